@@ -56,7 +56,8 @@ enum
   PROP_0,
   PROP_ENABLE,
   PROP_EMBEDDEDFONTS,
-  PROP_WAIT_TEXT
+  PROP_WAIT_TEXT,
+  PROP_STATS
 };
 
 /* FIXME: video-blend.c doesn't support formats with more than 8 bit per
@@ -167,6 +168,18 @@ gst_ass_render_class_init (GstAssRenderClass * klass)
           "Whether to wait for subtitles", TRUE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAssRender:stats:
+   *
+   * Counts and times (in nanoseconds) the libass renderings and the frames
+   * they are blended on or attached to, see the structure fields.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics", "Various statistics",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_ass_render_change_state);
 
@@ -299,6 +312,10 @@ gst_ass_render_reset_composition (GstAssRender * render)
     gst_video_overlay_composition_unref (render->composition);
     render->composition = NULL;
   }
+
+  GST_ASS_RENDER_LOCK (render);
+  render->stats_pixels = 0;
+  GST_ASS_RENDER_UNLOCK (render);
 }
 
 static void
@@ -345,6 +362,17 @@ gst_ass_render_get_property (GObject * object, guint prop_id,
     case PROP_WAIT_TEXT:
       g_value_set_boolean (value, render->wait_text);
       break;
+    case PROP_STATS:
+      g_value_take_boxed (value,
+          gst_structure_new ("application/x-assrender-stats",
+              "rendered", G_TYPE_UINT64, render->stats_rendered,
+              "render-cost", G_TYPE_UINT64, render->stats_render_cost,
+              "overlaid", G_TYPE_UINT64, render->stats_overlaid,
+              "last-cost", G_TYPE_UINT64, render->stats_last_cost,
+              "average-cost", G_TYPE_UINT64, render->stats_overlaid ?
+              render->stats_overlay_cost / render->stats_overlaid : 0,
+              "pixels", G_TYPE_UINT, render->stats_pixels, NULL));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -685,6 +713,10 @@ blit_bgra_premultiplied (GstAssRender * render, ASS_Image * ass_image,
     dst_x = ass_image->dst_x + x_off;
     dst_y = ass_image->dst_y + y_off;
 
+    /* images of the other bands */
+    if (dst_x < 0 || dst_y < 0)
+      goto next;
+
     w = MIN (ass_image->w, width - dst_x);
     h = MIN (ass_image->h, height - dst_y);
     if (w <= 0 || h <= 0)
@@ -1052,44 +1084,29 @@ gst_ass_render_process_text (GstAssRender * render, GstBuffer * buffer,
   gst_buffer_unmap (buffer, &map);
 }
 
-static GstVideoOverlayComposition *
-gst_ass_render_composite_overlay (GstAssRender * render, ASS_Image * images)
+typedef struct
+{
+  gint x0, y0, x1, y1;
+} GstAssRenderBand;
+
+static GstVideoOverlayRectangle *
+gst_ass_render_composite_band (GstAssRender * render, ASS_Image * images,
+    const GstAssRenderBand * band)
 {
-  GstVideoOverlayComposition *composition;
   GstVideoOverlayRectangle *rectangle;
   GstVideoMeta *vmeta;
   GstMapInfo map;
   GstBuffer *buffer;
-  ASS_Image *image;
-  gint min_x, min_y;
-  gint max_x, max_y;
   gint width, height;
   gint stride;
   gdouble hscale, vscale;
   gpointer data;
 
-  min_x = G_MAXINT;
-  min_y = G_MAXINT;
-  max_x = 0;
-  max_y = 0;
-
-  /* find bounding box of all images, to limit the overlay rectangle size */
-  for (image = images; image; image = image->next) {
-    if (min_x > image->dst_x)
-      min_x = image->dst_x;
-    if (min_y > image->dst_y)
-      min_y = image->dst_y;
-    if (max_x < image->dst_x + image->w)
-      max_x = image->dst_x + image->w;
-    if (max_y < image->dst_y + image->h)
-      max_y = image->dst_y + image->h;
-  }
-
-  width = MIN (max_x - min_x, render->ass_frame_width);
-  height = MIN (max_y - min_y, render->ass_frame_height);
+  width = MIN (band->x1 - band->x0, render->ass_frame_width);
+  height = MIN (band->y1 - band->y0, render->ass_frame_height);
 
   GST_DEBUG_OBJECT (render, "render overlay rectangle %dx%d%+d%+d",
-      width, height, min_x, min_y);
+      width, height, band->x0, band->y0);
 
   buffer = gst_buffer_new_and_alloc (4 * width * height);
   if (!buffer) {
@@ -1107,20 +1124,79 @@ gst_ass_render_composite_overlay (GstAssRender * render, ASS_Image * images)
   }
 
   blit_bgra_premultiplied (render, images, data, width, height, stride,
-      -min_x, -min_y);
+      -band->x0, -band->y0);
   gst_video_meta_unmap (vmeta, 0, &map);
 
   hscale = (gdouble) render->info.width / (gdouble) render->ass_frame_width;
   vscale = (gdouble) render->info.height / (gdouble) render->ass_frame_height;
 
   rectangle = gst_video_overlay_rectangle_new_raw (buffer,
-      hscale * min_x, vscale * min_y, hscale * width, vscale * height,
+      hscale * band->x0, vscale * band->y0, hscale * width, vscale * height,
       GST_VIDEO_OVERLAY_FORMAT_FLAG_PREMULTIPLIED_ALPHA);
 
   gst_buffer_unref (buffer);
 
-  composition = gst_video_overlay_composition_new (rectangle);
-  gst_video_overlay_rectangle_unref (rectangle);
+  return rectangle;
+}
+
+static GstVideoOverlayComposition *
+gst_ass_render_composite_overlay (GstAssRender * render, ASS_Image * images)
+{
+  GstVideoOverlayComposition *composition = NULL;
+  GstVideoOverlayRectangle *rectangle;
+  GstAssRenderBand b, *band;
+  ASS_Image *image;
+  GArray *bands;
+  guint i, pixels = 0;
+
+  /* Group the images in horizontal bands that don't share any line, e.g.
+   * the top and bottom subtitles, and make one rectangle of the bounding box
+   * of each band instead of one covering the whole screen */
+  bands = g_array_new (FALSE, FALSE, sizeof (GstAssRenderBand));
+  for (image = images; image; image = image->next) {
+    if (image->w <= 0 || image->h <= 0)
+      continue;
+
+    b.x0 = image->dst_x;
+    b.y0 = image->dst_y;
+    b.x1 = image->dst_x + image->w;
+    b.y1 = image->dst_y + image->h;
+
+    for (i = 0; i < bands->len;) {
+      band = &g_array_index (bands, GstAssRenderBand, i);
+      if (band->y0 < b.y1 && b.y0 < band->y1) {
+        b.x0 = MIN (b.x0, band->x0);
+        b.y0 = MIN (b.y0, band->y0);
+        b.x1 = MAX (b.x1, band->x1);
+        b.y1 = MAX (b.y1, band->y1);
+        g_array_remove_index_fast (bands, i);
+        /* the band grew, check the others again */
+        i = 0;
+      } else {
+        i++;
+      }
+    }
+    g_array_append_val (bands, b);
+  }
+
+  for (i = 0; i < bands->len; i++) {
+    band = &g_array_index (bands, GstAssRenderBand, i);
+    rectangle = gst_ass_render_composite_band (render, images, band);
+    if (!rectangle)
+      continue;
+
+    if (composition)
+      gst_video_overlay_composition_add_rectangle (composition, rectangle);
+    else
+      composition = gst_video_overlay_composition_new (rectangle);
+    gst_video_overlay_rectangle_unref (rectangle);
+    pixels += (band->x1 - band->x0) * (band->y1 - band->y0);
+  }
+  g_array_free (bands, TRUE);
+
+  GST_ASS_RENDER_LOCK (render);
+  render->stats_pixels = pixels;
+  GST_ASS_RENDER_UNLOCK (render);
 
   return composition;
 }
@@ -1129,16 +1205,18 @@ static gboolean
 gst_ass_render_push_frame (GstAssRender * render, GstBuffer * video_frame)
 {
   GstVideoFrame frame;
+  GstClockTime start, cost;
 
   if (!render->composition)
     goto done;
 
+  start = gst_util_get_timestamp ();
   video_frame = gst_buffer_make_writable (video_frame);
 
   if (render->attach_compo_to_buffer) {
     gst_buffer_add_video_overlay_composition_meta (video_frame,
         render->composition);
-    goto done;
+    goto stats;
   }
 
   if (!gst_video_frame_map (&frame, &render->info, video_frame,
@@ -1147,9 +1225,18 @@ gst_ass_render_push_frame (GstAssRender * render, GstBuffer * video_frame)
     goto done;
   }
 
+  /* only touches the pixels under the rectangles */
   gst_video_overlay_composition_blend (render->composition, &frame);
   gst_video_frame_unmap (&frame);
 
+stats:
+  cost = gst_util_get_timestamp () - start;
+  GST_ASS_RENDER_LOCK (render);
+  render->stats_overlaid++;
+  render->stats_last_cost = cost;
+  render->stats_overlay_cost += cost;
+  GST_ASS_RENDER_UNLOCK (render);
+
 done:
   return gst_pad_push (render->srcpad, video_frame);
 }
@@ -1310,9 +1397,19 @@ wait_for_text_buf:
       }
 
       if (ass_image != NULL) {
-        if (!render->composition)
+        /* libass tells when the images changed, otherwise the composition
+         * of the previous frame is used as is */
+        if (!render->composition) {
+          GstClockTime start = gst_util_get_timestamp ();
+
           render->composition = gst_ass_render_composite_overlay (render,
               ass_image);
+
+          GST_ASS_RENDER_LOCK (render);
+          render->stats_rendered++;
+          render->stats_render_cost += gst_util_get_timestamp () - start;
+          GST_ASS_RENDER_UNLOCK (render);
+        }
       } else {
         GST_DEBUG_OBJECT (render, "nothing to render right now");
       }
@@ -85,6 +85,14 @@ struct _GstAssRender
   GstVideoOverlayComposition *composition;
   guint window_width, window_height;
   gboolean attach_compo_to_buffer;
+
+  /* statistics, with the lock */
+  guint64 stats_rendered;
+  GstClockTime stats_render_cost;
+  guint64 stats_overlaid;
+  GstClockTime stats_last_cost;
+  GstClockTime stats_overlay_cost;
+  guint stats_pixels;
 };
 
 struct _GstAssRenderClass
@@ -133,6 +133,14 @@
 #define GSTCURL_DEFAULT_CONNECTIONS_SERVER 5
 #define GSTCURL_DEFAULT_CONNECTIONS_PROXY 30
 #define GSTCURL_DEFAULT_CONNECTIONS_GLOBAL 255
+/* The body is received in chunks of this size, at most max-queued-bytes of
+ * it wait for downstream before the transfer is paused. */
+#define GSTCURL_CHUNK_SIZE (64 * 1024)
+#define GSTCURL_MIN_QUEUED_BYTES GSTCURL_CHUNK_SIZE
+#define GSTCURL_MAX_QUEUED_BYTES G_MAXUINT64
+#define GSTCURL_DEFAULT_QUEUED_BYTES (4 * 1024 * 1024)
+/* How long the multi loop sleeps at most while a transfer is paused */
+#define GSTCURL_PAUSED_POLL_USECS 10000
 #define GSTCURL_INFO_RESPONSE(x) ((x >= 100) && (x <= 199))
 #define GSTCURL_SUCCESS_RESPONSE(x) ((x >= 200) && (x <=299))
 #define GSTCURL_REDIRECT_RESPONSE(x) ((x >= 300) && (x <= 399))
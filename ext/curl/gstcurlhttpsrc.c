@@ -138,6 +138,9 @@ static size_t gst_curl_http_src_get_header (void *header, size_t size,
 static size_t gst_curl_http_src_get_chunks (void *chunk, size_t size,
     size_t nmemb, void *src);
 static void gst_curl_http_src_request_remove (GstCurlHttpSrc * src);
+static gboolean gst_curl_http_src_resume_paused (GstCurlHttpSrc * src);
+static GstBuffer *gst_curl_http_src_pop_chunk (GstCurlHttpSrc * src);
+static void gst_curl_http_src_flush_chunks (GstCurlHttpSrc * src);
 static char *gst_curl_http_src_strcasestr (const char *haystack,
     const char *needle);
 
@@ -382,6 +385,36 @@ gst_curl_http_src_class_init (GstCurlHttpSrcClass * klass)
           GST_TYPE_CURL_HTTP_VERSION, pref_http_ver,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstCurlHttpSrc:max-queued-bytes:
+   *
+   * Maximum amount of the response body that is kept waiting for downstream.
+   * When it is reached, the transfer is paused until downstream took some of
+   * the data.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUED_BYTES,
+      g_param_spec_uint64 ("max-queued-bytes", "Max-Queued-Bytes",
+          "Maximum number of received bytes waiting for downstream before "
+          "the transfer is paused", GSTCURL_MIN_QUEUED_BYTES,
+          GSTCURL_MAX_QUEUED_BYTES, GSTCURL_DEFAULT_QUEUED_BYTES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstCurlHttpSrc:stats:
+   *
+   * Statistics of the receive queue, a #GstStructure with the fields
+   * "queued-bytes" (the bytes waiting for downstream), "queued-bytes-hwm"
+   * (the most that ever waited) and "pauses" (how often the transfer was
+   * paused because the queue was full).
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Stats", "Receive queue statistics",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   /* Add a debugging task so it's easier to debug in the Multi worker thread */
   GST_DEBUG_CATEGORY_INIT (gst_curl_loop_debug, "curl_multi_loop", 0,
       "libcURL loop thread debugging");
@@ -489,6 +522,11 @@ gst_curl_http_src_set_property (GObject * object, guint prop_id,
     case PROP_HTTPVERSION:
       source->preferred_http_version = g_value_get_enum (value);
       break;
+    case PROP_MAX_QUEUED_BYTES:
+      g_mutex_lock (&source->buffer_mutex);
+      source->max_queued_bytes = g_value_get_uint64 (value);
+      g_mutex_unlock (&source->buffer_mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -570,6 +608,17 @@ gst_curl_http_src_get_property (GObject * object, guint prop_id,
     case PROP_HTTPVERSION:
       g_value_set_enum (value, source->preferred_http_version);
       break;
+    case PROP_MAX_QUEUED_BYTES:
+      g_value_set_uint64 (value, source->max_queued_bytes);
+      break;
+    case PROP_STATS:
+      g_mutex_lock (&source->buffer_mutex);
+      g_value_take_boxed (value, gst_structure_new ("application/x-curl-stats",
+              "queued-bytes", G_TYPE_UINT64, source->queued_bytes,
+              "queued-bytes-hwm", G_TYPE_UINT64, source->queued_bytes_hwm,
+              "pauses", G_TYPE_UINT64, source->n_pauses, NULL));
+      g_mutex_unlock (&source->buffer_mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -619,8 +668,16 @@ gst_curl_http_src_init (GstCurlHttpSrc * source)
   g_mutex_init (&source->buffer_mutex);
   g_cond_init (&source->signal);
 
-  source->buffer = NULL;
-  source->buffer_len = 0;
+  source->pool = NULL;
+  g_queue_init (&source->chunk_queue);
+  source->chunk = NULL;
+  source->chunk_len = 0;
+  source->queued_bytes = 0;
+  source->max_queued_bytes = GSTCURL_DEFAULT_QUEUED_BYTES;
+  source->transfer_paused = FALSE;
+  source->resume_transfer = FALSE;
+  source->queued_bytes_hwm = 0;
+  source->n_pauses = 0;
   source->state = GSTCURL_NONE;
   source->pending_state = GSTCURL_NONE;
   source->status_code = 0;
@@ -788,6 +845,8 @@ retry:
     src->state = GSTCURL_OK;
     src->transfer_begun = TRUE;
     src->data_received = FALSE;
+    src->transfer_paused = FALSE;
+    src->resume_transfer = FALSE;
 
     GST_DEBUG_OBJECT (src, "Submitted request for URI %s to curl", src->uri);
 
@@ -801,16 +860,12 @@ retry:
   }
 
   /* Wait for data to become available, then punt it downstream */
-  while ((src->buffer_len == 0) && (src->state == GSTCURL_OK)) {
+  while ((src->queued_bytes == 0) && (src->state == GSTCURL_OK)) {
     g_cond_wait (&src->signal, &src->buffer_mutex);
   }
 
   if (src->state == GSTCURL_UNLOCK) {
-    if (src->buffer_len > 0) {
-      g_free (src->buffer);
-      src->buffer = NULL;
-      src->buffer_len = 0;
-    }
+    gst_curl_http_src_flush_chunks (src);
     ret = GST_FLOW_FLUSHING;
     goto escape;
   }
@@ -840,6 +895,7 @@ retry:
         goto escape;
       }
       GST_INFO_OBJECT (src, "Attempting retry for URI %s", src->uri);
+      gst_curl_http_src_flush_chunks (src);
       src->state = GSTCURL_NONE;
       src->transfer_begun = FALSE;
       src->status_code = 0;
@@ -857,20 +913,15 @@ retry:
   }
 
   if (((src->state == GSTCURL_OK) || (src->state == GSTCURL_DONE)) &&
-      (src->buffer_len > 0)) {
+      (src->queued_bytes > 0)) {
 
-    GST_DEBUG_OBJECT (src, "Pushing %u bytes of transfer for URI %s to pad",
-        src->buffer_len, src->uri);
-    *outbuf = gst_buffer_new_allocate (NULL, src->buffer_len, NULL);
-    gst_buffer_fill (*outbuf, 0, src->buffer, src->buffer_len);
-
-    g_free (src->buffer);
-    src->buffer = NULL;
-    src->buffer_len = 0;
+    *outbuf = gst_curl_http_src_pop_chunk (src);
+    GST_DEBUG_OBJECT (src, "Pushing %" G_GSIZE_FORMAT " bytes of transfer for "
+        "URI %s to pad", gst_buffer_get_size (*outbuf), src->uri);
     src->data_received = TRUE;
 
     /* ret should still be GST_FLOW_OK */
-  } else if ((src->state == GSTCURL_DONE) && (src->buffer_len == 0)) {
+  } else if ((src->state == GSTCURL_DONE) && (src->queued_bytes == 0)) {
     GST_INFO_OBJECT (src, "Full body received, signalling EOS for URI %s.",
         src->uri);
     src->state = GSTCURL_NONE;
@@ -1261,12 +1312,28 @@ gst_curl_http_src_change_state (GstElement * element, GstStateChange transition)
       gst_curl_http_src_ref_multi (source);
       break;
     case GST_STATE_CHANGE_READY_TO_PAUSED:
+    {
+      GstStructure *config;
+
       if (source->uri == NULL) {
         GST_ELEMENT_ERROR (element, RESOURCE, OPEN_READ, (_("No URL set.")),
             ("Missing URL"));
         return GST_STATE_CHANGE_FAILURE;
       }
+
+      /* the chunks are only recycled, the queue limit is enforced by us */
+      g_mutex_lock (&source->buffer_mutex);
+      source->pool = gst_buffer_pool_new ();
+      config = gst_buffer_pool_get_config (source->pool);
+      gst_buffer_pool_config_set_params (config, NULL, GSTCURL_CHUNK_SIZE, 0,
+          0);
+      gst_buffer_pool_set_config (source->pool, config);
+      gst_buffer_pool_set_active (source->pool, TRUE);
+      source->queued_bytes_hwm = 0;
+      source->n_pauses = 0;
+      g_mutex_unlock (&source->buffer_mutex);
       break;
+    }
     case GST_STATE_CHANGE_READY_TO_NULL:
       /* The pipeline has ended, so signal any running request to end. */
       gst_curl_http_src_request_remove (source);
@@ -1278,6 +1345,21 @@ gst_curl_http_src_change_state (GstElement * element, GstStateChange transition)
 
   ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
 
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      g_mutex_lock (&source->buffer_mutex);
+      gst_curl_http_src_flush_chunks (source);
+      if (source->pool) {
+        gst_buffer_pool_set_active (source->pool, FALSE);
+        gst_object_unref (source->pool);
+        source->pool = NULL;
+      }
+      g_mutex_unlock (&source->buffer_mutex);
+      break;
+    default:
+      break;
+  }
+
   GSTCURL_FUNCTION_EXIT (source);
   return ret;
 }
@@ -1314,13 +1396,17 @@ gst_curl_http_src_cleanup_instance (GstCurlHttpSrc * src)
   g_free (src->cookies);
   src->cookies = NULL;
 
+  gst_curl_http_src_flush_chunks (src);
+  if (src->pool) {
+    gst_buffer_pool_set_active (src->pool, FALSE);
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
+
   g_mutex_clear (&src->buffer_mutex);
 
   g_cond_clear (&src->signal);
 
-  g_free (src->buffer);
-  src->buffer = NULL;
-
   if (src->http_headers != NULL) {
     gst_structure_free (src->http_headers);
     src->http_headers = NULL;
@@ -1564,6 +1650,13 @@ gst_curl_http_src_curl_multi_loop (gpointer thread_data)
     fd_set fdread, fdwrite, fdexcep;
     int maxfd = -1;
     long curl_timeo = -1;
+    gboolean paused = FALSE;
+
+    /* Continue the transfers whose elements have room for data again */
+    for (qelement = context->queue; qelement != NULL; qelement = qelement->next) {
+      if (gst_curl_http_src_resume_paused (qelement->p))
+        paused = TRUE;
+    }
 
     /* Because curl can possibly take some time here, be nice and let go of the
      * mutex so other threads can perform state/queue operations as we don't
@@ -1586,6 +1679,13 @@ gst_curl_http_src_curl_multi_loop (gpointer thread_data)
         timeout.tv_usec = (curl_timeo % 1000) * 1000;
       }
     }
+    /* Nothing wakes us up when downstream takes data from a paused
+     * transfer, so poll for that */
+    if (paused && (timeout.tv_sec > 0 ||
+            timeout.tv_usec > GSTCURL_PAUSED_POLL_USECS)) {
+      timeout.tv_sec = 0;
+      timeout.tv_usec = GSTCURL_PAUSED_POLL_USECS;
+    }
 
     /* get file descriptors from the transfers */
     curl_multi_fdset (context->multi_handle, &fdread, &fdwrite, &fdexcep,
@@ -1825,31 +1925,143 @@ gst_curl_http_src_strcasestr (const char *haystack, const char *needle)
 
 /*
  * Receive chunks of the requested body and pass these back to the ::create()
- * loop
+ * loop. The data is copied once, into the chunks that are pushed downstream.
+ * If too much data is already waiting for downstream, the transfer is paused
+ * and curl hands the same data in again once it was resumed.
  */
 static size_t
 gst_curl_http_src_get_chunks (void *chunk, size_t size, size_t nmemb, void *src)
 {
   GstCurlHttpSrc *s = src;
   size_t chunk_len = size * nmemb;
+  const guint8 *data = chunk;
+  gsize len;
+
   GST_TRACE_OBJECT (s,
       "Received curl chunk for URI %s of size %d", s->uri, (int) chunk_len);
   g_mutex_lock (&s->buffer_mutex);
-  if (s->state == GSTCURL_UNLOCK) {
+  if (s->state == GSTCURL_UNLOCK || s->pool == NULL) {
     g_mutex_unlock (&s->buffer_mutex);
     return chunk_len;
   }
-  s->buffer =
-      g_realloc (s->buffer, (s->buffer_len + chunk_len + 1) * sizeof (char));
-  if (s->buffer == NULL) {
-    GST_ERROR_OBJECT (s, "Realloc for cURL response message failed!\n");
-    return 0;
+
+  if (s->queued_bytes >= s->max_queued_bytes) {
+    GST_DEBUG_OBJECT (s, "%" G_GUINT64_FORMAT " bytes queued, pausing "
+        "transfer for URI %s", s->queued_bytes, s->uri);
+    s->transfer_paused = TRUE;
+    s->resume_transfer = FALSE;
+    s->n_pauses++;
+    g_mutex_unlock (&s->buffer_mutex);
+    return CURL_WRITEFUNC_PAUSE;
   }
-  memcpy (s->buffer + s->buffer_len, chunk, chunk_len);
-  s->buffer_len += chunk_len;
+
+  while (chunk_len > 0) {
+    if (s->chunk == NULL) {
+      if (gst_buffer_pool_acquire_buffer (s->pool, &s->chunk,
+              NULL) != GST_FLOW_OK) {
+        GST_ERROR_OBJECT (s, "Failed to get a buffer for the cURL response");
+        g_mutex_unlock (&s->buffer_mutex);
+        return 0;
+      }
+      gst_buffer_map (s->chunk, &s->chunk_map, GST_MAP_WRITE);
+      s->chunk_len = 0;
+    }
+
+    len = MIN (chunk_len, s->chunk_map.size - s->chunk_len);
+    memcpy (s->chunk_map.data + s->chunk_len, data, len);
+    s->chunk_len += len;
+    s->queued_bytes += len;
+    data += len;
+    chunk_len -= len;
+
+    if (s->chunk_len == s->chunk_map.size) {
+      gst_buffer_unmap (s->chunk, &s->chunk_map);
+      g_queue_push_tail (&s->chunk_queue, s->chunk);
+      s->chunk = NULL;
+    }
+  }
+
+  s->queued_bytes_hwm = MAX (s->queued_bytes_hwm, s->queued_bytes);
   g_cond_signal (&s->signal);
   g_mutex_unlock (&s->buffer_mutex);
-  return chunk_len;
+  return size * nmemb;
+}
+
+/*
+ * Take the oldest received data out of the queue, a full chunk if there is
+ * one. Must be called with the buffer mutex held and data queued.
+ */
+static GstBuffer *
+gst_curl_http_src_pop_chunk (GstCurlHttpSrc * src)
+{
+  GstBuffer *buf;
+
+  buf = g_queue_pop_head (&src->chunk_queue);
+  if (buf == NULL) {
+    /* Hand out the partly filled chunk, curl fills a new one */
+    buf = src->chunk;
+    gst_buffer_unmap (buf, &src->chunk_map);
+    gst_buffer_resize (buf, 0, src->chunk_len);
+    src->chunk = NULL;
+    src->chunk_len = 0;
+  }
+  src->queued_bytes -= gst_buffer_get_size (buf);
+
+  if (src->transfer_paused && src->queued_bytes <= src->max_queued_bytes / 2) {
+    GST_DEBUG_OBJECT (src, "Room for more data, resuming transfer for URI %s",
+        src->uri);
+    src->resume_transfer = TRUE;
+  }
+
+  return buf;
+}
+
+/*
+ * Drop all the received data. Must be called with the buffer mutex held.
+ */
+static void
+gst_curl_http_src_flush_chunks (GstCurlHttpSrc * src)
+{
+  GstBuffer *buf;
+
+  while ((buf = g_queue_pop_head (&src->chunk_queue)))
+    gst_buffer_unref (buf);
+  if (src->chunk) {
+    gst_buffer_unmap (src->chunk, &src->chunk_map);
+    gst_buffer_unref (src->chunk);
+    src->chunk = NULL;
+  }
+  src->chunk_len = 0;
+  src->queued_bytes = 0;
+
+  if (src->transfer_paused)
+    src->resume_transfer = TRUE;
+}
+
+/*
+ * Called by the multi loop to continue a paused transfer once ::create() took
+ * enough data out of the queue. Returns TRUE if the transfer is still paused.
+ */
+static gboolean
+gst_curl_http_src_resume_paused (GstCurlHttpSrc * src)
+{
+  gboolean resume, paused;
+
+  g_mutex_lock (&src->buffer_mutex);
+  resume = src->transfer_paused && src->resume_transfer;
+  if (resume) {
+    src->transfer_paused = FALSE;
+    src->resume_transfer = FALSE;
+  }
+  paused = src->transfer_paused;
+  g_mutex_unlock (&src->buffer_mutex);
+
+  /* This can call gst_curl_http_src_get_chunks() right away, and pause the
+   * transfer again */
+  if (resume)
+    curl_easy_pause (src->curl_handle, CURLPAUSE_CONT);
+
+  return paused;
 }
 
 /*
@@ -201,11 +201,24 @@ struct _GstCurlHttpSrc
   CURL *curl_handle;
   GMutex buffer_mutex;
   GCond signal;
-  gchar *buffer;
-  guint buffer_len;
+  /* The body is received into fixed size chunks from the pool. Full chunks
+   * wait in chunk_queue, the one being filled is mapped in chunk_map. */
+  GstBufferPool *pool;
+  GQueue chunk_queue;
+  GstBuffer *chunk;
+  GstMapInfo chunk_map;
+  gsize chunk_len;
+  guint64 queued_bytes;         /* in chunk_queue and chunk */
+  guint64 max_queued_bytes;
+  gboolean transfer_paused;     /* curl holds the data back */
+  gboolean resume_transfer;     /* there is room again, multi loop unpauses */
   gboolean transfer_begun;
   gboolean data_received;
 
+  /* stats */
+  guint64 queued_bytes_hwm;
+  guint64 n_pauses;
+
   /*
    * Response Headers
    */
@@ -245,6 +258,8 @@ enum
   PROP_MAXCONCURRENT_PROXY,
   PROP_MAXCONCURRENT_GLOBAL,
   PROP_HTTPVERSION,
+  PROP_MAX_QUEUED_BYTES,
+  PROP_STATS,
   PROP_MAX
 };
 
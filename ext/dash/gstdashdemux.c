@@ -140,6 +140,20 @@
  * on downstream buffering, and will instead manage an internal queue.
  *
  *
+ * Low latency live playback:
+ *
+ * With the low-latency property enabled, the segments of a live stream are
+ * requested availabilityTimeOffset earlier than their nominal availability
+ * time, which for chunked CMAF content means while the encoder is still
+ * producing them. The server sends their chunks as they are produced
+ * (HTTP chunked transfer encoding) and each chunk is parsed and pushed
+ * downstream as soon as it is received. The live seek range ends
+ * accordingly closer to the live edge, and the base class catches up with
+ * it by raising the playback rate whenever the latency grows past the
+ * target-latency property. The presentation-delay property should be set
+ * close to that target so playback does not start far behind.
+ *
+ *
  * Keyframe trick-mode implementation:
  *
  * When requested (with GST_SEEK_FLAG_TRICKMODE_KEY_UNIT) and if the format
@@ -272,6 +286,27 @@
  *   Advance to keyframe/fragment for that target_time
  *   Adaptivedemux downloads that keyframe/fragment
  *
+ * Keyframe-only downloading is enabled by the
+ * GST_SEEK_FLAG_TRICKMODE_KEY_UNITS seek flag, or from the
+ * "trick-mode-key-units-rate" absolute rate on.
+ *
+ * In that mode the representation is only changed between fragments. It is
+ * the one of highest bandwidth for which the keyframes fit in the available
+ * bitrate, assuming the keyframe size of the representations is proportional
+ * to their bandwidth:
+ *   bandwidth <= bitrate * keyframe_dist * current_bandwidth /
+ *                (8 * keyframe_average_size)
+ * with keyframe_dist the running time between two downloaded keyframes,
+ * i.e. keyframe_average_distance / rate, but no less than the maximum
+ * framerate allows.
+ *
+ * If the MPD has a trick mode adaptation set for the video adaptation set
+ * (an EssentialProperty or SupplementalProperty with the
+ * "http://dashif.org/guidelines/trickmode" scheme and the id of the main
+ * adaptation set as value), the stream switches to it in key-frame trick
+ * mode and back to the main adaptation set afterwards. Trick mode adaptation
+ * sets signalled with an EssentialProperty are not exposed as streams.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -327,6 +362,8 @@ enum
   PROP_MAX_VIDEO_HEIGHT,
   PROP_MAX_VIDEO_FRAMERATE,
   PROP_PRESENTATION_DELAY,
+  PROP_ELEMENTARY_STREAMS,
+  PROP_TRICK_MODE_KEY_UNITS_RATE,
   PROP_LAST
 };
 
@@ -339,6 +376,8 @@ enum
 #define DEFAULT_MAX_VIDEO_FRAMERATE_N     0
 #define DEFAULT_MAX_VIDEO_FRAMERATE_D     1
 #define DEFAULT_PRESENTATION_DELAY     "10s"    /* 10s */
+#define DEFAULT_ELEMENTARY_STREAMS     FALSE
+#define DEFAULT_TRICK_MODE_KEY_UNITS_RATE 0.0   /* disabled */
 
 /* Clock drift compensation for live streams */
 #define SLOW_CLOCK_UPDATE_INTERVAL  (1000000 * 30 * 60) /* 30 minutes */
@@ -416,6 +455,8 @@ static void gst_dash_demux_stream_free (GstAdaptiveDemuxStream * stream);
 
 static GstCaps *gst_dash_demux_get_input_caps (GstDashDemux * demux,
     GstActiveStream * stream);
+static void gst_dash_demux_stream_clear_samples (GstDashDemuxStream *
+    dash_stream);
 static GstPad *gst_dash_demux_create_pad (GstDashDemux * demux,
     GstActiveStream * stream);
 static GstDashDemuxClockDrift *gst_dash_demux_clock_drift_new (GstDashDemux *
@@ -465,6 +506,26 @@ gst_dash_demux_dispose (GObject * obj)
   G_OBJECT_CLASS (parent_class)->dispose (obj);
 }
 
+/* The smallest availabilityTimeOffset of the active streams, i.e. how much
+ * earlier than their nominal availability time all the current segments can
+ * start to be fetched */
+static GstClockTime
+gst_dash_demux_get_availability_time_offset (GstDashDemux * demux)
+{
+  GstClockTime offset = GST_CLOCK_TIME_NONE;
+  guint i;
+
+  for (i = 0; i < gst_mpdparser_get_nb_active_stream (demux->client); i++) {
+    GstActiveStream *stream =
+        gst_mpdparser_get_active_stream_by_index (demux->client, i);
+
+    offset = MIN (offset,
+        gst_mpd_client_get_stream_availability_time_offset (stream));
+  }
+
+  return i > 0 ? offset : 0;
+}
+
 static gboolean
 gst_dash_demux_get_live_seek_range (GstAdaptiveDemux * demux, gint64 * start,
     gint64 * stop)
@@ -508,7 +569,12 @@ gst_dash_demux_get_live_seek_range (GstAdaptiveDemux * demux, gint64 * start,
      * the MPD duration of the Media Segment.
      Therefore we need to subtract the media segment duration from the stop
      time.
+     In low latency mode, the segments can be fetched availabilityTimeOffset
+     earlier, while they are being produced.
    */
+  if (gst_adaptive_demux_is_low_latency (demux))
+    seg_duration -=
+        MIN (seg_duration, gst_dash_demux_get_availability_time_offset (self));
   *stop -= seg_duration;
   return TRUE;
 }
@@ -595,6 +661,41 @@ gst_dash_demux_class_init (GstDashDemuxClass * klass)
           DEFAULT_PRESENTATION_DELAY,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDashDemux:elementary-streams:
+   *
+   * Output the timestamped samples of fragmented MP4 representations
+   * directly instead of the fragments, which makes a downstream qtdemux
+   * unnecessary. Only H.264, H.265 and AAC without encryption are supported,
+   * other representations are output as before.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_ELEMENTARY_STREAMS,
+      g_param_spec_boolean ("elementary-streams", "Elementary streams",
+          "Output the samples of fragmented MP4 representations instead of "
+          "the fragments", DEFAULT_ELEMENTARY_STREAMS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDashDemux:trick-mode-key-units-rate:
+   *
+   * Absolute playback rate from which only the keyframes of fragmented MP4
+   * video streams are downloaded, as if the seek had the
+   * %GST_SEEK_FLAG_TRICKMODE_KEY_UNITS flag. 0 disables this, keyframe-only
+   * downloading then depends on the seek flags only.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_TRICK_MODE_KEY_UNITS_RATE,
+      g_param_spec_double ("trick-mode-key-units-rate",
+          "Trick mode key units rate",
+          "Absolute playback rate from which only keyframes are downloaded "
+          "(0 = only with the TRICKMODE_KEY_UNITS seek flag)", 0.0,
+          G_MAXDOUBLE, DEFAULT_TRICK_MODE_KEY_UNITS_RATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (gstelement_class,
       &gst_dash_demux_audiosrc_template);
   gst_element_class_add_static_pad_template (gstelement_class,
@@ -664,6 +765,8 @@ gst_dash_demux_init (GstDashDemux * demux)
   demux->max_video_framerate_n = DEFAULT_MAX_VIDEO_FRAMERATE_N;
   demux->max_video_framerate_d = DEFAULT_MAX_VIDEO_FRAMERATE_D;
   demux->default_presentation_delay = g_strdup (DEFAULT_PRESENTATION_DELAY);
+  demux->elementary_streams = DEFAULT_ELEMENTARY_STREAMS;
+  demux->trick_mode_key_units_rate = DEFAULT_TRICK_MODE_KEY_UNITS_RATE;
 
   g_mutex_init (&demux->client_lock);
 
@@ -702,6 +805,12 @@ gst_dash_demux_set_property (GObject * object, guint prop_id,
       g_free (demux->default_presentation_delay);
       demux->default_presentation_delay = g_value_dup_string (value);
       break;
+    case PROP_ELEMENTARY_STREAMS:
+      demux->elementary_streams = g_value_get_boolean (value);
+      break;
+    case PROP_TRICK_MODE_KEY_UNITS_RATE:
+      demux->trick_mode_key_units_rate = g_value_get_double (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -741,6 +850,12 @@ gst_dash_demux_get_property (GObject * object, guint prop_id, GValue * value,
       else
         g_value_set_string (value, demux->default_presentation_delay);
       break;
+    case PROP_ELEMENTARY_STREAMS:
+      g_value_set_boolean (value, demux->elementary_streams);
+      break;
+    case PROP_TRICK_MODE_KEY_UNITS_RATE:
+      g_value_set_double (value, demux->trick_mode_key_units_rate);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -758,6 +873,14 @@ gst_dash_demux_setup_mpdparser_streams (GstDashDemux * demux,
   for (iter = adapt_sets; iter; iter = g_list_next (iter)) {
     GstAdaptationSetNode *adapt_set_node = iter->data;
 
+    /* Only used instead of their main adaptation set in key-frame trick
+     * mode */
+    if (gst_mpd_client_adaptation_set_is_trickmode_only (adapt_set_node)) {
+      GST_DEBUG_OBJECT (demux, "Skipping trick mode adaptation set %u",
+          adapt_set_node->id);
+      continue;
+    }
+
     gst_mpd_client_setup_streaming (client, adapt_set_node);
     has_streams = TRUE;
   }
@@ -1490,6 +1613,7 @@ gst_dash_demux_stream_seek (GstAdaptiveDemuxStream * stream, gboolean forward,
   dashstream->moof_sync_samples = NULL;
   dashstream->current_sync_sample = -1;
   dashstream->target_time = GST_CLOCK_TIME_NONE;
+  gst_dash_demux_stream_clear_samples (dashstream);
 
   is_isobmff = gst_mpd_client_has_isoff_ondemand_profile (dashdemux->client);
 
@@ -2081,6 +2205,7 @@ gst_dash_demux_stream_advance_fragment (GstAdaptiveDemuxStream * stream)
     g_array_free (dashstream->moof_sync_samples, TRUE);
   dashstream->moof_sync_samples = NULL;
   dashstream->current_sync_sample = -1;
+  gst_dash_demux_stream_clear_samples (dashstream);
 
   /* Check if we just need to 'advance' to the next fragment, or if we
    * need to skip by more. */
@@ -2159,6 +2284,103 @@ gst_dash_demux_stream_advance_fragment (GstAdaptiveDemuxStream * stream)
   return ret;
 }
 
+/* Switches a video stream to the trick mode adaptation set advertised for
+ * its adaptation set while downloading only keyframes, and back to the main
+ * adaptation set afterwards. The stream has to be seeked again if the
+ * adaptation set was changed */
+static gboolean
+gst_dash_demux_stream_update_adaptation_set (GstDashDemux * demux,
+    GstDashDemuxStream * dashstream)
+{
+  GstActiveStream *active_stream = dashstream->active_stream;
+  GstAdaptationSetNode *adapt_set;
+  GstCaps *caps;
+
+  if (active_stream == NULL || active_stream->cur_adapt_set == NULL
+      || active_stream->mimeType != GST_STREAM_VIDEO)
+    return FALSE;
+
+  if (GST_ADAPTIVE_DEMUX_IN_TRICKMODE_KEY_UNITS (demux))
+    adapt_set = gst_mpd_client_get_trickmode_adaptation_set (demux->client,
+        active_stream->cur_adapt_set);
+  else
+    adapt_set = gst_mpd_client_get_trickmode_main_adaptation_set (demux->client,
+        active_stream->cur_adapt_set);
+
+  if (adapt_set == NULL)
+    return FALSE;
+
+  GST_INFO_OBJECT (demux, "Switching stream %d from adaptation set %u to %u",
+      dashstream->index, active_stream->cur_adapt_set->id, adapt_set->id);
+
+  if (!gst_mpd_client_setup_adaptation_set (demux->client, active_stream,
+          adapt_set)) {
+    GST_WARNING_OBJECT (demux, "Can not switch adaptation set");
+    return FALSE;
+  }
+
+  /* When outputting samples the caps are updated from the moov of the
+   * new representation */
+  if (!dashstream->output_samples) {
+    caps = gst_dash_demux_get_input_caps (demux, active_stream);
+    gst_adaptive_demux_stream_set_caps (GST_ADAPTIVE_DEMUX_STREAM_CAST
+        (dashstream), caps);
+  }
+
+  /* The keyframes of the other adaptation set say nothing about these */
+  dashstream->keyframe_average_size = 0;
+  dashstream->first_sync_sample_always_after_moof = TRUE;
+
+  return TRUE;
+}
+
+/* Returns the maximum bandwidth of the representations whose keyframes can
+ * be downloaded with @bitrate at the current rate. The keyframe sizes of the
+ * other representations are assumed to be proportional to their bandwidth */
+static guint64
+gst_dash_demux_stream_get_key_units_bandwidth (GstDashDemux * demux,
+    GstDashDemuxStream * dashstream, guint64 bitrate)
+{
+  GstAdaptiveDemux *base_demux = GST_ADAPTIVE_DEMUX_CAST (demux);
+  GstRepresentationNode *rep = dashstream->active_stream->cur_representation;
+  gdouble rate = ABS (base_demux->segment.rate);
+  GstClockTime keyframe_dist, min_frame_dist;
+  gint max_fps_n, max_fps_d;
+  guint64 keyframe_bits;
+
+  /* Without any keyframe yet, assume all the frames are needed */
+  if (rep == NULL || rep->bandwidth == 0
+      || dashstream->keyframe_average_size == 0
+      || dashstream->keyframe_average_distance == 0)
+    return rate > 1.0 ? bitrate / rate : bitrate;
+
+  /* Running time between two downloaded keyframes. Like in
+   * gst_dash_demux_stream_get_target_time() keyframes are skipped to not
+   * exceed the maximum framerate */
+  keyframe_dist = dashstream->keyframe_average_distance / rate;
+
+  if (demux->max_video_framerate_n != 0) {
+    max_fps_n = demux->max_video_framerate_n;
+    max_fps_d = demux->max_video_framerate_d;
+  } else {
+    max_fps_n = 10;
+    max_fps_d = 1;
+  }
+  min_frame_dist = gst_util_uint64_scale_ceil (GST_SECOND, max_fps_d,
+      max_fps_n);
+  keyframe_dist = MAX (keyframe_dist, min_frame_dist);
+
+  keyframe_bits = gst_util_uint64_scale (bitrate, keyframe_dist, GST_SECOND);
+
+  GST_LOG_OBJECT (GST_ADAPTIVE_DEMUX_STREAM_PAD (dashstream),
+      "%" G_GUINT64_FORMAT " bits per keyframe every %" GST_TIME_FORMAT
+      ", average keyframe size %" G_GUINT64_FORMAT, keyframe_bits,
+      GST_TIME_ARGS (keyframe_dist), dashstream->keyframe_average_size);
+
+  return gst_util_uint64_scale (keyframe_bits, rep->bandwidth,
+      8 * dashstream->keyframe_average_size);
+}
+
 static gboolean
 gst_dash_demux_stream_select_bitrate (GstAdaptiveDemuxStream * stream,
     guint64 bitrate)
@@ -2169,6 +2391,8 @@ gst_dash_demux_stream_select_bitrate (GstAdaptiveDemuxStream * stream,
   GstAdaptiveDemux *base_demux = stream->demux;
   GstDashDemux *demux = GST_DASH_DEMUX_CAST (stream->demux);
   GstDashDemuxStream *dashstream = (GstDashDemuxStream *) stream;
+  GstClockTime position = GST_CLOCK_TIME_NONE;
+  gboolean key_units, adapt_set_changed;
   gboolean ret = FALSE;
 
   active_stream = dashstream->active_stream;
@@ -2176,12 +2400,29 @@ gst_dash_demux_stream_select_bitrate (GstAdaptiveDemuxStream * stream,
     goto end;
   }
 
-  /* In key-frame trick mode don't change bitrates */
-  if (GST_ADAPTIVE_DEMUX_IN_TRICKMODE_KEY_UNITS (demux)) {
-    GST_DEBUG_OBJECT (demux, "In key-frame trick mode, not changing bitrates");
+  key_units = GST_ADAPTIVE_DEMUX_IN_TRICKMODE_KEY_UNITS (demux)
+      && dashstream->is_isobmff && demux->allow_trickmode_key_units
+      && active_stream->mimeType == GST_STREAM_VIDEO;
+
+  /* In key-frame trick mode the sync samples of the current fragment are
+   * only valid for the current representation, switch after it */
+  if (key_units && dashstream->moof_sync_samples) {
+    GST_DEBUG_OBJECT (demux, "In key-frame trick mode fragment, not changing "
+        "bitrates");
     goto end;
   }
 
+  /* Switch to or from the trick mode adaptation set. The segments of both
+   * sets are not necessarily aligned, so seek again to the position */
+  position = dashstream->actual_position;
+  if (!GST_CLOCK_TIME_IS_VALID (position)
+      && !gst_mpd_client_get_next_fragment_timestamp (demux->client,
+          dashstream->index, &position))
+    position = GST_CLOCK_TIME_NONE;
+  adapt_set_changed =
+      gst_dash_demux_stream_update_adaptation_set (demux, dashstream);
+  ret = adapt_set_changed;
+
   /* retrieve representation list */
   if (active_stream->cur_adapt_set)
     rep_list = active_stream->cur_adapt_set->Representations;
@@ -2197,8 +2438,13 @@ gst_dash_demux_stream_select_bitrate (GstAdaptiveDemuxStream * stream,
   }
 
   /* get representation index with current max_bandwidth */
-  if (GST_ADAPTIVE_DEMUX_IN_TRICKMODE_KEY_UNITS (base_demux) ||
-      ABS (base_demux->segment.rate) <= 1.0) {
+  if (key_units) {
+    new_index =
+        gst_mpdparser_get_rep_idx_with_max_bandwidth (rep_list,
+        gst_dash_demux_stream_get_key_units_bandwidth (demux, dashstream,
+            bitrate), demux->max_video_width, demux->max_video_height,
+        demux->max_video_framerate_n, demux->max_video_framerate_d);
+  } else if (ABS (base_demux->segment.rate) <= 1.0) {
     new_index =
         gst_mpdparser_get_rep_idx_with_max_bandwidth (rep_list, bitrate,
         demux->max_video_width, demux->max_video_height,
@@ -2217,6 +2463,9 @@ gst_dash_demux_stream_select_bitrate (GstAdaptiveDemuxStream * stream,
 
   if (new_index != active_stream->representation_idx) {
     GstRepresentationNode *rep = g_list_nth_data (rep_list, new_index);
+    guint old_bandwidth = active_stream->cur_representation ?
+        active_stream->cur_representation->bandwidth : 0;
+
     GST_INFO_OBJECT (demux, "Changing representation idx: %d %d %u",
         dashstream->index, new_index, rep->bandwidth);
     if (gst_mpd_client_setup_representation (demux->client, active_stream, rep)) {
@@ -2224,8 +2473,18 @@ gst_dash_demux_stream_select_bitrate (GstAdaptiveDemuxStream * stream,
 
       GST_INFO_OBJECT (demux, "Switching bitrate to %d",
           active_stream->cur_representation->bandwidth);
-      caps = gst_dash_demux_get_input_caps (demux, active_stream);
-      gst_adaptive_demux_stream_set_caps (stream, caps);
+      /* Keyframes of the new representation are about as much bigger or
+       * smaller as its bandwidth */
+      if (key_units && old_bandwidth && !adapt_set_changed)
+        dashstream->keyframe_average_size =
+            gst_util_uint64_scale (dashstream->keyframe_average_size,
+            rep->bandwidth, old_bandwidth);
+      /* When outputting samples the caps are updated from the moov of the
+       * new representation */
+      if (!dashstream->output_samples) {
+        caps = gst_dash_demux_get_input_caps (demux, active_stream);
+        gst_adaptive_demux_stream_set_caps (stream, caps);
+      }
       ret = TRUE;
 
     } else {
@@ -2275,6 +2534,15 @@ gst_dash_demux_stream_select_bitrate (GstAdaptiveDemuxStream * stream,
     dashstream->moof_sync_samples = NULL;
     dashstream->current_sync_sample = -1;
     dashstream->target_time = GST_CLOCK_TIME_NONE;
+    gst_dash_demux_stream_clear_samples (dashstream);
+
+    if (adapt_set_changed && GST_CLOCK_TIME_IS_VALID (position)) {
+      dashstream->sidx_position = GST_CLOCK_TIME_NONE;
+      if (gst_dash_demux_stream_seek (stream, base_demux->segment.rate >= 0, 0,
+              position, NULL) != GST_FLOW_OK)
+        GST_WARNING_OBJECT (stream->pad, "Failed to seek to %" GST_TIME_FORMAT
+            " in the new adaptation set", GST_TIME_ARGS (position));
+    }
   }
 
 end:
@@ -2304,6 +2572,15 @@ gst_dash_demux_seek (GstAdaptiveDemux * demux, GstEvent * seek)
   gst_event_parse_seek (seek, &rate, &format, &flags, &start_type, &start,
       &stop_type, &stop);
 
+  /* From the configured rate on, download only keyframes as if the seek had
+   * the TRICKMODE_KEY_UNITS flag. The flag is reset by the next seek */
+  if (dashdemux->trick_mode_key_units_rate > 0.0
+      && dashdemux->allow_trickmode_key_units
+      && ABS (rate) >= dashdemux->trick_mode_key_units_rate) {
+    GST_DEBUG_OBJECT (demux, "Downloading only keyframes at rate %f", rate);
+    demux->segment.flags |= GST_SEGMENT_FLAG_TRICKMODE_KEY_UNITS;
+  }
+
   if (!SEEK_UPDATES_PLAY_POSITION (rate, start_type, stop_type)) {
     /* nothing to do if we don't have to update the current position */
     return TRUE;
@@ -2373,6 +2650,9 @@ gst_dash_demux_seek (GstAdaptiveDemux * demux, GstEvent * seek)
     GstDashDemuxStream *dashstream = iter->data;
 
     dashstream->average_skip_size = 0;
+    /* the seek below positions the stream in the new adaptation set */
+    if (gst_dash_demux_stream_update_adaptation_set (dashdemux, dashstream))
+      stream->need_header = TRUE;
     if (gst_dash_demux_stream_seek (stream, rate >= 0, 0, target_pos,
             NULL) != GST_FLOW_OK)
       return FALSE;
@@ -2538,6 +2818,13 @@ gst_dash_demux_stream_get_fragment_waiting_time (GstAdaptiveDemuxStream *
   if (segmentAvailability) {
     gint64 diff;
     GstDateTime *cur_time;
+    GstClockTime offset = 0;
+
+    /* in low latency mode, request the segment while it is being produced
+     * and consume its chunks as they are sent */
+    if (gst_adaptive_demux_is_low_latency (stream->demux))
+      offset = gst_mpd_client_get_stream_availability_time_offset
+          (active_stream);
 
     cur_time =
         gst_date_time_new_from_g_date_time
@@ -2548,6 +2835,9 @@ gst_dash_demux_stream_get_fragment_waiting_time (GstAdaptiveDemuxStream *
         segmentAvailability);
     gst_date_time_unref (segmentAvailability);
     gst_date_time_unref (cur_time);
+    if (!GST_CLOCK_TIME_IS_VALID (offset))
+      return 0;
+    diff -= offset;
     /* subtract the server's clock drift, so that if the server's
        time is behind our idea of UTC, we need to sleep for longer
        before requesting a fragment */
@@ -2787,6 +3077,256 @@ gst_dash_demux_need_another_chunk (GstAdaptiveDemuxStream * stream)
   return stream->fragment.chunk_size != 0;
 }
 
+static void
+gst_dash_demux_stream_clear_samples (GstDashDemuxStream * dash_stream)
+{
+  if (dash_stream->samples)
+    g_array_free (dash_stream->samples, TRUE);
+  dash_stream->samples = NULL;
+  dash_stream->current_sample = 0;
+  if (dash_stream->sample_adapter)
+    gst_adapter_clear (dash_stream->sample_adapter);
+}
+
+static GstCaps *
+gst_dash_demux_get_sample_entry_caps (GstStsdEntry * entry)
+{
+  GstCaps *caps;
+
+  switch (entry->fourcc) {
+    case GST_ISOFF_FOURCC_AVC1:
+    case GST_ISOFF_FOURCC_AVC3:
+      if (entry->codec_data_fourcc != GST_ISOFF_FOURCC_AVCC)
+        return NULL;
+      caps = gst_caps_new_simple ("video/x-h264",
+          "stream-format", G_TYPE_STRING,
+          entry->fourcc == GST_ISOFF_FOURCC_AVC1 ? "avc" : "avc3",
+          "alignment", G_TYPE_STRING, "au", NULL);
+      break;
+    case GST_ISOFF_FOURCC_HVC1:
+    case GST_ISOFF_FOURCC_HEV1:
+      if (entry->codec_data_fourcc != GST_ISOFF_FOURCC_HVCC)
+        return NULL;
+      caps = gst_caps_new_simple ("video/x-h265",
+          "stream-format", G_TYPE_STRING,
+          entry->fourcc == GST_ISOFF_FOURCC_HVC1 ? "hvc1" : "hev1",
+          "alignment", G_TYPE_STRING, "au", NULL);
+      break;
+    case GST_ISOFF_FOURCC_MP4A:{
+      gint mpegversion;
+
+      if (entry->codec_data_fourcc != GST_ISOFF_FOURCC_ESDS ||
+          entry->codec_data == NULL)
+        return NULL;
+
+      switch (entry->object_type_indication) {
+        case 0x40:
+          mpegversion = 4;
+          break;
+        case 0x66:
+        case 0x67:
+        case 0x68:
+          mpegversion = 2;
+          break;
+        default:
+          return NULL;
+      }
+
+      caps = gst_caps_new_simple ("audio/mpeg",
+          "mpegversion", G_TYPE_INT, mpegversion,
+          "stream-format", G_TYPE_STRING, "raw",
+          "framed", G_TYPE_BOOLEAN, TRUE, NULL);
+      if (entry->sample_rate)
+        gst_caps_set_simple (caps, "rate", G_TYPE_INT, entry->sample_rate,
+            NULL);
+      if (entry->channel_count)
+        gst_caps_set_simple (caps, "channels", G_TYPE_INT,
+            entry->channel_count, NULL);
+      break;
+    }
+    default:
+      /* Includes the encrypted sample entries */
+      return NULL;
+  }
+
+  if (entry->width && entry->height)
+    gst_caps_set_simple (caps, "width", G_TYPE_INT, entry->width,
+        "height", G_TYPE_INT, entry->height, NULL);
+  gst_caps_set_simple (caps, "codec_data", GST_TYPE_BUFFER, entry->codec_data,
+      NULL);
+
+  return caps;
+}
+
+/* Decides from the moov of the current representation if its samples can be
+ * output directly, and sets the caps accordingly */
+static void
+gst_dash_demux_stream_parse_moov (GstDashDemuxStream * dash_stream,
+    GstByteReader * reader)
+{
+  GstAdaptiveDemuxStream *stream = (GstAdaptiveDemuxStream *) dash_stream;
+  GstDashDemux *dashdemux = GST_DASH_DEMUX_CAST (stream->demux);
+  GstMoovBox *moov;
+  GstTrakBox *trak = NULL;
+  GstStsdBox *stsd;
+  GstCaps *caps = NULL;
+  guint i;
+
+  moov = gst_isoff_moov_box_parse (reader);
+  if (moov && moov->trak->len == 1)
+    trak = &g_array_index (moov->trak, GstTrakBox, 0);
+
+  if (trak && trak->mdia.mdhd.timescale != 0) {
+    stsd = &trak->mdia.minf.stbl.stsd;
+    /* Switching sample descriptions inside a representation would need
+     * caps changes per fragment, let qtdemux handle these */
+    if (stsd->entries && stsd->entries->len == 1)
+      caps =
+          gst_dash_demux_get_sample_entry_caps (&g_array_index (stsd->entries,
+              GstStsdEntry, 0));
+  }
+
+  if (caps) {
+    GST_INFO_OBJECT (stream->pad,
+        "Outputting samples of track %u with caps %" GST_PTR_FORMAT,
+        trak->tkhd.track_id, caps);
+
+    dash_stream->track_id = trak->tkhd.track_id;
+    dash_stream->timescale = trak->mdia.mdhd.timescale;
+    dash_stream->has_trex = FALSE;
+    for (i = 0; i < moov->trex->len; i++) {
+      GstTrexBox *trex = &g_array_index (moov->trex, GstTrexBox, i);
+
+      if (trex->track_id == dash_stream->track_id) {
+        dash_stream->trex = *trex;
+        dash_stream->has_trex = TRUE;
+        break;
+      }
+    }
+
+    if (!dash_stream->sample_adapter)
+      dash_stream->sample_adapter = gst_adapter_new ();
+    dash_stream->output_samples = TRUE;
+    gst_adaptive_demux_stream_set_caps (stream, caps);
+  } else {
+    GST_DEBUG_OBJECT (stream->pad,
+        "Can't output the samples of this representation");
+
+    if (dash_stream->output_samples) {
+      dash_stream->output_samples = FALSE;
+      gst_dash_demux_stream_clear_samples (dash_stream);
+      gst_adaptive_demux_stream_set_caps (stream,
+          gst_dash_demux_get_input_caps (dashdemux,
+              dash_stream->active_stream));
+    }
+  }
+
+  if (moov)
+    gst_isoff_moov_box_free (moov);
+}
+
+/* Resolves the samples of the moof we just parsed, called at the start of
+ * its mdat */
+static gboolean
+gst_dash_demux_stream_update_samples (GstDashDemuxStream * dash_stream)
+{
+  gst_dash_demux_stream_clear_samples (dash_stream);
+
+  if (dash_stream->moof == NULL)
+    return FALSE;
+
+  dash_stream->samples =
+      gst_isoff_moof_box_get_samples (dash_stream->moof,
+      dash_stream->moof_offset, dash_stream->track_id,
+      dash_stream->has_trex ? &dash_stream->trex : NULL);
+
+  return dash_stream->samples != NULL;
+}
+
+/* Takes mdat data starting at current_offset and pushes all samples that
+ * are complete. The data of incomplete samples is kept for the next call,
+ * samples whose start was not downloaded (key-units trick mode) are
+ * skipped */
+static GstFlowReturn
+gst_dash_demux_stream_push_samples (GstDashDemuxStream * dash_stream,
+    GstBuffer * buffer)
+{
+  GstAdaptiveDemuxStream *stream = (GstAdaptiveDemuxStream *) dash_stream;
+  GstAdapter *adapter = dash_stream->sample_adapter;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstIsoffSample *sample;
+  guint64 end_offset;
+  gsize available;
+
+  if (dash_stream->sample_offset + gst_adapter_available (adapter) !=
+      dash_stream->current_offset) {
+    gst_adapter_clear (adapter);
+    dash_stream->sample_offset = dash_stream->current_offset;
+  }
+  dash_stream->current_offset += gst_buffer_get_size (buffer);
+  gst_adapter_push (adapter, buffer);
+
+  while (ret == GST_FLOW_OK && dash_stream->samples &&
+      dash_stream->current_sample < dash_stream->samples->len) {
+    GstBuffer *out;
+    gint64 pts;
+
+    sample = &g_array_index (dash_stream->samples, GstIsoffSample,
+        dash_stream->current_sample);
+    available = gst_adapter_available (adapter);
+
+    if (sample->offset < dash_stream->sample_offset || sample->size == 0) {
+      dash_stream->current_sample++;
+      continue;
+    }
+    if (sample->offset + sample->size > dash_stream->sample_offset + available)
+      break;
+
+    gst_adapter_flush (adapter, sample->offset - dash_stream->sample_offset);
+    out = gst_adapter_take_buffer (adapter, sample->size);
+    dash_stream->sample_offset = sample->offset + sample->size;
+    dash_stream->current_sample++;
+
+    pts = (gint64) sample->decode_time + sample->composition_time_offset;
+    GST_BUFFER_DTS (out) =
+        gst_util_uint64_scale (sample->decode_time, GST_SECOND,
+        dash_stream->timescale);
+    GST_BUFFER_PTS (out) =
+        gst_util_uint64_scale (MAX (pts, 0), GST_SECOND,
+        dash_stream->timescale);
+    GST_BUFFER_DURATION (out) =
+        gst_util_uint64_scale (sample->duration, GST_SECOND,
+        dash_stream->timescale);
+    GST_BUFFER_OFFSET (out) = sample->offset;
+    GST_BUFFER_OFFSET_END (out) = sample->offset + sample->size;
+    if (!GST_ISOFF_SAMPLE_IS_SYNC (sample))
+      GST_BUFFER_FLAG_SET (out, GST_BUFFER_FLAG_DELTA_UNIT);
+
+    GST_LOG_OBJECT (stream->pad, "sample #%u size %u pts %" GST_TIME_FORMAT
+        " dts %" GST_TIME_FORMAT, dash_stream->current_sample - 1,
+        sample->size, GST_TIME_ARGS (GST_BUFFER_PTS (out)),
+        GST_TIME_ARGS (GST_BUFFER_DTS (out)));
+
+    ret = gst_adaptive_demux_stream_push_timestamped_buffer (stream, out);
+  }
+
+  /* Drop everything before the next sample */
+  available = gst_adapter_available (adapter);
+  end_offset = dash_stream->sample_offset + available;
+  if (dash_stream->samples &&
+      dash_stream->current_sample < dash_stream->samples->len) {
+    sample = &g_array_index (dash_stream->samples, GstIsoffSample,
+        dash_stream->current_sample);
+    end_offset = MIN (end_offset, sample->offset);
+  }
+  if (end_offset > dash_stream->sample_offset) {
+    gst_adapter_flush (adapter, end_offset - dash_stream->sample_offset);
+    dash_stream->sample_offset = end_offset;
+  }
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_dash_demux_parse_isobmff (GstAdaptiveDemux * demux,
     GstDashDemuxStream * dash_stream, gboolean * sidx_seek_needed)
@@ -2884,6 +3424,12 @@ gst_dash_demux_parse_isobmff (GstAdaptiveDemux * demux,
       } else {
         dash_stream->moof_average_size = size;
       }
+    } else if (dash_stream->isobmff_parser.current_fourcc ==
+        GST_ISOFF_FOURCC_MOOV && dashdemux->elementary_streams) {
+      GstByteReader sub_reader;
+
+      gst_byte_reader_get_sub_reader (&reader, &sub_reader, size - header_size);
+      gst_dash_demux_stream_parse_moov (dash_stream, &sub_reader);
     } else if (dash_stream->isobmff_parser.current_fourcc ==
         GST_ISOFF_FOURCC_SIDX &&
         gst_mpd_client_has_isoff_ondemand_profile (dashdemux->client) &&
@@ -2991,8 +3537,20 @@ gst_dash_demux_parse_isobmff (GstAdaptiveDemux * demux,
     pending = _gst_buffer_split (buffer, gst_byte_reader_get_pos (&reader), -1);
     gst_adapter_push (dash_stream->adapter, pending);
     dash_stream->current_offset += gst_byte_reader_get_pos (&reader);
+    if (dash_stream->isobmff_parser.current_size == -1)
+      dash_stream->mdat_end_offset = G_MAXUINT64;
+    else
+      dash_stream->mdat_end_offset =
+          dash_stream->isobmff_parser.current_start_offset +
+          dash_stream->isobmff_parser.current_size;
     dash_stream->isobmff_parser.current_size = 0;
 
+    /* The boxes are not needed downstream when outputting samples */
+    if (dash_stream->output_samples) {
+      gst_buffer_unref (buffer);
+      return GST_FLOW_OK;
+    }
+
     GST_BUFFER_OFFSET (buffer) = buffer_offset;
     GST_BUFFER_OFFSET_END (buffer) =
         buffer_offset + gst_buffer_get_size (buffer);
@@ -3008,6 +3566,11 @@ gst_dash_demux_parse_isobmff (GstAdaptiveDemux * demux,
     dash_stream->current_offset += gst_byte_reader_get_pos (&reader);
     dash_stream->isobmff_parser.current_size = 0;
 
+    if (dash_stream->output_samples) {
+      gst_buffer_unref (buffer);
+      return GST_FLOW_OK;
+    }
+
     GST_BUFFER_OFFSET (buffer) = buffer_offset;
     GST_BUFFER_OFFSET_END (buffer) =
         buffer_offset + gst_buffer_get_size (buffer);
@@ -3284,6 +3847,13 @@ gst_dash_demux_handle_isobmff (GstAdaptiveDemux * demux,
 
     /* Here we end up only if we're right at the mdat start */
 
+    if (dash_stream->output_samples &&
+        !gst_dash_demux_stream_update_samples (dash_stream)) {
+      GST_ELEMENT_ERROR (demux, STREAM, DEMUX, (NULL),
+          ("Can't find the samples of the fragment"));
+      return GST_FLOW_ERROR;
+    }
+
     /* Jump to the next sync sample. As we're doing chunked downloading
      * here, just drop data until our chunk is over so we can reuse the
      * HTTP connection instead of having to create a new one or
@@ -3360,10 +3930,16 @@ gst_dash_demux_handle_isobmff (GstAdaptiveDemux * demux,
       }
     }
   } else {
+    gsize available = gst_adapter_available (dash_stream->adapter);
+
+    /* When outputting samples stop at the end of the mdat, there might be
+     * another moof in this fragment */
+    if (dash_stream->output_samples &&
+        dash_stream->current_offset + available > dash_stream->mdat_end_offset)
+      available = dash_stream->mdat_end_offset - dash_stream->current_offset;
+
     /* Take it all and handle it further below */
-    buffer =
-        gst_adapter_take_buffer (dash_stream->adapter,
-        gst_adapter_available (dash_stream->adapter));
+    buffer = gst_adapter_take_buffer (dash_stream->adapter, available);
 
     /* Attention: All code paths below need to update dash_stream->current_offset */
   }
@@ -3402,11 +3978,15 @@ gst_dash_demux_handle_isobmff (GstAdaptiveDemux * demux,
     }
   }
 
-  GST_BUFFER_OFFSET (buffer) = dash_stream->current_offset;
-  dash_stream->current_offset += gst_buffer_get_size (buffer);
-  GST_BUFFER_OFFSET_END (buffer) = dash_stream->current_offset;
+  if (dash_stream->output_samples) {
+    ret = gst_dash_demux_stream_push_samples (dash_stream, buffer);
+  } else {
+    GST_BUFFER_OFFSET (buffer) = dash_stream->current_offset;
+    dash_stream->current_offset += gst_buffer_get_size (buffer);
+    GST_BUFFER_OFFSET_END (buffer) = dash_stream->current_offset;
 
-  ret = gst_adaptive_demux_stream_push_buffer (stream, buffer);
+    ret = gst_adaptive_demux_stream_push_buffer (stream, buffer);
+  }
   if (ret != GST_FLOW_OK)
     return ret;
 
@@ -3418,6 +3998,26 @@ gst_dash_demux_handle_isobmff (GstAdaptiveDemux * demux,
       return ret;
 
     /* If we still have data available, recurse and use it up if possible */
+    if (gst_adapter_available (dash_stream->adapter) > 0)
+      return gst_dash_demux_handle_isobmff (demux, stream);
+  } else if (dash_stream->output_samples &&
+      dash_stream->isobmff_parser.current_fourcc == GST_ISOFF_FOURCC_MDAT &&
+      dash_stream->current_offset >= dash_stream->mdat_end_offset) {
+    /* End of the mdat, parse the next moof of this fragment if any */
+    dash_stream->isobmff_parser.current_fourcc = 0;
+    dash_stream->isobmff_parser.current_start_offset =
+        dash_stream->current_offset;
+    dash_stream->isobmff_parser.current_size = 0;
+
+    if (dash_stream->moof)
+      gst_isoff_moof_box_free (dash_stream->moof);
+    dash_stream->moof = NULL;
+    if (dash_stream->moof_sync_samples)
+      g_array_free (dash_stream->moof_sync_samples, TRUE);
+    dash_stream->moof_sync_samples = NULL;
+    dash_stream->current_sync_sample = -1;
+    gst_dash_demux_stream_clear_samples (dash_stream);
+
     if (gst_adapter_available (dash_stream->adapter) > 0)
       return gst_dash_demux_handle_isobmff (demux, stream);
   }
@@ -3546,6 +4146,10 @@ gst_dash_demux_stream_free (GstAdaptiveDemuxStream * stream)
     gst_isoff_moof_box_free (dash_stream->moof);
   if (dash_stream->moof_sync_samples)
     g_array_free (dash_stream->moof_sync_samples, TRUE);
+  if (dash_stream->samples)
+    g_array_free (dash_stream->samples, TRUE);
+  if (dash_stream->sample_adapter)
+    g_object_unref (dash_stream->sample_adapter);
 }
 
 static GstDashDemuxClockDrift *
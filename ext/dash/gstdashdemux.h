@@ -112,6 +112,20 @@ struct _GstDashDemuxStream
   GstClockTime target_time;
   /* Average skip-ahead time (only in trickmode-key-units) */
   GstClockTime average_skip_size;
+
+  /* Elementary stream output, the samples of the current moof are cut out of
+   * the mdat instead of pushing the fragments */
+  gboolean output_samples;
+  guint32 track_id;
+  guint32 timescale;
+  GstTrexBox trex;
+  gboolean has_trex;
+  guint64 mdat_end_offset;
+  GArray *samples;
+  guint current_sample;
+  /* mdat data not output yet and the offset of its first byte */
+  GstAdapter *sample_adapter;
+  guint64 sample_offset;
 };
 
 /**
@@ -139,6 +153,8 @@ struct _GstDashDemux
   gint max_video_width, max_video_height;
   gint max_video_framerate_n, max_video_framerate_d;
   gchar* default_presentation_delay; /* presentation time delay if MPD@suggestedPresentationDelay is not present */
+  gboolean elementary_streams;  /* output the samples of fragmented MP4 */
+  gdouble trick_mode_key_units_rate; /* rate from which only keyframes are downloaded */
 
   gint n_audio_streams;
   gint n_video_streams;
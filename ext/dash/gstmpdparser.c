@@ -1485,6 +1485,7 @@ gst_mpdparser_parse_seg_base_type_ext (GstSegmentBaseType ** pointer,
   guint intval;
   guint64 int64val;
   gboolean boolval;
+  gdouble doubleval;
   GstRange *rangeval;
 
   gst_mpdparser_free_seg_base_type_ext (*pointer);
@@ -1493,6 +1494,7 @@ gst_mpdparser_parse_seg_base_type_ext (GstSegmentBaseType ** pointer,
   /* Initialize values that have defaults */
   seg_base_type->indexRangeExact = FALSE;
   seg_base_type->timescale = 1;
+  seg_base_type->availabilityTimeComplete = TRUE;
 
   /* Inherit attribute values from parent */
   if (parent) {
@@ -1500,6 +1502,9 @@ gst_mpdparser_parse_seg_base_type_ext (GstSegmentBaseType ** pointer,
     seg_base_type->presentationTimeOffset = parent->presentationTimeOffset;
     seg_base_type->indexRange = gst_mpdparser_clone_range (parent->indexRange);
     seg_base_type->indexRangeExact = parent->indexRangeExact;
+    seg_base_type->availabilityTimeOffset = parent->availabilityTimeOffset;
+    seg_base_type->availabilityTimeComplete =
+        parent->availabilityTimeComplete;
     seg_base_type->Initialization =
         gst_mpdparser_clone_URL (parent->Initialization);
     seg_base_type->RepresentationIndex =
@@ -1527,6 +1532,14 @@ gst_mpdparser_parse_seg_base_type_ext (GstSegmentBaseType ** pointer,
           FALSE, &boolval)) {
     seg_base_type->indexRangeExact = boolval;
   }
+  if (gst_mpdparser_get_xml_prop_double (a_node, "availabilityTimeOffset",
+          &doubleval)) {
+    seg_base_type->availabilityTimeOffset = doubleval;
+  }
+  if (gst_mpdparser_get_xml_prop_boolean (a_node, "availabilityTimeComplete",
+          TRUE, &boolval)) {
+    seg_base_type->availabilityTimeComplete = boolval;
+  }
 
   /* explore children nodes */
   for (cur_node = a_node->children; cur_node; cur_node = cur_node->next) {
@@ -1871,6 +1884,14 @@ gst_mpdparser_parse_representation_base_type (GstRepresentationBaseType **
               (xmlChar *) "ContentProtection") == 0) {
         gst_mpdparser_parse_content_protection_node
             (&representation_base->ContentProtection, cur_node);
+      } else if (xmlStrcmp (cur_node->name,
+              (xmlChar *) "EssentialProperty") == 0) {
+        gst_mpdparser_parse_descriptor_type_node
+            (&representation_base->EssentialProperty, cur_node);
+      } else if (xmlStrcmp (cur_node->name,
+              (xmlChar *) "SupplementalProperty") == 0) {
+        gst_mpdparser_parse_descriptor_type_node
+            (&representation_base->SupplementalProperty, cur_node);
       }
     }
   }
@@ -2903,6 +2924,10 @@ gst_mpdparser_free_representation_base_type (GstRepresentationBaseType *
         (GDestroyNotify) gst_mpdparser_free_descriptor_type_node);
     g_list_free_full (representation_base->ContentProtection,
         (GDestroyNotify) gst_mpdparser_free_descriptor_type_node);
+    g_list_free_full (representation_base->EssentialProperty,
+        (GDestroyNotify) gst_mpdparser_free_descriptor_type_node);
+    g_list_free_full (representation_base->SupplementalProperty,
+        (GDestroyNotify) gst_mpdparser_free_descriptor_type_node);
     g_slice_free (GstRepresentationBaseType, representation_base);
   }
 }
@@ -4746,6 +4771,176 @@ gst_mpd_client_get_adaptation_sets (GstMpdClient * client)
   return gst_mpd_client_get_adaptation_sets_for_period (client, stream_period);
 }
 
+/* Returns the trick mode descriptor of an AdaptationSet, if any. Trick mode
+ * AdaptationSets signalled with an EssentialProperty must not be used for
+ * normal playback */
+static GstDescriptorType *
+gst_mpdparser_get_trickmode_descriptor (GstAdaptationSetNode * adapt_set,
+    gboolean * essential)
+{
+  GstRepresentationBaseType *base = adapt_set->RepresentationBase;
+  GList *list;
+
+  if (base == NULL)
+    return NULL;
+
+  for (list = base->EssentialProperty; list; list = g_list_next (list)) {
+    GstDescriptorType *descriptor = list->data;
+
+    if (g_strcmp0 (descriptor->schemeIdUri,
+            GST_MPD_TRICKMODE_SCHEME_ID_URI) == 0) {
+      if (essential)
+        *essential = TRUE;
+      return descriptor;
+    }
+  }
+
+  for (list = base->SupplementalProperty; list; list = g_list_next (list)) {
+    GstDescriptorType *descriptor = list->data;
+
+    if (g_strcmp0 (descriptor->schemeIdUri,
+            GST_MPD_TRICKMODE_SCHEME_ID_URI) == 0) {
+      if (essential)
+        *essential = FALSE;
+      return descriptor;
+    }
+  }
+
+  return NULL;
+}
+
+/* The descriptor value is a whitespace separated list of AdaptationSet ids */
+static gboolean
+gst_mpdparser_trickmode_descriptor_has_id (GstDescriptorType * descriptor,
+    guint id)
+{
+  gchar **ids;
+  gboolean ret = FALSE;
+  guint i;
+
+  if (descriptor->value == NULL)
+    return FALSE;
+
+  ids = g_strsplit_set (descriptor->value, " \t\n", -1);
+  for (i = 0; ids[i] && !ret; i++) {
+    guint64 value;
+    gchar *end;
+
+    if (ids[i][0] == '\0')
+      continue;
+
+    value = g_ascii_strtoull (ids[i], &end, 10);
+    ret = (*end == '\0' && value == id);
+  }
+  g_strfreev (ids);
+
+  return ret;
+}
+
+gboolean
+gst_mpd_client_adaptation_set_is_trickmode_only (GstAdaptationSetNode *
+    adapt_set)
+{
+  gboolean essential = FALSE;
+
+  g_return_val_if_fail (adapt_set != NULL, FALSE);
+
+  return gst_mpdparser_get_trickmode_descriptor (adapt_set, &essential)
+      && essential;
+}
+
+GstAdaptationSetNode *
+gst_mpd_client_get_trickmode_adaptation_set (GstMpdClient * client,
+    GstAdaptationSetNode * adapt_set)
+{
+  GList *list;
+
+  g_return_val_if_fail (adapt_set != NULL, NULL);
+
+  /* a trick mode AdaptationSet has no trick mode AdaptationSet itself */
+  if (gst_mpdparser_get_trickmode_descriptor (adapt_set, NULL))
+    return NULL;
+
+  for (list = gst_mpd_client_get_adaptation_sets (client); list;
+      list = g_list_next (list)) {
+    GstAdaptationSetNode *trick_set = list->data;
+    GstDescriptorType *descriptor;
+
+    if (trick_set == adapt_set || trick_set->Representations == NULL)
+      continue;
+
+    descriptor = gst_mpdparser_get_trickmode_descriptor (trick_set, NULL);
+    if (descriptor
+        && gst_mpdparser_trickmode_descriptor_has_id (descriptor,
+            adapt_set->id))
+      return trick_set;
+  }
+
+  return NULL;
+}
+
+GstAdaptationSetNode *
+gst_mpd_client_get_trickmode_main_adaptation_set (GstMpdClient * client,
+    GstAdaptationSetNode * adapt_set)
+{
+  GstDescriptorType *descriptor;
+  GList *list;
+
+  g_return_val_if_fail (adapt_set != NULL, NULL);
+
+  descriptor = gst_mpdparser_get_trickmode_descriptor (adapt_set, NULL);
+  if (descriptor == NULL)
+    return NULL;
+
+  for (list = gst_mpd_client_get_adaptation_sets (client); list;
+      list = g_list_next (list)) {
+    GstAdaptationSetNode *main_set = list->data;
+
+    if (main_set != adapt_set && main_set->Representations != NULL
+        && gst_mpdparser_trickmode_descriptor_has_id (descriptor,
+            main_set->id))
+      return main_set;
+  }
+
+  return NULL;
+}
+
+/* Switches an active stream to the lowest representation of another
+ * AdaptationSet. The segment position is kept as is, the caller has to seek
+ * the stream again as the segments of both sets might not be aligned */
+gboolean
+gst_mpd_client_setup_adaptation_set (GstMpdClient * client,
+    GstActiveStream * stream, GstAdaptationSetNode * adapt_set)
+{
+  GstAdaptationSetNode *old_adapt_set;
+  GstRepresentationNode *representation, *old_representation;
+
+  g_return_val_if_fail (stream != NULL, FALSE);
+  g_return_val_if_fail (adapt_set != NULL, FALSE);
+
+  representation =
+      gst_mpdparser_get_lowest_representation (adapt_set->Representations);
+  if (!representation) {
+    GST_WARNING ("No valid representation in the AdaptationSet");
+    return FALSE;
+  }
+
+  old_adapt_set = stream->cur_adapt_set;
+  old_representation = stream->cur_representation;
+
+  stream->cur_adapt_set = adapt_set;
+  if (!gst_mpd_client_setup_representation (client, stream, representation)) {
+    GST_WARNING ("Failed to setup the representation of AdaptationSet %u",
+        adapt_set->id);
+    stream->cur_adapt_set = old_adapt_set;
+    if (old_representation)
+      gst_mpd_client_setup_representation (client, stream, old_representation);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 gboolean
 gst_mpd_client_setup_streaming (GstMpdClient * client,
     GstAdaptationSetNode * adapt_set)
@@ -6043,6 +6238,35 @@ gst_mpd_client_get_next_segment_availability_start_time (GstMpdClient * client,
   return rv;
 }
 
+/* Returns how long before their availability start time the segments of the
+ * stream can be requested, GST_CLOCK_TIME_NONE if they can always be. If
+ * availabilityTimeComplete is false, such early segments are still being
+ * produced and are only complete at their availability start time */
+GstClockTime
+gst_mpd_client_get_stream_availability_time_offset (GstActiveStream * stream)
+{
+  GstSegmentBaseType *segbase = NULL;
+
+  g_return_val_if_fail (stream != NULL, 0);
+
+  if (stream->cur_segment_list) {
+    segbase = stream->cur_segment_list->MultSegBaseType->SegBaseType;
+  } else if (stream->cur_seg_template) {
+    segbase = stream->cur_seg_template->MultSegBaseType->SegBaseType;
+  } else if (stream->cur_segment_base) {
+    segbase = stream->cur_segment_base;
+  }
+
+  if (segbase == NULL || !(segbase->availabilityTimeOffset > 0))
+    return 0;
+
+  /* "INF", or more than any live segment could be early */
+  if (segbase->availabilityTimeOffset >= G_MAXUINT32)
+    return GST_CLOCK_TIME_NONE;
+
+  return segbase->availabilityTimeOffset * GST_SECOND;
+}
+
 gboolean
 gst_mpd_client_seek_to_time (GstMpdClient * client, GDateTime * time)
 {
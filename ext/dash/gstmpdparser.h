@@ -70,6 +70,10 @@ typedef struct _GstMultSegmentBaseType    GstMultSegmentBaseType;
 
 #define GST_MPD_DURATION_NONE ((guint64)-1)
 
+/* DASH-IF IOP trick mode AdaptationSet descriptor, the value is the id of
+ * the main AdaptationSet */
+#define GST_MPD_TRICKMODE_SCHEME_ID_URI "http://dashif.org/guidelines/trickmode"
+
 typedef enum
 {
   GST_STREAM_UNKNOWN,
@@ -169,6 +173,8 @@ struct _GstSegmentBaseType
   guint64 presentationTimeOffset;
   GstRange *indexRange;
   gboolean indexRangeExact;
+  gdouble availabilityTimeOffset;   /* in seconds, may be infinite */
+  gboolean availabilityTimeComplete;
   /* Initialization node */
   GstURLType *Initialization;
   /* RepresentationIndex node */
@@ -240,6 +246,10 @@ struct _GstRepresentationBaseType
   GList *AudioChannelConfiguration;
   /* list of ContentProtection DescriptorType nodes */
   GList *ContentProtection;
+  /* list of EssentialProperty DescriptorType nodes */
+  GList *EssentialProperty;
+  /* list of SupplementalProperty DescriptorType nodes */
+  GList *SupplementalProperty;
 };
 
 struct _GstSubRepresentationNode
@@ -576,12 +586,17 @@ gboolean gst_mpd_client_active_stream_contains_subtitles (GstActiveStream * stre
 /* AdaptationSet */
 guint gst_mpdparser_get_nb_adaptationSet (GstMpdClient *client);
 GList * gst_mpd_client_get_adaptation_sets (GstMpdClient * client);
+gboolean gst_mpd_client_adaptation_set_is_trickmode_only (GstAdaptationSetNode * adapt_set);
+GstAdaptationSetNode * gst_mpd_client_get_trickmode_adaptation_set (GstMpdClient * client, GstAdaptationSetNode * adapt_set);
+GstAdaptationSetNode * gst_mpd_client_get_trickmode_main_adaptation_set (GstMpdClient * client, GstAdaptationSetNode * adapt_set);
+gboolean gst_mpd_client_setup_adaptation_set (GstMpdClient * client, GstActiveStream * stream, GstAdaptationSetNode * adapt_set);
 
 /* Segment */
 gboolean gst_mpd_client_has_next_segment (GstMpdClient * client, GstActiveStream * stream, gboolean forward);
 GstFlowReturn gst_mpd_client_advance_segment (GstMpdClient * client, GstActiveStream * stream, gboolean forward);
 void gst_mpd_client_seek_to_first_segment (GstMpdClient * client);
 GstDateTime *gst_mpd_client_get_next_segment_availability_start_time (GstMpdClient * client, GstActiveStream * stream);
+GstClockTime gst_mpd_client_get_stream_availability_time_offset (GstActiveStream * stream);
 
 /* Get audio/video stream parameters (caps, width, height, rate, number of channels) */
 GstCaps * gst_mpd_client_get_stream_caps (GstActiveStream * stream);
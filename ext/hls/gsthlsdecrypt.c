@@ -0,0 +1,285 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * gsthlsdecrypt.c:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gsthlsdecrypt.h"
+
+/* The backends use the AES instructions of the CPU when available, and
+ * decrypt several CBC blocks in parallel when given more than one at once:
+ * unlike encryption, decrypting a block does not depend on the result of
+ * the previous one. The buffers are thus decrypted in a single call, in
+ * place. */
+
+#if defined(HAVE_OPENSSL)
+static gboolean
+decrypt_start (GstHLSDecrypt * decrypt, const guint8 * key_data,
+    const guint8 * iv_data)
+{
+  EVP_CIPHER_CTX *ctx;
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  EVP_CIPHER_CTX_init (&decrypt->aes_ctx);
+  ctx = &decrypt->aes_ctx;
+#else
+  decrypt->aes_ctx = EVP_CIPHER_CTX_new ();
+  ctx = decrypt->aes_ctx;
+#endif
+  if (!EVP_DecryptInit_ex (ctx, EVP_aes_128_cbc (), NULL, key_data, iv_data))
+    return FALSE;
+  EVP_CIPHER_CTX_set_padding (ctx, 0);
+  return TRUE;
+}
+
+static gboolean
+decrypt_blocks (GstHLSDecrypt * decrypt, gsize length,
+    const guint8 * encrypted_data, guint8 * decrypted_data)
+{
+  int len;
+  EVP_CIPHER_CTX *ctx;
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  ctx = &decrypt->aes_ctx;
+#else
+  ctx = decrypt->aes_ctx;
+#endif
+
+  if (G_UNLIKELY (length > G_MAXINT || length % 16 != 0))
+    return FALSE;
+
+  /* without padding, the whole input is output right away, the context
+   * keeps the last block as IV for the next call */
+  len = (int) length;
+  if (!EVP_DecryptUpdate (ctx, decrypted_data, &len, encrypted_data, len))
+    return FALSE;
+  return (gsize) len == length;
+}
+
+static void
+decrypt_end (GstHLSDecrypt * decrypt)
+{
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  EVP_CIPHER_CTX_cleanup (&decrypt->aes_ctx);
+#else
+  EVP_CIPHER_CTX_free (decrypt->aes_ctx);
+  decrypt->aes_ctx = NULL;
+#endif
+}
+
+#elif defined(HAVE_NETTLE)
+static gboolean
+decrypt_start (GstHLSDecrypt * decrypt, const guint8 * key_data,
+    const guint8 * iv_data)
+{
+  aes_set_decrypt_key (&decrypt->aes_ctx.ctx, 16, key_data);
+  CBC_SET_IV (&decrypt->aes_ctx, iv_data);
+
+  return TRUE;
+}
+
+static gboolean
+decrypt_blocks (GstHLSDecrypt * decrypt, gsize length,
+    const guint8 * encrypted_data, guint8 * decrypted_data)
+{
+  if (length % 16 != 0)
+    return FALSE;
+
+  /* cbc_decrypt() supports decrypting in place */
+  CBC_DECRYPT (&decrypt->aes_ctx, aes_decrypt, length, decrypted_data,
+      encrypted_data);
+
+  return TRUE;
+}
+
+static void
+decrypt_end (GstHLSDecrypt * decrypt)
+{
+  /* NOP */
+}
+
+#else
+static gboolean
+decrypt_start (GstHLSDecrypt * decrypt, const guint8 * key_data,
+    const guint8 * iv_data)
+{
+  gcry_error_t err = 0;
+  gboolean ret = FALSE;
+
+  err =
+      gcry_cipher_open (&decrypt->aes_ctx, GCRY_CIPHER_AES128,
+      GCRY_CIPHER_MODE_CBC, 0);
+  if (err)
+    goto out;
+  err = gcry_cipher_setkey (decrypt->aes_ctx, key_data, 16);
+  if (err)
+    goto out;
+  err = gcry_cipher_setiv (decrypt->aes_ctx, iv_data, 16);
+  if (!err)
+    ret = TRUE;
+
+out:
+  if (!ret && decrypt->aes_ctx) {
+    gcry_cipher_close (decrypt->aes_ctx);
+    decrypt->aes_ctx = NULL;
+  }
+
+  return ret;
+}
+
+static gboolean
+decrypt_blocks (GstHLSDecrypt * decrypt, gsize length,
+    const guint8 * encrypted_data, guint8 * decrypted_data)
+{
+  gcry_error_t err = 0;
+
+  /* in place when no input is given */
+  if (encrypted_data == decrypted_data)
+    err = gcry_cipher_decrypt (decrypt->aes_ctx, decrypted_data, length,
+        NULL, 0);
+  else
+    err = gcry_cipher_decrypt (decrypt->aes_ctx, decrypted_data, length,
+        encrypted_data, length);
+
+  return err == 0;
+}
+
+static void
+decrypt_end (GstHLSDecrypt * decrypt)
+{
+  if (decrypt->aes_ctx) {
+    gcry_cipher_close (decrypt->aes_ctx);
+    decrypt->aes_ctx = NULL;
+  }
+}
+#endif
+
+gboolean
+gst_hls_decrypt_start (GstHLSDecrypt * decrypt, const guint8 * key_data,
+    const guint8 * iv_data)
+{
+  gst_hls_decrypt_end (decrypt);
+
+  if (!decrypt_start (decrypt, key_data, iv_data)) {
+    decrypt_end (decrypt);
+    return FALSE;
+  }
+
+  decrypt->started = TRUE;
+  return TRUE;
+}
+
+/* Decrypts the complete blocks of @encrypted, reusing its memory for the
+ * output when possible. The bytes left after the last complete block are
+ * kept and decrypted with the next buffer. Takes ownership of @encrypted,
+ * @decrypted is set to %NULL if no block could be completed. */
+gboolean
+gst_hls_decrypt_buffer (GstHLSDecrypt * decrypt, GstBuffer * encrypted,
+    GstBuffer ** decrypted)
+{
+  GstBuffer *block = NULL;
+  GstMapInfo info;
+  gsize size, offset = 0, tail;
+  gboolean ret;
+
+  g_return_val_if_fail (decrypt->started, FALSE);
+
+  *decrypted = NULL;
+  size = gst_buffer_get_size (encrypted);
+
+  /* first complete the block started by the previous buffer */
+  if (decrypt->partial_block_len > 0) {
+    offset = gst_buffer_extract (encrypted, 0,
+        decrypt->partial_block + decrypt->partial_block_len,
+        GST_HLS_DECRYPT_BLOCK_SIZE - decrypt->partial_block_len);
+    decrypt->partial_block_len += offset;
+    if (decrypt->partial_block_len < GST_HLS_DECRYPT_BLOCK_SIZE) {
+      gst_buffer_unref (encrypted);
+      return TRUE;
+    }
+
+    block = gst_buffer_new_allocate (NULL, GST_HLS_DECRYPT_BLOCK_SIZE, NULL);
+    gst_buffer_map (block, &info, GST_MAP_WRITE);
+    ret = decrypt_blocks (decrypt, GST_HLS_DECRYPT_BLOCK_SIZE,
+        decrypt->partial_block, info.data);
+    gst_buffer_unmap (block, &info);
+    decrypt->partial_block_len = 0;
+    if (!ret)
+      goto error;
+  }
+
+  tail = (size - offset) % GST_HLS_DECRYPT_BLOCK_SIZE;
+  if (tail > 0) {
+    gst_buffer_extract (encrypted, size - tail, decrypt->partial_block, tail);
+    decrypt->partial_block_len = tail;
+  }
+
+  if (size - offset - tail == 0) {
+    gst_buffer_unref (encrypted);
+    *decrypted = block;
+    return TRUE;
+  }
+
+  /* Mapping copies the memory only if it is shared */
+  encrypted = gst_buffer_make_writable (encrypted);
+  if (offset > 0 || tail > 0)
+    gst_buffer_resize (encrypted, offset, size - offset - tail);
+  if (!gst_buffer_map (encrypted, &info, GST_MAP_READWRITE))
+    goto error;
+  ret = decrypt_blocks (decrypt, info.size, info.data, info.data);
+  gst_buffer_unmap (encrypted, &info);
+  if (!ret)
+    goto error;
+
+  *decrypted = block ? gst_buffer_append (block, encrypted) : encrypted;
+  return TRUE;
+
+error:
+  gst_buffer_unref (encrypted);
+  if (block)
+    gst_buffer_unref (block);
+  return FALSE;
+}
+
+void
+gst_hls_decrypt_end (GstHLSDecrypt * decrypt)
+{
+  if (decrypt->started)
+    decrypt_end (decrypt);
+  decrypt->started = FALSE;
+  decrypt->partial_block_len = 0;
+}
+
+/* Removes the PKCS#7 padding from the last buffer of a segment, which must be
+ * writable */
+gboolean
+gst_hls_decrypt_unpad (GstBuffer * buffer)
+{
+  gsize size = gst_buffer_get_size (buffer);
+  guint8 padding;
+
+  if (size == 0 || gst_buffer_extract (buffer, size - 1, &padding, 1) != 1)
+    return FALSE;
+  if (padding == 0 || padding > GST_HLS_DECRYPT_BLOCK_SIZE || padding > size)
+    return FALSE;
+
+  gst_buffer_resize (buffer, 0, size - padding);
+  return TRUE;
+}
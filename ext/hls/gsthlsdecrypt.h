@@ -0,0 +1,80 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * gsthlsdecrypt.h:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_HLS_DECRYPT_H__
+#define __GST_HLS_DECRYPT_H__
+
+#include <gst/gst.h>
+#if defined(HAVE_OPENSSL)
+#include <openssl/evp.h>
+#elif defined(HAVE_NETTLE)
+#include <nettle/aes.h>
+#include <nettle/cbc.h>
+#else
+#include <gcrypt.h>
+#endif
+
+G_BEGIN_DECLS
+
+#define GST_HLS_DECRYPT_BLOCK_SIZE 16
+
+typedef struct _GstHLSDecrypt GstHLSDecrypt;
+
+/* AES-128-CBC decryption of a segment received in arbitrarily sized
+ * buffers. The CBC chain is kept across the buffers, the bytes of an
+ * incomplete block are kept until the next buffer completes it. */
+struct _GstHLSDecrypt
+{
+  gboolean started;
+
+#if defined(HAVE_OPENSSL)
+# if OPENSSL_VERSION_NUMBER < 0x10100000L
+  EVP_CIPHER_CTX aes_ctx;
+# else
+  EVP_CIPHER_CTX *aes_ctx;
+# endif
+#elif defined(HAVE_NETTLE)
+  struct CBC_CTX (struct aes_ctx, AES_BLOCK_SIZE) aes_ctx;
+#else
+  gcry_cipher_hd_t aes_ctx;
+#endif
+
+  guint8 partial_block[GST_HLS_DECRYPT_BLOCK_SIZE];
+  guint partial_block_len;
+};
+
+G_GNUC_INTERNAL
+gboolean gst_hls_decrypt_start (GstHLSDecrypt * decrypt,
+    const guint8 * key_data, const guint8 * iv_data);
+
+G_GNUC_INTERNAL
+gboolean gst_hls_decrypt_buffer (GstHLSDecrypt * decrypt,
+    GstBuffer * encrypted, GstBuffer ** decrypted);
+
+G_GNUC_INTERNAL
+void gst_hls_decrypt_end (GstHLSDecrypt * decrypt);
+
+G_GNUC_INTERNAL
+gboolean gst_hls_decrypt_unpad (GstBuffer * buffer);
+
+G_END_DECLS
+
+#endif /* __GST_HLS_DECRYPT_H__ */
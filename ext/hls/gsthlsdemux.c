@@ -75,12 +75,6 @@ static gchar *gst_hls_src_buf_to_utf8_playlist (GstBuffer * buf);
 
 static gboolean gst_hls_demux_change_playlist (GstHLSDemux * demux,
     guint max_bitrate, gboolean * changed);
-static GstBuffer *gst_hls_demux_decrypt_fragment (GstHLSDemux * demux,
-    GstHLSDemuxStream * stream, GstBuffer * encrypted_buffer, GError ** err);
-static gboolean
-gst_hls_demux_stream_decrypt_start (GstHLSDemuxStream * stream,
-    const guint8 * key_data, const guint8 * iv_data);
-static void gst_hls_demux_stream_decrypt_end (GstHLSDemuxStream * stream);
 
 static gboolean gst_hls_demux_is_live (GstAdaptiveDemux * demux);
 static GstClockTime gst_hls_demux_get_duration (GstAdaptiveDemux * demux);
@@ -252,13 +246,11 @@ gst_hls_demux_get_bitrate (GstHLSDemux * hlsdemux)
 static void
 gst_hls_demux_stream_clear_pending_data (GstHLSDemuxStream * hls_stream)
 {
-  if (hls_stream->pending_encrypted_data)
-    gst_adapter_clear (hls_stream->pending_encrypted_data);
   gst_buffer_replace (&hls_stream->pending_decrypted_buffer, NULL);
   gst_buffer_replace (&hls_stream->pending_typefind_buffer, NULL);
   gst_buffer_replace (&hls_stream->pending_pcr_buffer, NULL);
   hls_stream->current_offset = -1;
-  gst_hls_demux_stream_decrypt_end (hls_stream);
+  gst_hls_decrypt_end (&hls_stream->decrypt);
 }
 
 static void
@@ -769,8 +761,9 @@ gst_hls_demux_start_fragment (GstAdaptiveDemux * demux,
   if (key == NULL)
     goto key_failed;
 
-  gst_hls_demux_stream_decrypt_start (hls_stream, key->data,
-      hls_stream->current_iv);
+  if (!gst_hls_decrypt_start (&hls_stream->decrypt, key->data,
+          hls_stream->current_iv))
+    goto key_failed;
 
   return TRUE;
 
@@ -901,23 +894,14 @@ gst_hls_demux_finish_fragment (GstAdaptiveDemux * demux,
   GstFlowReturn ret = GST_FLOW_OK;
 
   if (hls_stream->current_key)
-    gst_hls_demux_stream_decrypt_end (hls_stream);
+    gst_hls_decrypt_end (&hls_stream->decrypt);
 
   if (stream->last_ret == GST_FLOW_OK) {
     if (hls_stream->pending_decrypted_buffer) {
-      if (hls_stream->current_key) {
-        GstMapInfo info;
-        gssize unpadded_size;
-
-        /* Handle pkcs7 unpadding here */
-        gst_buffer_map (hls_stream->pending_decrypted_buffer, &info,
-            GST_MAP_READ);
-        unpadded_size = info.size - info.data[info.size - 1];
-        gst_buffer_unmap (hls_stream->pending_decrypted_buffer, &info);
-
-        gst_buffer_resize (hls_stream->pending_decrypted_buffer, 0,
-            unpadded_size);
-      }
+      /* Handle pkcs7 unpadding here */
+      if (hls_stream->current_key
+          && !gst_hls_decrypt_unpad (hls_stream->pending_decrypted_buffer))
+        GST_WARNING_OBJECT (stream->pad, "Invalid padding of the segment");
 
       ret =
           gst_hls_demux_handle_buffer (demux, stream,
@@ -960,40 +944,25 @@ gst_hls_demux_data_received (GstAdaptiveDemux * demux,
     GstAdaptiveDemuxStream * stream, GstBuffer * buffer)
 {
   GstHLSDemuxStream *hls_stream = GST_HLS_DEMUX_STREAM_CAST (stream);
-  GstHLSDemux *hlsdemux = GST_HLS_DEMUX_CAST (demux);
 
   if (hls_stream->current_offset == -1)
     hls_stream->current_offset = 0;
 
   /* Is it encrypted? */
   if (hls_stream->current_key) {
-    GError *err = NULL;
-    gsize size;
     GstBuffer *tmp_buffer;
 
-    if (hls_stream->pending_encrypted_data == NULL)
-      hls_stream->pending_encrypted_data = gst_adapter_new ();
-
-    gst_adapter_push (hls_stream->pending_encrypted_data, buffer);
-    size = gst_adapter_available (hls_stream->pending_encrypted_data);
-
-    /* must be a multiple of 16 */
-    size &= (~0xF);
-
-    if (size == 0) {
-      return GST_FLOW_OK;
-    }
-
-    buffer = gst_adapter_take_buffer (hls_stream->pending_encrypted_data, size);
-    buffer =
-        gst_hls_demux_decrypt_fragment (hlsdemux, hls_stream, buffer, &err);
-    if (buffer == NULL) {
-      GST_ELEMENT_ERROR (demux, STREAM, DECODE, ("Failed to decrypt buffer"),
-          ("decryption failed %s", err->message));
-      g_error_free (err);
+    /* decrypted in place, the last incomplete AES block is kept until the
+     * next buffer completes it */
+    if (!gst_hls_decrypt_buffer (&hls_stream->decrypt, buffer, &buffer)) {
+      GST_ELEMENT_ERROR (demux, STREAM, DECRYPT, ("Failed to decrypt buffer"),
+          ("decryption failed"));
       return GST_FLOW_ERROR;
     }
 
+    if (buffer == NULL)
+      return GST_FLOW_OK;
+
     tmp_buffer = hls_stream->pending_decrypted_buffer;
     hls_stream->pending_decrypted_buffer = buffer;
     buffer = tmp_buffer;
@@ -1012,9 +981,6 @@ gst_hls_demux_stream_free (GstAdaptiveDemuxStream * stream)
     hls_stream->playlist = NULL;
   }
 
-  if (hls_stream->pending_encrypted_data)
-    g_object_unref (hls_stream->pending_encrypted_data);
-
   gst_buffer_replace (&hls_stream->pending_decrypted_buffer, NULL);
   gst_buffer_replace (&hls_stream->pending_typefind_buffer, NULL);
   gst_buffer_replace (&hls_stream->pending_pcr_buffer, NULL);
@@ -1027,7 +993,7 @@ gst_hls_demux_stream_free (GstAdaptiveDemuxStream * stream)
     g_free (hls_stream->current_iv);
     hls_stream->current_iv = NULL;
   }
-  gst_hls_demux_stream_decrypt_end (hls_stream);
+  gst_hls_decrypt_end (&hls_stream->decrypt);
 }
 
 static GstM3U8 *
@@ -1650,180 +1616,6 @@ retry_failover_protection:
   return TRUE;
 }
 
-#if defined(HAVE_OPENSSL)
-static gboolean
-gst_hls_demux_stream_decrypt_start (GstHLSDemuxStream * stream,
-    const guint8 * key_data, const guint8 * iv_data)
-{
-  EVP_CIPHER_CTX *ctx;
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-  EVP_CIPHER_CTX_init (&stream->aes_ctx);
-  ctx = &stream->aes_ctx;
-#else
-  stream->aes_ctx = EVP_CIPHER_CTX_new ();
-  ctx = stream->aes_ctx;
-#endif
-  if (!EVP_DecryptInit_ex (ctx, EVP_aes_128_cbc (), NULL, key_data, iv_data))
-    return FALSE;
-  EVP_CIPHER_CTX_set_padding (ctx, 0);
-  return TRUE;
-}
-
-static gboolean
-decrypt_fragment (GstHLSDemuxStream * stream, gsize length,
-    const guint8 * encrypted_data, guint8 * decrypted_data)
-{
-  int len, flen = 0;
-  EVP_CIPHER_CTX *ctx;
-
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-  ctx = &stream->aes_ctx;
-#else
-  ctx = stream->aes_ctx;
-#endif
-
-  if (G_UNLIKELY (length > G_MAXINT || length % 16 != 0))
-    return FALSE;
-
-  len = (int) length;
-  if (!EVP_DecryptUpdate (ctx, decrypted_data, &len, encrypted_data, len))
-    return FALSE;
-  EVP_DecryptFinal_ex (ctx, decrypted_data + len, &flen);
-  g_return_val_if_fail (len + flen == length, FALSE);
-  return TRUE;
-}
-
-static void
-gst_hls_demux_stream_decrypt_end (GstHLSDemuxStream * stream)
-{
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-  EVP_CIPHER_CTX_cleanup (&stream->aes_ctx);
-#else
-  EVP_CIPHER_CTX_free (stream->aes_ctx);
-  stream->aes_ctx = NULL;
-#endif
-}
-
-#elif defined(HAVE_NETTLE)
-static gboolean
-gst_hls_demux_stream_decrypt_start (GstHLSDemuxStream * stream,
-    const guint8 * key_data, const guint8 * iv_data)
-{
-  aes_set_decrypt_key (&stream->aes_ctx.ctx, 16, key_data);
-  CBC_SET_IV (&stream->aes_ctx, iv_data);
-
-  return TRUE;
-}
-
-static gboolean
-decrypt_fragment (GstHLSDemuxStream * stream, gsize length,
-    const guint8 * encrypted_data, guint8 * decrypted_data)
-{
-  if (length % 16 != 0)
-    return FALSE;
-
-  CBC_DECRYPT (&stream->aes_ctx, aes_decrypt, length, decrypted_data,
-      encrypted_data);
-
-  return TRUE;
-}
-
-static void
-gst_hls_demux_stream_decrypt_end (GstHLSDemuxStream * stream)
-{
-  /* NOP */
-}
-
-#else
-static gboolean
-gst_hls_demux_stream_decrypt_start (GstHLSDemuxStream * stream,
-    const guint8 * key_data, const guint8 * iv_data)
-{
-  gcry_error_t err = 0;
-  gboolean ret = FALSE;
-
-  err =
-      gcry_cipher_open (&stream->aes_ctx, GCRY_CIPHER_AES128,
-      GCRY_CIPHER_MODE_CBC, 0);
-  if (err)
-    goto out;
-  err = gcry_cipher_setkey (stream->aes_ctx, key_data, 16);
-  if (err)
-    goto out;
-  err = gcry_cipher_setiv (stream->aes_ctx, iv_data, 16);
-  if (!err)
-    ret = TRUE;
-
-out:
-  if (!ret)
-    if (stream->aes_ctx)
-      gcry_cipher_close (stream->aes_ctx);
-
-  return ret;
-}
-
-static gboolean
-decrypt_fragment (GstHLSDemuxStream * stream, gsize length,
-    const guint8 * encrypted_data, guint8 * decrypted_data)
-{
-  gcry_error_t err = 0;
-
-  err = gcry_cipher_decrypt (stream->aes_ctx, decrypted_data, length,
-      encrypted_data, length);
-
-  return err == 0;
-}
-
-static void
-gst_hls_demux_stream_decrypt_end (GstHLSDemuxStream * stream)
-{
-  if (stream->aes_ctx) {
-    gcry_cipher_close (stream->aes_ctx);
-    stream->aes_ctx = NULL;
-  }
-}
-#endif
-
-static GstBuffer *
-gst_hls_demux_decrypt_fragment (GstHLSDemux * demux, GstHLSDemuxStream * stream,
-    GstBuffer * encrypted_buffer, GError ** err)
-{
-  GstBuffer *decrypted_buffer = NULL;
-  GstMapInfo encrypted_info, decrypted_info;
-
-  decrypted_buffer =
-      gst_buffer_new_allocate (NULL, gst_buffer_get_size (encrypted_buffer),
-      NULL);
-
-  gst_buffer_map (encrypted_buffer, &encrypted_info, GST_MAP_READ);
-  gst_buffer_map (decrypted_buffer, &decrypted_info, GST_MAP_WRITE);
-
-  if (!decrypt_fragment (stream, encrypted_info.size,
-          encrypted_info.data, decrypted_info.data))
-    goto decrypt_error;
-
-
-  gst_buffer_unmap (decrypted_buffer, &decrypted_info);
-  gst_buffer_unmap (encrypted_buffer, &encrypted_info);
-
-  gst_buffer_unref (encrypted_buffer);
-
-  return decrypted_buffer;
-
-decrypt_error:
-  GST_ERROR_OBJECT (demux, "Failed to decrypt fragment");
-  g_set_error (err, GST_STREAM_ERROR, GST_STREAM_ERROR_DECRYPT,
-      "Failed to decrypt fragment");
-
-  gst_buffer_unmap (decrypted_buffer, &decrypted_info);
-  gst_buffer_unmap (encrypted_buffer, &encrypted_info);
-
-  gst_buffer_unref (encrypted_buffer);
-  gst_buffer_unref (decrypted_buffer);
-
-  return NULL;
-}
-
 static gint64
 gst_hls_demux_get_manifest_update_interval (GstAdaptiveDemux * demux)
 {
@@ -28,15 +28,8 @@
 #include <gst/gst.h>
 #include "m3u8.h"
 #include "gsthls.h"
+#include "gsthlsdecrypt.h"
 #include <gst/adaptivedemux/gstadaptivedemux.h>
-#if defined(HAVE_OPENSSL)
-#include <openssl/evp.h>
-#elif defined(HAVE_NETTLE)
-#include <nettle/aes.h>
-#include <nettle/cbc.h>
-#else
-#include <gcrypt.h>
-#endif
 
 G_BEGIN_DECLS
 
@@ -93,24 +86,13 @@ struct _GstHLSDemuxStream
   gboolean do_typefind;         /* Whether we need to typefind the next buffer */
   GstBuffer *pending_typefind_buffer; /* for collecting data until typefind succeeds */
 
-  GstAdapter *pending_encrypted_data;  /* for chunking data into 16 byte multiples for decryption */
   GstBuffer *pending_decrypted_buffer; /* last decrypted buffer for pkcs7 unpadding.
                                           We only know that it is the last at EOS */
   guint64 current_offset;              /* offset we're currently at */
   gboolean reset_pts;
 
   /* decryption tooling */
-#if defined(HAVE_OPENSSL)
-# if OPENSSL_VERSION_NUMBER < 0x10100000L
-  EVP_CIPHER_CTX aes_ctx;
-# else
-  EVP_CIPHER_CTX *aes_ctx;
-# endif
-#elif defined(HAVE_NETTLE)
-  struct CBC_CTX (struct aes_ctx, AES_BLOCK_SIZE) aes_ctx;
-#else
-  gcry_cipher_hd_t aes_ctx;
-#endif
+  GstHLSDecrypt decrypt;
 
   gchar     *current_key;
   guint8    *current_iv;
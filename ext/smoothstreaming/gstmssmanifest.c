@@ -54,6 +54,7 @@ GST_DEBUG_CATEGORY_EXTERN (mssdemux_debug);
 #define MSS_PROP_TIMESCALE            "TimeScale"
 #define MSS_PROP_URL                  "Url"
 
+/* A run of fragments of the same duration, starting at time */
 typedef struct _GstMssStreamFragment
 {
   guint number;
@@ -62,6 +63,9 @@ typedef struct _GstMssStreamFragment
   guint repetitions;
 } GstMssStreamFragment;
 
+#define GST_MSS_STREAM_FRAGMENT(stream,i) \
+    (&g_array_index ((stream)->fragments, GstMssStreamFragment, (i)))
+
 typedef struct _GstMssStreamQuality
 {
   xmlNodePtr xmlnode;
@@ -80,7 +84,7 @@ struct _GstMssStream
   gboolean has_live_fragments;
   GstAdapter *live_adapter;
 
-  GList *fragments;
+  GArray *fragments;            /* GstMssStreamFragment, in time order */
   GList *qualities;
 
   gchar *url;
@@ -88,10 +92,14 @@ struct _GstMssStream
 
   GstMssFragmentParser fragment_parser;
 
+  /* index in fragments, fragments->len when the stream is over */
+  guint current_fragment;
   guint fragment_repetition_index;
-  GList *current_fragment;
   GList *current_quality;
 
+  /* length of the DVR window in the stream timescale, 0 if infinite */
+  guint64 dvr_window;
+
   /* TODO move this to somewhere static */
   GRegex *regex_bitrate;
   GRegex *regex_position;
@@ -115,9 +123,10 @@ struct _GstMssManifest
 /* For parsing and building a fragments list */
 typedef struct _GstMssFragmentListBuilder
 {
-  GList *fragments;
+  GArray *fragments;
 
-  GstMssStreamFragment *previous_fragment;
+  /* index of the fragment waiting for its duration, -1 if none */
+  gint previous_fragment;
   guint fragment_number;
   guint64 fragment_time_accum;
 } GstMssFragmentListBuilder;
@@ -125,12 +134,34 @@ typedef struct _GstMssFragmentListBuilder
 static void
 gst_mss_fragment_list_builder_init (GstMssFragmentListBuilder * builder)
 {
-  builder->fragments = NULL;
-  builder->previous_fragment = NULL;
+  builder->fragments = g_array_new (FALSE, FALSE,
+      sizeof (GstMssStreamFragment));
+  builder->previous_fragment = -1;
   builder->fragment_time_accum = 0;
   builder->fragment_number = 0;
 }
 
+/* Appends fragment to the list, or extends the last run when fragment
+ * directly follows it with the same duration */
+static void
+gst_mss_fragment_list_append (GArray * fragments,
+    const GstMssStreamFragment * fragment)
+{
+  if (fragments->len > 0) {
+    GstMssStreamFragment *last = &g_array_index (fragments,
+        GstMssStreamFragment, fragments->len - 1);
+
+    if (last->duration == fragment->duration &&
+        last->number + last->repetitions == fragment->number &&
+        last->time + last->duration * last->repetitions == fragment->time) {
+      last->repetitions += fragment->repetitions;
+      return;
+    }
+  }
+
+  g_array_append_vals (fragments, fragment, 1);
+}
+
 static void
 gst_mss_fragment_list_builder_add (GstMssFragmentListBuilder * builder,
     xmlNodePtr node)
@@ -139,7 +170,7 @@ gst_mss_fragment_list_builder_add (GstMssFragmentListBuilder * builder,
   gchar *time_str;
   gchar *seqnum_str;
   gchar *repetition_str;
-  GstMssStreamFragment *fragment = g_new (GstMssStreamFragment, 1);
+  GstMssStreamFragment fragment;
 
   duration_str = (gchar *) xmlGetProp (node, (xmlChar *) MSS_PROP_DURATION);
   time_str = (gchar *) xmlGetProp (node, (xmlChar *) MSS_PROP_TIME);
@@ -149,54 +180,97 @@ gst_mss_fragment_list_builder_add (GstMssFragmentListBuilder * builder,
 
   /* use the node's seq number or use the previous + 1 */
   if (seqnum_str) {
-    fragment->number = g_ascii_strtoull (seqnum_str, NULL, 10);
+    fragment.number = g_ascii_strtoull (seqnum_str, NULL, 10);
     xmlFree (seqnum_str);
-    builder->fragment_number = fragment->number;
+    builder->fragment_number = fragment.number;
   } else {
-    fragment->number = builder->fragment_number;
+    fragment.number = builder->fragment_number;
   }
-  builder->fragment_number = fragment->number + 1;
+  builder->fragment_number = fragment.number + 1;
 
   if (repetition_str) {
-    fragment->repetitions = g_ascii_strtoull (repetition_str, NULL, 10);
+    fragment.repetitions = g_ascii_strtoull (repetition_str, NULL, 10);
     xmlFree (repetition_str);
   } else {
-    fragment->repetitions = 1;
+    fragment.repetitions = 1;
   }
 
   if (time_str) {
-    fragment->time = g_ascii_strtoull (time_str, NULL, 10);
+    fragment.time = g_ascii_strtoull (time_str, NULL, 10);
 
     xmlFree (time_str);
-    builder->fragment_time_accum = fragment->time;
+    builder->fragment_time_accum = fragment.time;
   } else {
-    fragment->time = builder->fragment_time_accum;
+    fragment.time = builder->fragment_time_accum;
   }
 
   /* if we have a previous fragment, means we need to set its duration */
-  if (builder->previous_fragment)
-    builder->previous_fragment->duration =
-        (fragment->time -
-        builder->previous_fragment->time) /
-        builder->previous_fragment->repetitions;
+  if (builder->previous_fragment >= 0) {
+    GstMssStreamFragment *previous = &g_array_index (builder->fragments,
+        GstMssStreamFragment, builder->previous_fragment);
+
+    previous->duration = (fragment.time - previous->time) /
+        previous->repetitions;
+  }
 
   if (duration_str) {
-    fragment->duration = g_ascii_strtoull (duration_str, NULL, 10);
+    fragment.duration = g_ascii_strtoull (duration_str, NULL, 10);
 
-    builder->previous_fragment = NULL;
-    builder->fragment_time_accum += fragment->duration * fragment->repetitions;
+    builder->previous_fragment = -1;
+    builder->fragment_time_accum += fragment.duration * fragment.repetitions;
     xmlFree (duration_str);
   } else {
     /* store to set the duration at the next iteration */
-    builder->previous_fragment = fragment;
+    fragment.duration = 0;
+    builder->previous_fragment = builder->fragments->len;
   }
 
-  /* we reverse it later */
-  builder->fragments = g_list_prepend (builder->fragments, fragment);
   GST_LOG ("Adding fragment number: %u, time: %" G_GUINT64_FORMAT
       ", duration: %" G_GUINT64_FORMAT ", repetitions: %u",
-      fragment->number, fragment->time, fragment->duration,
-      fragment->repetitions);
+      fragment.number, fragment.time, fragment.duration,
+      fragment.repetitions);
+
+  if (builder->previous_fragment >= 0)
+    g_array_append_val (builder->fragments, fragment);
+  else
+    gst_mss_fragment_list_append (builder->fragments, &fragment);
+}
+
+/* Returns the current fragment run, NULL when the stream is over */
+static GstMssStreamFragment *
+gst_mss_stream_get_current_fragment (GstMssStream * stream)
+{
+  if (stream->current_fragment >= stream->fragments->len)
+    return NULL;
+  return GST_MSS_STREAM_FRAGMENT (stream, stream->current_fragment);
+}
+
+static GstMssStreamFragment *
+gst_mss_stream_get_last_fragment (GstMssStream * stream)
+{
+  if (stream->fragments->len == 0)
+    return NULL;
+  return GST_MSS_STREAM_FRAGMENT (stream, stream->fragments->len - 1);
+}
+
+/* Returns the index of the first fragment run ending after time, or the
+ * number of runs if there is none */
+static guint
+gst_mss_stream_find_fragment (GstMssStream * stream, guint64 time)
+{
+  guint low = 0, high = stream->fragments->len;
+
+  while (low < high) {
+    guint mid = low + (high - low) / 2;
+    GstMssStreamFragment *fragment = GST_MSS_STREAM_FRAGMENT (stream, mid);
+
+    if (fragment->time + fragment->repetitions * fragment->duration > time)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+
+  return low;
 }
 
 static GstBuffer *gst_buffer_from_hex_string (const gchar * s);
@@ -269,6 +343,11 @@ _gst_mss_stream_init (GstMssManifest * manifest, GstMssStream * stream,
   stream->has_live_fragments = manifest->is_live
       && manifest->look_ahead_fragment_count;
 
+  if (manifest->dvr_window > 0)
+    stream->dvr_window = gst_util_uint64_scale_round (manifest->dvr_window,
+        gst_mss_stream_get_timescale (stream),
+        gst_mss_manifest_get_timescale (manifest));
+
   for (iter = node->children; iter; iter = iter->next) {
     if (node_has_type (iter, MSS_NODE_STREAM_FRAGMENT)) {
       gst_mss_fragment_list_builder_add (&builder, iter);
@@ -284,10 +363,8 @@ _gst_mss_stream_init (GstMssManifest * manifest, GstMssStream * stream,
     stream->live_adapter = gst_adapter_new ();
   }
 
-  if (builder.fragments) {
-    stream->fragments = g_list_reverse (builder.fragments);
-    stream->current_fragment = stream->fragments;
-  }
+  stream->fragments = builder.fragments;
+  stream->current_fragment = 0;
 
   /* order them from smaller to bigger based on bitrates */
   stream->qualities =
@@ -422,7 +499,7 @@ gst_mss_stream_free (GstMssStream * stream)
     g_object_unref (stream->live_adapter);
   }
 
-  g_list_free_full (stream->fragments, g_free);
+  g_array_free (stream->fragments, TRUE);
   g_list_free_full (stream->qualities,
       (GDestroyNotify) gst_mss_stream_quality_free);
   xmlFree (stream->url);
@@ -957,9 +1034,10 @@ gst_mss_manifest_get_duration (GstMssManifest * manifest)
       GstMssStream *stream = iter->data;
 
       if (stream->active) {
-        if (stream->fragments) {
-          GList *l = g_list_last (stream->fragments);
-          GstMssStreamFragment *fragment = (GstMssStreamFragment *) l->data;
+        GstMssStreamFragment *fragment =
+            gst_mss_stream_get_last_fragment (stream);
+
+        if (fragment) {
           guint64 frag_dur =
               fragment->time + fragment->duration * fragment->repetitions;
           max_dur = MAX (frag_dur, max_dur);
@@ -1045,11 +1123,10 @@ gst_mss_stream_get_fragment_url (GstMssStream * stream, gchar ** url)
 
   g_return_val_if_fail (stream->active, GST_FLOW_ERROR);
 
-  if (stream->current_fragment == NULL) /* stream is over */
+  fragment = gst_mss_stream_get_current_fragment (stream);
+  if (fragment == NULL)         /* stream is over */
     return GST_FLOW_EOS;
 
-  fragment = stream->current_fragment->data;
-
   time =
       fragment->time + fragment->duration * stream->fragment_repetition_index;
   start_time_str = g_strdup_printf ("%" G_GUINT64_FORMAT, time);
@@ -1077,15 +1154,14 @@ gst_mss_stream_get_fragment_gst_timestamp (GstMssStream * stream)
 
   g_return_val_if_fail (stream->active, GST_CLOCK_TIME_NONE);
 
-  if (!stream->current_fragment) {
-    GList *last = g_list_last (stream->fragments);
-    if (last == NULL)
+  fragment = gst_mss_stream_get_current_fragment (stream);
+  if (!fragment) {
+    fragment = gst_mss_stream_get_last_fragment (stream);
+    if (fragment == NULL)
       return GST_CLOCK_TIME_NONE;
 
-    fragment = last->data;
     time = fragment->time + (fragment->duration * fragment->repetitions);
   } else {
-    fragment = stream->current_fragment->data;
     time =
         fragment->time +
         (fragment->duration * stream->fragment_repetition_index);
@@ -1105,11 +1181,10 @@ gst_mss_stream_get_fragment_gst_duration (GstMssStream * stream)
 
   g_return_val_if_fail (stream->active, GST_FLOW_ERROR);
 
-  if (!stream->current_fragment)
+  fragment = gst_mss_stream_get_current_fragment (stream);
+  if (!fragment)
     return GST_CLOCK_TIME_NONE;
 
-  fragment = stream->current_fragment->data;
-
   dur = fragment->duration;
   timescale = gst_mss_stream_get_timescale (stream);
   return (GstClockTime) gst_util_uint64_scale_round (dur, GST_SECOND,
@@ -1121,10 +1196,7 @@ gst_mss_stream_has_next_fragment (GstMssStream * stream)
 {
   g_return_val_if_fail (stream->active, FALSE);
 
-  if (stream->current_fragment == NULL)
-    return FALSE;
-
-  return TRUE;
+  return gst_mss_stream_get_current_fragment (stream) != NULL;
 }
 
 GstFlowReturn
@@ -1136,20 +1208,20 @@ gst_mss_stream_advance_fragment (GstMssStream * stream)
 
   g_return_val_if_fail (stream->active, GST_FLOW_ERROR);
 
-  if (stream->current_fragment == NULL)
+  fragment = gst_mss_stream_get_current_fragment (stream);
+  if (fragment == NULL)
     return GST_FLOW_EOS;
 
-  fragment = stream->current_fragment->data;
   stream->fragment_repetition_index++;
   if (stream->fragment_repetition_index < fragment->repetitions)
     goto beach;
 
   stream->fragment_repetition_index = 0;
-  stream->current_fragment = g_list_next (stream->current_fragment);
+  stream->current_fragment++;
 
   GST_DEBUG ("Advanced to fragment #%d on %s stream", fragment->number,
       stream_type_name);
-  if (stream->current_fragment == NULL)
+  if (stream->current_fragment >= stream->fragments->len)
     return GST_FLOW_EOS;
 
 beach:
@@ -1164,15 +1236,16 @@ gst_mss_stream_regress_fragment (GstMssStream * stream)
   GstMssStreamFragment *fragment;
   g_return_val_if_fail (stream->active, GST_FLOW_ERROR);
 
-  if (stream->current_fragment == NULL)
+  if (gst_mss_stream_get_current_fragment (stream) == NULL)
     return GST_FLOW_EOS;
 
-  fragment = stream->current_fragment->data;
   if (stream->fragment_repetition_index == 0) {
-    stream->current_fragment = g_list_previous (stream->current_fragment);
-    if (stream->current_fragment == NULL)
+    if (stream->current_fragment == 0) {
+      stream->current_fragment = stream->fragments->len;
       return GST_FLOW_EOS;
-    fragment = stream->current_fragment->data;
+    }
+    stream->current_fragment--;
+    fragment = gst_mss_stream_get_current_fragment (stream);
     stream->fragment_repetition_index = fragment->repetitions - 1;
   } else {
     stream->fragment_repetition_index--;
@@ -1224,7 +1297,7 @@ void
 gst_mss_stream_seek (GstMssStream * stream, gboolean forward,
     GstSeekFlags flags, guint64 time, guint64 * final_time)
 {
-  GList *iter;
+  guint index;
   guint64 timescale;
   GstMssStreamFragment *fragment = NULL;
 
@@ -1232,42 +1305,44 @@ gst_mss_stream_seek (GstMssStream * stream, gboolean forward,
   time = gst_util_uint64_scale_round (time, timescale, GST_SECOND);
 
   GST_DEBUG ("Stream %s seeking to %" G_GUINT64_FORMAT, stream->url, time);
-  for (iter = stream->fragments; iter; iter = g_list_next (iter)) {
-    fragment = iter->data;
-    if (fragment->time + fragment->repetitions * fragment->duration > time) {
-      stream->current_fragment = iter;
-      stream->fragment_repetition_index =
-          (time - fragment->time) / fragment->duration;
-      if (((time - fragment->time) % fragment->duration) == 0) {
-
-        /* for reverse playback, start from the previous fragment when we are
-         * exactly at a limit */
-        if (!forward)
-          stream->fragment_repetition_index--;
-      } else if (SNAP_AFTER (forward, flags))
-        stream->fragment_repetition_index++;
-
-      if (stream->fragment_repetition_index == fragment->repetitions) {
-        /* move to the next one */
+  index = gst_mss_stream_find_fragment (stream, time);
+  if (index < stream->fragments->len) {
+    fragment = GST_MSS_STREAM_FRAGMENT (stream, index);
+
+    /* before the first fragment or in a gap between two of them */
+    if (time < fragment->time)
+      time = fragment->time;
+
+    stream->current_fragment = index;
+    stream->fragment_repetition_index =
+        (time - fragment->time) / fragment->duration;
+    if (((time - fragment->time) % fragment->duration) == 0) {
+
+      /* for reverse playback, start from the previous fragment when we are
+       * exactly at a limit */
+      if (!forward)
+        stream->fragment_repetition_index--;
+    } else if (SNAP_AFTER (forward, flags))
+      stream->fragment_repetition_index++;
+
+    if (stream->fragment_repetition_index == fragment->repetitions) {
+      /* move to the next one */
+      stream->fragment_repetition_index = 0;
+      stream->current_fragment = index + 1;
+      fragment = gst_mss_stream_get_current_fragment (stream);
+
+    } else if (stream->fragment_repetition_index == -1) {
+      if (index > 0) {
+        stream->current_fragment = index - 1;
+        fragment = gst_mss_stream_get_current_fragment (stream);
+        g_assert (fragment);
+        stream->fragment_repetition_index = fragment->repetitions - 1;
+      } else {
         stream->fragment_repetition_index = 0;
-        stream->current_fragment = g_list_next (iter);
-        fragment =
-            stream->current_fragment ? stream->current_fragment->data : NULL;
-
-      } else if (stream->fragment_repetition_index == -1) {
-        if (g_list_previous (iter)) {
-          stream->current_fragment = g_list_previous (iter);
-          fragment = stream->current_fragment->data;
-          g_assert (fragment);
-          stream->fragment_repetition_index = fragment->repetitions - 1;
-        } else {
-          stream->fragment_repetition_index = 0;
-        }
       }
-
-      break;
     }
-
+  } else {
+    fragment = gst_mss_stream_get_last_fragment (stream);
   }
 
   GST_DEBUG ("Stream %s seeked to fragment time %" G_GUINT64_FORMAT
@@ -1280,7 +1355,8 @@ gst_mss_stream_seek (GstMssStream * stream, gboolean forward,
           stream->fragment_repetition_index * fragment->duration,
           GST_SECOND, timescale);
     } else {
-      GstMssStreamFragment *last_fragment = g_list_last (iter)->data;
+      GstMssStreamFragment *last_fragment =
+          gst_mss_stream_get_last_fragment (stream);
       *final_time = gst_util_uint64_scale_round (last_fragment->time +
           last_fragment->repetitions * last_fragment->duration,
           GST_SECOND, timescale);
@@ -1336,13 +1412,15 @@ gst_mss_stream_reload_fragments (GstMssStream * stream, xmlNodePtr streamIndex)
   }
 
   /* store the new fragments list */
-  if (builder.fragments) {
-    g_list_free_full (stream->fragments, g_free);
-    stream->fragments = g_list_reverse (builder.fragments);
-    stream->current_fragment = stream->fragments;
+  if (builder.fragments->len > 0) {
+    g_array_free (stream->fragments, TRUE);
+    stream->fragments = builder.fragments;
+    stream->current_fragment = 0;
     /* TODO Verify how repositioning here works for reverse
      * playback - it might start from the wrong fragment */
     gst_mss_stream_seek (stream, TRUE, 0, current_gst_time, NULL);
+  } else {
+    g_array_free (builder.fragments, TRUE);
   }
 }
 
@@ -1530,19 +1608,19 @@ static gboolean
 gst_mss_stream_get_live_seek_range (GstMssStream * stream, gint64 * start,
     gint64 * stop)
 {
-  GList *l;
   GstMssStreamFragment *fragment;
   guint64 timescale = gst_mss_stream_get_timescale (stream);
 
   g_return_val_if_fail (stream->active, FALSE);
 
+  if (stream->fragments->len == 0)
+    return FALSE;
+
   /* XXX: assumes all the data in the stream is still available */
-  l = g_list_first (stream->fragments);
-  fragment = (GstMssStreamFragment *) l->data;
+  fragment = GST_MSS_STREAM_FRAGMENT (stream, 0);
   *start = gst_util_uint64_scale_round (fragment->time, GST_SECOND, timescale);
 
-  l = g_list_last (stream->fragments);
-  fragment = (GstMssStreamFragment *) l->data;
+  fragment = gst_mss_stream_get_last_fragment (stream);
   *stop = gst_util_uint64_scale_round (fragment->time + fragment->duration *
       fragment->repetitions, GST_SECOND, timescale);
 
@@ -1602,10 +1680,84 @@ gst_mss_stream_fragment_parsing_needed (GstMssStream * stream)
   return stream->fragment_parser.status == GST_MSS_FRAGMENT_HEADER_PARSER_INIT;
 }
 
+/* Drops the fragments that went out of the DVR window, except the current
+ * one. Whole runs are only removed from the array once they are at least as
+ * many as the remaining ones, so that each run is moved once on average. */
+static void
+gst_mss_stream_trim_fragments (GstMssStream * stream)
+{
+  GstMssStreamFragment *fragment;
+  guint64 start, end;
+  guint count, skip;
+
+  fragment = gst_mss_stream_get_last_fragment (stream);
+  if (stream->dvr_window == 0 || fragment == NULL)
+    return;
+
+  end = fragment->time + fragment->duration * fragment->repetitions;
+  if (end <= stream->dvr_window)
+    return;
+  start = end - stream->dvr_window;
+
+  count = MIN (gst_mss_stream_find_fragment (stream, start),
+      stream->current_fragment);
+  if (count > 0 && count >= stream->fragments->len - count) {
+    GST_LOG ("Removing %u fragment runs before %" G_GUINT64_FORMAT
+        " from %s stream", count, start, stream->url);
+    g_array_remove_range (stream->fragments, 0, count);
+    stream->current_fragment -= count;
+  }
+
+  /* and the repetitions of the first run that are out of the window */
+  fragment = GST_MSS_STREAM_FRAGMENT (stream, 0);
+  if (fragment->time >= start || fragment->duration == 0 ||
+      fragment->time + fragment->duration * fragment->repetitions <= start)
+    return;
+
+  skip = (start - fragment->time) / fragment->duration;
+  if (stream->current_fragment == 0) {
+    skip = MIN (skip, stream->fragment_repetition_index);
+    stream->fragment_repetition_index -= skip;
+  }
+  fragment->number += skip;
+  fragment->time += skip * fragment->duration;
+  fragment->repetitions -= skip;
+}
+
+/* Adds a fragment announced by a tfrf box of a live stream */
+static void
+gst_mss_stream_add_live_fragment (GstMssStream * stream, guint64 time,
+    guint64 duration)
+{
+  GstMssStreamFragment *last = gst_mss_stream_get_last_fragment (stream);
+  GstMssStreamFragment fragment;
+
+  if (last == NULL)
+    return;
+
+  /* only add the fragment to the list if it's outside the time in the
+   * current list */
+  if (last->time + last->duration * (last->repetitions - 1) >= time)
+    return;
+
+  fragment.number = last->number + last->repetitions;
+  fragment.repetitions = 1;
+  fragment.time = time;
+  fragment.duration = duration;
+
+  GST_LOG ("Adding fragment number: %u to %s stream, time: %"
+      G_GUINT64_FORMAT ", duration: %" G_GUINT64_FORMAT ", repetitions: %u",
+      fragment.number,
+      gst_mss_stream_type_name (gst_mss_stream_get_type (stream)),
+      fragment.time, fragment.duration, fragment.repetitions);
+
+  gst_mss_fragment_list_append (stream->fragments, &fragment);
+  gst_mss_stream_trim_fragments (stream);
+}
+
 void
 gst_mss_stream_parse_fragment (GstMssStream * stream, GstBuffer * buffer)
 {
-  const gchar *stream_type_name;
   guint8 index;
   GstMoofBox *moof;
   GstTrafBox *traf;
@@ -1619,38 +1771,10 @@ gst_mss_stream_parse_fragment (GstMssStream * stream, GstBuffer * buffer)
   moof = stream->fragment_parser.moof;
   traf = &g_array_index (moof->traf, GstTrafBox, 0);
 
-  stream_type_name =
-      gst_mss_stream_type_name (gst_mss_stream_get_type (stream));
-
   for (index = 0; index < traf->tfrf->entries_count; index++) {
     GstTfrfBoxEntry *entry =
         &g_array_index (traf->tfrf->entries, GstTfrfBoxEntry, index);
-    GList *l = g_list_last (stream->fragments);
-    GstMssStreamFragment *last;
-    GstMssStreamFragment *fragment;
-    guint64 parsed_time = entry->time;
-    guint64 parsed_duration = entry->duration;
-
-    if (l == NULL)
-      break;
-
-    last = (GstMssStreamFragment *) l->data;
-
-    /* only add the fragment to the list if it's outside the time in the
-     * current list */
-    if (last->time >= entry->time)
-      continue;
-
-    fragment = g_new (GstMssStreamFragment, 1);
-    fragment->number = last->number + 1;
-    fragment->repetitions = 1;
-    fragment->time = parsed_time;
-    fragment->duration = parsed_duration;
 
-    stream->fragments = g_list_append (stream->fragments, fragment);
-    GST_LOG ("Adding fragment number: %u to %s stream, time: %"
-        G_GUINT64_FORMAT ", duration: %" G_GUINT64_FORMAT ", repetitions: %u",
-        fragment->number, stream_type_name, fragment->time,
-        fragment->duration, fragment->repetitions);
+    gst_mss_stream_add_live_fragment (stream, entry->time, entry->duration);
   }
 }
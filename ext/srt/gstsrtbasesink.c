@@ -214,6 +214,9 @@ gst_srt_base_sink_render (GstBaseSink * sink, GstBuffer * buffer)
       GST_TIME_ARGS (GST_BUFFER_DURATION (buffer)),
       gst_buffer_get_size (buffer));
 
+  if (bclass->queue_buffer)
+    return bclass->queue_buffer (self, buffer) ? GST_FLOW_OK : GST_FLOW_ERROR;
+
   if (!gst_buffer_map (buffer, &info, GST_MAP_READ)) {
     GST_ELEMENT_ERROR (self, RESOURCE, READ,
         ("Could not map the input stream"), (NULL));
@@ -408,6 +411,8 @@ gst_srt_base_sink_get_stats (GSocketAddress * sockaddr, SRTSOCKET sock)
         "packets-sent-lost", G_TYPE_INT, stats.pktSndLoss,
         /* number of retransmitted packets */
         "packets-retransmitted", G_TYPE_INT, stats.pktRetrans,
+        /* total number of retransmitted packets since the connection */
+        "packets-retransmitted-total", G_TYPE_INT, stats.pktRetransTotal,
         /* number of received ACK packets */
         "packet-ack-received", G_TYPE_INT, stats.pktRecvACK,
         /* number of received NAK packets */
@@ -60,6 +60,10 @@ struct _GstSRTBaseSinkClass {
   /* ask the subclass to send a buffer */
   gboolean (*send_buffer)       (GstSRTBaseSink *self, const GstMapInfo *mapinfo);
 
+  /* hand a buffer to a subclass that sends it from another thread, used
+   * instead of send_buffer when set */
+  gboolean (*queue_buffer)      (GstSRTBaseSink *self, GstBuffer *buffer);
+
   gpointer _gst_reserved[GST_PADDING_LARGE];
 };
 
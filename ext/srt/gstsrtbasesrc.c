@@ -27,6 +27,12 @@
 #include <srt/srt.h>
 #include <gio/gio.h>
 
+#define SRT_DEFAULT_MAX_BATCH_MESSAGES 8
+
+/* the source times are followed as long as they stay this close to the
+ * clock, otherwise the mapping is made again */
+#define SRT_SRCTIME_RESYNC_THRESHOLD GST_SECOND
+
 #define GST_CAT_DEFAULT gst_debug_srt_base_src
 GST_DEBUG_CATEGORY (GST_CAT_DEFAULT);
 
@@ -37,6 +43,7 @@ enum
   PROP_LATENCY,
   PROP_PASSPHRASE,
   PROP_KEY_LENGTH,
+  PROP_MAX_BATCH_MESSAGES,
 
   /*< private > */
   PROP_LAST
@@ -84,6 +91,9 @@ gst_srt_base_src_get_property (GObject * object,
     case PROP_KEY_LENGTH:
       g_value_set_int (value, self->key_length);
       break;
+    case PROP_MAX_BATCH_MESSAGES:
+      g_value_set_uint (value, self->max_batch_messages);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -122,6 +132,9 @@ gst_srt_base_src_set_property (GObject * object,
       self->key_length = key_length;
       break;
     }
+    case PROP_MAX_BATCH_MESSAGES:
+      self->max_batch_messages = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -166,6 +179,17 @@ gst_srt_base_src_get_caps (GstBaseSrc * src, GstCaps * filter)
   return result;
 }
 
+/* makes room for a whole batch of messages in the buffers */
+static GstFlowReturn
+gst_srt_base_src_alloc (GstBaseSrc * src, guint64 offset, guint size,
+    GstBuffer ** buffer)
+{
+  GstSRTBaseSrc *self = GST_SRT_BASE_SRC (src);
+
+  size = MAX (size, self->max_batch_messages * SRT_LIVE_MAX_PLSIZE);
+
+  return GST_BASE_SRC_CLASS (parent_class)->alloc (src, offset, size, buffer);
+}
 
 static void
 gst_srt_base_src_class_init (GstSRTBaseSrcClass * klass)
@@ -210,9 +234,25 @@ gst_srt_base_src_class_init (GstSRTBaseSrcClass * klass)
       "Crypto key length in bytes{16,24,32}", 16,
       32, SRT_DEFAULT_KEY_LENGTH, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GstSRTBaseSrc:max-batch-messages:
+   *
+   * The maximum number of SRT messages that are put in one buffer. Only the
+   * messages that are already available are batched, this doesn't add any
+   * latency.
+   *
+   * Since: 1.16
+   */
+  properties[PROP_MAX_BATCH_MESSAGES] =
+      g_param_spec_uint ("max-batch-messages", "Max Batch Messages",
+      "Maximum number of available messages received into one buffer", 1,
+      1024, SRT_DEFAULT_MAX_BATCH_MESSAGES,
+      G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, properties);
 
   gstbasesrc_class->get_caps = GST_DEBUG_FUNCPTR (gst_srt_base_src_get_caps);
+  gstbasesrc_class->alloc = GST_DEBUG_FUNCPTR (gst_srt_base_src_alloc);
 }
 
 static void
@@ -223,6 +263,7 @@ gst_srt_base_src_init (GstSRTBaseSrc * self)
   gst_base_src_set_live (GST_BASE_SRC (self), TRUE);
   self->latency = SRT_DEFAULT_LATENCY;
   self->key_length = SRT_DEFAULT_KEY_LENGTH;
+  self->max_batch_messages = SRT_DEFAULT_MAX_BATCH_MESSAGES;
 }
 
 static GstURIType
@@ -289,3 +330,152 @@ gst_srt_base_src_uri_handler_init (gpointer g_iface, gpointer iface_data)
   iface->get_uri = gst_srt_base_src_uri_get_uri;
   iface->set_uri = gst_srt_base_src_uri_set_uri;
 }
+
+/* Converts the SRT source time of a message to a timestamp. The source time
+ * is the sender time of the message in the local SRT clock, so it is free of
+ * the network and scheduling jitter of the arrival time. */
+static GstClockTime
+gst_srt_base_src_get_pts (GstSRTBaseSrc * self, gint64 srctime)
+{
+  GstClock *clock;
+  GstClockTime now, base_time, pts;
+
+  clock = gst_element_get_clock (GST_ELEMENT_CAST (self));
+  if (clock == NULL)
+    return GST_CLOCK_TIME_NONE;
+
+  now = gst_clock_get_time (clock);
+  gst_object_unref (clock);
+  base_time = gst_element_get_base_time (GST_ELEMENT_CAST (self));
+
+  if (srctime <= 0)
+    return now - base_time;
+
+  /* the offset is kept in absolute clock time so it stays valid when the
+   * base time changes */
+  pts = srctime * GST_USECOND + self->srctime_offset;
+  if (!self->have_srctime_offset ||
+      ABS (GST_CLOCK_DIFF (pts, now)) > SRT_SRCTIME_RESYNC_THRESHOLD) {
+    GST_DEBUG_OBJECT (self, "mapping source time %" G_GINT64_FORMAT
+        " us to %" GST_TIME_FORMAT, srctime, GST_TIME_ARGS (now));
+    self->srctime_offset = GST_CLOCK_DIFF (srctime * GST_USECOND, now);
+    self->have_srctime_offset = TRUE;
+    pts = now;
+  }
+
+  if (pts < base_time)
+    return 0;
+
+  return pts - base_time;
+}
+
+/**
+ * gst_srt_base_src_receive:
+ * @self: a #GstSRTBaseSrc
+ * @sock: the socket to read from
+ * @info: the mapped buffer to receive into
+ * @pts: (out): the timestamp of the first message
+ *
+ * Receives one message from @sock, waiting for it if the socket is blocking,
+ * followed by the messages that are already available, up to
+ * #GstSRTBaseSrc:max-batch-messages and the size of @info.
+ *
+ * Returns: the number of bytes received, 0 at the end of the stream or
+ * SRT_ERROR if the first message could not be received.
+ */
+gint
+gst_srt_base_src_receive (GstSRTBaseSrc * self, SRTSOCKET sock,
+    GstMapInfo * info, GstClockTime * pts)
+{
+  SRT_MSGCTRL mctrl;
+  gint64 srctime;
+  gint recv_len, total;
+  guint n_messages = 1;
+  int payload_size, events, optlen;
+
+  srt_msgctrl_init (&mctrl);
+  total = srt_recvmsg2 (sock, (char *) info->data, info->size, &mctrl);
+  if (total <= 0)
+    return total;
+  srctime = mctrl.srctime;
+
+  optlen = sizeof (int);
+  if (srt_getsockopt (sock, 0, SRTO_PAYLOADSIZE, &payload_size,
+          &optlen) == SRT_ERROR || payload_size <= 0)
+    payload_size = SRT_LIVE_MAX_PLSIZE;
+
+  while (n_messages < self->max_batch_messages &&
+      info->size - total >= (gsize) payload_size) {
+    optlen = sizeof (int);
+    if (srt_getsockopt (sock, 0, SRTO_EVENT, &events, &optlen) == SRT_ERROR ||
+        !(events & SRT_EPOLL_IN))
+      break;
+
+    srt_msgctrl_init (&mctrl);
+    recv_len = srt_recvmsg2 (sock, (char *) info->data + total,
+        info->size - total, &mctrl);
+    if (recv_len <= 0) {
+      /* the next call reports it */
+      srt_clearlasterror ();
+      break;
+    }
+
+    total += recv_len;
+    n_messages++;
+  }
+
+  GST_LOG_OBJECT (self, "received %u messages, %d bytes", n_messages, total);
+
+  *pts = gst_srt_base_src_get_pts (self, srctime);
+
+  return total;
+}
+
+GstStructure *
+gst_srt_base_src_get_stats (GSocketAddress * sockaddr, SRTSOCKET sock)
+{
+  SRT_TRACEBSTATS stats;
+  int ret;
+  GValue v = G_VALUE_INIT;
+  GstStructure *s;
+
+  if (sock == SRT_INVALID_SOCK || sockaddr == NULL)
+    return gst_structure_new_empty ("application/x-srt-statistics");
+
+  s = gst_structure_new ("application/x-srt-statistics",
+      "sockaddr", G_TYPE_SOCKET_ADDRESS, sockaddr, NULL);
+
+  ret = srt_bstats (sock, &stats, 0);
+  if (ret >= 0) {
+    gst_structure_set (s,
+        /* number of received data packets */
+        "packets-received", G_TYPE_INT64, (gint64) stats.pktRecvTotal,
+        /* number of lost packets (receiver side) */
+        "packets-received-lost", G_TYPE_INT, stats.pktRcvLossTotal,
+        /* number of too-late-to-play dropped packets */
+        "packets-received-dropped", G_TYPE_INT, stats.pktRcvDropTotal,
+        /* number of retransmitted packets that were received */
+        "packets-received-retransmitted", G_TYPE_INT, stats.pktRcvRetrans,
+        /* number of sent ACK packets */
+        "packet-ack-sent", G_TYPE_INT, stats.pktSentACKTotal,
+        /* number of sent NAK packets */
+        "packet-nack-sent", G_TYPE_INT, stats.pktSentNAKTotal,
+        /* number of received data bytes */
+        "bytes-received", G_TYPE_UINT64, (guint64) stats.byteRecvTotal,
+        /* number of lost bytes (receiver side) */
+        "bytes-received-lost", G_TYPE_UINT64, (guint64) stats.byteRcvLossTotal,
+        /* receiving rate in Mb/s */
+        "receive-rate-mbps", G_TYPE_DOUBLE, stats.mbpsRecvRate,
+        /* estimated bandwidth, in Mb/s */
+        "bandwidth-mbps", G_TYPE_DOUBLE, stats.mbpsBandwidth,
+        "rtt-ms", G_TYPE_DOUBLE, stats.msRTT,
+        "negotiated-latency-ms", G_TYPE_INT, stats.msRcvTsbPdDelay, NULL);
+  }
+
+  g_value_init (&v, G_TYPE_STRING);
+  g_value_take_string (&v,
+      g_socket_connectable_to_string (G_SOCKET_CONNECTABLE (sockaddr)));
+  gst_structure_take_value (s, "sockaddr-str", &v);
+
+  return s;
+}
@@ -23,6 +23,9 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstpushsrc.h>
+#include <gio/gio.h>
+
+#include <srt/srt.h>
 
 G_BEGIN_DECLS
 
@@ -46,8 +49,13 @@ struct _GstSRTBaseSrc {
   gint latency;
   gchar *passphrase;
   gint key_length;
+  guint max_batch_messages;
 
   /*< private >*/
+  /* maps the SRT source times to the clock of the element */
+  gboolean have_srctime_offset;
+  GstClockTimeDiff srctime_offset;
+
   gpointer _gst_reserved[GST_PADDING];
 };
 
@@ -60,6 +68,12 @@ struct _GstSRTBaseSrcClass {
 GST_EXPORT
 GType gst_srt_base_src_get_type (void);
 
+gint gst_srt_base_src_receive (GstSRTBaseSrc *self, SRTSOCKET sock,
+    GstMapInfo *info, GstClockTime *pts);
+
+GstStructure * gst_srt_base_src_get_stats (GSocketAddress *sockaddr,
+    SRTSOCKET sock);
+
 G_END_DECLS
 
 #endif /* __GST_SRT_BASE_SRC_H__ */
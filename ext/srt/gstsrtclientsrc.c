@@ -60,6 +60,7 @@ GST_DEBUG_CATEGORY (GST_CAT_DEFAULT);
 struct _GstSRTClientSrcPrivate
 {
   SRTSOCKET sock;
+  GSocketAddress *sockaddr;
   gint poll_id;
   gint poll_timeout;
 
@@ -78,6 +79,7 @@ enum
   PROP_BIND_ADDRESS,
   PROP_BIND_PORT,
   PROP_RENDEZ_VOUS,
+  PROP_STATS,
 
   /*< private > */
   PROP_LAST
@@ -111,6 +113,12 @@ gst_srt_client_src_get_property (GObject * object,
     case PROP_RENDEZ_VOUS:
       g_value_set_boolean (value, priv->bind_port);
       break;
+    case PROP_STATS:
+      GST_OBJECT_LOCK (self);
+      g_value_take_boxed (value, gst_srt_base_src_get_stats (priv->sockaddr,
+              priv->sock));
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -160,6 +168,7 @@ gst_srt_client_src_finalize (GObject * object)
     priv->sock = SRT_INVALID_SOCK;
   }
 
+  g_clear_object (&priv->sockaddr);
   g_free (priv->bind_address);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -173,6 +182,7 @@ gst_srt_client_src_fill (GstPushSrc * src, GstBuffer * outbuf)
   GstFlowReturn ret = GST_FLOW_OK;
   GstMapInfo info;
   SRTSOCKET ready[2];
+  GstClockTime pts = GST_CLOCK_TIME_NONE;
   gint recv_len;
 
   if (srt_epoll_wait (priv->poll_id, 0, 0, ready, &(int) {
@@ -195,8 +205,8 @@ gst_srt_client_src_fill (GstPushSrc * src, GstBuffer * outbuf)
     goto out;
   }
 
-  recv_len = srt_recvmsg (priv->sock, (char *) info.data,
-      gst_buffer_get_size (outbuf));
+  recv_len = gst_srt_base_src_receive (GST_SRT_BASE_SRC (src), priv->sock,
+      &info, &pts);
 
   gst_buffer_unmap (outbuf, &info);
 
@@ -210,9 +220,7 @@ gst_srt_client_src_fill (GstPushSrc * src, GstBuffer * outbuf)
     goto out;
   }
 
-  GST_BUFFER_PTS (outbuf) =
-      gst_clock_get_time (GST_ELEMENT_CLOCK (src)) -
-      GST_ELEMENT_CAST (src)->base_time;
+  GST_BUFFER_PTS (outbuf) = pts;
 
   gst_buffer_resize (outbuf, 0, recv_len);
 
@@ -237,13 +245,19 @@ gst_srt_client_src_start (GstBaseSrc * src)
   GstSRTBaseSrc *base = GST_SRT_BASE_SRC (src);
   GstUri *uri = gst_uri_ref (base->uri);
   GSocketAddress *socket_address = NULL;
+  SRTSOCKET sock;
 
-  priv->sock = gst_srt_client_connect_full (GST_ELEMENT (src), FALSE,
+  sock = gst_srt_client_connect_full (GST_ELEMENT (src), FALSE,
       gst_uri_get_host (uri), gst_uri_get_port (uri), priv->rendez_vous,
       priv->bind_address, priv->bind_port, base->latency,
       &socket_address, &priv->poll_id, base->passphrase, base->key_length);
 
-  g_clear_object (&socket_address);
+  GST_OBJECT_LOCK (self);
+  priv->sock = sock;
+  g_clear_object (&priv->sockaddr);
+  priv->sockaddr = socket_address;
+  GST_OBJECT_UNLOCK (self);
+
   g_clear_pointer (&uri, gst_uri_unref);
 
   return (priv->sock != SRT_INVALID_SOCK);
@@ -263,9 +277,12 @@ gst_srt_client_src_stop (GstBaseSrc * src)
   priv->poll_id = SRT_ERROR;
 
   GST_DEBUG_OBJECT (self, "closing SRT connection");
+  GST_OBJECT_LOCK (self);
   if (priv->sock != SRT_INVALID_SOCK)
     srt_close (priv->sock);
   priv->sock = SRT_INVALID_SOCK;
+  g_clear_object (&priv->sockaddr);
+  GST_OBJECT_UNLOCK (self);
 
   return TRUE;
 }
@@ -309,6 +326,18 @@ gst_srt_client_src_class_init (GstSRTClientSrcClass * klass)
       "Work in Rendez-Vous mode instead of client/caller mode", FALSE,
       G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GstSRTClientSrc:stats:
+   *
+   * The statistics of the SRT link: round trip time, losses,
+   * retransmissions, ...
+   *
+   * Since: 1.16
+   */
+  properties[PROP_STATS] = g_param_spec_boxed ("stats", "Statistics",
+      "SRT Statistics", GST_TYPE_STRUCTURE,
+      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, properties);
 
   gst_element_class_add_static_pad_template (gstelement_class, &src_template);
@@ -32,6 +32,12 @@
  * gst-launch-1.0 -v audiotestsrc ! srtserversink
  * ]| This pipeline shows how to serve SRT packets through the default port.
  * </refsect2>
+ *
+ * Every client has its own queue that is drained by a sender thread, so a
+ * congested client does not hold back the streaming thread or the other
+ * clients. The buffers are shared by all the queues. When the queue of a
+ * client grows over #GstSRTServerSink:client-queue-size bytes,
+ * #GstSRTServerSink:overflow-policy decides what happens.
  * 
  */
 
@@ -45,6 +51,12 @@
 #include <gio/gio.h>
 
 #define SRT_DEFAULT_POLL_TIMEOUT -1
+#define SRT_DEFAULT_CLIENT_QUEUE_SIZE (2 * 1024 * 1024)
+#define SRT_DEFAULT_OVERFLOW_POLICY GST_SRT_SERVER_SINK_OVERFLOW_DROP_OLDEST
+
+/* how long the sender thread waits for a congested client before it looks
+ * at the other queues again, in milliseconds */
+#define SRT_SEND_POLL_TIMEOUT 10
 
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -68,6 +80,16 @@ struct _GstSRTServerSinkPrivate
   GThread *thread;
 
   GList *clients;
+
+  /* the client queues are drained by this thread, protected by the object
+   * lock like the client list */
+  GThread *send_thread;
+  GCond send_cond;
+  gboolean send_stop;
+  gint send_poll_id;
+
+  guint client_queue_size;
+  GstSRTServerSinkOverflowPolicy overflow_policy;
 };
 
 #define GST_SRT_SERVER_SINK_GET_PRIVATE(obj)  \
@@ -77,6 +99,8 @@ enum
 {
   PROP_POLL_TIMEOUT = 1,
   PROP_STATS,
+  PROP_CLIENT_QUEUE_SIZE,
+  PROP_OVERFLOW_POLICY,
   /*< private > */
   PROP_LAST
 };
@@ -99,11 +123,48 @@ G_DEFINE_TYPE_WITH_CODE (GstSRTServerSink, gst_srt_server_sink,
     GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, "srtserversink", 0,
         "SRT Server Sink"));
 
+#define GST_TYPE_SRT_SERVER_SINK_OVERFLOW_POLICY \
+    (gst_srt_server_sink_overflow_policy_get_type ())
+static GType
+gst_srt_server_sink_overflow_policy_get_type (void)
+{
+  static GType overflow_policy_type = 0;
+  static const GEnumValue overflow_policy[] = {
+    {GST_SRT_SERVER_SINK_OVERFLOW_DROP_OLDEST,
+        "Drop the oldest buffers", "drop-oldest"},
+    {GST_SRT_SERVER_SINK_OVERFLOW_DROP_TO_KEYFRAME,
+        "Drop the queue and wait for a keyframe", "drop-to-keyframe"},
+    {GST_SRT_SERVER_SINK_OVERFLOW_DISCONNECT,
+        "Disconnect the client", "disconnect"},
+    {0, NULL, NULL},
+  };
+
+  if (!overflow_policy_type) {
+    overflow_policy_type =
+        g_enum_register_static ("GstSRTServerSinkOverflowPolicy",
+        overflow_policy);
+  }
+  return overflow_policy_type;
+}
+
 typedef struct
 {
   int sock;
   GSocketAddress *sockaddr;
   gboolean sent_headers;
+
+  /* buffers waiting for the sender thread */
+  GQueue queue;
+  gsize queued_bytes;
+  gsize queued_bytes_hwm;
+  guint64 buffers_dropped;
+
+  /* the SRT send buffer is full, the socket is in the sender poll */
+  gboolean congested;
+  /* dropping buffers up to the next keyframe */
+  gboolean wait_keyframe;
+  /* to be removed by the sender thread */
+  gboolean disconnect;
 } SRTClient;
 
 static SRTClient *
@@ -111,15 +172,33 @@ srt_client_new (void)
 {
   SRTClient *client = g_new0 (SRTClient, 1);
   client->sock = SRT_INVALID_SOCK;
+  g_queue_init (&client->queue);
   return client;
 }
 
+/* drops all the queued buffers and returns how many there were, the
+ * streamheaders are sent again before the next buffer */
+static guint
+srt_client_flush (SRTClient * client)
+{
+  guint n = g_queue_get_length (&client->queue);
+  GstBuffer *buffer;
+
+  while ((buffer = g_queue_pop_head (&client->queue)))
+    gst_buffer_unref (buffer);
+  client->queued_bytes = 0;
+  client->sent_headers = FALSE;
+
+  return n;
+}
+
 static void
 srt_client_free (SRTClient * client)
 {
   g_return_if_fail (client != NULL);
 
   g_clear_object (&client->sockaddr);
+  srt_client_flush (client);
 
   if (client->sock != SRT_INVALID_SOCK) {
     srt_close (client->sock);
@@ -158,14 +237,33 @@ gst_srt_server_sink_get_property (GObject * object,
         SRTClient *client = item->data;
         GValue tmp = G_VALUE_INIT;
 
+        GstStructure *s;
+
+        s = gst_srt_base_sink_get_stats (client->sockaddr, client->sock);
+        gst_structure_set (s,
+            "queue-depth", G_TYPE_UINT, g_queue_get_length (&client->queue),
+            "queued-bytes", G_TYPE_UINT64, (guint64) client->queued_bytes,
+            "queued-bytes-hwm", G_TYPE_UINT64,
+            (guint64) client->queued_bytes_hwm,
+            "buffers-dropped", G_TYPE_UINT64, client->buffers_dropped, NULL);
+
         g_value_init (&tmp, GST_TYPE_STRUCTURE);
-        g_value_take_boxed (&tmp, gst_srt_base_sink_get_stats (client->sockaddr,
-                client->sock));
+        g_value_take_boxed (&tmp, s);
         gst_value_array_append_and_take_value (value, &tmp);
       }
       GST_OBJECT_UNLOCK (self);
       break;
     }
+    case PROP_CLIENT_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->client_queue_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_OVERFLOW_POLICY:
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, priv->overflow_policy);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -183,6 +281,16 @@ gst_srt_server_sink_set_property (GObject * object,
     case PROP_POLL_TIMEOUT:
       priv->poll_timeout = g_value_get_int (value);
       break;
+    case PROP_CLIENT_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      priv->client_queue_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_OVERFLOW_POLICY:
+      GST_OBJECT_LOCK (self);
+      priv->overflow_policy = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -199,7 +307,7 @@ idle_listen_callback (gpointer data)
   SRTClient *client;
   SRTSOCKET ready[2];
   struct sockaddr sa;
-  int sa_len;
+  int sa_len = sizeof (sa);
 
   if (srt_epoll_wait (priv->poll_id, ready, &(int) {
           2}, 0, 0, priv->poll_timeout, 0, 0, 0, 0) == -1) {
@@ -257,6 +365,178 @@ thread_func (gpointer data)
   return NULL;
 }
 
+typedef enum
+{
+  SRT_SEND_OK,
+  SRT_SEND_CONGESTED,
+  SRT_SEND_ERROR,
+} SRTSendResult;
+
+static SRTSendResult
+srt_client_send (GstSRTServerSink * self, SRTClient * client,
+    GstBuffer * buffer)
+{
+  SRTSendResult ret = SRT_SEND_OK;
+  GstMapInfo info;
+
+  if (!gst_buffer_map (buffer, &info, GST_MAP_READ)) {
+    GST_WARNING_OBJECT (self, "could not map buffer %" GST_PTR_FORMAT, buffer);
+    return SRT_SEND_OK;
+  }
+
+  if (srt_sendmsg2 (client->sock, (char *) info.data, info.size,
+          0) == SRT_ERROR) {
+    if (srt_getlasterror (NULL) == SRT_EASYNCSND) {
+      ret = SRT_SEND_CONGESTED;
+    } else {
+      GST_WARNING_OBJECT (self, "%s", srt_getlasterror_str ());
+      ret = SRT_SEND_ERROR;
+    }
+    srt_clearlasterror ();
+  }
+
+  gst_buffer_unmap (buffer, &info);
+
+  return ret;
+}
+
+/* Sends the queued buffers of @client until the queue is empty or the
+ * socket is congested. Called with the object lock, which is released
+ * around each send */
+static void
+srt_client_drain (GstSRTServerSink * self, SRTClient * client)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  GstBuffer *buffer;
+  SRTSendResult res;
+  gsize size;
+
+  while (!client->disconnect && (buffer = g_queue_pop_head (&client->queue))) {
+    size = gst_buffer_get_size (buffer);
+    client->queued_bytes -= size;
+
+    GST_OBJECT_UNLOCK (self);
+    res = srt_client_send (self, client, buffer);
+    GST_OBJECT_LOCK (self);
+
+    switch (res) {
+      case SRT_SEND_OK:
+        gst_buffer_unref (buffer);
+        break;
+      case SRT_SEND_CONGESTED:
+        GST_LOG_OBJECT (self, "client %d is congested", client->sock);
+        g_queue_push_head (&client->queue, buffer);
+        client->queued_bytes += size;
+        client->congested = TRUE;
+        srt_epoll_add_usock (priv->send_poll_id, client->sock, &(int) {
+            SRT_EPOLL_OUT | SRT_EPOLL_ERR});
+        return;
+      case SRT_SEND_ERROR:
+        gst_buffer_unref (buffer);
+        client->disconnect = TRUE;
+        return;
+    }
+  }
+}
+
+/* whether there is work for the sender thread that doesn't need to wait for
+ * a congested socket */
+static gboolean
+srt_server_sink_has_pending (GstSRTServerSink * self)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  GList *item;
+
+  for (item = priv->clients; item; item = item->next) {
+    SRTClient *client = item->data;
+
+    if (client->disconnect || (!client->congested &&
+            !g_queue_is_empty (&client->queue)))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+static void
+srt_server_sink_uncongest (GstSRTServerSink * self, SRTSOCKET sock)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  GList *item;
+
+  srt_epoll_remove_usock (priv->send_poll_id, sock);
+
+  for (item = priv->clients; item; item = item->next) {
+    SRTClient *client = item->data;
+
+    if (client->sock == sock) {
+      client->congested = FALSE;
+      break;
+    }
+  }
+}
+
+static gpointer
+send_thread_func (gpointer data)
+{
+  GstSRTServerSink *self = GST_SRT_SERVER_SINK (data);
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  SRTSOCKET ready[16];
+  GList *item, *next;
+  gboolean congested;
+  int i, n_ready;
+
+  GST_OBJECT_LOCK (self);
+  while (!priv->send_stop) {
+    congested = FALSE;
+
+    /* only this thread removes clients, the others append or modify them */
+    for (item = priv->clients; item; item = next) {
+      SRTClient *client = item->data;
+
+      if (!client->congested)
+        srt_client_drain (self, client);
+      next = item->next;
+
+      if (client->disconnect) {
+        GST_DEBUG_OBJECT (self, "removing client %d", client->sock);
+        priv->clients = g_list_delete_link (priv->clients, item);
+        if (client->congested)
+          srt_epoll_remove_usock (priv->send_poll_id, client->sock);
+
+        GST_OBJECT_UNLOCK (self);
+        srt_emit_client_removed (client, self);
+        srt_client_free (client);
+        GST_OBJECT_LOCK (self);
+      } else if (client->congested) {
+        congested = TRUE;
+      }
+    }
+
+    if (congested) {
+      int timeout = srt_server_sink_has_pending (self) ? 0 :
+          SRT_SEND_POLL_TIMEOUT;
+
+      GST_OBJECT_UNLOCK (self);
+      n_ready = G_N_ELEMENTS (ready);
+      if (srt_epoll_wait (priv->send_poll_id, NULL, NULL, ready, &n_ready,
+              timeout, 0, 0, 0, 0) == -1) {
+        srt_clearlasterror ();
+        n_ready = 0;
+      }
+      GST_OBJECT_LOCK (self);
+
+      for (i = 0; i < n_ready; i++)
+        srt_server_sink_uncongest (self, ready[i]);
+    } else if (!srt_server_sink_has_pending (self) && !priv->send_stop) {
+      g_cond_wait (&priv->send_cond, GST_OBJECT_GET_LOCK (self));
+    }
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  return NULL;
+}
+
 static gboolean
 gst_srt_server_sink_start (GstBaseSink * sink)
 {
@@ -365,6 +645,18 @@ gst_srt_server_sink_start (GstBaseSink * sink)
   if (error != NULL) {
     GST_WARNING_OBJECT (self, "failed to create thread (reason: %s)",
         error->message);
+    g_clear_error (&error);
+    ret = FALSE;
+  }
+
+  priv->send_poll_id = srt_epoll_create ();
+  priv->send_stop = FALSE;
+  priv->send_thread = g_thread_try_new ("srtserversink-send",
+      send_thread_func, self, &error);
+  if (error != NULL) {
+    GST_WARNING_OBJECT (self, "failed to create sender thread (reason: %s)",
+        error->message);
+    g_clear_error (&error);
     ret = FALSE;
   }
 
@@ -391,54 +683,100 @@ failed:
   return FALSE;
 }
 
-static gboolean
-send_buffer_internal (GstSRTBaseSink * sink,
-    const GstMapInfo * mapinfo, gpointer user_data)
+static void
+srt_client_queue_buffer (SRTClient * client, GstBuffer * buffer)
 {
-  SRTClient *client = user_data;
+  g_queue_push_tail (&client->queue, gst_buffer_ref (buffer));
+  client->queued_bytes += gst_buffer_get_size (buffer);
+  client->queued_bytes_hwm = MAX (client->queued_bytes_hwm,
+      client->queued_bytes);
+}
 
-  if (srt_sendmsg2 (client->sock, (char *) mapinfo->data, mapinfo->size,
-          0) == SRT_ERROR) {
-    GST_WARNING_OBJECT (sink, "%s", srt_getlasterror_str ());
-    return FALSE;
+/* Makes room for @size bytes in the queue of @client according to the
+ * overflow policy, returns FALSE if the buffer is to be dropped */
+static gboolean
+srt_client_handle_overflow (GstSRTServerSink * self, SRTClient * client,
+    gsize size, gboolean keyframe)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  GstBuffer *buffer;
+
+  if (g_queue_is_empty (&client->queue) ||
+      client->queued_bytes + size <= priv->client_queue_size)
+    return TRUE;
+
+  switch (priv->overflow_policy) {
+    case GST_SRT_SERVER_SINK_OVERFLOW_DROP_OLDEST:
+      while (client->queued_bytes + size > priv->client_queue_size &&
+          (buffer = g_queue_pop_head (&client->queue))) {
+        client->queued_bytes -= gst_buffer_get_size (buffer);
+        client->buffers_dropped++;
+        gst_buffer_unref (buffer);
+      }
+      return TRUE;
+    case GST_SRT_SERVER_SINK_OVERFLOW_DROP_TO_KEYFRAME:
+      GST_DEBUG_OBJECT (self, "client %d overflows, dropping to keyframe",
+          client->sock);
+      client->buffers_dropped += srt_client_flush (client);
+      if (keyframe)
+        return TRUE;
+      client->wait_keyframe = TRUE;
+      break;
+    case GST_SRT_SERVER_SINK_OVERFLOW_DISCONNECT:
+      GST_WARNING_OBJECT (self, "client %d overflows, disconnecting",
+          client->sock);
+      client->buffers_dropped += srt_client_flush (client);
+      client->disconnect = TRUE;
+      break;
   }
 
-  return TRUE;
+  client->buffers_dropped++;
+  return FALSE;
 }
 
 static gboolean
-gst_srt_server_sink_send_buffer (GstSRTBaseSink * sink,
-    const GstMapInfo * mapinfo)
+gst_srt_server_sink_queue_buffer (GstSRTBaseSink * sink, GstBuffer * buffer)
 {
   GstSRTServerSink *self = GST_SRT_SERVER_SINK (sink);
   GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
-  GList *clients = priv->clients;
+  gsize size = gst_buffer_get_size (buffer);
+  gboolean keyframe =
+      !GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+  GList *item;
+  guint i;
 
   GST_OBJECT_LOCK (sink);
-  while (clients != NULL) {
-    SRTClient *client = clients->data;
-    clients = clients->next;
+  for (item = priv->clients; item; item = item->next) {
+    SRTClient *client = item->data;
 
-    if (!client->sent_headers) {
-      if (!gst_srt_base_sink_send_headers (sink, send_buffer_internal, client))
-        goto err;
+    if (client->disconnect)
+      continue;
 
-      client->sent_headers = TRUE;
+    if (client->wait_keyframe) {
+      if (!keyframe) {
+        client->buffers_dropped++;
+        continue;
+      }
+      GST_DEBUG_OBJECT (self, "client %d resumes at keyframe", client->sock);
+      client->wait_keyframe = FALSE;
     }
 
-    if (!send_buffer_internal (sink, mapinfo, client))
-      goto err;
+    if (!srt_client_handle_overflow (self, client, size, keyframe))
+      continue;
 
-    continue;
+    /* after the overflow handling, which may have flushed them */
+    if (!client->sent_headers) {
+      if (sink->headers) {
+        for (i = 0; i < gst_buffer_list_length (sink->headers); i++)
+          srt_client_queue_buffer (client,
+              gst_buffer_list_get (sink->headers, i));
+      }
+      client->sent_headers = TRUE;
+    }
 
-  err:
-    priv->clients = g_list_remove (priv->clients, client);
-    GST_OBJECT_UNLOCK (sink);
-    g_signal_emit (self, signals[SIG_CLIENT_REMOVED], 0, client->sock,
-        client->sockaddr);
-    srt_client_free (client);
-    GST_OBJECT_LOCK (sink);
+    srt_client_queue_buffer (client, buffer);
   }
+  g_cond_signal (&priv->send_cond);
   GST_OBJECT_UNLOCK (sink);
 
   return TRUE;
@@ -451,6 +789,20 @@ gst_srt_server_sink_stop (GstBaseSink * sink)
   GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
   GList *clients;
 
+  if (priv->send_thread) {
+    GST_OBJECT_LOCK (sink);
+    priv->send_stop = TRUE;
+    g_cond_signal (&priv->send_cond);
+    GST_OBJECT_UNLOCK (sink);
+    g_thread_join (priv->send_thread);
+    priv->send_thread = NULL;
+  }
+
+  if (priv->send_poll_id != SRT_ERROR) {
+    srt_epoll_release (priv->send_poll_id);
+    priv->send_poll_id = SRT_ERROR;
+  }
+
   GST_DEBUG_OBJECT (self, "closing client sockets");
 
   GST_OBJECT_LOCK (sink);
@@ -505,6 +857,17 @@ gst_srt_server_sink_unlock_stop (GstBaseSink * sink)
   return TRUE;
 }
 
+static void
+gst_srt_server_sink_finalize (GObject * object)
+{
+  GstSRTServerSink *self = GST_SRT_SERVER_SINK (object);
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+
+  g_cond_clear (&priv->send_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_srt_server_sink_class_init (GstSRTServerSinkClass * klass)
 {
@@ -515,6 +878,7 @@ gst_srt_server_sink_class_init (GstSRTServerSinkClass * klass)
 
   gobject_class->set_property = gst_srt_server_sink_set_property;
   gobject_class->get_property = gst_srt_server_sink_get_property;
+  gobject_class->finalize = gst_srt_server_sink_finalize;
 
   properties[PROP_POLL_TIMEOUT] =
       g_param_spec_int ("poll-timeout", "Poll Timeout",
@@ -529,6 +893,33 @@ gst_srt_server_sink_class_init (GstSRTServerSinkClass * klass)
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS),
       G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GstSRTServerSink:client-queue-size:
+   *
+   * The maximum number of bytes waiting to be sent to one client, the
+   * #GstSRTServerSink:overflow-policy applies when it is reached.
+   *
+   * Since: 1.16
+   */
+  properties[PROP_CLIENT_QUEUE_SIZE] =
+      g_param_spec_uint ("client-queue-size", "Client Queue Size",
+      "Maximum number of bytes queued for one client", 0, G_MAXUINT,
+      SRT_DEFAULT_CLIENT_QUEUE_SIZE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GstSRTServerSink:overflow-policy:
+   *
+   * What to do with a client whose queue is full.
+   *
+   * Since: 1.16
+   */
+  properties[PROP_OVERFLOW_POLICY] =
+      g_param_spec_enum ("overflow-policy", "Overflow Policy",
+      "What to do when the queue of a client is full",
+      GST_TYPE_SRT_SERVER_SINK_OVERFLOW_POLICY, SRT_DEFAULT_OVERFLOW_POLICY,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, properties);
 
   /**
@@ -573,8 +964,8 @@ gst_srt_server_sink_class_init (GstSRTServerSinkClass * klass)
   gstbasesink_class->unlock_stop =
       GST_DEBUG_FUNCPTR (gst_srt_server_sink_unlock_stop);
 
-  gstsrtbasesink_class->send_buffer =
-      GST_DEBUG_FUNCPTR (gst_srt_server_sink_send_buffer);
+  gstsrtbasesink_class->queue_buffer =
+      GST_DEBUG_FUNCPTR (gst_srt_server_sink_queue_buffer);
 }
 
 static void
@@ -582,4 +973,8 @@ gst_srt_server_sink_init (GstSRTServerSink * self)
 {
   GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
   priv->poll_timeout = SRT_DEFAULT_POLL_TIMEOUT;
+  priv->send_poll_id = SRT_ERROR;
+  priv->client_queue_size = SRT_DEFAULT_CLIENT_QUEUE_SIZE;
+  priv->overflow_policy = SRT_DEFAULT_OVERFLOW_POLICY;
+  g_cond_init (&priv->send_cond);
 }
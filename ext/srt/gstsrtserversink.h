@@ -34,6 +34,21 @@ G_BEGIN_DECLS
 #define GST_SRT_SERVER_SINK_CAST(obj)         ((GstSRTServerSink*)(obj))
 #define GST_SRT_SERVER_SINK_CLASS_CAST(klass) ((GstSRTServerSinkClass*)(klass))
 
+/**
+ * GstSRTServerSinkOverflowPolicy:
+ * @GST_SRT_SERVER_SINK_OVERFLOW_DROP_OLDEST: drop the oldest queued buffers
+ * @GST_SRT_SERVER_SINK_OVERFLOW_DROP_TO_KEYFRAME: drop the queued buffers and
+ *   the following ones up to the next keyframe
+ * @GST_SRT_SERVER_SINK_OVERFLOW_DISCONNECT: disconnect the client
+ *
+ * What to do when the queue of a client is full.
+ */
+typedef enum {
+  GST_SRT_SERVER_SINK_OVERFLOW_DROP_OLDEST,
+  GST_SRT_SERVER_SINK_OVERFLOW_DROP_TO_KEYFRAME,
+  GST_SRT_SERVER_SINK_OVERFLOW_DISCONNECT,
+} GstSRTServerSinkOverflowPolicy;
+
 typedef struct _GstSRTServerSink GstSRTServerSink;
 typedef struct _GstSRTServerSinkClass GstSRTServerSinkClass;
 typedef struct _GstSRTServerSinkPrivate GstSRTServerSinkPrivate;
@@ -72,6 +72,7 @@ struct _GstSRTServerSrcPrivate
 enum
 {
   PROP_POLL_TIMEOUT = 1,
+  PROP_STATS,
 
   /*< private > */
   PROP_LAST
@@ -106,6 +107,13 @@ gst_srt_server_src_get_property (GObject * object,
     case PROP_POLL_TIMEOUT:
       g_value_set_int (value, priv->poll_timeout);
       break;
+    case PROP_STATS:
+      GST_OBJECT_LOCK (self);
+      g_value_take_boxed (value,
+          gst_srt_base_src_get_stats (priv->client_sockaddr,
+              priv->client_sock));
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -156,9 +164,10 @@ gst_srt_server_src_fill (GstPushSrc * src, GstBuffer * outbuf)
   GstFlowReturn ret = GST_FLOW_OK;
   GstMapInfo info;
   SRTSOCKET ready[2];
+  GstClockTime pts = GST_CLOCK_TIME_NONE;
   gint recv_len;
   struct sockaddr client_sa;
-  size_t client_sa_len;
+  int client_sa_len = sizeof (client_sa);
 
   while (!priv->has_client) {
     GST_DEBUG_OBJECT (self, "poll wait (timeout: %d)", priv->poll_timeout);
@@ -189,7 +198,7 @@ gst_srt_server_src_fill (GstPushSrc * src, GstBuffer * outbuf)
     }
 
     priv->client_sock =
-        srt_accept (priv->sock, &client_sa, (int *) &client_sa_len);
+        srt_accept (priv->sock, &client_sa, &client_sa_len);
 
     GST_DEBUG_OBJECT (self, "checking client sock");
     if (priv->client_sock == SRT_INVALID_SOCK) {
@@ -199,9 +208,11 @@ gst_srt_server_src_fill (GstPushSrc * src, GstBuffer * outbuf)
       srt_clearlasterror ();
     } else {
       priv->has_client = TRUE;
+      GST_OBJECT_LOCK (self);
       g_clear_object (&priv->client_sockaddr);
       priv->client_sockaddr = g_socket_address_new_from_native (&client_sa,
           client_sa_len);
+      GST_OBJECT_UNLOCK (self);
       g_signal_emit (self, signals[SIG_CLIENT_ADDED], 0,
           priv->client_sock, priv->client_sockaddr);
     }
@@ -216,8 +227,8 @@ gst_srt_server_src_fill (GstPushSrc * src, GstBuffer * outbuf)
     goto out;
   }
 
-  recv_len = srt_recvmsg (priv->client_sock, (char *) info.data,
-      gst_buffer_get_size (outbuf));
+  recv_len = gst_srt_base_src_receive (GST_SRT_BASE_SRC (src),
+      priv->client_sock, &info, &pts);
 
   gst_buffer_unmap (outbuf, &info);
 
@@ -227,9 +238,11 @@ gst_srt_server_src_fill (GstPushSrc * src, GstBuffer * outbuf)
     g_signal_emit (self, signals[SIG_CLIENT_CLOSED], 0,
         priv->client_sock, priv->client_sockaddr);
 
+    GST_OBJECT_LOCK (self);
     srt_close (priv->client_sock);
     priv->client_sock = SRT_INVALID_SOCK;
     g_clear_object (&priv->client_sockaddr);
+    GST_OBJECT_UNLOCK (self);
     priv->has_client = FALSE;
     gst_buffer_resize (outbuf, 0, 0);
     ret = GST_FLOW_OK;
@@ -239,9 +252,7 @@ gst_srt_server_src_fill (GstPushSrc * src, GstBuffer * outbuf)
     goto out;
   }
 
-  GST_BUFFER_PTS (outbuf) =
-      gst_clock_get_time (GST_ELEMENT_CLOCK (src)) -
-      GST_ELEMENT_CAST (src)->base_time;
+  GST_BUFFER_PTS (outbuf) = pts;
 
   gst_buffer_resize (outbuf, 0, recv_len);
 
@@ -382,9 +393,11 @@ gst_srt_server_src_stop (GstBaseSrc * src)
   if (priv->client_sock != SRT_INVALID_SOCK) {
     g_signal_emit (self, signals[SIG_CLIENT_ADDED], 0,
         priv->client_sock, priv->client_sockaddr);
+    GST_OBJECT_LOCK (self);
     srt_close (priv->client_sock);
     g_clear_object (&priv->client_sockaddr);
     priv->client_sock = SRT_INVALID_SOCK;
+    GST_OBJECT_UNLOCK (self);
     priv->has_client = FALSE;
   }
 
@@ -451,6 +464,18 @@ gst_srt_server_src_class_init (GstSRTServerSrcClass * klass)
       "Return poll wait after timeout miliseconds", 0, G_MAXINT32,
       SRT_DEFAULT_POLL_TIMEOUT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GstSRTServerSrc:stats:
+   *
+   * The statistics of the SRT link with the client: round trip time,
+   * losses, retransmissions, ...
+   *
+   * Since: 1.16
+   */
+  properties[PROP_STATS] = g_param_spec_boxed ("stats", "Statistics",
+      "SRT Statistics", GST_TYPE_STRUCTURE,
+      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, properties);
 
   /**
@@ -142,6 +142,12 @@ typedef struct
 } UnifiedBlock;
 
 
+enum
+{
+  PROP_0,
+  PROP_STATS
+};
+
 static GstElementClass *parent_class = NULL;
 static void gst_ttml_render_base_init (gpointer g_class);
 static void gst_ttml_render_class_init (GstTtmlRenderClass * klass);
@@ -179,6 +185,8 @@ static void gst_ttml_render_text_pad_unlink (GstPad * pad, GstObject * parent);
 static void gst_ttml_render_pop_text (GstTtmlRender * render);
 
 static void gst_ttml_render_finalize (GObject * object);
+static void gst_ttml_render_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static gboolean gst_ttml_render_can_handle_caps (GstCaps * incaps);
 
@@ -252,6 +260,19 @@ gst_ttml_render_class_init (GstTtmlRenderClass * klass)
   parent_class = g_type_class_peek_parent (klass);
 
   gobject_class->finalize = gst_ttml_render_finalize;
+  gobject_class->get_property = gst_ttml_render_get_property;
+
+  /**
+   * GstTtmlRender:stats:
+   *
+   * Counts and times (in nanoseconds) the renderings of the TTML regions
+   * and the frames they are blended on or attached to.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics", "Various statistics",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_template_factory));
@@ -278,10 +299,9 @@ gst_ttml_render_finalize (GObject * object)
 {
   GstTtmlRender *render = GST_TTML_RENDER (object);
 
-  if (render->compositions) {
-    g_list_free_full (render->compositions,
-        (GDestroyNotify) gst_video_overlay_composition_unref);
-    render->compositions = NULL;
+  if (render->composition) {
+    gst_video_overlay_composition_unref (render->composition);
+    render->composition = NULL;
   }
 
   if (render->text_buffer) {
@@ -300,6 +320,32 @@ gst_ttml_render_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_ttml_render_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstTtmlRender *render = GST_TTML_RENDER (object);
+
+  switch (prop_id) {
+    case PROP_STATS:
+      GST_TTML_RENDER_LOCK (render);
+      g_value_take_boxed (value,
+          gst_structure_new ("application/x-ttmlrender-stats",
+              "rendered", G_TYPE_UINT64, render->stats_rendered,
+              "render-cost", G_TYPE_UINT64, render->stats_render_cost,
+              "overlaid", G_TYPE_UINT64, render->stats_overlaid,
+              "last-cost", G_TYPE_UINT64, render->stats_last_cost,
+              "average-cost", G_TYPE_UINT64, render->stats_overlaid ?
+              render->stats_overlay_cost / render->stats_overlaid : 0,
+              "pixels", G_TYPE_UINT, render->stats_pixels, NULL));
+      GST_TTML_RENDER_UNLOCK (render);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_ttml_render_init (GstTtmlRender * render, GstTtmlRenderClass * klass)
 {
@@ -353,7 +399,7 @@ gst_ttml_render_init (GstTtmlRender * render, GstTtmlRenderClass * klass)
   render->text_buffer = NULL;
   render->text_linked = FALSE;
 
-  render->compositions = NULL;
+  render->composition = NULL;
   render->layout =
       pango_layout_new (GST_TTML_RENDER_GET_CLASS (render)->pango_context);
 
@@ -444,6 +490,8 @@ gst_ttml_render_negotiate (GstTtmlRender * render, GstCaps * caps)
     gst_query_unref (query);
   }
 
+  render->attach_compo_to_buffer = attach;
+
   if (!allocation_ret && render->video_flushing) {
     ret = FALSE;
   } else if (original_caps && !original_has_meta && !attach) {
@@ -791,10 +839,10 @@ static GstFlowReturn
 gst_ttml_render_push_frame (GstTtmlRender * render, GstBuffer * video_frame)
 {
   GstVideoFrame frame;
-  GList *compositions = render->compositions;
+  GstClockTime start, cost;
 
-  if (compositions == NULL) {
-    GST_CAT_DEBUG (ttmlrender_debug, "No compositions.");
+  if (render->composition == NULL) {
+    GST_CAT_DEBUG (ttmlrender_debug, "No composition.");
     goto done;
   }
 
@@ -809,20 +857,34 @@ gst_ttml_render_push_frame (GstTtmlRender * render, GstBuffer * video_frame)
     }
   }
 
+  start = gst_util_get_timestamp ();
   video_frame = gst_buffer_make_writable (video_frame);
 
+  /* the composition is only rendered again when the text changes, attaching
+   * it to the following frames costs a meta */
+  if (render->attach_compo_to_buffer) {
+    gst_buffer_add_video_overlay_composition_meta (video_frame,
+        render->composition);
+    goto stats;
+  }
+
   if (!gst_video_frame_map (&frame, &render->info, video_frame,
           GST_MAP_READWRITE))
     goto invalid_frame;
 
-  while (compositions) {
-    GstVideoOverlayComposition *composition = compositions->data;
-    gst_video_overlay_composition_blend (composition, &frame);
-    compositions = compositions->next;
-  }
+  /* only touches the pixels under the region rectangles */
+  gst_video_overlay_composition_blend (render->composition, &frame);
 
   gst_video_frame_unmap (&frame);
 
+stats:
+  cost = gst_util_get_timestamp () - start;
+  GST_TTML_RENDER_LOCK (render);
+  render->stats_overlaid++;
+  render->stats_last_cost = cost;
+  render->stats_overlay_cost += cost;
+  GST_TTML_RENDER_UNLOCK (render);
+
 done:
 
   return gst_pad_push (render->srcpad, video_frame);
@@ -2589,11 +2651,10 @@ gst_ttml_render_render_text_block (GstTtmlRender * render,
 }
 
 
-static GstVideoOverlayComposition *
+static GstVideoOverlayRectangle *
 gst_ttml_render_compose_overlay (GstTtmlRenderRenderedImage * image)
 {
   GstVideoOverlayRectangle *rectangle;
-  GstVideoOverlayComposition *ret = NULL;
 
   gst_buffer_add_video_meta (image->image, GST_VIDEO_FRAME_FLAG_NONE,
       GST_VIDEO_OVERLAY_COMPOSITION_FORMAT_RGB, image->width, image->height);
@@ -2602,13 +2663,11 @@ gst_ttml_render_compose_overlay (GstTtmlRenderRenderedImage * image)
       image->y, image->width, image->height,
       GST_VIDEO_OVERLAY_FORMAT_FLAG_PREMULTIPLIED_ALPHA);
 
-  ret = gst_video_overlay_composition_new (rectangle);
-  gst_video_overlay_rectangle_unref (rectangle);
-  return ret;
+  return rectangle;
 }
 
 
-static GstVideoOverlayComposition *
+static GstVideoOverlayRectangle *
 gst_ttml_render_render_text_region (GstTtmlRender * render,
     GstSubtitleRegion * region, GstBuffer * text_buf)
 {
@@ -2619,7 +2678,7 @@ gst_ttml_render_render_text_region (GstTtmlRender * render,
       g_ptr_array_new_with_free_func (
       (GDestroyNotify) gst_ttml_render_rendered_image_free);
   GstTtmlRenderRenderedImage *region_image = NULL;
-  GstVideoOverlayComposition *ret = NULL;
+  GstVideoOverlayRectangle *ret = NULL;
   guint i;
 
   region_width = (guint) (round (region->style_set->extent_w * render->width));
@@ -2897,30 +2956,46 @@ wait_for_text_buf:
       if (render->need_render) {
         GstSubtitleRegion *region = NULL;
         GstSubtitleMeta *subtitle_meta = NULL;
-        guint i;
+        GstClockTime start = gst_util_get_timestamp ();
+        guint i, pixels = 0;
 
-        if (render->compositions) {
-          g_list_free_full (render->compositions,
-              (GDestroyNotify) gst_video_overlay_composition_unref);
-          render->compositions = NULL;
+        if (render->composition) {
+          gst_video_overlay_composition_unref (render->composition);
+          render->composition = NULL;
         }
 
         subtitle_meta = gst_buffer_get_subtitle_meta (render->text_buffer);
         if (!subtitle_meta) {
           GST_CAT_WARNING (ttmlrender_debug, "Failed to get subtitle meta.");
         } else {
+          /* one rectangle per region, all in the same composition */
           for (i = 0; i < subtitle_meta->regions->len; ++i) {
-            GstVideoOverlayComposition *composition;
+            GstVideoOverlayRectangle *rectangle;
+            gint x, y;
+            guint width, height;
+
             region = g_ptr_array_index (subtitle_meta->regions, i);
-            composition = gst_ttml_render_render_text_region (render, region,
+            rectangle = gst_ttml_render_render_text_region (render, region,
                 render->text_buffer);
-            if (composition) {
-              render->compositions = g_list_append (render->compositions,
-                  composition);
-            }
+            if (!rectangle)
+              continue;
+
+            gst_video_overlay_rectangle_get_render_rectangle (rectangle, &x,
+                &y, &width, &height);
+            pixels += width * height;
+            if (render->composition)
+              gst_video_overlay_composition_add_rectangle (render->composition,
+                  rectangle);
+            else
+              render->composition =
+                  gst_video_overlay_composition_new (rectangle);
+            gst_video_overlay_rectangle_unref (rectangle);
           }
         }
         render->need_render = FALSE;
+        render->stats_rendered++;
+        render->stats_render_cost += gst_util_get_timestamp () - start;
+        render->stats_pixels = pixels;
       }
 
       GST_TTML_RENDER_UNLOCK (render);
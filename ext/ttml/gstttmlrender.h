@@ -92,7 +92,16 @@ struct _GstTtmlRender {
     gboolean                 need_render;
 
     PangoLayout             *layout;
-    GList * compositions;
+    GstVideoOverlayComposition *composition;
+    gboolean                 attach_compo_to_buffer;
+
+    /* statistics, with the lock */
+    guint64                  stats_rendered;
+    GstClockTime             stats_render_cost;
+    guint64                  stats_overlaid;
+    GstClockTime             stats_last_cost;
+    GstClockTime             stats_overlay_cost;
+    guint                    stats_pixels;
 };
 
 struct _GstTtmlRenderClass {
@@ -0,0 +1,406 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Threads shared by all the webrtcbin and ICE agents of the process.
+ *
+ * Each webrtcbin serializes its operations in a WebRTCTaskQueue.  The
+ * queues are run by a single thread pool: a queue with pending tasks is
+ * pushed to the pool once and a pool thread runs its tasks in order, so
+ * that the tasks of a queue never run concurrently nor out of order.  After
+ * a batch of tasks, the queue goes back to the end of the pool to let the
+ * other queues progress.  The GST_WEBRTC_THREADS environment variable sets
+ * the maximum number of threads of the pool.
+ *
+ * The ICE agents need a GMainContext to do their I/O.  A fixed number of
+ * contexts, each run by its own thread, are shared by the agents which are
+ * spread over the least used ones.  The GST_WEBRTC_ICE_THREADS environment
+ * variable sets the number of contexts.  A context thread is stopped when
+ * its last user releases it.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "executor.h"
+
+#define GST_CAT_DEFAULT webrtc_executor_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+/* number of tasks of a queue run before letting the other queues run */
+#define TASK_BATCH 16
+
+typedef struct
+{
+  WebRTCTaskFunc func;
+  gpointer data;
+  GDestroyNotify notify;
+} WebRTCTask;
+
+struct _WebRTCTaskQueue
+{
+  gint refcount;
+
+  GMutex lock;
+  GCond cond;
+  GQueue tasks;
+  /* whether the queue is in the pool or being run */
+  gboolean scheduled;
+  gboolean closed;
+  /* the thread running the tasks */
+  GThread *thread;
+};
+
+typedef struct
+{
+  GMainContext *context;
+  GMainLoop *loop;
+  GThread *thread;
+  guint users;
+} SharedContext;
+
+static GThreadPool *task_pool;
+
+static GMutex context_lock;
+static SharedContext *shared_contexts;
+static guint n_shared_contexts;
+
+static void
+_init_debug (void)
+{
+  static gsize init = 0;
+
+  if (g_once_init_enter (&init)) {
+    GST_DEBUG_CATEGORY_INIT (webrtc_executor_debug, "webrtcexecutor", 0,
+        "webrtcexecutor");
+    g_once_init_leave (&init, 1);
+  }
+}
+
+static guint
+_get_env_uint (const gchar * name, guint default_value)
+{
+  const gchar *str = g_getenv (name);
+  gchar *end = NULL;
+  guint64 val;
+
+  if (!str)
+    return default_value;
+
+  val = g_ascii_strtoull (str, &end, 10);
+  if (end == str || *end != '\0' || val == 0 || val > G_MAXINT) {
+    GST_WARNING ("ignoring invalid value '%s' of %s", str, name);
+    return default_value;
+  }
+
+  return val;
+}
+
+static void
+_free_task (WebRTCTask * task)
+{
+  if (task->notify)
+    task->notify (task->data);
+  g_free (task);
+}
+
+static void
+_run_task_queue (WebRTCTaskQueue * queue, gpointer unused)
+{
+  WebRTCTask *task;
+  guint n_tasks = 0;
+
+  g_mutex_lock (&queue->lock);
+  queue->thread = g_thread_self ();
+  while (!queue->closed && (task = g_queue_pop_head (&queue->tasks))) {
+    g_mutex_unlock (&queue->lock);
+    task->func (task->data);
+    _free_task (task);
+    g_mutex_lock (&queue->lock);
+
+    if (++n_tasks == TASK_BATCH && !queue->closed
+        && !g_queue_is_empty (&queue->tasks)) {
+      /* still scheduled, the pool keeps our reference */
+      queue->thread = NULL;
+      g_mutex_unlock (&queue->lock);
+      g_thread_pool_push (task_pool, queue, NULL);
+      return;
+    }
+  }
+  queue->thread = NULL;
+  queue->scheduled = FALSE;
+  g_cond_broadcast (&queue->cond);
+  g_mutex_unlock (&queue->lock);
+
+  webrtc_task_queue_unref (queue);
+}
+
+static void
+_init_task_pool (void)
+{
+  static gsize init = 0;
+
+  if (g_once_init_enter (&init)) {
+    guint max_threads;
+
+    _init_debug ();
+
+    max_threads = _get_env_uint ("GST_WEBRTC_THREADS",
+        MAX (4, 2 * g_get_num_processors ()));
+    GST_INFO ("running the webrtcbin tasks with up to %u threads",
+        max_threads);
+
+    /* never freed, the threads of a non-exclusive pool exit when idle */
+    task_pool = g_thread_pool_new ((GFunc) _run_task_queue, NULL,
+        max_threads, FALSE, NULL);
+    g_once_init_leave (&init, 1);
+  }
+}
+
+WebRTCTaskQueue *
+webrtc_task_queue_new (void)
+{
+  WebRTCTaskQueue *queue;
+
+  _init_task_pool ();
+
+  queue = g_new0 (WebRTCTaskQueue, 1);
+  queue->refcount = 1;
+  g_mutex_init (&queue->lock);
+  g_cond_init (&queue->cond);
+  g_queue_init (&queue->tasks);
+
+  return queue;
+}
+
+/* runs @func with @data after all the tasks previously pushed to @queue.
+ * @notify is called on @data once the task has run or if it is dropped,
+ * which includes pushing to a closed queue */
+gboolean
+webrtc_task_queue_push (WebRTCTaskQueue * queue, WebRTCTaskFunc func,
+    gpointer data, GDestroyNotify notify)
+{
+  WebRTCTask *task;
+
+  g_mutex_lock (&queue->lock);
+  if (queue->closed) {
+    g_mutex_unlock (&queue->lock);
+    if (notify)
+      notify (data);
+    return FALSE;
+  }
+
+  task = g_new0 (WebRTCTask, 1);
+  task->func = func;
+  task->data = data;
+  task->notify = notify;
+  g_queue_push_tail (&queue->tasks, task);
+
+  if (!queue->scheduled) {
+    queue->scheduled = TRUE;
+    g_atomic_int_inc (&queue->refcount);
+    g_thread_pool_push (task_pool, queue, NULL);
+  }
+  g_mutex_unlock (&queue->lock);
+
+  return TRUE;
+}
+
+/* drops the pending tasks of @queue and waits for the running one, if any,
+ * unless called from it.  Tasks pushed afterwards are dropped too. */
+void
+webrtc_task_queue_close (WebRTCTaskQueue * queue)
+{
+  GQueue dropped = G_QUEUE_INIT;
+  WebRTCTask *task;
+
+  g_mutex_lock (&queue->lock);
+  queue->closed = TRUE;
+  while ((task = g_queue_pop_head (&queue->tasks)))
+    g_queue_push_tail (&dropped, task);
+  while (queue->scheduled && queue->thread != g_thread_self ())
+    g_cond_wait (&queue->cond, &queue->lock);
+  g_mutex_unlock (&queue->lock);
+
+  while ((task = g_queue_pop_head (&dropped)))
+    _free_task (task);
+}
+
+void
+webrtc_task_queue_unref (WebRTCTaskQueue * queue)
+{
+  if (!g_atomic_int_dec_and_test (&queue->refcount))
+    return;
+
+  g_assert (g_queue_is_empty (&queue->tasks));
+  g_mutex_clear (&queue->lock);
+  g_cond_clear (&queue->cond);
+  g_free (queue);
+}
+
+static gpointer
+_run_context (GMainLoop * loop)
+{
+  g_main_loop_run (loop);
+
+  return NULL;
+}
+
+static gboolean
+_quit_loop (GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+struct sync_point
+{
+  GMutex lock;
+  GCond cond;
+  gboolean done;
+};
+
+static gboolean
+_signal_sync_point (struct sync_point *sync)
+{
+  g_mutex_lock (&sync->lock);
+  sync->done = TRUE;
+  g_cond_broadcast (&sync->cond);
+  g_mutex_unlock (&sync->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* waits for whatever @context is currently dispatching */
+static void
+_sync_context (GMainContext * context)
+{
+  struct sync_point sync;
+  GSource *source;
+
+  g_mutex_init (&sync.lock);
+  g_cond_init (&sync.cond);
+  sync.done = FALSE;
+
+  source = g_idle_source_new ();
+  g_source_set_priority (source, G_PRIORITY_HIGH);
+  g_source_set_callback (source, (GSourceFunc) _signal_sync_point, &sync,
+      NULL);
+  g_source_attach (source, context);
+  g_source_unref (source);
+
+  g_mutex_lock (&sync.lock);
+  while (!sync.done)
+    g_cond_wait (&sync.cond, &sync.lock);
+  g_mutex_unlock (&sync.lock);
+
+  g_mutex_clear (&sync.lock);
+  g_cond_clear (&sync.cond);
+}
+
+/* returns a reference to the least used of the shared contexts, which is
+ * iterated by its own thread until released by all its users */
+GMainContext *
+webrtc_executor_acquire_context (void)
+{
+  SharedContext *shared = NULL;
+  guint i;
+
+  _init_debug ();
+
+  g_mutex_lock (&context_lock);
+  if (!shared_contexts) {
+    n_shared_contexts = _get_env_uint ("GST_WEBRTC_ICE_THREADS",
+        g_get_num_processors ());
+    shared_contexts = g_new0 (SharedContext, n_shared_contexts);
+    GST_INFO ("sharing %u ICE contexts", n_shared_contexts);
+  }
+
+  for (i = 0; i < n_shared_contexts; i++) {
+    if (!shared || shared_contexts[i].users < shared->users)
+      shared = &shared_contexts[i];
+  }
+
+  if (!shared->thread) {
+    shared->context = g_main_context_new ();
+    shared->loop = g_main_loop_new (shared->context, FALSE);
+    shared->thread = g_thread_new ("gst-nice-ops",
+        (GThreadFunc) _run_context, shared->loop);
+    GST_DEBUG ("started ICE context %p", shared->context);
+  }
+  shared->users++;
+  g_mutex_unlock (&context_lock);
+
+  return g_main_context_ref (shared->context);
+}
+
+/* releases a context returned by webrtc_executor_acquire_context().  On
+ * return, nothing of the caller is dispatched from the context anymore. */
+void
+webrtc_executor_release_context (GMainContext * context)
+{
+  SharedContext *shared = NULL;
+  GMainLoop *loop = NULL;
+  GThread *thread = NULL;
+  guint i;
+
+  if (!g_main_context_is_owner (context))
+    _sync_context (context);
+
+  g_mutex_lock (&context_lock);
+  for (i = 0; i < n_shared_contexts; i++) {
+    if (shared_contexts[i].context == context) {
+      shared = &shared_contexts[i];
+      break;
+    }
+  }
+  g_assert (shared != NULL && shared->users > 0);
+
+  if (--shared->users == 0) {
+    GSource *source;
+
+    loop = shared->loop;
+    thread = shared->thread;
+
+    /* quitting from a source also works if the loop is not running yet */
+    source = g_idle_source_new ();
+    g_source_set_callback (source, (GSourceFunc) _quit_loop, loop, NULL);
+    g_source_attach (source, context);
+    g_source_unref (source);
+
+    g_main_context_unref (shared->context);
+    shared->context = NULL;
+    shared->loop = NULL;
+    shared->thread = NULL;
+    GST_DEBUG ("stopping ICE context %p", context);
+  }
+  g_mutex_unlock (&context_lock);
+
+  if (thread) {
+    if (thread == g_thread_self ())
+      g_thread_unref (thread);
+    else
+      g_thread_join (thread);
+    g_main_loop_unref (loop);
+  }
+
+  g_main_context_unref (context);
+}
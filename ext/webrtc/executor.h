@@ -0,0 +1,50 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __WEBRTC_EXECUTOR_H__
+#define __WEBRTC_EXECUTOR_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef void (*WebRTCTaskFunc) (gpointer data);
+
+typedef struct _WebRTCTaskQueue WebRTCTaskQueue;
+
+G_GNUC_INTERNAL
+WebRTCTaskQueue *       webrtc_task_queue_new           (void);
+G_GNUC_INTERNAL
+gboolean                webrtc_task_queue_push          (WebRTCTaskQueue * queue,
+                                                         WebRTCTaskFunc func,
+                                                         gpointer data,
+                                                         GDestroyNotify notify);
+G_GNUC_INTERNAL
+void                    webrtc_task_queue_close         (WebRTCTaskQueue * queue);
+G_GNUC_INTERNAL
+void                    webrtc_task_queue_unref         (WebRTCTaskQueue * queue);
+
+G_GNUC_INTERNAL
+GMainContext *          webrtc_executor_acquire_context (void);
+G_GNUC_INTERNAL
+void                    webrtc_executor_release_context (GMainContext * context);
+
+G_END_DECLS
+
+#endif /* __WEBRTC_EXECUTOR_H__ */
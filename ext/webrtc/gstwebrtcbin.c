@@ -29,6 +29,8 @@
 #include "webrtcsdp.h"
 #include "webrtctransceiver.h"
 
+#include <gst/rtp/rtp.h>
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,6 +40,10 @@
        (guint64) g_random_int ())) & \
     G_GUINT64_CONSTANT (0x7fffffffffffffff))
 
+#define RTPHDREXT_MID "urn:ietf:params:rtp-hdrext:sdes:mid"
+/* the id we offer the MID header extension with, the only one we use */
+#define DEFAULT_MID_EXT_ID 1
+
 #define PC_GET_LOCK(w) (&w->priv->pc_lock)
 #define PC_LOCK(w) (g_mutex_lock (PC_GET_LOCK(w)))
 #define PC_UNLOCK(w) (g_mutex_unlock (PC_GET_LOCK(w)))
@@ -61,6 +67,22 @@
  * On the receiving side, RTPTransceiver's are created in response to setting
  * a remote description.  Output pads for the receiving streams in the set
  * description are also created.
+ *
+ * With a bundle-policy other than none, media are grouped with
+ * a=group:BUNDLE and bundled media share the transport (and rtpbin session)
+ * of the first media of the group.  The sending streams are muxed with an
+ * rtpfunnel and the received ones are sent to the right output pad
+ * depending on their MID, carried in the
+ * urn:ietf:params:rtp-hdrext:sdes:mid RTP header extension when both sides
+ * negotiated it, and otherwise on the SSRC's or the payload types of each
+ * media.  Once an answer settled the group, the transports the bundled
+ * media moved away from are torn down.
+ *
+ * The operations of each webrtcbin (and the emission of the signals from
+ * them) are serialized but run on a thread pool shared with all the other
+ * webrtcbin's of the process, see executor.c.  The GST_WEBRTC_THREADS and
+ * GST_WEBRTC_ICE_THREADS environment variables size the shared threads.
+ * Signal handlers blocking for long hold one of these threads.
  */
 
 /*
@@ -68,7 +90,6 @@
  * assert sending payload type matches the stream
  * reconfiguration (of anything)
  * LS groups
- * bundling
  * setting custom DTLS certificates
  * data channel
  *
@@ -145,6 +166,170 @@ _transport_stream_get_caps_for_pt (TransportStream * stream, guint pt)
   return NULL;
 }
 
+/* Finds the media a received stream belongs to, by its SSRC if the remote
+ * announced it or sent it with a MID, and otherwise by its payload type.
+ * Returns -1 if unknown. */
+static gint
+_transport_stream_get_media_idx (TransportStream * stream, guint32 ssrc,
+    guint pt)
+{
+  gint ret = -1;
+  guint i, len;
+
+  GST_OBJECT_LOCK (stream);
+  len = stream->remote_ssrcmap->len;
+  for (i = 0; i < len && ret < 0; i++) {
+    SsrcMapItem *item = &g_array_index (stream->remote_ssrcmap, SsrcMapItem, i);
+    if (item->ssrc == ssrc)
+      ret = item->media_idx;
+  }
+
+  len = stream->ptmap->len;
+  for (i = 0; i < len && ret < 0; i++) {
+    PtMapItem *item = &g_array_index (stream->ptmap, PtMapItem, i);
+    if (item->pt == pt)
+      ret = item->media_idx;
+  }
+  GST_OBJECT_UNLOCK (stream);
+
+  return ret;
+}
+
+/* Learns the media of a SSRC from the MID it is sent with, before rtpbin
+ * demuxes the streams of the transport */
+static gboolean
+_transport_stream_learn_mid (GstBuffer ** buffer, guint idx,
+    TransportStream * stream)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  gpointer data;
+  guint size, i;
+  guint32 ssrc;
+
+  if (!gst_rtp_buffer_map (*buffer, GST_MAP_READ, &rtp))
+    return TRUE;
+
+  GST_OBJECT_LOCK (stream);
+  if (stream->mid_ext_id && gst_rtp_buffer_get_extension_onebyte_header (&rtp,
+          stream->mid_ext_id, 0, &data, &size)) {
+    ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+
+    for (i = 0; i < stream->midmap->len; i++) {
+      MidMapItem *item = &g_array_index (stream->midmap, MidMapItem, i);
+
+      if (strlen (item->mid) == size && memcmp (item->mid, data, size) == 0)
+        break;
+    }
+
+    if (i < stream->midmap->len) {
+      guint media_idx = g_array_index (stream->midmap, MidMapItem, i).media_idx;
+
+      /* the MID overrides whatever the SDP said about the SSRC */
+      for (i = 0; i < stream->remote_ssrcmap->len; i++) {
+        SsrcMapItem *item =
+            &g_array_index (stream->remote_ssrcmap, SsrcMapItem, i);
+
+        if (item->ssrc == ssrc) {
+          item->media_idx = media_idx;
+          break;
+        }
+      }
+      if (i == stream->remote_ssrcmap->len) {
+        SsrcMapItem item = { ssrc, media_idx };
+
+        GST_LOG_OBJECT (stream, "SSRC %u belongs to media %u", ssrc,
+            media_idx);
+        g_array_append_val (stream->remote_ssrcmap, item);
+      }
+    }
+  }
+  GST_OBJECT_UNLOCK (stream);
+
+  gst_rtp_buffer_unmap (&rtp);
+
+  return TRUE;
+}
+
+static GstPadProbeReturn
+_on_receive_rtp_probe (GstPad * pad, GstPadProbeInfo * info,
+    TransportStream * stream)
+{
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    gst_buffer_list_foreach (GST_PAD_PROBE_INFO_BUFFER_LIST (info),
+        (GstBufferListFunc) _transport_stream_learn_mid, stream);
+  } else {
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+    _transport_stream_learn_mid (&buffer, 0, stream);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+struct mid_ext
+{
+  guint8 id;
+  gchar mid[17];                /* the one-byte header form fits 16 bytes */
+};
+
+static gboolean
+_add_mid_ext_to_buffer (GstBuffer ** buffer, guint idx, struct mid_ext *ext)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  gpointer data;
+  guint size;
+
+  *buffer = gst_buffer_make_writable (*buffer);
+  if (!gst_rtp_buffer_map (*buffer, GST_MAP_READWRITE, &rtp))
+    return TRUE;
+
+  if (!gst_rtp_buffer_get_extension_onebyte_header (&rtp, ext->id, 0, &data,
+          &size)
+      && !gst_rtp_buffer_add_extension_onebyte_header (&rtp, ext->id,
+          ext->mid, strlen (ext->mid)))
+    GST_LOG ("could not add the MID to %" GST_PTR_FORMAT, *buffer);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return TRUE;
+}
+
+/* Sends the MID of @trans with its packets so that the receiver of a
+ * bundle can tell the media apart */
+static GstPadProbeReturn
+_on_send_rtp_probe (GstPad * pad, GstPadProbeInfo * info,
+    WebRTCTransceiver * trans)
+{
+  GstWebRTCRTPTransceiver *rtp_trans = GST_WEBRTC_RTP_TRANSCEIVER (trans);
+  struct mid_ext ext = { 0, };
+
+  GST_OBJECT_LOCK (trans);
+  if (trans->mid_ext_id && rtp_trans->mid && rtp_trans->mid[0] != '\0'
+      && strlen (rtp_trans->mid) < sizeof (ext.mid)) {
+    ext.id = trans->mid_ext_id;
+    g_strlcpy (ext.mid, rtp_trans->mid, sizeof (ext.mid));
+  }
+  GST_OBJECT_UNLOCK (trans);
+
+  if (!ext.id)
+    return GST_PAD_PROBE_OK;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+
+    list = gst_buffer_list_make_writable (list);
+    gst_buffer_list_foreach (list, (GstBufferListFunc) _add_mid_ext_to_buffer,
+        &ext);
+    GST_PAD_PROBE_INFO_DATA (info) = list;
+  } else {
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+    _add_mid_ext_to_buffer (&buffer, 0, &ext);
+    GST_PAD_PROBE_INFO_DATA (info) = buffer;
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
 static void
 gst_webrtc_bin_pad_init (GstWebRTCBinPad * pad)
 {
@@ -213,8 +398,11 @@ enum
   PROP_PENDING_REMOTE_DESCRIPTION,
   PROP_STUN_SERVER,
   PROP_TURN_SERVER,
+  PROP_BUNDLE_POLICY,
 };
 
+#define DEFAULT_BUNDLE_POLICY GST_WEBRTC_BUNDLE_POLICY_NONE
+
 static guint gst_webrtc_bin_signals[LAST_SIGNAL] = { 0 };
 
 static GstWebRTCDTLSTransport *
@@ -381,6 +569,64 @@ _find_transport_for_session (GstWebRTCBin * webrtc, guint session_id)
   return stream;
 }
 
+/* Returns the session, and so the TransportStream, used by the media
+ * @media_idx of @desc.  Bundled media use the session of the first media of
+ * the BUNDLE group.  In our own offers, only bundle-only media are bundled
+ * as the answer may still refuse the group. */
+static guint
+_get_session_for_media (GstWebRTCBin * webrtc, SDPSource source,
+    const GstWebRTCSessionDescription * desc, guint media_idx)
+{
+  const GstSDPMedia *media;
+  const gchar *mid;
+  gchar **bundled;
+  guint ret = media_idx;
+
+  if (webrtc->priv->bundle_policy == GST_WEBRTC_BUNDLE_POLICY_NONE)
+    return media_idx;
+
+  if (!(bundled = _parse_bundle (desc->sdp)))
+    return media_idx;
+
+  media = gst_sdp_message_get_media (desc->sdp, media_idx);
+  mid = gst_sdp_media_get_attribute_val (media, "mid");
+
+  if (mid && g_strv_contains ((const gchar **) bundled, mid)) {
+    if (source == SDP_REMOTE || desc->type != GST_WEBRTC_SDP_TYPE_OFFER
+        || _media_is_bundle_only (media)) {
+      gint tag_idx = _get_media_index_for_mid (desc->sdp, bundled[0]);
+
+      if (tag_idx >= 0)
+        ret = tag_idx;
+    }
+  }
+
+  g_strfreev (bundled);
+
+  return ret;
+}
+
+/* Media with a zero port are rejected unless they are bundled */
+static gboolean
+_media_is_rejected (const GstSDPMessage * sdp, guint media_idx)
+{
+  const GstSDPMedia *media = gst_sdp_message_get_media (sdp, media_idx);
+  const gchar *mid = gst_sdp_media_get_attribute_val (media, "mid");
+  gchar **bundled;
+  gboolean ret;
+
+  if (gst_sdp_media_get_port (media) != 0 || _media_is_bundle_only (media))
+    return FALSE;
+
+  if (!mid || !(bundled = _parse_bundle (sdp)))
+    return TRUE;
+
+  ret = !g_strv_contains ((const gchar **) bundled, mid);
+  g_strfreev (bundled);
+
+  return ret;
+}
+
 typedef gboolean (*FindPadFunc) (GstWebRTCBinPad * p1, gconstpointer data);
 
 static GstWebRTCBinPad *
@@ -507,67 +753,29 @@ match_for_pad (GstWebRTCBinPad * pad, GstWebRTCBinPad * other)
 }
 #endif
 
-static gboolean
-_unlock_pc_thread (GMutex * lock)
-{
-  g_mutex_unlock (lock);
-  return G_SOURCE_REMOVE;
-}
-
-static gpointer
-_gst_pc_thread (GstWebRTCBin * webrtc)
-{
-  PC_LOCK (webrtc);
-  webrtc->priv->main_context = g_main_context_new ();
-  webrtc->priv->loop = g_main_loop_new (webrtc->priv->main_context, FALSE);
-
-  PC_COND_BROADCAST (webrtc);
-  g_main_context_invoke (webrtc->priv->main_context,
-      (GSourceFunc) _unlock_pc_thread, PC_GET_LOCK (webrtc));
-
-  /* Having the thread be the thread default GMainContext will break the
-   * required queue-like ordering (from W3's peerconnection spec) of re-entrant
-   * tasks */
-  g_main_loop_run (webrtc->priv->loop);
-
-  PC_LOCK (webrtc);
-  g_main_context_unref (webrtc->priv->main_context);
-  webrtc->priv->main_context = NULL;
-  g_main_loop_unref (webrtc->priv->loop);
-  webrtc->priv->loop = NULL;
-  PC_COND_BROADCAST (webrtc);
-  PC_UNLOCK (webrtc);
-
-  return NULL;
-}
-
 static void
-_start_thread (GstWebRTCBin * webrtc)
+_start_task_queue (GstWebRTCBin * webrtc)
 {
   PC_LOCK (webrtc);
-  webrtc->priv->thread = g_thread_new ("gst-pc-ops",
-      (GThreadFunc) _gst_pc_thread, webrtc);
-
-  while (!webrtc->priv->loop)
-    PC_COND_WAIT (webrtc);
+  webrtc->priv->task_queue = webrtc_task_queue_new ();
   webrtc->priv->is_closed = FALSE;
   PC_UNLOCK (webrtc);
 }
 
+/* the queue itself is only freed on finalize, so that tasks enqueued from
+ * other threads meanwhile are dropped by the closed queue */
 static void
-_stop_thread (GstWebRTCBin * webrtc)
+_stop_task_queue (GstWebRTCBin * webrtc)
 {
   PC_LOCK (webrtc);
   webrtc->priv->is_closed = TRUE;
-  g_main_loop_quit (webrtc->priv->loop);
-  while (webrtc->priv->loop)
-    PC_COND_WAIT (webrtc);
   PC_UNLOCK (webrtc);
 
-  g_thread_unref (webrtc->priv->thread);
+  /* waits for the running task, which takes the PC lock */
+  webrtc_task_queue_close (webrtc->priv->task_queue);
 }
 
-static gboolean
+static void
 _execute_op (GstWebRTCBinTask * op)
 {
   PC_LOCK (op->webrtc);
@@ -581,7 +789,6 @@ _execute_op (GstWebRTCBinTask * op)
 
 out:
   PC_UNLOCK (op->webrtc);
-  return G_SOURCE_REMOVE;
 }
 
 static void
@@ -597,28 +804,22 @@ gst_webrtc_bin_enqueue_task (GstWebRTCBin * webrtc, GstWebRTCBinFunc func,
     gpointer data, GDestroyNotify notify)
 {
   GstWebRTCBinTask *op;
-  GSource *source;
 
   g_return_if_fail (GST_IS_WEBRTC_BIN (webrtc));
 
-  if (webrtc->priv->is_closed) {
-    GST_DEBUG_OBJECT (webrtc, "Peerconnection is closed, aborting execution");
-    if (notify)
-      notify (data);
-    return;
-  }
   op = g_new0 (GstWebRTCBinTask, 1);
   op->webrtc = webrtc;
   op->op = func;
   op->data = data;
   op->notify = notify;
 
-  source = g_idle_source_new ();
-  g_source_set_priority (source, G_PRIORITY_DEFAULT);
-  g_source_set_callback (source, (GSourceFunc) _execute_op, op,
-      (GDestroyNotify) _free_op);
-  g_source_attach (source, webrtc->priv->main_context);
-  g_source_unref (source);
+  /* the tasks of a webrtcbin run in order, on any of the shared threads.
+   * The closed state is checked under the lock of the queue, which may be
+   * closed concurrently, and the PC lock can't be taken here as tasks
+   * enqueue others while holding it. */
+  if (!webrtc_task_queue_push (webrtc->priv->task_queue,
+          (WebRTCTaskFunc) _execute_op, op, (GDestroyNotify) _free_op))
+    GST_DEBUG_OBJECT (webrtc, "Peerconnection is closed, aborting execution");
 }
 
 /* https://www.w3.org/TR/webrtc/#dom-rtciceconnectionstate */
@@ -1262,6 +1463,7 @@ _create_transport_channel (GstWebRTCBin * webrtc, guint session_id)
   GstWebRTCDTLSTransport *transport;
   TransportStream *ret;
   gchar *pad_name;
+  GstPad *pad;
 
   /* FIXME: how to parametrize the sender and the receiver */
   ret = transport_stream_new (webrtc, session_id);
@@ -1288,6 +1490,12 @@ _create_transport_channel (GstWebRTCBin * webrtc, guint session_id)
   gst_bin_add (GST_BIN (webrtc), GST_ELEMENT (ret->send_bin));
   gst_bin_add (GST_BIN (webrtc), GST_ELEMENT (ret->receive_bin));
 
+  pad = gst_element_get_static_pad (GST_ELEMENT (ret->receive_bin), "rtp_src");
+  gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) _on_receive_rtp_probe, ret, NULL);
+  gst_object_unref (pad);
+
   pad_name = g_strdup_printf ("recv_rtcp_sink_%u", ret->session_id);
   if (!gst_element_link_pads (GST_ELEMENT (ret->receive_bin), "rtcp_src",
           GST_ELEMENT (webrtc->rtpbin), pad_name))
@@ -1311,6 +1519,90 @@ _create_transport_channel (GstWebRTCBin * webrtc, guint session_id)
   return ret;
 }
 
+static void
+_release_rtpbin_pad (GstWebRTCBin * webrtc, const gchar * name_templ,
+    guint session_id)
+{
+  gchar *pad_name = g_strdup_printf (name_templ, session_id);
+  GstPad *pad = gst_element_get_static_pad (webrtc->rtpbin, pad_name);
+
+  if (pad) {
+    gst_element_release_request_pad (webrtc->rtpbin, pad);
+    gst_object_unref (pad);
+  }
+  g_free (pad_name);
+}
+
+/* Tears down the transport at @idx: its elements, its rtpbin session and
+ * its ICE stream so that no ICE checks or DTLS handshake keep running on
+ * it. */
+static void
+_remove_transport (GstWebRTCBin * webrtc, guint idx)
+{
+  TransportStream *stream =
+      g_array_index (webrtc->priv->transports, TransportStream *, idx);
+  GstElement *elements[3];
+  guint i;
+
+  GST_DEBUG_OBJECT (webrtc, "removing unused transport %" GST_PTR_FORMAT
+      " of session %u", stream, stream->session_id);
+
+  elements[0] = GST_ELEMENT (stream->send_bin);
+  elements[1] = GST_ELEMENT (stream->receive_bin);
+  elements[2] = stream->rtpfunnel;
+  for (i = 0; i < G_N_ELEMENTS (elements); i++) {
+    if (!elements[i])
+      continue;
+    gst_element_set_state (elements[i], GST_STATE_NULL);
+    gst_bin_remove (GST_BIN (webrtc), elements[i]);
+  }
+  stream->rtpfunnel = NULL;
+
+  /* rtpbin frees the session with its last pad */
+  _release_rtpbin_pad (webrtc, "send_rtp_sink_%u", stream->session_id);
+  _release_rtpbin_pad (webrtc, "send_rtcp_src_%u", stream->session_id);
+  _release_rtpbin_pad (webrtc, "recv_rtp_sink_%u", stream->session_id);
+  _release_rtpbin_pad (webrtc, "recv_rtcp_sink_%u", stream->session_id);
+
+  for (i = 0; i < webrtc->priv->ice_stream_map->len; i++) {
+    IceStreamItem *item =
+        &g_array_index (webrtc->priv->ice_stream_map, IceStreamItem, i);
+
+    if (item->stream == stream->stream) {
+      g_array_remove_index (webrtc->priv->ice_stream_map, i);
+      break;
+    }
+  }
+  gst_webrtc_ice_remove_stream (webrtc->priv->ice, stream->stream);
+  stream->stream = NULL;
+
+  g_array_remove_index (webrtc->priv->transports, idx);
+}
+
+/* Once an answer settled the BUNDLE group, the transports that the media
+ * moved away from are not used anymore */
+static void
+_remove_unused_transports (GstWebRTCBin * webrtc)
+{
+  gint i, j;
+
+  for (i = webrtc->priv->transports->len - 1; i >= 0; i--) {
+    TransportStream *stream =
+        g_array_index (webrtc->priv->transports, TransportStream *, i);
+
+    for (j = 0; j < webrtc->priv->transceivers->len; j++) {
+      WebRTCTransceiver *trans = WEBRTC_TRANSCEIVER (g_array_index
+          (webrtc->priv->transceivers, GstWebRTCRTPTransceiver *, j));
+
+      if (trans->stream == stream)
+        break;
+    }
+
+    if (j == webrtc->priv->transceivers->len)
+      _remove_transport (webrtc, i);
+  }
+}
+
 /* based off https://tools.ietf.org/html/draft-ietf-rtcweb-jsep-18#section-5.2.1 */
 static gboolean
 sdp_media_from_transceiver (GstWebRTCBin * webrtc, GstSDPMedia * media,
@@ -1390,41 +1682,151 @@ sdp_media_from_transceiver (GstWebRTCBin * webrtc, GstSDPMedia * media,
   gst_sdp_media_add_attribute (media, "mid", sdp_mid);
   g_free (sdp_mid);
 
-  if (trans->sender) {
-    gchar *cert, *fingerprint, *val;
+  gst_caps_unref (caps);
 
-    if (!trans->sender->transport) {
-      TransportStream *item;
-      /* FIXME: bundle */
-      item = _find_transport_for_session (webrtc, media_idx);
-      if (!item)
-        item = _create_transport_channel (webrtc, media_idx);
-      webrtc_transceiver_set_transport (WEBRTC_TRANSCEIVER (trans), item);
+  return TRUE;
+}
+
+static void
+_add_fingerprint_to_media (GstWebRTCDTLSTransport * transport,
+    GstSDPMedia * media)
+{
+  gchar *cert, *fingerprint, *val;
+
+  g_object_get (transport, "certificate", &cert, NULL);
+
+  fingerprint =
+      _generate_fingerprint_from_certificate (cert, G_CHECKSUM_SHA256);
+  g_free (cert);
+  val =
+      g_strdup_printf ("%s %s",
+      _g_checksum_to_webrtc_string (G_CHECKSUM_SHA256), fingerprint);
+  g_free (fingerprint);
+
+  gst_sdp_media_add_attribute (media, "fingerprint", val);
+  g_free (val);
+}
+
+/* the id of the MID RTP header extension in @media, 0 if there is none or
+ * if it doesn't fit the one-byte header form */
+static guint8
+_media_get_mid_ext_id (const GstSDPMedia * media)
+{
+  guint8 ret = 0;
+  int i;
+
+  for (i = 0; i < gst_sdp_media_attributes_len (media) && !ret; i++) {
+    const GstSDPAttribute *attr = gst_sdp_media_get_attribute (media, i);
+    gchar **tokens;
+
+    if (g_strcmp0 (attr->key, "extmap") != 0 || !attr->value)
+      continue;
+
+    /* a=extmap:<value>["/"<direction>] <URI> <extensionattributes> */
+    tokens = g_strsplit (attr->value, " ", 3);
+    if (tokens[0] && g_strcmp0 (tokens[1], RTPHDREXT_MID) == 0) {
+      guint64 id = g_ascii_strtoull (tokens[0], NULL, 10);
+
+      if (id >= 1 && id <= 14)
+        ret = id;
     }
+    g_strfreev (tokens);
+  }
+
+  return ret;
+}
+
+static void
+_add_mid_ext_to_media (guint8 id, GstSDPMedia * media)
+{
+  gchar *val = g_strdup_printf ("%u %s", id, RTPHDREXT_MID);
+
+  gst_sdp_media_add_attribute (media, "extmap", val);
+  g_free (val);
+}
+
+/* whether @media, about to be added to the offer @sdp, only uses the
+ * transport of the bundle */
+static gboolean
+_offer_media_is_bundle_only (GstWebRTCBin * webrtc, const GstSDPMessage * sdp,
+    const GstSDPMedia * media)
+{
+  int i;
 
-    g_object_get (trans->sender->transport, "certificate", &cert, NULL);
+  /* the first media always carries the transport of the bundle */
+  if (gst_sdp_message_medias_len (sdp) == 0)
+    return FALSE;
 
-    fingerprint =
-        _generate_fingerprint_from_certificate (cert, G_CHECKSUM_SHA256);
-    g_free (cert);
-    val =
-        g_strdup_printf ("%s %s",
-        _g_checksum_to_webrtc_string (G_CHECKSUM_SHA256), fingerprint);
-    g_free (fingerprint);
+  switch (webrtc->priv->bundle_policy) {
+    case GST_WEBRTC_BUNDLE_POLICY_MAX_BUNDLE:
+      return TRUE;
+    case GST_WEBRTC_BUNDLE_POLICY_BALANCED:
+      /* one transport per media type */
+      for (i = 0; i < gst_sdp_message_medias_len (sdp); i++) {
+        const GstSDPMedia *other = gst_sdp_message_get_media (sdp, i);
 
-    gst_sdp_media_add_attribute (media, "fingerprint", val);
-    g_free (val);
+        if (g_strcmp0 (gst_sdp_media_get_media (other),
+                gst_sdp_media_get_media (media)) == 0)
+          return TRUE;
+      }
+      return FALSE;
+    default:
+      return FALSE;
   }
+}
 
-  gst_caps_unref (caps);
+static GstPad *_connect_input_stream (GstWebRTCBin * webrtc,
+    GstWebRTCBinPad * pad);
 
-  return TRUE;
+/* Moves @trans to @stream.  If its sink pad already feeds another transport,
+ * the pad is moved to the rtpfunnel of @stream, otherwise its media would
+ * keep going to a transport that bundling left unused. */
+static void
+_move_transceiver_to_transport (GstWebRTCBin * webrtc,
+    WebRTCTransceiver * trans, TransportStream * stream)
+{
+  TransportStream *old_stream = trans->stream;
+  GstWebRTCBinPad *pad;
+  GstPad *target;
+
+  if (old_stream == stream)
+    return;
+
+  webrtc_transceiver_set_transport (trans, stream);
+  if (!old_stream)
+    return;
+
+  pad = _find_pad_for_transceiver (webrtc, GST_PAD_SINK,
+      GST_WEBRTC_RTP_TRANSCEIVER (trans));
+  if (!pad)
+    return;
+
+  target = gst_ghost_pad_get_target (GST_GHOST_PAD (pad));
+  if (target) {
+    GstElement *parent = gst_pad_get_parent_element (target);
+
+    GST_DEBUG_OBJECT (webrtc, "moving %" GST_PTR_FORMAT " from session %u "
+        "to session %u", pad, old_stream->session_id, stream->session_id);
+
+    gst_ghost_pad_set_target (GST_GHOST_PAD (pad), NULL);
+    if (parent) {
+      gst_element_release_request_pad (parent, target);
+      gst_object_unref (parent);
+    }
+    gst_object_unref (target);
+
+    _connect_input_stream (webrtc, pad);
+  }
+  gst_object_unref (pad);
 }
 
 static GstSDPMessage *
 _create_offer_task (GstWebRTCBin * webrtc, const GstStructure * options)
 {
   GstSDPMessage *ret;
+  GString *bundled_mids = NULL;
+  TransportStream *bundle_stream = NULL;
+  gchar *bundle_ufrag = NULL, *bundle_pwd = NULL;
   int i;
 
   gst_sdp_message_new (&ret);
@@ -1440,34 +1842,83 @@ _create_offer_task (GstWebRTCBin * webrtc, const GstStructure * options)
   gst_sdp_message_add_time (ret, "0", "0", NULL);
   gst_sdp_message_add_attribute (ret, "ice-options", "trickle");
 
+  if (webrtc->priv->bundle_policy != GST_WEBRTC_BUNDLE_POLICY_NONE)
+    bundled_mids = g_string_new ("BUNDLE");
+
   /* for each rtp transceiver */
   for (i = 0; i < webrtc->priv->transceivers->len; i++) {
     GstWebRTCRTPTransceiver *trans;
+    WebRTCTransceiver *wtrans;
     GstSDPMedia media = { 0, };
     gchar *ufrag, *pwd;
 
     trans =
         g_array_index (webrtc->priv->transceivers, GstWebRTCRTPTransceiver *,
         i);
+    wtrans = WEBRTC_TRANSCEIVER (trans);
 
     gst_sdp_media_init (&media);
     /* mandated by JSEP */
     gst_sdp_media_add_attribute (&media, "setup", "actpass");
 
-    /* FIXME: only needed when restarting ICE */
-    _generate_ice_credentials (&ufrag, &pwd);
+    if (!sdp_media_from_transceiver (webrtc, &media, trans,
+            GST_WEBRTC_SDP_TYPE_OFFER, i)) {
+      gst_sdp_media_uninit (&media);
+      continue;
+    }
+
+    if (bundled_mids && _offer_media_is_bundle_only (webrtc, ret, &media)) {
+      /* the remote has to accept the bundle for this media to be used */
+      gst_sdp_media_set_port_info (&media, 0, 0);
+      gst_sdp_media_add_attribute (&media, "bundle-only", NULL);
+
+      _move_transceiver_to_transport (webrtc, wtrans, bundle_stream);
+      ufrag = g_strdup (bundle_ufrag);
+      pwd = g_strdup (bundle_pwd);
+    } else {
+      if (!wtrans->stream) {
+        TransportStream *item = _find_transport_for_session (webrtc, i);
+        if (!item)
+          item = _create_transport_channel (webrtc, i);
+        webrtc_transceiver_set_transport (wtrans, item);
+      }
+
+      /* FIXME: only needed when restarting ICE */
+      _generate_ice_credentials (&ufrag, &pwd);
+
+      if (bundled_mids && !bundle_stream) {
+        bundle_stream = wtrans->stream;
+        bundle_ufrag = g_strdup (ufrag);
+        bundle_pwd = g_strdup (pwd);
+      }
+    }
+
     gst_sdp_media_add_attribute (&media, "ice-ufrag", ufrag);
     gst_sdp_media_add_attribute (&media, "ice-pwd", pwd);
     g_free (ufrag);
     g_free (pwd);
 
-    if (sdp_media_from_transceiver (webrtc, &media, trans,
-            GST_WEBRTC_SDP_TYPE_OFFER, i))
-      gst_sdp_message_add_media (ret, &media);
-    else
-      gst_sdp_media_uninit (&media);
+    _add_fingerprint_to_media (wtrans->stream->transport, &media);
+
+    if (bundled_mids) {
+      g_string_append_printf (bundled_mids, " %s",
+          gst_sdp_media_get_attribute_val (&media, "mid"));
+      /* lets the bundled media be told apart whatever their SSRC's and
+       * payload types */
+      _add_mid_ext_to_media (DEFAULT_MID_EXT_ID, &media);
+    }
+
+    gst_sdp_message_add_media (ret, &media);
   }
 
+  if (bundled_mids) {
+    if (gst_sdp_message_medias_len (ret) > 0)
+      gst_sdp_message_add_attribute (ret, "group", bundled_mids->str);
+    g_string_free (bundled_mids, TRUE);
+  }
+  g_free (bundle_ufrag);
+  g_free (bundle_pwd);
+
   /* FIXME: pre-emptively setup receiving elements when needed */
 
   /* XXX: only true for the initial offerer */
@@ -1482,6 +1933,9 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
   GstSDPMessage *ret = NULL;
   const GstWebRTCSessionDescription *pending_remote =
       webrtc->pending_remote_description;
+  GString *bundled_mids = NULL;
+  gchar **bundled = NULL;
+  gchar *bundle_ufrag = NULL, *bundle_pwd = NULL;
   int i;
 
   if (!webrtc->pending_remote_description) {
@@ -1490,6 +1944,13 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
     return NULL;
   }
 
+  if (webrtc->priv->bundle_policy != GST_WEBRTC_BUNDLE_POLICY_NONE
+      && (bundled = _parse_bundle (pending_remote->sdp))) {
+    bundled_mids = g_string_new ("BUNDLE");
+    /* FIXME: only needed when restarting ICE */
+    _generate_ice_credentials (&bundle_ufrag, &bundle_pwd);
+  }
+
   gst_sdp_message_new (&ret);
 
   /* FIXME: session id and version need special handling depending on the state we're in */
@@ -1512,9 +1973,6 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
   }
 
   for (i = 0; i < gst_sdp_message_medias_len (pending_remote->sdp); i++) {
-    /* FIXME:
-     * bundle policy
-     */
     GstSDPMedia *media = NULL;
     GstSDPMedia *offer_media;
     GstWebRTCRTPTransceiver *rtp_trans = NULL;
@@ -1522,15 +1980,28 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
     GstWebRTCRTPTransceiverDirection offer_dir, answer_dir;
     GstWebRTCDTLSSetup offer_setup, answer_setup;
     GstCaps *offer_caps, *answer_caps = NULL;
-    gchar *cert;
+    const gchar *mid;
+    gboolean media_in_bundle;
+    guint session_id;
     int j;
 
+    offer_media =
+        (GstSDPMedia *) gst_sdp_message_get_media (pending_remote->sdp, i);
+    mid = gst_sdp_media_get_attribute_val (offer_media, "mid");
+    media_in_bundle = bundled && mid
+        && g_strv_contains ((const gchar **) bundled, mid);
+    session_id = _get_session_for_media (webrtc, SDP_REMOTE,
+        pending_remote, i);
+
     gst_sdp_media_new (&media);
     gst_sdp_media_set_port_info (media, 9, 0);
     gst_sdp_media_set_proto (media, "UDP/TLS/RTP/SAVPF");
     gst_sdp_media_add_connection (media, "IN", "IP4", "0.0.0.0", 0, 0);
 
-    {
+    if (media_in_bundle) {
+      gst_sdp_media_add_attribute (media, "ice-ufrag", bundle_ufrag);
+      gst_sdp_media_add_attribute (media, "ice-pwd", bundle_pwd);
+    } else {
       /* FIXME: only needed when restarting ICE */
       gchar *ufrag, *pwd;
       _generate_ice_credentials (&ufrag, &pwd);
@@ -1540,8 +2011,6 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
       g_free (pwd);
     }
 
-    offer_media =
-        (GstSDPMedia *) gst_sdp_message_get_media (pending_remote->sdp, i);
     for (j = 0; j < gst_sdp_media_attributes_len (offer_media); j++) {
       const GstSDPAttribute *attr =
           gst_sdp_media_get_attribute (offer_media, j);
@@ -1573,6 +2042,14 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
       gst_caps_append (offer_caps, caps);
     }
 
+    /* media the offerer only wants to send over the bundle can't be
+     * accepted without bundling */
+    if (gst_sdp_media_get_port (offer_media) == 0
+        && (!media_in_bundle || !_media_is_bundle_only (offer_media))) {
+      GST_INFO_OBJECT (webrtc, "media %u is bundle-only or was rejected", i);
+      goto rejected;
+    }
+
     for (j = 0; j < webrtc->priv->transceivers->len; j++) {
       GstCaps *trans_caps;
 
@@ -1656,29 +2133,23 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
     }
     _media_replace_setup (media, answer_setup);
 
-    /* FIXME: bundle! */
-    if (!trans->stream) {
-      TransportStream *item = _find_transport_for_session (webrtc, i);
+    /* bundled media move to the transport of the bundle */
+    if (!trans->stream || (media_in_bundle
+            && trans->stream->session_id != session_id)) {
+      TransportStream *item = _find_transport_for_session (webrtc, session_id);
       if (!item)
-        item = _create_transport_channel (webrtc, i);
-      webrtc_transceiver_set_transport (trans, item);
+        item = _create_transport_channel (webrtc, session_id);
+      _move_transceiver_to_transport (webrtc, trans, item);
     }
     /* set the a=fingerprint: for this transport */
-    g_object_get (trans->stream->transport, "certificate", &cert, NULL);
+    _add_fingerprint_to_media (trans->stream->transport, media);
 
-    {
-      gchar *fingerprint, *val;
-
-      fingerprint =
-          _generate_fingerprint_from_certificate (cert, G_CHECKSUM_SHA256);
-      g_free (cert);
-      val =
-          g_strdup_printf ("%s %s",
-          _g_checksum_to_webrtc_string (G_CHECKSUM_SHA256), fingerprint);
-      g_free (fingerprint);
-
-      gst_sdp_media_add_attribute (media, "fingerprint", val);
-      g_free (val);
+    if (media_in_bundle) {
+      guint8 mid_ext_id = _media_get_mid_ext_id (offer_media);
+
+      g_string_append_printf (bundled_mids, " %s", mid);
+      if (mid_ext_id)
+        _add_mid_ext_to_media (mid_ext_id, media);
     }
 
     if (0) {
@@ -1687,6 +2158,11 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
       gst_sdp_media_free (media);
       gst_sdp_media_copy (offer_media, &media);
       gst_sdp_media_set_port_info (media, 0, 0);
+      for (j = gst_sdp_media_attributes_len (media) - 1; j >= 0; j--) {
+        const GstSDPAttribute *attr = gst_sdp_media_get_attribute (media, j);
+        if (g_strcmp0 (attr->key, "bundle-only") == 0)
+          gst_sdp_media_remove_attribute (media, j);
+      }
     }
     gst_sdp_message_add_media (ret, media);
     gst_sdp_media_free (media);
@@ -1696,6 +2172,16 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
 
   /* FIXME: can we add not matched transceivers? */
 
+  if (bundled_mids) {
+    /* only the accepted media are part of the group */
+    if (strchr (bundled_mids->str, ' '))
+      gst_sdp_message_add_attribute (ret, "group", bundled_mids->str);
+    g_string_free (bundled_mids, TRUE);
+  }
+  g_strfreev (bundled);
+  g_free (bundle_ufrag);
+  g_free (bundle_pwd);
+
   /* XXX: only true for the initial offerer */
   g_object_set (webrtc->priv->ice, "controller", FALSE, NULL);
 
@@ -1827,6 +2313,63 @@ out:
   return ret;
 }
 
+/* requests the rtpbin sink pad of the session of @stream and links the
+ * session output to the transport */
+static GstPad *
+_request_send_rtp_sink (GstWebRTCBin * webrtc, TransportStream * stream)
+{
+  GstPadTemplate *rtp_templ;
+  GstPad *rtp_sink;
+  gchar *pad_name;
+
+  rtp_templ =
+      _find_pad_template (webrtc->rtpbin, GST_PAD_SINK, GST_PAD_REQUEST,
+      "send_rtp_sink_%u");
+  g_assert (rtp_templ);
+
+  pad_name = g_strdup_printf ("send_rtp_sink_%u", stream->session_id);
+  rtp_sink =
+      gst_element_request_pad (webrtc->rtpbin, rtp_templ, pad_name, NULL);
+  g_free (pad_name);
+
+  pad_name = g_strdup_printf ("send_rtp_src_%u", stream->session_id);
+  if (!gst_element_link_pads (GST_ELEMENT (webrtc->rtpbin), pad_name,
+          GST_ELEMENT (stream->send_bin), "rtp_sink"))
+    g_warn_if_reached ();
+  g_free (pad_name);
+
+  return rtp_sink;
+}
+
+static gboolean
+_connect_rtpfunnel (GstWebRTCBin * webrtc, TransportStream * stream)
+{
+  GstPad *srcpad, *rtp_sink;
+
+  stream->rtpfunnel = gst_element_factory_make ("rtpfunnel", NULL);
+  if (!stream->rtpfunnel) {
+    /* FIXME: is this the right thing for a missing plugin? */
+    GST_ELEMENT_ERROR (webrtc, CORE, MISSING_PLUGIN, (NULL),
+        ("%s", "rtpfunnel element is not available"));
+    return FALSE;
+  }
+
+  gst_bin_add (GST_BIN (webrtc), stream->rtpfunnel);
+  gst_element_sync_state_with_parent (stream->rtpfunnel);
+
+  rtp_sink = _request_send_rtp_sink (webrtc, stream);
+  srcpad = gst_element_get_static_pad (stream->rtpfunnel, "src");
+  if (gst_pad_link (srcpad, rtp_sink) != GST_PAD_LINK_OK)
+    g_warn_if_reached ();
+  gst_object_unref (srcpad);
+  gst_object_unref (rtp_sink);
+
+  GST_DEBUG_OBJECT (webrtc, "muxing the bundled streams of session %u with %"
+      GST_PTR_FORMAT, stream->session_id, stream->rtpfunnel);
+
+  return TRUE;
+}
+
 static GstPad *
 _connect_input_stream (GstWebRTCBin * webrtc, GstWebRTCBinPad * pad)
 {
@@ -1841,43 +2384,44 @@ _connect_input_stream (GstWebRTCBin * webrtc, GstWebRTCBinPad * pad)
  * o----------o send_rtp_sink_%u   ;                           ;
  * ;          '--------------------'                           ;
  * '--------------------- -------------------------------------'
+ *
+ * When bundling, the sink pads of all the bundled media are muxed with an
+ * rtpfunnel in front of send_rtp_sink_%u.
  */
-  GstPadTemplate *rtp_templ;
   GstPad *rtp_sink;
-  gchar *pad_name;
   WebRTCTransceiver *trans;
 
   g_return_val_if_fail (pad->trans != NULL, NULL);
 
   GST_INFO_OBJECT (pad, "linking input stream %u", pad->mlineindex);
 
-  rtp_templ =
-      _find_pad_template (webrtc->rtpbin, GST_PAD_SINK, GST_PAD_REQUEST,
-      "send_rtp_sink_%u");
-  g_assert (rtp_templ);
-
-  pad_name = g_strdup_printf ("send_rtp_sink_%u", pad->mlineindex);
-  rtp_sink =
-      gst_element_request_pad (webrtc->rtpbin, rtp_templ, pad_name, NULL);
-  g_free (pad_name);
-  gst_ghost_pad_set_target (GST_GHOST_PAD (pad), rtp_sink);
-  gst_object_unref (rtp_sink);
-
   trans = WEBRTC_TRANSCEIVER (pad->trans);
   if (!trans->stream) {
     TransportStream *item;
-    /* FIXME: bundle */
     item = _find_transport_for_session (webrtc, pad->mlineindex);
     if (!item)
       item = _create_transport_channel (webrtc, pad->mlineindex);
     webrtc_transceiver_set_transport (trans, item);
   }
 
-  pad_name = g_strdup_printf ("send_rtp_src_%u", pad->mlineindex);
-  if (!gst_element_link_pads (GST_ELEMENT (webrtc->rtpbin), pad_name,
-          GST_ELEMENT (trans->stream->send_bin), "rtp_sink"))
-    g_warn_if_reached ();
-  g_free (pad_name);
+  if (webrtc->priv->bundle_policy == GST_WEBRTC_BUNDLE_POLICY_NONE) {
+    rtp_sink = _request_send_rtp_sink (webrtc, trans->stream);
+  } else {
+    /* the streams of all the bundled media go through the same rtpbin
+     * session */
+    if (!trans->stream->rtpfunnel
+        && !_connect_rtpfunnel (webrtc, trans->stream))
+      return NULL;
+
+    rtp_sink =
+        gst_element_get_request_pad (trans->stream->rtpfunnel, "sink_%u");
+    gst_pad_add_probe (rtp_sink,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+        (GstPadProbeCallback) _on_send_rtp_probe, gst_object_ref (trans),
+        (GDestroyNotify) gst_object_unref);
+  }
+  gst_ghost_pad_set_target (GST_GHOST_PAD (pad), rtp_sink);
+  gst_object_unref (rtp_sink);
 
   gst_element_sync_state_with_parent (GST_ELEMENT (trans->stream->send_bin));
 
@@ -1902,6 +2446,7 @@ _connect_output_stream (GstWebRTCBin * webrtc, GstWebRTCBinPad * pad)
  */
   gchar *pad_name;
   WebRTCTransceiver *trans;
+  GstPad *rtp_src;
 
   g_return_val_if_fail (pad->trans != NULL, NULL);
 
@@ -1910,18 +2455,26 @@ _connect_output_stream (GstWebRTCBin * webrtc, GstWebRTCBinPad * pad)
   trans = WEBRTC_TRANSCEIVER (pad->trans);
   if (!trans->stream) {
     TransportStream *item;
-    /* FIXME: bundle */
     item = _find_transport_for_session (webrtc, pad->mlineindex);
     if (!item)
       item = _create_transport_channel (webrtc, pad->mlineindex);
     webrtc_transceiver_set_transport (trans, item);
   }
 
-  pad_name = g_strdup_printf ("recv_rtp_sink_%u", pad->mlineindex);
-  if (!gst_element_link_pads (GST_ELEMENT (trans->stream->receive_bin),
-          "rtp_src", GST_ELEMENT (webrtc->rtpbin), pad_name))
-    g_warn_if_reached ();
-  g_free (pad_name);
+  /* bundled media share the receiving side of the transport, rtpbin demuxes
+   * the streams by SSRC (learnt from the MID's if negotiated) and payload
+   * type */
+  rtp_src =
+      gst_element_get_static_pad (GST_ELEMENT (trans->stream->receive_bin),
+      "rtp_src");
+  if (!gst_pad_is_linked (rtp_src)) {
+    pad_name = g_strdup_printf ("recv_rtp_sink_%u", trans->stream->session_id);
+    if (!gst_element_link_pads (GST_ELEMENT (trans->stream->receive_bin),
+            "rtp_src", GST_ELEMENT (webrtc->rtpbin), pad_name))
+      g_warn_if_reached ();
+    g_free (pad_name);
+  }
+  gst_object_unref (rtp_src);
 
   gst_element_sync_state_with_parent (GST_ELEMENT (trans->stream->receive_bin));
 
@@ -1947,6 +2500,13 @@ _add_ice_candidate (GstWebRTCBin * webrtc, IceCandidateItem * item)
   GstWebRTCICEStream *stream;
 
   stream = _find_ice_stream_for_session (webrtc, item->mlineindex);
+  if (stream == NULL) {
+    /* bundled media use the ICE stream of their transport */
+    GstWebRTCRTPTransceiver *trans =
+        _find_transceiver_for_mline (webrtc, item->mlineindex);
+    if (trans && WEBRTC_TRANSCEIVER (trans)->stream)
+      stream = WEBRTC_TRANSCEIVER (trans)->stream->stream;
+  }
   if (stream == NULL) {
     GST_WARNING_OBJECT (webrtc, "Unknown mline %u, ignoring", item->mlineindex);
     return;
@@ -1958,9 +2518,32 @@ _add_ice_candidate (GstWebRTCBin * webrtc, IceCandidateItem * item)
   gst_webrtc_ice_add_candidate (webrtc->priv->ice, stream, item->candidate);
 }
 
+/* whether any of the transceivers using @stream receives media */
+static gboolean
+_transport_stream_is_receiving (GstWebRTCBin * webrtc, TransportStream * stream)
+{
+  int i;
+
+  for (i = 0; i < webrtc->priv->transceivers->len; i++) {
+    GstWebRTCRTPTransceiver *rtp_trans =
+        g_array_index (webrtc->priv->transceivers, GstWebRTCRTPTransceiver *,
+        i);
+
+    if (WEBRTC_TRANSCEIVER (rtp_trans)->stream != stream)
+      continue;
+    if (rtp_trans->current_direction ==
+        GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_RECVONLY
+        || rtp_trans->current_direction ==
+        GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
 static void
 _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
-    const GstSDPMessage * sdp, guint media_idx,
+    const GstSDPMessage * sdp, guint media_idx, guint session_id,
     GstWebRTCRTPTransceiver * rtp_trans)
 {
   WebRTCTransceiver *trans = WEBRTC_TRANSCEIVER (rtp_trans);
@@ -1978,17 +2561,30 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
     const GstSDPAttribute *attr = gst_sdp_media_get_attribute (media, i);
 
     if (g_strcmp0 (attr->key, "mid") == 0) {
+      /* also read by the bundle send path */
+      GST_OBJECT_LOCK (rtp_trans);
       g_free (rtp_trans->mid);
       rtp_trans->mid = g_strdup (attr->value);
+      GST_OBJECT_UNLOCK (rtp_trans);
     }
   }
 
+  if (stream && stream->session_id != session_id) {
+    if (prev_dir != GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_NONE) {
+      GST_FIXME_OBJECT (webrtc, "implement moving a negotiated transceiver "
+          "to another transport");
+      return;
+    }
+    /* the answer bundled this media with another one */
+    stream = NULL;
+  }
+
   if (!stream) {
-    /* FIXME: find an existing transport for e.g. bundle/reconfiguration */
-    stream = _find_transport_for_session (webrtc, media_idx);
+    /* FIXME: find an existing transport for e.g. reconfiguration */
+    stream = _find_transport_for_session (webrtc, session_id);
     if (!stream)
-      stream = _create_transport_channel (webrtc, media_idx);
-    webrtc_transceiver_set_transport (trans, stream);
+      stream = _create_transport_channel (webrtc, session_id);
+    _move_transceiver_to_transport (webrtc, trans, stream);
   }
 
   {
@@ -1996,6 +2592,7 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
     GstWebRTCRTPTransceiverDirection local_dir, remote_dir;
     GstWebRTCDTLSSetup local_setup, remote_setup;
     guint i, len;
+    guint8 mid_ext_id;
     const gchar *proto;
     GstCaps *global_caps;
 
@@ -2028,9 +2625,8 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
       GST_DEBUG_OBJECT (webrtc, "mapping sdp media level attributes to caps");
       gst_sdp_media_attributes_to_caps (media, global_caps);
 
-      /* clear the ptmap */
-      g_array_set_size (stream->ptmap, 0);
-
+      /* bundled media add their payload types to the same ptmap, which has
+       * been cleared in _update_transceivers_from_sdp() */
       len = gst_sdp_media_formats_len (media);
       for (i = 0; i < len; i++) {
         GstCaps *caps, *outcaps;
@@ -2042,6 +2638,12 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
 
         GST_DEBUG_OBJECT (webrtc, " looking at %d pt: %d", i, pt);
 
+        if (_transport_stream_get_caps_for_pt (stream, pt)) {
+          GST_WARNING_OBJECT (webrtc, " skipping pt %d already used by "
+              "another bundled media", pt);
+          continue;
+        }
+
         /* convert caps */
         caps = gst_sdp_media_get_caps_from_media (media, pt);
         if (caps == NULL) {
@@ -2058,6 +2660,7 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
         gst_structure_set_name (s, "application/x-rtp");
 
         item.pt = pt;
+        item.media_idx = media_idx;
         item.caps = outcaps;
 
         g_array_append_val (stream->ptmap, item);
@@ -2066,6 +2669,48 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
       gst_caps_unref (global_caps);
     }
 
+    /* the SSRC's announced by the remote tell the bundled media apart */
+    GST_OBJECT_LOCK (stream);
+    for (i = 0; i < gst_sdp_media_attributes_len (remote_media); i++) {
+      const GstSDPAttribute *attr =
+          gst_sdp_media_get_attribute (remote_media, i);
+      SsrcMapItem item;
+      guint j;
+
+      if (g_strcmp0 (attr->key, "ssrc") != 0 || !attr->value)
+        continue;
+
+      item.ssrc = g_ascii_strtoull (attr->value, NULL, 10);
+      item.media_idx = media_idx;
+
+      for (j = 0; j < stream->remote_ssrcmap->len; j++) {
+        if (g_array_index (stream->remote_ssrcmap, SsrcMapItem, j).ssrc ==
+            item.ssrc)
+          break;
+      }
+      if (j == stream->remote_ssrcmap->len)
+        g_array_append_val (stream->remote_ssrcmap, item);
+    }
+
+    /* and so do the MID's when both sides send the header extension with
+     * the same id */
+    mid_ext_id = _media_get_mid_ext_id (local_media);
+    if (mid_ext_id != _media_get_mid_ext_id (remote_media))
+      mid_ext_id = 0;
+    if (mid_ext_id && rtp_trans->mid) {
+      MidMapItem item;
+
+      item.mid = g_strdup (rtp_trans->mid);
+      item.media_idx = media_idx;
+      g_array_append_val (stream->midmap, item);
+      stream->mid_ext_id = mid_ext_id;
+    }
+    GST_OBJECT_UNLOCK (stream);
+
+    GST_OBJECT_LOCK (trans);
+    trans->mid_ext_id = mid_ext_id;
+    GST_OBJECT_UNLOCK (trans);
+
     new_rtcp_mux = _media_has_attribute_key (local_media, "rtcp-mux")
         && _media_has_attribute_key (remote_media, "rtcp-mux");
     new_rtcp_rsize = _media_has_attribute_key (local_media, "rtcp-rsize")
@@ -2074,7 +2719,7 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
     {
       GObject *session;
       g_signal_emit_by_name (webrtc->rtpbin, "get-internal-session",
-          media_idx, &session);
+          stream->session_id, &session);
       if (session) {
         g_object_set (session, "rtcp-reduced-size", new_rtcp_rsize, NULL);
         g_object_unref (session);
@@ -2088,7 +2733,6 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
     return;
   }
 
-  /* FIXME: bundle! */
   g_object_set (stream, "rtcp-mux", new_rtcp_mux, NULL);
 
   if (new_dir != prev_dir) {
@@ -2096,9 +2740,6 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
 
     GST_TRACE_OBJECT (webrtc, "transceiver direction change");
 
-    /* FIXME: this may not always be true. e.g. bundle */
-    g_assert (media_idx == stream->session_id);
-
     if (new_dir == GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY ||
         new_dir == GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV) {
       GstWebRTCBinPad *pad =
@@ -2146,15 +2787,15 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
           new_setup == GST_WEBRTC_DTLS_SETUP_ACTIVE, NULL);
     }
 
+    rtp_trans->mline = media_idx;
+    rtp_trans->current_direction = new_dir;
+
+    /* the transport may be shared with other bundled media */
     receive = TRANSPORT_RECEIVE_BIN (stream->receive_bin);
-    if (new_dir == GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_RECVONLY ||
-        new_dir == GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV)
+    if (_transport_stream_is_receiving (webrtc, stream))
       transport_receive_bin_set_receive_state (receive, RECEIVE_STATE_PASS);
     else
       transport_receive_bin_set_receive_state (receive, RECEIVE_STATE_DROP);
-
-    rtp_trans->mline = media_idx;
-    rtp_trans->current_direction = new_dir;
   }
 }
 
@@ -2176,14 +2817,30 @@ _update_transceivers_from_sdp (GstWebRTCBin * webrtc, SDPSource source,
 {
   int i;
 
+  /* the payload types, SSRC's and MID's of all the (bundled) media of each
+   * transport are gathered again */
+  for (i = 0; i < webrtc->priv->transports->len; i++) {
+    TransportStream *stream =
+        g_array_index (webrtc->priv->transports, TransportStream *, i);
+
+    g_array_set_size (stream->ptmap, 0);
+    GST_OBJECT_LOCK (stream);
+    g_array_set_size (stream->remote_ssrcmap, 0);
+    g_array_set_size (stream->midmap, 0);
+    stream->mid_ext_id = 0;
+    GST_OBJECT_UNLOCK (stream);
+  }
+
   for (i = 0; i < gst_sdp_message_medias_len (sdp->sdp); i++) {
     const GstSDPMedia *media = gst_sdp_message_get_media (sdp->sdp, i);
     GstWebRTCRTPTransceiver *trans;
+    guint session_id;
 
     /* skip rejected media */
-    if (gst_sdp_media_get_port (media) == 0)
+    if (_media_is_rejected (sdp->sdp, i))
       continue;
 
+    session_id = _get_session_for_media (webrtc, source, sdp, i);
     trans = _find_transceiver_for_sdp_media (webrtc, sdp->sdp, i);
 
     if (source == SDP_LOCAL && sdp->type == GST_WEBRTC_SDP_TYPE_OFFER && !trans) {
@@ -2191,7 +2848,8 @@ _update_transceivers_from_sdp (GstWebRTCBin * webrtc, SDPSource source,
       return FALSE;
     } else {
       if (trans) {
-        _update_transceiver_from_sdp_media (webrtc, sdp->sdp, i, trans);
+        _update_transceiver_from_sdp_media (webrtc, sdp->sdp, i, session_id,
+            trans);
       } else {
         trans = _find_transceiver (webrtc, NULL,
             (FindTransceiverFunc) _find_compatible_unassociated_transceiver);
@@ -2203,7 +2861,8 @@ _update_transceivers_from_sdp (GstWebRTCBin * webrtc, SDPSource source,
          * that calls to setDirection will change the value.  Nothing about
          * a default value when the transceiver is created internally */
         trans->direction = _get_direction_from_media (media);
-        _update_transceiver_from_sdp_media (webrtc, sdp->sdp, i, trans);
+        _update_transceiver_from_sdp_media (webrtc, sdp->sdp, i, session_id,
+            trans);
       }
     }
   }
@@ -2456,7 +3115,11 @@ _set_description_task (GstWebRTCBin * webrtc, struct set_description *sd)
       gchar *ufrag, *pwd;
       TransportStream *item;
 
-      /* FIXME: bundle */
+      /* bundled media use the credentials of the first media of the
+       * bundle */
+      if (_get_session_for_media (webrtc, sd->source, sd->sdp, i) != i)
+        continue;
+
       item = _find_transport_for_session (webrtc, i);
       if (!item)
         item = _create_transport_channel (webrtc, i);
@@ -2476,7 +3139,11 @@ _set_description_task (GstWebRTCBin * webrtc, struct set_description *sd)
       gchar *ufrag, *pwd;
       TransportStream *item;
 
-      /* FIXME: bundle */
+      /* bundled media use the credentials of the first media of the
+       * bundle */
+      if (_get_session_for_media (webrtc, sd->source, sd->sdp, i) != i)
+        continue;
+
       item = _find_transport_for_session (webrtc, i);
       if (!item)
         item = _create_transport_channel (webrtc, i);
@@ -2489,6 +3156,10 @@ _set_description_task (GstWebRTCBin * webrtc, struct set_description *sd)
     }
   }
 
+  if (sd->sdp->type == GST_WEBRTC_SDP_TYPE_ANSWER
+      && webrtc->signaling_state == GST_WEBRTC_SIGNALING_STATE_STABLE)
+    _remove_unused_transports (webrtc);
+
   {
     int i;
     for (i = 0; i < webrtc->priv->ice_stream_map->len; i++) {
@@ -2648,7 +3319,8 @@ _on_ice_candidate (GstWebRTCICE * ice, guint session_id,
 {
   IceCandidateItem *item = g_new0 (IceCandidateItem, 1);
 
-  /* FIXME: bundle support */
+  /* bundled media share the ICE stream of the first media of the bundle,
+   * which is also the session id */
   item->mlineindex = session_id;
   item->candidate = g_strdup (candidate);
 
@@ -2784,6 +3456,7 @@ on_rtpbin_pad_added (GstElement * rtpbin, GstPad * new_pad,
   GST_TRACE_OBJECT (webrtc, "new rtpbin pad %s", new_pad_name);
   if (g_str_has_prefix (new_pad_name, "recv_rtp_src_")) {
     guint32 session_id = 0, ssrc = 0, pt = 0;
+    gint media_idx;
     GstWebRTCRTPTransceiver *rtp_trans;
     WebRTCTransceiver *trans;
     TransportStream *stream;
@@ -2799,8 +3472,15 @@ on_rtpbin_pad_added (GstElement * rtpbin, GstPad * new_pad,
     if (!stream)
       g_warn_if_reached ();
 
-    /* FIXME: bundle! */
-    rtp_trans = _find_transceiver_for_mline (webrtc, session_id);
+    /* the stream may belong to any of the media bundled in this session */
+    media_idx = _transport_stream_get_media_idx (stream, ssrc, pt);
+    if (media_idx < 0)
+      media_idx = session_id;
+
+    GST_DEBUG_OBJECT (webrtc, "ssrc %u with pt %u of session %u is for "
+        "media %i", ssrc, pt, session_id, media_idx);
+
+    rtp_trans = _find_transceiver_for_mline (webrtc, media_idx);
     if (!rtp_trans)
       g_warn_if_reached ();
     trans = WEBRTC_TRANSCEIVER (rtp_trans);
@@ -3058,6 +3738,11 @@ gst_webrtc_bin_set_property (GObject * object, guint prop_id,
     case PROP_TURN_SERVER:
       g_object_set_property (G_OBJECT (webrtc->priv->ice), pspec->name, value);
       break;
+    case PROP_BUNDLE_POLICY:
+      PC_LOCK (webrtc);
+      webrtc->priv->bundle_policy = g_value_get_enum (value);
+      PC_UNLOCK (webrtc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3116,6 +3801,9 @@ gst_webrtc_bin_get_property (GObject * object, guint prop_id,
     case PROP_TURN_SERVER:
       g_object_get_property (G_OBJECT (webrtc->priv->ice), pspec->name, value);
       break;
+    case PROP_BUNDLE_POLICY:
+      g_value_set_enum (value, webrtc->priv->bundle_policy);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3134,7 +3822,7 @@ gst_webrtc_bin_dispose (GObject * object)
 {
   GstWebRTCBin *webrtc = GST_WEBRTC_BIN (object);
 
-  _stop_thread (webrtc);
+  _stop_task_queue (webrtc);
 
   if (webrtc->priv->ice)
     gst_object_unref (webrtc->priv->ice);
@@ -3152,6 +3840,9 @@ gst_webrtc_bin_finalize (GObject * object)
 {
   GstWebRTCBin *webrtc = GST_WEBRTC_BIN (object);
 
+  webrtc_task_queue_unref (webrtc->priv->task_queue);
+  webrtc->priv->task_queue = NULL;
+
   if (webrtc->priv->transports)
     g_array_free (webrtc->priv->transports, TRUE);
   webrtc->priv->transports = NULL;
@@ -3244,6 +3935,24 @@ gst_webrtc_bin_class_init (GstWebRTCBinClass * klass)
           "The TURN server of the form turn(s)://username:password@host:port",
           NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstWebRTCBin:bundle-policy:
+   *
+   * How media are grouped on transports in the offers and answers created.
+   * With none, no BUNDLE group is offered and offered groups are ignored.
+   * With balanced, the first media of each type have their own transport.
+   * With max-compat, all the media have their own transport until the
+   * remote accepts the bundle.  With max-bundle, only the first media has
+   * a transport.
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_BUNDLE_POLICY,
+      g_param_spec_enum ("bundle-policy", "Bundle Policy",
+          "The policy to apply for bundling",
+          GST_TYPE_WEBRTC_BUNDLE_POLICY,
+          DEFAULT_BUNDLE_POLICY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_property (gobject_class,
       PROP_CONNECTION_STATE,
       g_param_spec_enum ("connection-state", "Connection State",
@@ -3502,7 +4211,9 @@ gst_webrtc_bin_init (GstWebRTCBin * webrtc)
       G_TYPE_INSTANCE_GET_PRIVATE ((webrtc), GST_TYPE_WEBRTC_BIN,
       GstWebRTCBinPrivate);
 
-  _start_thread (webrtc);
+  _start_task_queue (webrtc);
+
+  webrtc->priv->bundle_policy = DEFAULT_BUNDLE_POLICY;
 
   webrtc->rtpbin = _create_rtpbin (webrtc);
   gst_bin_add (GST_BIN (webrtc), webrtc->rtpbin);
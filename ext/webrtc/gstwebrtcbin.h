@@ -22,6 +22,7 @@
 
 #include <gst/sdp/sdp.h>
 #include "fwd.h"
+#include "executor.h"
 #include "gstwebrtcice.h"
 
 G_BEGIN_DECLS
@@ -100,7 +101,7 @@ struct _GstWebRTCBinPrivate
 {
   guint max_sink_pad_serial;
 
-  gboolean bundle;
+  GstWebRTCBundlePolicy bundle_policy;
   GArray *transceivers;
   GArray *session_mid_map;
   GArray *transports;
@@ -114,10 +115,8 @@ struct _GstWebRTCBinPrivate
   gboolean need_negotiation;
   gpointer sctp_transport;      /* FIXME */
 
-  /* peerconnection helper thread for promises */
-  GMainContext *main_context;
-  GMainLoop *loop;
-  GThread *thread;
+  /* peerconnection operations, run on the shared threads */
+  WebRTCTaskQueue *task_queue;
   GMutex pc_lock;
   GCond pc_cond;
 
@@ -22,6 +22,7 @@
 #endif
 
 #include "gstwebrtcice.h"
+#include "executor.h"
 /* libnice */
 #include <agent.h>
 #include "icestream.h"
@@ -73,68 +74,10 @@ struct _GstWebRTCICEPrivate
 
   GArray *nice_stream_map;
 
-  GThread *thread;
+  /* shared with other agents */
   GMainContext *main_context;
-  GMainLoop *loop;
-  GMutex lock;
-  GCond cond;
 };
 
-static gboolean
-_unlock_pc_thread (GMutex * lock)
-{
-  g_mutex_unlock (lock);
-  return G_SOURCE_REMOVE;
-}
-
-static gpointer
-_gst_nice_thread (GstWebRTCICE * ice)
-{
-  g_mutex_lock (&ice->priv->lock);
-  ice->priv->main_context = g_main_context_new ();
-  ice->priv->loop = g_main_loop_new (ice->priv->main_context, FALSE);
-
-  g_cond_broadcast (&ice->priv->cond);
-  g_main_context_invoke (ice->priv->main_context,
-      (GSourceFunc) _unlock_pc_thread, &ice->priv->lock);
-
-  g_main_loop_run (ice->priv->loop);
-
-  g_mutex_lock (&ice->priv->lock);
-  g_main_context_unref (ice->priv->main_context);
-  ice->priv->main_context = NULL;
-  g_main_loop_unref (ice->priv->loop);
-  ice->priv->loop = NULL;
-  g_cond_broadcast (&ice->priv->cond);
-  g_mutex_unlock (&ice->priv->lock);
-
-  return NULL;
-}
-
-static void
-_start_thread (GstWebRTCICE * ice)
-{
-  g_mutex_lock (&ice->priv->lock);
-  ice->priv->thread = g_thread_new ("gst-nice-ops",
-      (GThreadFunc) _gst_nice_thread, ice);
-
-  while (!ice->priv->loop)
-    g_cond_wait (&ice->priv->cond, &ice->priv->lock);
-  g_mutex_unlock (&ice->priv->lock);
-}
-
-static void
-_stop_thread (GstWebRTCICE * ice)
-{
-  g_mutex_lock (&ice->priv->lock);
-  g_main_loop_quit (ice->priv->loop);
-  while (ice->priv->loop)
-    g_cond_wait (&ice->priv->cond, &ice->priv->lock);
-  g_mutex_unlock (&ice->priv->lock);
-
-  g_thread_unref (ice->priv->thread);
-}
-
 #if 0
 static NiceComponentType
 _webrtc_component_to_nice (GstWebRTCICEComponent comp)
@@ -359,6 +302,26 @@ gst_webrtc_ice_add_stream (GstWebRTCICE * ice, guint session_id)
   return item->stream;
 }
 
+/* stops the ICE checks of @stream and releases it, e.g. once bundling left
+ * its transport unused */
+void
+gst_webrtc_ice_remove_stream (GstWebRTCICE * ice, GstWebRTCICEStream * stream)
+{
+  struct NiceStreamItem *item;
+  guint idx;
+
+  item = _find_item (ice, -1, -1, stream);
+  g_return_if_fail (item != NULL);
+
+  GST_DEBUG_OBJECT (ice, "removing stream %u for session %u",
+      item->nice_stream_id, item->session_id);
+
+  nice_agent_remove_stream (ice->priv->nice_agent, item->nice_stream_id);
+
+  idx = item - (struct NiceStreamItem *) ice->priv->nice_stream_map->data;
+  g_array_remove_index (ice->priv->nice_stream_map, idx);
+}
+
 static void
 _on_new_candidate (NiceAgent * agent, NiceCandidate * candidate,
     GstWebRTCICE * ice)
@@ -793,16 +756,15 @@ gst_webrtc_ice_finalize (GObject * object)
 
   g_signal_handlers_disconnect_by_data (ice->priv->nice_agent, ice);
 
-  _stop_thread (ice);
+  /* make sure _on_new_candidate() is not running anymore */
+  webrtc_executor_release_context (ice->priv->main_context);
+  ice->priv->main_context = NULL;
 
   if (ice->turn_server)
     gst_uri_unref (ice->turn_server);
   if (ice->stun_server)
     gst_uri_unref (ice->stun_server);
 
-  g_mutex_clear (&ice->priv->lock);
-  g_cond_clear (&ice->priv->cond);
-
   g_array_free (ice->priv->nice_stream_map, TRUE);
 
   g_object_unref (ice->priv->nice_agent);
@@ -864,10 +826,7 @@ gst_webrtc_ice_init (GstWebRTCICE * ice)
       G_TYPE_INSTANCE_GET_PRIVATE ((ice), GST_TYPE_WEBRTC_ICE,
       GstWebRTCICEPrivate);
 
-  g_mutex_init (&ice->priv->lock);
-  g_cond_init (&ice->priv->cond);
-
-  _start_thread (ice);
+  ice->priv->main_context = webrtc_executor_acquire_context ();
 
   ice->priv->nice_agent = nice_agent_new (ice->priv->main_context,
       NICE_COMPATIBILITY_RFC5245);
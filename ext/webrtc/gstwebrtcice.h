@@ -59,6 +59,8 @@ struct _GstWebRTCICEClass
 GstWebRTCICE *              gst_webrtc_ice_new                      (void);
 GstWebRTCICEStream *        gst_webrtc_ice_add_stream               (GstWebRTCICE * ice,
                                                                      guint session_id);
+void                        gst_webrtc_ice_remove_stream            (GstWebRTCICE * ice,
+                                                                     GstWebRTCICEStream * stream);
 GstWebRTCICETransport *     gst_webrtc_ice_find_transport           (GstWebRTCICE * ice,
                                                                      GstWebRTCICEStream * stream,
                                                                      GstWebRTCICEComponent component);
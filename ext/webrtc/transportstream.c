@@ -128,6 +128,8 @@ transport_stream_finalize (GObject * object)
   TransportStream *stream = TRANSPORT_STREAM (object);
 
   g_array_free (stream->ptmap, TRUE);
+  g_array_free (stream->remote_ssrcmap, TRUE);
+  g_array_free (stream->midmap, TRUE);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -233,11 +235,20 @@ clear_ptmap_item (PtMapItem * item)
     gst_caps_unref (item->caps);
 }
 
+static void
+clear_midmap_item (MidMapItem * item)
+{
+  g_free (item->mid);
+}
+
 static void
 transport_stream_init (TransportStream * stream)
 {
   stream->ptmap = g_array_new (FALSE, TRUE, sizeof (PtMapItem));
   g_array_set_clear_func (stream->ptmap, (GDestroyNotify) clear_ptmap_item);
+  stream->remote_ssrcmap = g_array_new (FALSE, TRUE, sizeof (SsrcMapItem));
+  stream->midmap = g_array_new (FALSE, TRUE, sizeof (MidMapItem));
+  g_array_set_clear_func (stream->midmap, (GDestroyNotify) clear_midmap_item);
 }
 
 TransportStream *
@@ -34,9 +34,22 @@ GType transport_stream_get_type(void);
 typedef struct
 {
   guint8 pt;
+  guint media_idx;
   GstCaps *caps;
 } PtMapItem;
 
+typedef struct
+{
+  guint32 ssrc;
+  guint media_idx;
+} SsrcMapItem;
+
+typedef struct
+{
+  gchar *mid;
+  guint media_idx;
+} MidMapItem;
+
 struct _TransportStream
 {
   GstObject                 parent;
@@ -54,6 +67,11 @@ struct _TransportStream
   GstWebRTCDTLSTransport   *rtcp_transport;
 
   GArray                   *ptmap;                  /* array of PtMapItem's */
+  GArray                   *remote_ssrcmap;         /* array of SsrcMapItem's */
+  GArray                   *midmap;                 /* array of MidMapItem's */
+  guint8                    mid_ext_id;             /* id of the sdes:mid RTP header extension, 0 if not negotiated */
+
+  GstElement               *rtpfunnel;              /* muxes the bundled send streams, owned by webrtcbin */
 };
 
 struct _TransportStreamClass
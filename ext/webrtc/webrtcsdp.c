@@ -200,6 +200,64 @@ _media_has_attribute_key (const GstSDPMedia * media, const gchar * key)
   return FALSE;
 }
 
+gboolean
+_media_is_bundle_only (const GstSDPMedia * media)
+{
+  return gst_sdp_media_get_port (media) == 0
+      && _media_has_attribute_key (media, "bundle-only");
+}
+
+/* Returns the mids listed in the first BUNDLE group of @msg, the first one
+ * being the tag of the group, or %NULL */
+gchar **
+_parse_bundle (const GstSDPMessage * msg)
+{
+  gchar **ret = NULL;
+  int i;
+
+  for (i = 0; i < gst_sdp_message_attributes_len (msg); i++) {
+    const GstSDPAttribute *attr = gst_sdp_message_get_attribute (msg, i);
+
+    if (g_strcmp0 (attr->key, "group") == 0 && attr->value
+        && g_str_has_prefix (attr->value, "BUNDLE ")) {
+      gchar **mids = g_strsplit (&attr->value[7], " ", -1);
+      guint j, n = 0;
+
+      /* remove the empty strings from repeated separators */
+      for (j = 0; mids[j]; j++) {
+        if (mids[j][0] != '\0')
+          mids[n++] = mids[j];
+        else
+          g_free (mids[j]);
+      }
+      mids[n] = NULL;
+
+      if (n > 0) {
+        ret = mids;
+        break;
+      }
+      g_strfreev (mids);
+    }
+  }
+
+  return ret;
+}
+
+gint
+_get_media_index_for_mid (const GstSDPMessage * msg, const gchar * mid)
+{
+  int i;
+
+  for (i = 0; i < gst_sdp_message_medias_len (msg); i++) {
+    const GstSDPMedia *media = gst_sdp_message_get_media (msg, i);
+
+    if (g_strcmp0 (gst_sdp_media_get_attribute_val (media, "mid"), mid) == 0)
+      return i;
+  }
+
+  return -1;
+}
+
 static gboolean
 _media_has_mid (const GstSDPMedia * media, guint media_idx, GError ** error)
 {
@@ -281,11 +339,8 @@ gboolean
 validate_sdp (GstWebRTCBin * webrtc, SDPSource source,
     GstWebRTCSessionDescription * sdp, GError ** error)
 {
-#if 0
-  const gchar *group, *bundle_ice_ufrag = NULL, *bundle_ice_pwd = NULL;
-  gchar **group_members = NULL;
-  gboolean is_bundle = FALSE;
-#endif
+  const gchar *bundle_ice_ufrag = NULL, *bundle_ice_pwd = NULL;
+  gchar **group_members;
   int i;
 
   if (!_check_valid_state_for_sdp_change (webrtc, source, sdp->type, error))
@@ -294,52 +349,46 @@ validate_sdp (GstWebRTCBin * webrtc, SDPSource source,
     return FALSE;
 /* not explicitly required
   if (ICE && !_check_trickle_ice (sdp->sdp))
-    return FALSE;
-  group = gst_sdp_message_get_attribute_val (sdp->sdp, "group");
-  is_bundle = g_str_has_prefix (group, "BUNDLE");
-  if (is_bundle)
-    group_members = g_strsplit (&group[6], " ", -1);*/
+    return FALSE;*/
+  group_members = _parse_bundle (sdp->sdp);
 
   for (i = 0; i < gst_sdp_message_medias_len (sdp->sdp); i++) {
     const GstSDPMedia *media = gst_sdp_message_get_media (sdp->sdp, i);
-#if 0
-    const gchar *mid;
-    gboolean media_in_bundle = FALSE, first_media_in_bundle = FALSE;
-    gboolean bundle_only = FALSE;
-#endif
+    const gchar *mid, *ice_ufrag, *ice_pwd;
+    gboolean media_in_bundle, bundle_only;
+
     if (!_media_has_mid (media, i, error))
       goto fail;
-#if 0
+
     mid = gst_sdp_media_get_attribute_val (media, "mid");
-    media_in_bundle = is_bundle && g_strv_contains (group_members, mid);
-    if (media_in_bundle)
-      bundle_only =
-          gst_sdp_media_get_attribute_val (media, "bundle-only") != NULL;
-    first_media_in_bundle = media_in_bundle
-        && g_strcmp0 (mid, group_members[0]) == 0;
-#endif
-    if (!_media_get_ice_ufrag (sdp->sdp, i)) {
+    media_in_bundle = group_members
+        && g_strv_contains ((const gchar **) group_members, mid);
+    bundle_only = media_in_bundle && _media_is_bundle_only (media);
+
+    ice_ufrag = _media_get_ice_ufrag (sdp->sdp, i);
+    ice_pwd = _media_get_ice_pwd (sdp->sdp, i);
+
+    /* bundle-only media use the transport of the bundle and are allowed to
+     * skip the transport attributes */
+    if (!ice_ufrag && !bundle_only) {
       g_set_error (error, GST_WEBRTC_BIN_ERROR, GST_WEBRTC_BIN_ERROR_BAD_SDP,
           "media %u is missing or contains an empty \'ice-ufrag\' attribute",
           i);
       goto fail;
     }
-    if (!_media_get_ice_pwd (sdp->sdp, i)) {
+    if (!ice_pwd && !bundle_only) {
       g_set_error (error, GST_WEBRTC_BIN_ERROR, GST_WEBRTC_BIN_ERROR_BAD_SDP,
           "media %u is missing or contains an empty \'ice-pwd\' attribute", i);
       goto fail;
     }
-    if (!_media_has_setup (media, i, error))
+    if (!bundle_only && !_media_has_setup (media, i, error))
       goto fail;
-#if 0
+
     /* check paramaters in bundle are the same */
-    if (media_in_bundle) {
-      const gchar *ice_ufrag =
-          gst_sdp_media_get_attribute_val (media, "ice-ufrag");
-      const gchar *ice_pwd = gst_sdp_media_get_attribute_val (media, "ice-pwd");
-      if (!bundle_ice_ufrag)
+    if (media_in_bundle && ice_ufrag && ice_pwd) {
+      if (!bundle_ice_ufrag) {
         bundle_ice_ufrag = ice_ufrag;
-      else if (!g_strcmp0 (bundle_ice_ufrag, ice_ufrag) != 0) {
+      } else if (g_strcmp0 (bundle_ice_ufrag, ice_ufrag) != 0) {
         g_set_error (error, GST_WEBRTC_BIN_ERROR, GST_WEBRTC_BIN_ERROR_BAD_SDP,
             "media %u has different ice-ufrag values in bundle. "
             "%s != %s", i, bundle_ice_ufrag, ice_ufrag);
@@ -347,22 +396,21 @@ validate_sdp (GstWebRTCBin * webrtc, SDPSource source,
       }
       if (!bundle_ice_pwd) {
         bundle_ice_pwd = ice_pwd;
-      } else if (g_strcmp0 (bundle_ice_pwd, ice_pwd) == 0) {
+      } else if (g_strcmp0 (bundle_ice_pwd, ice_pwd) != 0) {
         g_set_error (error, GST_WEBRTC_BIN_ERROR, GST_WEBRTC_BIN_ERROR_BAD_SDP,
-            "media %u has different ice-ufrag values in bundle. "
-            "%s != %s", i, bundle_ice_ufrag, ice_ufrag);
+            "media %u has different ice-pwd values in bundle. "
+            "%s != %s", i, bundle_ice_pwd, ice_pwd);
         goto fail;
       }
     }
-#endif
   }
 
-//  g_strv_free (group_members);
+  g_strfreev (group_members);
 
   return TRUE;
 
 fail:
-//  g_strv_free (group_members);
+  g_strfreev (group_members);
   return FALSE;
 }
 
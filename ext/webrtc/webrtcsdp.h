@@ -75,6 +75,13 @@ void                                _generate_ice_credentials               (gch
 G_GNUC_INTERNAL
 gboolean                            _media_has_attribute_key                (const GstSDPMedia * media,
                                                                              const gchar * key);
+G_GNUC_INTERNAL
+gboolean                            _media_is_bundle_only                   (const GstSDPMedia * media);
+G_GNUC_INTERNAL
+gchar **                            _parse_bundle                           (const GstSDPMessage * msg);
+G_GNUC_INTERNAL
+gint                                _get_media_index_for_mid                (const GstSDPMessage * msg,
+                                                                             const gchar * mid);
 
 
 #endif /* __WEBRTC_UTILS_H__ */
@@ -38,6 +38,7 @@ struct _WebRTCTransceiver
   GstWebRTCRTPTransceiver   parent;
 
   TransportStream          *stream;
+  guint8                    mid_ext_id;     /* id of the sdes:mid RTP header extension to send, 0 if none */
 };
 
 struct _WebRTCTransceiverClass
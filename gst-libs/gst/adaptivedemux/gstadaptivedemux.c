@@ -122,6 +122,7 @@ that the demux object and its streams are not changed by anybody else.
 #include "gstadaptivedemux.h"
 #include "gst/gst-i18n-plugin.h"
 #include <gst/base/gstadapter.h>
+#include <glib/gstdio.h>
 
 GST_DEBUG_CATEGORY (adaptivedemux_debug);
 #define GST_CAT_DEFAULT adaptivedemux_debug
@@ -134,6 +135,21 @@ GST_DEBUG_CATEGORY (adaptivedemux_debug);
 #define DEFAULT_FAILED_COUNT 3
 #define DEFAULT_CONNECTION_SPEED 0
 #define DEFAULT_BITRATE_LIMIT 0.8f
+#define DEFAULT_LOW_LATENCY FALSE
+#define DEFAULT_TARGET_LATENCY (3 * GST_SECOND)
+#define DEFAULT_MAX_CATCH_UP_RATE 1.05
+#define DEFAULT_INDEX_CACHE_DIRECTORY NULL
+#define DEFAULT_INDEX_CACHE_MAX_SIZE (16 * 1024 * 1024)
+#define INDEX_CACHE_SUFFIX ".index"
+/* validators, expiry and last use of each entry, in a key file */
+#define INDEX_CACHE_META_SUFFIX ".meta"
+#define INDEX_CACHE_META_GROUP "entry"
+/* how long an entry is used without revalidation when the response did not
+ * tell */
+#define INDEX_CACHE_DEFAULT_MAX_AGE (3600 * G_USEC_PER_SEC)
+#define HTTP_STATUS_NOT_MODIFIED 304
+/* how far behind the target latency playback can fall before catching up */
+#define CATCH_UP_THRESHOLD (500 * GST_MSECOND)
 #define SRC_QUEUE_MAX_BYTES 20 * 1024 * 1024    /* For safety. Large enough to hold a segment. */
 #define NUM_LOOKBACK_FRAGMENTS 3
 
@@ -162,6 +178,11 @@ enum
   PROP_0,
   PROP_CONNECTION_SPEED,
   PROP_BITRATE_LIMIT,
+  PROP_LOW_LATENCY,
+  PROP_TARGET_LATENCY,
+  PROP_MAX_CATCH_UP_RATE,
+  PROP_INDEX_CACHE_DIRECTORY,
+  PROP_INDEX_CACHE_MAX_SIZE,
   PROP_LAST
 };
 
@@ -173,6 +194,28 @@ struct _GstAdaptiveDemuxPrivate
   GstAdapter *input_adapter;    /* protected by manifest_lock */
   gboolean have_manifest;       /* protected by manifest_lock */
 
+  /* low latency live playback, protected by manifest_lock */
+  gboolean low_latency;
+  GstClockTime target_latency;
+  gdouble max_catch_up_rate;
+
+  /* Catch-up state, protected by manifest_lock. The streams switch to
+   * catch_up_rate at their first fragment starting at or after the
+   * presentation position catch_up_position, which maps to the running time
+   * catch_up_running_time. catch_up_generation counts the switches,
+   * catch_up_saved is the running time skipped by the previous catch-ups */
+  gdouble catch_up_rate;
+  GstClockTime catch_up_running_time;
+  GstClockTime catch_up_position;
+  guint catch_up_generation;
+  GstClockTime catch_up_saved;
+
+  GstClockTime pipeline_latency;        /* protected by object lock */
+
+  /* on-disk cache of the headers and indexes, protected by manifest_lock */
+  gchar *index_cache_directory;
+  guint64 index_cache_max_size;
+
   GList *old_streams;           /* protected by manifest_lock */
 
   GstTask *updates_task;        /* MT safe */
@@ -251,6 +294,7 @@ static gboolean gst_adaptive_demux_prepare_streams (GstAdaptiveDemux * demux,
     gboolean first_and_live);
 static gboolean gst_adaptive_demux_expose_streams (GstAdaptiveDemux * demux);
 static gboolean gst_adaptive_demux_is_live (GstAdaptiveDemux * demux);
+static void gst_adaptive_demux_reset_catch_up (GstAdaptiveDemux * demux);
 static GstFlowReturn gst_adaptive_demux_stream_seek (GstAdaptiveDemux * demux,
     GstAdaptiveDemuxStream * stream, gboolean forward, GstSeekFlags flags,
     GstClockTime ts, GstClockTime * final_ts);
@@ -354,6 +398,22 @@ gst_adaptive_demux_set_property (GObject * object, guint prop_id,
     case PROP_BITRATE_LIMIT:
       demux->bitrate_limit = g_value_get_float (value);
       break;
+    case PROP_LOW_LATENCY:
+      demux->priv->low_latency = g_value_get_boolean (value);
+      break;
+    case PROP_TARGET_LATENCY:
+      demux->priv->target_latency = g_value_get_uint64 (value);
+      break;
+    case PROP_MAX_CATCH_UP_RATE:
+      demux->priv->max_catch_up_rate = g_value_get_double (value);
+      break;
+    case PROP_INDEX_CACHE_DIRECTORY:
+      g_free (demux->priv->index_cache_directory);
+      demux->priv->index_cache_directory = g_value_dup_string (value);
+      break;
+    case PROP_INDEX_CACHE_MAX_SIZE:
+      demux->priv->index_cache_max_size = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -378,6 +438,21 @@ gst_adaptive_demux_get_property (GObject * object, guint prop_id,
     case PROP_BITRATE_LIMIT:
       g_value_set_float (value, demux->bitrate_limit);
       break;
+    case PROP_LOW_LATENCY:
+      g_value_set_boolean (value, demux->priv->low_latency);
+      break;
+    case PROP_TARGET_LATENCY:
+      g_value_set_uint64 (value, demux->priv->target_latency);
+      break;
+    case PROP_MAX_CATCH_UP_RATE:
+      g_value_set_double (value, demux->priv->max_catch_up_rate);
+      break;
+    case PROP_INDEX_CACHE_DIRECTORY:
+      g_value_set_string (value, demux->priv->index_cache_directory);
+      break;
+    case PROP_INDEX_CACHE_MAX_SIZE:
+      g_value_set_uint64 (value, demux->priv->index_cache_max_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -421,6 +496,89 @@ gst_adaptive_demux_class_init (GstAdaptiveDemuxClass * klass)
           0, 1, DEFAULT_BITRATE_LIMIT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAdaptiveDemux:low-latency:
+   *
+   * Play live streams as close to the live edge as the stream allows:
+   * fragments are requested as soon as their first chunks are announced to
+   * be available and pushed downstream while they are being downloaded, and
+   * the playback rate is raised up to #GstAdaptiveDemux:max-catch-up-rate
+   * while the distance to the live edge exceeds
+   * #GstAdaptiveDemux:target-latency.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_LOW_LATENCY,
+      g_param_spec_boolean ("low-latency", "Low latency",
+          "Fetch live fragments as early as they are available and catch up "
+          "with the live edge when falling behind the target latency",
+          DEFAULT_LOW_LATENCY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAdaptiveDemux:target-latency:
+   *
+   * The distance to the end of the live seek range that low latency playback
+   * tries to keep, in nanoseconds.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_TARGET_LATENCY,
+      g_param_spec_uint64 ("target-latency", "Target latency",
+          "Distance to the live edge to keep in low latency mode (in ns)",
+          0, G_MAXUINT64, DEFAULT_TARGET_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAdaptiveDemux:max-catch-up-rate:
+   *
+   * The playback rate used in low latency mode to catch up with the live
+   * edge, 1.0 disables catching up.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_CATCH_UP_RATE,
+      g_param_spec_double ("max-catch-up-rate", "Max catch-up rate",
+          "Playback rate used to catch up with the live edge in low latency "
+          "mode (1.0 = disabled)", 1.0, 2.0, DEFAULT_MAX_CATCH_UP_RATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAdaptiveDemux:index-cache-directory:
+   *
+   * Directory where the headers and segment indexes of on-demand streams
+   * (e.g. the initialization segments and sidx boxes of DASH on-demand
+   * representations) are kept once downloaded. Reopening the same manifest
+   * then reads them from the disk instead of requesting them again before
+   * the first fragment or after a seek. %NULL disables the cache.
+   *
+   * The entries are used as long as the Cache-Control max-age of their
+   * response allows, or one hour if it was not given. After that they are
+   * revalidated with a conditional request using their ETag or
+   * Last-Modified, or downloaded again.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX_CACHE_DIRECTORY,
+      g_param_spec_string ("index-cache-directory", "Index cache directory",
+          "Directory where the headers and indexes of on-demand streams are "
+          "cached (NULL = disabled)", DEFAULT_INDEX_CACHE_DIRECTORY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAdaptiveDemux:index-cache-max-size:
+   *
+   * Maximum size of the files in #GstAdaptiveDemux:index-cache-directory,
+   * in bytes. The least recently used entries are removed when storing a
+   * new one would exceed it.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX_CACHE_MAX_SIZE,
+      g_param_spec_uint64 ("index-cache-max-size", "Index cache max size",
+          "Maximum size of the index cache (in bytes)", 0, G_MAXUINT64,
+          DEFAULT_INDEX_CACHE_MAX_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = gst_adaptive_demux_change_state;
 
   gstbin_class->handle_message = gst_adaptive_demux_handle_message;
@@ -513,6 +671,12 @@ gst_adaptive_demux_init (GstAdaptiveDemux * demux,
   /* Properties */
   demux->bitrate_limit = DEFAULT_BITRATE_LIMIT;
   demux->connection_speed = DEFAULT_CONNECTION_SPEED;
+  demux->priv->low_latency = DEFAULT_LOW_LATENCY;
+  demux->priv->target_latency = DEFAULT_TARGET_LATENCY;
+  demux->priv->max_catch_up_rate = DEFAULT_MAX_CATCH_UP_RATE;
+  demux->priv->index_cache_directory = DEFAULT_INDEX_CACHE_DIRECTORY;
+  demux->priv->index_cache_max_size = DEFAULT_INDEX_CACHE_MAX_SIZE;
+  gst_adaptive_demux_reset_catch_up (demux);
 
   gst_element_add_pad (GST_ELEMENT (demux), demux->sinkpad);
 }
@@ -527,6 +691,7 @@ gst_adaptive_demux_finalize (GObject * object)
 
   g_object_unref (priv->input_adapter);
   g_object_unref (demux->downloader);
+  g_free (priv->index_cache_directory);
 
   g_mutex_clear (&priv->updates_timed_lock);
   g_cond_clear (&priv->updates_timed_cond);
@@ -823,6 +988,7 @@ gst_adaptive_demux_reset (GstAdaptiveDemux * demux)
   demux->priv->have_manifest = FALSE;
 
   gst_segment_init (&demux->segment, GST_FORMAT_TIME);
+  gst_adaptive_demux_reset_catch_up (demux);
 
   demux->have_group_id = FALSE;
   demux->group_id = G_MAXUINT;
@@ -1075,6 +1241,11 @@ gst_adaptive_demux_prepare_streams (GstAdaptiveDemux * demux,
 
   period_start = gst_adaptive_demux_get_period_start_time (demux);
 
+  /* A catch-up still in progress is abandoned, the new streams start at the
+   * normal rate */
+  demux->priv->catch_up_rate = 1.0;
+  demux->priv->catch_up_generation = 0;
+
   /* For live streams, the subclass is supposed to seek to the current
    * fragment and then tell us its timestamp in stream->fragment.timestamp.
    * We now also have to seek our demuxer segment to reflect this.
@@ -1093,6 +1264,7 @@ gst_adaptive_demux_prepare_streams (GstAdaptiveDemux * demux,
 
     offset = gst_adaptive_demux_stream_get_presentation_offset (demux, stream);
     stream->segment = demux->segment;
+    stream->catch_up_generation = 0;
 
     /* The demuxer segment is just built from seek events, but for each stream
      * we have to adjust segments according to the current period and the
@@ -1189,6 +1361,12 @@ gst_adaptive_demux_prepare_streams (GstAdaptiveDemux * demux,
           period_start);
     }
 
+    /* The streams played faster than the demuxer segment while catching up
+     * with the live edge, keep their running time in sync with the previous
+     * ones */
+    stream->segment.base -=
+        MIN (stream->segment.base, demux->priv->catch_up_saved);
+
     stream->pending_segment = gst_event_new_segment (&stream->segment);
     gst_event_set_seqnum (stream->pending_segment, demux->priv->segment_seqnum);
     stream->qos_earliest_time = GST_CLOCK_TIME_NONE;
@@ -1515,6 +1693,7 @@ gst_adaptive_demux_update_streams_segment (GstAdaptiveDemux * demux,
     /* Make sure the first buffer after a seek has the discont flag */
     stream->discont = TRUE;
     stream->qos_earliest_time = GST_CLOCK_TIME_NONE;
+    stream->catch_up_generation = 0;
   }
 }
 
@@ -1747,6 +1926,7 @@ gst_adaptive_demux_handle_seek_event (GstAdaptiveDemux * demux, GstPad * pad,
 
   gst_segment_do_seek (&demux->segment, rate, format, flags, start_type,
       start, stop_type, stop, &update);
+  gst_adaptive_demux_reset_catch_up (demux);
 
   /* FIXME - this seems unatural, do_seek() is updating base when we
    * only want the start/stop position to change, maybe do_seek() needs
@@ -1851,9 +2031,16 @@ gst_adaptive_demux_src_event (GstPad * pad, GstObject * parent,
     }
       break;
     case GST_EVENT_LATENCY:{
+      GstClockTime latency;
+
       /* Upstream and our internal source are irrelevant
        * for latency, and we should not fail here to
-       * configure the latency */
+       * configure the latency. Only remember it for
+       * the low latency mode */
+      gst_event_parse_latency (event, &latency);
+      GST_OBJECT_LOCK (demux);
+      demux->priv->pipeline_latency = latency;
+      GST_OBJECT_UNLOCK (demux);
       gst_event_unref (event);
       return TRUE;
     }
@@ -2309,12 +2496,176 @@ gst_adaptive_demux_handle_preroll (GstAdaptiveDemux * demux,
   }
 }
 
+/* must be called with manifest_lock taken */
+static void
+gst_adaptive_demux_reset_catch_up (GstAdaptiveDemux * demux)
+{
+  demux->priv->catch_up_rate = 1.0;
+  demux->priv->catch_up_running_time = 0;
+  demux->priv->catch_up_position = 0;
+  demux->priv->catch_up_generation = 0;
+  demux->priv->catch_up_saved = 0;
+}
+
+/* Returns the running time currently being played, or GST_CLOCK_TIME_NONE
+ * if not playing */
+static GstClockTime
+gst_adaptive_demux_get_playing_running_time (GstAdaptiveDemux * demux)
+{
+  GstClock *clock;
+  GstClockTime base_time, now, latency;
+
+  GST_OBJECT_LOCK (demux);
+  if (GST_STATE (demux) != GST_STATE_PLAYING
+      || GST_ELEMENT_CLOCK (demux) == NULL) {
+    GST_OBJECT_UNLOCK (demux);
+    return GST_CLOCK_TIME_NONE;
+  }
+  clock = gst_object_ref (GST_ELEMENT_CLOCK (demux));
+  base_time = GST_ELEMENT_CAST (demux)->base_time;
+  latency = demux->priv->pipeline_latency;
+  GST_OBJECT_UNLOCK (demux);
+
+  now = gst_clock_get_time (clock);
+  gst_object_unref (clock);
+
+  /* the sinks render a running time once the pipeline latency elapsed */
+  if (now < base_time + latency)
+    return GST_CLOCK_TIME_NONE;
+  return now - base_time - latency;
+}
+
+/* Decides whether playback needs to catch up with the live edge, based on
+ * the position being played in @stream. The switch is scheduled at the
+ * running time of @pts, the start of @stream's next fragment.
+ *
+ * must be called with manifest_lock and segment_lock taken */
+static void
+gst_adaptive_demux_update_catch_up (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream, GstClockTime pts)
+{
+  GstAdaptiveDemuxPrivate *priv = demux->priv;
+  GstClockTime offset, period_start, running_time, position, switch_time;
+  GstClockTime latency;
+  gint64 range_start, range_stop;
+  gdouble rate;
+  GList *iter;
+
+  /* wait for the streams still downloading to apply the previous switch.
+   * Those at their end or waiting for the next fragment to be available
+   * apply the latest one when they resume */
+  for (iter = demux->streams; iter; iter = g_list_next (iter)) {
+    GstAdaptiveDemuxStream *other = iter->data;
+
+    if (other->eos || other->last_ret == GST_FLOW_EOS
+        || !gst_adaptive_demux_stream_has_next_fragment (demux, other))
+      continue;
+
+    if (other->pending_segment == NULL
+        && other->catch_up_generation != priv->catch_up_generation)
+      return;
+  }
+
+  running_time = gst_adaptive_demux_get_playing_running_time (demux);
+  if (!GST_CLOCK_TIME_IS_VALID (running_time))
+    return;
+
+  offset = gst_adaptive_demux_stream_get_presentation_offset (demux, stream);
+  period_start = gst_adaptive_demux_get_period_start_time (demux);
+  position = gst_segment_position_from_running_time (&stream->segment,
+      GST_FORMAT_TIME, running_time);
+  if (!GST_CLOCK_TIME_IS_VALID (position) || position < offset)
+    return;
+  position = position - offset + period_start;
+
+  if (!gst_adaptive_demux_get_live_seek_range (demux, &range_start,
+          &range_stop))
+    return;
+  latency = range_stop > (gint64) position ? range_stop - position : 0;
+
+  if (priv->catch_up_rate == 1.0
+      && latency > priv->target_latency + CATCH_UP_THRESHOLD)
+    rate = priv->max_catch_up_rate;
+  else if (priv->catch_up_rate != 1.0 && latency <= priv->target_latency)
+    rate = 1.0;
+  else
+    return;
+
+  switch_time =
+      gst_segment_to_running_time (&stream->segment, GST_FORMAT_TIME, pts);
+  if (!GST_CLOCK_TIME_IS_VALID (switch_time) || pts < offset
+      || rate == priv->catch_up_rate)
+    return;
+
+  GST_DEBUG_OBJECT (demux, "Latency %" GST_TIME_FORMAT ", switching to rate "
+      "%lf at running time %" GST_TIME_FORMAT, GST_TIME_ARGS (latency), rate,
+      GST_TIME_ARGS (switch_time));
+
+  if (rate == 1.0) {
+    GstClockTime demux_running_time =
+        gst_segment_to_running_time (&demux->segment, GST_FORMAT_TIME,
+        pts - offset + period_start);
+
+    /* remember how far ahead of the demuxer segment the streams are now, for
+     * the segments of the next periods */
+    if (GST_CLOCK_TIME_IS_VALID (demux_running_time)
+        && demux_running_time > switch_time)
+      priv->catch_up_saved = demux_running_time - switch_time;
+  }
+
+  priv->catch_up_rate = rate;
+  priv->catch_up_running_time = switch_time;
+  priv->catch_up_position = pts - offset + period_start;
+  priv->catch_up_generation++;
+}
+
+/* Switches @stream to the catch-up rate if its fragment starting at @pts is
+ * past the switch point. The segment maps the switch position to the switch
+ * running time, so the streams which missed some switches while idle
+ * join the others at the same running time.
+ *
+ * must be called with manifest_lock and segment_lock taken */
+static void
+gst_adaptive_demux_stream_apply_catch_up (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream, GstClockTime pts)
+{
+  GstAdaptiveDemuxPrivate *priv = demux->priv;
+  GstClockTime offset, period_start, position, time;
+
+  if (stream->catch_up_generation == priv->catch_up_generation)
+    return;
+
+  offset = gst_adaptive_demux_stream_get_presentation_offset (demux, stream);
+  period_start = gst_adaptive_demux_get_period_start_time (demux);
+  time = gst_segment_to_stream_time (&stream->segment, GST_FORMAT_TIME, pts);
+  if (!GST_CLOCK_TIME_IS_VALID (time) || pts < offset)
+    return;
+  position = pts - offset + period_start;
+  if (position < priv->catch_up_position)
+    return;
+
+  stream->segment.rate = priv->catch_up_rate;
+  stream->segment.start = pts;
+  stream->segment.time = time;
+  stream->segment.position = pts;
+  stream->segment.offset = 0;
+  stream->segment.base = priv->catch_up_running_time +
+      (position - priv->catch_up_position) / priv->catch_up_rate;
+  stream->catch_up_generation = priv->catch_up_generation;
+
+  GST_DEBUG_OBJECT (stream->pad, "Catch-up segment %" GST_SEGMENT_FORMAT,
+      &stream->segment);
+
+  stream->pending_segment = gst_event_new_segment (&stream->segment);
+  gst_event_set_seqnum (stream->pending_segment, priv->segment_seqnum);
+}
+
 /* must be called with manifest_lock taken.
  * Temporarily releases manifest_lock
  */
-GstFlowReturn
-gst_adaptive_demux_stream_push_buffer (GstAdaptiveDemuxStream * stream,
-    GstBuffer * buffer)
+static GstFlowReturn
+gst_adaptive_demux_stream_push_buffer_full (GstAdaptiveDemuxStream * stream,
+    GstBuffer * buffer, gboolean timestamped)
 {
   GstAdaptiveDemux *demux = stream->demux;
   GstFlowReturn ret = GST_FLOW_OK;
@@ -2338,9 +2689,22 @@ gst_adaptive_demux_stream_push_buffer (GstAdaptiveDemuxStream * stream,
        * as each fragment for its own has to be reversed */
       discont = TRUE;
 
-    GST_BUFFER_PTS (buffer) = stream->fragment.timestamp;
-    if (GST_BUFFER_PTS_IS_VALID (buffer))
-      GST_BUFFER_PTS (buffer) += offset;
+    if (!timestamped) {
+      GST_BUFFER_PTS (buffer) = stream->fragment.timestamp;
+      if (GST_BUFFER_PTS_IS_VALID (buffer))
+        GST_BUFFER_PTS (buffer) += offset;
+    }
+
+    /* in low latency mode, adjust the playback rate at the fragment
+     * boundaries to keep up with the live edge */
+    if (GST_BUFFER_PTS_IS_VALID (buffer) && demux->priv->low_latency
+        && stream->pending_segment == NULL && demux->segment.rate == 1.0
+        && gst_adaptive_demux_is_live (demux)) {
+      gst_adaptive_demux_update_catch_up (demux, stream,
+          GST_BUFFER_PTS (buffer));
+      gst_adaptive_demux_stream_apply_catch_up (demux, stream,
+          GST_BUFFER_PTS (buffer));
+    }
 
     if (GST_BUFFER_PTS_IS_VALID (buffer)) {
       stream->segment.position = GST_BUFFER_PTS (buffer);
@@ -2357,7 +2721,7 @@ gst_adaptive_demux_stream_push_buffer (GstAdaptiveDemuxStream * stream,
     GST_LOG_OBJECT (stream->pad,
         "Going to push buffer with PTS %" GST_TIME_FORMAT,
         GST_TIME_ARGS (GST_BUFFER_PTS (buffer)));
-  } else {
+  } else if (!timestamped) {
     GST_BUFFER_PTS (buffer) = GST_CLOCK_TIME_NONE;
   }
 
@@ -2375,8 +2739,10 @@ gst_adaptive_demux_stream_push_buffer (GstAdaptiveDemuxStream * stream,
 
   stream->first_fragment_buffer = FALSE;
 
-  GST_BUFFER_DURATION (buffer) = GST_CLOCK_TIME_NONE;
-  GST_BUFFER_DTS (buffer) = GST_CLOCK_TIME_NONE;
+  if (!timestamped) {
+    GST_BUFFER_DURATION (buffer) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_DTS (buffer) = GST_CLOCK_TIME_NONE;
+  }
   if (G_UNLIKELY (stream->pending_caps)) {
     pending_caps = gst_event_new_caps (stream->pending_caps);
     gst_caps_unref (stream->pending_caps);
@@ -2491,6 +2857,38 @@ gst_adaptive_demux_stream_push_buffer (GstAdaptiveDemuxStream * stream,
   return ret;
 }
 
+/* must be called with manifest_lock taken.
+ * Temporarily releases manifest_lock
+ */
+GstFlowReturn
+gst_adaptive_demux_stream_push_buffer (GstAdaptiveDemuxStream * stream,
+    GstBuffer * buffer)
+{
+  return gst_adaptive_demux_stream_push_buffer_full (stream, buffer, FALSE);
+}
+
+/**
+ * gst_adaptive_demux_stream_push_timestamped_buffer:
+ * @stream: #GstAdaptiveDemuxStream
+ * @buffer: (transfer full): a buffer timestamped in the stream's segment,
+ *   i.e. including the presentation offset
+ *
+ * Like gst_adaptive_demux_stream_push_buffer() but keeps the timestamps and
+ * the duration of @buffer, for subclasses that output the samples of the
+ * fragments instead of the fragment data.
+ *
+ * Must be called with the manifest lock taken, which is temporarily
+ * released.
+ *
+ * Since: 1.16
+ */
+GstFlowReturn
+gst_adaptive_demux_stream_push_timestamped_buffer (GstAdaptiveDemuxStream *
+    stream, GstBuffer * buffer)
+{
+  return gst_adaptive_demux_stream_push_buffer_full (stream, buffer, TRUE);
+}
+
 /* must be called with manifest_lock taken */
 static GstFlowReturn
 gst_adaptive_demux_stream_finish_fragment_default (GstAdaptiveDemux * demux,
@@ -2631,6 +3029,9 @@ _src_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GST_TRACE_OBJECT (stream->pad, "Received buffer of size %" G_GSIZE_FORMAT,
       gst_buffer_get_size (buffer));
 
+  if (stream->cache_adapter)
+    gst_adapter_push (stream->cache_adapter, gst_buffer_ref (buffer));
+
   ret = klass->data_received (demux, stream, buffer);
 
   if (ret == GST_FLOW_FLUSHING) {
@@ -2748,6 +3149,22 @@ _src_event (GstPad * pad, GstObject * parent, GstEvent * event)
       GST_MANIFEST_UNLOCK (demux);
       break;
     }
+    case GST_EVENT_CUSTOM_DOWNSTREAM_STICKY:{
+      const GstStructure *s = gst_event_get_structure (event);
+      const GValue *value;
+
+      /* keep the validators of a header or index going to the index cache */
+      if (stream->cache_adapter && gst_structure_has_name (s, "http-headers")) {
+        value = gst_structure_get_value (s, "response-headers");
+        if (value && GST_VALUE_HOLDS_STRUCTURE (value)) {
+          if (stream->cache_headers)
+            gst_structure_free (stream->cache_headers);
+          stream->cache_headers =
+              gst_structure_copy (gst_value_get_structure (value));
+        }
+      }
+      break;
+    }
     default:
       break;
   }
@@ -3116,7 +3533,7 @@ uritype (GstAdaptiveDemuxStream * s)
 static GstFlowReturn
 gst_adaptive_demux_stream_download_uri (GstAdaptiveDemux * demux,
     GstAdaptiveDemuxStream * stream, const gchar * uri, gint64 start,
-    gint64 end, guint * http_status)
+    gint64 end, const GstStructure * request_headers, guint * http_status)
 {
   GstFlowReturn ret = GST_FLOW_OK;
   GST_DEBUG_OBJECT (stream->pad,
@@ -3131,6 +3548,10 @@ gst_adaptive_demux_stream_download_uri (GstAdaptiveDemux * demux,
     return ret;
   }
 
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (stream->uri_handler),
+          "extra-headers"))
+    g_object_set (stream->uri_handler, "extra-headers", request_headers, NULL);
+
   gst_element_set_locked_state (stream->src, TRUE);
 
   GST_MANIFEST_UNLOCK (demux);
@@ -3271,6 +3692,499 @@ gst_adaptive_demux_stream_download_uri (GstAdaptiveDemux * demux,
   return ret;
 }
 
+typedef struct
+{
+  gchar *path;
+  gint64 last_used;
+  guint64 size;
+} GstAdaptiveDemuxIndexCacheEntry;
+
+static gint
+compare_index_cache_entries (gconstpointer a, gconstpointer b)
+{
+  const GstAdaptiveDemuxIndexCacheEntry *ea = a;
+  const GstAdaptiveDemuxIndexCacheEntry *eb = b;
+
+  if (ea->last_used < eb->last_used)
+    return -1;
+  if (ea->last_used > eb->last_used)
+    return 1;
+  return 0;
+}
+
+/* Returns the current time in microseconds, made strictly increasing in the
+ * process so that the entries used in a row keep their order within the
+ * resolution of the clock */
+static gint64
+gst_adaptive_demux_index_cache_stamp (void)
+{
+  static GMutex lock;
+  static gint64 last_stamp = 0;
+  gint64 stamp = g_get_real_time ();
+
+  g_mutex_lock (&lock);
+  if (stamp <= last_stamp)
+    stamp = last_stamp + 1;
+  last_stamp = stamp;
+  g_mutex_unlock (&lock);
+
+  return stamp;
+}
+
+/* must be called with manifest_lock taken.
+ * Returns the path of the cache entry of the given range of uri, or NULL if
+ * it must not be cached */
+static gchar *
+gst_adaptive_demux_index_cache_get_path (GstAdaptiveDemux * demux,
+    const gchar * uri, gint64 start, gint64 end)
+{
+  gchar *key, *checksum, *filename, *path;
+
+  if (demux->priv->index_cache_directory == NULL ||
+      demux->priv->index_cache_max_size == 0 || demux->manifest_uri == NULL)
+    return NULL;
+
+  /* the indexes of live streams change with each manifest update */
+  if (gst_adaptive_demux_is_live (demux))
+    return NULL;
+
+  /* the same resource can be shared by several manifests, e.g. with different
+   * base URLs, so the manifest is part of the key */
+  key = g_strdup_printf ("%s\n%s\n%" G_GINT64_FORMAT "-%" G_GINT64_FORMAT,
+      demux->manifest_uri, uri, start, end);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+  filename = g_strconcat (checksum, INDEX_CACHE_SUFFIX, NULL);
+  path = g_build_filename (demux->priv->index_cache_directory, filename, NULL);
+
+  g_free (filename);
+  g_free (checksum);
+  g_free (key);
+
+  return path;
+}
+
+/* Returns the key file of the entry at @path, or NULL if it has none */
+static GKeyFile *
+gst_adaptive_demux_index_cache_read_meta (const gchar * path)
+{
+  gchar *meta_path = g_strconcat (path, INDEX_CACHE_META_SUFFIX, NULL);
+  GKeyFile *meta = g_key_file_new ();
+
+  if (!g_key_file_load_from_file (meta, meta_path, G_KEY_FILE_NONE, NULL)) {
+    g_key_file_unref (meta);
+    meta = NULL;
+  }
+  g_free (meta_path);
+
+  return meta;
+}
+
+static void
+gst_adaptive_demux_index_cache_write_meta (GstAdaptiveDemux * demux,
+    const gchar * path, GKeyFile * meta)
+{
+  gchar *meta_path = g_strconcat (path, INDEX_CACHE_META_SUFFIX, NULL);
+  GError *err = NULL;
+  gchar *data;
+  gsize length;
+
+  data = g_key_file_to_data (meta, &length, NULL);
+  if (!g_file_set_contents (meta_path, data, length, &err)) {
+    GST_WARNING_OBJECT (demux, "Could not write index cache entry: %s",
+        err->message);
+    g_clear_error (&err);
+  }
+  g_free (data);
+  g_free (meta_path);
+}
+
+static void
+gst_adaptive_demux_index_cache_remove (const gchar * path)
+{
+  gchar *meta_path = g_strconcat (path, INDEX_CACHE_META_SUFFIX, NULL);
+
+  g_unlink (meta_path);
+  g_unlink (path);
+  g_free (meta_path);
+}
+
+/* Returns the value of the response header @name, looked up without case as
+ * the HTTP sources differ there */
+static const gchar *
+gst_adaptive_demux_get_response_header (const GstStructure * headers,
+    const gchar * name)
+{
+  const GValue *value;
+  gint i;
+
+  for (i = 0; i < gst_structure_n_fields (headers); i++) {
+    if (g_ascii_strcasecmp (gst_structure_nth_field_name (headers, i),
+            name) != 0)
+      continue;
+    value = gst_structure_get_value (headers,
+        gst_structure_nth_field_name (headers, i));
+    if (G_VALUE_HOLDS_STRING (value))
+      return g_value_get_string (value);
+  }
+
+  return NULL;
+}
+
+/* Updates the validators and the expiry of an entry from @headers, the
+ * response headers of its download or of its revalidation. Without them, the
+ * entry is kept for the max-age it had. Returns FALSE if the response must
+ * not be stored */
+static gboolean
+gst_adaptive_demux_index_cache_update_meta (GKeyFile * meta,
+    const GstStructure * headers)
+{
+  const gchar *etag = NULL, *last_modified = NULL, *cache_control = NULL;
+  gboolean no_cache = FALSE;
+  gint64 max_age;
+  GError *err = NULL;
+
+  max_age = g_key_file_get_int64 (meta, INDEX_CACHE_META_GROUP, "max-age",
+      &err);
+  if (err) {
+    max_age = INDEX_CACHE_DEFAULT_MAX_AGE;
+    g_clear_error (&err);
+  }
+
+  if (headers) {
+    etag = gst_adaptive_demux_get_response_header (headers, "ETag");
+    last_modified =
+        gst_adaptive_demux_get_response_header (headers, "Last-Modified");
+    cache_control =
+        gst_adaptive_demux_get_response_header (headers, "Cache-Control");
+  }
+
+  if (cache_control) {
+    gchar **directives = g_strsplit (cache_control, ",", -1);
+    gchar **d;
+
+    for (d = directives; *d; d++) {
+      gchar *directive = g_strstrip (*d);
+
+      if (g_ascii_strcasecmp (directive, "no-store") == 0) {
+        g_strfreev (directives);
+        return FALSE;
+      } else if (g_ascii_strcasecmp (directive, "no-cache") == 0) {
+        no_cache = TRUE;
+      } else if (g_ascii_strncasecmp (directive, "max-age=", 8) == 0) {
+        max_age = MAX (g_ascii_strtoll (directive + 8, NULL, 10), 0) *
+            G_USEC_PER_SEC;
+      }
+    }
+    g_strfreev (directives);
+  }
+  if (no_cache)
+    max_age = 0;
+
+  if (etag)
+    g_key_file_set_string (meta, INDEX_CACHE_META_GROUP, "etag", etag);
+  if (last_modified)
+    g_key_file_set_string (meta, INDEX_CACHE_META_GROUP, "last-modified",
+        last_modified);
+  g_key_file_set_int64 (meta, INDEX_CACHE_META_GROUP, "max-age", max_age);
+  g_key_file_set_int64 (meta, INDEX_CACHE_META_GROUP, "expires",
+      g_get_real_time () + max_age);
+
+  return TRUE;
+}
+
+static gboolean
+gst_adaptive_demux_index_cache_is_fresh (GKeyFile * meta)
+{
+  /* 0 if unknown */
+  return g_get_real_time () < g_key_file_get_int64 (meta,
+      INDEX_CACHE_META_GROUP, "expires", NULL);
+}
+
+/* Returns the headers of a conditional request revalidating the entry, or
+ * NULL if it has no validator */
+static GstStructure *
+gst_adaptive_demux_index_cache_get_conditions (GKeyFile * meta)
+{
+  GstStructure *conditions = NULL;
+  gchar *etag, *last_modified;
+
+  etag = g_key_file_get_string (meta, INDEX_CACHE_META_GROUP, "etag", NULL);
+  last_modified = g_key_file_get_string (meta, INDEX_CACHE_META_GROUP,
+      "last-modified", NULL);
+
+  if (etag || last_modified) {
+    conditions = gst_structure_new_empty ("headers");
+    if (etag)
+      gst_structure_set (conditions, "If-None-Match", G_TYPE_STRING, etag,
+          NULL);
+    if (last_modified)
+      gst_structure_set (conditions, "If-Modified-Since", G_TYPE_STRING,
+          last_modified, NULL);
+  }
+
+  g_free (etag);
+  g_free (last_modified);
+
+  return conditions;
+}
+
+/* must be called with manifest_lock taken.
+ * Returns the entry at @path and its key file in @meta, marking it as the
+ * most recently used one. The entries without a key file have no validator
+ * and are expired */
+static GstBuffer *
+gst_adaptive_demux_index_cache_lookup (GstAdaptiveDemux * demux,
+    const gchar * path, GKeyFile ** meta)
+{
+  gchar *contents;
+  gsize length;
+
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    return NULL;
+
+  if (length == 0) {
+    g_free (contents);
+    return NULL;
+  }
+
+  *meta = gst_adaptive_demux_index_cache_read_meta (path);
+  if (*meta == NULL)
+    *meta = g_key_file_new ();
+  g_key_file_set_int64 (*meta, INDEX_CACHE_META_GROUP, "last-used",
+      gst_adaptive_demux_index_cache_stamp ());
+  gst_adaptive_demux_index_cache_write_meta (demux, path, *meta);
+
+  return gst_buffer_new_wrapped (contents, length);
+}
+
+/* must be called with manifest_lock taken.
+ * Removes the least recently used entries until the cache fits in
+ * index_cache_max_size */
+static void
+gst_adaptive_demux_index_cache_evict (GstAdaptiveDemux * demux)
+{
+  GstAdaptiveDemuxIndexCacheEntry *entry;
+  GArray *entries;
+  const gchar *name;
+  guint64 total = 0;
+  GDir *dir;
+  guint i;
+
+  dir = g_dir_open (demux->priv->index_cache_directory, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  entries = g_array_new (FALSE, FALSE,
+      sizeof (GstAdaptiveDemuxIndexCacheEntry));
+  while ((name = g_dir_read_name (dir)) != NULL) {
+    GstAdaptiveDemuxIndexCacheEntry e;
+    GKeyFile *meta;
+    GStatBuf st;
+
+    if (!g_str_has_suffix (name, INDEX_CACHE_SUFFIX))
+      continue;
+
+    e.path = g_build_filename (demux->priv->index_cache_directory, name, NULL);
+    if (g_stat (e.path, &st) != 0) {
+      g_free (e.path);
+      continue;
+    }
+    /* the entries without key file go first */
+    e.last_used = 0;
+    meta = gst_adaptive_demux_index_cache_read_meta (e.path);
+    if (meta) {
+      e.last_used = g_key_file_get_int64 (meta, INDEX_CACHE_META_GROUP,
+          "last-used", NULL);
+      g_key_file_unref (meta);
+    }
+    e.size = st.st_size;
+    total += e.size;
+    g_array_append_val (entries, e);
+  }
+  g_dir_close (dir);
+
+  if (total > demux->priv->index_cache_max_size) {
+    g_array_sort (entries, compare_index_cache_entries);
+
+    for (i = 0; i < entries->len && total > demux->priv->index_cache_max_size;
+        i++) {
+      entry = &g_array_index (entries, GstAdaptiveDemuxIndexCacheEntry, i);
+      GST_LOG_OBJECT (demux, "Evicting %s from the index cache", entry->path);
+      gst_adaptive_demux_index_cache_remove (entry->path);
+      if (!g_file_test (entry->path, G_FILE_TEST_EXISTS))
+        total -= entry->size;
+    }
+  }
+
+  for (i = 0; i < entries->len; i++) {
+    entry = &g_array_index (entries, GstAdaptiveDemuxIndexCacheEntry, i);
+    g_free (entry->path);
+  }
+  g_array_free (entries, TRUE);
+}
+
+/* must be called with manifest_lock taken */
+static void
+gst_adaptive_demux_index_cache_store (GstAdaptiveDemux * demux,
+    const gchar * path, GstAdapter * adapter, const GstStructure * headers)
+{
+  gsize size = gst_adapter_available (adapter);
+  GError *err = NULL;
+  gconstpointer data;
+  GKeyFile *meta;
+
+  if (size == 0 || size > demux->priv->index_cache_max_size)
+    return;
+
+  meta = g_key_file_new ();
+  if (!gst_adaptive_demux_index_cache_update_meta (meta, headers)) {
+    GST_DEBUG_OBJECT (demux, "Not caching %s, the server does not allow it",
+        path);
+    gst_adaptive_demux_index_cache_remove (path);
+    g_key_file_unref (meta);
+    return;
+  }
+  g_key_file_set_int64 (meta, INDEX_CACHE_META_GROUP, "last-used",
+      gst_adaptive_demux_index_cache_stamp ());
+
+  if (g_mkdir_with_parents (demux->priv->index_cache_directory, 0755) != 0) {
+    GST_WARNING_OBJECT (demux, "Could not create index cache directory %s",
+        demux->priv->index_cache_directory);
+    g_key_file_unref (meta);
+    return;
+  }
+
+  data = gst_adapter_map (adapter, size);
+  if (g_file_set_contents (path, data, size, &err)) {
+    gst_adaptive_demux_index_cache_write_meta (demux, path, meta);
+  } else {
+    GST_WARNING_OBJECT (demux, "Could not write index cache entry: %s",
+        err->message);
+    g_clear_error (&err);
+  }
+  gst_adapter_unmap (adapter);
+  g_key_file_unref (meta);
+
+  gst_adaptive_demux_index_cache_evict (demux);
+}
+
+/* must be called with manifest_lock taken.
+ * Passes a header or index read from the index cache to the subclass as if
+ * it had just been downloaded */
+static GstFlowReturn
+gst_adaptive_demux_stream_push_cached (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream, GstBuffer * buffer, gint64 start)
+{
+  GstFlowReturn ret;
+
+  GST_BUFFER_OFFSET (buffer) = MAX (start, 0);
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  stream->download_finished = FALSE;
+  stream->downloading_first_buffer = TRUE;
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  ret = _src_chain (stream->internal_pad, GST_OBJECT_CAST (demux), buffer);
+  if (ret == GST_FLOW_OK)
+    gst_adaptive_demux_eos_handling (stream);
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  if (G_UNLIKELY (stream->cancelled)) {
+    ret = stream->last_ret = GST_FLOW_FLUSHING;
+    g_mutex_unlock (&stream->fragment_download_lock);
+    return ret;
+  }
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  return stream->last_ret;
+}
+
+/* must be called with manifest_lock taken.
+ * Can temporarily release manifest_lock
+ *
+ * Downloads a header or an index, or reads it from the index cache. Expired
+ * entries are revalidated with a conditional request.
+ */
+static GstFlowReturn
+gst_adaptive_demux_stream_download_header_uri (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream, const gchar * uri, gint64 start,
+    gint64 end)
+{
+  GstFlowReturn ret;
+  GstBuffer *cached = NULL;
+  GstStructure *conditions = NULL;
+  GKeyFile *meta = NULL;
+  gboolean not_modified;
+  gchar *cache_path;
+
+  cache_path = gst_adaptive_demux_index_cache_get_path (demux, uri, start, end);
+  if (cache_path)
+    cached = gst_adaptive_demux_index_cache_lookup (demux, cache_path, &meta);
+
+  if (cached && gst_adaptive_demux_index_cache_is_fresh (meta)) {
+    GST_DEBUG_OBJECT (stream->pad, "Using cached %s %s",
+        uritype (stream), cache_path);
+    ret = gst_adaptive_demux_stream_push_cached (demux, stream,
+        gst_buffer_ref (cached), start);
+    goto done;
+  }
+
+  if (cached) {
+    conditions = gst_adaptive_demux_index_cache_get_conditions (meta);
+    if (conditions == NULL)
+      gst_buffer_replace (&cached, NULL);
+  }
+
+  if (cache_path)
+    stream->cache_adapter = gst_adapter_new ();
+
+  stream->last_status_code = 200;
+  ret = gst_adaptive_demux_stream_download_uri (demux, stream, uri, start, end,
+      conditions, NULL);
+  not_modified = cached && ret == GST_FLOW_CUSTOM_ERROR
+      && stream->last_status_code == HTTP_STATUS_NOT_MODIFIED;
+
+  if (not_modified) {
+    GST_DEBUG_OBJECT (stream->pad, "Cached %s %s is still valid",
+        uritype (stream), cache_path);
+    if (gst_adaptive_demux_index_cache_update_meta (meta,
+            stream->cache_headers))
+      gst_adaptive_demux_index_cache_write_meta (demux, cache_path, meta);
+    else
+      gst_adaptive_demux_index_cache_remove (cache_path);
+  } else if (stream->cache_adapter && ret == GST_FLOW_OK) {
+    gst_adaptive_demux_index_cache_store (demux, cache_path,
+        stream->cache_adapter, stream->cache_headers);
+  }
+
+  if (stream->cache_adapter) {
+    g_object_unref (stream->cache_adapter);
+    stream->cache_adapter = NULL;
+  }
+  if (stream->cache_headers) {
+    gst_structure_free (stream->cache_headers);
+    stream->cache_headers = NULL;
+  }
+
+  if (not_modified) {
+    g_clear_error (&stream->last_error);
+    stream->last_ret = GST_FLOW_OK;
+    ret = gst_adaptive_demux_stream_push_cached (demux, stream,
+        gst_buffer_ref (cached), start);
+  }
+
+done:
+  if (cached)
+    gst_buffer_unref (cached);
+  if (conditions)
+    gst_structure_free (conditions);
+  if (meta)
+    g_key_file_unref (meta);
+  g_free (cache_path);
+
+  return ret;
+}
+
 /* must be called with manifest_lock taken.
  * Can temporarily release manifest_lock
  */
@@ -3287,9 +4201,9 @@ gst_adaptive_demux_stream_download_header_fragment (GstAdaptiveDemuxStream *
         stream->fragment.header_range_start, stream->fragment.header_range_end);
 
     stream->downloading_header = TRUE;
-    ret = gst_adaptive_demux_stream_download_uri (demux, stream,
+    ret = gst_adaptive_demux_stream_download_header_uri (demux, stream,
         stream->fragment.header_uri, stream->fragment.header_range_start,
-        stream->fragment.header_range_end, NULL);
+        stream->fragment.header_range_end);
     stream->downloading_header = FALSE;
   }
 
@@ -3302,9 +4216,9 @@ gst_adaptive_demux_stream_download_header_fragment (GstAdaptiveDemuxStream *
           stream->fragment.index_uri,
           stream->fragment.index_range_start, stream->fragment.index_range_end);
       stream->downloading_index = TRUE;
-      ret = gst_adaptive_demux_stream_download_uri (demux, stream,
+      ret = gst_adaptive_demux_stream_download_header_uri (demux, stream,
           stream->fragment.index_uri, stream->fragment.index_range_start,
-          stream->fragment.index_range_end, NULL);
+          stream->fragment.index_range_end);
       stream->downloading_index = FALSE;
     }
   }
@@ -3384,7 +4298,7 @@ again:
 
       ret =
           gst_adaptive_demux_stream_download_uri (demux, stream, url,
-          chunk_start, chunk_end, &http_status);
+          chunk_start, chunk_end, NULL, &http_status);
 
       GST_DEBUG_OBJECT (stream->pad,
           "Fragment chunk download result: %d (%d) %s", stream->last_ret,
@@ -3432,7 +4346,8 @@ again:
   } else {
     ret =
         gst_adaptive_demux_stream_download_uri (demux, stream, url,
-        stream->fragment.range_start, stream->fragment.range_end, &http_status);
+        stream->fragment.range_start, stream->fragment.range_end, NULL,
+        &http_status);
     GST_DEBUG_OBJECT (stream->pad, "Fragment download result: %d (%d) %s",
         stream->last_ret, http_status, gst_flow_get_name (stream->last_ret));
   }
@@ -4473,6 +5388,26 @@ gst_adaptive_demux_get_client_now_utc (GstAdaptiveDemux * demux)
   return g_date_time_new_from_timeval_utc (&gtv);
 }
 
+/**
+ * gst_adaptive_demux_is_low_latency:
+ * @demux: #GstAdaptiveDemux
+ *
+ * Used by subclasses to request fragments as early as possible when playing
+ * a live stream.
+ *
+ * Must be called with the manifest lock taken.
+ *
+ * Returns: %TRUE if #GstAdaptiveDemux:low-latency is enabled
+ *
+ * Since: 1.16
+ */
+gboolean
+gst_adaptive_demux_is_low_latency (GstAdaptiveDemux * demux)
+{
+  g_return_val_if_fail (demux != NULL, FALSE);
+  return demux->priv->low_latency;
+}
+
 static GstAdaptiveDemuxTimer *
 gst_adaptive_demux_timer_new (GCond * cond, GMutex * mutex)
 {
@@ -149,6 +149,10 @@ struct _GstAdaptiveDemuxStream
   gboolean downloading_first_buffer;
   gboolean downloading_header;
   gboolean downloading_index;
+  /* copy of the header or index being downloaded, to be stored in the
+   * index cache, and its response headers */
+  GstAdapter *cache_adapter;
+  GstStructure *cache_headers;
 
   gboolean bitrate_changed;
 
@@ -187,6 +191,9 @@ struct _GstAdaptiveDemuxStream
   /* QoS data */
   GstClockTime qos_earliest_time;
 
+  /* low latency catch-up switch the segment was last updated for */
+  guint catch_up_generation;
+
   GstAdaptiveDemuxStreamFragment fragment;
 
   guint download_error_count;
@@ -514,6 +521,9 @@ void gst_adaptive_demux_stream_fragment_clear (GstAdaptiveDemuxStreamFragment *
 GST_ADAPTIVE_DEMUX_API
 GstFlowReturn gst_adaptive_demux_stream_push_buffer (GstAdaptiveDemuxStream * stream, GstBuffer * buffer);
 
+GST_ADAPTIVE_DEMUX_API
+GstFlowReturn gst_adaptive_demux_stream_push_timestamped_buffer (GstAdaptiveDemuxStream * stream, GstBuffer * buffer);
+
 GST_ADAPTIVE_DEMUX_API
 GstFlowReturn
 gst_adaptive_demux_stream_advance_fragment (GstAdaptiveDemux * demux,
@@ -529,6 +539,9 @@ GstClockTime gst_adaptive_demux_get_monotonic_time (GstAdaptiveDemux * demux);
 GST_ADAPTIVE_DEMUX_API
 GDateTime *gst_adaptive_demux_get_client_now_utc (GstAdaptiveDemux * demux);
 
+GST_ADAPTIVE_DEMUX_API
+gboolean gst_adaptive_demux_is_low_latency (GstAdaptiveDemux * demux);
+
 G_END_DECLS
 
 #endif
@@ -556,6 +556,131 @@ gst_isoff_moof_box_free (GstMoofBox * moof)
   g_free (moof);
 }
 
+/* gst_isoff_moof_box_get_samples:
+ * @moof: a parsed moof box
+ * @moof_offset: offset of the start of the moof box
+ * @track_id: track to get the samples of
+ * @trex: (allow-none): track extends defaults of the track
+ *
+ * Resolves the samples of all track runs of @track_id in @moof, the data
+ * offsets following the default-base-is-moof, base data offset and implicit
+ * (end of the previous run) rules. The decode times start at the tfdt of the
+ * first traf, trafs without decode time continue where the previous left.
+ *
+ * Returns: an array of #GstIsoffSample, or NULL if a sample size or
+ * duration could not be resolved
+ */
+GArray *
+gst_isoff_moof_box_get_samples (GstMoofBox * moof, guint64 moof_offset,
+    guint32 track_id, const GstTrexBox * trex)
+{
+  GArray *samples;
+  guint64 prev_traf_end, decode_time = 0;
+  gboolean had_traf = FALSE;
+  guint i;
+
+  g_return_val_if_fail (moof != NULL, NULL);
+
+  samples = g_array_new (FALSE, FALSE, sizeof (GstIsoffSample));
+
+  prev_traf_end = moof_offset;
+  for (i = 0; i < moof->traf->len; i++) {
+    GstTrafBox *traf = &g_array_index (moof->traf, GstTrafBox, i);
+    gboolean match = traf->tfhd.track_id == track_id;
+    const GstTrexBox *defaults = match ? trex : NULL;
+    guint64 traf_offset, prev_trun_end;
+    guint j;
+
+    if (traf->tfhd.flags & GST_TFHD_FLAGS_BASE_DATA_OFFSET_PRESENT)
+      traf_offset = traf->tfhd.base_data_offset;
+    else if (traf->tfhd.flags & GST_TFHD_FLAGS_DEFAULT_BASE_IS_MOOF)
+      traf_offset = moof_offset;
+    else
+      traf_offset = prev_traf_end;
+
+    if (match && (!had_traf || traf->tfdt.decode_time != 0))
+      decode_time = traf->tfdt.decode_time;
+
+    prev_trun_end = traf_offset;
+    for (j = 0; j < traf->trun->len; j++) {
+      GstTrunBox *trun = &g_array_index (traf->trun, GstTrunBox, j);
+      guint64 sample_offset;
+      guint k;
+
+      if (trun->flags & GST_TRUN_FLAGS_DATA_OFFSET_PRESENT)
+        sample_offset = traf_offset + trun->data_offset;
+      else
+        sample_offset = prev_trun_end;
+
+      for (k = 0; k < trun->samples->len; k++) {
+        GstTrunSample *trun_sample =
+            &g_array_index (trun->samples, GstTrunSample, k);
+        GstIsoffSample sample = { 0, };
+
+        sample.offset = sample_offset;
+        sample.decode_time = decode_time;
+
+        if (trun->flags & GST_TRUN_FLAGS_SAMPLE_SIZE_PRESENT)
+          sample.size = trun_sample->sample_size;
+        else if (traf->tfhd.flags & GST_TFHD_FLAGS_DEFAULT_SAMPLE_SIZE_PRESENT)
+          sample.size = traf->tfhd.default_sample_size;
+        else if (defaults)
+          sample.size = defaults->default_sample_size;
+        else
+          goto unresolved;
+
+        if (trun->flags & GST_TRUN_FLAGS_SAMPLE_DURATION_PRESENT)
+          sample.duration = trun_sample->sample_duration;
+        else if (traf->
+            tfhd.flags & GST_TFHD_FLAGS_DEFAULT_SAMPLE_DURATION_PRESENT)
+          sample.duration = traf->tfhd.default_sample_duration;
+        else if (defaults)
+          sample.duration = defaults->default_sample_duration;
+        else if (match)
+          goto unresolved;
+
+        if (trun->flags & GST_TRUN_FLAGS_SAMPLE_FLAGS_PRESENT)
+          sample.flags = trun_sample->sample_flags;
+        else if ((trun->flags & GST_TRUN_FLAGS_FIRST_SAMPLE_FLAGS_PRESENT)
+            && k == 0)
+          sample.flags = trun->first_sample_flags;
+        else if (traf->tfhd.flags & GST_TFHD_FLAGS_DEFAULT_SAMPLE_FLAGS_PRESENT)
+          sample.flags = traf->tfhd.default_sample_flags;
+        else if (defaults)
+          sample.flags = defaults->default_sample_flags;
+
+        if (trun->flags & GST_TRUN_FLAGS_SAMPLE_COMPOSITION_TIME_OFFSETS_PRESENT) {
+          if (trun->version == 0)
+            sample.composition_time_offset =
+                MIN (trun_sample->sample_composition_time_offset.u, G_MAXINT32);
+          else
+            sample.composition_time_offset =
+                trun_sample->sample_composition_time_offset.s;
+        }
+
+        if (match) {
+          g_array_append_val (samples, sample);
+          decode_time += sample.duration;
+        }
+
+        sample_offset += sample.size;
+      }
+
+      prev_trun_end = sample_offset;
+    }
+
+    prev_traf_end = prev_trun_end;
+    had_traf |= match;
+  }
+
+  return samples;
+
+unresolved:
+  GST_DEBUG ("Sample size or duration not given by trun, tfhd or trex");
+  g_array_free (samples, TRUE);
+  return NULL;
+}
+
 static gboolean
 gst_isoff_mdhd_box_parse (GstMdhdBox * mdhd, GstByteReader * reader)
 {
@@ -608,10 +733,347 @@ gst_isoff_hdlr_box_parse (GstHdlrBox * hdlr, GstByteReader * reader)
   return TRUE;
 }
 
+/* reads the size of an MPEG-4 descriptor (ISO/IEC 14496-1 expandable class) */
+static gboolean
+gst_isoff_read_descriptor_size (GstByteReader * reader, guint32 * size)
+{
+  guint8 byte;
+  gint i;
+
+  *size = 0;
+  for (i = 0; i < 4; i++) {
+    if (!gst_byte_reader_get_uint8 (reader, &byte))
+      return FALSE;
+    *size = (*size << 7) | (byte & 0x7f);
+    if (!(byte & 0x80))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+static gboolean
+gst_isoff_esds_box_parse (GstStsdEntry * entry, GstByteReader * reader)
+{
+  guint8 tag, es_flags;
+  guint32 size;
+  guint8 *data;
+
+  /* version & flags */
+  if (!gst_byte_reader_skip (reader, 4))
+    return FALSE;
+
+  /* ES_Descriptor */
+  if (!gst_byte_reader_get_uint8 (reader, &tag) || tag != 0x03)
+    return FALSE;
+  if (!gst_isoff_read_descriptor_size (reader, &size))
+    return FALSE;
+  /* ES_ID */
+  if (!gst_byte_reader_skip (reader, 2))
+    return FALSE;
+  if (!gst_byte_reader_get_uint8 (reader, &es_flags))
+    return FALSE;
+  /* dependsOn_ES_ID */
+  if ((es_flags & 0x80) && !gst_byte_reader_skip (reader, 2))
+    return FALSE;
+  if (es_flags & 0x40) {
+    guint8 url_length;
+
+    if (!gst_byte_reader_get_uint8 (reader, &url_length)
+        || !gst_byte_reader_skip (reader, url_length))
+      return FALSE;
+  }
+  /* OCR_ES_Id */
+  if ((es_flags & 0x20) && !gst_byte_reader_skip (reader, 2))
+    return FALSE;
+
+  /* DecoderConfigDescriptor */
+  if (!gst_byte_reader_get_uint8 (reader, &tag) || tag != 0x04)
+    return FALSE;
+  if (!gst_isoff_read_descriptor_size (reader, &size))
+    return FALSE;
+  if (!gst_byte_reader_get_uint8 (reader, &entry->object_type_indication))
+    return FALSE;
+  /* streamType, bufferSizeDB, maxBitrate, avgBitrate */
+  if (!gst_byte_reader_skip (reader, 12))
+    return FALSE;
+
+  /* DecoderSpecificInfo, optional */
+  if (!gst_byte_reader_get_uint8 (reader, &tag) || tag != 0x05)
+    return TRUE;
+  if (!gst_isoff_read_descriptor_size (reader, &size))
+    return FALSE;
+  if (!gst_byte_reader_dup_data (reader, size, &data))
+    return FALSE;
+
+  entry->codec_data = gst_buffer_new_wrapped (data, size);
+
+  return TRUE;
+}
+
+static void
+gst_isoff_stsd_entry_clear (GstStsdEntry * entry)
+{
+  if (entry->codec_data)
+    gst_buffer_unref (entry->codec_data);
+  entry->codec_data = NULL;
+}
+
+static gboolean
+gst_isoff_stsd_entry_parse (GstStsdEntry * entry, guint32 fourcc,
+    GstByteReader * reader)
+{
+  memset (entry, 0, sizeof (*entry));
+  entry->fourcc = fourcc;
+
+  switch (fourcc) {
+    case GST_ISOFF_FOURCC_AVC1:
+    case GST_ISOFF_FOURCC_AVC3:
+    case GST_ISOFF_FOURCC_HVC1:
+    case GST_ISOFF_FOURCC_HEV1:
+    case GST_ISOFF_FOURCC_ENCV:
+      /* reserved, data_reference_index, pre_defined, reserved */
+      if (!gst_byte_reader_skip (reader, 24))
+        return FALSE;
+      if (!gst_byte_reader_get_uint16_be (reader, &entry->width) ||
+          !gst_byte_reader_get_uint16_be (reader, &entry->height))
+        return FALSE;
+      /* resolutions, reserved, frame_count, compressorname, depth,
+       * pre_defined */
+      if (!gst_byte_reader_skip (reader, 50))
+        return FALSE;
+      break;
+    case GST_ISOFF_FOURCC_MP4A:
+    case GST_ISOFF_FOURCC_ENCA:{
+      guint16 version;
+      guint32 sample_rate;
+
+      /* reserved, data_reference_index */
+      if (!gst_byte_reader_skip (reader, 8))
+        return FALSE;
+      /* the reserved fields start with the QuickTime sound version */
+      if (!gst_byte_reader_get_uint16_be (reader, &version) ||
+          !gst_byte_reader_skip (reader, 6))
+        return FALSE;
+      if (!gst_byte_reader_get_uint16_be (reader, &entry->channel_count))
+        return FALSE;
+      /* samplesize, pre_defined, reserved */
+      if (!gst_byte_reader_skip (reader, 6))
+        return FALSE;
+      if (!gst_byte_reader_get_uint32_be (reader, &sample_rate))
+        return FALSE;
+      entry->sample_rate = sample_rate >> 16;
+
+      if (version == 1 && !gst_byte_reader_skip (reader, 16))
+        return FALSE;
+      else if (version == 2 && !gst_byte_reader_skip (reader, 36))
+        return FALSE;
+      break;
+    }
+    default:
+      /* Unknown sample entry, only the type is of interest */
+      return TRUE;
+  }
+
+  while (gst_byte_reader_get_remaining (reader) > 0) {
+    guint32 child_fourcc;
+    guint header_size;
+    guint64 size;
+    GstByteReader sub_reader;
+
+    if (!gst_isoff_parse_box_header (reader, &child_fourcc, NULL, &header_size,
+            &size))
+      goto error;
+    if (gst_byte_reader_get_remaining (reader) < size - header_size)
+      goto error;
+
+    gst_byte_reader_get_sub_reader (reader, &sub_reader, size - header_size);
+
+    switch (child_fourcc) {
+      case GST_ISOFF_FOURCC_AVCC:
+      case GST_ISOFF_FOURCC_HVCC:{
+        guint8 *data;
+
+        if (entry->codec_data)
+          break;
+        if (!gst_byte_reader_dup_data (&sub_reader, size - header_size, &data))
+          goto error;
+        entry->codec_data_fourcc = child_fourcc;
+        entry->codec_data = gst_buffer_new_wrapped (data, size - header_size);
+        break;
+      }
+      case GST_ISOFF_FOURCC_ESDS:
+        if (entry->codec_data)
+          break;
+        entry->codec_data_fourcc = child_fourcc;
+        if (!gst_isoff_esds_box_parse (entry, &sub_reader))
+          goto error;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return TRUE;
+
+error:
+  gst_isoff_stsd_entry_clear (entry);
+  return FALSE;
+}
+
+static void
+gst_isoff_stsd_box_clear (GstStsdBox * stsd)
+{
+  if (stsd->entries)
+    g_array_free (stsd->entries, TRUE);
+  stsd->entries = NULL;
+}
+
+static gboolean
+gst_isoff_stsd_box_parse (GstStsdBox * stsd, GstByteReader * reader)
+{
+  guint32 entry_count, i;
+
+  memset (stsd, 0, sizeof (*stsd));
+
+  /* version & flags */
+  if (!gst_byte_reader_skip (reader, 4))
+    return FALSE;
+
+  if (!gst_byte_reader_get_uint32_be (reader, &entry_count))
+    return FALSE;
+
+  stsd->entries = g_array_new (FALSE, FALSE, sizeof (GstStsdEntry));
+  g_array_set_clear_func (stsd->entries,
+      (GDestroyNotify) gst_isoff_stsd_entry_clear);
+
+  for (i = 0; i < entry_count; i++) {
+    guint32 fourcc;
+    guint header_size;
+    guint64 size;
+    GstByteReader sub_reader;
+    GstStsdEntry entry;
+
+    if (!gst_isoff_parse_box_header (reader, &fourcc, NULL, &header_size,
+            &size))
+      goto error;
+    if (gst_byte_reader_get_remaining (reader) < size - header_size)
+      goto error;
+
+    gst_byte_reader_get_sub_reader (reader, &sub_reader, size - header_size);
+    if (!gst_isoff_stsd_entry_parse (&entry, fourcc, &sub_reader))
+      goto error;
+
+    g_array_append_val (stsd->entries, entry);
+  }
+
+  return TRUE;
+
+error:
+  gst_isoff_stsd_box_clear (stsd);
+  return FALSE;
+}
+
+static gboolean
+gst_isoff_stbl_box_parse (GstStblBox * stbl, GstByteReader * reader)
+{
+  gboolean had_stsd = FALSE;
+
+  memset (stbl, 0, sizeof (*stbl));
+
+  while (gst_byte_reader_get_remaining (reader) > 0) {
+    guint32 fourcc;
+    guint header_size;
+    guint64 size;
+    GstByteReader sub_reader;
+
+    if (!gst_isoff_parse_box_header (reader, &fourcc, NULL, &header_size,
+            &size))
+      goto error;
+    if (gst_byte_reader_get_remaining (reader) < size - header_size)
+      goto error;
+
+    switch (fourcc) {
+      case GST_ISOFF_FOURCC_STSD:{
+        if (had_stsd) {
+          gst_byte_reader_skip (reader, size - header_size);
+          break;
+        }
+
+        gst_byte_reader_get_sub_reader (reader, &sub_reader,
+            size - header_size);
+        if (!gst_isoff_stsd_box_parse (&stbl->stsd, &sub_reader))
+          return FALSE;
+
+        had_stsd = TRUE;
+        break;
+      }
+      default:
+        gst_byte_reader_skip (reader, size - header_size);
+        break;
+    }
+  }
+
+  return TRUE;
+
+error:
+  gst_isoff_stsd_box_clear (&stbl->stsd);
+  return FALSE;
+}
+
+static gboolean
+gst_isoff_minf_box_parse (GstMinfBox * minf, GstByteReader * reader)
+{
+  gboolean had_stbl = FALSE;
+
+  memset (minf, 0, sizeof (*minf));
+
+  while (gst_byte_reader_get_remaining (reader) > 0) {
+    guint32 fourcc;
+    guint header_size;
+    guint64 size;
+    GstByteReader sub_reader;
+
+    if (!gst_isoff_parse_box_header (reader, &fourcc, NULL, &header_size,
+            &size))
+      goto error;
+    if (gst_byte_reader_get_remaining (reader) < size - header_size)
+      goto error;
+
+    switch (fourcc) {
+      case GST_ISOFF_FOURCC_STBL:{
+        if (had_stbl) {
+          gst_byte_reader_skip (reader, size - header_size);
+          break;
+        }
+
+        gst_byte_reader_get_sub_reader (reader, &sub_reader,
+            size - header_size);
+        if (!gst_isoff_stbl_box_parse (&minf->stbl, &sub_reader))
+          return FALSE;
+
+        had_stbl = TRUE;
+        break;
+      }
+      default:
+        gst_byte_reader_skip (reader, size - header_size);
+        break;
+    }
+  }
+
+  return TRUE;
+
+error:
+  gst_isoff_stsd_box_clear (&minf->stbl.stsd);
+  return FALSE;
+}
+
 static gboolean
 gst_isoff_mdia_box_parse (GstMdiaBox * mdia, GstByteReader * reader)
 {
-  gboolean had_mdhd = FALSE, had_hdlr = FALSE;
+  gboolean had_mdhd = FALSE, had_hdlr = FALSE, had_minf = FALSE;
+
+  memset (&mdia->minf, 0, sizeof (mdia->minf));
   while (gst_byte_reader_get_remaining (reader) > 0) {
     guint32 fourcc;
     guint header_size;
@@ -620,16 +1082,16 @@ gst_isoff_mdia_box_parse (GstMdiaBox * mdia, GstByteReader * reader)
 
     if (!gst_isoff_parse_box_header (reader, &fourcc, NULL, &header_size,
             &size))
-      return FALSE;
+      goto error;
     if (gst_byte_reader_get_remaining (reader) < size - header_size)
-      return FALSE;
+      goto error;
 
     switch (fourcc) {
       case GST_ISOFF_FOURCC_MDHD:{
         gst_byte_reader_get_sub_reader (reader, &sub_reader,
             size - header_size);
         if (!gst_isoff_mdhd_box_parse (&mdia->mdhd, &sub_reader))
-          return FALSE;
+          goto error;
 
         had_mdhd = TRUE;
         break;
@@ -638,11 +1100,25 @@ gst_isoff_mdia_box_parse (GstMdiaBox * mdia, GstByteReader * reader)
         gst_byte_reader_get_sub_reader (reader, &sub_reader,
             size - header_size);
         if (!gst_isoff_hdlr_box_parse (&mdia->hdlr, &sub_reader))
-          return FALSE;
+          goto error;
 
         had_hdlr = TRUE;
         break;
       }
+      case GST_ISOFF_FOURCC_MINF:{
+        if (had_minf) {
+          gst_byte_reader_skip (reader, size - header_size);
+          break;
+        }
+
+        gst_byte_reader_get_sub_reader (reader, &sub_reader,
+            size - header_size);
+        if (!gst_isoff_minf_box_parse (&mdia->minf, &sub_reader))
+          goto error;
+
+        had_minf = TRUE;
+        break;
+      }
       default:
         gst_byte_reader_skip (reader, size - header_size);
         break;
@@ -650,9 +1126,13 @@ gst_isoff_mdia_box_parse (GstMdiaBox * mdia, GstByteReader * reader)
   }
 
   if (!had_mdhd || !had_hdlr)
-    return FALSE;
+    goto error;
 
   return TRUE;
+
+error:
+  gst_isoff_stsd_box_clear (&mdia->minf.stbl.stsd);
+  return FALSE;
 }
 
 static gboolean
@@ -686,10 +1166,18 @@ gst_isoff_tkhd_box_parse (GstTkhdBox * tkhd, GstByteReader * reader)
   return TRUE;
 }
 
+static void
+gst_isoff_trak_box_clear (GstTrakBox * trak)
+{
+  gst_isoff_stsd_box_clear (&trak->mdia.minf.stbl.stsd);
+}
+
 static gboolean
 gst_isoff_trak_box_parse (GstTrakBox * trak, GstByteReader * reader)
 {
   gboolean had_mdia = FALSE, had_tkhd = FALSE;
+
+  memset (trak, 0, sizeof (*trak));
   while (gst_byte_reader_get_remaining (reader) > 0) {
     guint32 fourcc;
     guint header_size;
@@ -698,16 +1186,21 @@ gst_isoff_trak_box_parse (GstTrakBox * trak, GstByteReader * reader)
 
     if (!gst_isoff_parse_box_header (reader, &fourcc, NULL, &header_size,
             &size))
-      return FALSE;
+      goto error;
     if (gst_byte_reader_get_remaining (reader) < size - header_size)
-      return FALSE;
+      goto error;
 
     switch (fourcc) {
       case GST_ISOFF_FOURCC_MDIA:{
+        if (had_mdia) {
+          gst_byte_reader_skip (reader, size - header_size);
+          break;
+        }
+
         gst_byte_reader_get_sub_reader (reader, &sub_reader,
             size - header_size);
         if (!gst_isoff_mdia_box_parse (&trak->mdia, &sub_reader))
-          return FALSE;
+          goto error;
 
         had_mdia = TRUE;
         break;
@@ -716,7 +1209,7 @@ gst_isoff_trak_box_parse (GstTrakBox * trak, GstByteReader * reader)
         gst_byte_reader_get_sub_reader (reader, &sub_reader,
             size - header_size);
         if (!gst_isoff_tkhd_box_parse (&trak->tkhd, &sub_reader))
-          return FALSE;
+          goto error;
 
         had_tkhd = TRUE;
         break;
@@ -728,23 +1221,89 @@ gst_isoff_trak_box_parse (GstTrakBox * trak, GstByteReader * reader)
   }
 
   if (!had_tkhd || !had_mdia)
+    goto error;
+
+  return TRUE;
+
+error:
+  gst_isoff_trak_box_clear (trak);
+  return FALSE;
+}
+
+static gboolean
+gst_isoff_trex_box_parse (GstTrexBox * trex, GstByteReader * reader)
+{
+  memset (trex, 0, sizeof (*trex));
+
+  /* version & flags */
+  if (!gst_byte_reader_skip (reader, 4))
+    return FALSE;
+
+  if (!gst_byte_reader_get_uint32_be (reader, &trex->track_id) ||
+      !gst_byte_reader_get_uint32_be (reader,
+          &trex->default_sample_description_index) ||
+      !gst_byte_reader_get_uint32_be (reader, &trex->default_sample_duration)
+      || !gst_byte_reader_get_uint32_be (reader, &trex->default_sample_size)
+      || !gst_byte_reader_get_uint32_be (reader, &trex->default_sample_flags))
     return FALSE;
 
   return TRUE;
 }
 
+static gboolean
+gst_isoff_mvex_box_parse (GArray * trex_array, GstByteReader * reader)
+{
+  while (gst_byte_reader_get_remaining (reader) > 0) {
+    guint32 fourcc;
+    guint header_size;
+    guint64 size;
+    GstByteReader sub_reader;
+
+    if (!gst_isoff_parse_box_header (reader, &fourcc, NULL, &header_size,
+            &size))
+      return FALSE;
+    if (gst_byte_reader_get_remaining (reader) < size - header_size)
+      return FALSE;
+
+    switch (fourcc) {
+      case GST_ISOFF_FOURCC_TREX:{
+        GstTrexBox trex;
+
+        gst_byte_reader_get_sub_reader (reader, &sub_reader,
+            size - header_size);
+        if (!gst_isoff_trex_box_parse (&trex, &sub_reader))
+          return FALSE;
+
+        g_array_append_val (trex_array, trex);
+        break;
+      }
+      default:
+        gst_byte_reader_skip (reader, size - header_size);
+        break;
+    }
+  }
+
+  return TRUE;
+}
+
 GstMoovBox *
 gst_isoff_moov_box_parse (GstByteReader * reader)
 {
   GstMoovBox *moov;
   gboolean had_trak = FALSE;
+
+  INITIALIZE_DEBUG_CATEGORY;
   moov = g_new0 (GstMoovBox, 1);
   moov->trak = g_array_new (FALSE, FALSE, sizeof (GstTrakBox));
+  g_array_set_clear_func (moov->trak,
+      (GDestroyNotify) gst_isoff_trak_box_clear);
+  moov->trex = g_array_new (FALSE, FALSE, sizeof (GstTrexBox));
 
   while (gst_byte_reader_get_remaining (reader) > 0) {
     guint32 fourcc;
     guint header_size;
     guint64 size;
+    GstByteReader sub_reader;
 
     if (!gst_isoff_parse_box_header (reader, &fourcc, NULL, &header_size,
             &size))
@@ -754,7 +1313,6 @@ gst_isoff_moov_box_parse (GstByteReader * reader)
 
     switch (fourcc) {
       case GST_ISOFF_FOURCC_TRAK:{
-        GstByteReader sub_reader;
         GstTrakBox trak;
 
         gst_byte_reader_get_sub_reader (reader, &sub_reader,
@@ -766,6 +1324,13 @@ gst_isoff_moov_box_parse (GstByteReader * reader)
         g_array_append_val (moov->trak, trak);
         break;
       }
+      case GST_ISOFF_FOURCC_MVEX:{
+        gst_byte_reader_get_sub_reader (reader, &sub_reader,
+            size - header_size);
+        if (!gst_isoff_mvex_box_parse (moov->trex, &sub_reader))
+          goto error;
+        break;
+      }
       default:
         gst_byte_reader_skip (reader, size - header_size);
         break;
@@ -786,6 +1351,7 @@ void
 gst_isoff_moov_box_free (GstMoovBox * moov)
 {
   g_array_free (moov->trak, TRUE);
+  g_array_free (moov->trex, TRUE);
   g_free (moov);
 }
 
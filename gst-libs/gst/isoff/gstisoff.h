@@ -59,6 +59,23 @@ gboolean gst_isoff_parse_box_header (GstByteReader * reader, guint32 * type, gui
 #define GST_ISOFF_FOURCC_MDHD GST_MAKE_FOURCC('m','d','h','d')
 #define GST_ISOFF_FOURCC_HDLR GST_MAKE_FOURCC('h','d','l','r')
 #define GST_ISOFF_FOURCC_SIDX GST_MAKE_FOURCC('s','i','d','x')
+#define GST_ISOFF_FOURCC_MINF GST_MAKE_FOURCC('m','i','n','f')
+#define GST_ISOFF_FOURCC_STBL GST_MAKE_FOURCC('s','t','b','l')
+#define GST_ISOFF_FOURCC_STSD GST_MAKE_FOURCC('s','t','s','d')
+#define GST_ISOFF_FOURCC_MVEX GST_MAKE_FOURCC('m','v','e','x')
+#define GST_ISOFF_FOURCC_TREX GST_MAKE_FOURCC('t','r','e','x')
+
+/* sample entries and their codec configuration boxes */
+#define GST_ISOFF_FOURCC_AVC1 GST_MAKE_FOURCC('a','v','c','1')
+#define GST_ISOFF_FOURCC_AVC3 GST_MAKE_FOURCC('a','v','c','3')
+#define GST_ISOFF_FOURCC_AVCC GST_MAKE_FOURCC('a','v','c','C')
+#define GST_ISOFF_FOURCC_HVC1 GST_MAKE_FOURCC('h','v','c','1')
+#define GST_ISOFF_FOURCC_HEV1 GST_MAKE_FOURCC('h','e','v','1')
+#define GST_ISOFF_FOURCC_HVCC GST_MAKE_FOURCC('h','v','c','C')
+#define GST_ISOFF_FOURCC_MP4A GST_MAKE_FOURCC('m','p','4','a')
+#define GST_ISOFF_FOURCC_ESDS GST_MAKE_FOURCC('e','s','d','s')
+#define GST_ISOFF_FOURCC_ENCV GST_MAKE_FOURCC('e','n','c','v')
+#define GST_ISOFF_FOURCC_ENCA GST_MAKE_FOURCC('e','n','c','a')
 
 /* handler type */
 #define GST_ISOFF_FOURCC_SOUN GST_MAKE_FOURCC('s','o','u','n')
@@ -192,6 +209,37 @@ GstMoofBox * gst_isoff_moof_box_parse (GstByteReader *reader);
 GST_ISOFF_API
 void gst_isoff_moof_box_free (GstMoofBox *moof);
 
+typedef struct _GstTrexBox
+{
+  guint32 track_id;
+  guint32 default_sample_description_index;
+  guint32 default_sample_duration;
+  guint32 default_sample_size;
+  guint32 default_sample_flags;
+} GstTrexBox;
+
+/* A sample of a track fragment, with all defaults from tfhd and trex
+ * resolved. The offset is absolute in the same reference as the moof offset
+ * given to gst_isoff_moof_box_get_samples(), the times are in the track
+ * timescale */
+typedef struct _GstIsoffSample
+{
+  guint64 offset;
+  guint32 size;
+  guint32 duration;
+  guint32 flags;
+  gint32 composition_time_offset;
+
+  guint64 decode_time;
+} GstIsoffSample;
+
+#define GST_ISOFF_SAMPLE_IS_SYNC(sample) \
+  (!GST_ISOFF_SAMPLE_FLAGS_SAMPLE_IS_NON_SYNC_SAMPLE ((sample)->flags) || \
+   GST_ISOFF_SAMPLE_FLAGS_SAMPLE_DEPENDS_ON ((sample)->flags) == 2)
+
+GST_ISOFF_API
+GArray * gst_isoff_moof_box_get_samples (GstMoofBox *moof, guint64 moof_offset, guint32 track_id, const GstTrexBox * trex);
+
 typedef struct _GstTkhdBox
 {
   guint32 track_id;
@@ -207,10 +255,46 @@ typedef struct _GstHdlrBox
   guint32 handler_type;
 } GstHdlrBox;
 
+typedef struct _GstStsdEntry
+{
+  guint32 fourcc;
+
+  /* visual sample entries */
+  guint16 width;
+  guint16 height;
+
+  /* audio sample entries */
+  guint16 channel_count;
+  guint32 sample_rate;
+
+  /* contents of the avcC or hvcC box, or the decoder specific info of the
+   * esds box */
+  guint32 codec_data_fourcc;
+  GstBuffer *codec_data;
+  /* from the esds box */
+  guint8 object_type_indication;
+} GstStsdEntry;
+
+typedef struct _GstStsdBox
+{
+  GArray *entries;
+} GstStsdBox;
+
+typedef struct _GstStblBox
+{
+  GstStsdBox stsd;
+} GstStblBox;
+
+typedef struct _GstMinfBox
+{
+  GstStblBox stbl;
+} GstMinfBox;
+
 typedef struct _GstMdiaBox
 {
   GstMdhdBox mdhd;
   GstHdlrBox hdlr;
+  GstMinfBox minf;
 } GstMdiaBox;
 
 typedef struct _GstTrakBox
@@ -222,6 +306,7 @@ typedef struct _GstTrakBox
 typedef struct _GstMoovBox
 {
   GArray *trak;
+  GArray *trex;
 } GstMoovBox;
 
 GST_ISOFF_API
@@ -0,0 +1,287 @@
+/*
+ * gstmpegtscrc.c - CRC-32 of MPEG-TS sections
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * The CRC of the sections is CRC-32/MPEG-2: polynomial 0x04c11db7 processed
+ * most significant bit first, initial value 0xffffffff and no final xor.
+ *
+ * Buffers of at least 64 bytes are folded 64 bytes at a time with carry-less
+ * multiplications, the rest is done with a slicing-by-8 table
+ * implementation.  On x86 the PCLMULQDQ code is always built with GCC and
+ * clang and used if the CPU has it, on ARMv8 PMULL is used when the
+ * compiler targets the crypto extension.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mpegts.h"
+#include "gstmpegts-private.h"
+
+#if defined(__PCLMUL__) && defined(__SSE4_1__)
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#define HAVE_CRC32_CLMUL 1
+#define HAVE_CRC32_CLMUL_X86 1
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || \
+    (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+/* the compiler doesn't target PCLMULQDQ, check for it at runtime */
+#include <cpuid.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#define HAVE_CRC32_CLMUL 1
+#define HAVE_CRC32_CLMUL_X86 1
+#define HAVE_CRC32_CLMUL_RUNTIME 1
+#define CRC32_CLMUL_TARGET __attribute__ ((target ("pclmul,sse4.1")))
+#elif defined(__ARM_FEATURE_CRYPTO) && defined(__aarch64__)
+#include <arm_neon.h>
+#define HAVE_CRC32_CLMUL 1
+#endif
+
+#ifndef CRC32_CLMUL_TARGET
+#define CRC32_CLMUL_TARGET
+#endif
+
+#define CRC32_POLY 0x04c11db7
+
+static guint32 crc_tab[8][256];
+
+#if defined(HAVE_CRC32_CLMUL_RUNTIME)
+static gboolean have_clmul;
+#elif defined(HAVE_CRC32_CLMUL)
+#define have_clmul TRUE
+#endif
+
+#if defined(HAVE_CRC32_CLMUL)
+/* x^(D+64) mod P and x^D mod P, to fold 128 bits D bits forward */
+static guint32 fold_512[2];
+static guint32 fold_128[2];
+
+static guint32
+xn_mod_p (guint n)
+{
+  guint32 r = 1;
+
+  while (n--)
+    r = (r << 1) ^ (r & 0x80000000 ? CRC32_POLY : 0);
+
+  return r;
+}
+#endif
+
+static void
+crc_init (void)
+{
+  static gsize init = 0;
+
+  if (g_once_init_enter (&init)) {
+    guint32 c;
+    gint i, j;
+
+    for (i = 0; i < 256; i++) {
+      c = (guint32) i << 24;
+      for (j = 0; j < 8; j++)
+        c = (c << 1) ^ (c & 0x80000000 ? CRC32_POLY : 0);
+      crc_tab[0][i] = c;
+    }
+    /* crc_tab[j][i] is the CRC of i followed by j zero bytes */
+    for (i = 0; i < 256; i++) {
+      c = crc_tab[0][i];
+      for (j = 1; j < 8; j++) {
+        c = (c << 8) ^ crc_tab[0][c >> 24];
+        crc_tab[j][i] = c;
+      }
+    }
+
+#if defined(HAVE_CRC32_CLMUL)
+    fold_512[0] = xn_mod_p (512 + 64);
+    fold_512[1] = xn_mod_p (512);
+    fold_128[0] = xn_mod_p (128 + 64);
+    fold_128[1] = xn_mod_p (128);
+#endif
+
+#if defined(HAVE_CRC32_CLMUL_RUNTIME)
+    {
+      guint eax, ebx, ecx, edx;
+
+      /* PCLMULQDQ is bit 1 of ECX and SSE4.1 bit 19 */
+      have_clmul = __get_cpuid (1, &eax, &ebx, &ecx, &edx)
+          && (ecx & (1 << 1)) && (ecx & (1 << 19));
+    }
+#endif
+
+    g_once_init_leave (&init, 1);
+  }
+}
+
+/* slicing-by-8 */
+static guint32
+crc32_update_table (guint32 crc, const guint8 * p, gsize len)
+{
+  guint32 hi, lo;
+
+  for (; len >= 8; len -= 8, p += 8) {
+    hi = crc ^ GST_READ_UINT32_BE (p);
+    lo = GST_READ_UINT32_BE (p + 4);
+    crc = crc_tab[7][hi >> 24] ^ crc_tab[6][(hi >> 16) & 0xff] ^
+        crc_tab[5][(hi >> 8) & 0xff] ^ crc_tab[4][hi & 0xff] ^
+        crc_tab[3][lo >> 24] ^ crc_tab[2][(lo >> 16) & 0xff] ^
+        crc_tab[1][(lo >> 8) & 0xff] ^ crc_tab[0][lo & 0xff];
+  }
+  for (; len; len--)
+    crc = (crc << 8) ^ crc_tab[0][(crc >> 24) ^ *p++];
+
+  return crc;
+}
+
+#if defined(HAVE_CRC32_CLMUL)
+/* The 128 bit registers hold 16 bytes of data with the first byte in the
+ * most significant position, so bit n is the coefficient of x^n */
+#if defined(HAVE_CRC32_CLMUL_X86)
+typedef __m128i crc_vec;
+
+static inline CRC32_CLMUL_TARGET crc_vec
+vec_load (const guint8 * p)
+{
+  return _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) p),
+      _mm_set_epi8 (0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+static inline CRC32_CLMUL_TARGET void
+vec_store (guint8 * p, crc_vec v)
+{
+  _mm_storeu_si128 ((__m128i *) p, _mm_shuffle_epi8 (v,
+          _mm_set_epi8 (0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+              15)));
+}
+
+static inline CRC32_CLMUL_TARGET crc_vec
+vec_xor_crc (crc_vec v, guint32 crc)
+{
+  return _mm_xor_si128 (v, _mm_set_epi32 (crc, 0, 0, 0));
+}
+
+/* next + v * x^D, kept to 128 bits modulo P */
+static inline CRC32_CLMUL_TARGET crc_vec
+vec_fold (crc_vec v, const guint32 * k, crc_vec next)
+{
+  crc_vec kv = _mm_set_epi32 (0, k[0], 0, k[1]);
+
+  return _mm_xor_si128 (next, _mm_xor_si128 (_mm_clmulepi64_si128 (v, kv,
+              0x11), _mm_clmulepi64_si128 (v, kv, 0x00)));
+}
+#else
+typedef uint64x2_t crc_vec;
+
+static inline crc_vec
+vec_load (const guint8 * p)
+{
+  uint8x16_t v = vrev64q_u8 (vld1q_u8 (p));
+
+  return vreinterpretq_u64_u8 (vextq_u8 (v, v, 8));
+}
+
+static inline void
+vec_store (guint8 * p, crc_vec v)
+{
+  uint8x16_t b = vrev64q_u8 (vreinterpretq_u8_u64 (v));
+
+  vst1q_u8 (p, vextq_u8 (b, b, 8));
+}
+
+static inline crc_vec
+vec_xor_crc (crc_vec v, guint32 crc)
+{
+  return veorq_u64 (v, vsetq_lane_u64 ((guint64) crc << 32, vdupq_n_u64 (0),
+          1));
+}
+
+/* next + v * x^D, kept to 128 bits modulo P */
+static inline crc_vec
+vec_fold (crc_vec v, const guint32 * k, crc_vec next)
+{
+  poly128_t h = vmull_p64 (vgetq_lane_u64 (v, 1), k[0]);
+  poly128_t l = vmull_p64 (vgetq_lane_u64 (v, 0), k[1]);
+
+  return veorq_u64 (next, veorq_u64 (vreinterpretq_u64_p128 (h),
+          vreinterpretq_u64_p128 (l)));
+}
+#endif
+
+/* Keeps 128 bit remainders of the data congruent to it modulo P, and
+ * leaves the final reduction of the last one to the table code */
+static CRC32_CLMUL_TARGET guint32
+crc32_update_clmul (guint32 crc, const guint8 * p, gsize len)
+{
+  crc_vec v0, v1, v2, v3;
+  guint8 rem[16];
+
+  v0 = vec_xor_crc (vec_load (p), crc);
+  v1 = vec_load (p + 16);
+  v2 = vec_load (p + 32);
+  v3 = vec_load (p + 48);
+  p += 64;
+  len -= 64;
+
+  for (; len >= 64; len -= 64, p += 64) {
+    v0 = vec_fold (v0, fold_512, vec_load (p));
+    v1 = vec_fold (v1, fold_512, vec_load (p + 16));
+    v2 = vec_fold (v2, fold_512, vec_load (p + 32));
+    v3 = vec_fold (v3, fold_512, vec_load (p + 48));
+  }
+
+  v1 = vec_fold (v0, fold_128, v1);
+  v2 = vec_fold (v1, fold_128, v2);
+  v3 = vec_fold (v2, fold_128, v3);
+
+  for (; len >= 16; len -= 16, p += 16)
+    v3 = vec_fold (v3, fold_128, vec_load (p));
+
+  vec_store (rem, v3);
+  crc = crc32_update_table (0, rem, 16);
+
+  return crc32_update_table (crc, p, len);
+}
+#endif
+
+/**
+ * gst_mpegts_calc_crc32:
+ * @data: (array length=length): the data
+ * @length: the size of @data
+ *
+ * Computes the CRC-32 used by the MPEG-TS sections (ITU H.222.0 Annex A)
+ * over @data. The CRC of a complete section, including its trailing CRC_32
+ * field, is 0.
+ *
+ * Returns: the CRC of @data
+ */
+guint32
+gst_mpegts_calc_crc32 (const guint8 * data, gsize length)
+{
+  crc_init ();
+
+#if defined(HAVE_CRC32_CLMUL)
+  if (length >= 64 && have_clmul)
+    return crc32_update_clmul (0xffffffff, data, length);
+#endif
+
+  return crc32_update_table (0xffffffff, data, length);
+}
@@ -180,6 +180,9 @@ struct _GstMpegtsSection
 GST_MPEGTS_API
 GBytes *gst_mpegts_section_get_data (GstMpegtsSection *section);
 
+GST_MPEGTS_API
+guint32 gst_mpegts_calc_crc32 (const guint8 *data, gsize length);
+
 /* PAT */
 #define GST_TYPE_MPEGTS_PAT_PROGRAM (gst_mpegts_pat_program_get_type())
 
@@ -67,6 +67,9 @@ GST_DEBUG_CATEGORY_STATIC (gst_player_debug);
 #define DEFAULT_RATE 1.0
 #define DEFAULT_POSITION_UPDATE_INTERVAL_MS 100
 #define DEFAULT_AUDIO_VIDEO_OFFSET 0
+#define DEFAULT_TIME_TO_FIRST_FRAME GST_CLOCK_TIME_NONE
+#define DEFAULT_MAX_STANDBY 2
+#define DEFAULT_STANDBY_BUFFER_SIZE 0
 
 GQuark
 gst_player_error_quark (void)
@@ -82,6 +85,8 @@ typedef enum
   CONFIG_QUARK_USER_AGENT = 0,
   CONFIG_QUARK_POSITION_INTERVAL_UPDATE,
   CONFIG_QUARK_ACCURATE_SEEK,
+  CONFIG_QUARK_MAX_STANDBY,
+  CONFIG_QUARK_STANDBY_BUFFER_SIZE,
 
   CONFIG_QUARK_MAX
 } ConfigQuarkId;
@@ -90,6 +95,8 @@ static const gchar *_config_quark_strings[] = {
   "user-agent",
   "position-interval-update",
   "accurate-seek",
+  "max-standby",
+  "standby-buffer-size",
 };
 
 GQuark _config_quark_table[CONFIG_QUARK_MAX];
@@ -116,6 +123,7 @@ enum
   PROP_VIDEO_MULTIVIEW_MODE,
   PROP_VIDEO_MULTIVIEW_FLAGS,
   PROP_AUDIO_VIDEO_OFFSET,
+  PROP_TIME_TO_FIRST_FRAME,
   PROP_LAST
 };
 
@@ -134,6 +142,7 @@ enum
   SIGNAL_VOLUME_CHANGED,
   SIGNAL_MUTE_CHANGED,
   SIGNAL_SEEK_DONE,
+  SIGNAL_STANDBY_READY,
   SIGNAL_LAST
 };
 
@@ -145,6 +154,45 @@ enum
   GST_PLAY_FLAG_VIS = (1 << 3)
 };
 
+/* A pipeline pre-rolled for a URI that might be played next */
+typedef struct
+{
+  GstPlayer *player;
+  gchar *uri;
+
+  GstElement *playbin;
+  GSource *bus_source;
+
+  GstState state;
+  gboolean failed;
+  gboolean is_live;
+  gint buffering;
+  guint buffer_size;
+
+  /* messages replayed on the player bus when switching to this pipeline */
+  GQueue messages;
+
+  /* Protected by lock, keyframe gates of the decoders of a live pipeline */
+  GMutex lock;
+  GList *gates;
+} GstPlayerStandby;
+
+/* Holds back the buffers of a decoder of a live standby pipeline, from the
+ * latest keyframe on, until the pipeline is switched to */
+typedef struct
+{
+  volatile gint refcount;
+  volatile gint released;
+
+  /* Only used from the streaming thread */
+  gboolean passing;
+  gboolean headers_done;
+  GQueue headers;
+  GQueue buffers;
+  gsize size;
+  gsize max_size;
+} GstPlayerKeyframeGate;
+
 struct _GstPlayer
 {
   GstObject parent;
@@ -162,8 +210,11 @@ struct _GstPlayer
   GMainContext *context;
   GMainLoop *loop;
 
+  /* Only replaced from main context, with the object lock. Other threads
+   * use it through gst_player_ref_playbin() */
   GstElement *playbin;
   GstBus *bus;
+  GSource *bus_source;
   GstState target_state, current_state;
   gboolean is_live, is_eos;
   GSource *tick_source, *ready_timeout_source;
@@ -191,6 +242,14 @@ struct _GstPlayer
    * is emitted after gst_player_stop/pause() has been called by the user. */
   gboolean inhibit_sigs;
 
+  /* Protected by the object lock, the sinks' streaming threads set them */
+  GstClockTime uri_change_time; /* Only set from main context */
+  GstClockTime time_to_first_frame;
+  volatile gint first_frame_pending;
+
+  /* Only used from main context, oldest first */
+  GList *standbys;
+
   /* For playbin3 */
   gboolean use_playbin3;
   GstStreamCollection *collection;
@@ -271,6 +330,26 @@ static void *get_cover_sample (GstTagList * tags);
 
 static void remove_seek_source (GstPlayer * self);
 
+static void gst_player_standby_free (GstPlayerStandby * standby);
+static GstPlayerStandby *gst_player_take_standby (GstPlayer * self,
+    const gchar * uri);
+static void gst_player_switch_to_standby (GstPlayer * self,
+    GstPlayerStandby * standby);
+
+/* Returns a reference to the current pipeline, which the main context
+ * replaces when switching to a standby pipeline */
+static GstElement *
+gst_player_ref_playbin (GstPlayer * self)
+{
+  GstElement *playbin;
+
+  GST_OBJECT_LOCK (self);
+  playbin = gst_object_ref (self->playbin);
+  GST_OBJECT_UNLOCK (self);
+
+  return playbin;
+}
+
 static void
 gst_player_init (GstPlayer * self)
 {
@@ -288,6 +367,8 @@ gst_player_init (GstPlayer * self)
   self->config = gst_structure_new_id (QUARK_CONFIG,
       CONFIG_QUARK (POSITION_INTERVAL_UPDATE), G_TYPE_UINT, DEFAULT_POSITION_UPDATE_INTERVAL_MS,
       CONFIG_QUARK (ACCURATE_SEEK), G_TYPE_BOOLEAN, FALSE,
+      CONFIG_QUARK (MAX_STANDBY), G_TYPE_UINT, DEFAULT_MAX_STANDBY,
+      CONFIG_QUARK (STANDBY_BUFFER_SIZE), G_TYPE_UINT, DEFAULT_STANDBY_BUFFER_SIZE,
       NULL);
   /* *INDENT-ON* */
 
@@ -295,6 +376,8 @@ gst_player_init (GstPlayer * self)
   self->seek_position = GST_CLOCK_TIME_NONE;
   self->last_seek_time = GST_CLOCK_TIME_NONE;
   self->inhibit_sigs = FALSE;
+  self->uri_change_time = GST_CLOCK_TIME_NONE;
+  self->time_to_first_frame = DEFAULT_TIME_TO_FIRST_FRAME;
 
   GST_TRACE_OBJECT (self, "Initialized");
 }
@@ -412,6 +495,12 @@ gst_player_class_init (GstPlayerClass * klass)
       "The synchronisation offset between audio and video in nanoseconds",
       G_MININT64, G_MAXINT64, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  param_specs[PROP_TIME_TO_FIRST_FRAME] =
+      g_param_spec_uint64 ("time-to-first-frame", "Time to first frame",
+      "Time from the last URI change until the first frame reached the sinks",
+      0, G_MAXUINT64, DEFAULT_TIME_TO_FIRST_FRAME,
+      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, param_specs);
 
   signals[SIGNAL_URI_LOADED] =
@@ -479,6 +568,11 @@ gst_player_class_init (GstPlayerClass * klass)
       G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS, 0, NULL,
       NULL, NULL, G_TYPE_NONE, 1, GST_TYPE_CLOCK_TIME);
 
+  signals[SIGNAL_STANDBY_READY] =
+      g_signal_new ("standby-ready", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS, 0, NULL,
+      NULL, NULL, G_TYPE_NONE, 1, G_TYPE_STRING);
+
   config_quark_initialize ();
 }
 
@@ -578,6 +672,7 @@ static gboolean
 gst_player_set_uri_internal (gpointer user_data)
 {
   GstPlayer *self = user_data;
+  GstPlayerStandby *standby;
 
   gst_player_stop_internal (self, FALSE);
 
@@ -585,7 +680,14 @@ gst_player_set_uri_internal (gpointer user_data)
 
   GST_DEBUG_OBJECT (self, "Changing URI to '%s'", GST_STR_NULL (self->uri));
 
-  g_object_set (self->playbin, "uri", self->uri, NULL);
+  GST_OBJECT_LOCK (self);
+  self->uri_change_time = gst_util_get_timestamp ();
+  g_atomic_int_set (&self->first_frame_pending, TRUE);
+  GST_OBJECT_UNLOCK (self);
+
+  standby = gst_player_take_standby (self, self->uri);
+  if (!standby)
+    g_object_set (self->playbin, "uri", self->uri, NULL);
 
   if (g_signal_handler_find (self, G_SIGNAL_MATCH_ID,
           signals[SIGNAL_URI_LOADED], 0, NULL, NULL, NULL) != 0) {
@@ -602,6 +704,9 @@ gst_player_set_uri_internal (gpointer user_data)
 
   g_mutex_unlock (&self->lock);
 
+  if (standby)
+    gst_player_switch_to_standby (self, standby);
+
   return G_SOURCE_REMOVE;
 }
 
@@ -664,6 +769,7 @@ gst_player_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
   GstPlayer *self = GST_PLAYER (object);
+  GstElement *playbin;
 
   switch (prop_id) {
     case PROP_VIDEO_RENDERER:
@@ -703,7 +809,9 @@ gst_player_set_property (GObject * object, guint prop_id,
     }
     case PROP_VOLUME:
       GST_DEBUG_OBJECT (self, "Set volume=%lf", g_value_get_double (value));
-      g_object_set_property (G_OBJECT (self->playbin), "volume", value);
+      playbin = gst_player_ref_playbin (self);
+      g_object_set_property (G_OBJECT (playbin), "volume", value);
+      gst_object_unref (playbin);
       break;
     case PROP_RATE:
       g_mutex_lock (&self->lock);
@@ -714,22 +822,29 @@ gst_player_set_property (GObject * object, guint prop_id,
       break;
     case PROP_MUTE:
       GST_DEBUG_OBJECT (self, "Set mute=%d", g_value_get_boolean (value));
-      g_object_set_property (G_OBJECT (self->playbin), "mute", value);
+      playbin = gst_player_ref_playbin (self);
+      g_object_set_property (G_OBJECT (playbin), "mute", value);
+      gst_object_unref (playbin);
       break;
     case PROP_VIDEO_MULTIVIEW_MODE:
       GST_DEBUG_OBJECT (self, "Set multiview mode=%u",
           g_value_get_enum (value));
-      g_object_set_property (G_OBJECT (self->playbin), "video-multiview-mode",
-          value);
+      playbin = gst_player_ref_playbin (self);
+      g_object_set_property (G_OBJECT (playbin), "video-multiview-mode", value);
+      gst_object_unref (playbin);
       break;
     case PROP_VIDEO_MULTIVIEW_FLAGS:
       GST_DEBUG_OBJECT (self, "Set multiview flags=%x",
           g_value_get_flags (value));
-      g_object_set_property (G_OBJECT (self->playbin), "video-multiview-flags",
+      playbin = gst_player_ref_playbin (self);
+      g_object_set_property (G_OBJECT (playbin), "video-multiview-flags",
           value);
+      gst_object_unref (playbin);
       break;
     case PROP_AUDIO_VIDEO_OFFSET:
-      g_object_set_property (G_OBJECT (self->playbin), "av-offset", value);
+      playbin = gst_player_ref_playbin (self);
+      g_object_set_property (G_OBJECT (playbin), "av-offset", value);
+      gst_object_unref (playbin);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -742,6 +857,7 @@ gst_player_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
 {
   GstPlayer *self = GST_PLAYER (object);
+  GstElement *playbin;
 
   switch (prop_id) {
     case PROP_URI:
@@ -759,7 +875,9 @@ gst_player_get_property (GObject * object, guint prop_id,
     case PROP_POSITION:{
       gint64 position = 0;
 
-      gst_element_query_position (self->playbin, GST_FORMAT_TIME, &position);
+      playbin = gst_player_ref_playbin (self);
+      gst_element_query_position (playbin, GST_FORMAT_TIME, &position);
+      gst_object_unref (playbin);
       g_value_set_uint64 (value, position);
       GST_TRACE_OBJECT (self, "Returning position=%" GST_TIME_FORMAT,
           GST_TIME_ARGS (g_value_get_uint64 (value)));
@@ -795,7 +913,9 @@ gst_player_get_property (GObject * object, guint prop_id,
       break;
     }
     case PROP_VOLUME:
-      g_object_get_property (G_OBJECT (self->playbin), "volume", value);
+      playbin = gst_player_ref_playbin (self);
+      g_object_get_property (G_OBJECT (playbin), "volume", value);
+      gst_object_unref (playbin);
       GST_TRACE_OBJECT (self, "Returning volume=%lf",
           g_value_get_double (value));
       break;
@@ -805,28 +925,40 @@ gst_player_get_property (GObject * object, guint prop_id,
       g_mutex_unlock (&self->lock);
       break;
     case PROP_MUTE:
-      g_object_get_property (G_OBJECT (self->playbin), "mute", value);
+      playbin = gst_player_ref_playbin (self);
+      g_object_get_property (G_OBJECT (playbin), "mute", value);
+      gst_object_unref (playbin);
       GST_TRACE_OBJECT (self, "Returning mute=%d", g_value_get_boolean (value));
       break;
     case PROP_PIPELINE:
-      g_value_set_object (value, self->playbin);
+      g_value_take_object (value, gst_player_ref_playbin (self));
       break;
     case PROP_VIDEO_MULTIVIEW_MODE:{
-      g_object_get_property (G_OBJECT (self->playbin), "video-multiview-mode",
-          value);
+      playbin = gst_player_ref_playbin (self);
+      g_object_get_property (G_OBJECT (playbin), "video-multiview-mode", value);
+      gst_object_unref (playbin);
       GST_TRACE_OBJECT (self, "Return multiview mode=%d",
           g_value_get_enum (value));
       break;
     }
     case PROP_VIDEO_MULTIVIEW_FLAGS:{
-      g_object_get_property (G_OBJECT (self->playbin), "video-multiview-flags",
+      playbin = gst_player_ref_playbin (self);
+      g_object_get_property (G_OBJECT (playbin), "video-multiview-flags",
           value);
+      gst_object_unref (playbin);
       GST_TRACE_OBJECT (self, "Return multiview flags=%x",
           g_value_get_flags (value));
       break;
     }
     case PROP_AUDIO_VIDEO_OFFSET:
-      g_object_get_property (G_OBJECT (self->playbin), "av-offset", value);
+      playbin = gst_player_ref_playbin (self);
+      g_object_get_property (G_OBJECT (playbin), "av-offset", value);
+      gst_object_unref (playbin);
+      break;
+    case PROP_TIME_TO_FIRST_FRAME:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->time_to_first_frame);
+      GST_OBJECT_UNLOCK (self);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1951,11 +2083,13 @@ streams_selected_cb (G_GNUC_UNUSED GstBus * bus, GstMessage * msg,
 static void
 player_set_flag (GstPlayer * self, gint pos)
 {
+  GstElement *playbin = gst_player_ref_playbin (self);
   gint flags;
 
-  g_object_get (self->playbin, "flags", &flags, NULL);
+  g_object_get (playbin, "flags", &flags, NULL);
   flags |= pos;
-  g_object_set (self->playbin, "flags", flags, NULL);
+  g_object_set (playbin, "flags", flags, NULL);
+  gst_object_unref (playbin);
 
   GST_DEBUG_OBJECT (self, "setting flags=%#x", flags);
 }
@@ -1963,11 +2097,13 @@ player_set_flag (GstPlayer * self, gint pos)
 static void
 player_clear_flag (GstPlayer * self, gint pos)
 {
+  GstElement *playbin = gst_player_ref_playbin (self);
   gint flags;
 
-  g_object_get (self->playbin, "flags", &flags, NULL);
+  g_object_get (playbin, "flags", &flags, NULL);
   flags &= ~pos;
-  g_object_set (self->playbin, "flags", flags, NULL);
+  g_object_set (playbin, "flags", flags, NULL);
+  gst_object_unref (playbin);
 
   GST_DEBUG_OBJECT (self, "setting flags=%#x", flags);
 }
@@ -2298,9 +2434,11 @@ gst_player_stream_info_find_from_stream_id (GstPlayerMediaInfo * media_info,
 static gboolean
 is_track_enabled (GstPlayer * self, gint pos)
 {
+  GstElement *playbin = gst_player_ref_playbin (self);
   gint flags;
 
-  g_object_get (G_OBJECT (self->playbin), "flags", &flags, NULL);
+  g_object_get (G_OBJECT (playbin), "flags", &flags, NULL);
+  gst_object_unref (playbin);
 
   if ((flags & pos))
     return TRUE;
@@ -2312,13 +2450,16 @@ static GstPlayerStreamInfo *
 gst_player_stream_info_get_current (GstPlayer * self, const gchar * prop,
     GType type)
 {
+  GstElement *playbin;
   gint current;
   GstPlayerStreamInfo *info;
 
   if (!self->media_info)
     return NULL;
 
-  g_object_get (G_OBJECT (self->playbin), prop, &current, NULL);
+  playbin = gst_player_ref_playbin (self);
+  g_object_get (G_OBJECT (playbin), prop, &current, NULL);
+  gst_object_unref (playbin);
   g_mutex_lock (&self->lock);
   info = gst_player_stream_info_find (self->media_info, type, current);
   if (info)
@@ -2852,58 +2993,262 @@ source_setup_cb (GstElement * playbin, GstElement * source, GstPlayer * self)
   }
 }
 
-static gpointer
-gst_player_main (gpointer data)
+/* Copies the properties that were changed from their default on @sink to a
+ * new element of the same factory, so that a pipeline that is switched to
+ * uses the same kind of sinks as the previous one */
+static GstElement *
+clone_sink (GstElement * sink)
+{
+  GstElement *clone = NULL;
+  GstElementFactory *factory;
+  GParamSpec **pspecs;
+  guint i, n_pspecs;
+
+  factory = gst_element_get_factory (sink);
+  if (factory)
+    clone = gst_element_factory_create (factory, NULL);
+
+  if (clone) {
+    pspecs =
+        g_object_class_list_properties (G_OBJECT_GET_CLASS (sink), &n_pspecs);
+    for (i = 0; i < n_pspecs; i++) {
+      GParamSpec *pspec = pspecs[i];
+      GValue value = G_VALUE_INIT;
+
+      if ((pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE
+          || (pspec->flags & G_PARAM_CONSTRUCT_ONLY)
+          || pspec->owner_type == GST_TYPE_OBJECT)
+        continue;
+
+      g_value_init (&value, pspec->value_type);
+      g_object_get_property (G_OBJECT (sink), pspec->name, &value);
+      if (!g_param_value_defaults (pspec, &value))
+        g_object_set_property (G_OBJECT (clone), pspec->name, &value);
+      g_value_unset (&value);
+    }
+    g_free (pspecs);
+  }
+
+  return clone;
+}
+
+#define STANDBY_SINK_KEY "gst-player-standby-sink"
+
+/* Standby pipelines render into a fakesink in a bin that is set as their
+ * audio and video sink, so that they don't open any device. The sink of the
+ * player is stored on the bin when switching to the pipeline and replaces
+ * the fakesink at the next buffer */
+static GstElement *
+standby_sink_new (void)
 {
-  GstPlayer *self = GST_PLAYER (data);
-  GstBus *bus;
-  GSource *source;
-  GSource *bus_source;
-  GstElement *scaletempo;
-  const gchar *env;
+  GstElement *bin, *fakesink;
+  GstPad *pad;
 
-  GST_TRACE_OBJECT (self, "Starting main thread");
+  bin = gst_bin_new (NULL);
+  fakesink = gst_element_factory_make ("fakesink", NULL);
+  gst_bin_add (GST_BIN (bin), fakesink);
 
-  g_main_context_push_thread_default (self->context);
+  pad = gst_element_get_static_pad (fakesink, "sink");
+  gst_element_add_pad (bin, gst_ghost_pad_new ("sink", pad));
+  gst_object_unref (pad);
 
-  source = g_idle_source_new ();
-  g_source_set_callback (source, (GSourceFunc) main_loop_running_cb, self,
-      NULL);
-  g_source_attach (source, self->context);
-  g_source_unref (source);
+  return bin;
+}
 
-  env = g_getenv ("GST_PLAYER_USE_PLAYBIN3");
-  if (env && g_str_has_prefix (env, "1"))
-    self->use_playbin3 = TRUE;
+/* Returns the sink set as @prop on @playbin, or the one that is used instead
+ * of the fakesink if @playbin was a standby pipeline */
+static GstElement *
+get_sink (GstElement * playbin, const gchar * prop)
+{
+  GstElement *sink = NULL, *standby_sink;
 
-  if (self->use_playbin3) {
-    GST_DEBUG_OBJECT (self, "playbin3 enabled");
-    self->playbin = gst_element_factory_make ("playbin3", "playbin3");
-  } else
-    self->playbin = gst_element_factory_make ("playbin", "playbin");
+  g_object_get (playbin, prop, &sink, NULL);
+  if (sink) {
+    standby_sink = g_object_get_data (G_OBJECT (sink), STANDBY_SINK_KEY);
+    if (standby_sink)
+      gst_object_replace ((GstObject **) & sink, GST_OBJECT (standby_sink));
+  }
 
-  if (self->video_renderer) {
+  return sink;
+}
+
+static GstPadProbeReturn
+standby_sink_swap_cb (GstPad * pad, GstPadProbeInfo * info, GstElement * bin)
+{
+  GstElement *sink, *fakesink;
+  GstPad *ghostpad, *target, *sinkpad;
+  GstPadProbeReturn ret = GST_PAD_PROBE_REMOVE;
+  GstCaps *caps;
+
+  sink = g_object_get_data (G_OBJECT (bin), STANDBY_SINK_KEY);
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  if (!sinkpad) {
+    GST_WARNING_OBJECT (bin, "%" GST_PTR_FORMAT " has no sink pad", sink);
+    return GST_PAD_PROBE_REMOVE;
+  }
+
+  ghostpad = gst_element_get_static_pad (bin, "sink");
+  target = gst_ghost_pad_get_target (GST_GHOST_PAD (ghostpad));
+  fakesink = gst_pad_get_parent_element (target);
+
+  GST_DEBUG_OBJECT (bin, "Rendering to %" GST_PTR_FORMAT, sink);
+
+  gst_bin_add (GST_BIN (bin), sink);
+  gst_ghost_pad_set_target (GST_GHOST_PAD (ghostpad), sinkpad);
+  gst_element_sync_state_with_parent (sink);
+
+  gst_element_set_locked_state (fakesink, TRUE);
+  gst_element_set_state (fakesink, GST_STATE_NULL);
+  gst_bin_remove (GST_BIN (bin), fakesink);
+
+  /* The stream was negotiated with the fakesink, which accepts anything.
+   * This buffer is dropped and upstream renegotiates before the next one */
+  caps = gst_pad_get_current_caps (ghostpad);
+  if (caps && !gst_pad_query_accept_caps (sinkpad, caps)) {
+    GST_DEBUG_OBJECT (bin, "Renegotiating, %" GST_PTR_FORMAT " not accepted",
+        caps);
+    gst_pad_push_event (ghostpad, gst_event_new_reconfigure ());
+    gst_pad_remove_probe (pad, info->id);
+    ret = GST_PAD_PROBE_DROP;
+  }
+  if (caps)
+    gst_caps_unref (caps);
+
+  gst_object_unref (fakesink);
+  gst_object_unref (target);
+  gst_object_unref (ghostpad);
+  gst_object_unref (sinkpad);
+
+  return ret;
+}
+
+/* Makes the standby sink set as @prop on @playbin render to @sink from the
+ * next buffer on */
+static void
+standby_sink_promote (GstElement * playbin, const gchar * prop,
+    GstElement * sink)
+{
+  GstElement *bin = NULL;
+  GstPad *ghostpad, *pad;
+
+  g_object_get (playbin, prop, &bin, NULL);
+  g_object_set_data_full (G_OBJECT (bin), STANDBY_SINK_KEY,
+      gst_object_ref_sink (sink), gst_object_unref);
+
+  /* the pad belongs to the bin, which outlives the probe */
+  ghostpad = gst_element_get_static_pad (bin, "sink");
+  pad = GST_PAD (gst_proxy_pad_get_internal (GST_PROXY_PAD (ghostpad)));
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) standby_sink_swap_cb, bin, NULL);
+
+  gst_object_unref (pad);
+  gst_object_unref (ghostpad);
+  gst_object_unref (bin);
+}
+
+static GstPadProbeReturn
+first_frame_probe_cb (G_GNUC_UNUSED GstPad * pad,
+    G_GNUC_UNUSED GstPadProbeInfo * info, GstPlayer * self)
+{
+  GstClockTime time;
+
+  if (!g_atomic_int_compare_and_exchange (&self->first_frame_pending, TRUE,
+          FALSE))
+    return GST_PAD_PROBE_OK;
+
+  GST_OBJECT_LOCK (self);
+  time = gst_util_get_timestamp () - self->uri_change_time;
+  self->time_to_first_frame = time;
+  GST_OBJECT_UNLOCK (self);
+
+  GST_INFO_OBJECT (self, "First frame %" GST_TIME_FORMAT " after URI change",
+      GST_TIME_ARGS (time));
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Watches the first buffer that reaches a sink */
+static void
+element_setup_cb (G_GNUC_UNUSED GstElement * playbin, GstElement * element,
+    GstPlayer * self)
+{
+  const gchar *klass;
+  GstPad *pad;
+
+  klass = gst_element_class_get_metadata (GST_ELEMENT_GET_CLASS (element),
+      GST_ELEMENT_METADATA_KLASS);
+  if (!klass || !strstr (klass, "Sink"))
+    return;
+
+  pad = gst_element_get_static_pad (element, "sink");
+  if (!pad)
+    return;
+
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) first_frame_probe_cb, self, NULL);
+  gst_object_unref (pad);
+}
+
+static GstElement *
+gst_player_create_playbin (GstPlayer * self, gboolean standby)
+{
+  GstElement *playbin;
+  GstElement *scaletempo;
+
+  if (self->use_playbin3)
+    playbin = gst_element_factory_make ("playbin3", "playbin3");
+  else
+    playbin = gst_element_factory_make ("playbin", "playbin");
+
+  if (standby) {
+    g_object_set (playbin, "audio-sink", standby_sink_new (), "video-sink",
+        standby_sink_new (), NULL);
+
+    g_mutex_lock (&self->lock);
+    if (self->current_vis_element) {
+      GstElementFactory *factory;
+
+      factory = gst_element_get_factory (self->current_vis_element);
+      if (factory)
+        g_object_set (playbin, "vis-plugin",
+            gst_element_factory_create (factory, NULL), NULL);
+    }
+    g_mutex_unlock (&self->lock);
+  } else if (self->video_renderer) {
     GstElement *video_sink =
         gst_player_video_renderer_create_video_sink (self->video_renderer,
         self);
 
     if (video_sink)
-      g_object_set (self->playbin, "video-sink", video_sink, NULL);
+      g_object_set (playbin, "video-sink", video_sink, NULL);
   }
 
   scaletempo = gst_element_factory_make ("scaletempo", NULL);
   if (scaletempo) {
-    g_object_set (self->playbin, "audio-filter", scaletempo, NULL);
-  } else {
+    g_object_set (playbin, "audio-filter", scaletempo, NULL);
+  } else if (!standby) {
     g_warning ("GstPlayer: scaletempo element not available. Audio pitch "
         "will not be preserved during trick modes");
   }
 
+  g_signal_connect (playbin, "source-setup",
+      G_CALLBACK (source_setup_cb), self);
+
+  return playbin;
+}
+
+static void
+gst_player_attach_playbin (GstPlayer * self)
+{
+  GstBus *bus;
+
   self->bus = bus = gst_element_get_bus (self->playbin);
-  bus_source = gst_bus_create_watch (bus);
-  g_source_set_callback (bus_source, (GSourceFunc) gst_bus_async_signal_func,
-      NULL, NULL);
-  g_source_attach (bus_source, self->context);
+  self->bus_source = gst_bus_create_watch (bus);
+  g_source_set_callback (self->bus_source,
+      (GSourceFunc) gst_bus_async_signal_func, NULL, NULL);
+  g_source_attach (self->bus_source, self->context);
 
   g_signal_connect (G_OBJECT (bus), "message::error", G_CALLBACK (error_cb),
       self);
@@ -2951,8 +3296,53 @@ gst_player_main (gpointer data)
       G_CALLBACK (volume_notify_cb), self);
   g_signal_connect (self->playbin, "notify::mute",
       G_CALLBACK (mute_notify_cb), self);
-  g_signal_connect (self->playbin, "source-setup",
-      G_CALLBACK (source_setup_cb), self);
+  g_signal_connect (self->playbin, "element-setup",
+      G_CALLBACK (element_setup_cb), self);
+}
+
+static void
+gst_player_detach_playbin (GstPlayer * self)
+{
+  g_source_destroy (self->bus_source);
+  g_source_unref (self->bus_source);
+  self->bus_source = NULL;
+
+  g_signal_handlers_disconnect_by_data (self->bus, self);
+  g_signal_handlers_disconnect_by_data (self->playbin, self);
+  gst_object_unref (self->bus);
+  self->bus = NULL;
+}
+
+static gpointer
+gst_player_main (gpointer data)
+{
+  GstPlayer *self = GST_PLAYER (data);
+  GstElement *playbin;
+  GSource *source;
+  const gchar *env;
+
+  GST_TRACE_OBJECT (self, "Starting main thread");
+
+  g_main_context_push_thread_default (self->context);
+
+  source = g_idle_source_new ();
+  g_source_set_callback (source, (GSourceFunc) main_loop_running_cb, self,
+      NULL);
+  g_source_attach (source, self->context);
+  g_source_unref (source);
+
+  env = g_getenv ("GST_PLAYER_USE_PLAYBIN3");
+  if (env && g_str_has_prefix (env, "1"))
+    self->use_playbin3 = TRUE;
+
+  if (self->use_playbin3)
+    GST_DEBUG_OBJECT (self, "playbin3 enabled");
+
+  playbin = gst_player_create_playbin (self, FALSE);
+  GST_OBJECT_LOCK (self);
+  self->playbin = playbin;
+  GST_OBJECT_UNLOCK (self);
+  gst_player_attach_playbin (self);
 
   self->target_state = GST_STATE_NULL;
   self->current_state = GST_STATE_NULL;
@@ -2966,13 +3356,14 @@ gst_player_main (gpointer data)
   g_main_loop_run (self->loop);
   GST_TRACE_OBJECT (self, "Stopped main loop");
 
-  g_source_destroy (bus_source);
-  g_source_unref (bus_source);
-  gst_object_unref (bus);
+  gst_player_detach_playbin (self);
 
   remove_tick_source (self);
   remove_ready_timeout_source (self);
 
+  g_list_free_full (self->standbys, (GDestroyNotify) gst_player_standby_free);
+  self->standbys = NULL;
+
   g_mutex_lock (&self->lock);
   if (self->media_info) {
     g_object_unref (self->media_info);
@@ -2986,10 +3377,13 @@ gst_player_main (gpointer data)
 
   self->target_state = GST_STATE_NULL;
   self->current_state = GST_STATE_NULL;
-  if (self->playbin) {
-    gst_element_set_state (self->playbin, GST_STATE_NULL);
-    gst_object_unref (self->playbin);
-    self->playbin = NULL;
+  GST_OBJECT_LOCK (self);
+  playbin = self->playbin;
+  self->playbin = NULL;
+  GST_OBJECT_UNLOCK (self);
+  if (playbin) {
+    gst_element_set_state (playbin, GST_STATE_NULL);
+    gst_object_unref (playbin);
   }
 
   GST_TRACE_OBJECT (self, "Stopped main thread");
@@ -2997,6 +3391,519 @@ gst_player_main (gpointer data)
   return NULL;
 }
 
+static void
+standby_ready_dispatch (gpointer user_data)
+{
+  UriLoadedSignalData *data = user_data;
+
+  if (data->player->inhibit_sigs)
+    return;
+
+  g_signal_emit (data->player, signals[SIGNAL_STANDBY_READY], 0, data->uri);
+}
+
+static void
+emit_standby_ready (GstPlayer * self, const gchar * uri)
+{
+  if (g_signal_handler_find (self, G_SIGNAL_MATCH_ID,
+          signals[SIGNAL_STANDBY_READY], 0, NULL, NULL, NULL) != 0) {
+    UriLoadedSignalData *data = g_new (UriLoadedSignalData, 1);
+
+    data->player = g_object_ref (self);
+    data->uri = g_strdup (uri);
+    gst_player_signal_dispatcher_dispatch (self->signal_dispatcher, self,
+        standby_ready_dispatch, data,
+        (GDestroyNotify) uri_loaded_signal_data_free);
+  }
+}
+
+static GstPlayerKeyframeGate *
+keyframe_gate_new (gsize max_size)
+{
+  GstPlayerKeyframeGate *gate;
+
+  gate = g_new0 (GstPlayerKeyframeGate, 1);
+  gate->refcount = 1;
+  gate->max_size = max_size;
+  g_queue_init (&gate->headers);
+  g_queue_init (&gate->buffers);
+
+  return gate;
+}
+
+static GstPlayerKeyframeGate *
+keyframe_gate_ref (GstPlayerKeyframeGate * gate)
+{
+  g_atomic_int_inc (&gate->refcount);
+
+  return gate;
+}
+
+static void
+keyframe_gate_unref (GstPlayerKeyframeGate * gate)
+{
+  if (!g_atomic_int_dec_and_test (&gate->refcount))
+    return;
+
+  g_queue_foreach (&gate->headers, (GFunc) gst_mini_object_unref, NULL);
+  g_queue_clear (&gate->headers);
+  g_queue_foreach (&gate->buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_queue_clear (&gate->buffers);
+  g_free (gate);
+}
+
+static void
+keyframe_gate_flush (GstPlayerKeyframeGate * gate)
+{
+  g_queue_foreach (&gate->buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_queue_clear (&gate->buffers);
+  gate->size = 0;
+}
+
+static GstFlowReturn
+keyframe_gate_push (GstPad * pad, GQueue * queue, GstFlowReturn ret)
+{
+  GstBuffer *buffer;
+
+  while ((buffer = g_queue_pop_head (queue))) {
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_chain (pad, buffer);
+    else
+      gst_buffer_unref (buffer);
+  }
+
+  return ret;
+}
+
+static GstPadProbeReturn
+keyframe_gate_probe_cb (GstPad * pad, GstPadProbeInfo * info,
+    GstPlayerKeyframeGate * gate)
+{
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  gsize size;
+
+  if (gate->passing)
+    return GST_PAD_PROBE_OK;
+
+  if (g_atomic_int_get (&gate->released)) {
+    GstFlowReturn ret;
+
+    /* let the decoder catch up from the latest keyframe, the buffers go
+     * through this probe again */
+    GST_DEBUG_OBJECT (pad, "Releasing %u buffers",
+        g_queue_get_length (&gate->buffers));
+    gate->passing = TRUE;
+    ret = keyframe_gate_push (pad, &gate->headers, GST_FLOW_OK);
+    keyframe_gate_push (pad, &gate->buffers, ret);
+    gate->size = 0;
+
+    return GST_PAD_PROBE_REMOVE;
+  }
+
+  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_HEADER)) {
+    /* a new set of headers replaces the previous one */
+    if (gate->headers_done) {
+      g_queue_foreach (&gate->headers, (GFunc) gst_mini_object_unref, NULL);
+      g_queue_clear (&gate->headers);
+      gate->headers_done = FALSE;
+    }
+    g_queue_push_tail (&gate->headers, gst_buffer_ref (buffer));
+
+    return GST_PAD_PROBE_DROP;
+  }
+  gate->headers_done = TRUE;
+
+  if (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    keyframe_gate_flush (gate);
+  } else if (g_queue_is_empty (&gate->buffers)) {
+    /* not decodable without the keyframe before it */
+    return GST_PAD_PROBE_DROP;
+  }
+
+  size = gst_buffer_get_size (buffer);
+  if (gate->max_size > 0 && gate->size + size > gate->max_size) {
+    GST_DEBUG_OBJECT (pad, "Keyframe interval larger than %" G_GSIZE_FORMAT
+        " bytes, dropping it", gate->max_size);
+    keyframe_gate_flush (gate);
+
+    return GST_PAD_PROBE_DROP;
+  }
+
+  g_queue_push_tail (&gate->buffers, gst_buffer_ref (buffer));
+  gate->size += size;
+
+  return GST_PAD_PROBE_DROP;
+}
+
+/* Live standby pipelines keep running, their decoders only get the buffers
+ * from the latest keyframe when the pipeline is switched to */
+static void
+standby_element_setup_cb (G_GNUC_UNUSED GstElement * playbin,
+    GstElement * element, GstPlayerStandby * standby)
+{
+  GstPlayerKeyframeGate *gate;
+  const gchar *klass;
+  GstPad *pad;
+
+  if (!standby->is_live)
+    return;
+
+  klass = gst_element_class_get_metadata (GST_ELEMENT_GET_CLASS (element),
+      GST_ELEMENT_METADATA_KLASS);
+  if (!klass || !strstr (klass, "Decoder"))
+    return;
+
+  pad = gst_element_get_static_pad (element, "sink");
+  if (!pad)
+    return;
+
+  gate = keyframe_gate_new (standby->buffer_size);
+  g_mutex_lock (&standby->lock);
+  standby->gates = g_list_prepend (standby->gates, keyframe_gate_ref (gate));
+  g_mutex_unlock (&standby->lock);
+
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) keyframe_gate_probe_cb, gate,
+      (GDestroyNotify) keyframe_gate_unref);
+  gst_object_unref (pad);
+}
+
+static gboolean
+standby_bus_cb (G_GNUC_UNUSED GstBus * bus, GstMessage * msg,
+    gpointer user_data)
+{
+  GstPlayerStandby *standby = user_data;
+  GstPlayer *self = standby->player;
+
+  switch (GST_MESSAGE_TYPE (msg)) {
+    case GST_MESSAGE_ERROR:{
+      GError *err = NULL;
+
+      gst_message_parse_error (msg, &err, NULL);
+      GST_WARNING_OBJECT (self, "Standby pipeline for '%s' failed: %s",
+          standby->uri, err->message);
+      g_clear_error (&err);
+
+      /* it is dropped when it would be used */
+      standby->failed = TRUE;
+      gst_element_set_state (standby->playbin, GST_STATE_NULL);
+      return G_SOURCE_REMOVE;
+    }
+    case GST_MESSAGE_STATE_CHANGED:{
+      GstState old_state, new_state, pending_state;
+
+      if (GST_MESSAGE_SRC (msg) != GST_OBJECT (standby->playbin))
+        break;
+
+      gst_message_parse_state_changed (msg, &old_state, &new_state,
+          &pending_state);
+      standby->state = new_state;
+
+      if (old_state == GST_STATE_READY && new_state == GST_STATE_PAUSED
+          && pending_state == GST_STATE_VOID_PENDING) {
+        GST_DEBUG_OBJECT (self, "Standby pipeline for '%s' pre-rolled",
+            standby->uri);
+        g_queue_push_tail (&standby->messages, gst_message_ref (msg));
+        emit_standby_ready (self, standby->uri);
+      }
+      break;
+    }
+    case GST_MESSAGE_BUFFERING:
+      gst_message_parse_buffering (msg, &standby->buffering);
+      break;
+    case GST_MESSAGE_TAG:{
+      GstTagList *tags = NULL;
+
+      gst_message_parse_tag (msg, &tags);
+      if (gst_tag_list_get_scope (tags) == GST_TAG_SCOPE_GLOBAL)
+        g_queue_push_tail (&standby->messages, gst_message_ref (msg));
+      gst_tag_list_unref (tags);
+      break;
+    }
+    case GST_MESSAGE_STREAM_COLLECTION:
+    case GST_MESSAGE_STREAMS_SELECTED:
+      g_queue_push_tail (&standby->messages, gst_message_ref (msg));
+      break;
+    case GST_MESSAGE_LATENCY:
+      gst_bin_recalculate_latency (GST_BIN (standby->playbin));
+      break;
+    default:
+      break;
+  }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GstPlayerStandby *
+gst_player_standby_new (GstPlayer * self, const gchar * uri,
+    guint buffer_size)
+{
+  GstPlayerStandby *standby;
+  GstStateChangeReturn state_ret;
+  GstBus *bus;
+
+  standby = g_new0 (GstPlayerStandby, 1);
+  standby->player = self;
+  standby->uri = g_strdup (uri);
+  standby->state = GST_STATE_NULL;
+  standby->buffering = 100;
+  standby->buffer_size = buffer_size;
+  g_queue_init (&standby->messages);
+  g_mutex_init (&standby->lock);
+
+  standby->playbin = gst_player_create_playbin (self, TRUE);
+  g_signal_connect (standby->playbin, "element-setup",
+      G_CALLBACK (standby_element_setup_cb), standby);
+  g_object_set (standby->playbin, "uri", uri, NULL);
+  if (buffer_size > 0)
+    g_object_set (standby->playbin, "buffer-size",
+        (gint) MIN (buffer_size, G_MAXINT), NULL);
+
+  bus = gst_element_get_bus (standby->playbin);
+  standby->bus_source = gst_bus_create_watch (bus);
+  g_source_set_callback (standby->bus_source, (GSourceFunc) standby_bus_cb,
+      standby, NULL);
+  g_source_attach (standby->bus_source, self->context);
+  gst_object_unref (bus);
+
+  GST_DEBUG_OBJECT (self, "Pre-rolling '%s' in standby", uri);
+
+  state_ret = gst_element_set_state (standby->playbin, GST_STATE_PAUSED);
+  if (state_ret == GST_STATE_CHANGE_FAILURE) {
+    GST_WARNING_OBJECT (self, "Failed to pre-roll '%s'", uri);
+    standby->failed = TRUE;
+    gst_element_set_state (standby->playbin, GST_STATE_NULL);
+  } else if (state_ret == GST_STATE_CHANGE_NO_PREROLL) {
+    GST_DEBUG_OBJECT (self, "Standby pipeline for '%s' is live", uri);
+    standby->is_live = TRUE;
+    gst_element_set_state (standby->playbin, GST_STATE_PLAYING);
+  }
+
+  return standby;
+}
+
+static void
+gst_player_standby_free (GstPlayerStandby * standby)
+{
+  if (standby->bus_source) {
+    g_source_destroy (standby->bus_source);
+    g_source_unref (standby->bus_source);
+  }
+  if (standby->playbin) {
+    gst_element_set_state (standby->playbin, GST_STATE_NULL);
+    gst_object_unref (standby->playbin);
+  }
+  g_queue_foreach (&standby->messages, (GFunc) gst_mini_object_unref, NULL);
+  g_queue_clear (&standby->messages);
+  g_list_free_full (standby->gates, (GDestroyNotify) keyframe_gate_unref);
+  g_mutex_clear (&standby->lock);
+  g_free (standby->uri);
+  g_free (standby);
+}
+
+/* Removes the standby pipeline of @uri from the list and returns it, unless
+ * it failed */
+static GstPlayerStandby *
+gst_player_take_standby (GstPlayer * self, const gchar * uri)
+{
+  GstPlayerStandby *standby;
+  GList *l;
+
+  for (l = self->standbys; l; l = l->next) {
+    standby = l->data;
+
+    if (g_strcmp0 (standby->uri, uri) != 0)
+      continue;
+
+    self->standbys = g_list_delete_link (self->standbys, l);
+    if (standby->failed) {
+      gst_player_standby_free (standby);
+      return NULL;
+    }
+    return standby;
+  }
+
+  return NULL;
+}
+
+/* Replaces the current pipeline by the one of @standby, called right after
+ * gst_player_stop_internal() */
+static void
+gst_player_switch_to_standby (GstPlayer * self, GstPlayerStandby * standby)
+{
+  GstElement *old_playbin = self->playbin;
+  GstElement *audio_sink = NULL, *video_sink = NULL, *sink;
+  GstVideoMultiviewFramePacking multiview_mode;
+  GstVideoMultiviewFlags multiview_flags;
+  GstMessage *msg;
+  gdouble volume;
+  gboolean mute;
+  gint64 av_offset;
+  gint flags;
+  GList *l;
+
+  GST_DEBUG_OBJECT (self, "Switching to standby pipeline for '%s'",
+      standby->uri);
+
+  g_source_destroy (standby->bus_source);
+  g_source_unref (standby->bus_source);
+  standby->bus_source = NULL;
+  g_signal_handlers_disconnect_by_data (standby->playbin, standby);
+
+  if (standby->is_live) {
+    gst_element_set_state (standby->playbin, GST_STATE_PAUSED);
+
+    g_mutex_lock (&standby->lock);
+    for (l = standby->gates; l; l = l->next) {
+      GstPlayerKeyframeGate *gate = l->data;
+
+      g_atomic_int_set (&gate->released, TRUE);
+    }
+    g_mutex_unlock (&standby->lock);
+  }
+
+  /* keep what the application set on the previous pipeline */
+  g_object_get (old_playbin, "volume", &volume, "mute", &mute, "flags",
+      &flags, "av-offset", &av_offset, "video-multiview-mode",
+      &multiview_mode, "video-multiview-flags", &multiview_flags, NULL);
+  g_object_set (standby->playbin, "volume", volume, "mute", mute, "flags",
+      flags, "av-offset", av_offset, "video-multiview-mode", multiview_mode,
+      "video-multiview-flags", multiview_flags, NULL);
+
+  sink = get_sink (old_playbin, "audio-sink");
+  if (sink) {
+    audio_sink = clone_sink (sink);
+    gst_object_unref (sink);
+  }
+  if (!self->video_renderer) {
+    sink = get_sink (old_playbin, "video-sink");
+    if (sink) {
+      video_sink = clone_sink (sink);
+      gst_object_unref (sink);
+    }
+  }
+
+  gst_player_detach_playbin (self);
+
+  g_mutex_lock (&self->lock);
+  GST_OBJECT_LOCK (self);
+  self->playbin = standby->playbin;
+  GST_OBJECT_UNLOCK (self);
+  standby->playbin = NULL;
+  if (self->current_vis_element) {
+    gst_object_unref (self->current_vis_element);
+    g_object_get (self->playbin, "vis-plugin", &self->current_vis_element,
+        NULL);
+  }
+  g_mutex_unlock (&self->lock);
+
+  gst_player_attach_playbin (self);
+
+  remove_ready_timeout_source (self);
+  gst_element_set_state (old_playbin, GST_STATE_NULL);
+  gst_object_unref (old_playbin);
+
+  /* Once the previous pipeline is gone, the renderer's sink can be used
+   * again. This also lets the renderer know about the new pipeline */
+  if (self->video_renderer) {
+    video_sink =
+        gst_player_video_renderer_create_video_sink (self->video_renderer,
+        self);
+    if (video_sink && GST_OBJECT_PARENT (video_sink)) {
+      /* the application still holds on to the previous pipeline */
+      video_sink = clone_sink (video_sink);
+    }
+  }
+
+  if (!audio_sink)
+    audio_sink = gst_element_factory_make ("autoaudiosink", NULL);
+  if (audio_sink)
+    standby_sink_promote (self->playbin, "audio-sink", audio_sink);
+  if (!video_sink)
+    video_sink = gst_element_factory_make ("autovideosink", NULL);
+  if (video_sink)
+    standby_sink_promote (self->playbin, "video-sink", video_sink);
+
+  self->target_state = GST_STATE_PAUSED;
+  self->current_state = standby->state;
+  self->is_live = standby->is_live;
+  self->buffering = standby->buffering;
+
+  /* Go through what was posted while pre-rolling as if the pipeline had
+   * always been the current one, this creates the media info and brings the
+   * player to the PAUSED state */
+  while ((msg = g_queue_pop_head (&standby->messages))) {
+    gst_bus_async_signal_func (self->bus, msg, NULL);
+    gst_message_unref (msg);
+  }
+
+  gst_player_standby_free (standby);
+}
+
+typedef struct
+{
+  GstPlayer *player;
+  gchar *uri;
+} StandbyUriData;
+
+static void
+standby_uri_data_free (StandbyUriData * data)
+{
+  g_object_unref (data->player);
+  g_free (data->uri);
+  g_free (data);
+}
+
+static gboolean
+gst_player_add_standby_uri_internal (gpointer user_data)
+{
+  StandbyUriData *data = user_data;
+  GstPlayer *self = data->player;
+  GstPlayerStandby *standby;
+  guint max_standby, buffer_size;
+
+  g_mutex_lock (&self->lock);
+  max_standby = gst_player_config_get_max_standby (self->config);
+  buffer_size = gst_player_config_get_standby_buffer_size (self->config);
+  g_mutex_unlock (&self->lock);
+
+  standby = gst_player_take_standby (self, data->uri);
+
+  if (!standby) {
+    /* drop the oldest ones */
+    while (self->standbys && g_list_length (self->standbys) >= max_standby) {
+      standby = self->standbys->data;
+      GST_DEBUG_OBJECT (self, "Dropping standby pipeline for '%s'",
+          standby->uri);
+      gst_player_standby_free (standby);
+      self->standbys = g_list_delete_link (self->standbys, self->standbys);
+    }
+
+    if (max_standby == 0)
+      return G_SOURCE_REMOVE;
+
+    standby = gst_player_standby_new (self, data->uri, buffer_size);
+  }
+
+  /* most recently requested last */
+  self->standbys = g_list_append (self->standbys, standby);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+gst_player_remove_standby_uri_internal (gpointer user_data)
+{
+  StandbyUriData *data = user_data;
+  GstPlayerStandby *standby;
+
+  standby = gst_player_take_standby (data->player, data->uri);
+  if (standby)
+    gst_player_standby_free (standby);
+
+  return G_SOURCE_REMOVE;
+}
+
 static gpointer
 gst_player_init_once (G_GNUC_UNUSED gpointer user_data)
 {
@@ -3498,6 +4405,95 @@ gst_player_set_uri (GstPlayer * self, const gchar * val)
   g_object_set (self, "uri", val, NULL);
 }
 
+/**
+ * gst_player_add_standby_uri:
+ * @player: #GstPlayer instance
+ * @uri: next URI
+ *
+ * Opens @uri in a standby pipeline and pre-rolls it in the background. A
+ * later gst_player_set_uri() with the same URI switches to that pipeline
+ * instead of opening and probing the stream again, so the following
+ * gst_player_play() only has to bring it to PLAYING. This allows e.g. to
+ * zap almost instantly to the neighbouring channels of a TV service.
+ *
+ * At most gst_player_config_get_max_standby() pipelines are kept, the one
+ * added first is dropped when a new one goes over the limit. Adding a URI
+ * that is already in standby makes it the last one to be dropped.
+ *
+ * Standby pipelines render to fakesinks until they are switched to. Live
+ * streams can't pre-roll, they keep running instead and their decoders get
+ * the buffers from the latest keyframe on when switching, at most
+ * gst_player_config_get_standby_buffer_size() bytes per stream.
+ *
+ * The #GstPlayer::standby-ready signal is emitted when the pipeline of @uri
+ * is ready to be switched to.
+ *
+ * Since: 1.16
+ */
+void
+gst_player_add_standby_uri (GstPlayer * self, const gchar * uri)
+{
+  StandbyUriData *data;
+
+  g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (uri != NULL);
+
+  data = g_new (StandbyUriData, 1);
+  data->player = g_object_ref (self);
+  data->uri = g_strdup (uri);
+
+  g_main_context_invoke_full (self->context, G_PRIORITY_DEFAULT,
+      gst_player_add_standby_uri_internal, data,
+      (GDestroyNotify) standby_uri_data_free);
+}
+
+/**
+ * gst_player_remove_standby_uri:
+ * @player: #GstPlayer instance
+ * @uri: URI added with gst_player_add_standby_uri()
+ *
+ * Closes the standby pipeline of @uri, if any.
+ *
+ * Since: 1.16
+ */
+void
+gst_player_remove_standby_uri (GstPlayer * self, const gchar * uri)
+{
+  StandbyUriData *data;
+
+  g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (uri != NULL);
+
+  data = g_new (StandbyUriData, 1);
+  data->player = g_object_ref (self);
+  data->uri = g_strdup (uri);
+
+  g_main_context_invoke_full (self->context, G_PRIORITY_DEFAULT,
+      gst_player_remove_standby_uri_internal, data,
+      (GDestroyNotify) standby_uri_data_free);
+}
+
+/**
+ * gst_player_get_time_to_first_frame:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the time it took from the last URI change until the first frame
+ * reached the sinks, or %GST_CLOCK_TIME_NONE if none did yet.
+ *
+ * Since: 1.16
+ */
+GstClockTime
+gst_player_get_time_to_first_frame (GstPlayer * self)
+{
+  GstClockTime val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_TIME_TO_FIRST_FRAME);
+
+  g_object_get (self, "time-to-first-frame", &val, NULL);
+
+  return val;
+}
+
 /**
  * gst_player_set_subtitle_uri:
  * @player: #GstPlayer instance
@@ -3789,6 +4785,7 @@ gst_player_get_current_subtitle_track (GstPlayer * self)
 static gboolean
 gst_player_select_streams (GstPlayer * self)
 {
+  GstElement *playbin;
   GList *stream_list = NULL;
   gboolean ret = FALSE;
 
@@ -3801,8 +4798,10 @@ gst_player_select_streams (GstPlayer * self)
 
   g_mutex_unlock (&self->lock);
   if (stream_list) {
-    ret = gst_element_send_event (self->playbin,
+    playbin = gst_player_ref_playbin (self);
+    ret = gst_element_send_event (playbin,
         gst_event_new_select_streams (stream_list));
+    gst_object_unref (playbin);
     g_list_free_full (stream_list, g_free);
   } else {
     GST_ERROR_OBJECT (self, "No available streams for select-streams");
@@ -3845,8 +4844,10 @@ gst_player_set_audio_track (GstPlayer * self, gint stream_index)
     ret = gst_player_select_streams (self);
     g_mutex_unlock (&self->lock);
   } else {
-    g_object_set (G_OBJECT (self->playbin), "current-audio", stream_index,
-        NULL);
+    GstElement *playbin = gst_player_ref_playbin (self);
+
+    g_object_set (G_OBJECT (playbin), "current-audio", stream_index, NULL);
+    gst_object_unref (playbin);
   }
 
   GST_DEBUG_OBJECT (self, "set stream index '%d'", stream_index);
@@ -3887,8 +4888,10 @@ gst_player_set_video_track (GstPlayer * self, gint stream_index)
     ret = gst_player_select_streams (self);
     g_mutex_unlock (&self->lock);
   } else {
-    g_object_set (G_OBJECT (self->playbin), "current-video", stream_index,
-        NULL);
+    GstElement *playbin = gst_player_ref_playbin (self);
+
+    g_object_set (G_OBJECT (playbin), "current-video", stream_index, NULL);
+    gst_object_unref (playbin);
   }
 
   GST_DEBUG_OBJECT (self, "set stream index '%d'", stream_index);
@@ -3928,7 +4931,10 @@ gst_player_set_subtitle_track (GstPlayer * self, gint stream_index)
     ret = gst_player_select_streams (self);
     g_mutex_unlock (&self->lock);
   } else {
-    g_object_set (G_OBJECT (self->playbin), "current-text", stream_index, NULL);
+    GstElement *playbin = gst_player_ref_playbin (self);
+
+    g_object_set (G_OBJECT (playbin), "current-text", stream_index, NULL);
+    gst_object_unref (playbin);
   }
 
   GST_DEBUG_OBJECT (self, "set stream index '%d'", stream_index);
@@ -4045,14 +5051,16 @@ gchar *
 gst_player_get_current_visualization (GstPlayer * self)
 {
   gchar *name = NULL;
-  GstElement *vis_plugin = NULL;
+  GstElement *playbin, *vis_plugin = NULL;
 
   g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
 
   if (!is_track_enabled (self, GST_PLAY_FLAG_VIS))
     return NULL;
 
-  g_object_get (self->playbin, "vis-plugin", &vis_plugin, NULL);
+  playbin = gst_player_ref_playbin (self);
+  g_object_get (playbin, "vis-plugin", &vis_plugin, NULL);
+  gst_object_unref (playbin);
 
   if (vis_plugin) {
     GstElementFactory *factory = gst_element_get_factory (vis_plugin);
@@ -4101,7 +5109,7 @@ static const struct CBChannelMap cb_channel_map[] = {
 };
 
 static GstColorBalanceChannel *
-gst_player_color_balance_find_channel (GstPlayer * self,
+gst_player_color_balance_find_channel (GstElement * playbin,
     GstPlayerColorBalanceType type)
 {
   GstColorBalanceChannel *channel;
@@ -4111,8 +5119,7 @@ gst_player_color_balance_find_channel (GstPlayer * self,
       type > GST_PLAYER_COLOR_BALANCE_HUE)
     return NULL;
 
-  channels =
-      gst_color_balance_list_channels (GST_COLOR_BALANCE (self->playbin));
+  channels = gst_color_balance_list_channels (GST_COLOR_BALANCE (playbin));
   for (l = channels; l; l = l->next) {
     channel = l->data;
     if (g_strrstr (channel->label, cb_channel_map[type].label))
@@ -4134,15 +5141,16 @@ gst_player_color_balance_find_channel (GstPlayer * self,
 gboolean
 gst_player_has_color_balance (GstPlayer * self)
 {
-  const GList *channels;
+  GstElement *playbin;
+  const GList *channels = NULL;
 
   g_return_val_if_fail (GST_IS_PLAYER (self), FALSE);
 
-  if (!GST_IS_COLOR_BALANCE (self->playbin))
-    return FALSE;
+  playbin = gst_player_ref_playbin (self);
+  if (GST_IS_COLOR_BALANCE (playbin))
+    channels = gst_color_balance_list_channels (GST_COLOR_BALANCE (playbin));
+  gst_object_unref (playbin);
 
-  channels =
-      gst_color_balance_list_channels (GST_COLOR_BALANCE (self->playbin));
   return (channels != NULL);
 }
 
@@ -4160,17 +5168,19 @@ gst_player_set_color_balance (GstPlayer * self, GstPlayerColorBalanceType type,
     gdouble value)
 {
   GstColorBalanceChannel *channel;
+  GstElement *playbin;
   gdouble new_val;
 
   g_return_if_fail (GST_IS_PLAYER (self));
   g_return_if_fail (value >= 0.0 && value <= 1.0);
 
-  if (!GST_IS_COLOR_BALANCE (self->playbin))
-    return;
+  playbin = gst_player_ref_playbin (self);
+  if (!GST_IS_COLOR_BALANCE (playbin))
+    goto out;
 
-  channel = gst_player_color_balance_find_channel (self, type);
+  channel = gst_player_color_balance_find_channel (playbin, type);
   if (!channel)
-    return;
+    goto out;
 
   value = CLAMP (value, 0.0, 1.0);
 
@@ -4178,8 +5188,10 @@ gst_player_set_color_balance (GstPlayer * self, GstPlayerColorBalanceType type,
   new_val = channel->min_value + value * ((gdouble) channel->max_value -
       (gdouble) channel->min_value);
 
-  gst_color_balance_set_value (GST_COLOR_BALANCE (self->playbin), channel,
-      new_val);
+  gst_color_balance_set_value (GST_COLOR_BALANCE (playbin), channel, new_val);
+
+out:
+  gst_object_unref (playbin);
 }
 
 /**
@@ -4196,23 +5208,30 @@ gdouble
 gst_player_get_color_balance (GstPlayer * self, GstPlayerColorBalanceType type)
 {
   GstColorBalanceChannel *channel;
+  GstElement *playbin;
+  gdouble ret = -1;
   gint value;
 
   g_return_val_if_fail (GST_IS_PLAYER (self), -1);
 
-  if (!GST_IS_COLOR_BALANCE (self->playbin))
-    return -1;
+  playbin = gst_player_ref_playbin (self);
+  if (!GST_IS_COLOR_BALANCE (playbin))
+    goto out;
 
-  channel = gst_player_color_balance_find_channel (self, type);
+  channel = gst_player_color_balance_find_channel (playbin, type);
   if (!channel)
-    return -1;
+    goto out;
 
-  value = gst_color_balance_get_value (GST_COLOR_BALANCE (self->playbin),
-      channel);
+  value = gst_color_balance_get_value (GST_COLOR_BALANCE (playbin), channel);
 
-  return ((gdouble) value -
+  ret = ((gdouble) value -
       (gdouble) channel->min_value) / ((gdouble) channel->max_value -
       (gdouble) channel->min_value);
+
+out:
+  gst_object_unref (playbin);
+
+  return ret;
 }
 
 /**
@@ -4665,6 +5684,94 @@ gst_player_config_get_seek_accurate (const GstStructure * config)
   return accurate;
 }
 
+/**
+ * gst_player_config_set_max_standby:
+ * @config: a #GstPlayer configuration
+ * @max_standby: maximum number of standby pipelines
+ *
+ * Sets how many pipelines gst_player_add_standby_uri() keeps pre-rolled at
+ * the same time. 0 disables them.
+ *
+ * This is 2 by default.
+ *
+ * Since: 1.16
+ */
+void
+gst_player_config_set_max_standby (GstStructure * config, guint max_standby)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_id_set (config,
+      CONFIG_QUARK (MAX_STANDBY), G_TYPE_UINT, max_standby, NULL);
+}
+
+/**
+ * gst_player_config_get_max_standby:
+ * @config: a #GstPlayer configuration
+ *
+ * Returns: the maximum number of standby pipelines
+ *
+ * Since: 1.16
+ */
+guint
+gst_player_config_get_max_standby (const GstStructure * config)
+{
+  guint max_standby = DEFAULT_MAX_STANDBY;
+
+  g_return_val_if_fail (config != NULL, DEFAULT_MAX_STANDBY);
+
+  gst_structure_id_get (config,
+      CONFIG_QUARK (MAX_STANDBY), G_TYPE_UINT, &max_standby, NULL);
+
+  return max_standby;
+}
+
+/**
+ * gst_player_config_set_standby_buffer_size:
+ * @config: a #GstPlayer configuration
+ * @size: buffer size in bytes
+ *
+ * Limits the amount of data each standby pipeline buffers while it waits to
+ * be played, see the playbin #GstPlayBin:buffer-size property. It also
+ * bounds the keyframe interval a live standby pipeline holds back per
+ * stream. 0 keeps the default of playbin and doesn't bound the keyframe
+ * interval.
+ *
+ * This is 0 by default.
+ *
+ * Since: 1.16
+ */
+void
+gst_player_config_set_standby_buffer_size (GstStructure * config, guint size)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_id_set (config,
+      CONFIG_QUARK (STANDBY_BUFFER_SIZE), G_TYPE_UINT, size, NULL);
+}
+
+/**
+ * gst_player_config_get_standby_buffer_size:
+ * @config: a #GstPlayer configuration
+ *
+ * Returns: the buffer size of the standby pipelines in bytes, 0 for the
+ * default of playbin
+ *
+ * Since: 1.16
+ */
+guint
+gst_player_config_get_standby_buffer_size (const GstStructure * config)
+{
+  guint size = DEFAULT_STANDBY_BUFFER_SIZE;
+
+  g_return_val_if_fail (config != NULL, DEFAULT_STANDBY_BUFFER_SIZE);
+
+  gst_structure_id_get (config,
+      CONFIG_QUARK (STANDBY_BUFFER_SIZE), G_TYPE_UINT, &size, NULL);
+
+  return size;
+}
+
 /**
  * gst_player_get_video_snapshot:
  * @player: #GstPlayer instance
@@ -4693,11 +5800,14 @@ gst_player_get_video_snapshot (GstPlayer * self,
   gint height = -1;
   gint par_n = 1;
   gint par_d = 1;
+  GstElement *playbin;
   g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
 
-  g_object_get (self->playbin, "n-video", &video_tracks, NULL);
+  playbin = gst_player_ref_playbin (self);
+  g_object_get (playbin, "n-video", &video_tracks, NULL);
   if (video_tracks == 0) {
     GST_DEBUG_OBJECT (self, "total video track num is 0");
+    gst_object_unref (playbin);
     return NULL;
   }
 
@@ -4752,8 +5862,9 @@ gst_player_get_video_snapshot (GstPlayer * self,
         par_n, par_d, NULL);
   }
 
-  g_signal_emit_by_name (self->playbin, "convert-sample", caps, &sample);
+  g_signal_emit_by_name (playbin, "convert-sample", caps, &sample);
   gst_caps_unref (caps);
+  gst_object_unref (playbin);
   if (!sample) {
     GST_WARNING_OBJECT (self, "Failed to retrieve or convert video frame");
     return NULL;
@@ -141,6 +141,17 @@ void         gst_player_set_uri                       (GstPlayer    * player,
 GST_PLAYER_API
 gchar *      gst_player_get_subtitle_uri              (GstPlayer    * player);
 
+GST_PLAYER_API
+void         gst_player_add_standby_uri               (GstPlayer    * player,
+                                                       const gchar  * uri);
+
+GST_PLAYER_API
+void         gst_player_remove_standby_uri            (GstPlayer    * player,
+                                                       const gchar  * uri);
+
+GST_PLAYER_API
+GstClockTime gst_player_get_time_to_first_frame       (GstPlayer    * player);
+
 GST_PLAYER_API
 void         gst_player_set_subtitle_uri              (GstPlayer    * player,
                                                        const gchar *uri);
@@ -278,6 +289,20 @@ void           gst_player_config_set_seek_accurate (GstStructure * config, gbool
 GST_PLAYER_API
 gboolean       gst_player_config_get_seek_accurate (const GstStructure * config);
 
+GST_PLAYER_API
+void           gst_player_config_set_max_standby      (GstStructure * config,
+                                                       guint          max_standby);
+
+GST_PLAYER_API
+guint          gst_player_config_get_max_standby      (const GstStructure * config);
+
+GST_PLAYER_API
+void           gst_player_config_set_standby_buffer_size (GstStructure * config,
+                                                          guint          size);
+
+GST_PLAYER_API
+guint          gst_player_config_get_standby_buffer_size (const GstStructure * config);
+
 typedef enum
 {
   GST_PLAYER_THUMBNAIL_RAW_NATIVE = 0,
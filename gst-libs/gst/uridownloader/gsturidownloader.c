@@ -27,6 +27,23 @@
 #define GST_CAT_DEFAULT uridownloader_debug
 GST_DEBUG_CATEGORY (uridownloader_debug);
 
+/* Responses kept to revalidate them or to answer the ranges they contain */
+#define MAX_CACHED_RESPONSES 16
+#define MAX_CACHED_RESPONSE_SIZE (1024 * 1024)
+
+#define HTTP_STATUS_NOT_MODIFIED 304
+
+typedef struct _GstUriDownloaderCacheEntry
+{
+  gchar *uri;
+  gint64 range_start;           /* 0 for a complete response */
+  gboolean complete;
+  gchar *etag;
+  gchar *last_modified;
+  GstStructure *headers;
+  GstBuffer *buffer;
+} GstUriDownloaderCacheEntry;
+
 #define GST_URI_DOWNLOADER_GET_PRIVATE(obj)  \
    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
     GST_TYPE_URI_DOWNLOADER, GstUriDownloaderPrivate))
@@ -48,6 +65,20 @@ struct _GstUriDownloaderPrivate
 
   GCond cond;
   gboolean cancelled;
+
+  /* protected by download_lock, most recently used first */
+  GQueue cache;
+  /* the entry whose validators were sent with the current request */
+  GstUriDownloaderCacheEntry *validated;
+  gboolean not_modified;
+
+  /* protected by the object lock */
+  guint64 requests;
+  guint64 sources_reused;
+  guint64 not_modified_count;
+  guint64 range_hits;
+  guint64 bytes_received;
+  guint64 bytes_saved;
 };
 
 static void gst_uri_downloader_finalize (GObject * object);
@@ -111,6 +142,19 @@ gst_uri_downloader_init (GstUriDownloader * downloader)
 
   g_mutex_init (&downloader->priv->download_lock);
   g_cond_init (&downloader->priv->cond);
+  g_queue_init (&downloader->priv->cache);
+}
+
+static void
+gst_uri_downloader_cache_entry_free (GstUriDownloaderCacheEntry * entry)
+{
+  g_free (entry->uri);
+  g_free (entry->etag);
+  g_free (entry->last_modified);
+  if (entry->headers)
+    gst_structure_free (entry->headers);
+  gst_buffer_unref (entry->buffer);
+  g_slice_free (GstUriDownloaderCacheEntry, entry);
 }
 
 static void
@@ -135,6 +179,10 @@ gst_uri_downloader_dispose (GObject * object)
     downloader->priv->download = NULL;
   }
 
+  g_queue_foreach (&downloader->priv->cache,
+      (GFunc) gst_uri_downloader_cache_entry_free, NULL);
+  g_queue_clear (&downloader->priv->cache);
+
   g_weak_ref_clear (&downloader->priv->parent);
 
   G_OBJECT_CLASS (gst_uri_downloader_parent_class)->dispose (object);
@@ -178,6 +226,41 @@ gst_uri_downloader_set_parent (GstUriDownloader * downloader,
   g_weak_ref_set (&downloader->priv->parent, parent);
 }
 
+/**
+ * gst_uri_downloader_get_stats:
+ * @downloader: the #GstUriDownloader
+ *
+ * Returns the statistics of the downloads: the number of "requests" passed
+ * to a source element and how many of them re-used the source, and so its
+ * keep-alive connection, of the previous one in "sources-reused", the
+ * "not-modified" responses to conditional requests and the "range-hits"
+ * answered from a kept response without a request, the "bytes-received"
+ * and the "bytes-saved" by the last two.
+ *
+ * Returns: (transfer full): a #GstStructure
+ *
+ * Since: 1.16
+ */
+GstStructure *
+gst_uri_downloader_get_stats (GstUriDownloader * downloader)
+{
+  GstStructure *stats;
+
+  g_return_val_if_fail (GST_IS_URI_DOWNLOADER (downloader), NULL);
+
+  GST_OBJECT_LOCK (downloader);
+  stats = gst_structure_new ("uridownloader-stats",
+      "requests", G_TYPE_UINT64, downloader->priv->requests,
+      "sources-reused", G_TYPE_UINT64, downloader->priv->sources_reused,
+      "not-modified", G_TYPE_UINT64, downloader->priv->not_modified_count,
+      "range-hits", G_TYPE_UINT64, downloader->priv->range_hits,
+      "bytes-received", G_TYPE_UINT64, downloader->priv->bytes_received,
+      "bytes-saved", G_TYPE_UINT64, downloader->priv->bytes_saved, NULL);
+  GST_OBJECT_UNLOCK (downloader);
+
+  return stats;
+}
+
 static gboolean
 gst_uri_downloader_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event)
@@ -235,25 +318,40 @@ gst_uri_downloader_bus_handler (GstBus * bus,
     GError *err = NULL;
     gchar *dbg_info = NULL;
     gchar *new_error = NULL;
+    const GstStructure *details = NULL;
+    guint status_code = 0;
 
     gst_message_parse_error (message, &err, &dbg_info);
-    GST_WARNING_OBJECT (downloader,
-        "Received error: %s from %s, the download will be cancelled",
-        err->message, GST_OBJECT_NAME (message->src));
-    GST_DEBUG ("Debugging info: %s\n", (dbg_info) ? dbg_info : "none");
+    gst_message_parse_error_details (message, &details);
+    if (details)
+      gst_structure_get_uint (details, "http-status-code", &status_code);
+
+    if (status_code == HTTP_STATUS_NOT_MODIFIED
+        && downloader->priv->validated) {
+      /* answer to the validators we sent, the kept response is used */
+      GST_DEBUG_OBJECT (downloader, "%s was not modified",
+          downloader->priv->validated->uri);
+      downloader->priv->not_modified = TRUE;
+      g_error_free (err);
+    } else {
+      GST_WARNING_OBJECT (downloader,
+          "Received error: %s from %s, the download will be cancelled",
+          err->message, GST_OBJECT_NAME (message->src));
+      GST_DEBUG ("Debugging info: %s\n", (dbg_info) ? dbg_info : "none");
+
+      if (dbg_info)
+        new_error = g_strdup_printf ("%s: %s\n", err->message, dbg_info);
+      if (new_error) {
+        g_free (err->message);
+        err->message = new_error;
+      }
 
-    if (dbg_info)
-      new_error = g_strdup_printf ("%s: %s\n", err->message, dbg_info);
-    if (new_error) {
-      g_free (err->message);
-      err->message = new_error;
+      if (!downloader->priv->err)
+        downloader->priv->err = err;
+      else
+        g_error_free (err);
     }
 
-    if (!downloader->priv->err)
-      downloader->priv->err = err;
-    else
-      g_error_free (err);
-
     g_free (dbg_info);
 
     /* remove the sync handler to avoid duplicated messages */
@@ -425,6 +523,8 @@ gst_uri_downloader_ensure_src (GstUriDownloader * downloader, const gchar * uri)
             "Failed to re-use old source element: %s", err->message);
         g_clear_error (&err);
         gst_uri_downloader_destroy_src (downloader);
+      } else {
+        downloader->priv->sources_reused++;
       }
     }
     g_free (old_uri);
@@ -463,11 +563,16 @@ gst_uri_downloader_destroy_src (GstUriDownloader * downloader)
 static gboolean
 gst_uri_downloader_set_uri (GstUriDownloader * downloader, const gchar * uri,
     const gchar * referer, gboolean compress,
-    gboolean refresh, gboolean allow_cache)
+    gboolean refresh, gboolean allow_cache,
+    gint64 range_start, gint64 range_end, gboolean * range_set)
 {
+  GstUriDownloaderCacheEntry *validated = downloader->priv->validated;
+  gboolean has_range = range_start > 0 || range_end >= 0;
   GstPad *pad;
   GObjectClass *gobject_class;
 
+  *range_set = FALSE;
+
   if (!gst_uri_is_valid (uri))
     return FALSE;
 
@@ -480,7 +585,7 @@ gst_uri_downloader_set_uri (GstUriDownloader * downloader, const gchar * uri,
   if (g_object_class_find_property (gobject_class, "keep-alive"))
     g_object_set (downloader->priv->urisrc, "keep-alive", TRUE, NULL);
   if (g_object_class_find_property (gobject_class, "extra-headers")) {
-    if (referer || refresh || !allow_cache) {
+    if (referer || refresh || !allow_cache || validated || has_range) {
       GstStructure *extra_headers = gst_structure_new_empty ("headers");
 
       if (referer)
@@ -494,6 +599,26 @@ gst_uri_downloader_set_uri (GstUriDownloader * downloader, const gchar * uri,
         gst_structure_set (extra_headers, "Cache-Control", G_TYPE_STRING,
             "max-age=0", NULL);
 
+      if (validated && validated->etag)
+        gst_structure_set (extra_headers, "If-None-Match", G_TYPE_STRING,
+            validated->etag, NULL);
+      if (validated && validated->last_modified)
+        gst_structure_set (extra_headers, "If-Modified-Since", G_TYPE_STRING,
+            validated->last_modified, NULL);
+
+      if (has_range) {
+        gchar *range;
+
+        if (range_end >= 0)
+          range = g_strdup_printf ("bytes=%" G_GINT64_FORMAT "-%"
+              G_GINT64_FORMAT, range_start, range_end);
+        else
+          range = g_strdup_printf ("bytes=%" G_GINT64_FORMAT "-", range_start);
+        gst_structure_set (extra_headers, "Range", G_TYPE_STRING, range, NULL);
+        g_free (range);
+        *range_set = TRUE;
+      }
+
       g_object_set (downloader->priv->urisrc, "extra-headers", extra_headers,
           NULL);
 
@@ -501,6 +626,9 @@ gst_uri_downloader_set_uri (GstUriDownloader * downloader, const gchar * uri,
     } else {
       g_object_set (downloader->priv->urisrc, "extra-headers", NULL, NULL);
     }
+  } else {
+    /* no way to send the validators, fetch the whole response */
+    downloader->priv->validated = NULL;
   }
 
   /* add a sync handler for the bus messages to detect errors in the download */
@@ -543,6 +671,170 @@ gst_uri_downloader_fetch_uri (GstUriDownloader * downloader,
       referer, compress, refresh, allow_cache, 0, -1, err);
 }
 
+static const gchar *
+gst_uri_downloader_get_response_header (GstFragment * download,
+    const gchar * name)
+{
+  const GstStructure *response_headers;
+  const GValue *value;
+  const gchar *field;
+  gint i;
+
+  if (!download->headers)
+    return NULL;
+
+  value = gst_structure_get_value (download->headers, "response-headers");
+  if (!value || !GST_VALUE_HOLDS_STRUCTURE (value))
+    return NULL;
+  response_headers = gst_value_get_structure (value);
+
+  /* the header names are kept as the server sent them */
+  for (i = 0; i < gst_structure_n_fields (response_headers); i++) {
+    field = gst_structure_nth_field_name (response_headers, i);
+    if (g_ascii_strcasecmp (field, name) == 0) {
+      value = gst_structure_get_value (response_headers, field);
+      return G_VALUE_HOLDS_STRING (value) ? g_value_get_string (value) : NULL;
+    }
+  }
+
+  return NULL;
+}
+
+static GstUriDownloaderCacheEntry *
+gst_uri_downloader_cache_lookup (GstUriDownloader * downloader,
+    const gchar * uri)
+{
+  GstUriDownloaderCacheEntry *entry;
+  GList *link;
+
+  for (link = downloader->priv->cache.head; link; link = link->next) {
+    entry = link->data;
+    if (g_str_equal (entry->uri, uri)) {
+      g_queue_unlink (&downloader->priv->cache, link);
+      g_queue_push_head_link (&downloader->priv->cache, link);
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+static void
+gst_uri_downloader_cache_remove (GstUriDownloader * downloader,
+    const gchar * uri)
+{
+  GstUriDownloaderCacheEntry *entry;
+
+  entry = gst_uri_downloader_cache_lookup (downloader, uri);
+  if (entry) {
+    g_queue_pop_head (&downloader->priv->cache);
+    gst_uri_downloader_cache_entry_free (entry);
+  }
+}
+
+/* Keeps a response with validators to revalidate it with the next fetch of
+ * the URI, or a range to answer the ranges it contains */
+static void
+gst_uri_downloader_cache_store (GstUriDownloader * downloader,
+    GstFragment * download, const gchar * uri)
+{
+  GQueue *cache = &downloader->priv->cache;
+  GstUriDownloaderCacheEntry *entry;
+  const gchar *etag, *last_modified;
+  gboolean complete;
+  GstBuffer *buffer;
+
+  gst_uri_downloader_cache_remove (downloader, uri);
+
+  complete = download->range_start == 0 && download->range_end == -1;
+  etag = gst_uri_downloader_get_response_header (download, "ETag");
+  last_modified =
+      gst_uri_downloader_get_response_header (download, "Last-Modified");
+  if (complete && !etag && !last_modified)
+    return;
+
+  buffer = gst_fragment_get_buffer (download);
+  if (!buffer)
+    return;
+  if (gst_buffer_get_size (buffer) > MAX_CACHED_RESPONSE_SIZE) {
+    gst_buffer_unref (buffer);
+    return;
+  }
+
+  entry = g_slice_new0 (GstUriDownloaderCacheEntry);
+  entry->uri = g_strdup (uri);
+  entry->range_start = download->range_start;
+  entry->complete = complete;
+  entry->etag = g_strdup (etag);
+  entry->last_modified = g_strdup (last_modified);
+  if (download->headers)
+    entry->headers = gst_structure_copy (download->headers);
+  entry->buffer = buffer;
+
+  g_queue_push_head (cache, entry);
+  if (g_queue_get_length (cache) > MAX_CACHED_RESPONSES)
+    gst_uri_downloader_cache_entry_free (g_queue_pop_tail (cache));
+}
+
+/* Whether the range is contained in the kept response */
+static gboolean
+gst_uri_downloader_cache_entry_contains (GstUriDownloaderCacheEntry * entry,
+    gint64 range_start, gint64 range_end)
+{
+  gint64 entry_end;
+
+  entry_end = entry->range_start + gst_buffer_get_size (entry->buffer) - 1;
+
+  if (range_end < 0)
+    return entry->complete && range_start <= entry_end;
+
+  return range_start >= entry->range_start && range_end <= entry_end;
+}
+
+static GstFragment *
+gst_uri_downloader_cache_entry_fragment (GstUriDownloaderCacheEntry * entry,
+    gint64 range_start, gint64 range_end)
+{
+  GstFragment *download;
+  gsize offset, size;
+
+  offset = range_start - entry->range_start;
+  if (range_end < 0)
+    size = gst_buffer_get_size (entry->buffer) - offset;
+  else
+    size = range_end - range_start + 1;
+
+  download = gst_fragment_new ();
+  download->range_start = range_start;
+  download->range_end = range_end;
+  if (entry->headers)
+    download->headers = gst_structure_copy (entry->headers);
+  download->download_start_time = gst_util_get_timestamp ();
+  if (size > 0)
+    gst_fragment_add_buffer (download,
+        gst_buffer_copy_region (entry->buffer, GST_BUFFER_COPY_ALL, offset,
+            size));
+  download->completed = TRUE;
+  download->download_stop_time = download->download_start_time;
+
+  return download;
+}
+
+static guint64
+gst_uri_downloader_fragment_size (GstFragment * download)
+{
+  GstBuffer *buffer;
+  guint64 size;
+
+  buffer = gst_fragment_get_buffer (download);
+  if (!buffer)
+    return 0;
+  size = gst_buffer_get_size (buffer);
+  gst_buffer_unref (buffer);
+
+  return size;
+}
+
 /**
  * gst_uri_downloader_fetch_uri_with_range:
  * @downloader: the #GstUriDownloader
@@ -560,12 +852,16 @@ gst_uri_downloader_fetch_uri_with_range (GstUriDownloader *
 {
   GstStateChangeReturn ret;
   GstFragment *download = NULL;
+  GstUriDownloaderCacheEntry *entry;
+  gboolean range_set = FALSE;
 
   GST_DEBUG_OBJECT (downloader, "Fetching URI %s", uri);
 
   g_mutex_lock (&downloader->priv->download_lock);
   downloader->priv->err = NULL;
   downloader->priv->got_buffer = FALSE;
+  downloader->priv->validated = NULL;
+  downloader->priv->not_modified = FALSE;
 
   GST_OBJECT_LOCK (downloader);
   if (downloader->priv->cancelled) {
@@ -573,11 +869,32 @@ gst_uri_downloader_fetch_uri_with_range (GstUriDownloader *
     goto quit;
   }
 
+  entry = gst_uri_downloader_cache_lookup (downloader, uri);
+  if (entry && range_start == 0 && range_end == -1) {
+    if (entry->complete)
+      downloader->priv->validated = entry;
+  } else if (entry && range_start >= 0 && !refresh
+      && gst_uri_downloader_cache_entry_contains (entry, range_start,
+          range_end)) {
+    GST_DEBUG_OBJECT (downloader, "Range %" G_GINT64_FORMAT "-%"
+        G_GINT64_FORMAT " of %s is kept", range_start, range_end, uri);
+    download = gst_uri_downloader_cache_entry_fragment (entry, range_start,
+        range_end);
+    download->uri = g_strdup (uri);
+    downloader->priv->range_hits++;
+    downloader->priv->bytes_saved +=
+        gst_uri_downloader_fragment_size (download);
+    GST_OBJECT_UNLOCK (downloader);
+    g_mutex_unlock (&downloader->priv->download_lock);
+    return download;
+  }
+
   if (!gst_uri_downloader_set_uri (downloader, uri, referer, compress, refresh,
-          allow_cache)) {
+          allow_cache, range_start, range_end, &range_set)) {
     GST_WARNING_OBJECT (downloader, "Failed to set URI");
     goto quit;
   }
+  downloader->priv->requests++;
 
   gst_bus_set_flushing (downloader->priv->bus, FALSE);
   if (downloader->priv->download)
@@ -603,7 +920,7 @@ gst_uri_downloader_fetch_uri_with_range (GstUriDownloader *
       GST_WARNING_OBJECT (downloader, "Failed to set HTTP method");
       goto quit;
     }
-  } else {
+  } else if (!range_set) {
     if (!gst_uri_downloader_set_range (downloader, range_start, range_end)) {
       GST_WARNING_OBJECT (downloader, "Failed to set range");
       goto quit;
@@ -640,6 +957,15 @@ gst_uri_downloader_fetch_uri_with_range (GstUriDownloader *
       g_object_unref (downloader->priv->download);
       downloader->priv->download = NULL;
     }
+    if (downloader->priv->not_modified) {
+      download =
+          gst_uri_downloader_cache_entry_fragment (downloader->priv->validated,
+          0, -1);
+      downloader->priv->not_modified_count++;
+      downloader->priv->bytes_saved +=
+          gst_uri_downloader_fragment_size (download);
+      GST_INFO_OBJECT (downloader, "URI not modified, using kept response");
+    }
     goto quit;
   }
 
@@ -655,6 +981,12 @@ gst_uri_downloader_fetch_uri_with_range (GstUriDownloader *
     }
   }
 
+  if (download != NULL && download->range_start >= 0) {
+    downloader->priv->bytes_received +=
+        gst_uri_downloader_fragment_size (download);
+    gst_uri_downloader_cache_store (downloader, download, uri);
+  }
+
   if (download != NULL)
     GST_INFO_OBJECT (downloader, "URI fetched successfully");
   else
@@ -67,6 +67,9 @@ GstUriDownloader * gst_uri_downloader_new (void);
 GST_URI_DOWNLOADER_API
 void gst_uri_downloader_set_parent (GstUriDownloader * downloader, GstElement * parent);
 
+GST_URI_DOWNLOADER_API
+GstStructure * gst_uri_downloader_get_stats (GstUriDownloader * downloader);
+
 GST_URI_DOWNLOADER_API
 GstFragment * gst_uri_downloader_fetch_uri (GstUriDownloader * downloader, const gchar * uri, const gchar * referer, gboolean compress, gboolean refresh, gboolean allow_cache, GError ** err);
 
@@ -56,32 +56,221 @@
   }                                                                            \
 } G_STMT_END
 
-#define draw_line_aa(_vd, _x1, _x2, _y1, _y2, _st, _c) G_STMT_START {          \
-  guint _i, _j, _x, _y;                                                        \
-  gint _dx = _x2 - _x1, _dy = _y2 - _y1;                                       \
-  gfloat _f, _rx, _ry, _fx, _fy;                                               \
-                                                                               \
-  _j = abs (_dx) > abs (_dy) ? abs (_dx) : abs (_dy);                          \
-  for (_i = 0; _i < _j; _i++) {                                                \
-    _f = (gfloat) _i / (gfloat) _j;                                            \
-    _rx = _x1 + _dx * _f;                                                      \
-    _ry = _y1 + _dy * _f;                                                      \
-    _x = (guint)_rx;                                                           \
-    _y = (guint)_ry;                                                           \
-    _fx = _rx - (gfloat)_x;                                                    \
-    _fy = _ry - (gfloat)_y;                                                    \
-                                                                               \
-    _f = ((1.0 - _fx) + (1.0 - _fy)) / 2.0;                                    \
-    draw_dot_aa (_vd, _x, _y, _st, _c, _f);                                    \
-                                                                               \
-    _f = (_fx + (1.0 - _fy)) / 2.0;                                            \
-    draw_dot_aa (_vd, (_x + 1), _y, _st, _c, _f);                              \
-                                                                               \
-    _f = ((1.0 - _fx) + _fy) / 2.0;                                            \
-    draw_dot_aa (_vd, _x, (_y + 1), _st, _c, _f);                              \
-                                                                               \
-    _f = (_fx + _fy) / 2.0;                                                    \
-    draw_dot_aa (_vd, (_x + 1), (_y + 1), _st, _c, _f);                        \
-  }                                                                            \
-} G_STMT_END
 
+#include <stdlib.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* saturating add of the four bytes of _c to the pixel, without branches */
+static inline void
+add_pixel (guint32 * _p, guint32 _c)
+{
+  guint32 p = *_p, t, x, o;
+
+  t = (p & 0x7f7f7f7f) + (_c & 0x7f7f7f7f);
+  x = (p ^ _c) & 0x80808080;
+  /* carry out of the top bit of each byte */
+  o = ((p & _c) | (x & t)) & 0x80808080;
+
+  *_p = (t ^ x) | ((o >> 7) * 0xff);
+}
+
+/* Adds _c weighted by _f00, _f10, _f01 and _f11 to the pixel at _p, the one
+ * right of it and the two below them, like draw_dot_aa() does for each. With
+ * SSE2 the four pixels are blended at once */
+static inline void
+draw_quad_aa (guint32 * _p, guint _st, guint32 _c, gfloat _f00, gfloat _f10,
+    gfloat _f01, gfloat _f11)
+{
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128 cv = _mm_cvtepi32_ps (_mm_unpacklo_epi16 (_mm_unpacklo_epi8
+          (_mm_cvtsi32_si128 (_c), zero), zero));
+  __m128i top = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i *) _p),
+      zero);
+  __m128i bottom = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i *)
+          (_p + _st)), zero);
+  __m128i p00, p10, p01, p11;
+
+  /* channel + color * f, truncated and saturated as in draw_dot_aa() */
+  p00 = _mm_cvttps_epi32 (_mm_add_ps (_mm_cvtepi32_ps (_mm_unpacklo_epi16
+              (top, zero)), _mm_mul_ps (cv, _mm_set1_ps (_f00))));
+  p10 = _mm_cvttps_epi32 (_mm_add_ps (_mm_cvtepi32_ps (_mm_unpackhi_epi16
+              (top, zero)), _mm_mul_ps (cv, _mm_set1_ps (_f10))));
+  p01 = _mm_cvttps_epi32 (_mm_add_ps (_mm_cvtepi32_ps (_mm_unpacklo_epi16
+              (bottom, zero)), _mm_mul_ps (cv, _mm_set1_ps (_f01))));
+  p11 = _mm_cvttps_epi32 (_mm_add_ps (_mm_cvtepi32_ps (_mm_unpackhi_epi16
+              (bottom, zero)), _mm_mul_ps (cv, _mm_set1_ps (_f11))));
+
+  top = _mm_packus_epi16 (_mm_packs_epi32 (p00, p10), zero);
+  bottom = _mm_packus_epi16 (_mm_packs_epi32 (p01, p11), zero);
+  /* the alpha is cleared */
+  _mm_storel_epi64 ((__m128i *) _p, _mm_and_si128 (top,
+          _mm_set1_epi32 (0x00ffffff)));
+  _mm_storel_epi64 ((__m128i *) (_p + _st), _mm_and_si128 (bottom,
+          _mm_set1_epi32 (0x00ffffff)));
+#else
+  draw_dot_aa (_p, 0, 0, _st, _c, _f00);
+  draw_dot_aa (_p, 1, 0, _st, _c, _f10);
+  draw_dot_aa (_p, 0, 1, _st, _c, _f01);
+  draw_dot_aa (_p, 1, 1, _st, _c, _f11);
+#endif
+}
+
+static inline void
+draw_line_aa (guint32 * _vd, gint _x1, gint _x2, gint _y1, gint _y2,
+    guint _st, guint32 _c)
+{
+  guint _i, _j, _x, _y;
+  gint _dx = _x2 - _x1, _dy = _y2 - _y1;
+  gfloat _f, _rx, _ry, _fx, _fy;
+
+  _j = abs (_dx) > abs (_dy) ? abs (_dx) : abs (_dy);
+  for (_i = 0; _i < _j; _i++) {
+    _f = (gfloat) _i / (gfloat) _j;
+    _rx = _x1 + _dx * _f;
+    _ry = _y1 + _dy * _f;
+    _x = (guint) _rx;
+    _y = (guint) _ry;
+    _fx = _rx - (gfloat) _x;
+    _fy = _ry - (gfloat) _y;
+
+    draw_quad_aa (&_vd[(_y * _st) + _x], _st, _c,
+        ((1.0 - _fx) + (1.0 - _fy)) / 2.0, (_fx + (1.0 - _fy)) / 2.0,
+        ((1.0 - _fx) + _fy) / 2.0, (_fx + _fy) / 2.0);
+  }
+}
+
+/* Maps _n samples, _stride samples apart, to the coordinates _o + sample * _d,
+ * four at a time with SSE2 */
+static inline void
+scale_samples (guint * _out, const gint16 * _s, guint _stride, guint _n,
+    gfloat _o, gfloat _d)
+{
+  guint i = 0;
+
+#ifdef __SSE2__
+  {
+    __m128 ov = _mm_set1_ps (_o), dv = _mm_set1_ps (_d);
+
+    for (; i + 4 <= _n; i += 4, _s += 4 * _stride) {
+      __m128 sv = _mm_cvtepi32_ps (_mm_set_epi32 (_s[3 * _stride],
+              _s[2 * _stride], _s[_stride], _s[0]));
+
+      _mm_storeu_si128 ((__m128i *) (_out + i),
+          _mm_cvttps_epi32 (_mm_add_ps (ov, _mm_mul_ps (sv, dv))));
+    }
+  }
+#endif
+  for (; i < _n; i++, _s += _stride)
+    _out[i] = (guint) (_o + (gfloat) _s[0] * _d);
+}
+
+/* Maps the _n positions from _first on to the coordinates position * _d */
+static inline void
+scale_positions (guint * _out, guint _first, guint _n, gfloat _d)
+{
+  guint i = 0;
+
+#ifdef __SSE2__
+  {
+    __m128i pv = _mm_add_epi32 (_mm_set1_epi32 (_first),
+        _mm_set_epi32 (3, 2, 1, 0));
+    __m128 dv = _mm_set1_ps (_d);
+
+    for (; i + 4 <= _n; i += 4) {
+      _mm_storeu_si128 ((__m128i *) (_out + i),
+          _mm_cvttps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (pv), dv)));
+      pv = _mm_add_epi32 (pv, _mm_set1_epi32 (4));
+    }
+  }
+#endif
+  for (; i < _n; i++)
+    _out[i] = (guint) ((gfloat) (_first + i) * _d);
+}
+
+/* Draws the _n dots at _xs, _ys, with SSE2 the pixel offsets are computed
+ * four at a time */
+static inline void
+draw_dots (guint32 * _vd, const guint * _xs, const guint * _ys, guint _n,
+    guint _st, guint32 _c)
+{
+  guint i = 0;
+
+#ifdef __SSE2__
+  {
+    __m128i sv = _mm_set1_epi32 (_st);
+    guint off[4];
+
+    for (; i + 4 <= _n; i += 4) {
+      __m128i yv = _mm_loadu_si128 ((const __m128i *) (_ys + i));
+      /* the low 32 bits of y * _st, from the 64 bit products of the even
+       * and odd lanes */
+      __m128i even = _mm_mul_epu32 (yv, sv);
+      __m128i odd = _mm_mul_epu32 (_mm_srli_epi64 (yv, 32), sv);
+      __m128i ov = _mm_unpacklo_epi32 (_mm_shuffle_epi32 (even,
+              _MM_SHUFFLE (0, 0, 2, 0)), _mm_shuffle_epi32 (odd,
+              _MM_SHUFFLE (0, 0, 2, 0)));
+
+      ov = _mm_add_epi32 (ov, _mm_loadu_si128 ((const __m128i *) (_xs + i)));
+      _mm_storeu_si128 ((__m128i *) off, ov);
+      _vd[off[0]] = _c;
+      _vd[off[1]] = _c;
+      _vd[off[2]] = _c;
+      _vd[off[3]] = _c;
+    }
+  }
+#endif
+  for (; i < _n; i++)
+    draw_dot (_vd, _xs[i], _ys[i], _st, _c);
+}
+
+/* Draws one vertical bar per column, rows are walked in memory order so that
+ * several columns are done at once. The bar of column x starts with a _c
+ * pixel at row top[x], _fill is added below it down to row _last, which gets
+ * it added once more */
+static inline void
+draw_bars (guint32 * _vd, guint _w, guint _last, const guint * top,
+    guint32 _c, guint32 _fill)
+{
+  guint x, r, first = _last;
+  guint32 *row;
+
+  for (x = 0; x < _w; x++)
+    first = MIN (first, top[x]);
+
+  for (r = first; r <= _last; r++) {
+    row = _vd + r * _w;
+    x = 0;
+#ifdef __SSE2__
+    {
+      __m128i rv = _mm_set1_epi32 (r);
+      __m128i cv = _mm_set1_epi32 (_c);
+      __m128i fv = _mm_set1_epi32 (_fill);
+
+      for (; x + 4 <= _w; x += 4) {
+        __m128i tv = _mm_loadu_si128 ((const __m128i *) (top + x));
+        __m128i pv = _mm_loadu_si128 ((const __m128i *) (row + x));
+        __m128i eq = _mm_cmpeq_epi32 (tv, rv);
+        __m128i below = _mm_cmplt_epi32 (tv, rv);
+
+        pv = _mm_adds_epu8 (pv, _mm_and_si128 (below, fv));
+        pv = _mm_or_si128 (_mm_andnot_si128 (eq, pv), _mm_and_si128 (eq, cv));
+        if (r == _last)
+          pv = _mm_adds_epu8 (pv, fv);
+        _mm_storeu_si128 ((__m128i *) (row + x), pv);
+      }
+    }
+#endif
+    for (; x < _w; x++) {
+      if (top[x] == r)
+        row[x] = _c;
+      else if (top[x] < r)
+        add_pixel (&row[x], _fill);
+      if (r == _last)
+        add_pixel (&row[x], _fill);
+    }
+  }
+}
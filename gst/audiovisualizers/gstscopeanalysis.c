@@ -0,0 +1,283 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * gstscopeanalysis.c: spectrum analysis shared by the scopes
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Per channel float FFT of the last @size frames that were given to
+ * gst_scope_analysis_process_s16(). Callers can hand in blocks shorter than
+ * the FFT, the older samples are then kept from the previous calls, so
+ * consecutive analyses overlap.
+ *
+ * The window is computed once and has the 1/size normalization folded in,
+ * the spectrum of a full scale sine peaks at about half the window gain. The
+ * per sample loops work on separate float arrays so the compiler can
+ * vectorize them.
+ *
+ * GstScopeRenderInterval only lets every Nth video frame be drawn and fills
+ * the ones in between with the last drawn frame.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#include "gstscopeanalysis.h"
+
+struct _GstScopeAnalysis
+{
+  guint channels;
+  guint rate;
+  guint size;
+  guint n_freq;
+
+  GstFFTF32 *fft;
+  gfloat *window;
+  gfloat *tmp;
+
+  /* per channel, one after the other */
+  gfloat *history;
+  GstFFTF32Complex *spectrum;
+  gfloat *magnitudes;
+
+  /* log-frequency bands, band b covers the bins band_start[b] to
+   * band_start[b + 1] - 1 */
+  guint n_bands;
+  guint *band_start;
+  gfloat *bands;
+};
+
+GstScopeAnalysis *
+gst_scope_analysis_new (guint channels, guint rate, guint size,
+    GstFFTWindow window)
+{
+  GstScopeAnalysis *analysis;
+  guint i;
+
+  g_return_val_if_fail (channels > 0, NULL);
+  g_return_val_if_fail (rate > 0, NULL);
+  g_return_val_if_fail (size >= 2 && size % 2 == 0, NULL);
+
+  analysis = g_new0 (GstScopeAnalysis, 1);
+  analysis->channels = channels;
+  analysis->rate = rate;
+  analysis->size = size;
+  analysis->n_freq = size / 2 + 1;
+
+  analysis->fft = gst_fft_f32_new (size, FALSE);
+  analysis->window = g_new (gfloat, size);
+  for (i = 0; i < size; i++)
+    analysis->window[i] = 1.0 / size;
+  gst_fft_f32_window (analysis->fft, analysis->window, window);
+  analysis->tmp = g_new (gfloat, size);
+
+  analysis->history = g_new0 (gfloat, channels * size);
+  analysis->spectrum = g_new0 (GstFFTF32Complex, channels * analysis->n_freq);
+  analysis->magnitudes = g_new0 (gfloat, channels * analysis->n_freq);
+
+  return analysis;
+}
+
+void
+gst_scope_analysis_free (GstScopeAnalysis * analysis)
+{
+  if (!analysis)
+    return;
+
+  gst_fft_f32_free (analysis->fft);
+  g_free (analysis->window);
+  g_free (analysis->tmp);
+  g_free (analysis->history);
+  g_free (analysis->spectrum);
+  g_free (analysis->magnitudes);
+  g_free (analysis->band_start);
+  g_free (analysis->bands);
+  g_free (analysis);
+}
+
+/* Groups the bins in @n_bands bands of equal width on a log-frequency scale
+ * from @fmin to @fmax, every band gets at least one bin */
+void
+gst_scope_analysis_set_bands (GstScopeAnalysis * analysis, guint n_bands,
+    gfloat fmin, gfloat fmax)
+{
+  gfloat bin_width;
+  guint b, k;
+
+  g_return_if_fail (analysis != NULL);
+
+  g_free (analysis->band_start);
+  g_free (analysis->bands);
+  analysis->band_start = NULL;
+  analysis->bands = NULL;
+  analysis->n_bands = n_bands;
+  if (n_bands == 0)
+    return;
+
+  bin_width = (gfloat) analysis->rate / analysis->size;
+  fmin = MAX (fmin, bin_width);
+  fmax = CLAMP (fmax, fmin, analysis->rate / 2.0);
+
+  analysis->band_start = g_new (guint, n_bands + 1);
+  analysis->bands = g_new0 (gfloat, analysis->channels * n_bands);
+
+  analysis->band_start[0] = (guint) (fmin / bin_width);
+  for (b = 1; b <= n_bands; b++) {
+    k = (guint) (fmin * powf (fmax / fmin, (gfloat) b / n_bands) / bin_width);
+    k = MAX (k, analysis->band_start[b - 1] + 1);
+    analysis->band_start[b] = MIN (k, analysis->n_freq);
+  }
+}
+
+static void
+analyse_channel (GstScopeAnalysis * analysis, guint channel)
+{
+  const gfloat *hist = analysis->history + channel * analysis->size;
+  const gfloat *window = analysis->window;
+  gfloat *tmp = analysis->tmp;
+  GstFFTF32Complex *spec = analysis->spectrum + channel * analysis->n_freq;
+  gfloat *mag = analysis->magnitudes + channel * analysis->n_freq;
+  guint i, b, size = analysis->size, n_freq = analysis->n_freq;
+
+  for (i = 0; i < size; i++)
+    tmp[i] = hist[i] * window[i];
+
+  gst_fft_f32_fft (analysis->fft, tmp, spec);
+
+  for (i = 0; i < n_freq; i++)
+    mag[i] = sqrtf (spec[i].r * spec[i].r + spec[i].i * spec[i].i);
+
+  if (analysis->n_bands) {
+    const guint *start = analysis->band_start;
+    gfloat *bands = analysis->bands + channel * analysis->n_bands;
+
+    for (b = 0; b < analysis->n_bands; b++) {
+      gfloat m = 0.0;
+
+      for (i = start[b]; i < start[b + 1]; i++)
+        m = MAX (m, mag[i]);
+      bands[b] = m;
+    }
+  }
+}
+
+/* Analyses the last frames of the @n_frames interleaved frames in @data,
+ * together with older frames if there are less than the FFT size */
+void
+gst_scope_analysis_process_s16 (GstScopeAnalysis * analysis,
+    const gint16 * data, guint n_frames)
+{
+  guint ch, i, keep, n_new, channels, size;
+
+  g_return_if_fail (analysis != NULL);
+
+  if (n_frames == 0)
+    return;
+
+  channels = analysis->channels;
+  size = analysis->size;
+  n_new = MIN (n_frames, size);
+  keep = size - n_new;
+  data += (n_frames - n_new) * channels;
+
+  for (ch = 0; ch < channels; ch++) {
+    gfloat *dst = analysis->history + ch * size;
+    const gint16 *src = data + ch;
+
+    if (keep)
+      memmove (dst, dst + n_new, keep * sizeof (gfloat));
+    dst += keep;
+
+    for (i = 0; i < n_new; i++)
+      dst[i] = src[i * channels] * (1.0f / 32768.0f);
+
+    analyse_channel (analysis, ch);
+  }
+}
+
+const GstFFTF32Complex *
+gst_scope_analysis_get_spectrum (GstScopeAnalysis * analysis, guint channel)
+{
+  g_return_val_if_fail (channel < analysis->channels, NULL);
+
+  return analysis->spectrum + channel * analysis->n_freq;
+}
+
+const gfloat *
+gst_scope_analysis_get_magnitudes (GstScopeAnalysis * analysis, guint channel)
+{
+  g_return_val_if_fail (channel < analysis->channels, NULL);
+
+  return analysis->magnitudes + channel * analysis->n_freq;
+}
+
+const gfloat *
+gst_scope_analysis_get_bands (GstScopeAnalysis * analysis, guint channel)
+{
+  g_return_val_if_fail (channel < analysis->channels, NULL);
+  g_return_val_if_fail (analysis->n_bands > 0, NULL);
+
+  return analysis->bands + channel * analysis->n_bands;
+}
+
+/* Fills @video with the last drawn frame and returns TRUE if it is not to be
+ * drawn */
+gboolean
+gst_scope_render_interval_repeat (GstScopeRenderInterval * ri,
+    GstVideoFrame * video)
+{
+  if (ri->interval <= 1 || !ri->last_frame
+      || ri->count++ % ri->interval == 0)
+    return FALSE;
+
+  memcpy (GST_VIDEO_FRAME_PLANE_DATA (video, 0), ri->last_frame,
+      GST_VIDEO_FRAME_SIZE (video));
+
+  return TRUE;
+}
+
+/* Keeps the frame that was just drawn to @video for the following ones */
+void
+gst_scope_render_interval_store (GstScopeRenderInterval * ri,
+    GstVideoFrame * video)
+{
+  gsize size = GST_VIDEO_FRAME_SIZE (video);
+
+  if (ri->interval <= 1) {
+    gst_scope_render_interval_reset (ri);
+    return;
+  }
+
+  if (!ri->last_frame) {
+    ri->last_frame = g_malloc (size);
+    ri->count = 1;
+  }
+  memcpy (ri->last_frame, GST_VIDEO_FRAME_PLANE_DATA (video, 0), size);
+}
+
+void
+gst_scope_render_interval_reset (GstScopeRenderInterval * ri)
+{
+  g_free (ri->last_frame);
+  ri->last_frame = NULL;
+  ri->count = 0;
+}
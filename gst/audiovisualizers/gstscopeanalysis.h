@@ -0,0 +1,69 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * gstscopeanalysis.h: spectrum analysis and frame pacing shared by the scopes
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_SCOPE_ANALYSIS_H__
+#define __GST_SCOPE_ANALYSIS_H__
+
+#include <gst/gst.h>
+#include <gst/fft/gstfft.h>
+#include <gst/fft/gstfftf32.h>
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstScopeAnalysis GstScopeAnalysis;
+
+GstScopeAnalysis * gst_scope_analysis_new (guint channels, guint rate,
+    guint size, GstFFTWindow window);
+void gst_scope_analysis_free (GstScopeAnalysis * analysis);
+
+void gst_scope_analysis_set_bands (GstScopeAnalysis * analysis,
+    guint n_bands, gfloat fmin, gfloat fmax);
+
+void gst_scope_analysis_process_s16 (GstScopeAnalysis * analysis,
+    const gint16 * data, guint n_frames);
+
+const GstFFTF32Complex * gst_scope_analysis_get_spectrum (
+    GstScopeAnalysis * analysis, guint channel);
+const gfloat * gst_scope_analysis_get_magnitudes (GstScopeAnalysis * analysis,
+    guint channel);
+const gfloat * gst_scope_analysis_get_bands (GstScopeAnalysis * analysis,
+    guint channel);
+
+typedef struct _GstScopeRenderInterval GstScopeRenderInterval;
+
+/* render-interval property of the scopes */
+struct _GstScopeRenderInterval
+{
+  guint interval;
+
+  guint count;
+  guint8 *last_frame;
+};
+
+gboolean gst_scope_render_interval_repeat (GstScopeRenderInterval * ri,
+    GstVideoFrame * video);
+void gst_scope_render_interval_store (GstScopeRenderInterval * ri,
+    GstVideoFrame * video);
+void gst_scope_render_interval_reset (GstScopeRenderInterval * ri);
+
+G_END_DECLS
+#endif /* __GST_SCOPE_ANALYSIS_H__ */
@@ -67,10 +67,13 @@ GST_STATIC_PAD_TEMPLATE ("sink",
 GST_DEBUG_CATEGORY_STATIC (space_scope_debug);
 #define GST_CAT_DEFAULT space_scope_debug
 
+#define DEFAULT_RENDER_INTERVAL 1
+
 enum
 {
   PROP_0,
-  PROP_STYLE
+  PROP_STYLE,
+  PROP_RENDER_INTERVAL
 };
 
 enum
@@ -106,6 +109,7 @@ static void gst_space_scope_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_space_scope_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
+static void gst_space_scope_finalize (GObject * object);
 
 static void render_dots (GstAudioVisualizer * base, guint32 * vdata,
     gint16 * adata, guint num_samples);
@@ -116,6 +120,7 @@ static void render_color_dots (GstAudioVisualizer * base, guint32 * vdata,
 static void render_color_lines (GstAudioVisualizer * base, guint32 * vdata,
     gint16 * adata, guint num_samples);
 
+static gboolean gst_space_scope_setup (GstAudioVisualizer * scope);
 static gboolean gst_space_scope_render (GstAudioVisualizer * scope,
     GstBuffer * audio, GstVideoFrame * video);
 
@@ -140,7 +145,9 @@ gst_space_scope_class_init (GstSpaceScopeClass * g_class)
 
   gobject_class->set_property = gst_space_scope_set_property;
   gobject_class->get_property = gst_space_scope_get_property;
+  gobject_class->finalize = gst_space_scope_finalize;
 
+  scope_class->setup = GST_DEBUG_FUNCPTR (gst_space_scope_setup);
   scope_class->render = GST_DEBUG_FUNCPTR (gst_space_scope_render);
 
   g_object_class_install_property (gobject_class, PROP_STYLE,
@@ -148,12 +155,45 @@ gst_space_scope_class_init (GstSpaceScopeClass * g_class)
           "Drawing styles for the space scope display.",
           GST_TYPE_SPACE_SCOPE_STYLE, STYLE_DOTS,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSpaceScope:render-interval:
+   *
+   * Only draw every Nth video frame, the frames in between repeat the last
+   * drawn one.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_RENDER_INTERVAL,
+      g_param_spec_uint ("render-interval", "Render interval",
+          "Draw every Nth video frame and repeat it in between", 1, G_MAXUINT,
+          DEFAULT_RENDER_INTERVAL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
 gst_space_scope_init (GstSpaceScope * scope)
 {
-  /* do nothing */
+  scope->render_interval.interval = DEFAULT_RENDER_INTERVAL;
+}
+
+static void
+gst_space_scope_finalize (GObject * object)
+{
+  GstSpaceScope *scope = GST_SPACE_SCOPE (object);
+
+  gst_scope_render_interval_reset (&scope->render_interval);
+
+  G_OBJECT_CLASS (gst_space_scope_parent_class)->finalize (object);
+}
+
+static gboolean
+gst_space_scope_setup (GstAudioVisualizer * bscope)
+{
+  GstSpaceScope *scope = GST_SPACE_SCOPE (bscope);
+
+  gst_scope_render_interval_reset (&scope->render_interval);
+
+  return TRUE;
 }
 
 static void
@@ -208,21 +248,22 @@ static void
 render_dots (GstAudioVisualizer * base, guint32 * vdata, gint16 * adata,
     guint num_samples)
 {
-  guint i, s, x, y, ox, oy;
+  guint i, n, ox, oy;
+  guint xs[64], ys[64];
   gfloat dx, dy;
   guint w = GST_VIDEO_INFO_WIDTH (&base->vinfo);
   guint h = GST_VIDEO_INFO_HEIGHT (&base->vinfo);
 
-  /* draw dots 1st channel x, 2nd channel y */
+  /* draw dots 1st channel x, 2nd channel y, a block of samples at a time */
   dx = w / 65536.0;
   ox = w / 2;
   dy = h / 65536.0;
   oy = h / 2;
-  s = 0;
-  for (i = 0; i < num_samples; i++) {
-    x = (guint) (ox + (gfloat) adata[s++] * dx);
-    y = (guint) (oy + (gfloat) adata[s++] * dy);
-    draw_dot (vdata, x, y, w, 0x00FFFFFF);
+  for (i = 0; i < num_samples; i += n) {
+    n = MIN (num_samples - i, G_N_ELEMENTS (xs));
+    scale_samples (xs, adata + 2 * i, 2, n, ox, dx);
+    scale_samples (ys, adata + 2 * i + 1, 2, n, oy, dy);
+    draw_dots (vdata, xs, ys, n, w, 0x00FFFFFF);
   }
 }
 
@@ -230,26 +271,30 @@ static void
 render_lines (GstAudioVisualizer * base, guint32 * vdata, gint16 * adata,
     guint num_samples)
 {
-  guint i, s, x, y, ox, oy;
+  guint i, j, n, ox, oy;
+  guint xs[64], ys[64];
   gfloat dx, dy;
   guint w = GST_VIDEO_INFO_WIDTH (&base->vinfo);
   guint h = GST_VIDEO_INFO_HEIGHT (&base->vinfo);
   gint x2, y2;
 
-  /* draw lines 1st channel x, 2nd channel y */
+  /* draw lines 1st channel x, 2nd channel y, the end points of a block of
+   * samples are computed at once */
   dx = (w - 1) / 65536.0;
   ox = (w - 1) / 2;
   dy = (h - 1) / 65536.0;
   oy = (h - 1) / 2;
-  s = 0;
-  x2 = (guint) (ox + (gfloat) adata[s++] * dx);
-  y2 = (guint) (oy + (gfloat) adata[s++] * dy);
-  for (i = 1; i < num_samples; i++) {
-    x = (guint) (ox + (gfloat) adata[s++] * dx);
-    y = (guint) (oy + (gfloat) adata[s++] * dy);
-    draw_line_aa (vdata, x2, x, y2, y, w, 0x00FFFFFF);
-    x2 = x;
-    y2 = y;
+  x2 = (guint) (ox + (gfloat) adata[0] * dx);
+  y2 = (guint) (oy + (gfloat) adata[1] * dy);
+  for (i = 1; i < num_samples; i += n) {
+    n = MIN (num_samples - i, G_N_ELEMENTS (xs));
+    scale_samples (xs, adata + 2 * i, 2, n, ox, dx);
+    scale_samples (ys, adata + 2 * i + 1, 2, n, oy, dy);
+    for (j = 0; j < n; j++) {
+      draw_line_aa (vdata, x2, xs[j], y2, ys[j], w, 0x00FFFFFF);
+      x2 = xs[j];
+      y2 = ys[j];
+    }
   }
 }
 
@@ -434,6 +479,9 @@ gst_space_scope_render (GstAudioVisualizer * base, GstBuffer * audio,
   GstMapInfo amap;
   guint num_samples;
 
+  if (gst_scope_render_interval_repeat (&scope->render_interval, video))
+    return TRUE;
+
   gst_buffer_map (audio, &amap, GST_MAP_READ);
 
   num_samples =
@@ -441,6 +489,8 @@ gst_space_scope_render (GstAudioVisualizer * base, GstBuffer * audio,
   scope->process (base, (guint32 *) GST_VIDEO_FRAME_PLANE_DATA (video, 0),
       (gint16 *) amap.data, num_samples);
   gst_buffer_unmap (audio, &amap);
+
+  gst_scope_render_interval_store (&scope->render_interval, video);
   return TRUE;
 }
 
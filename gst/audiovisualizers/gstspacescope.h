@@ -23,6 +23,7 @@
 #define __GST_SPACE_SCOPE_H__
 
 #include "gst/pbutils/gstaudiovisualizer.h"
+#include "gstscopeanalysis.h"
 
 G_BEGIN_DECLS
 #define GST_TYPE_SPACE_SCOPE            (gst_space_scope_get_type())
@@ -42,6 +43,7 @@ struct _GstSpaceScope
   /* < private > */
   GstSpaceScopeProcessFunc process;
   gint style;
+  GstScopeRenderInterval render_interval;
 
   /* filter specific data */
   gdouble f1l_l, f1l_m, f1l_h;
@@ -39,6 +39,7 @@
 #include <stdlib.h>
 
 #include "gstspectrascope.h"
+#include "gstdrawhelpers.h"
 
 #if G_BYTE_ORDER == G_BIG_ENDIAN
 #define RGB_ORDER "xRGB"
@@ -68,6 +69,23 @@ GST_STATIC_PAD_TEMPLATE ("sink",
 GST_DEBUG_CATEGORY_STATIC (spectra_scope_debug);
 #define GST_CAT_DEFAULT spectra_scope_debug
 
+#define DEFAULT_LOG_FREQUENCY FALSE
+#define DEFAULT_RENDER_INTERVAL 1
+
+/* lowest frequency of the log-frequency display */
+#define LOG_FREQUENCY_MIN 20.0
+
+enum
+{
+  PROP_0,
+  PROP_LOG_FREQUENCY,
+  PROP_RENDER_INTERVAL
+};
+
+static void gst_spectra_scope_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_spectra_scope_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static void gst_spectra_scope_finalize (GObject * object);
 
 static gboolean gst_spectra_scope_setup (GstAudioVisualizer * scope);
@@ -84,8 +102,36 @@ gst_spectra_scope_class_init (GstSpectraScopeClass * g_class)
   GstElementClass *element_class = (GstElementClass *) g_class;
   GstAudioVisualizerClass *scope_class = (GstAudioVisualizerClass *) g_class;
 
+  gobject_class->set_property = gst_spectra_scope_set_property;
+  gobject_class->get_property = gst_spectra_scope_get_property;
   gobject_class->finalize = gst_spectra_scope_finalize;
 
+  /**
+   * GstSpectraScope:log-frequency:
+   *
+   * Lay the frequencies out on a logarithmic scale instead of a linear one,
+   * each bar shows the loudest bin of its band.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_LOG_FREQUENCY,
+      g_param_spec_boolean ("log-frequency", "Log frequency",
+          "Use a logarithmic frequency scale", DEFAULT_LOG_FREQUENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSpectraScope:render-interval:
+   *
+   * Only analyse and draw every Nth video frame, the frames in between repeat
+   * the last drawn one.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_RENDER_INTERVAL,
+      g_param_spec_uint ("render-interval", "Render interval",
+          "Draw every Nth video frame and repeat it in between", 1, G_MAXUINT,
+          DEFAULT_RENDER_INTERVAL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class,
       "Frequency spectrum scope", "Visualization",
       "Simple frequency spectrum scope", "Stefan Kost <ensonic@users.sf.net>");
@@ -102,7 +148,8 @@ gst_spectra_scope_class_init (GstSpectraScopeClass * g_class)
 static void
 gst_spectra_scope_init (GstSpectraScope * scope)
 {
-  /* do nothing */
+  scope->log_frequency = DEFAULT_LOG_FREQUENCY;
+  scope->render_interval.interval = DEFAULT_RENDER_INTERVAL;
 }
 
 static void
@@ -110,122 +157,133 @@ gst_spectra_scope_finalize (GObject * object)
 {
   GstSpectraScope *scope = GST_SPECTRA_SCOPE (object);
 
-  if (scope->fft_ctx) {
-    gst_fft_s16_free (scope->fft_ctx);
-    scope->fft_ctx = NULL;
-  }
-  if (scope->freq_data) {
-    g_free (scope->freq_data);
-    scope->freq_data = NULL;
-  }
+  gst_scope_analysis_free (scope->analysis);
+  scope->analysis = NULL;
+  g_free (scope->bar_top);
+  scope->bar_top = NULL;
+  gst_scope_render_interval_reset (&scope->render_interval);
 
   G_OBJECT_CLASS (gst_spectra_scope_parent_class)->finalize (object);
 }
 
+static void
+gst_spectra_scope_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSpectraScope *scope = GST_SPECTRA_SCOPE (object);
+
+  switch (prop_id) {
+    case PROP_LOG_FREQUENCY:
+      scope->log_frequency = g_value_get_boolean (value);
+      break;
+    case PROP_RENDER_INTERVAL:
+      scope->render_interval.interval = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_spectra_scope_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSpectraScope *scope = GST_SPECTRA_SCOPE (object);
+
+  switch (prop_id) {
+    case PROP_LOG_FREQUENCY:
+      g_value_set_boolean (value, scope->log_frequency);
+      break;
+    case PROP_RENDER_INTERVAL:
+      g_value_set_uint (value, scope->render_interval.interval);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static gboolean
 gst_spectra_scope_setup (GstAudioVisualizer * bscope)
 {
   GstSpectraScope *scope = GST_SPECTRA_SCOPE (bscope);
-  guint num_freq = GST_VIDEO_INFO_WIDTH (&bscope->vinfo) + 1;
+  guint w = GST_VIDEO_INFO_WIDTH (&bscope->vinfo);
 
-  if (scope->fft_ctx)
-    gst_fft_s16_free (scope->fft_ctx);
-  g_free (scope->freq_data);
+  gst_scope_analysis_free (scope->analysis);
+  g_free (scope->bar_top);
+  gst_scope_render_interval_reset (&scope->render_interval);
 
   /* we'd need this amount of samples per render() call */
-  bscope->req_spf = num_freq * 2 - 2;
-  scope->fft_ctx = gst_fft_s16_new (bscope->req_spf, FALSE);
-  scope->freq_data = g_new (GstFFTS16Complex, num_freq);
+  bscope->req_spf = w * 2;
+  scope->analysis =
+      gst_scope_analysis_new (GST_AUDIO_INFO_CHANNELS (&bscope->ainfo),
+      GST_AUDIO_INFO_RATE (&bscope->ainfo), bscope->req_spf,
+      GST_FFT_WINDOW_HAMMING);
+  scope->bands_log_frequency = FALSE;
+  scope->bar_top = g_new (guint, w);
 
   return TRUE;
 }
 
-static inline void
-add_pixel (guint32 * _p, guint32 _c)
-{
-  guint8 *p = (guint8 *) _p;
-  guint8 *c = (guint8 *) & _c;
-
-  if (p[0] < 255 - c[0])
-    p[0] += c[0];
-  else
-    p[0] = 255;
-  if (p[1] < 255 - c[1])
-    p[1] += c[1];
-  else
-    p[1] = 255;
-  if (p[2] < 255 - c[2])
-    p[2] += c[2];
-  else
-    p[2] = 255;
-  if (p[3] < 255 - c[3])
-    p[3] += c[3];
-  else
-    p[3] = 255;
-}
-
 static gboolean
 gst_spectra_scope_render (GstAudioVisualizer * bscope, GstBuffer * audio,
     GstVideoFrame * video)
 {
   GstSpectraScope *scope = GST_SPECTRA_SCOPE (bscope);
-  gint16 *mono_adata;
-  GstFFTS16Complex *fdata = scope->freq_data;
-  guint x, y, off, l;
+  GstScopeAnalysis *analysis = scope->analysis;
+  const gfloat **mag;
+  guint x, y, c;
   guint w = GST_VIDEO_INFO_WIDTH (&bscope->vinfo);
   guint h = GST_VIDEO_INFO_HEIGHT (&bscope->vinfo) - 1;
-  gfloat fr, fi;
+  gfloat m, scale;
   GstMapInfo amap;
   guint32 *vdata;
-  gint channels;
+  guint channels;
+
+  if (gst_scope_render_interval_repeat (&scope->render_interval, video))
+    return TRUE;
 
-  gst_buffer_map (audio, &amap, GST_MAP_READ);
   vdata = (guint32 *) GST_VIDEO_FRAME_PLANE_DATA (video, 0);
 
   channels = GST_AUDIO_INFO_CHANNELS (&bscope->ainfo);
 
-  mono_adata = (gint16 *) g_memdup (amap.data, amap.size);
-
-  if (channels > 1) {
-    guint ch = channels;
-    guint num_samples = amap.size / (ch * sizeof (gint16));
-    guint i, c, v, s = 0;
-
-    /* deinterleave and mixdown adata */
-    for (i = 0; i < num_samples; i++) {
-      v = 0;
-      for (c = 0; c < ch; c++) {
-        v += mono_adata[s++];
-      }
-      mono_adata[i] = v / ch;
-    }
+  if (scope->log_frequency != scope->bands_log_frequency) {
+    if (scope->log_frequency)
+      gst_scope_analysis_set_bands (analysis, w, LOG_FREQUENCY_MIN,
+          GST_AUDIO_INFO_RATE (&bscope->ainfo) / 2.0);
+    else
+      gst_scope_analysis_set_bands (analysis, 0, 0.0, 0.0);
+    scope->bands_log_frequency = scope->log_frequency;
   }
 
-  /* run fft */
-  gst_fft_s16_window (scope->fft_ctx, mono_adata, GST_FFT_WINDOW_HAMMING);
-  gst_fft_s16_fft (scope->fft_ctx, mono_adata, fdata);
-  g_free (mono_adata);
+  gst_buffer_map (audio, &amap, GST_MAP_READ);
+  gst_scope_analysis_process_s16 (analysis, (const gint16 *) amap.data,
+      amap.size / (channels * sizeof (gint16)));
+  gst_buffer_unmap (audio, &amap);
+
+  /* the bins start at DC, which is not drawn */
+  mag = g_newa (const gfloat *, channels);
+  for (c = 0; c < channels; c++) {
+    if (scope->log_frequency)
+      mag[c] = gst_scope_analysis_get_bands (analysis, c);
+    else
+      mag[c] = gst_scope_analysis_get_magnitudes (analysis, c) + 1;
+  }
 
-  /* draw lines */
+  /* average of the channels, a sine at about -25 dBFS fills the height */
+  scale = h * 64.0 / channels;
   for (x = 0; x < w; x++) {
-    /* figure out the range so that we don't need to clip,
-     * or even better do a log mapping? */
-    fr = (gfloat) fdata[1 + x].r / 512.0;
-    fi = (gfloat) fdata[1 + x].i / 512.0;
-    y = (guint) (h * sqrt (fr * fr + fi * fi));
-    if (y > h)
-      y = h;
-    y = h - y;
-    off = (y * w) + x;
-    vdata[off] = 0x00FFFFFF;
-    for (l = y; l < h; l++) {
-      off += w;
-      add_pixel (&vdata[off], 0x007F7F7F);
-    }
-    /* ensure bottom line is full bright (especially in move-up mode) */
-    add_pixel (&vdata[off], 0x007F7F7F);
+    for (m = 0.0, c = 0; c < channels; c++)
+      m += mag[c][x];
+    y = (guint) MIN (m * scale, h);
+    scope->bar_top[x] = h - y;
   }
-  gst_buffer_unmap (audio, &amap);
+
+  draw_bars (vdata, w, h, scope->bar_top, 0x00FFFFFF, 0x007F7F7F);
+
+  gst_scope_render_interval_store (&scope->render_interval, video);
+
   return TRUE;
 }
 
@@ -37,6 +37,7 @@
 #endif
 
 #include "gstsynaescope.h"
+#include "gstdrawhelpers.h"
 
 #if G_BYTE_ORDER == G_BIG_ENDIAN
 #define RGB_ORDER "xRGB"
@@ -66,6 +67,18 @@ GST_STATIC_PAD_TEMPLATE ("sink",
 GST_DEBUG_CATEGORY_STATIC (synae_scope_debug);
 #define GST_CAT_DEFAULT synae_scope_debug
 
+#define DEFAULT_RENDER_INTERVAL 1
+
+enum
+{
+  PROP_0,
+  PROP_RENDER_INTERVAL
+};
+
+static void gst_synae_scope_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_synae_scope_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static void gst_synae_scope_finalize (GObject * object);
 
 static gboolean gst_synae_scope_setup (GstAudioVisualizer * scope);
@@ -82,8 +95,23 @@ gst_synae_scope_class_init (GstSynaeScopeClass * g_class)
   GstElementClass *element_class = (GstElementClass *) g_class;
   GstAudioVisualizerClass *scope_class = (GstAudioVisualizerClass *) g_class;
 
+  gobject_class->set_property = gst_synae_scope_set_property;
+  gobject_class->get_property = gst_synae_scope_get_property;
   gobject_class->finalize = gst_synae_scope_finalize;
 
+  /**
+   * GstSynaeScope:render-interval:
+   *
+   * Only draw every Nth video frame, the frames in between repeat the last
+   * drawn one.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_RENDER_INTERVAL,
+      g_param_spec_uint ("render-interval", "Render interval",
+          "Draw every Nth video frame and repeat it in between", 1, G_MAXUINT,
+          DEFAULT_RENDER_INTERVAL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class, "Synaescope",
       "Visualization",
       "Creates video visualizations of audio input, using stereo and pitch information",
@@ -120,6 +148,8 @@ gst_synae_scope_init (GstSynaeScope * scope)
 
   for (i = 0; i < 256; i++)
     shade[i] = i * 200 >> 8;
+
+  scope->render_interval.interval = DEFAULT_RENDER_INTERVAL;
 }
 
 static void
@@ -127,81 +157,66 @@ gst_synae_scope_finalize (GObject * object)
 {
   GstSynaeScope *scope = GST_SYNAE_SCOPE (object);
 
-  if (scope->fft_ctx) {
-    gst_fft_s16_free (scope->fft_ctx);
-    scope->fft_ctx = NULL;
-  }
-  if (scope->freq_data_l) {
-    g_free (scope->freq_data_l);
-    scope->freq_data_l = NULL;
-  }
-  if (scope->freq_data_r) {
-    g_free (scope->freq_data_r);
-    scope->freq_data_r = NULL;
-  }
-  if (scope->adata_l) {
-    g_free (scope->adata_l);
-    scope->adata_l = NULL;
-  }
-  if (scope->adata_r) {
-    g_free (scope->adata_r);
-    scope->adata_r = NULL;
-  }
+  gst_scope_analysis_free (scope->analysis);
+  scope->analysis = NULL;
+  gst_scope_render_interval_reset (&scope->render_interval);
 
   G_OBJECT_CLASS (gst_synae_scope_parent_class)->finalize (object);
 }
 
+static void
+gst_synae_scope_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSynaeScope *scope = GST_SYNAE_SCOPE (object);
+
+  switch (prop_id) {
+    case PROP_RENDER_INTERVAL:
+      scope->render_interval.interval = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_synae_scope_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSynaeScope *scope = GST_SYNAE_SCOPE (object);
+
+  switch (prop_id) {
+    case PROP_RENDER_INTERVAL:
+      g_value_set_uint (value, scope->render_interval.interval);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static gboolean
 gst_synae_scope_setup (GstAudioVisualizer * bscope)
 {
   GstSynaeScope *scope = GST_SYNAE_SCOPE (bscope);
   guint num_freq = GST_VIDEO_INFO_HEIGHT (&bscope->vinfo) + 1;
 
-  if (scope->fft_ctx)
-    gst_fft_s16_free (scope->fft_ctx);
-  g_free (scope->freq_data_l);
-  g_free (scope->freq_data_r);
-  g_free (scope->adata_l);
-  g_free (scope->adata_r);
+  gst_scope_analysis_free (scope->analysis);
+  gst_scope_render_interval_reset (&scope->render_interval);
 
   /* FIXME: we could have horizontal or vertical layout */
 
   /* we'd need this amount of samples per render() call */
   bscope->req_spf = num_freq * 2 - 2;
-  scope->fft_ctx = gst_fft_s16_new (bscope->req_spf, FALSE);
-  scope->freq_data_l = g_new (GstFFTS16Complex, num_freq);
-  scope->freq_data_r = g_new (GstFFTS16Complex, num_freq);
-
-  scope->adata_l = g_new (gint16, bscope->req_spf);
-  scope->adata_r = g_new (gint16, bscope->req_spf);
+  scope->analysis =
+      gst_scope_analysis_new (GST_AUDIO_INFO_CHANNELS (&bscope->ainfo),
+      GST_AUDIO_INFO_RATE (&bscope->ainfo), bscope->req_spf,
+      GST_FFT_WINDOW_RECTANGULAR);
 
   return TRUE;
 }
 
-static inline void
-add_pixel (guint32 * _p, guint32 _c)
-{
-  guint8 *p = (guint8 *) _p;
-  guint8 *c = (guint8 *) & _c;
-
-  if (p[0] < 255 - c[0])
-    p[0] += c[0];
-  else
-    p[0] = 255;
-  if (p[1] < 255 - c[1])
-    p[1] += c[1];
-  else
-    p[1] = 255;
-  if (p[2] < 255 - c[2])
-    p[2] += c[2];
-  else
-    p[2] = 255;
-  if (p[3] < 255 - c[3])
-    p[3] += c[3];
-  else
-    p[3] = 255;
-}
-
 static gboolean
 gst_synae_scope_render (GstAudioVisualizer * bscope, GstBuffer * audio,
     GstVideoFrame * video)
@@ -209,11 +224,7 @@ gst_synae_scope_render (GstAudioVisualizer * bscope, GstBuffer * audio,
   GstSynaeScope *scope = GST_SYNAE_SCOPE (bscope);
   GstMapInfo amap;
   guint32 *vdata;
-  gint16 *adata;
-  gint16 *adata_l = scope->adata_l;
-  gint16 *adata_r = scope->adata_r;
-  GstFFTS16Complex *fdata_l = scope->freq_data_l;
-  GstFFTS16Complex *fdata_r = scope->freq_data_r;
+  const GstFFTF32Complex *fdata_l, *fdata_r;
   gint x, y;
   guint off;
   guint w = GST_VIDEO_INFO_WIDTH (&bscope->vinfo);
@@ -223,39 +234,35 @@ gst_synae_scope_render (GstAudioVisualizer * bscope, GstBuffer * audio,
   //guint w2 = w /2;
   guint ch = GST_AUDIO_INFO_CHANNELS (&bscope->ainfo);
   guint num_samples;
-  gint i, j, b;
+  gint i, b;
   gint br, br1, br2;
   gint clarity;
   gdouble fc, r, l, rr, ll;
   gdouble frl, fil, frr, fir;
   const guint sl = 30;
 
+  if (gst_scope_render_interval_repeat (&scope->render_interval, video))
+    return TRUE;
+
   gst_buffer_map (audio, &amap, GST_MAP_READ);
 
   vdata = (guint32 *) GST_VIDEO_FRAME_PLANE_DATA (video, 0);
-  adata = (gint16 *) amap.data;
 
   num_samples = amap.size / (ch * sizeof (gint16));
 
-  /* deinterleave */
-  for (i = 0, j = 0; i < num_samples; i++) {
-    adata_l[i] = adata[j++];
-    adata_r[i] = adata[j++];
-  }
-
   /* run fft */
-  /*gst_fft_s16_window (scope->fft_ctx, adata_l, GST_FFT_WINDOW_HAMMING); */
-  gst_fft_s16_fft (scope->fft_ctx, adata_l, fdata_l);
-  /*gst_fft_s16_window (scope->fft_ctx, adata_r, GST_FFT_WINDOW_HAMMING); */
-  gst_fft_s16_fft (scope->fft_ctx, adata_r, fdata_r);
+  gst_scope_analysis_process_s16 (scope->analysis, (const gint16 *) amap.data,
+      num_samples);
+  fdata_l = gst_scope_analysis_get_spectrum (scope->analysis, 0);
+  fdata_r = gst_scope_analysis_get_spectrum (scope->analysis, 1);
 
-  /* draw stars */
+  /* draw stars, the spectrum is scaled to 16 bit sample values */
   for (y = 0; y < h; y++) {
     b = h - y;
-    frl = (gdouble) fdata_l[b].r;
-    fil = (gdouble) fdata_l[b].i;
-    frr = (gdouble) fdata_r[b].r;
-    fir = (gdouble) fdata_r[b].i;
+    frl = fdata_l[b].r * 32768.0;
+    fil = fdata_l[b].i * 32768.0;
+    frr = fdata_r[b].r * 32768.0;
+    fir = fdata_r[b].i * 32768.0;
 
     ll = (frl + fil) * (frl + fil) + (frr - fir) * (frr - fir);
     l = sqrt (ll);
@@ -307,6 +314,8 @@ gst_synae_scope_render (GstAudioVisualizer * bscope, GstBuffer * audio,
   }
   gst_buffer_unmap (audio, &amap);
 
+  gst_scope_render_interval_store (&scope->render_interval, video);
+
   return TRUE;
 }
 
@@ -23,7 +23,7 @@
 #define __GST_SYNAE_SCOPE_H__
 
 #include "gst/pbutils/gstaudiovisualizer.h"
-#include <gst/fft/gstffts16.h>
+#include "gstscopeanalysis.h"
 
 G_BEGIN_DECLS
 #define GST_TYPE_SYNAE_SCOPE            (gst_synae_scope_get_type())
@@ -38,9 +38,8 @@ struct _GstSynaeScope
 {
   GstAudioVisualizer parent;
 
-  GstFFTS16 *fft_ctx;
-  GstFFTS16Complex *freq_data_l, *freq_data_r;
-  gint16 *adata_l, *adata_r;
+  GstScopeAnalysis *analysis;
+  GstScopeRenderInterval render_interval;
 
   guint32 colors[256];
   guint shade[256];
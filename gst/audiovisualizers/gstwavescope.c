@@ -67,10 +67,13 @@ GST_STATIC_PAD_TEMPLATE ("sink",
 GST_DEBUG_CATEGORY_STATIC (wave_scope_debug);
 #define GST_CAT_DEFAULT wave_scope_debug
 
+#define DEFAULT_RENDER_INTERVAL 1
+
 enum
 {
   PROP_0,
-  PROP_STYLE
+  PROP_STYLE,
+  PROP_RENDER_INTERVAL
 };
 
 enum
@@ -144,6 +147,19 @@ gst_wave_scope_class_init (GstWaveScopeClass * g_class)
           GST_TYPE_WAVE_SCOPE_STYLE, STYLE_DOTS,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstWaveScope:render-interval:
+   *
+   * Only draw every Nth video frame, the frames in between repeat the last
+   * drawn one.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_RENDER_INTERVAL,
+      g_param_spec_uint ("render-interval", "Render interval",
+          "Draw every Nth video frame and repeat it in between", 1, G_MAXUINT,
+          DEFAULT_RENDER_INTERVAL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Waveform oscilloscope", "Visualization", "Simple waveform oscilloscope",
       "Stefan Kost <ensonic@users.sf.net>");
@@ -157,7 +173,7 @@ gst_wave_scope_class_init (GstWaveScopeClass * g_class)
 static void
 gst_wave_scope_init (GstWaveScope * scope)
 {
-  /* do nothing */
+  scope->render_interval.interval = DEFAULT_RENDER_INTERVAL;
 }
 
 static void
@@ -169,6 +185,7 @@ gst_wave_scope_finalize (GObject * object)
     g_free (scope->flt);
     scope->flt = NULL;
   }
+  gst_scope_render_interval_reset (&scope->render_interval);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -181,6 +198,7 @@ gst_wave_scope_setup (GstAudioVisualizer * bscope)
   g_free (scope->flt);
 
   scope->flt = g_new0 (gdouble, 6 * GST_AUDIO_INFO_CHANNELS (&bscope->ainfo));
+  gst_scope_render_interval_reset (&scope->render_interval);
 
   return TRUE;
 }
@@ -209,6 +227,9 @@ gst_wave_scope_set_property (GObject * object, guint prop_id,
           break;
       }
       break;
+    case PROP_RENDER_INTERVAL:
+      scope->render_interval.interval = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -225,6 +246,9 @@ gst_wave_scope_get_property (GObject * object, guint prop_id,
     case PROP_STYLE:
       g_value_set_enum (value, scope->style);
       break;
+    case PROP_RENDER_INTERVAL:
+      g_value_set_uint (value, scope->render_interval.interval);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -238,22 +262,22 @@ render_dots (GstAudioVisualizer * base, guint32 * vdata, gint16 * adata,
     guint num_samples)
 {
   gint channels = GST_AUDIO_INFO_CHANNELS (&base->ainfo);
-  guint i, c, s, x, y, oy;
+  guint i, c, n, oy;
+  guint xs[64], ys[64];
   gfloat dx, dy;
   guint w = GST_VIDEO_INFO_WIDTH (&base->vinfo);
   guint h = GST_VIDEO_INFO_HEIGHT (&base->vinfo);
 
-  /* draw dots */
+  /* draw dots, a block of samples at a time */
   dx = (gfloat) w / (gfloat) num_samples;
   dy = h / 65536.0;
   oy = h / 2;
   for (c = 0; c < channels; c++) {
-    s = c;
-    for (i = 0; i < num_samples; i++) {
-      x = (guint) ((gfloat) i * dx);
-      y = (guint) (oy + (gfloat) adata[s] * dy);
-      s += channels;
-      draw_dot (vdata, x, y, w, 0x00FFFFFF);
+    for (i = 0; i < num_samples; i += n) {
+      n = MIN (num_samples - i, G_N_ELEMENTS (xs));
+      scale_positions (xs, i, n, dx);
+      scale_samples (ys, adata + i * channels + c, channels, n, oy, dy);
+      draw_dots (vdata, xs, ys, n, w, 0x00FFFFFF);
     }
   }
 }
@@ -263,27 +287,30 @@ render_lines (GstAudioVisualizer * base, guint32 * vdata, gint16 * adata,
     guint num_samples)
 {
   gint channels = GST_AUDIO_INFO_CHANNELS (&base->ainfo);
-  guint i, c, s, x, y, oy;
+  guint i, j, c, n, oy;
+  guint xs[64], ys[64];
   gfloat dx, dy;
   guint w = GST_VIDEO_INFO_WIDTH (&base->vinfo);
   guint h = GST_VIDEO_INFO_HEIGHT (&base->vinfo);
   gint x2, y2;
 
-  /* draw lines */
+  /* draw lines, the end points of a block of samples are computed at once.
+   * The point at position i uses sample i - 1 */
   dx = (gfloat) (w - 1) / (gfloat) num_samples;
   dy = (h - 1) / 65536.0;
   oy = (h - 1) / 2;
   for (c = 0; c < channels; c++) {
-    s = c;
     x2 = 0;
-    y2 = (guint) (oy + (gfloat) adata[s] * dy);
-    for (i = 1; i < num_samples; i++) {
-      x = (guint) ((gfloat) i * dx);
-      y = (guint) (oy + (gfloat) adata[s] * dy);
-      s += channels;
-      draw_line_aa (vdata, x2, x, y2, y, w, 0x00FFFFFF);
-      x2 = x;
-      y2 = y;
+    y2 = (guint) (oy + (gfloat) adata[c] * dy);
+    for (i = 1; i < num_samples; i += n) {
+      n = MIN (num_samples - i, G_N_ELEMENTS (xs));
+      scale_positions (xs, i, n, dx);
+      scale_samples (ys, adata + (i - 1) * channels + c, channels, n, oy, dy);
+      for (j = 0; j < n; j++) {
+        draw_line_aa (vdata, x2, xs[j], y2, ys[j], w, 0x00FFFFFF);
+        x2 = xs[j];
+        y2 = ys[j];
+      }
     }
   }
 }
@@ -410,6 +437,9 @@ gst_wave_scope_render (GstAudioVisualizer * base, GstBuffer * audio,
   guint num_samples;
   gint channels = GST_AUDIO_INFO_CHANNELS (&base->ainfo);
 
+  if (gst_scope_render_interval_repeat (&scope->render_interval, video))
+    return TRUE;
+
   gst_buffer_map (audio, &amap, GST_MAP_READ);
 
   num_samples = amap.size / (channels * sizeof (gint16));
@@ -418,6 +448,8 @@ gst_wave_scope_render (GstAudioVisualizer * base, GstBuffer * audio,
 
   gst_buffer_unmap (audio, &amap);
 
+  gst_scope_render_interval_store (&scope->render_interval, video);
+
   return TRUE;
 }
 
@@ -23,6 +23,7 @@
 #define __GST_WAVE_SCOPE_H__
 
 #include "gst/pbutils/gstaudiovisualizer.h"
+#include "gstscopeanalysis.h"
 
 G_BEGIN_DECLS
 #define GST_TYPE_WAVE_SCOPE            (gst_wave_scope_get_type())
@@ -42,6 +43,7 @@ struct _GstWaveScope
   /* < private > */
   GstWaveScopeProcessFunc process;
   gint style;
+  GstScopeRenderInterval render_interval;
 
   /* filter specific data */
   gdouble *flt;
@@ -26,6 +26,14 @@
  * @title: bayer2rgb
  *
  * Decodes raw camera bayer (fourcc BA81) to RGB.
+ *
+ * 8 bit input is interpolated bilinearly with ORC kernels when converting
+ * to 32 bit RGB.  10 to 16 bit little endian input (e.g. format=bggr12le),
+ * the higher quality #GstBayer2RGB:method=malvar, and direct I420, NV12 and
+ * 16 bit ARGB64 output go through a generic C implementation instead.
+ *
+ * In both cases the picture is split in horizontal bands that are processed
+ * in parallel, see #GstBayer2RGB:n-threads.
  */
 
 /*
@@ -87,6 +95,7 @@
 #endif
 
 #include "gstbayerorc.h"
+#include "gstbayerdemosaic.h"
 
 #define GST_CAT_DEFAULT gst_bayer2rgb_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
@@ -111,6 +120,17 @@ typedef struct _GstBayer2RGBClass GstBayer2RGBClass;
 
 typedef void (*GstBayer2RGBProcessFunc) (GstBayer2RGB *, guint8 *, guint);
 
+/* a horizontal slice of the picture, processed by one thread */
+typedef struct
+{
+  GstBayer2RGB *filter;
+  const guint8 *src;
+  GstVideoFrame *frame;
+  int y0;
+  int y1;
+  gpointer scratch;
+} GstBayer2RGBBand;
+
 struct _GstBayer2RGB
 {
   GstBaseTransform basetransform;
@@ -122,7 +142,27 @@ struct _GstBayer2RGB
   int r_off;                    /* offset for red */
   int g_off;                    /* offset for green */
   int b_off;                    /* offset for blue */
+  int a_off;                    /* offset for alpha/padding */
   int format;
+  int depth;                    /* bits per bayer sample */
+  int src_stride;
+
+  /* TRUE when the ORC kernels can be used */
+  gboolean orc_path;
+  GstBayerDemosaicParams params;
+  /* RGB to YUV in 8.8 fixed point, last column is the rounded offset */
+  gint yuv_matrix[3][4];
+
+  GstBayer2RGBBand *bands;
+  guint n_bands;
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+  guint pending;
+
+  /* properties */
+  GstBayerDemosaicMethod method;
+  guint n_threads;
 };
 
 struct _GstBayer2RGBClass
@@ -131,21 +171,50 @@ struct _GstBayer2RGBClass
 };
 
 #define	SRC_CAPS                                 \
-  GST_VIDEO_CAPS_MAKE ("{ RGBx, xRGB, BGRx, xBGR, RGBA, ARGB, BGRA, ABGR }")
+  GST_VIDEO_CAPS_MAKE ("{ RGBx, xRGB, BGRx, xBGR, RGBA, ARGB, BGRA, ABGR, " \
+      "ARGB64, I420, NV12 }")
 
-#define SINK_CAPS "video/x-bayer,format=(string){bggr,grbg,gbrg,rggb}," \
+#define SINK_CAPS "video/x-bayer,format=(string){bggr,grbg,gbrg,rggb," \
+  "bggr10le,grbg10le,gbrg10le,rggb10le,bggr12le,grbg12le,gbrg12le,rggb12le," \
+  "bggr14le,grbg14le,gbrg14le,rggb14le,bggr16le,grbg16le,gbrg16le,rggb16le}," \
   "width=(int)[1,MAX],height=(int)[1,MAX],framerate=(fraction)[0/1,MAX]"
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_METHOD,
+  PROP_N_THREADS
 };
 
+#define DEFAULT_METHOD           GST_BAYER_DEMOSAIC_BILINEAR
+#define DEFAULT_N_THREADS        0
+
+#define GST_TYPE_BAYER2RGB_METHOD (gst_bayer2rgb_method_get_type())
+static GType
+gst_bayer2rgb_method_get_type (void)
+{
+  static GType method_type = 0;
+
+  static const GEnumValue method_types[] = {
+    {GST_BAYER_DEMOSAIC_BILINEAR, "Bilinear interpolation", "bilinear"},
+    {GST_BAYER_DEMOSAIC_MALVAR,
+        "Gradient-corrected linear interpolation (Malvar-He-Cutler)",
+        "malvar"},
+    {0, NULL, NULL}
+  };
+
+  if (!method_type) {
+    method_type = g_enum_register_static ("GstBayer2RGBMethod", method_types);
+  }
+  return method_type;
+}
+
 GType gst_bayer2rgb_get_type (void);
 
 #define gst_bayer2rgb_parent_class parent_class
 G_DEFINE_TYPE (GstBayer2RGB, gst_bayer2rgb, GST_TYPE_BASE_TRANSFORM);
 
+static void gst_bayer2rgb_finalize (GObject * object);
 static void gst_bayer2rgb_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_bayer2rgb_get_property (GObject * object, guint prop_id,
@@ -160,6 +229,7 @@ static GstCaps *gst_bayer2rgb_transform_caps (GstBaseTransform * base,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter);
 static gboolean gst_bayer2rgb_get_unit_size (GstBaseTransform * base,
     GstCaps * caps, gsize * size);
+static void gst_bayer2rgb_band_func (gpointer data, gpointer user_data);
 
 
 static void
@@ -171,9 +241,25 @@ gst_bayer2rgb_class_init (GstBayer2RGBClass * klass)
   gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
 
+  gobject_class->finalize = gst_bayer2rgb_finalize;
   gobject_class->set_property = gst_bayer2rgb_set_property;
   gobject_class->get_property = gst_bayer2rgb_get_property;
 
+  g_object_class_install_property (gobject_class, PROP_METHOD,
+      g_param_spec_enum ("method", "Method", "Demosaicing method",
+          GST_TYPE_BAYER2RGB_METHOD, DEFAULT_METHOD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBayer2RGB:n-threads:
+   *
+   * Number of threads to split the picture over, 0 for one per CPU.
+   * Changes apply on the next caps change.
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Number of threads to use (0 = one per CPU)", 0, G_MAXINT,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Bayer to RGB decoder for cameras", "Filter/Converter/Video",
       "Converts video/x-bayer to video/x-raw",
@@ -202,17 +288,61 @@ gst_bayer2rgb_class_init (GstBayer2RGBClass * klass)
 static void
 gst_bayer2rgb_init (GstBayer2RGB * filter)
 {
+  g_mutex_init (&filter->lock);
+  g_cond_init (&filter->cond);
+  filter->method = DEFAULT_METHOD;
+  filter->n_threads = DEFAULT_N_THREADS;
+
   gst_bayer2rgb_reset (filter);
   gst_base_transform_set_in_place (GST_BASE_TRANSFORM (filter), TRUE);
 }
 
-/* No properties are implemented, so only a warning is produced */
+static void
+gst_bayer2rgb_free_bands (GstBayer2RGB * filter)
+{
+  guint i;
+
+  if (filter->pool) {
+    g_thread_pool_free (filter->pool, FALSE, TRUE);
+    filter->pool = NULL;
+  }
+
+  for (i = 0; i < filter->n_bands; i++)
+    g_free (filter->bands[i].scratch);
+  g_free (filter->bands);
+  filter->bands = NULL;
+  filter->n_bands = 0;
+}
+
+static void
+gst_bayer2rgb_finalize (GObject * object)
+{
+  GstBayer2RGB *filter = GST_BAYER2RGB (object);
+
+  gst_bayer2rgb_free_bands (filter);
+  g_mutex_clear (&filter->lock);
+  g_cond_clear (&filter->cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_bayer2rgb_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
+  GstBayer2RGB *filter = GST_BAYER2RGB (object);
 
   switch (prop_id) {
+    case PROP_METHOD:
+      GST_OBJECT_LOCK (filter);
+      filter->method = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (filter);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      filter->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -223,14 +353,139 @@ static void
 gst_bayer2rgb_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
 {
+  GstBayer2RGB *filter = GST_BAYER2RGB (object);
 
   switch (prop_id) {
+    case PROP_METHOD:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_enum (value, filter->method);
+      GST_OBJECT_UNLOCK (filter);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_uint (value, filter->n_threads);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* parses bggr, bggr10le, ... into the pattern and the bit depth */
+static gboolean
+gst_bayer2rgb_parse_format (const gchar * format, int *pattern, int *depth)
+{
+  static const gchar *patterns[] = { "bggr", "gbrg", "grbg", "rggb" };
+  gchar *end = NULL;
+  guint64 bits;
+  int i;
+
+  if (format == NULL)
+    return FALSE;
+
+  for (i = 0; i < G_N_ELEMENTS (patterns); i++) {
+    if (g_str_has_prefix (format, patterns[i]))
+      break;
+  }
+  if (i == G_N_ELEMENTS (patterns))
+    return FALSE;
+  *pattern = i;
+
+  if (format[4] == '\0') {
+    *depth = 8;
+    return TRUE;
+  }
+
+  bits = g_ascii_strtoull (format + 4, &end, 10);
+  if (bits < 10 || bits > 16 || end == NULL || strcmp (end, "le") != 0)
+    return FALSE;
+  *depth = bits;
+
+  return TRUE;
+}
+
+static void
+gst_bayer2rgb_setup_yuv_matrix (GstBayer2RGB * filter)
+{
+  GstVideoColorimetry *cinfo = &GST_VIDEO_INFO_COLORIMETRY (&filter->info);
+  gdouble Kr, Kb, Kg, ys, cs, yo;
+  gdouble m[3][3];
+  int i, j;
+
+  if (!gst_video_color_matrix_get_Kr_Kb (cinfo->matrix, &Kr, &Kb)) {
+    Kr = 0.299;
+    Kb = 0.114;
+  }
+  Kg = 1.0 - Kr - Kb;
+
+  if (cinfo->range == GST_VIDEO_COLOR_RANGE_0_255) {
+    ys = cs = 1.0;
+    yo = 0;
+  } else {
+    ys = 219.0 / 255.0;
+    cs = 224.0 / 255.0;
+    yo = 16;
+  }
+
+  m[0][0] = Kr * ys;
+  m[0][1] = Kg * ys;
+  m[0][2] = Kb * ys;
+  m[1][0] = -Kr / (2 * (1 - Kb)) * cs;
+  m[1][1] = -Kg / (2 * (1 - Kb)) * cs;
+  m[1][2] = 0.5 * cs;
+  m[2][0] = 0.5 * cs;
+  m[2][1] = -Kg / (2 * (1 - Kr)) * cs;
+  m[2][2] = -Kb / (2 * (1 - Kr)) * cs;
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++)
+      filter->yuv_matrix[i][j] = (gint) (m[i][j] * 256 + (m[i][j] < 0 ? -0.5 :
+              0.5));
+    /* offsets keep every sum positive, so a plain shift rounds correctly */
+    filter->yuv_matrix[i][3] = ((i == 0 ? (gint) yo : 128) << 8) + 128;
+  }
+}
+
+/* (re)allocates one band per thread with the scratch memory both
+ * processing paths need */
+static void
+gst_bayer2rgb_setup_bands (GstBayer2RGB * filter)
+{
+  guint n_bands, i;
+  gsize scratch_size;
+
+  GST_OBJECT_LOCK (filter);
+  n_bands = filter->n_threads;
+  GST_OBJECT_UNLOCK (filter);
+  if (n_bands == 0)
+    n_bands = g_get_num_processors ();
+  /* bands are aligned to pairs of rows */
+  n_bands = CLAMP (n_bands, 1, MAX (filter->height / 2, 1));
+
+  gst_bayer2rgb_free_bands (filter);
+
+  if (n_bands > 1) {
+    filter->pool = g_thread_pool_new (gst_bayer2rgb_band_func, filter,
+        n_bands - 1, TRUE, NULL);
+    if (filter->pool == NULL)
+      n_bands = 1;
+  }
+
+  scratch_size = MAX (8 * filter->width,
+      (gst_bayer_demosaic_scratch_size (&filter->params) +
+          6 * filter->width) * sizeof (guint16));
+
+  filter->bands = g_new0 (GstBayer2RGBBand, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    filter->bands[i].filter = filter;
+    filter->bands[i].scratch = g_malloc (scratch_size);
+  }
+  filter->n_bands = n_bands;
+
+  GST_DEBUG_OBJECT (filter, "processing in %u bands", n_bands);
+}
+
 static gboolean
 gst_bayer2rgb_set_caps (GstBaseTransform * base, GstCaps * incaps,
     GstCaps * outcaps)
@@ -249,26 +504,50 @@ gst_bayer2rgb_set_caps (GstBaseTransform * base, GstCaps * incaps,
   gst_structure_get_int (structure, "height", &bayer2rgb->height);
 
   format = gst_structure_get_string (structure, "format");
-  if (g_str_equal (format, "bggr")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_BGGR;
-  } else if (g_str_equal (format, "gbrg")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_GBRG;
-  } else if (g_str_equal (format, "grbg")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_GRBG;
-  } else if (g_str_equal (format, "rggb")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_RGGB;
-  } else {
+  if (!gst_bayer2rgb_parse_format (format, &bayer2rgb->format,
+          &bayer2rgb->depth))
     return FALSE;
-  }
+  bayer2rgb->src_stride = GST_ROUND_UP_4 (bayer2rgb->width) *
+      (bayer2rgb->depth > 8 ? 2 : 1);
 
   /* To cater for different RGB formats, we need to set params for later */
-  gst_video_info_from_caps (&info, outcaps);
+  if (!gst_video_info_from_caps (&info, outcaps))
+    return FALSE;
   bayer2rgb->r_off = GST_VIDEO_INFO_COMP_OFFSET (&info, 0);
   bayer2rgb->g_off = GST_VIDEO_INFO_COMP_OFFSET (&info, 1);
   bayer2rgb->b_off = GST_VIDEO_INFO_COMP_OFFSET (&info, 2);
+  /* offsets of the 4 bytes add up to 6 */
+  bayer2rgb->a_off = 6 - bayer2rgb->r_off - bayer2rgb->g_off - bayer2rgb->b_off;
 
   bayer2rgb->info = info;
 
+  bayer2rgb->params.width = bayer2rgb->width;
+  bayer2rgb->params.height = bayer2rgb->height;
+  bayer2rgb->params.depth = bayer2rgb->depth;
+  bayer2rgb->params.stride = bayer2rgb->src_stride;
+  bayer2rgb->params.phase_x =
+      (bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GBRG ||
+      bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_RGGB);
+  bayer2rgb->params.phase_y =
+      (bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GRBG ||
+      bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_RGGB);
+  GST_OBJECT_LOCK (bayer2rgb);
+  bayer2rgb->params.method = bayer2rgb->method;
+  GST_OBJECT_UNLOCK (bayer2rgb);
+
+  if (GST_VIDEO_INFO_IS_YUV (&info))
+    gst_bayer2rgb_setup_yuv_matrix (bayer2rgb);
+
+  bayer2rgb->orc_path = bayer2rgb->depth == 8 &&
+      bayer2rgb->params.method == GST_BAYER_DEMOSAIC_BILINEAR &&
+      GST_VIDEO_INFO_IS_RGB (&info) && GST_VIDEO_INFO_COMP_PSTRIDE (&info,
+      0) == 4;
+
+  GST_DEBUG_OBJECT (bayer2rgb, "%d bit input, %s path", bayer2rgb->depth,
+      bayer2rgb->orc_path ? "orc" : "generic");
+
+  gst_bayer2rgb_setup_bands (bayer2rgb);
+
   return TRUE;
 }
 
@@ -280,6 +559,9 @@ gst_bayer2rgb_reset (GstBayer2RGB * filter)
   filter->r_off = 0;
   filter->g_off = 0;
   filter->b_off = 0;
+  filter->a_off = 3;
+  filter->depth = 8;
+  filter->src_stride = 0;
   gst_video_info_init (&filter->info);
 }
 
@@ -334,12 +616,21 @@ gst_bayer2rgb_get_unit_size (GstBaseTransform * base, GstCaps * caps,
     name = gst_structure_get_name (structure);
     /* Our name must be either video/x-bayer video/x-raw */
     if (strcmp (name, "video/x-raw")) {
-      *size = GST_ROUND_UP_4 (width) * height;
+      int pattern, depth;
+
+      if (!gst_bayer2rgb_parse_format (gst_structure_get_string (structure,
+                  "format"), &pattern, &depth))
+        depth = 8;
+      *size = GST_ROUND_UP_4 (width) * height * (depth > 8 ? 2 : 1);
       return TRUE;
     } else {
-      /* For output, calculate according to format (always 32 bits) */
-      *size = width * height * 4;
-      return TRUE;
+      GstVideoInfo info;
+
+      /* For output, calculate according to format */
+      if (gst_video_info_from_caps (&info, caps)) {
+        *size = GST_VIDEO_INFO_SIZE (&info);
+        return TRUE;
+      }
     }
 
   }
@@ -381,12 +672,13 @@ typedef void (*process_func) (guint8 * d0, const guint8 * s0, const guint8 * s1,
     const guint8 * s2, const guint8 * s3, const guint8 * s4, const guint8 * s5,
     int n);
 
+/* processes rows @y0 to @y1 with the ORC kernels, @tmp holds 8 lines */
 static void
 gst_bayer2rgb_process (GstBayer2RGB * bayer2rgb, uint8_t * dest,
-    int dest_stride, uint8_t * src, int src_stride)
+    int dest_stride, const uint8_t * src, int src_stride, int y0, int y1,
+    guint8 * tmp)
 {
-  int j;
-  guint8 *tmp;
+  int j, k;
   process_func merge[2] = { NULL, NULL };
   int r_off, g_off, b_off;
 
@@ -423,31 +715,194 @@ gst_bayer2rgb_process (GstBayer2RGB * bayer2rgb, uint8_t * dest,
     merge[1] = tmp;
   }
 
-  tmp = g_malloc (2 * 4 * bayer2rgb->width);
 #define LINE(x) (tmp + ((x)&7) * bayer2rgb->width)
 
-  gst_bayer2rgb_split_and_upsample_horiz (LINE (3 * 2 + 0), LINE (3 * 2 + 1),
-      src + 1 * src_stride, bayer2rgb->width);
-  j = 0;
-  gst_bayer2rgb_split_and_upsample_horiz (LINE (j * 2 + 0), LINE (j * 2 + 1),
-      src + j * src_stride, bayer2rgb->width);
+  /* prime the cache with the rows above and at @y0, the first row of the
+   * picture is mirrored */
+  k = y0 > 0 ? y0 - 1 : MIN (1, bayer2rgb->height - 1);
+  gst_bayer2rgb_split_and_upsample_horiz (LINE ((y0 - 1) * 2 + 0),
+      LINE ((y0 - 1) * 2 + 1), src + k * src_stride, bayer2rgb->width);
+  gst_bayer2rgb_split_and_upsample_horiz (LINE (y0 * 2 + 0),
+      LINE (y0 * 2 + 1), src + y0 * src_stride, bayer2rgb->width);
 
-  for (j = 0; j < bayer2rgb->height; j++) {
-    if (j < bayer2rgb->height - 1) {
-      gst_bayer2rgb_split_and_upsample_horiz (LINE ((j + 1) * 2 + 0),
-          LINE ((j + 1) * 2 + 1), src + (j + 1) * src_stride, bayer2rgb->width);
-    }
+  for (j = y0; j < y1; j++) {
+    /* the row below, mirrored at the bottom of the picture */
+    k = j < bayer2rgb->height - 1 ? j + 1 : MAX (bayer2rgb->height - 2, 0);
+    gst_bayer2rgb_split_and_upsample_horiz (LINE ((j + 1) * 2 + 0),
+        LINE ((j + 1) * 2 + 1), src + k * src_stride, bayer2rgb->width);
 
     merge[j & 1] (dest + j * dest_stride,
         LINE (j * 2 - 2), LINE (j * 2 - 1),
         LINE (j * 2 + 0), LINE (j * 2 + 1),
         LINE (j * 2 + 2), LINE (j * 2 + 3), bayer2rgb->width >> 1);
   }
+#undef LINE
+}
+
+static void
+gst_bayer2rgb_write_rgb (GstBayer2RGB * filter, guint8 * dest,
+    const guint16 * r, const guint16 * g, const guint16 * b)
+{
+  int shift = filter->depth - 8;
+  int x;
+
+  for (x = 0; x < filter->width; x++) {
+    dest[filter->r_off] = r[x] >> shift;
+    dest[filter->g_off] = g[x] >> shift;
+    dest[filter->b_off] = b[x] >> shift;
+    dest[filter->a_off] = 0xff;
+    dest += 4;
+  }
+}
+
+static void
+gst_bayer2rgb_write_argb64 (GstBayer2RGB * filter, guint16 * dest,
+    const guint16 * r, const guint16 * g, const guint16 * b)
+{
+  /* scale to 16 bits by replicating the top bits in the low bits */
+  int up = 16 - filter->depth;
+  int down = 2 * filter->depth - 16;
+  int x;
+
+  for (x = 0; x < filter->width; x++) {
+    dest[0] = 0xffff;
+    dest[1] = (r[x] << up) | (r[x] >> down);
+    dest[2] = (g[x] << up) | (g[x] >> down);
+    dest[3] = (b[x] << up) | (b[x] >> down);
+    dest += 4;
+  }
+}
+
+/* writes @n_rows (1 or 2) luma rows from @y and one row of subsampled
+ * chroma, works for both I420 and NV12 */
+static void
+gst_bayer2rgb_write_yuv (GstBayer2RGB * filter, GstVideoFrame * frame,
+    int y, int n_rows, guint16 * rgb[2][3])
+{
+  const gint (*m)[4] = (const gint (*)[4]) filter->yuv_matrix;
+  int shift = filter->depth - 8;
+  int width = filter->width;
+  guint8 *u, *v;
+  int u_pstride, v_pstride;
+  int i, j, x;
+
+  for (i = 0; i < n_rows; i++) {
+    guint8 *dy = GST_VIDEO_FRAME_COMP_DATA (frame, 0) +
+        (y + i) * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+    const guint16 *r = rgb[i][0], *g = rgb[i][1], *b = rgb[i][2];
+
+    for (x = 0; x < width; x++) {
+      int rv = r[x] >> shift, gv = g[x] >> shift, bv = b[x] >> shift;
+
+      dy[x] = CLAMP ((m[0][0] * rv + m[0][1] * gv + m[0][2] * bv +
+              m[0][3]) >> 8, 0, 255);
+    }
+  }
 
-  g_free (tmp);
+  u = GST_VIDEO_FRAME_COMP_DATA (frame, 1) +
+      (y / 2) * GST_VIDEO_FRAME_COMP_STRIDE (frame, 1);
+  v = GST_VIDEO_FRAME_COMP_DATA (frame, 2) +
+      (y / 2) * GST_VIDEO_FRAME_COMP_STRIDE (frame, 2);
+  u_pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 1);
+  v_pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 2);
+
+  for (x = 0; x < width; x += 2) {
+    int rv = 0, gv = 0, bv = 0, n = 0;
+
+    for (i = 0; i < n_rows; i++) {
+      for (j = x; j < MIN (x + 2, width); j++) {
+        rv += rgb[i][0][j];
+        gv += rgb[i][1][j];
+        bv += rgb[i][2][j];
+        n++;
+      }
+    }
+    rv = (rv / n) >> shift;
+    gv = (gv / n) >> shift;
+    bv = (bv / n) >> shift;
+
+    u[(x / 2) * u_pstride] = CLAMP ((m[1][0] * rv + m[1][1] * gv +
+            m[1][2] * bv + m[1][3]) >> 8, 0, 255);
+    v[(x / 2) * v_pstride] = CLAMP ((m[2][0] * rv + m[2][1] * gv +
+            m[2][2] * bv + m[2][3]) >> 8, 0, 255);
+  }
 }
 
+/* processes rows @y0 to @y1 with the generic demosaicing, @y0 is even */
+static void
+gst_bayer2rgb_process_generic (GstBayer2RGB * filter, GstVideoFrame * frame,
+    const guint8 * src, int y0, int y1, guint16 * scratch)
+{
+  GstBayerDemosaic demosaic;
+  guint16 *rgb[2][3];
+  int width = filter->width;
+  int y, i;
+
+  gst_bayer_demosaic_init (&demosaic, &filter->params, src, scratch);
+  scratch += gst_bayer_demosaic_scratch_size (&filter->params);
+  for (i = 0; i < 6; i++)
+    rgb[i / 3][i % 3] = scratch + i * width;
+
+  for (y = y0; y < y1; y += 2) {
+    int n_rows = MIN (2, y1 - y);
+
+    for (i = 0; i < n_rows; i++)
+      gst_bayer_demosaic_row (&demosaic, y + i, rgb[i][0], rgb[i][1],
+          rgb[i][2]);
+
+    switch (GST_VIDEO_FRAME_FORMAT (frame)) {
+      case GST_VIDEO_FORMAT_I420:
+      case GST_VIDEO_FORMAT_NV12:
+        gst_bayer2rgb_write_yuv (filter, frame, y, n_rows, rgb);
+        break;
+      case GST_VIDEO_FORMAT_ARGB64:
+        for (i = 0; i < n_rows; i++) {
+          gst_bayer2rgb_write_argb64 (filter,
+              (guint16 *) ((guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame,
+                      0) + (y + i) * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0)),
+              rgb[i][0], rgb[i][1], rgb[i][2]);
+        }
+        break;
+      default:
+        for (i = 0; i < n_rows; i++) {
+          gst_bayer2rgb_write_rgb (filter,
+              (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) +
+              (y + i) * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0),
+              rgb[i][0], rgb[i][1], rgb[i][2]);
+        }
+        break;
+    }
+  }
+}
 
+static void
+gst_bayer2rgb_process_band (GstBayer2RGBBand * band)
+{
+  GstBayer2RGB *filter = band->filter;
+
+  if (filter->orc_path) {
+    gst_bayer2rgb_process (filter,
+        GST_VIDEO_FRAME_PLANE_DATA (band->frame, 0),
+        GST_VIDEO_FRAME_PLANE_STRIDE (band->frame, 0), band->src,
+        filter->src_stride, band->y0, band->y1, band->scratch);
+  } else {
+    gst_bayer2rgb_process_generic (filter, band->frame, band->src, band->y0,
+        band->y1, band->scratch);
+  }
+}
+
+static void
+gst_bayer2rgb_band_func (gpointer data, gpointer user_data)
+{
+  GstBayer2RGB *filter = user_data;
+
+  gst_bayer2rgb_process_band (data);
+
+  g_mutex_lock (&filter->lock);
+  if (--filter->pending == 0)
+    g_cond_signal (&filter->cond);
+  g_mutex_unlock (&filter->lock);
+}
 
 
 static GstFlowReturn
@@ -456,11 +911,14 @@ gst_bayer2rgb_transform (GstBaseTransform * base, GstBuffer * inbuf,
 {
   GstBayer2RGB *filter = GST_BAYER2RGB (base);
   GstMapInfo map;
-  uint8_t *output;
   GstVideoFrame frame;
+  guint i, n_bands;
 
   GST_DEBUG ("transforming buffer");
 
+  if (G_UNLIKELY (filter->n_bands == 0))
+    return GST_FLOW_NOT_NEGOTIATED;
+
   if (!gst_buffer_map (inbuf, &map, GST_MAP_READ))
     goto map_failed;
 
@@ -469,9 +927,35 @@ gst_bayer2rgb_transform (GstBaseTransform * base, GstBuffer * inbuf,
     goto map_failed;
   }
 
-  output = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
-  gst_bayer2rgb_process (filter, output, frame.info.stride[0],
-      map.data, GST_ROUND_UP_4 (filter->width));
+  /* band boundaries are kept on even rows for the chroma subsampling */
+  n_bands = filter->n_bands;
+  for (i = 0; i < n_bands; i++) {
+    GstBayer2RGBBand *band = &filter->bands[i];
+
+    band->src = map.data;
+    band->frame = &frame;
+    band->y0 = GST_ROUND_DOWN_2 (filter->height * i / n_bands);
+    band->y1 = i == n_bands - 1 ? filter->height :
+        GST_ROUND_DOWN_2 (filter->height * (i + 1) / n_bands);
+  }
+
+  if (n_bands > 1) {
+    g_mutex_lock (&filter->lock);
+    filter->pending = n_bands - 1;
+    g_mutex_unlock (&filter->lock);
+
+    for (i = 1; i < n_bands; i++)
+      g_thread_pool_push (filter->pool, &filter->bands[i], NULL);
+  }
+
+  gst_bayer2rgb_process_band (&filter->bands[0]);
+
+  if (n_bands > 1) {
+    g_mutex_lock (&filter->lock);
+    while (filter->pending > 0)
+      g_cond_wait (&filter->cond, &filter->lock);
+    g_mutex_unlock (&filter->lock);
+  }
 
   gst_video_frame_unmap (&frame);
   gst_buffer_unmap (inbuf, &map);
@@ -0,0 +1,232 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Generic demosaicing for 8 to 16 bit Bayer input.
+ *
+ * Like the ORC path in gstbayer2rgb.c, all kernels are written for the
+ * BGGR arrangement, other arrangements are handled by shifting the
+ * pattern by one column and/or row:
+ *
+ *       0 1
+ *   0   B G      class 0: B,  class 1: G on a blue row
+ *   1   G R      class 2: G on a red row,  class 3: R
+ *
+ * Two methods are available, plain bilinear interpolation and the
+ * gradient-corrected linear interpolation from
+ * H. S. Malvar, L. He and R. Cutler,
+ * "High-quality linear interpolation for demosaicing of Bayer-patterned
+ *  color images", ICASSP 2004.
+ * The Malvar filters are applied with all coefficients doubled, so that
+ * they can be evaluated in integers with a final shift by 4.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbayerdemosaic.h"
+
+#define PAD 2
+
+static inline gint
+mirror (gint i, gint n)
+{
+  if (i < 0)
+    i = -i;
+  else if (i >= n)
+    i = 2 * (n - 1) - i;
+
+  return CLAMP (i, 0, n - 1);
+}
+
+gsize
+gst_bayer_demosaic_scratch_size (const GstBayerDemosaicParams * params)
+{
+  return 5 * (params->width + 2 * PAD);
+}
+
+void
+gst_bayer_demosaic_init (GstBayerDemosaic * demosaic,
+    const GstBayerDemosaicParams * params, const guint8 * src,
+    guint16 * scratch)
+{
+  gint i;
+
+  demosaic->params = params;
+  demosaic->src = src;
+
+  for (i = 0; i < 5; i++) {
+    demosaic->lines[i] = scratch + i * (params->width + 2 * PAD) + PAD;
+    demosaic->line_y[i] = G_MININT;
+  }
+}
+
+/* converts input row @y to 16 bits, with @PAD mirrored samples on each
+ * side */
+static guint16 *
+gst_bayer_demosaic_get_line (GstBayerDemosaic * demosaic, gint y)
+{
+  const GstBayerDemosaicParams *params = demosaic->params;
+  gint slot = ((y % 5) + 5) % 5;
+  guint16 *line = demosaic->lines[slot];
+  const guint8 *src;
+  gint x, width = params->width;
+
+  if (demosaic->line_y[slot] == y)
+    return line;
+
+  src = demosaic->src + mirror (y, params->height) * params->stride;
+
+  if (params->depth > 8) {
+    const guint16 *s = (const guint16 *) src;
+    guint16 mask = (1 << params->depth) - 1;
+
+    for (x = 0; x < width; x++)
+      line[x] = GUINT16_FROM_LE (s[x]) & mask;
+  } else {
+    for (x = 0; x < width; x++)
+      line[x] = src[x];
+  }
+
+  for (x = 1; x <= PAD; x++) {
+    line[-x] = line[mirror (-x, width)];
+    line[width - 1 + x] = line[mirror (width - 1 + x, width)];
+  }
+
+  demosaic->line_y[slot] = y;
+
+  return line;
+}
+
+static void
+demosaic_row_bilinear (const guint16 * l0, const guint16 * l1,
+    const guint16 * l2, gint width, gint phase_x, gint row_class,
+    guint16 * r, guint16 * g, guint16 * b)
+{
+  gint x;
+
+  for (x = 0; x < width; x++) {
+    guint c = l1[x];
+    guint cross = (l0[x] + l2[x] + l1[x - 1] + l1[x + 1] + 2) >> 2;
+    guint diag = (l0[x - 1] + l0[x + 1] + l2[x - 1] + l2[x + 1] + 2) >> 2;
+    guint horiz = (l1[x - 1] + l1[x + 1] + 1) >> 1;
+    guint vert = (l0[x] + l2[x] + 1) >> 1;
+
+    switch (row_class | ((x + phase_x) & 1)) {
+      case 0:
+        b[x] = c;
+        g[x] = cross;
+        r[x] = diag;
+        break;
+      case 1:
+        b[x] = horiz;
+        g[x] = c;
+        r[x] = vert;
+        break;
+      case 2:
+        b[x] = vert;
+        g[x] = c;
+        r[x] = horiz;
+        break;
+      default:
+        b[x] = diag;
+        g[x] = cross;
+        r[x] = c;
+        break;
+    }
+  }
+}
+
+static void
+demosaic_row_malvar (const guint16 * const *l, gint width, gint phase_x,
+    gint row_class, gint max, guint16 * r, guint16 * g, guint16 * b)
+{
+  const guint16 *l0 = l[0], *l1 = l[1], *l2 = l[2], *l3 = l[3], *l4 = l[4];
+  gint x;
+
+#define CLIP(v) CLAMP (((v) + 8) >> 4, 0, max)
+  for (x = 0; x < width; x++) {
+    gint c = l2[x];
+    gint cross = l1[x] + l3[x] + l2[x - 1] + l2[x + 1];
+    gint cross2 = l0[x] + l4[x] + l2[x - 2] + l2[x + 2];
+    gint diag = l1[x - 1] + l1[x + 1] + l3[x - 1] + l3[x + 1];
+    gint horiz = l2[x - 1] + l2[x + 1];
+    gint horiz2 = l2[x - 2] + l2[x + 2];
+    gint vert = l1[x] + l3[x];
+    gint vert2 = l0[x] + l4[x];
+
+    switch (row_class | ((x + phase_x) & 1)) {
+      case 0:
+        b[x] = c;
+        g[x] = CLIP (8 * c + 4 * cross - 2 * cross2);
+        r[x] = CLIP (12 * c + 4 * diag - 3 * cross2);
+        break;
+      case 1:
+        b[x] = CLIP (10 * c + 8 * horiz - 2 * diag - 2 * horiz2 + vert2);
+        g[x] = c;
+        r[x] = CLIP (10 * c + 8 * vert - 2 * diag - 2 * vert2 + horiz2);
+        break;
+      case 2:
+        b[x] = CLIP (10 * c + 8 * vert - 2 * diag - 2 * vert2 + horiz2);
+        g[x] = c;
+        r[x] = CLIP (10 * c + 8 * horiz - 2 * diag - 2 * horiz2 + vert2);
+        break;
+      default:
+        b[x] = CLIP (12 * c + 4 * diag - 3 * cross2);
+        g[x] = CLIP (8 * c + 4 * cross - 2 * cross2);
+        r[x] = c;
+        break;
+    }
+  }
+#undef CLIP
+}
+
+/**
+ * gst_bayer_demosaic_row:
+ * @demosaic: a #GstBayerDemosaic
+ * @y: the row to interpolate
+ * @r: (out caller-allocates): width red samples
+ * @g: (out caller-allocates): width green samples
+ * @b: (out caller-allocates): width blue samples
+ *
+ * Interpolates row @y into @r, @g and @b with the input bit depth.  Rows
+ * are cached, so bands should be processed from top to bottom.
+ */
+void
+gst_bayer_demosaic_row (GstBayerDemosaic * demosaic, gint y,
+    guint16 * r, guint16 * g, guint16 * b)
+{
+  const GstBayerDemosaicParams *params = demosaic->params;
+  const guint16 *l[5];
+  gint i, row_class;
+
+  for (i = 0; i < 5; i++)
+    l[i] = gst_bayer_demosaic_get_line (demosaic, y - 2 + i);
+
+  row_class = ((y + params->phase_y) & 1) << 1;
+
+  if (params->method == GST_BAYER_DEMOSAIC_MALVAR) {
+    demosaic_row_malvar (l, params->width, params->phase_x, row_class,
+        (1 << params->depth) - 1, r, g, b);
+  } else {
+    demosaic_row_bilinear (l[1], l[2], l[3], params->width, params->phase_x,
+        row_class, r, g, b);
+  }
+}
@@ -0,0 +1,70 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_BAYER_DEMOSAIC_H_
+#define _GST_BAYER_DEMOSAIC_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GST_BAYER_DEMOSAIC_BILINEAR,
+  GST_BAYER_DEMOSAIC_MALVAR
+} GstBayerDemosaicMethod;
+
+typedef struct
+{
+  gint width;
+  gint height;
+  gint depth;                   /* bits per sample, 8 to 16 */
+  gint stride;                  /* in bytes */
+
+  /* position of the pattern relative to bggr */
+  gint phase_x;
+  gint phase_y;
+
+  GstBayerDemosaicMethod method;
+} GstBayerDemosaicParams;
+
+/* Interpolates one band of the picture row by row.  A band keeps a window
+ * of five input rows converted to 16 bits and padded by mirroring, so the
+ * kernels never need to check for borders. */
+typedef struct
+{
+  const GstBayerDemosaicParams *params;
+  const guint8 *src;
+
+  guint16 *lines[5];
+  gint line_y[5];
+} GstBayerDemosaic;
+
+gsize gst_bayer_demosaic_scratch_size (const GstBayerDemosaicParams * params);
+
+void  gst_bayer_demosaic_init         (GstBayerDemosaic * demosaic,
+                                       const GstBayerDemosaicParams * params,
+                                       const guint8 * src, guint16 * scratch);
+
+void  gst_bayer_demosaic_row          (GstBayerDemosaic * demosaic, gint y,
+                                       guint16 * r, guint16 * g, guint16 * b);
+
+G_END_DECLS
+
+#endif /* _GST_BAYER_DEMOSAIC_H_ */
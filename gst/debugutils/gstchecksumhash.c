@@ -0,0 +1,350 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Non-cryptographic hashes for checksumsink, next to the GChecksum ones.
+ *
+ * XXH64 follows the xxHash specification by Yann Collet, with a seed of 0,
+ * and gives the same digests as the xxhsum tool.  Its four independent
+ * accumulators keep a modern CPU busy without explicit SIMD.
+ *
+ * CRC32C uses the Castagnoli polynomial (as in iSCSI and ext4).  The CRC32
+ * instructions of SSE 4.2 or ARMv8 are used when the compiler targets them,
+ * otherwise a slicing-by-8 table implementation.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gstchecksumhash.h"
+
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#include <nmmintrin.h>
+#define HAVE_CRC32C_SSE42 1
+#elif defined(__ARM_FEATURE_CRC32) && defined(__aarch64__)
+#include <arm_acle.h>
+#define HAVE_CRC32C_ARMV8 1
+#endif
+
+/* XXH64 */
+
+#define PRIME64_1 G_GUINT64_CONSTANT (0x9E3779B185EBCA87)
+#define PRIME64_2 G_GUINT64_CONSTANT (0xC2B2AE3D27D4EB4F)
+#define PRIME64_3 G_GUINT64_CONSTANT (0x165667B19E3779F9)
+#define PRIME64_4 G_GUINT64_CONSTANT (0x85EBCA77C2B2AE63)
+#define PRIME64_5 G_GUINT64_CONSTANT (0x27D4EB2F165667C5)
+
+#define ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static inline guint64
+read64 (const guint8 * p)
+{
+  guint64 v;
+
+  memcpy (&v, p, 8);
+  return GUINT64_FROM_LE (v);
+}
+
+static inline guint32
+read32 (const guint8 * p)
+{
+  guint32 v;
+
+  memcpy (&v, p, 4);
+  return GUINT32_FROM_LE (v);
+}
+
+static inline guint64
+xxh64_round (guint64 acc, guint64 input)
+{
+  acc += input * PRIME64_2;
+  acc = ROTL64 (acc, 31);
+  return acc * PRIME64_1;
+}
+
+static inline guint64
+xxh64_merge_round (guint64 acc, guint64 val)
+{
+  acc ^= xxh64_round (0, val);
+  return acc * PRIME64_1 + PRIME64_4;
+}
+
+static void
+xxh64_init (GstXXH64State * s)
+{
+  memset (s, 0, sizeof (GstXXH64State));
+  s->v[0] = PRIME64_1 + PRIME64_2;
+  s->v[1] = PRIME64_2;
+  s->v[2] = 0;
+  s->v[3] = 0 - PRIME64_1;
+}
+
+/* consumes as many 32 byte stripes as possible, returns the number of
+ * bytes consumed */
+static gsize
+xxh64_stripes (GstXXH64State * s, const guint8 * p, gsize len)
+{
+  guint64 v0 = s->v[0], v1 = s->v[1], v2 = s->v[2], v3 = s->v[3];
+  const guint8 *start = p, *limit;
+
+  if (len < 32)
+    return 0;
+
+  limit = p + len - 32;
+  do {
+    v0 = xxh64_round (v0, read64 (p));
+    v1 = xxh64_round (v1, read64 (p + 8));
+    v2 = xxh64_round (v2, read64 (p + 16));
+    v3 = xxh64_round (v3, read64 (p + 24));
+    p += 32;
+  } while (p <= limit);
+
+  s->v[0] = v0;
+  s->v[1] = v1;
+  s->v[2] = v2;
+  s->v[3] = v3;
+
+  return p - start;
+}
+
+static void
+xxh64_update (GstXXH64State * s, const guint8 * p, gsize len)
+{
+  gsize n;
+
+  s->total_len += len;
+
+  if (s->mem_size + len < 32) {
+    memcpy (s->mem + s->mem_size, p, len);
+    s->mem_size += len;
+    return;
+  }
+
+  if (s->mem_size) {
+    n = 32 - s->mem_size;
+    memcpy (s->mem + s->mem_size, p, n);
+    xxh64_stripes (s, s->mem, 32);
+    p += n;
+    len -= n;
+    s->mem_size = 0;
+  }
+
+  n = xxh64_stripes (s, p, len);
+  memcpy (s->mem, p + n, len - n);
+  s->mem_size = len - n;
+}
+
+static guint64
+xxh64_digest (const GstXXH64State * s)
+{
+  const guint8 *p = s->mem, *end = s->mem + s->mem_size;
+  guint64 h;
+
+  if (s->total_len >= 32) {
+    h = ROTL64 (s->v[0], 1) + ROTL64 (s->v[1], 7) + ROTL64 (s->v[2], 12) +
+        ROTL64 (s->v[3], 18);
+    h = xxh64_merge_round (h, s->v[0]);
+    h = xxh64_merge_round (h, s->v[1]);
+    h = xxh64_merge_round (h, s->v[2]);
+    h = xxh64_merge_round (h, s->v[3]);
+  } else {
+    h = PRIME64_5;
+  }
+
+  h += s->total_len;
+
+  for (; p + 8 <= end; p += 8) {
+    h ^= xxh64_round (0, read64 (p));
+    h = ROTL64 (h, 27) * PRIME64_1 + PRIME64_4;
+  }
+  if (p + 4 <= end) {
+    h ^= (guint64) read32 (p) * PRIME64_1;
+    h = ROTL64 (h, 23) * PRIME64_2 + PRIME64_3;
+    p += 4;
+  }
+  for (; p < end; p++) {
+    h ^= *p * PRIME64_5;
+    h = ROTL64 (h, 11) * PRIME64_1;
+  }
+
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+
+  return h;
+}
+
+/* CRC32C */
+
+#if defined(HAVE_CRC32C_SSE42)
+static guint32
+crc32c_update (guint32 crc, const guint8 * p, gsize len)
+{
+  guint64 c = crc;
+
+  for (; len && ((guintptr) p & 7); len--)
+    c = _mm_crc32_u8 (c, *p++);
+  for (; len >= 8; len -= 8, p += 8)
+    c = _mm_crc32_u64 (c, *(const guint64 *) p);
+  for (; len; len--)
+    c = _mm_crc32_u8 (c, *p++);
+
+  return c;
+}
+#elif defined(HAVE_CRC32C_ARMV8)
+static guint32
+crc32c_update (guint32 crc, const guint8 * p, gsize len)
+{
+  for (; len && ((guintptr) p & 7); len--)
+    crc = __crc32cb (crc, *p++);
+  for (; len >= 8; len -= 8, p += 8)
+    crc = __crc32cd (crc, *(const guint64 *) p);
+  for (; len; len--)
+    crc = __crc32cb (crc, *p++);
+
+  return crc;
+}
+#else
+static guint32 crc32c_table[8][256];
+
+static void
+crc32c_init_table (void)
+{
+  static gsize init = 0;
+
+  if (g_once_init_enter (&init)) {
+    guint32 c;
+    gint i, j;
+
+    for (i = 0; i < 256; i++) {
+      c = i;
+      for (j = 0; j < 8; j++)
+        c = (c >> 1) ^ (c & 1 ? 0x82F63B78 : 0);
+      crc32c_table[0][i] = c;
+    }
+    for (i = 0; i < 256; i++) {
+      c = crc32c_table[0][i];
+      for (j = 1; j < 8; j++) {
+        c = crc32c_table[0][c & 0xff] ^ (c >> 8);
+        crc32c_table[j][i] = c;
+      }
+    }
+
+    g_once_init_leave (&init, 1);
+  }
+}
+
+/* slicing-by-8 */
+static guint32
+crc32c_update (guint32 crc, const guint8 * p, gsize len)
+{
+  crc32c_init_table ();
+
+  for (; len >= 8; len -= 8, p += 8) {
+    guint32 lo = read32 (p) ^ crc;
+    guint32 hi = read32 (p + 4);
+
+    crc = crc32c_table[7][lo & 0xff] ^ crc32c_table[6][(lo >> 8) & 0xff] ^
+        crc32c_table[5][(lo >> 16) & 0xff] ^ crc32c_table[4][lo >> 24] ^
+        crc32c_table[3][hi & 0xff] ^ crc32c_table[2][(hi >> 8) & 0xff] ^
+        crc32c_table[1][(hi >> 16) & 0xff] ^ crc32c_table[0][hi >> 24];
+  }
+  for (; len; len--)
+    crc = crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+
+  return crc;
+}
+#endif
+
+void
+gst_checksum_hash_init (GstChecksumHash * hash, GstChecksumHashType type)
+{
+  hash->type = type;
+
+  switch (type) {
+    case GST_CHECKSUM_HASH_XXH64:
+      xxh64_init (&hash->state.xxh64);
+      break;
+    case GST_CHECKSUM_HASH_CRC32C:
+      hash->state.crc32c = 0xffffffff;
+      break;
+    default:
+      hash->state.checksum = g_checksum_new ((GChecksumType) type);
+      break;
+  }
+}
+
+void
+gst_checksum_hash_update (GstChecksumHash * hash, const guint8 * data,
+    gsize length)
+{
+  switch (hash->type) {
+    case GST_CHECKSUM_HASH_XXH64:
+      xxh64_update (&hash->state.xxh64, data, length);
+      break;
+    case GST_CHECKSUM_HASH_CRC32C:
+      hash->state.crc32c = crc32c_update (hash->state.crc32c, data, length);
+      break;
+    default:
+      g_checksum_update (hash->state.checksum, data, length);
+      break;
+  }
+}
+
+/* returns the digest as a newly allocated hexadecimal string and releases
+ * the resources of @hash */
+gchar *
+gst_checksum_hash_finish (GstChecksumHash * hash)
+{
+  gchar *s;
+
+  switch (hash->type) {
+    case GST_CHECKSUM_HASH_XXH64:
+      s = g_strdup_printf ("%016" G_GINT64_MODIFIER "x",
+          xxh64_digest (&hash->state.xxh64));
+      break;
+    case GST_CHECKSUM_HASH_CRC32C:
+      s = g_strdup_printf ("%08x", hash->state.crc32c ^ 0xffffffff);
+      break;
+    default:
+      s = g_strdup (g_checksum_get_string (hash->state.checksum));
+      g_checksum_free (hash->state.checksum);
+      hash->state.checksum = NULL;
+      break;
+  }
+
+  return s;
+}
+
+gchar *
+gst_checksum_hash_compute (GstChecksumHashType type, const guint8 * data,
+    gsize length)
+{
+  GstChecksumHash hash;
+
+  gst_checksum_hash_init (&hash, type);
+  gst_checksum_hash_update (&hash, data, length);
+
+  return gst_checksum_hash_finish (&hash);
+}
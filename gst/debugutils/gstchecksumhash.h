@@ -0,0 +1,72 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_CHECKSUM_HASH_H__
+#define __GST_CHECKSUM_HASH_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* The cryptographic hashes keep the values of #GChecksumType */
+typedef enum
+{
+  GST_CHECKSUM_HASH_MD5 = G_CHECKSUM_MD5,
+  GST_CHECKSUM_HASH_SHA1 = G_CHECKSUM_SHA1,
+  GST_CHECKSUM_HASH_SHA256 = G_CHECKSUM_SHA256,
+  GST_CHECKSUM_HASH_SHA512 = G_CHECKSUM_SHA512,
+  GST_CHECKSUM_HASH_XXH64 = 32,
+  GST_CHECKSUM_HASH_CRC32C
+} GstChecksumHashType;
+
+typedef struct
+{
+  guint64 v[4];
+  guint64 total_len;
+  guint8 mem[32];
+  guint mem_size;
+} GstXXH64State;
+
+/* Incremental hashing of a byte stream with any of the supported hashes */
+typedef struct
+{
+  GstChecksumHashType type;
+
+  union
+  {
+    GChecksum *checksum;
+    GstXXH64State xxh64;
+    guint32 crc32c;
+  } state;
+} GstChecksumHash;
+
+void    gst_checksum_hash_init   (GstChecksumHash * hash,
+                                  GstChecksumHashType type);
+
+void    gst_checksum_hash_update (GstChecksumHash * hash,
+                                  const guint8 * data, gsize length);
+
+gchar * gst_checksum_hash_finish (GstChecksumHash * hash);
+
+gchar * gst_checksum_hash_compute (GstChecksumHashType type,
+                                   const guint8 * data, gsize length);
+
+G_END_DECLS
+
+#endif /* __GST_CHECKSUM_HASH_H__ */
@@ -17,14 +17,45 @@
  * Boston, MA 02110-1301, USA.
  */
 
+/**
+ * SECTION:element-checksumsink
+ * @title: checksumsink
+ *
+ * Computes a checksum of every buffer and prints it, together with the
+ * buffer timestamp, on stdout or into the file set with
+ * #GstChecksumSink:location.
+ *
+ * Besides the cryptographic hashes provided by GLib, the much faster
+ * non-cryptographic XXH64 and CRC32C hashes can be selected.  With
+ * #GstChecksumSink:n-threads, hashing is done on a pool of worker threads,
+ * the checksums are still written in buffer order.
+ *
+ * With #GstChecksumSink:plane-checksums enabled and raw video caps, one
+ * checksum is printed per plane instead, computed on the visible pixels
+ * only: the row padding is skipped, so that the checksums do not depend on
+ * the strides chosen by the decoder.
+ *
+ * ## Example launch line
+ * |[
+ * gst-launch-1.0 -v filesrc location=some_file.mkv ! decodebin ! \
+ *   checksumsink hash=xxh64 plane-checksums=true location=sums.txt
+ * ]|
+ */
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
 #include <gst/gst.h>
 #include <gst/base/gstbasesink.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <errno.h>
 #include "gstchecksumsink.h"
 
+GST_DEBUG_CATEGORY_STATIC (gst_checksum_sink_debug);
+#define GST_CAT_DEFAULT gst_checksum_sink_debug
+
 static void gst_checksum_sink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_checksum_sink_get_property (GObject * object, guint prop_id,
@@ -34,15 +65,42 @@ static void gst_checksum_sink_finalize (GObject * object);
 
 static gboolean gst_checksum_sink_start (GstBaseSink * sink);
 static gboolean gst_checksum_sink_stop (GstBaseSink * sink);
+static gboolean gst_checksum_sink_set_caps (GstBaseSink * sink,
+    GstCaps * caps);
+static gboolean gst_checksum_sink_event (GstBaseSink * sink,
+    GstEvent * event);
 static GstFlowReturn
 gst_checksum_sink_render (GstBaseSink * sink, GstBuffer * buffer);
 
+static void gst_checksum_sink_job_func (gpointer data, gpointer user_data);
+
 enum
 {
   PROP_0,
   PROP_HASH,
+  PROP_PLANE_CHECKSUMS,
+  PROP_N_THREADS,
+  PROP_LOCATION
 };
 
+#define DEFAULT_HASH GST_CHECKSUM_HASH_SHA1
+#define DEFAULT_PLANE_CHECKSUMS FALSE
+#define DEFAULT_N_THREADS 1
+#define DEFAULT_LOCATION NULL
+
+/* number of buffers queued per worker thread */
+#define JOBS_PER_THREAD 2
+
+typedef struct
+{
+  GstBuffer *buffer;
+  GstChecksumHashType hash;
+  gboolean planes;
+  GstVideoInfo info;
+
+  gchar *line;
+} GstChecksumSinkJob;
+
 static GstStaticPadTemplate gst_checksum_sink_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -59,10 +117,13 @@ gst_checksum_sink_hash_get_type (void)
 
   if (gtype == 0) {
     static const GEnumValue values[] = {
-      {G_CHECKSUM_MD5, "MD5", "md5"},
-      {G_CHECKSUM_SHA1, "SHA-1", "sha1"},
-      {G_CHECKSUM_SHA256, "SHA-256", "sha256"},
-      {G_CHECKSUM_SHA512, "SHA-512", "sha512"},
+      {GST_CHECKSUM_HASH_MD5, "MD5", "md5"},
+      {GST_CHECKSUM_HASH_SHA1, "SHA-1", "sha1"},
+      {GST_CHECKSUM_HASH_SHA256, "SHA-256", "sha256"},
+      {GST_CHECKSUM_HASH_SHA512, "SHA-512", "sha512"},
+      {GST_CHECKSUM_HASH_XXH64, "xxHash 64 bits (non-cryptographic)",
+          "xxh64"},
+      {GST_CHECKSUM_HASH_CRC32C, "CRC-32C (non-cryptographic)", "crc32c"},
       {0, NULL, NULL},
     };
 
@@ -87,6 +148,8 @@ gst_checksum_sink_class_init (GstChecksumSinkClass * klass)
   gobject_class->finalize = gst_checksum_sink_finalize;
   base_sink_class->start = GST_DEBUG_FUNCPTR (gst_checksum_sink_start);
   base_sink_class->stop = GST_DEBUG_FUNCPTR (gst_checksum_sink_stop);
+  base_sink_class->set_caps = GST_DEBUG_FUNCPTR (gst_checksum_sink_set_caps);
+  base_sink_class->event = GST_DEBUG_FUNCPTR (gst_checksum_sink_event);
   base_sink_class->render = GST_DEBUG_FUNCPTR (gst_checksum_sink_render);
 
   gst_element_class_add_static_pad_template (element_class,
@@ -94,19 +157,46 @@ gst_checksum_sink_class_init (GstChecksumSinkClass * klass)
 
   g_object_class_install_property (gobject_class, PROP_HASH,
       g_param_spec_enum ("hash", "Hash", "Checksum type",
-          gst_checksum_sink_hash_get_type (), G_CHECKSUM_SHA1,
+          gst_checksum_sink_hash_get_type (), DEFAULT_HASH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PLANE_CHECKSUMS,
+      g_param_spec_boolean ("plane-checksums", "Plane checksums",
+          "Checksum the visible pixels of each plane of raw video "
+          "separately, ignoring the row padding", DEFAULT_PLANE_CHECKSUMS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used for hashing (0 = one per CPU, "
+          "1 = hash in the streaming thread)", 0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_LOCATION,
+      g_param_spec_string ("location", "Location",
+          "File to write the checksums to (NULL = stdout)", DEFAULT_LOCATION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (element_class, "Checksum sink",
       "Debug/Sink", "Calculates a checksum for buffers",
       "David Schleef <ds@schleef.org>");
+
+  GST_DEBUG_CATEGORY_INIT (gst_checksum_sink_debug, "checksumsink", 0,
+      "checksumsink");
 }
 
 static void
 gst_checksum_sink_init (GstChecksumSink * checksumsink)
 {
   gst_base_sink_set_sync (GST_BASE_SINK (checksumsink), FALSE);
-  checksumsink->hash = G_CHECKSUM_SHA1;
+  checksumsink->hash = DEFAULT_HASH;
+  checksumsink->plane_checksums = DEFAULT_PLANE_CHECKSUMS;
+  checksumsink->n_threads = DEFAULT_N_THREADS;
+  checksumsink->location = g_strdup (DEFAULT_LOCATION);
+
+  g_mutex_init (&checksumsink->lock);
+  g_cond_init (&checksumsink->cond);
+  g_queue_init (&checksumsink->jobs);
 }
 
 static void
@@ -115,14 +205,26 @@ gst_checksum_sink_set_property (GObject * object, guint prop_id,
 {
   GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (object);
 
+  GST_OBJECT_LOCK (checksumsink);
   switch (prop_id) {
     case PROP_HASH:
       checksumsink->hash = g_value_get_enum (value);
       break;
+    case PROP_PLANE_CHECKSUMS:
+      checksumsink->plane_checksums = g_value_get_boolean (value);
+      break;
+    case PROP_N_THREADS:
+      checksumsink->n_threads = g_value_get_uint (value);
+      break;
+    case PROP_LOCATION:
+      g_free (checksumsink->location);
+      checksumsink->location = g_value_dup_string (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  GST_OBJECT_UNLOCK (checksumsink);
 }
 
 static void
@@ -131,14 +233,25 @@ gst_checksum_sink_get_property (GObject * object, guint prop_id,
 {
   GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (object);
 
+  GST_OBJECT_LOCK (checksumsink);
   switch (prop_id) {
     case PROP_HASH:
       g_value_set_enum (value, checksumsink->hash);
       break;
+    case PROP_PLANE_CHECKSUMS:
+      g_value_set_boolean (value, checksumsink->plane_checksums);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, checksumsink->n_threads);
+      break;
+    case PROP_LOCATION:
+      g_value_set_string (value, checksumsink->location);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  GST_OBJECT_UNLOCK (checksumsink);
 }
 
 static void
@@ -150,36 +263,266 @@ gst_checksum_sink_dispose (GObject * object)
 static void
 gst_checksum_sink_finalize (GObject * object)
 {
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (object);
+
+  g_free (checksumsink->location);
+  g_mutex_clear (&checksumsink->lock);
+  g_cond_clear (&checksumsink->cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
 static gboolean
 gst_checksum_sink_start (GstBaseSink * sink)
 {
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+  gchar *location;
+  guint n_threads;
+  GError *err = NULL;
+
+  GST_OBJECT_LOCK (checksumsink);
+  location = g_strdup (checksumsink->location);
+  n_threads = checksumsink->n_threads;
+  GST_OBJECT_UNLOCK (checksumsink);
+
+  if (location && *location) {
+    checksumsink->file = g_fopen (location, "w");
+    if (!checksumsink->file) {
+      GST_ELEMENT_ERROR (checksumsink, RESOURCE, OPEN_WRITE,
+          ("Could not open file \"%s\" for writing.", location),
+          GST_ERROR_SYSTEM);
+      g_free (location);
+      return FALSE;
+    }
+  }
+  g_free (location);
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  if (n_threads > 1) {
+    checksumsink->pool = g_thread_pool_new (gst_checksum_sink_job_func,
+        checksumsink, n_threads, TRUE, &err);
+    if (!checksumsink->pool) {
+      GST_WARNING_OBJECT (checksumsink, "failed to create thread pool, "
+          "hashing in the streaming thread: %s", err->message);
+      g_clear_error (&err);
+    }
+    checksumsink->max_pending = n_threads * JOBS_PER_THREAD;
+  }
+
+  checksumsink->video = FALSE;
+
   return TRUE;
 }
 
+static void
+gst_checksum_sink_drain (GstChecksumSink * checksumsink)
+{
+  g_mutex_lock (&checksumsink->lock);
+  while (!g_queue_is_empty (&checksumsink->jobs))
+    g_cond_wait (&checksumsink->cond, &checksumsink->lock);
+  g_mutex_unlock (&checksumsink->lock);
+
+  if (checksumsink->file)
+    fflush (checksumsink->file);
+}
+
 static gboolean
 gst_checksum_sink_stop (GstBaseSink * sink)
 {
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+
+  if (checksumsink->pool) {
+    gst_checksum_sink_drain (checksumsink);
+    g_thread_pool_free (checksumsink->pool, FALSE, TRUE);
+    checksumsink->pool = NULL;
+  }
+
+  if (checksumsink->file) {
+    fclose (checksumsink->file);
+    checksumsink->file = NULL;
+  }
+
   return TRUE;
 }
 
+static gboolean
+gst_checksum_sink_set_caps (GstBaseSink * sink, GstCaps * caps)
+{
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+  GstStructure *s = gst_caps_get_structure (caps, 0);
+  GstVideoInfo info;
+
+  /* wait for the buffers with the old caps */
+  gst_checksum_sink_drain (checksumsink);
+
+  checksumsink->video = gst_structure_has_name (s, "video/x-raw") &&
+      gst_video_info_from_caps (&info, caps);
+
+  if (checksumsink->video) {
+    const GstVideoFormatInfo *finfo = info.finfo;
+
+    /* the visible area of these can't be walked row by row */
+    if (GST_VIDEO_FORMAT_INFO_IS_COMPLEX (finfo) ||
+        GST_VIDEO_FORMAT_INFO_IS_TILED (finfo) ||
+        GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, 0) == 0) {
+      GST_INFO_OBJECT (checksumsink, "no plane checksums for format %s",
+          GST_VIDEO_FORMAT_INFO_NAME (finfo));
+      checksumsink->video = FALSE;
+    }
+    checksumsink->info = info;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_checksum_sink_event (GstBaseSink * sink, GstEvent * event)
+{
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS)
+    gst_checksum_sink_drain (checksumsink);
+
+  return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
+}
+
+/* hashes the visible part of every plane, skipping the padding at the end
+ * of the rows */
+static gboolean
+gst_checksum_sink_hash_planes (GstChecksumSinkJob * job, GString * line)
+{
+  const GstVideoFormatInfo *finfo = job->info.finfo;
+  GstVideoFrame frame;
+  GstChecksumHash hash;
+  guint p, c, y;
+
+  if (!gst_video_frame_map (&frame, &job->info, job->buffer, GST_MAP_READ))
+    return FALSE;
+
+  for (p = 0; p < GST_VIDEO_FRAME_N_PLANES (&frame); p++) {
+    const guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (&frame, p);
+    gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (&frame, p);
+    gsize row_size = 0;
+    guint rows = 0;
+    gchar *s;
+
+    /* packed formats have several components in one plane, the widest
+     * one covers the whole row */
+    for (c = 0; c < GST_VIDEO_FRAME_N_COMPONENTS (&frame); c++) {
+      if (GST_VIDEO_FORMAT_INFO_PLANE (finfo, c) != p)
+        continue;
+      row_size = MAX (row_size, GST_VIDEO_FRAME_COMP_WIDTH (&frame, c) *
+          GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, c));
+      rows = MAX (rows, GST_VIDEO_FRAME_COMP_HEIGHT (&frame, c));
+    }
+
+    gst_checksum_hash_init (&hash, job->hash);
+    for (y = 0; y < rows; y++)
+      gst_checksum_hash_update (&hash, data + y * stride, row_size);
+    s = gst_checksum_hash_finish (&hash);
+    g_string_append_printf (line, " %s", s);
+    g_free (s);
+  }
+
+  gst_video_frame_unmap (&frame);
+
+  return TRUE;
+}
+
+static gchar *
+gst_checksum_sink_job_process (GstChecksumSinkJob * job)
+{
+  GString *line;
+
+  line = g_string_new (NULL);
+  g_string_append_printf (line, "%" GST_TIME_FORMAT,
+      GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (job->buffer)));
+
+  if (!job->planes || !gst_checksum_sink_hash_planes (job, line)) {
+    GstMapInfo map;
+    gchar *s;
+
+    gst_buffer_map (job->buffer, &map, GST_MAP_READ);
+    s = gst_checksum_hash_compute (job->hash, map.data, map.size);
+    gst_buffer_unmap (job->buffer, &map);
+    g_string_append_printf (line, " %s", s);
+    g_free (s);
+  }
+
+  g_string_append_c (line, '\n');
+
+  gst_buffer_unref (job->buffer);
+  job->buffer = NULL;
+
+  return g_string_free (line, FALSE);
+}
+
+static void
+gst_checksum_sink_output (GstChecksumSink * checksumsink, const gchar * line)
+{
+  if (checksumsink->file)
+    fputs (line, checksumsink->file);
+  else
+    g_print ("%s", line);
+}
+
+static void
+gst_checksum_sink_job_func (gpointer data, gpointer user_data)
+{
+  GstChecksumSink *checksumsink = user_data;
+  GstChecksumSinkJob *job = data;
+  gchar *line;
+
+  line = gst_checksum_sink_job_process (job);
+
+  g_mutex_lock (&checksumsink->lock);
+  job->line = line;
+  /* write out all the finished jobs that are next in order */
+  while ((job = g_queue_peek_head (&checksumsink->jobs)) && job->line) {
+    g_queue_pop_head (&checksumsink->jobs);
+    gst_checksum_sink_output (checksumsink, job->line);
+    g_free (job->line);
+    g_slice_free (GstChecksumSinkJob, job);
+  }
+  g_cond_broadcast (&checksumsink->cond);
+  g_mutex_unlock (&checksumsink->lock);
+}
+
 static GstFlowReturn
 gst_checksum_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
-  gchar *s;
-  GstMapInfo map;
   GstChecksumSink *checksumsink;
+  GstChecksumSinkJob *job;
 
   checksumsink = GST_CHECKSUM_SINK (sink);
-  gst_buffer_map (buffer, &map, GST_MAP_READ);
-  s = g_compute_checksum_for_data (checksumsink->hash, map.data, map.size);
-  gst_buffer_unmap (buffer, &map);
-  g_print ("%" GST_TIME_FORMAT " %s\n",
-      GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buffer)), s);
 
-  g_free (s);
+  job = g_slice_new0 (GstChecksumSinkJob);
+  job->buffer = gst_buffer_ref (buffer);
+  GST_OBJECT_LOCK (checksumsink);
+  job->hash = checksumsink->hash;
+  job->planes = checksumsink->plane_checksums && checksumsink->video;
+  GST_OBJECT_UNLOCK (checksumsink);
+  if (job->planes)
+    job->info = checksumsink->info;
+
+  if (!checksumsink->pool) {
+    gchar *line = gst_checksum_sink_job_process (job);
+
+    gst_checksum_sink_output (checksumsink, line);
+    g_free (line);
+    g_slice_free (GstChecksumSinkJob, job);
+    return GST_FLOW_OK;
+  }
+
+  g_mutex_lock (&checksumsink->lock);
+  while (g_queue_get_length (&checksumsink->jobs) >= checksumsink->max_pending)
+    g_cond_wait (&checksumsink->cond, &checksumsink->lock);
+  g_queue_push_tail (&checksumsink->jobs, job);
+  g_mutex_unlock (&checksumsink->lock);
+
+  g_thread_pool_push (checksumsink->pool, job, NULL);
 
   return GST_FLOW_OK;
 }
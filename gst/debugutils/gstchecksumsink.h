@@ -22,6 +22,10 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstbasesink.h>
+#include <gst/video/video.h>
+#include <stdio.h>
+
+#include "gstchecksumhash.h"
 
 G_BEGIN_DECLS
 
@@ -37,7 +41,22 @@ typedef struct _GstChecksumSinkClass GstChecksumSinkClass;
 struct _GstChecksumSink
 {
   GstBaseSink base_checksumsink;
-  GChecksumType hash;
+  GstChecksumHashType hash;
+  gboolean plane_checksums;
+  guint n_threads;
+  gchar *location;
+
+  FILE *file;
+  gboolean video;
+  GstVideoInfo info;
+
+  /* hashing jobs, in buffer order; results are written in that order as
+   * soon as the job at the head of the queue is done */
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+  GQueue jobs;
+  guint max_pending;
 };
 
 struct _GstChecksumSinkClass
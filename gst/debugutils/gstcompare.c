@@ -55,7 +55,10 @@ enum GstCompareMethod
 {
   GST_COMPARE_METHOD_MEM,
   GST_COMPARE_METHOD_MAX,
-  GST_COMPARE_METHOD_SSIM
+  GST_COMPARE_METHOD_SSIM,
+  GST_COMPARE_METHOD_PSNR,
+  GST_COMPARE_METHOD_SSIM_FAST,
+  GST_COMPARE_METHOD_MS_SSIM
 };
 
 #define GST_COMPARE_METHOD_TYPE (gst_compare_method_get_type())
@@ -68,6 +71,10 @@ gst_compare_method_get_type (void)
     {GST_COMPARE_METHOD_MEM, "Memory", "mem"},
     {GST_COMPARE_METHOD_MAX, "Maximum metric", "max"},
     {GST_COMPARE_METHOD_SSIM, "SSIM (raw video)", "ssim"},
+    {GST_COMPARE_METHOD_PSNR, "PSNR in dB (raw video)", "psnr"},
+    {GST_COMPARE_METHOD_SSIM_FAST,
+        "SSIM using block sums and threads (raw video)", "ssim-fast"},
+    {GST_COMPARE_METHOD_MS_SSIM, "Multi-scale SSIM (raw video)", "ms-ssim"},
     {0, NULL, NULL}
   };
 
@@ -91,7 +98,9 @@ enum
   PROP_OFFSET_TS,
   PROP_METHOD,
   PROP_THRESHOLD,
-  PROP_UPPER
+  PROP_UPPER,
+  PROP_N_THREADS,
+  PROP_POST_SCORES
 };
 
 #define DEFAULT_META             GST_BUFFER_COPY_ALL
@@ -99,6 +108,8 @@ enum
 #define DEFAULT_METHOD           GST_COMPARE_METHOD_MEM
 #define DEFAULT_THRESHOLD        0
 #define DEFAULT_UPPER            TRUE
+#define DEFAULT_N_THREADS        0
+#define DEFAULT_POST_SCORES      TRUE
 
 static void gst_compare_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec);
@@ -125,6 +136,9 @@ gst_compare_finalize (GObject * object)
 
   gst_object_unref (comp->cpads);
 
+  if (comp->metrics)
+    gst_compare_metrics_free (comp->metrics);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -168,6 +182,16 @@ gst_compare_class_init (GstCompareClass * klass)
       g_param_spec_boolean ("upper", "Threshold Upper Bound",
           "Whether threshold value is upper bound or lower bound for difference measure",
           DEFAULT_UPPER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Number of threads used by the psnr, ssim-fast and ms-ssim methods "
+          "(0 = one per CPU)", 0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_POST_SCORES,
+      g_param_spec_boolean ("post-scores", "Post Scores",
+          "Post a score message for every frame compared by the psnr, "
+          "ssim-fast and ms-ssim methods",
+          DEFAULT_POST_SCORES, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_static_pad_template (gstelement_class, &src_factory);
   gst_element_class_add_static_pad_template (gstelement_class, &sink_factory);
@@ -210,6 +234,8 @@ gst_compare_init (GstCompare * comp)
   comp->method = DEFAULT_METHOD;
   comp->threshold = DEFAULT_THRESHOLD;
   comp->upper = DEFAULT_UPPER;
+  comp->n_threads = DEFAULT_N_THREADS;
+  comp->post_scores = DEFAULT_POST_SCORES;
 
   gst_compare_reset (comp);
 }
@@ -217,6 +243,7 @@ gst_compare_init (GstCompare * comp)
 static void
 gst_compare_reset (GstCompare * comp)
 {
+  comp->frames = 0;
 }
 
 static gboolean
@@ -507,6 +534,122 @@ unsupported_input:
   }
 }
 
+static void
+gst_compare_post_scores (GstCompare * comp, GstBuffer * buf,
+    const gchar * method, gdouble score, const gdouble * comp_scores,
+    gint comps, GstClockTime processing_time)
+{
+  GValue scores = G_VALUE_INIT;
+  GValue v = G_VALUE_INIT;
+  GstStructure *s;
+  gint i;
+
+  g_value_init (&scores, GST_TYPE_ARRAY);
+  g_value_init (&v, G_TYPE_DOUBLE);
+  for (i = 0; i < comps; i++) {
+    g_value_set_double (&v, comp_scores[i]);
+    gst_value_array_append_value (&scores, &v);
+  }
+  g_value_unset (&v);
+
+  s = gst_structure_new ("score", "method", G_TYPE_STRING, method,
+      "frame", G_TYPE_UINT64, comp->frames,
+      "timestamp", G_TYPE_UINT64, GST_BUFFER_PTS (buf),
+      "score", G_TYPE_DOUBLE, score,
+      "processing-time", G_TYPE_UINT64, processing_time, NULL);
+  gst_structure_take_value (s, "component-scores", &scores);
+
+  gst_element_post_message (GST_ELEMENT (comp),
+      gst_message_new_element (GST_OBJECT (comp), s));
+}
+
+static gdouble
+gst_compare_quality (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
+    GstBuffer * buf2, GstCaps * caps2, GstCompareMetric metric)
+{
+  GstVideoInfo info1, info2;
+  GstVideoFrame frame1, frame2;
+  gdouble comp_scores[GST_VIDEO_MAX_COMPONENTS], score;
+  GstClockTime start;
+  guint n_threads;
+  gboolean ret;
+
+  if (!caps1 || !gst_video_info_from_caps (&info1, caps1))
+    goto invalid_input;
+
+  if (!caps2 || !gst_video_info_from_caps (&info2, caps2))
+    goto invalid_input;
+
+  if (GST_VIDEO_INFO_FORMAT (&info1) != GST_VIDEO_INFO_FORMAT (&info2) ||
+      GST_VIDEO_INFO_WIDTH (&info1) != GST_VIDEO_INFO_WIDTH (&info2) ||
+      GST_VIDEO_INFO_HEIGHT (&info1) != GST_VIDEO_INFO_HEIGHT (&info2))
+    return comp->upper ? comp->threshold + 1 : 0;
+
+  if (!gst_compare_metrics_format_supported (&info1))
+    goto unsupported_input;
+
+  n_threads = comp->n_threads ? comp->n_threads : g_get_num_processors ();
+  if (comp->metrics &&
+      gst_compare_metrics_get_n_threads (comp->metrics) != n_threads) {
+    gst_compare_metrics_free (comp->metrics);
+    comp->metrics = NULL;
+  }
+  if (!comp->metrics)
+    comp->metrics = gst_compare_metrics_new (n_threads);
+
+  if (!gst_video_frame_map (&frame1, &info1, buf1, GST_MAP_READ))
+    goto map_failed;
+  if (!gst_video_frame_map (&frame2, &info2, buf2, GST_MAP_READ)) {
+    gst_video_frame_unmap (&frame1);
+    goto map_failed;
+  }
+
+  start = gst_util_get_timestamp ();
+  ret = gst_compare_metrics_frame (comp->metrics, metric, &frame1, &frame2,
+      comp_scores, &score);
+
+  gst_video_frame_unmap (&frame1);
+  gst_video_frame_unmap (&frame2);
+
+  if (!ret)
+    goto unsupported_input;
+
+  GST_LOG_OBJECT (comp, "frame %" G_GUINT64_FORMAT " score %f",
+      comp->frames, score);
+
+  if (comp->post_scores) {
+    GEnumValue *method;
+
+    method = g_enum_get_value (g_type_class_peek (GST_COMPARE_METHOD_TYPE),
+        comp->method);
+    gst_compare_post_scores (comp, buf1, method->value_nick, score,
+        comp_scores, GST_VIDEO_INFO_N_COMPONENTS (&info1),
+        gst_util_get_timestamp () - start);
+  }
+  comp->frames++;
+
+  return score;
+
+  /* ERRORS */
+invalid_input:
+  {
+    GST_ERROR_OBJECT (comp, "%s method needs raw video input",
+        metric == GST_COMPARE_METRIC_PSNR ? "psnr" : "ssim");
+    return 0;
+  }
+unsupported_input:
+  {
+    GST_ERROR_OBJECT (comp, "raw video format not supported %" GST_PTR_FORMAT,
+        caps1);
+    return 0;
+  }
+map_failed:
+  {
+    GST_ERROR_OBJECT (comp, "failed to map video frame");
+    return 0;
+  }
+}
+
 static void
 gst_compare_buffers (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
     GstBuffer * buf2, GstCaps * caps2)
@@ -543,6 +686,18 @@ gst_compare_buffers (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
       case GST_COMPARE_METHOD_SSIM:
         delta = gst_compare_ssim (comp, buf1, caps1, buf2, caps2);
         break;
+      case GST_COMPARE_METHOD_PSNR:
+        delta = gst_compare_quality (comp, buf1, caps1, buf2, caps2,
+            GST_COMPARE_METRIC_PSNR);
+        break;
+      case GST_COMPARE_METHOD_SSIM_FAST:
+        delta = gst_compare_quality (comp, buf1, caps1, buf2, caps2,
+            GST_COMPARE_METRIC_SSIM);
+        break;
+      case GST_COMPARE_METHOD_MS_SSIM:
+        delta = gst_compare_quality (comp, buf1, caps1, buf2, caps2,
+            GST_COMPARE_METRIC_MS_SSIM);
+        break;
       default:
         g_assert_not_reached ();
         break;
@@ -627,6 +782,12 @@ gst_compare_set_property (GObject * object, guint prop_id,
     case PROP_UPPER:
       comp->upper = g_value_get_boolean (value);
       break;
+    case PROP_N_THREADS:
+      comp->n_threads = g_value_get_uint (value);
+      break;
+    case PROP_POST_SCORES:
+      comp->post_scores = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -655,6 +816,12 @@ gst_compare_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_UPPER:
       g_value_set_boolean (value, comp->upper);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, comp->n_threads);
+      break;
+    case PROP_POST_SCORES:
+      g_value_set_boolean (value, comp->post_scores);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
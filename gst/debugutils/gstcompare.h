@@ -27,6 +27,8 @@
 
 #include <gst/gst.h>
 
+#include "gstcomparemetrics.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_COMPARE \
@@ -55,6 +57,10 @@ struct _GstCompare {
   GstCollectPads *cpads;
 
   gint count;
+  guint64 frames;
+
+  /* created on first use by the psnr and ssim methods */
+  GstCompareMetrics *metrics;
 
   /* properties */
   GstBufferCopyFlags meta;
@@ -62,6 +68,8 @@ struct _GstCompare {
   gint method;
   gdouble threshold;
   gboolean upper;
+  guint n_threads;
+  gboolean post_scores;
 };
 
 struct _GstCompareClass {
@@ -0,0 +1,699 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Quality metrics engine for the compare element.
+ *
+ * SSIM uses the same window layout as the plain "ssim" method (16x16
+ * windows, moving by 8 pixels), but rather than summing every window from
+ * scratch, each component is first reduced to a grid of 8x8 block sums.
+ * Every window is then the sum of 2x2 neighbouring blocks, so each sample is
+ * read exactly once.  Both passes are split in horizontal slices that are run
+ * on a private thread pool.  The per-row kernels are plain loops over
+ * contiguous samples, written so the compiler can vectorize them.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#include "gstcomparemetrics.h"
+
+#define BLOCK_SIZE 8
+#define MS_SSIM_SCALES 5
+
+static const gdouble ms_ssim_weights[MS_SSIM_SCALES] = {
+  0.0448, 0.2856, 0.3001, 0.2363, 0.1333
+};
+
+typedef struct
+{
+  guint64 s1, s2;
+  guint64 ss1, ss2, s12;
+} GstCompareBlock;
+
+/* one component of both frames */
+typedef struct
+{
+  const guint8 *data1, *data2;
+  gint stride1, stride2;        /* in bytes */
+  gint width, height;
+  gint step;                    /* in samples */
+  gint bps;                     /* bytes per sample, 1 or 2 */
+} GstComparePlane;
+
+typedef struct
+{
+  const GstComparePlane *plane;
+  gint bw, bh;
+  gdouble c1, c2;
+} GstCompareJob;
+
+typedef struct
+{
+  gdouble ssim;
+  gdouble cs;
+  guint count;
+  guint64 sse;
+} GstCompareSliceResult;
+
+typedef void (*GstCompareSliceFunc) (GstCompareMetrics * metrics,
+    const GstCompareJob * job, gint slice, gint n_slices);
+
+struct _GstCompareMetrics
+{
+  guint n_threads;
+  GThreadPool *pool;
+
+  GMutex lock;
+  GCond cond;
+  gint pending;
+
+  /* current parallel run */
+  GstCompareSliceFunc func;
+  const GstCompareJob *job;
+  gint n_slices;
+
+  /* one per thread */
+  GstCompareSliceResult *results;
+
+  GstCompareBlock *blocks;
+  gsize n_blocks;
+
+  /* MS-SSIM downscaled planes, [frame][ping-pong] */
+  guint16 *scaled[2][2];
+  gsize scaled_size;
+};
+
+static void
+slice_range (gint n, gint slice, gint n_slices, gint * start, gint * end)
+{
+  *start = (n * slice) / n_slices;
+  *end = (n * (slice + 1)) / n_slices;
+}
+
+static void
+gst_compare_metrics_worker (gpointer data, gpointer user_data)
+{
+  GstCompareMetrics *metrics = user_data;
+
+  metrics->func (metrics, metrics->job, GPOINTER_TO_INT (data),
+      metrics->n_slices);
+
+  g_mutex_lock (&metrics->lock);
+  if (--metrics->pending == 0)
+    g_cond_signal (&metrics->cond);
+  g_mutex_unlock (&metrics->lock);
+}
+
+/* runs @func for each of @n_rows split in slices, the calling thread
+ * takes the first slice itself */
+static void
+gst_compare_metrics_run (GstCompareMetrics * metrics,
+    GstCompareSliceFunc func, const GstCompareJob * job, gint n_rows)
+{
+  gint i, n_slices;
+
+  n_slices = MIN ((gint) metrics->n_threads, n_rows);
+  if (n_slices <= 0)
+    return;
+
+  if (n_slices == 1 || metrics->pool == NULL) {
+    func (metrics, job, 0, 1);
+    return;
+  }
+
+  metrics->func = func;
+  metrics->job = job;
+  metrics->n_slices = n_slices;
+
+  g_mutex_lock (&metrics->lock);
+  metrics->pending = n_slices - 1;
+  g_mutex_unlock (&metrics->lock);
+
+  for (i = 1; i < n_slices; i++)
+    g_thread_pool_push (metrics->pool, GINT_TO_POINTER (i), NULL);
+
+  func (metrics, job, 0, n_slices);
+
+  g_mutex_lock (&metrics->lock);
+  while (metrics->pending > 0)
+    g_cond_wait (&metrics->cond, &metrics->lock);
+  g_mutex_unlock (&metrics->lock);
+}
+
+/* row kernels; @step is a constant 1 for the common planar case once
+ * inlined, which is what allows the loops to be vectorized */
+#define DEFINE_ACCUMULATE_ROW(name,type,acc)                            \
+static inline void                                                      \
+name (const guint8 * row1, const guint8 * row2, gint width, gint step,  \
+    GstCompareBlock * blocks)                                           \
+{                                                                       \
+  const type *p1 = (const type *) row1;                                 \
+  const type *p2 = (const type *) row2;                                 \
+  gint x0, x;                                                           \
+                                                                        \
+  for (x0 = 0; x0 < width; x0 += BLOCK_SIZE, blocks++) {                \
+    gint xe = MIN (x0 + BLOCK_SIZE, width);                             \
+    acc s1 = 0, s2 = 0, ss1 = 0, ss2 = 0, s12 = 0;                      \
+                                                                        \
+    for (x = x0; x < xe; x++) {                                         \
+      acc a = p1[x * step];                                             \
+      acc b = p2[x * step];                                             \
+                                                                        \
+      s1 += a;                                                          \
+      s2 += b;                                                          \
+      ss1 += a * a;                                                     \
+      ss2 += b * b;                                                     \
+      s12 += a * b;                                                     \
+    }                                                                   \
+    blocks->s1 += s1;                                                   \
+    blocks->s2 += s2;                                                   \
+    blocks->ss1 += ss1;                                                 \
+    blocks->ss2 += ss2;                                                 \
+    blocks->s12 += s12;                                                 \
+  }                                                                     \
+}
+
+DEFINE_ACCUMULATE_ROW (accumulate_row_u8, guint8, guint32)
+DEFINE_ACCUMULATE_ROW (accumulate_row_u16, guint16, guint64)
+
+#define DEFINE_SSE_ROW(name,type)                                       \
+static inline guint64                                                   \
+name (const guint8 * row1, const guint8 * row2, gint width, gint step)  \
+{                                                                       \
+  const type *p1 = (const type *) row1;                                 \
+  const type *p2 = (const type *) row2;                                 \
+  guint64 sse = 0;                                                      \
+  gint x;                                                               \
+                                                                        \
+  for (x = 0; x < width; x++) {                                         \
+    gint64 d = (gint64) p1[x * step] - (gint64) p2[x * step];           \
+                                                                        \
+    sse += d * d;                                                       \
+  }                                                                     \
+  return sse;                                                           \
+}
+
+DEFINE_SSE_ROW (sse_row_u8, guint8)
+DEFINE_SSE_ROW (sse_row_u16, guint16)
+
+#define DEFINE_DOWNSCALE_ROW(name,type)                                 \
+static inline void                                                      \
+name (const guint8 * row0, const guint8 * row1, guint16 * dest,         \
+    gint width, gint step)                                              \
+{                                                                       \
+  const type *p0 = (const type *) row0;                                 \
+  const type *p1 = (const type *) row1;                                 \
+  gint x;                                                               \
+                                                                        \
+  for (x = 0; x < width; x++) {                                         \
+    guint sum = p0[2 * x * step] + p0[(2 * x + 1) * step] +             \
+        p1[2 * x * step] + p1[(2 * x + 1) * step];                      \
+                                                                        \
+    dest[x] = (sum + 2) >> 2;                                           \
+  }                                                                     \
+}
+
+DEFINE_DOWNSCALE_ROW (downscale_row_u8, guint8)
+DEFINE_DOWNSCALE_ROW (downscale_row_u16, guint16)
+
+static void
+accumulate_row (const GstComparePlane * plane, gint y, GstCompareBlock * blocks)
+{
+  const guint8 *row1 = plane->data1 + y * plane->stride1;
+  const guint8 *row2 = plane->data2 + y * plane->stride2;
+
+  if (plane->bps == 1) {
+    if (plane->step == 1)
+      accumulate_row_u8 (row1, row2, plane->width, 1, blocks);
+    else
+      accumulate_row_u8 (row1, row2, plane->width, plane->step, blocks);
+  } else {
+    if (plane->step == 1)
+      accumulate_row_u16 (row1, row2, plane->width, 1, blocks);
+    else
+      accumulate_row_u16 (row1, row2, plane->width, plane->step, blocks);
+  }
+}
+
+static guint64
+sse_row (const GstComparePlane * plane, gint y)
+{
+  const guint8 *row1 = plane->data1 + y * plane->stride1;
+  const guint8 *row2 = plane->data2 + y * plane->stride2;
+
+  if (plane->bps == 1) {
+    if (plane->step == 1)
+      return sse_row_u8 (row1, row2, plane->width, 1);
+    return sse_row_u8 (row1, row2, plane->width, plane->step);
+  } else {
+    if (plane->step == 1)
+      return sse_row_u16 (row1, row2, plane->width, 1);
+    return sse_row_u16 (row1, row2, plane->width, plane->step);
+  }
+}
+
+static void
+block_sums_slice (GstCompareMetrics * metrics, const GstCompareJob * job,
+    gint slice, gint n_slices)
+{
+  const GstComparePlane *plane = job->plane;
+  gint by0, by1, by, y;
+
+  slice_range (job->bh, slice, n_slices, &by0, &by1);
+
+  memset (metrics->blocks + by0 * job->bw, 0,
+      (by1 - by0) * job->bw * sizeof (GstCompareBlock));
+
+  for (by = by0; by < by1; by++) {
+    GstCompareBlock *blocks = metrics->blocks + by * job->bw;
+    gint ye = MIN ((by + 1) * BLOCK_SIZE, plane->height);
+
+    for (y = by * BLOCK_SIZE; y < ye; y++)
+      accumulate_row (plane, y, blocks);
+  }
+}
+
+static void
+ssim_windows_slice (GstCompareMetrics * metrics, const GstCompareJob * job,
+    gint slice, gint n_slices)
+{
+  const GstComparePlane *plane = job->plane;
+  GstCompareSliceResult *res = &metrics->results[slice];
+  gint by0, by1, by, bx;
+
+  res->ssim = 0;
+  res->cs = 0;
+  res->count = 0;
+
+  /* a window spans blocks (bx, by) to (bx + 1, by + 1) */
+  slice_range (job->bh - 1, slice, n_slices, &by0, &by1);
+
+  for (by = by0; by < by1; by++) {
+    const GstCompareBlock *b0 = metrics->blocks + by * job->bw;
+    const GstCompareBlock *b1 = b0 + job->bw;
+    gint wh = MIN (2 * BLOCK_SIZE, plane->height - by * BLOCK_SIZE);
+
+    for (bx = 0; bx < job->bw - 1; bx++) {
+      gint ww = MIN (2 * BLOCK_SIZE, plane->width - bx * BLOCK_SIZE);
+      gdouble n = ww * wh;
+      gdouble mu1, mu2, var1, var2, cov, cs;
+
+      mu1 = (b0[bx].s1 + b0[bx + 1].s1 + b1[bx].s1 + b1[bx + 1].s1) / n;
+      mu2 = (b0[bx].s2 + b0[bx + 1].s2 + b1[bx].s2 + b1[bx + 1].s2) / n;
+      var1 = (b0[bx].ss1 + b0[bx + 1].ss1 + b1[bx].ss1 + b1[bx + 1].ss1) / n
+          - mu1 * mu1;
+      var2 = (b0[bx].ss2 + b0[bx + 1].ss2 + b1[bx].ss2 + b1[bx + 1].ss2) / n
+          - mu2 * mu2;
+      cov = (b0[bx].s12 + b0[bx + 1].s12 + b1[bx].s12 + b1[bx + 1].s12) / n
+          - mu1 * mu2;
+
+      cs = (2 * cov + job->c2) / (var1 + var2 + job->c2);
+      res->cs += cs;
+      res->ssim += cs * (2 * mu1 * mu2 + job->c1) /
+          (mu1 * mu1 + mu2 * mu2 + job->c1);
+      res->count++;
+    }
+  }
+}
+
+static void
+sse_slice (GstCompareMetrics * metrics, const GstCompareJob * job,
+    gint slice, gint n_slices)
+{
+  const GstComparePlane *plane = job->plane;
+  GstCompareSliceResult *res = &metrics->results[slice];
+  gint y0, y1, y;
+
+  slice_range (plane->height, slice, n_slices, &y0, &y1);
+
+  res->sse = 0;
+  for (y = y0; y < y1; y++)
+    res->sse += sse_row (plane, y);
+}
+
+static gint
+gst_compare_metrics_n_slices (GstCompareMetrics * metrics, gint n_rows)
+{
+  return CLAMP (n_rows, 0, (gint) metrics->n_threads);
+}
+
+static guint64
+compare_plane_sse (GstCompareMetrics * metrics, const GstComparePlane * plane)
+{
+  GstCompareJob job = { plane, 0, 0, 0, 0 };
+  guint64 sse = 0;
+  gint i, n_slices;
+
+  n_slices = gst_compare_metrics_n_slices (metrics, plane->height);
+  gst_compare_metrics_run (metrics, sse_slice, &job, plane->height);
+
+  for (i = 0; i < n_slices; i++)
+    sse += metrics->results[i].sse;
+
+  return sse;
+}
+
+static void
+compare_plane_ssim (GstCompareMetrics * metrics, const GstComparePlane * plane,
+    gdouble peak, gdouble * ssim, gdouble * cs)
+{
+  GstCompareJob job;
+  gdouble ssim_sum = 0, cs_sum = 0;
+  guint count = 0;
+  gint i, n_slices;
+
+  job.plane = plane;
+  job.bw = (plane->width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  job.bh = (plane->height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  job.c1 = (0.01 * peak) * (0.01 * peak);
+  job.c2 = (0.03 * peak) * (0.03 * peak);
+
+  /* For empty images, return maximum similarity */
+  if (job.bw < 2 || job.bh < 2) {
+    *ssim = *cs = 1.0;
+    return;
+  }
+
+  if (metrics->n_blocks < (gsize) job.bw * job.bh) {
+    g_free (metrics->blocks);
+    metrics->n_blocks = job.bw * job.bh;
+    metrics->blocks = g_new (GstCompareBlock, metrics->n_blocks);
+  }
+
+  gst_compare_metrics_run (metrics, block_sums_slice, &job, job.bh);
+
+  n_slices = gst_compare_metrics_n_slices (metrics, job.bh - 1);
+  gst_compare_metrics_run (metrics, ssim_windows_slice, &job, job.bh - 1);
+
+  for (i = 0; i < n_slices; i++) {
+    ssim_sum += metrics->results[i].ssim;
+    cs_sum += metrics->results[i].cs;
+    count += metrics->results[i].count;
+  }
+
+  *ssim = ssim_sum / count;
+  *cs = cs_sum / count;
+}
+
+/* downscales @plane by 2 into the @buf ping-pong buffers and updates
+ * @plane to point to the result */
+static void
+compare_plane_downscale (GstCompareMetrics * metrics, GstComparePlane * plane,
+    gint buf)
+{
+  gint width = plane->width / 2;
+  gint height = plane->height / 2;
+  guint16 *dest1 = metrics->scaled[0][buf];
+  guint16 *dest2 = metrics->scaled[1][buf];
+  gint y;
+
+  for (y = 0; y < height; y++) {
+    const guint8 *row1 = plane->data1 + 2 * y * plane->stride1;
+    const guint8 *row2 = plane->data2 + 2 * y * plane->stride2;
+
+    if (plane->bps == 1) {
+      downscale_row_u8 (row1, row1 + plane->stride1, dest1 + y * width,
+          width, plane->step);
+      downscale_row_u8 (row2, row2 + plane->stride2, dest2 + y * width,
+          width, plane->step);
+    } else {
+      downscale_row_u16 (row1, row1 + plane->stride1, dest1 + y * width,
+          width, plane->step);
+      downscale_row_u16 (row2, row2 + plane->stride2, dest2 + y * width,
+          width, plane->step);
+    }
+  }
+
+  plane->data1 = (const guint8 *) dest1;
+  plane->data2 = (const guint8 *) dest2;
+  plane->stride1 = plane->stride2 = width * sizeof (guint16);
+  plane->width = width;
+  plane->height = height;
+  plane->step = 1;
+  plane->bps = 2;
+}
+
+static gdouble
+compare_plane_ms_ssim (GstCompareMetrics * metrics,
+    const GstComparePlane * plane, gdouble peak)
+{
+  GstComparePlane cur = *plane;
+  gdouble cs[MS_SSIM_SCALES], ssim = 1.0;
+  gdouble weight_sum = 0, res = 1.0;
+  gsize needed;
+  gint scale, n_scales = 0, i, j;
+
+  needed = (gsize) (plane->width / 2) * (plane->height / 2);
+  if (metrics->scaled_size < needed) {
+    for (i = 0; i < 2; i++) {
+      for (j = 0; j < 2; j++) {
+        g_free (metrics->scaled[i][j]);
+        metrics->scaled[i][j] = g_new (guint16, needed);
+      }
+    }
+    metrics->scaled_size = needed;
+  }
+
+  /* stop early on small pictures and spread the weights of the
+   * remaining scales */
+  for (scale = 0; scale < MS_SSIM_SCALES; scale++) {
+    compare_plane_ssim (metrics, &cur, peak, &ssim, &cs[scale]);
+    weight_sum += ms_ssim_weights[scale];
+    n_scales++;
+
+    if (cur.width / 2 < 2 * BLOCK_SIZE || cur.height / 2 < 2 * BLOCK_SIZE)
+      break;
+    if (scale + 1 < MS_SSIM_SCALES)
+      compare_plane_downscale (metrics, &cur, scale & 1);
+  }
+
+  for (scale = 0; scale < n_scales - 1; scale++)
+    res *= pow (MAX (cs[scale], 0.0), ms_ssim_weights[scale] / weight_sum);
+  res *= pow (MAX (ssim, 0.0), ms_ssim_weights[n_scales - 1] / weight_sum);
+
+  return res;
+}
+
+static gdouble
+psnr_from_sse (guint64 sse, guint64 n_samples, gdouble peak)
+{
+  gdouble mse;
+
+  if (sse == 0 || n_samples == 0)
+    return GST_COMPARE_METRICS_PSNR_MAX;
+
+  mse = (gdouble) sse / n_samples;
+  return MIN (10.0 * log10 (peak * peak / mse), GST_COMPARE_METRICS_PSNR_MAX);
+}
+
+/**
+ * gst_compare_metrics_new:
+ * @n_threads: number of threads to spread the work over, 0 for one per CPU
+ *
+ * Returns: a new #GstCompareMetrics
+ */
+GstCompareMetrics *
+gst_compare_metrics_new (guint n_threads)
+{
+  GstCompareMetrics *metrics;
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  metrics = g_new0 (GstCompareMetrics, 1);
+  metrics->n_threads = n_threads;
+  metrics->results = g_new0 (GstCompareSliceResult, n_threads);
+  g_mutex_init (&metrics->lock);
+  g_cond_init (&metrics->cond);
+
+  if (n_threads > 1) {
+    metrics->pool = g_thread_pool_new (gst_compare_metrics_worker, metrics,
+        n_threads - 1, TRUE, NULL);
+    if (metrics->pool == NULL)
+      metrics->n_threads = 1;
+  }
+
+  return metrics;
+}
+
+void
+gst_compare_metrics_free (GstCompareMetrics * metrics)
+{
+  gint i, j;
+
+  if (metrics->pool)
+    g_thread_pool_free (metrics->pool, FALSE, TRUE);
+
+  for (i = 0; i < 2; i++) {
+    for (j = 0; j < 2; j++)
+      g_free (metrics->scaled[i][j]);
+  }
+  g_free (metrics->blocks);
+  g_free (metrics->results);
+  g_mutex_clear (&metrics->lock);
+  g_cond_clear (&metrics->cond);
+  g_free (metrics);
+}
+
+guint
+gst_compare_metrics_get_n_threads (GstCompareMetrics * metrics)
+{
+  return metrics->n_threads;
+}
+
+/**
+ * gst_compare_metrics_format_supported:
+ * @info: a #GstVideoInfo
+ *
+ * Returns: %TRUE if every component of @info can be addressed as one
+ * native endian 8 or 16 bit sample
+ */
+gboolean
+gst_compare_metrics_format_supported (const GstVideoInfo * info)
+{
+  const GstVideoFormatInfo *finfo = info->finfo;
+  gint i;
+
+  if (finfo == NULL || GST_VIDEO_INFO_FORMAT (info) == GST_VIDEO_FORMAT_UNKNOWN)
+    return FALSE;
+
+  if (GST_VIDEO_FORMAT_INFO_IS_COMPLEX (finfo) ||
+      GST_VIDEO_FORMAT_INFO_HAS_PALETTE (finfo))
+    return FALSE;
+
+  for (i = 0; i < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); i++) {
+    gint depth = GST_VIDEO_FORMAT_INFO_DEPTH (finfo, i);
+    gint shift = GST_VIDEO_FORMAT_INFO_SHIFT (finfo, i);
+    gint pstride = GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, i);
+    gint bits = depth > 8 ? 16 : 8;
+
+    if (depth > 16 || pstride <= 0 || depth + shift > bits)
+      return FALSE;
+
+    if (bits == 16) {
+      if (pstride % 2)
+        return FALSE;
+      if ((G_BYTE_ORDER == G_LITTLE_ENDIAN) !=
+          (GST_VIDEO_FORMAT_INFO_IS_LE (finfo) != 0))
+        return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_compare_metrics_frame:
+ * @metrics: a #GstCompareMetrics
+ * @metric: the #GstCompareMetric to compute
+ * @frame1: a mapped #GstVideoFrame
+ * @frame2: a mapped #GstVideoFrame of the same format and size
+ * @comp_scores: (out caller-allocates): %GST_VIDEO_MAX_COMPONENTS scores,
+ *     one per component
+ * @score: (out): the weighted score of all components
+ *
+ * Returns: %FALSE if the frames are of an unsupported format
+ */
+gboolean
+gst_compare_metrics_frame (GstCompareMetrics * metrics, GstCompareMetric metric,
+    GstVideoFrame * frame1, GstVideoFrame * frame2, gdouble * comp_scores,
+    gdouble * score)
+{
+  const GstVideoInfo *info = &frame1->info;
+  gdouble weights[GST_VIDEO_MAX_COMPONENTS];
+  guint64 sse_total = 0, n_total = 0;
+  gdouble peak0 = 0;
+  gint i, comps;
+  gboolean yuv;
+
+  if (!gst_compare_metrics_format_supported (info))
+    return FALSE;
+
+  if (GST_VIDEO_FRAME_FORMAT (frame1) != GST_VIDEO_FRAME_FORMAT (frame2) ||
+      GST_VIDEO_FRAME_WIDTH (frame1) != GST_VIDEO_FRAME_WIDTH (frame2) ||
+      GST_VIDEO_FRAME_HEIGHT (frame1) != GST_VIDEO_FRAME_HEIGHT (frame2))
+    return FALSE;
+
+  /* same weighting as the plain ssim method: luma counts for half of the
+   * score in yuv */
+  comps = GST_VIDEO_INFO_N_COMPONENTS (info);
+  yuv = GST_VIDEO_INFO_IS_YUV (info) && comps > 1;
+  for (i = 0; i < comps; i++) {
+    weights[i] = 1.0;
+    if (yuv && i == 0)
+      weights[i] = comps - 1;
+    weights[i] /= yuv ? 2 * (comps - 1) : comps;
+  }
+
+  *score = 0;
+
+  for (i = 0; i < comps; i++) {
+    GstComparePlane plane;
+    gint depth = GST_VIDEO_INFO_COMP_DEPTH (info, i);
+    gdouble peak;
+    gdouble cs;
+
+    peak = (gdouble) (((1 << depth) - 1) << GST_VIDEO_INFO_COMP_SHIFT (info,
+            i));
+
+    plane.data1 = GST_VIDEO_FRAME_COMP_DATA (frame1, i);
+    plane.data2 = GST_VIDEO_FRAME_COMP_DATA (frame2, i);
+    plane.stride1 = GST_VIDEO_FRAME_COMP_STRIDE (frame1, i);
+    plane.stride2 = GST_VIDEO_FRAME_COMP_STRIDE (frame2, i);
+    plane.width = GST_VIDEO_FRAME_COMP_WIDTH (frame1, i);
+    plane.height = GST_VIDEO_FRAME_COMP_HEIGHT (frame1, i);
+    plane.bps = depth > 8 ? 2 : 1;
+    plane.step = GST_VIDEO_FRAME_COMP_PSTRIDE (frame1, i) / plane.bps;
+
+    switch (metric) {
+      case GST_COMPARE_METRIC_PSNR:{
+        guint64 sse = compare_plane_sse (metrics, &plane);
+        guint64 n = (guint64) plane.width * plane.height;
+
+        comp_scores[i] = psnr_from_sse (sse, n, peak);
+        sse_total += sse;
+        n_total += n;
+        if (i == 0)
+          peak0 = peak;
+        break;
+      }
+      case GST_COMPARE_METRIC_SSIM:
+        compare_plane_ssim (metrics, &plane, peak, &comp_scores[i], &cs);
+        *score += weights[i] * comp_scores[i];
+        break;
+      case GST_COMPARE_METRIC_MS_SSIM:
+        comp_scores[i] = compare_plane_ms_ssim (metrics, &plane, peak);
+        *score += weights[i] * comp_scores[i];
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+  }
+
+  /* overall PSNR is that of the mean squared error of all samples */
+  if (metric == GST_COMPARE_METRIC_PSNR)
+    *score = psnr_from_sse (sse_total, n_total, peak0);
+
+  return TRUE;
+}
@@ -0,0 +1,57 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_COMPARE_METRICS_H__
+#define __GST_COMPARE_METRICS_H__
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GST_COMPARE_METRIC_PSNR,
+  GST_COMPARE_METRIC_SSIM,
+  GST_COMPARE_METRIC_MS_SSIM
+} GstCompareMetric;
+
+/* upper bound reported for identical planes, where PSNR is infinite */
+#define GST_COMPARE_METRICS_PSNR_MAX 100.0
+
+typedef struct _GstCompareMetrics GstCompareMetrics;
+
+GstCompareMetrics * gst_compare_metrics_new          (guint n_threads);
+
+void                gst_compare_metrics_free         (GstCompareMetrics * metrics);
+
+guint               gst_compare_metrics_get_n_threads (GstCompareMetrics * metrics);
+
+gboolean            gst_compare_metrics_format_supported (const GstVideoInfo * info);
+
+gboolean            gst_compare_metrics_frame        (GstCompareMetrics * metrics,
+                                                      GstCompareMetric metric,
+                                                      GstVideoFrame * frame1,
+                                                      GstVideoFrame * frame2,
+                                                      gdouble * comp_scores,
+                                                      gdouble * score);
+
+G_END_DECLS
+
+#endif /* __GST_COMPARE_METRICS_H__ */
@@ -59,7 +59,8 @@ enum
   PROP_0,
   PROP_ENABLE,
   PROP_MAX_PAGE_TIMEOUT,
-  PROP_FORCE_END
+  PROP_FORCE_END,
+  PROP_STATS
 };
 
 #define DEFAULT_ENABLE (TRUE)
@@ -159,6 +160,18 @@ gst_dvbsub_overlay_class_init (GstDVBSubOverlayClass * klass)
           "Assume PES-aligned subtitles and force end-of-display",
           DEFAULT_FORCE_END, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDVBSubOverlay:stats:
+   *
+   * Counts and times (in nanoseconds) the conversions of the DVB subtitle
+   * pages and the frames they are blended on or attached to.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics", "Various statistics",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_dvbsub_overlay_change_state);
 
@@ -309,6 +322,39 @@ gst_dvbsub_overlay_set_property (GObject * object, guint prop_id,
   }
 }
 
+static GstStructure *
+gst_dvbsub_overlay_get_stats (GstDVBSubOverlay * overlay)
+{
+  GstStructure *s;
+  guint pixels = 0;
+  guint i, n;
+
+  g_mutex_lock (&overlay->dvbsub_mutex);
+  if (overlay->current_comp) {
+    n = gst_video_overlay_composition_n_rectangles (overlay->current_comp);
+    for (i = 0; i < n; i++) {
+      guint w, h;
+
+      gst_video_overlay_rectangle_get_render_rectangle
+          (gst_video_overlay_composition_get_rectangle (overlay->current_comp,
+              i), NULL, NULL, &w, &h);
+      pixels += w * h;
+    }
+  }
+
+  s = gst_structure_new ("application/x-dvbsub-overlay-stats",
+      "rendered", G_TYPE_UINT64, overlay->stats_rendered,
+      "render-cost", G_TYPE_UINT64, overlay->stats_render_cost,
+      "overlaid", G_TYPE_UINT64, overlay->stats_overlaid,
+      "last-cost", G_TYPE_UINT64, overlay->stats_last_cost,
+      "average-cost", G_TYPE_UINT64, overlay->stats_overlaid ?
+      overlay->stats_overlay_cost / overlay->stats_overlaid : 0,
+      "pixels", G_TYPE_UINT, pixels, NULL);
+  g_mutex_unlock (&overlay->dvbsub_mutex);
+
+  return s;
+}
+
 static void
 gst_dvbsub_overlay_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
@@ -325,6 +371,9 @@ gst_dvbsub_overlay_get_property (GObject * object, guint prop_id,
     case PROP_FORCE_END:
       g_value_set_boolean (value, g_atomic_int_get (&overlay->force_end));
       break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_dvbsub_overlay_get_stats (overlay));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -933,7 +982,7 @@ gst_dvbsub_overlay_subs_to_comp (GstDVBSubOverlay * overlay,
   for (i = 0; i < subs->num_rects; i++) {
     DVBSubtitleRect *srect = &subs->rects[i];
     GstBuffer *buf;
-    gint w, h;
+    gint x0, y0, x1, y1;
     guint8 *in_data;
     guint32 *palette, *data;
     gint rx, ry, rw, rh, stride;
@@ -943,17 +992,38 @@ gst_dvbsub_overlay_subs_to_comp (GstDVBSubOverlay * overlay,
     GST_LOG_OBJECT (overlay, "rectangle %d: %dx%d @ (%d, %d)", i,
         srect->w, srect->h, srect->x, srect->y);
 
-    w = srect->w;
-    h = srect->h;
+    palette = srect->pict.palette;
+    stride = srect->pict.rowstride;
+
+    /* Regions are mostly transparent around the text, only keep the
+     * bounding box of the visible pixels so that blending doesn't have to
+     * go over the rest on every frame */
+    x0 = srect->w;
+    y0 = srect->h;
+    x1 = y1 = 0;
+    for (k = 0; k < srect->h; k++) {
+      in_data = srect->pict.data + k * stride;
+      for (l = 0; l < srect->w; l++) {
+        if (palette[in_data[l]] >> 24) {
+          x0 = MIN (x0, l);
+          x1 = MAX (x1, l + 1);
+          y0 = MIN (y0, k);
+          y1 = k + 1;
+        }
+      }
+    }
+
+    if (x0 >= x1 || y0 >= y1) {
+      GST_LOG_OBJECT (overlay, "rectangle %d is fully transparent", i);
+      continue;
+    }
 
-    buf = gst_buffer_new_and_alloc (w * h * 4);
+    buf = gst_buffer_new_and_alloc ((x1 - x0) * (y1 - y0) * 4);
     gst_buffer_map (buf, &map, GST_MAP_WRITE);
     data = (guint32 *) map.data;
-    in_data = srect->pict.data;
-    palette = srect->pict.palette;
-    stride = srect->pict.rowstride;
-    for (k = 0; k < h; k++) {
-      for (l = 0; l < w; l++) {
+    for (k = y0; k < y1; k++) {
+      in_data = srect->pict.data + k * stride + x0;
+      for (l = x0; l < x1; l++) {
         guint32 ayuv;
 
         ayuv = palette[*in_data];
@@ -961,7 +1031,6 @@ gst_dvbsub_overlay_subs_to_comp (GstDVBSubOverlay * overlay,
         in_data++;
         data++;
       }
-      in_data += stride - w;
     }
     gst_buffer_unmap (buf, &map);
 
@@ -969,16 +1038,16 @@ gst_dvbsub_overlay_subs_to_comp (GstDVBSubOverlay * overlay,
      * to the window (if there is one) within a display of specified dimension.
      * Coordinate wrt the latter is then scaled to the actual dimension of
      * the video we are dealing with here. */
-    rx = gst_util_uint64_scale (wx + srect->x, width, dw);
-    ry = gst_util_uint64_scale (wy + srect->y, height, dh);
-    rw = gst_util_uint64_scale (srect->w, width, dw);
-    rh = gst_util_uint64_scale (srect->h, height, dh);
+    rx = gst_util_uint64_scale (wx + srect->x + x0, width, dw);
+    ry = gst_util_uint64_scale (wy + srect->y + y0, height, dh);
+    rw = gst_util_uint64_scale (x1 - x0, width, dw);
+    rh = gst_util_uint64_scale (y1 - y0, height, dh);
 
     GST_LOG_OBJECT (overlay, "rectangle %d rendered: %dx%d @ (%d, %d)", i,
         rw, rh, rx, ry);
 
     gst_buffer_add_video_meta (buf, GST_VIDEO_FRAME_FLAG_NONE,
-        GST_VIDEO_OVERLAY_COMPOSITION_FORMAT_YUV, w, h);
+        GST_VIDEO_OVERLAY_COMPOSITION_FORMAT_YUV, x1 - x0, y1 - y0);
     rect = gst_video_overlay_rectangle_new_raw (buf, rx, ry, rw, rh, 0);
     g_assert (rect);
     if (comp) {
@@ -1003,6 +1072,7 @@ gst_dvbsub_overlay_chain_video (GstPad * pad, GstObject * parent,
   guint64 cstart, cstop;
   gboolean in_seg;
   GstClockTime vid_running_time, vid_running_time_end;
+  GstClockTime render_start;
 
   if (GST_VIDEO_INFO_FORMAT (&overlay->info) == GST_VIDEO_FORMAT_UNKNOWN)
     return GST_FLOW_NOT_NEGOTIATED;
@@ -1099,8 +1169,13 @@ gst_dvbsub_overlay_chain_video (GstPad * pad, GstObject * parent,
       overlay->current_subtitle = candidate;
       if (overlay->current_comp)
         gst_video_overlay_composition_unref (overlay->current_comp);
+      /* The composition is only built once per page, later frames get
+       * the same one */
+      render_start = gst_util_get_timestamp ();
       overlay->current_comp =
           gst_dvbsub_overlay_subs_to_comp (overlay, overlay->current_subtitle);
+      overlay->stats_render_cost += gst_util_get_timestamp () - render_start;
+      overlay->stats_rendered++;
     }
   }
 
@@ -1118,10 +1193,12 @@ gst_dvbsub_overlay_chain_video (GstPad * pad, GstObject * parent,
   }
 
   /* Now render it */
-  if (g_atomic_int_get (&overlay->enable) && overlay->current_subtitle) {
+  if (g_atomic_int_get (&overlay->enable) && overlay->current_subtitle
+      && overlay->current_comp) {
     GstVideoFrame frame;
+    GstClockTime cost;
 
-    g_assert (overlay->current_comp);
+    render_start = gst_util_get_timestamp ();
     if (overlay->attach_compo_to_buffer) {
       GST_DEBUG_OBJECT (overlay, "Attaching overlay image to video buffer");
       gst_buffer_add_video_overlay_composition_meta (buffer,
@@ -1132,6 +1209,10 @@ gst_dvbsub_overlay_chain_video (GstPad * pad, GstObject * parent,
       gst_video_overlay_composition_blend (overlay->current_comp, &frame);
       gst_video_frame_unmap (&frame);
     }
+    cost = gst_util_get_timestamp () - render_start;
+    overlay->stats_overlaid++;
+    overlay->stats_last_cost = cost;
+    overlay->stats_overlay_cost += cost;
   }
   g_mutex_unlock (&overlay->dvbsub_mutex);
 
@@ -68,6 +68,13 @@ struct _GstDVBSubOverlay
   GstClockTime last_text_pts;
 
   gboolean attach_compo_to_buffer;
+
+  /* statistics, with the dvbsub_mutex */
+  guint64 stats_rendered;
+  GstClockTime stats_render_cost;
+  guint64 stats_overlaid;
+  GstClockTime stats_last_cost;
+  GstClockTime stats_overlay_cost;
 };
 
 struct _GstDVBSubOverlayClass
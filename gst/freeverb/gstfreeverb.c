@@ -34,6 +34,11 @@
  *
  * Reverberation/room effect.
  *
+ * Mono input is turned into stereo. Stereo and multi-channel input up to 7.1
+ * keeps its layout: every channel gets its own reverb, left/right pairs are
+ * mixed like stereo according to #GstFreeverb:width and LFE channels are
+ * passed through unchanged.
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 audiotestsrc wave=saw ! freeverb ! autoaudiosink
@@ -59,6 +64,10 @@
 
 #include "gstfreeverb.h"
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
 #define GST_CAT_DEFAULT gst_freeverb_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
@@ -71,12 +80,14 @@ enum
   PROP_LEVEL
 };
 
+#define MAX_CHANNELS 8
+
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
         "format = (string) { " GST_AUDIO_NE (F32) ", " GST_AUDIO_NE (S16) "}, "
-        "rate = (int) [ 1, MAX ], " "channels = (int) [ 1, 2 ], "
+        "rate = (int) [ 1, MAX ], " "channels = (int) [ 1, 8 ], "
         "layout = (string) interleaved")
     );
 
@@ -85,7 +96,7 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
         "format = (string) { " GST_AUDIO_NE (F32) ", " GST_AUDIO_NE (S16) "}, "
-        "rate = (int) [ 1, MAX ], " "channels = (int) 2, "
+        "rate = (int) [ 1, MAX ], " "channels = (int) [ 2, 8 ], "
         "layout = (string) interleaved")
     );
 
@@ -109,26 +120,16 @@ static gboolean gst_freeverb_set_caps (GstBaseTransform * base,
 static GstFlowReturn gst_freeverb_transform (GstBaseTransform * base,
     GstBuffer * inbuf, GstBuffer * outbuf);
 
-static gboolean gst_freeverb_transform_m2s_int (GstFreeverb * filter,
-    gint16 * idata, gint16 * odata, guint num_samples);
-static gboolean gst_freeverb_transform_s2s_int (GstFreeverb * filter,
+static gboolean gst_freeverb_transform_int (GstFreeverb * filter,
     gint16 * idata, gint16 * odata, guint num_samples);
-static gboolean gst_freeverb_transform_m2s_float (GstFreeverb * filter,
-    gfloat * idata, gfloat * odata, guint num_samples);
-static gboolean gst_freeverb_transform_s2s_float (GstFreeverb * filter,
+static gboolean gst_freeverb_transform_float (GstFreeverb * filter,
     gfloat * idata, gfloat * odata, guint num_samples);
 
 
-/* Table with processing functions: [channels][format] */
-static const GstFreeverbProcessFunc process_functions[2][2] = {
-  {
-        (GstFreeverbProcessFunc) gst_freeverb_transform_m2s_int,
-        (GstFreeverbProcessFunc) gst_freeverb_transform_m2s_float,
-      },
-  {
-        (GstFreeverbProcessFunc) gst_freeverb_transform_s2s_int,
-        (GstFreeverbProcessFunc) gst_freeverb_transform_s2s_float,
-      }
+/* Table with processing functions: [format] */
+static const GstFreeverbProcessFunc process_functions[2] = {
+  (GstFreeverbProcessFunc) gst_freeverb_transform_int,
+  (GstFreeverbProcessFunc) gst_freeverb_transform_float,
 };
 
 /***************************************************************
@@ -144,12 +145,22 @@ static const GstFreeverbProcessFunc process_functions[2][2] = {
  * outside world (i.e. it does not appear at the output.  There is a
  * very small turn-on transient response, which should not cause
  * problems.
+ *
+ * On x86 the blocks are additionally processed with denormals flushed to
+ * zero, which also covers the feedback paths that the offset does not keep
+ * away from zero.
  */
 
 //#define DC_OFFSET 0
 #define DC_OFFSET 1e-8
 //#define DC_OFFSET 0.001f
 
+/* The filters run over blocks of samples, one filter after the other. The
+ * combs are independent and the allpasses in series, so this gives the same
+ * result as running all of them sample by sample, but keeps the state of one
+ * filter in registers and walks its delay line linearly. */
+#define BLOCK_SIZE 256
+
 /* all pass filter */
 
 typedef struct _freeverb_allpass
@@ -181,7 +192,7 @@ freeverb_allpass_init (freeverb_allpass * allpass)
   gfloat *buf = allpass->buffer;
 
   for (i = 0; i < len; i++) {
-    buf[i] = (gfloat) DC_OFFSET;         /* this is not 100 % correct. */
+    buf[i] = (gfloat) DC_OFFSET;        /* this is not 100 % correct. */
   }
 }
 
@@ -191,24 +202,32 @@ freeverb_allpass_setfeedback (freeverb_allpass * allpass, gfloat val)
   allpass->feedback = val;
 }
 
-/*
-static gfloat
-freeverb_allpass_getfeedback(freeverb_allpass* allpass)
+/* in place; within one pass of the delay line no sample depends on another,
+ * so the inner loop can be vectorized */
+static void
+freeverb_allpass_process_block (freeverb_allpass * allpass, gfloat * io,
+    guint n)
 {
-  return allpass->feedback;
-}*/
+  gfloat feedback = allpass->feedback;
+  gfloat bufout, *buf;
+  guint k, len;
+
+  while (n) {
+    buf = allpass->buffer + allpass->bufidx;
+    len = MIN (n, allpass->bufsize - allpass->bufidx);
+
+    for (k = 0; k < len; k++) {
+      bufout = buf[k];
+      buf[k] = io[k] + (bufout * feedback);
+      io[k] = bufout - io[k];
+    }
 
-#define freeverb_allpass_process(_allpass, _input_1) \
-{ \
-  gfloat output; \
-  gfloat bufout; \
-  bufout = _allpass.buffer[_allpass.bufidx]; \
-  output = bufout-_input_1; \
-  _allpass.buffer[_allpass.bufidx] = _input_1 + (bufout * _allpass.feedback); \
-  if (++_allpass.bufidx >= _allpass.bufsize) { \
-    _allpass.bufidx = 0; \
-  } \
-  _input_1 = output; \
+    allpass->bufidx += len;
+    if (allpass->bufidx >= allpass->bufsize)
+      allpass->bufidx = 0;
+    io += len;
+    n -= len;
+  }
 }
 
 /* comb filter */
@@ -246,7 +265,7 @@ freeverb_comb_init (freeverb_comb * comb)
   gfloat *buf = comb->buffer;
 
   for (i = 0; i < len; i++) {
-    buf[i] = (gfloat) DC_OFFSET;         /* This is not 100 % correct. */
+    buf[i] = (gfloat) DC_OFFSET;        /* This is not 100 % correct. */
   }
 }
 
@@ -257,37 +276,127 @@ freeverb_comb_setdamp (freeverb_comb * comb, gfloat val)
   comb->damp2 = 1 - val;
 }
 
-/*
-static gfloat
-freeverb_comb_getdamp(freeverb_comb* comb)
-{
-  return comb->damp1;
-}*/
-
 static void
 freeverb_comb_setfeedback (freeverb_comb * comb, gfloat val)
 {
   comb->feedback = val;
 }
 
-/*
-static gfloat
-freeverb_comb_getfeedback(freeverb_comb* comb)
+/* adds the output of the comb to @acc */
+static void
+freeverb_comb_process_block (freeverb_comb * comb, const gfloat * input,
+    gfloat * acc, guint n)
 {
-  return comb->feedback;
-}*/
+  gfloat filterstore = comb->filterstore;
+  gfloat damp1 = comb->damp1, damp2 = comb->damp2;
+  gfloat feedback = comb->feedback;
+  gfloat tmp, *buf;
+  guint k, len;
+
+  while (n) {
+    buf = comb->buffer + comb->bufidx;
+    len = MIN (n, comb->bufsize - comb->bufidx);
+
+    for (k = 0; k < len; k++) {
+      tmp = buf[k];
+      filterstore = (tmp * damp2) + (filterstore * damp1);
+      buf[k] = input[k] + (filterstore * feedback);
+      acc[k] += tmp;
+    }
 
-#define freeverb_comb_process(_comb, _input_1, _output) \
-{ \
-  gfloat _tmp = _comb.buffer[_comb.bufidx]; \
-  _comb.filterstore = (_tmp * _comb.damp2) + (_comb.filterstore * _comb.damp1); \
-  _comb.buffer[_comb.bufidx] = _input_1 + (_comb.filterstore * _comb.feedback); \
-  if (++_comb.bufidx >= _comb.bufsize) { \
-    _comb.bufidx = 0; \
-  } \
-  _output += _tmp; \
+    comb->bufidx += len;
+    if (comb->bufidx >= comb->bufsize)
+      comb->bufidx = 0;
+    input += len;
+    acc += len;
+    n -= len;
+  }
+
+  comb->filterstore = filterstore;
 }
 
+#ifdef __SSE__
+/* Four combs at once, one per vector lane. Four samples of each delay line
+ * are loaded and transposed so that each vector holds the same sample of
+ * the four combs, which runs their low-pass filters in parallel. */
+static void
+freeverb_comb4_process_block (freeverb_comb * comb, const gfloat * input,
+    gfloat * acc, guint n)
+{
+  __m128 fs, damp1, damp2, feedback;
+  __m128 b0, b1, b2, b3, in;
+  guint j, k, len, len4;
+  gfloat *buf[4];
+  gfloat store[4];
+
+  damp1 = _mm_setr_ps (comb[0].damp1, comb[1].damp1, comb[2].damp1,
+      comb[3].damp1);
+  damp2 = _mm_setr_ps (comb[0].damp2, comb[1].damp2, comb[2].damp2,
+      comb[3].damp2);
+  feedback = _mm_setr_ps (comb[0].feedback, comb[1].feedback,
+      comb[2].feedback, comb[3].feedback);
+
+  while (n) {
+    len = n;
+    for (j = 0; j < 4; j++) {
+      buf[j] = comb[j].buffer + comb[j].bufidx;
+      len = MIN (len, comb[j].bufsize - comb[j].bufidx);
+    }
+    len4 = len & ~3;
+
+    fs = _mm_setr_ps (comb[0].filterstore, comb[1].filterstore,
+        comb[2].filterstore, comb[3].filterstore);
+
+    for (k = 0; k < len4; k += 4) {
+      b0 = _mm_loadu_ps (buf[0] + k);
+      b1 = _mm_loadu_ps (buf[1] + k);
+      b2 = _mm_loadu_ps (buf[2] + k);
+      b3 = _mm_loadu_ps (buf[3] + k);
+
+      _mm_storeu_ps (acc + k, _mm_add_ps (_mm_loadu_ps (acc + k),
+              _mm_add_ps (_mm_add_ps (b0, b1), _mm_add_ps (b2, b3))));
+
+      _MM_TRANSPOSE4_PS (b0, b1, b2, b3);
+
+      fs = _mm_add_ps (_mm_mul_ps (b0, damp2), _mm_mul_ps (fs, damp1));
+      in = _mm_set1_ps (input[k]);
+      b0 = _mm_add_ps (in, _mm_mul_ps (fs, feedback));
+      fs = _mm_add_ps (_mm_mul_ps (b1, damp2), _mm_mul_ps (fs, damp1));
+      in = _mm_set1_ps (input[k + 1]);
+      b1 = _mm_add_ps (in, _mm_mul_ps (fs, feedback));
+      fs = _mm_add_ps (_mm_mul_ps (b2, damp2), _mm_mul_ps (fs, damp1));
+      in = _mm_set1_ps (input[k + 2]);
+      b2 = _mm_add_ps (in, _mm_mul_ps (fs, feedback));
+      fs = _mm_add_ps (_mm_mul_ps (b3, damp2), _mm_mul_ps (fs, damp1));
+      in = _mm_set1_ps (input[k + 3]);
+      b3 = _mm_add_ps (in, _mm_mul_ps (fs, feedback));
+
+      _MM_TRANSPOSE4_PS (b0, b1, b2, b3);
+
+      _mm_storeu_ps (buf[0] + k, b0);
+      _mm_storeu_ps (buf[1] + k, b1);
+      _mm_storeu_ps (buf[2] + k, b2);
+      _mm_storeu_ps (buf[3] + k, b3);
+    }
+
+    _mm_storeu_ps (store, fs);
+    for (j = 0; j < 4; j++) {
+      comb[j].filterstore = store[j];
+      comb[j].bufidx += len4;
+      /* the up to three samples before the next wrap */
+      freeverb_comb_process_block (&comb[j], input + len4, acc + len4,
+          len - len4);
+      if (comb[j].bufidx >= comb[j].bufsize)
+        comb[j].bufidx = 0;
+    }
+
+    input += len;
+    acc += len;
+    n -= len;
+  }
+}
+#endif
+
 #define numcombs 8
 #define numallpasses 4
 #define	fixedgain 0.015f
@@ -301,31 +410,26 @@ freeverb_comb_getfeedback(freeverb_comb* comb)
 /* These values assume 44.1KHz sample rate
  * they will need scaling for 96KHz (or other) sample rates.
  * The values were obtained by listening tests.
+ * The right channel adds stereospread to them, further channels add it
+ * again for each channel to decorrelate their reverbs.
  */
-#define combtuningL1 1116
-#define combtuningR1 (1116 + stereospread)
-#define combtuningL2 1188
-#define combtuningR2 (1188 + stereospread)
-#define combtuningL3 1277
-#define combtuningR3 (1277 + stereospread)
-#define combtuningL4 1356
-#define combtuningR4 (1356 + stereospread)
-#define combtuningL5 1422
-#define combtuningR5 (1422 + stereospread)
-#define combtuningL6 1491
-#define combtuningR6 (1491 + stereospread)
-#define combtuningL7 1557
-#define combtuningR7 (1557 + stereospread)
-#define combtuningL8 1617
-#define combtuningR8 (1617 + stereospread)
-#define allpasstuningL1 556
-#define allpasstuningR1 (556 + stereospread)
-#define allpasstuningL2 441
-#define allpasstuningR2 (441 + stereospread)
-#define allpasstuningL3 341
-#define allpasstuningR3 (341 + stereospread)
-#define allpasstuningL4 225
-#define allpasstuningR4 (225 + stereospread)
+static const gint combtuning[numcombs] = {
+  1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617
+};
+
+static const gint allpasstuning[numallpasses] = {
+  556, 441, 341, 225
+};
+
+/* the reverb of one output channel */
+typedef struct _freeverb_tank
+{
+  gboolean active;
+  /* the output channel that is mixed in with the wet2 gain, or -1 */
+  gint partner;
+  freeverb_comb comb[numcombs];
+  freeverb_allpass allpass[numallpasses];
+} freeverb_tank;
 
 struct _GstFreeverbPrivate
 {
@@ -334,49 +438,146 @@ struct _GstFreeverbPrivate
   gfloat wet, wet1, wet2, dry;
   gfloat width;
   gfloat gain;
-  /*
-     The following are all declared inline
-     to remove the need for dynamic allocation
-     with its subsequent error-checking messiness
-   */
-  /* Comb filters */
-  freeverb_comb combL[numcombs];
-  freeverb_comb combR[numcombs];
-  /* Allpass filters */
-  freeverb_allpass allpassL[numallpasses];
-  freeverb_allpass allpassR[numallpasses];
+
+  /* one per output channel */
+  freeverb_tank *tanks;
+  guint n_tanks;
+  guint in_channels;
+
+  /* work buffers of BLOCK_SIZE frames */
+  gfloat *tank_in;
+  gfloat *wet_data;
+  gfloat *in_data;
+  gfloat *out_data;
 };
 
 static void
-freeverb_revmodel_init (GstFreeverb * filter)
+freeverb_tank_process_block (freeverb_tank * tank, const gfloat * input,
+    gfloat * output, guint n)
+{
+  guint i = 0, k;
+
+  memset (output, 0, n * sizeof (gfloat));
+
+  /* Accumulate comb filters in parallel */
+#ifdef __SSE__
+  for (; i + 4 <= numcombs; i += 4)
+    freeverb_comb4_process_block (&tank->comb[i], input, output, n);
+#endif
+  for (; i < numcombs; i++)
+    freeverb_comb_process_block (&tank->comb[i], input, output, n);
+
+  /* Feed through allpasses in series */
+  for (i = 0; i < numallpasses; i++)
+    freeverb_allpass_process_block (&tank->allpass[i], output, n);
+
+  /* Remove the DC offset */
+  for (k = 0; k < n; k++)
+    output[k] -= (gfloat) DC_OFFSET;
+}
+
+/* Runs the reverb over @n interleaved frames of @in into @out, with @n at
+ * most BLOCK_SIZE. A mono input feeds the tanks of both output channels.
+ * Returns %TRUE if the output is silent. */
+static gboolean
+freeverb_revmodel_process_block (GstFreeverb * filter, const gfloat * in,
+    gfloat * out, guint n)
 {
   GstFreeverbPrivate *priv = filter->priv;
-  gint i;
+  guint in_channels = priv->in_channels, out_channels = priv->n_tanks;
+  gfloat scale = in_channels == 1 ? 2.0f : 1.0f;
+  gfloat wet1 = priv->wet1, wet2 = priv->wet2, dry = priv->dry;
+  gfloat *tank_in = priv->tank_in;
+  const gfloat *wet, *wet_partner;
+  gboolean drained = TRUE;
+  guint c, ic, k;
+
+  for (c = 0; c < out_channels; c++) {
+    if (!priv->tanks[c].active)
+      continue;
+
+    /* The original Freeverb code expects a stereo signal and 'input_1'
+     * is set to the sum of the left and right input_1 sample. Since
+     * the mono case works on a mono signal, 'input_1' is set to twice the
+     * input_1 sample. */
+    ic = in_channels == 1 ? 0 : c;
+    for (k = 0; k < n; k++)
+      tank_in[k] = (in[k * in_channels + ic] * scale + DC_OFFSET) * priv->gain;
 
-  for (i = 0; i < numcombs; i++) {
-    freeverb_comb_init (&priv->combL[i]);
-    freeverb_comb_init (&priv->combR[i]);
+    freeverb_tank_process_block (&priv->tanks[c], tank_in,
+        priv->wet_data + c * BLOCK_SIZE, n);
   }
-  for (i = 0; i < numallpasses; i++) {
-    freeverb_allpass_init (&priv->allpassL[i]);
-    freeverb_allpass_init (&priv->allpassR[i]);
+
+  /* Calculate output */
+  for (c = 0; c < out_channels; c++) {
+    freeverb_tank *tank = &priv->tanks[c];
+    const gfloat *dry_in = in + (in_channels == 1 ? 0 : c);
+
+    wet = priv->wet_data + c * BLOCK_SIZE;
+    if (!tank->active) {
+      for (k = 0; k < n; k++)
+        out[k * out_channels + c] = dry_in[k * in_channels];
+    } else if (tank->partner >= 0) {
+      wet_partner = priv->wet_data + tank->partner * BLOCK_SIZE;
+      for (k = 0; k < n; k++)
+        out[k * out_channels + c] = wet[k] * wet1 + wet_partner[k] * wet2 +
+            dry_in[k * in_channels] * dry;
+    } else {
+      for (k = 0; k < n; k++)
+        out[k * out_channels + c] = wet[k] * (wet1 + wet2) +
+            dry_in[k * in_channels] * dry;
+    }
+  }
+
+  for (k = 0; k < n * out_channels; k++) {
+    if (out[k] != 0.0f) {
+      drained = FALSE;
+      break;
+    }
   }
+
+  return drained;
 }
 
 static void
-freeverb_revmodel_free (GstFreeverb * filter)
+freeverb_revmodel_init (GstFreeverb * filter)
 {
   GstFreeverbPrivate *priv = filter->priv;
-  gint i;
-
-  for (i = 0; i < numcombs; i++) {
-    freeverb_comb_release (&priv->combL[i]);
-    freeverb_comb_release (&priv->combR[i]);
+  guint c, i;
+
+  for (c = 0; c < priv->n_tanks; c++) {
+    if (!priv->tanks[c].active)
+      continue;
+    for (i = 0; i < numcombs; i++)
+      freeverb_comb_init (&priv->tanks[c].comb[i]);
+    for (i = 0; i < numallpasses; i++)
+      freeverb_allpass_init (&priv->tanks[c].allpass[i]);
   }
-  for (i = 0; i < numallpasses; i++) {
-    freeverb_allpass_release (&priv->allpassL[i]);
-    freeverb_allpass_release (&priv->allpassR[i]);
+}
+
+static void
+freeverb_revmodel_free (GstFreeverb * filter)
+{
+  GstFreeverbPrivate *priv = filter->priv;
+  guint c, i;
+
+  for (c = 0; c < priv->n_tanks; c++) {
+    if (!priv->tanks[c].active)
+      continue;
+    for (i = 0; i < numcombs; i++)
+      freeverb_comb_release (&priv->tanks[c].comb[i]);
+    for (i = 0; i < numallpasses; i++)
+      freeverb_allpass_release (&priv->tanks[c].allpass[i]);
   }
+  g_free (priv->tanks);
+  priv->tanks = NULL;
+  priv->n_tanks = 0;
+
+  g_free (priv->tank_in);
+  g_free (priv->wet_data);
+  g_free (priv->in_data);
+  g_free (priv->out_data);
+  priv->tank_in = priv->wet_data = priv->in_data = priv->out_data = NULL;
 }
 
 /* GObject vmethod implementations */
@@ -448,8 +649,6 @@ gst_freeverb_init (GstFreeverb * filter)
   filter->process = NULL;
 
   gst_base_transform_set_gap_aware (GST_BASE_TRANSFORM (filter), TRUE);
-
-  freeverb_revmodel_init (filter);
 }
 
 static void
@@ -465,69 +664,136 @@ gst_freeverb_finalize (GObject * object)
 static gboolean
 gst_freeverb_set_process_function (GstFreeverb * filter, GstAudioInfo * info)
 {
-  gint channel_index, format_index;
+  gint format_index;
   const GstAudioFormatInfo *finfo = info->finfo;
 
   /* set processing function */
-  channel_index = GST_AUDIO_INFO_CHANNELS (info) - 1;
-  if (channel_index > 1 || channel_index < 0) {
+  if (GST_AUDIO_INFO_CHANNELS (info) > MAX_CHANNELS) {
     filter->process = NULL;
     return FALSE;
   }
 
   format_index = GST_AUDIO_FORMAT_INFO_IS_FLOAT (finfo) ? 1 : 0;
 
-  filter->process = process_functions[channel_index][format_index];
+  filter->process = process_functions[format_index];
   return TRUE;
 }
 
+/* the mirrored position of the channels that are mixed as a stereo pair */
+static GstAudioChannelPosition
+gst_freeverb_mirror_position (GstAudioChannelPosition pos)
+{
+  static const GstAudioChannelPosition pairs[][2] = {
+    {GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
+        GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT},
+    {GST_AUDIO_CHANNEL_POSITION_REAR_LEFT,
+        GST_AUDIO_CHANNEL_POSITION_REAR_RIGHT},
+    {GST_AUDIO_CHANNEL_POSITION_SIDE_LEFT,
+        GST_AUDIO_CHANNEL_POSITION_SIDE_RIGHT},
+    {GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT_OF_CENTER,
+        GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT_OF_CENTER},
+    {GST_AUDIO_CHANNEL_POSITION_WIDE_LEFT,
+        GST_AUDIO_CHANNEL_POSITION_WIDE_RIGHT},
+    {GST_AUDIO_CHANNEL_POSITION_TOP_FRONT_LEFT,
+        GST_AUDIO_CHANNEL_POSITION_TOP_FRONT_RIGHT},
+    {GST_AUDIO_CHANNEL_POSITION_TOP_REAR_LEFT,
+        GST_AUDIO_CHANNEL_POSITION_TOP_REAR_RIGHT},
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (pairs); i++) {
+    if (pairs[i][0] == pos)
+      return pairs[i][1];
+    if (pairs[i][1] == pos)
+      return pairs[i][0];
+  }
+  return GST_AUDIO_CHANNEL_POSITION_INVALID;
+}
+
+/* Stereo (and mono upmixed to stereo) is one pair. In other layouts the
+ * left/right pairs are mixed like stereo, the other channels only get their
+ * own reverb and the LFE channels are passed through. Without positions the
+ * channels are paired in order. */
+static void
+gst_freeverb_setup_channels (GstFreeverb * filter, GstAudioInfo * out_info)
+{
+  GstFreeverbPrivate *priv = filter->priv;
+  guint c, p, n = GST_AUDIO_INFO_CHANNELS (out_info);
+  GstAudioChannelPosition pos, mirror;
+
+  for (c = 0; c < n; c++) {
+    freeverb_tank *tank = &priv->tanks[c];
+
+    tank->active = TRUE;
+    tank->partner = -1;
+
+    if (n == 2 || GST_AUDIO_INFO_IS_UNPOSITIONED (out_info)) {
+      if ((c ^ 1) < n)
+        tank->partner = c ^ 1;
+      continue;
+    }
+
+    pos = GST_AUDIO_INFO_POSITION (out_info, c);
+    if (pos == GST_AUDIO_CHANNEL_POSITION_LFE1 ||
+        pos == GST_AUDIO_CHANNEL_POSITION_LFE2) {
+      tank->active = FALSE;
+      continue;
+    }
+
+    mirror = gst_freeverb_mirror_position (pos);
+    if (mirror == GST_AUDIO_CHANNEL_POSITION_INVALID)
+      continue;
+    for (p = 0; p < n; p++) {
+      if (GST_AUDIO_INFO_POSITION (out_info, p) == mirror)
+        tank->partner = p;
+    }
+  }
+}
+
 static void
-gst_freeverb_init_rev_model (GstFreeverb * filter)
+gst_freeverb_init_rev_model (GstFreeverb * filter, GstAudioInfo * out_info)
 {
   gfloat srfactor = GST_AUDIO_INFO_RATE (&filter->info) / 44100.0f;
   GstFreeverbPrivate *priv = filter->priv;
+  guint c, i, n_tanks = GST_AUDIO_INFO_CHANNELS (out_info);
+  gint spread;
 
   freeverb_revmodel_free (filter);
 
   priv->gain = fixedgain;
+  priv->in_channels = GST_AUDIO_INFO_CHANNELS (&filter->info);
+  priv->n_tanks = n_tanks;
+  priv->tanks = g_new0 (freeverb_tank, n_tanks);
+  gst_freeverb_setup_channels (filter, out_info);
+
+  priv->tank_in = g_new (gfloat, BLOCK_SIZE);
+  priv->wet_data = g_new0 (gfloat, n_tanks * BLOCK_SIZE);
+  priv->in_data = g_new (gfloat, priv->in_channels * BLOCK_SIZE);
+  priv->out_data = g_new (gfloat, n_tanks * BLOCK_SIZE);
 
-  freeverb_comb_setbuffer (&priv->combL[0], combtuningL1 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[0], combtuningR1 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[1], combtuningL2 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[1], combtuningR2 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[2], combtuningL3 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[2], combtuningR3 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[3], combtuningL4 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[3], combtuningR4 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[4], combtuningL5 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[4], combtuningR5 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[5], combtuningL6 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[5], combtuningR6 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[6], combtuningL7 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[6], combtuningR7 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[7], combtuningL8 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[7], combtuningR8 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassL[0], allpasstuningL1 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassR[0], allpasstuningR1 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassL[1], allpasstuningL2 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassR[1], allpasstuningR2 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassL[2], allpasstuningL3 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassR[2], allpasstuningR3 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassL[3], allpasstuningL4 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassR[3], allpasstuningR4 * srfactor);
+  for (c = 0; c < n_tanks; c++) {
+    freeverb_tank *tank = &priv->tanks[c];
+
+    if (!tank->active)
+      continue;
+
+    spread = c * stereospread;
+    for (i = 0; i < numcombs; i++) {
+      freeverb_comb_setbuffer (&tank->comb[i],
+          (combtuning[i] + spread) * srfactor);
+      freeverb_comb_setfeedback (&tank->comb[i], priv->roomsize);
+      freeverb_comb_setdamp (&tank->comb[i], priv->damp);
+    }
+    for (i = 0; i < numallpasses; i++) {
+      freeverb_allpass_setbuffer (&tank->allpass[i],
+          (allpasstuning[i] + spread) * srfactor);
+      /* set default values */
+      freeverb_allpass_setfeedback (&tank->allpass[i], 0.5f);
+    }
+  }
 
   /* clear buffers */
   freeverb_revmodel_init (filter);
-
-  /* set default values */
-  freeverb_allpass_setfeedback (&priv->allpassL[0], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassR[0], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassL[1], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassR[1], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassL[2], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassR[2], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassL[3], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassR[3], 0.5f);
 }
 
 static void
@@ -536,23 +802,23 @@ gst_freeverb_set_property (GObject * object, guint prop_id,
 {
   GstFreeverb *filter = GST_FREEVERB (object);
   GstFreeverbPrivate *priv = filter->priv;
-  gint i;
+  guint c, i;
 
   switch (prop_id) {
     case PROP_ROOM_SIZE:
       filter->room_size = g_value_get_float (value);
       priv->roomsize = (filter->room_size * scaleroom) + offsetroom;
-      for (i = 0; i < numcombs; i++) {
-        freeverb_comb_setfeedback (&priv->combL[i], priv->roomsize);
-        freeverb_comb_setfeedback (&priv->combR[i], priv->roomsize);
+      for (c = 0; c < priv->n_tanks; c++) {
+        for (i = 0; i < numcombs; i++)
+          freeverb_comb_setfeedback (&priv->tanks[c].comb[i], priv->roomsize);
       }
       break;
     case PROP_DAMPING:
       filter->damping = g_value_get_float (value);
       priv->damp = filter->damping * scaledamp;
-      for (i = 0; i < numcombs; i++) {
-        freeverb_comb_setdamp (&priv->combL[i], priv->damp);
-        freeverb_comb_setdamp (&priv->combR[i], priv->damp);
+      for (c = 0; c < priv->n_tanks; c++) {
+        for (i = 0; i < numcombs; i++)
+          freeverb_comb_setdamp (&priv->tanks[c].comb[i], priv->damp);
       }
       break;
     case PROP_PAN_WIDTH:
@@ -625,18 +891,38 @@ gst_freeverb_transform_caps (GstBaseTransform * base,
 {
   GstCaps *res;
   GstStructure *structure;
-  gint i;
+  gint i, channels;
 
-  /* replace the channel property with our range. */
+  /* mono is turned into stereo, more channels keep their layout. */
   res = gst_caps_copy (caps);
   for (i = 0; i < gst_caps_get_size (res); i++) {
     structure = gst_caps_get_structure (res, i);
+    if (!gst_structure_get_int (structure, "channels", &channels))
+      channels = 0;
+    if (channels > 2) {
+      GST_INFO_OBJECT (base, "[%d] keep %d channels", i, channels);
+      continue;
+    }
+
     if (direction == GST_PAD_SRC) {
-      GST_INFO_OBJECT (base, "[%d] allow 1-2 channels", i);
-      gst_structure_set (structure, "channels", GST_TYPE_INT_RANGE, 1, 2, NULL);
+      if (channels == 2) {
+        GST_INFO_OBJECT (base, "[%d] allow 1-2 channels", i);
+        gst_structure_set (structure, "channels", GST_TYPE_INT_RANGE, 1, 2,
+            NULL);
+      } else {
+        GST_INFO_OBJECT (base, "[%d] allow 1-%d channels", i, MAX_CHANNELS);
+        gst_structure_set (structure, "channels", GST_TYPE_INT_RANGE, 1,
+            MAX_CHANNELS, NULL);
+      }
     } else {
-      GST_INFO_OBJECT (base, "[%d] allow 2 channels", i);
-      gst_structure_set (structure, "channels", G_TYPE_INT, 2, NULL);
+      if (channels == 1 || channels == 2) {
+        GST_INFO_OBJECT (base, "[%d] allow 2 channels", i);
+        gst_structure_set (structure, "channels", G_TYPE_INT, 2, NULL);
+      } else {
+        GST_INFO_OBJECT (base, "[%d] allow 2-%d channels", i, MAX_CHANNELS);
+        gst_structure_set (structure, "channels", GST_TYPE_INT_RANGE, 2,
+            MAX_CHANNELS, NULL);
+      }
     }
     gst_structure_remove_field (structure, "channel-mask");
   }
@@ -661,11 +947,13 @@ gst_freeverb_set_caps (GstBaseTransform * base, GstCaps * incaps,
     GstCaps * outcaps)
 {
   GstFreeverb *filter = GST_FREEVERB (base);
-  GstAudioInfo info;
+  GstAudioInfo info, out_info;
 
   /*GST_INFO ("incaps are %" GST_PTR_FORMAT, incaps); */
   if (!gst_audio_info_from_caps (&info, incaps))
     goto no_format;
+  if (!gst_audio_info_from_caps (&out_info, outcaps))
+    goto no_format;
 
   GST_DEBUG ("try to process %d input with %d channels",
       GST_AUDIO_INFO_FORMAT (&info), GST_AUDIO_INFO_CHANNELS (&info));
@@ -675,7 +963,7 @@ gst_freeverb_set_caps (GstBaseTransform * base, GstCaps * incaps,
 
   filter->info = info;
 
-  gst_freeverb_init_rev_model (filter);
+  gst_freeverb_init_rev_model (filter, &out_info);
   filter->drained = FALSE;
   GST_INFO_OBJECT (base, "model configured");
 
@@ -689,189 +977,55 @@ no_format:
 }
 
 static gboolean
-gst_freeverb_transform_m2s_int (GstFreeverb * filter,
+gst_freeverb_transform_int (GstFreeverb * filter,
     gint16 * idata, gint16 * odata, guint num_samples)
 {
   GstFreeverbPrivate *priv = filter->priv;
-  gint i, k;
-  gfloat out_l1, out_r1, input_1;
-  gfloat out_l2, out_r2, input_2;
+  gfloat *in = priv->in_data, *out = priv->out_data, v;
+  guint k, n, in_len, out_len;
   gboolean drained = TRUE;
 
-  for (k = 0; k < num_samples; k++) {
-    out_l1 = out_r1 = 0.0;
-
-    /* The original Freeverb code expects a stereo signal and 'input_1'
-     * is set to the sum of the left and right input_1 sample. Since
-     * this code works on a mono signal, 'input_1' is set to twice the
-     * input_1 sample. */
-    input_2 = (gfloat) * idata++;
-    input_1 = (2.0f * input_2 + DC_OFFSET) * priv->gain;
-
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      freeverb_comb_process (priv->combL[i], input_1, out_l1);
-      freeverb_comb_process (priv->combR[i], input_1, out_r1);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      freeverb_allpass_process (priv->allpassL[i], out_l1);
-      freeverb_allpass_process (priv->allpassR[i], out_r1);
-    }
-
-    /* Remove the DC offset */
-    out_l1 -= (gfloat) DC_OFFSET;
-    out_r1 -= (gfloat) DC_OFFSET;
-
-    /* Calculate output */
-    out_l2 = out_l1 * priv->wet1 + out_r1 * priv->wet2 + input_2 * priv->dry;
-    out_r2 = out_r1 * priv->wet1 + out_l1 * priv->wet2 + input_2 * priv->dry;
-    out_l2 = CLAMP (out_l2, G_MININT16, G_MAXINT16);
-    out_r2 = CLAMP (out_r2, G_MININT16, G_MAXINT16);
-    *odata++ = (gint16) out_l2;
-    *odata++ = (gint16) out_r2;
-
-    if (abs ((gint16) out_l2) > 0 || abs ((gint16) out_r2) > 0)
-      drained = FALSE;
-  }
-  return drained;
-}
-
-static gboolean
-gst_freeverb_transform_s2s_int (GstFreeverb * filter,
-    gint16 * idata, gint16 * odata, guint num_samples)
-{
-  GstFreeverbPrivate *priv = filter->priv;
-  gint i, k;
-  gfloat out_l1, out_r1, input_1l, input_1r;
-  gfloat out_l2, out_r2, input_2l, input_2r;
-  gboolean drained = TRUE;
+  while (num_samples) {
+    n = MIN (num_samples, BLOCK_SIZE);
+    in_len = n * priv->in_channels;
+    out_len = n * priv->n_tanks;
 
-  for (k = 0; k < num_samples; k++) {
-    out_l1 = out_r1 = 0.0;
+    for (k = 0; k < in_len; k++)
+      in[k] = idata[k];
 
-    input_2l = (gfloat) * idata++;
-    input_2r = (gfloat) * idata++;
-    input_1l = (input_2l + DC_OFFSET) * priv->gain;
-    input_1r = (input_2r + DC_OFFSET) * priv->gain;
+    freeverb_revmodel_process_block (filter, in, out, n);
 
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      freeverb_comb_process (priv->combL[i], input_1l, out_l1);
-      freeverb_comb_process (priv->combR[i], input_1r, out_r1);
+    for (k = 0; k < out_len; k++) {
+      v = CLAMP (out[k], G_MININT16, G_MAXINT16);
+      odata[k] = (gint16) v;
+      if (odata[k] != 0)
+        drained = FALSE;
     }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      freeverb_allpass_process (priv->allpassL[i], out_l1);
-      freeverb_allpass_process (priv->allpassR[i], out_r1);
-    }
-
-    /* Remove the DC offset */
-    out_l1 -= (gfloat) DC_OFFSET;
-    out_r1 -= (gfloat) DC_OFFSET;
-
-    /* Calculate output */
-    out_l2 = out_l1 * priv->wet1 + out_r1 * priv->wet2 + input_2l * priv->dry;
-    out_r2 = out_r1 * priv->wet1 + out_l1 * priv->wet2 + input_2r * priv->dry;
-    out_l2 = CLAMP (out_l2, G_MININT16, G_MAXINT16);
-    out_r2 = CLAMP (out_r2, G_MININT16, G_MAXINT16);
-    *odata++ = (gint16) out_l2;
-    *odata++ = (gint16) out_r2;
 
-    if (abs ((gint16) out_l2) > 0 || abs ((gint16) out_r2) > 0)
-      drained = FALSE;
+    idata += in_len;
+    odata += out_len;
+    num_samples -= n;
   }
   return drained;
 }
 
 static gboolean
-gst_freeverb_transform_m2s_float (GstFreeverb * filter,
+gst_freeverb_transform_float (GstFreeverb * filter,
     gfloat * idata, gfloat * odata, guint num_samples)
 {
   GstFreeverbPrivate *priv = filter->priv;
-  gint i, k;
-  gfloat out_l1, out_r1, input_1;
-  gfloat out_l2, out_r2, input_2;
+  guint n;
   gboolean drained = TRUE;
 
-  for (k = 0; k < num_samples; k++) {
-    out_l1 = out_r1 = 0.0;
-
-    /* The original Freeverb code expects a stereo signal and 'input_1'
-     * is set to the sum of the left and right input_1 sample. Since
-     * this code works on a mono signal, 'input_1' is set to twice the
-     * input_1 sample. */
-    input_2 = *idata++;
-    input_1 = (2.0f * input_2 + DC_OFFSET) * priv->gain;
+  while (num_samples) {
+    n = MIN (num_samples, BLOCK_SIZE);
 
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      freeverb_comb_process (priv->combL[i], input_1, out_l1);
-      freeverb_comb_process (priv->combR[i], input_1, out_r1);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      freeverb_allpass_process (priv->allpassL[i], out_l1);
-      freeverb_allpass_process (priv->allpassR[i], out_r1);
-    }
-
-    /* Remove the DC offset */
-    out_l1 -= (gfloat) DC_OFFSET;
-    out_r1 -= (gfloat) DC_OFFSET;
-
-    /* Calculate output */
-    out_l2 = out_l1 * priv->wet1 + out_r1 * priv->wet2 + input_2 * priv->dry;
-    out_r2 = out_r1 * priv->wet1 + out_l1 * priv->wet2 + input_2 * priv->dry;
-    *odata++ = out_l2;
-    *odata++ = out_r2;
-
-    if (fabs (out_l2) > 0 || fabs (out_r2) > 0)
+    if (!freeverb_revmodel_process_block (filter, idata, odata, n))
       drained = FALSE;
-  }
-  return drained;
-}
 
-static gboolean
-gst_freeverb_transform_s2s_float (GstFreeverb * filter,
-    gfloat * idata, gfloat * odata, guint num_samples)
-{
-  GstFreeverbPrivate *priv = filter->priv;
-  gint i, k;
-  gfloat out_l1, out_r1, input_1l, input_1r;
-  gfloat out_l2, out_r2, input_2l, input_2r;
-  gboolean drained = TRUE;
-
-  for (k = 0; k < num_samples; k++) {
-    out_l1 = out_r1 = 0.0;
-
-    input_2l = *idata++;
-    input_2r = *idata++;
-    input_1l = (input_2l + DC_OFFSET) * priv->gain;
-    input_1r = (input_2r + DC_OFFSET) * priv->gain;
-
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      freeverb_comb_process (priv->combL[i], input_1l, out_l1);
-      freeverb_comb_process (priv->combR[i], input_1r, out_r1);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      freeverb_allpass_process (priv->allpassL[i], out_l1);
-      freeverb_allpass_process (priv->allpassR[i], out_r1);
-    }
-
-    /* Remove the DC offset */
-    out_l1 -= (gfloat) DC_OFFSET;
-    out_r1 -= (gfloat) DC_OFFSET;
-
-    /* Calculate output */
-    out_l2 = out_l1 * priv->wet1 + out_r1 * priv->wet2 + input_2l * priv->dry;
-    out_r2 = out_r1 * priv->wet1 + out_l1 * priv->wet2 + input_2r * priv->dry;
-    *odata++ = out_l2;
-    *odata++ = out_r2;
-
-    if (fabs (out_l2) > 0 || fabs (out_r2) > 0)
-      drained = FALSE;
+    idata += n * priv->in_channels;
+    odata += n * priv->n_tanks;
+    num_samples -= n;
   }
   return drained;
 }
@@ -886,6 +1040,9 @@ gst_freeverb_transform (GstBaseTransform * base, GstBuffer * inbuf,
   guint num_samples;
   GstClockTime timestamp;
   GstMapInfo inmap, outmap;
+#ifdef __SSE__
+  guint csr;
+#endif
 
   timestamp = GST_BUFFER_TIMESTAMP (inbuf);
   timestamp =
@@ -893,7 +1050,8 @@ gst_freeverb_transform (GstBaseTransform * base, GstBuffer * inbuf,
 
   gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
   gst_buffer_map (outbuf, &outmap, GST_MAP_WRITE);
-  num_samples = outmap.size / (2 * GST_AUDIO_INFO_BPS (&filter->info));
+  num_samples = outmap.size / (filter->priv->n_tanks *
+      GST_AUDIO_INFO_BPS (&filter->info));
 
   GST_DEBUG_OBJECT (filter, "processing %u samples at %" GST_TIME_FORMAT,
       num_samples, GST_TIME_ARGS (timestamp));
@@ -913,8 +1071,16 @@ gst_freeverb_transform (GstBaseTransform * base, GstBuffer * inbuf,
   }
 
   if (!filter->drained) {
+#ifdef __SSE__
+    /* flush denormals to zero while processing */
+    csr = _mm_getcsr ();
+    _mm_setcsr (csr | _MM_FLUSH_ZERO_ON);
+#endif
     filter->drained =
         filter->process (filter, inmap.data, outmap.data, num_samples);
+#ifdef __SSE__
+    _mm_setcsr (csr);
+#endif
   }
 
   if (filter->drained) {
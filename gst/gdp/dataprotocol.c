@@ -136,6 +136,30 @@ static guint16 gst_dp_crc (const guint8 * buffer, guint length);
 static guint16 gst_dp_crc_from_memory_maps (const GstMapInfo * maps,
     guint n_maps);
 
+/* CRC of the memories of @buffer, without merging them */
+static guint16
+gst_dp_crc_from_buffer (GstBuffer * buffer)
+{
+  GstMapInfo *maps;
+  guint n_maps, i;
+  guint16 crc;
+
+  n_maps = gst_buffer_n_memory (buffer);
+  if (n_maps == 0)
+    return 0;
+
+  maps = g_newa (GstMapInfo, n_maps);
+  for (i = 0; i < n_maps; ++i)
+    gst_memory_map (gst_buffer_peek_memory (buffer, i), &maps[i], GST_MAP_READ);
+
+  crc = gst_dp_crc_from_memory_maps (maps, n_maps);
+
+  for (i = 0; i < n_maps; ++i)
+    gst_memory_unmap (maps[i].memory, &maps[i]);
+
+  return crc;
+}
+
 /* payloading functions */
 
 GstBuffer *
@@ -156,32 +180,9 @@ gst_dp_payload_buffer (GstBuffer * buffer, GstDPHeaderFlag flags)
   /* version, flags, type */
   GST_DP_INIT_HEADER (h, GST_DP_VERSION_1_0, flags, GST_DP_PAYLOAD_BUFFER);
 
-  if ((flags & GST_DP_HEADER_FLAG_CRC_PAYLOAD)) {
-    GstMapInfo *maps;
-    guint n_maps, i;
-
-    buffer_size = 0;
-
-    n_maps = gst_buffer_n_memory (buffer);
-    if (n_maps > 0) {
-      maps = g_newa (GstMapInfo, n_maps);
-
-      for (i = 0; i < n_maps; ++i) {
-        GstMemory *mem;
-
-        mem = gst_buffer_peek_memory (buffer, i);
-        gst_memory_map (mem, &maps[i], GST_MAP_READ);
-        buffer_size += maps[i].size;
-      }
-
-      crc = gst_dp_crc_from_memory_maps (maps, n_maps);
-
-      for (i = 0; i < n_maps; ++i)
-        gst_memory_unmap (maps[i].memory, &maps[i]);
-    }
-  } else {
-    buffer_size = gst_buffer_get_size (buffer);
-  }
+  buffer_size = gst_buffer_get_size (buffer);
+  if ((flags & GST_DP_HEADER_FLAG_CRC_PAYLOAD))
+    crc = gst_dp_crc_from_buffer (buffer);
 
   /* buffer properties */
   GST_WRITE_UINT32_BE (h + 6, buffer_size);
@@ -329,40 +330,60 @@ gst_dp_payload_event (const GstEvent * event, GstDPHeaderFlag flags)
 
 /*** PUBLIC FUNCTIONS ***/
 
-static const guint16 gst_dp_crc_table[256] = {
-  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
-  0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
-  0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
-  0x9339, 0x8318, 0xb37b, 0xa35a, 0xd3bd, 0xc39c, 0xf3ff, 0xe3de,
-  0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485,
-  0xa56a, 0xb54b, 0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d,
-  0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
-  0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc,
-  0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861, 0x2802, 0x3823,
-  0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b,
-  0x5af5, 0x4ad4, 0x7ab7, 0x6a96, 0x1a71, 0x0a50, 0x3a33, 0x2a12,
-  0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a,
-  0x6ca6, 0x7c87, 0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41,
-  0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
-  0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70,
-  0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a, 0x9f59, 0x8f78,
-  0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f,
-  0x1080, 0x00a1, 0x30c2, 0x20e3, 0x5004, 0x4025, 0x7046, 0x6067,
-  0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e,
-  0x02b1, 0x1290, 0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256,
-  0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
-  0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
-  0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e, 0xc71d, 0xd73c,
-  0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634,
-  0xd94c, 0xc96d, 0xf90e, 0xe92f, 0x99c8, 0x89e9, 0xb98a, 0xa9ab,
-  0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3,
-  0xcb7d, 0xdb5c, 0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a,
-  0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
-  0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9,
-  0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1,
-  0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
-  0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
-};
+/* gst_dp_crc_table[j][i] is the CRC of i followed by j zero bytes, for the
+ * slicing-by-8 loop in gst_dp_crc_update(), filled on first use */
+static guint16 gst_dp_crc_table[8][256];
+
+static void
+gst_dp_crc_init_table (void)
+{
+  static gsize init = 0;
+  guint16 c;
+  gint i, j;
+
+  /* not done in gst_dp_init(), the CRC functions are also used without it */
+  if (!g_once_init_enter (&init))
+    return;
+
+  for (i = 0; i < 256; i++) {
+    c = (guint16) (i << 8);
+    for (j = 0; j < 8; j++)
+      c = (guint16) ((c << 1) ^ (c & 0x8000 ? POLY : 0));
+    gst_dp_crc_table[0][i] = c;
+  }
+  for (i = 0; i < 256; i++) {
+    c = gst_dp_crc_table[0][i];
+    for (j = 1; j < 8; j++) {
+      c = (guint16) ((c << 8) ^ gst_dp_crc_table[0][c >> 8]);
+      gst_dp_crc_table[j][i] = c;
+    }
+  }
+
+  g_once_init_leave (&init, 1);
+}
+
+static guint16
+gst_dp_crc_update (guint16 crc_register, const guint8 * buffer, gsize length)
+{
+  guint16 hi;
+
+  gst_dp_crc_init_table ();
+
+  for (; length >= 8; length -= 8, buffer += 8) {
+    hi = crc_register ^ GST_READ_UINT16_BE (buffer);
+    crc_register = gst_dp_crc_table[7][hi >> 8] ^
+        gst_dp_crc_table[6][hi & 0xff] ^ gst_dp_crc_table[5][buffer[2]] ^
+        gst_dp_crc_table[4][buffer[3]] ^ gst_dp_crc_table[3][buffer[4]] ^
+        gst_dp_crc_table[2][buffer[5]] ^ gst_dp_crc_table[1][buffer[6]] ^
+        gst_dp_crc_table[0][buffer[7]];
+  }
+  for (; length; length--) {
+    crc_register = (guint16) ((crc_register << 8) ^
+        gst_dp_crc_table[0][(crc_register >> 8) ^ *buffer++]);
+  }
+
+  return crc_register;
+}
 
 /**
  * gst_dp_crc:
@@ -386,10 +407,8 @@ gst_dp_crc (const guint8 * buffer, guint length)
   g_assert (buffer != NULL);
 
   /* calc CRC */
-  for (; length--;) {
-    crc_register = (guint16) ((crc_register << 8) ^
-        gst_dp_crc_table[((crc_register >> 8) & 0x00ff) ^ *buffer++]);
-  }
+  crc_register = gst_dp_crc_update (crc_register, buffer, length);
+
   return (0xffff ^ crc_register);
 }
 
@@ -406,15 +425,8 @@ gst_dp_crc_from_memory_maps (const GstMapInfo * maps, guint n_maps)
 
   /* calc CRC */
   while (n_maps > 0) {
-    guint8 *buffer = maps->data;
-    gsize length = maps->size;
-
-    total_length += length;
-
-    while (length-- > 0) {
-      crc_register = (guint16) ((crc_register << 8) ^
-          gst_dp_crc_table[((crc_register >> 8) & 0x00ff) ^ *buffer++]);
-    }
+    total_length += maps->size;
+    crc_register = gst_dp_crc_update (crc_register, maps->data, maps->size);
     --n_maps;
     ++maps;
   }
@@ -436,8 +448,13 @@ gst_dp_crc_from_memory_maps (const GstMapInfo * maps, guint n_maps)
 void
 gst_dp_init (void)
 {
-  GST_DEBUG_CATEGORY_INIT (data_protocol_debug, "gdp", 0,
-      "GStreamer Data Protocol");
+  static gsize init = 0;
+
+  if (g_once_init_enter (&init)) {
+    GST_DEBUG_CATEGORY_INIT (data_protocol_debug, "gdp", 0,
+        "GStreamer Data Protocol");
+    g_once_init_leave (&init, 1);
+  }
 }
 
 /**
@@ -474,6 +491,17 @@ gst_dp_header_payload_type (const guint8 * header)
 
 /*** DEPACKETIZING FUNCTIONS ***/
 
+static void
+gst_dp_buffer_set_metadata (GstBuffer * buffer, const guint8 * header)
+{
+  GST_BUFFER_TIMESTAMP (buffer) = GST_DP_HEADER_TIMESTAMP (header);
+  GST_BUFFER_DTS (buffer) = GST_DP_HEADER_DTS (header);
+  GST_BUFFER_DURATION (buffer) = GST_DP_HEADER_DURATION (header);
+  GST_BUFFER_OFFSET (buffer) = GST_DP_HEADER_OFFSET (header);
+  GST_BUFFER_OFFSET_END (buffer) = GST_DP_HEADER_OFFSET_END (header);
+  GST_BUFFER_FLAGS (buffer) = GST_DP_HEADER_BUFFER_FLAGS (header);
+}
+
 /**
  * gst_dp_buffer_from_header:
  * @header_length: the length of the packet header
@@ -507,16 +535,43 @@ gst_dp_buffer_from_header (guint header_length, const guint8 * header,
       gst_buffer_new_allocate (allocator,
       (guint) GST_DP_HEADER_PAYLOAD_LENGTH (header), allocation_params);
 
-  GST_BUFFER_TIMESTAMP (buffer) = GST_DP_HEADER_TIMESTAMP (header);
-  GST_BUFFER_DTS (buffer) = GST_DP_HEADER_DTS (header);
-  GST_BUFFER_DURATION (buffer) = GST_DP_HEADER_DURATION (header);
-  GST_BUFFER_OFFSET (buffer) = GST_DP_HEADER_OFFSET (header);
-  GST_BUFFER_OFFSET_END (buffer) = GST_DP_HEADER_OFFSET_END (header);
-  GST_BUFFER_FLAGS (buffer) = GST_DP_HEADER_BUFFER_FLAGS (header);
+  gst_dp_buffer_set_metadata (buffer, header);
 
   return buffer;
 }
 
+/**
+ * gst_dp_buffer_from_payload:
+ * @header_length: the length of the packet header
+ * @header: the byte array of the packet header
+ * @payload: (transfer full): a #GstBuffer holding the packet payload
+ *
+ * Turns @payload, as taken from the stream without copying its memories,
+ * into the #GstBuffer described by @header.
+ *
+ * This function does not check the header passed to it, use
+ * gst_dp_validate_header() first if the header data is unchecked, and
+ * gst_dp_validate_payload_buffer() to check @payload.
+ *
+ * Returns: A #GstBuffer if the buffer was successfully created, or NULL.
+ */
+GstBuffer *
+gst_dp_buffer_from_payload (guint header_length, const guint8 * header,
+    GstBuffer * payload)
+{
+  g_return_val_if_fail (header != NULL, NULL);
+  g_return_val_if_fail (header_length >= GST_DP_HEADER_LENGTH, NULL);
+  g_return_val_if_fail (GST_DP_HEADER_PAYLOAD_TYPE (header) ==
+      GST_DP_PAYLOAD_BUFFER, NULL);
+  g_return_val_if_fail (gst_buffer_get_size (payload) ==
+      GST_DP_HEADER_PAYLOAD_LENGTH (header), NULL);
+
+  payload = gst_buffer_make_writable (payload);
+  gst_dp_buffer_set_metadata (payload, header);
+
+  return payload;
+}
+
 /**
  * gst_dp_caps_from_packet:
  * @header_length: the length of the packet header
@@ -754,6 +809,42 @@ crc_error:
   }
 }
 
+/**
+ * gst_dp_validate_payload_buffer:
+ * @header_length: the length of the packet header
+ * @header: the byte array of the packet header
+ * @payload: a #GstBuffer holding the packet payload
+ *
+ * Validates the given packet payload using the given packet header
+ * by checking the CRC checksum over the memories of @payload, which do
+ * not need to be contiguous.
+ *
+ * Returns: %TRUE if the CRC matches, or no CRC checksum is present.
+ */
+gboolean
+gst_dp_validate_payload_buffer (guint header_length, const guint8 * header,
+    GstBuffer * payload)
+{
+  guint16 crc_read, crc_calculated;
+
+  g_return_val_if_fail (header != NULL, FALSE);
+  g_return_val_if_fail (header_length >= GST_DP_HEADER_LENGTH, FALSE);
+
+  if (!(GST_DP_HEADER_FLAGS (header) & GST_DP_HEADER_FLAG_CRC_PAYLOAD))
+    return TRUE;
+
+  crc_read = GST_DP_HEADER_CRC_PAYLOAD (header);
+  crc_calculated = gst_dp_crc_from_buffer (payload);
+  if (crc_read != crc_calculated) {
+    GST_WARNING ("payload crc mismatch: read %02x, calculated %02x", crc_read,
+        crc_calculated);
+    return FALSE;
+  }
+
+  GST_LOG ("payload crc validation: %02x", crc_read);
+  return TRUE;
+}
+
 /**
  * gst_dp_validate_packet:
  * @header_length: the length of the packet header
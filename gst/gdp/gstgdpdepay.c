@@ -259,6 +259,21 @@ gst_gdp_depay_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return res;
 }
 
+/* The payload can be pushed in the memories it arrived in unless downstream
+ * asked for a specific allocator or memory layout */
+static gboolean
+gst_gdp_depay_can_share_payload (GstGDPDepay * this)
+{
+  if (this->allocator &&
+      g_strcmp0 (this->allocator->mem_type, GST_ALLOCATOR_SYSMEM) != 0)
+    return FALSE;
+
+  return this->allocation_params.flags == 0 &&
+      this->allocation_params.align == 0 &&
+      this->allocation_params.prefix == 0 &&
+      this->allocation_params.padding == 0;
+}
+
 static GstFlowReturn
 gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
@@ -340,7 +355,9 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
           goto wrong_type;
         }
 
-        if (this->payload_length) {
+        /* buffer payloads are checked in place once taken, the others are
+         * parsed from a contiguous copy anyway */
+        if (this->payload_length && this->state != GST_GDP_DEPAY_STATE_BUFFER) {
           const guint8 *data;
           gboolean res;
 
@@ -362,21 +379,49 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
           goto no_caps;
 
         GST_LOG_OBJECT (this, "reading GDP buffer from adapter");
-        buf =
-            gst_dp_buffer_from_header (GST_DP_HEADER_LENGTH, this->header,
-            this->allocator, &this->allocation_params);
-        if (!buf)
-          goto buffer_failed;
-
-        /* now take the payload if there is any */
-        if (this->payload_length > 0) {
-          GstMapInfo map;
-
-          gst_buffer_map (buf, &map, GST_MAP_WRITE);
-          gst_adapter_copy (this->adapter, map.data, 0, this->payload_length);
-          gst_buffer_unmap (buf, &map);
+        if (gst_gdp_depay_can_share_payload (this)) {
+          GstBuffer *payload;
+
+          /* take the payload memories by reference */
+          if (this->payload_length > 0)
+            payload = gst_adapter_take_buffer_fast (this->adapter,
+                this->payload_length);
+          else
+            payload = gst_buffer_new ();
+
+          if (!gst_dp_validate_payload_buffer (GST_DP_HEADER_LENGTH,
+                  this->header, payload)) {
+            gst_buffer_unref (payload);
+            goto payload_validate_error;
+          }
 
-          gst_adapter_flush (this->adapter, this->payload_length);
+          buf = gst_dp_buffer_from_payload (GST_DP_HEADER_LENGTH, this->header,
+              payload);
+          if (!buf)
+            goto buffer_failed;
+        } else {
+          buf =
+              gst_dp_buffer_from_header (GST_DP_HEADER_LENGTH, this->header,
+              this->allocator, &this->allocation_params);
+          if (!buf)
+            goto buffer_failed;
+
+          /* now take the payload if there is any */
+          if (this->payload_length > 0) {
+            GstMapInfo map;
+
+            gst_buffer_map (buf, &map, GST_MAP_WRITE);
+            gst_adapter_copy (this->adapter, map.data, 0, this->payload_length);
+            gst_buffer_unmap (buf, &map);
+
+            gst_adapter_flush (this->adapter, this->payload_length);
+          }
+
+          if (!gst_dp_validate_payload_buffer (GST_DP_HEADER_LENGTH,
+                  this->header, buf)) {
+            gst_buffer_unref (buf);
+            goto payload_validate_error;
+          }
         }
 
         if (GST_BUFFER_TIMESTAMP (buf) > -this->ts_offset)
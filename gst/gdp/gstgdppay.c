@@ -76,6 +76,8 @@ static void gst_gdp_pay_reset (GstGDPPay * this);
 
 static GstFlowReturn gst_gdp_pay_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
+static GstFlowReturn gst_gdp_pay_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list);
 static gboolean gst_gdp_pay_src_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static gboolean gst_gdp_pay_sink_event (GstPad * pad, GstObject * parent,
@@ -132,6 +134,8 @@ gst_gdp_pay_init (GstGDPPay * gdppay)
       gst_pad_new_from_static_template (&gdp_pay_sink_template, "sink");
   gst_pad_set_chain_function (gdppay->sinkpad,
       GST_DEBUG_FUNCPTR (gst_gdp_pay_chain));
+  gst_pad_set_chain_list_function (gdppay->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_gdp_pay_chain_list));
   gst_pad_set_event_function (gdppay->sinkpad,
       GST_DEBUG_FUNCPTR (gst_gdp_pay_sink_event));
   gst_element_add_pad (GST_ELEMENT (gdppay), gdppay->sinkpad);
@@ -420,14 +424,12 @@ gst_gdp_queue_buffer (GstGDPPay * this, GstBuffer * buffer)
   return GST_FLOW_OK;
 }
 
+/* create the GDP buffer for @buffer, which stays owned by the caller */
 static GstFlowReturn
-gst_gdp_pay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_gdp_pay_payload_buffer (GstGDPPay * this, GstBuffer * buffer,
+    GstBuffer ** outbuf)
 {
-  GstGDPPay *this;
   GstBuffer *outbuffer;
-  GstFlowReturn ret;
-
-  this = GST_GDP_PAY (parent);
 
   /* we should have received a new_segment before, otherwise it's a bug.
    * fake one in that case */
@@ -478,15 +480,9 @@ gst_gdp_pay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GST_BUFFER_TIMESTAMP (outbuffer) = GST_BUFFER_TIMESTAMP (buffer);
   GST_BUFFER_DURATION (outbuffer) = GST_BUFFER_DURATION (buffer);
 
-  if (this->reset_streamheader)
-    gst_gdp_pay_reset_streamheader (this);
-
-  ret = gst_gdp_queue_buffer (this, outbuffer);
-
-done:
-  gst_buffer_unref (buffer);
+  *outbuf = outbuffer;
 
-  return ret;
+  return GST_FLOW_OK;
 
   /* ERRORS */
 no_caps:
@@ -495,16 +491,87 @@ no_caps:
      * message */
     GST_ELEMENT_ERROR (this, STREAM, FORMAT, (NULL),
         ("first received buffer does not have caps set"));
-    ret = GST_FLOW_NOT_NEGOTIATED;
-    goto done;
+    return GST_FLOW_NOT_NEGOTIATED;
   }
 no_buffer:
   {
     GST_ELEMENT_ERROR (this, STREAM, ENCODE, (NULL),
         ("Could not create GDP buffer from buffer"));
-    ret = GST_FLOW_ERROR;
-    goto done;
+    return GST_FLOW_ERROR;
+  }
+}
+
+static GstFlowReturn
+gst_gdp_pay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstGDPPay *this;
+  GstBuffer *outbuffer;
+  GstFlowReturn ret;
+
+  this = GST_GDP_PAY (parent);
+
+  ret = gst_gdp_pay_payload_buffer (this, buffer, &outbuffer);
+  if (ret == GST_FLOW_OK) {
+    if (this->reset_streamheader)
+      gst_gdp_pay_reset_streamheader (this);
+
+    ret = gst_gdp_queue_buffer (this, outbuffer);
   }
+
+  gst_buffer_unref (buffer);
+
+  return ret;
+}
+
+/* The GDP buffers only reference the memories of the incoming buffers, so
+ * a list in gives a list of headers and shared payloads out in one push */
+static GstFlowReturn
+gst_gdp_pay_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  GstGDPPay *this;
+  GstBufferList *outlist;
+  GstBuffer *outbuffer;
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i, len;
+
+  this = GST_GDP_PAY (parent);
+
+  len = gst_buffer_list_length (list);
+  outlist = gst_buffer_list_new_sized (len);
+
+  for (i = 0; i < len; i++) {
+    ret = gst_gdp_pay_payload_buffer (this, gst_buffer_list_get (list, i),
+        &outbuffer);
+    if (ret != GST_FLOW_OK)
+      break;
+
+    /* before the streamheaders are out the buffers go through the queue,
+     * streamheaders are only reset by events so this only happens for the
+     * first buffers of the list */
+    if (this->sent_streamheader && !this->reset_streamheader) {
+      gst_buffer_list_add (outlist, outbuffer);
+      continue;
+    }
+
+    if (this->reset_streamheader)
+      gst_gdp_pay_reset_streamheader (this);
+
+    ret = gst_gdp_queue_buffer (this, outbuffer);
+    if (ret != GST_FLOW_OK)
+      break;
+  }
+
+  if (ret == GST_FLOW_OK && gst_buffer_list_length (outlist) > 0) {
+    GST_LOG_OBJECT (this, "Pushing list of %u GDP buffers",
+        gst_buffer_list_length (outlist));
+    ret = gst_pad_push_list (this->srcpad, outlist);
+  } else {
+    gst_buffer_list_unref (outlist);
+  }
+
+  gst_buffer_list_unref (list);
+
+  return ret;
 }
 
 static gboolean
@@ -59,6 +59,12 @@ static void record_pcr (MpegTSPacketizer2 * packetizer, MpegTSPCR * pcrtable,
 #define CONTINUITY_UNSET 255
 #define VERSION_NUMBER_UNSET 255
 #define TABLE_ID_UNSET 0xFF
+
+#define SUBTABLE_KEY(table_id, subtable_extension) \
+  GUINT_TO_POINTER (((table_id) << 16) | (subtable_extension))
+/* Long sections have an 8 byte header and end with a CRC_32 */
+#define SECTION_HAS_CRC(data, length) (((data)[1] & 0x80) && (length) >= 12)
+
 #define PACKET_SYNC_BYTE 0x47
 
 static inline MpegTSPCR *
@@ -135,31 +141,25 @@ mpegts_packetizer_get_current_time (MpegTSPacketizer2 * packetizer,
 }
 
 static inline MpegTSPacketizerStreamSubtable *
-find_subtable (GSList * subtables, guint8 table_id, guint16 subtable_extension)
+find_subtable (MpegTSPacketizerStream * stream, guint8 table_id,
+    guint16 subtable_extension)
 {
-  GSList *tmp;
-
-  /* FIXME: Make this an array ! */
-  for (tmp = subtables; tmp; tmp = tmp->next) {
-    MpegTSPacketizerStreamSubtable *sub =
-        (MpegTSPacketizerStreamSubtable *) tmp->data;
-    if (sub->table_id == table_id
-        && sub->subtable_extension == subtable_extension)
-      return sub;
-  }
-
-  return NULL;
+  return g_hash_table_lookup (stream->subtables, SUBTABLE_KEY (table_id,
+          subtable_extension));
 }
 
+/* data/size are the beginning of the section and what is available of it
+ * in the current packet */
 static gboolean
 seen_section_before (MpegTSPacketizerStream * stream, guint8 table_id,
     guint16 subtable_extension, guint8 version_number, guint8 section_number,
-    guint8 last_section_number)
+    guint8 last_section_number, const guint8 * data, gsize size,
+    guint section_length)
 {
   MpegTSPacketizerStreamSubtable *subtable;
 
   /* Check if we've seen this table_id/subtable_extension first */
-  subtable = find_subtable (stream->subtables, table_id, subtable_extension);
+  subtable = find_subtable (stream, table_id, subtable_extension);
   if (!subtable) {
     GST_DEBUG ("Haven't seen subtable");
     return FALSE;
@@ -174,8 +174,19 @@ seen_section_before (MpegTSPacketizerStream * stream, guint8 table_id,
     GST_DEBUG ("Different last_section_number");
     return FALSE;
   }
-  /* Finally return whether we saw that section or not */
-  return MPEGTS_BIT_IS_SET (subtable->seen_section, section_number);
+  /* Did we see that section ? */
+  if (!MPEGTS_BIT_IS_SET (subtable->seen_section, section_number))
+    return FALSE;
+  /* Finally if the whole section is in this packet, check that its content
+   * didn't change without a version update */
+  if (section_length <= size && SECTION_HAS_CRC (data, section_length) &&
+      GST_READ_UINT32_BE (data + section_length - 4) !=
+      subtable->section_crc[section_number]) {
+    GST_DEBUG ("Different CRC");
+    return FALSE;
+  }
+
+  return TRUE;
 }
 
 static MpegTSPacketizerStreamSubtable *
@@ -189,9 +200,18 @@ mpegts_packetizer_stream_subtable_new (guint8 table_id,
   subtable->table_id = table_id;
   subtable->subtable_extension = subtable_extension;
   subtable->last_section_number = last_section_number;
+  subtable->section_crc = g_new0 (guint32, last_section_number + 1);
   return subtable;
 }
 
+static void
+mpegts_packetizer_stream_subtable_free (MpegTSPacketizerStreamSubtable *
+    subtable)
+{
+  g_free (subtable->section_crc);
+  g_free (subtable);
+}
+
 static MpegTSPacketizerStream *
 mpegts_packetizer_stream_new (guint16 pid)
 {
@@ -199,7 +219,8 @@ mpegts_packetizer_stream_new (guint16 pid)
 
   stream = (MpegTSPacketizerStream *) g_new0 (MpegTSPacketizerStream, 1);
   stream->continuity_counter = CONTINUITY_UNSET;
-  stream->subtables = NULL;
+  stream->subtables = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) mpegts_packetizer_stream_subtable_free);
   stream->table_id = TABLE_ID_UNSET;
   stream->pid = pid;
   return stream;
@@ -216,20 +237,11 @@ mpegts_packetizer_clear_section (MpegTSPacketizerStream * stream)
   stream->section_data = NULL;
 }
 
-static void
-mpegts_packetizer_stream_subtable_free (MpegTSPacketizerStreamSubtable *
-    subtable)
-{
-  g_free (subtable);
-}
-
 static void
 mpegts_packetizer_stream_free (MpegTSPacketizerStream * stream)
 {
   mpegts_packetizer_clear_section (stream);
-  g_slist_foreach (stream->subtables,
-      (GFunc) mpegts_packetizer_stream_subtable_free, NULL);
-  g_slist_free (stream->subtables);
+  g_hash_table_unref (stream->subtables);
   g_free (stream);
 }
 
@@ -498,13 +510,19 @@ mpegts_packetizer_parse_section_header (MpegTSPacketizer2 * packetizer,
   GstMpegtsSection *res;
 
   subtable =
-      find_subtable (stream->subtables, stream->table_id,
-      stream->subtable_extension);
+      find_subtable (stream, stream->table_id, stream->subtable_extension);
   if (subtable) {
     GST_DEBUG ("Found previous subtable_extension:0x%04x",
         stream->subtable_extension);
-    if (G_UNLIKELY (stream->version_number != subtable->version_number)) {
-      /* If the version number changed, reset the subtable */
+    if (G_UNLIKELY (stream->version_number != subtable->version_number ||
+            stream->last_section_number != subtable->last_section_number)) {
+      /* If the version number or the number of sections changed, reset the
+       * subtable */
+      if (stream->last_section_number != subtable->last_section_number) {
+        g_free (subtable->section_crc);
+        subtable->section_crc =
+            g_new0 (guint32, stream->last_section_number + 1);
+      }
       subtable->version_number = stream->version_number;
       subtable->last_section_number = stream->last_section_number;
       memset (subtable->seen_section, 0, 32);
@@ -516,9 +534,18 @@ mpegts_packetizer_parse_section_header (MpegTSPacketizer2 * packetizer,
         stream->subtable_extension, stream->last_section_number);
     subtable->version_number = stream->version_number;
 
-    stream->subtables = g_slist_prepend (stream->subtables, subtable);
+    g_hash_table_insert (stream->subtables,
+        SUBTABLE_KEY (stream->table_id, stream->subtable_extension),
+        subtable);
   }
 
+  /* Remember the CRC, to tell repeats from changes without a version
+   * update in seen_section_before() */
+  if (SECTION_HAS_CRC (stream->section_data, stream->section_length))
+    subtable->section_crc[stream->section_number] =
+        GST_READ_UINT32_BE (stream->section_data + stream->section_length -
+        4);
+
   GST_MEMDUMP ("Full section data", stream->section_data,
       stream->section_length);
   /* TODO ? : Replace this by an efficient version (where we provide all
@@ -1165,9 +1192,12 @@ section_start:
    * * same version_number
    * * same last_section_number
    * * same section_number was seen
+   * * same CRC_32, if the whole section is in this packet
+   * so that repeated sections are dropped before being copied or parsed.
    */
   if (seen_section_before (stream, table_id, subtable_extension,
-          version_number, section_number, last_section_number)) {
+          version_number, section_number, last_section_number, data_start,
+          packet->data_end - data_start, section_length)) {
     GST_DEBUG
         ("PID 0x%04x Already processed table_id:0x%02x subtable_extension:0x%04x, version_number:%d, section_number:%d",
         packet->pid, table_id, subtable_extension, version_number,
@@ -85,7 +85,8 @@ typedef struct
   guint8  section_number;
   guint8  last_section_number;
 
-  GSList *subtables;
+  /* MpegTSPacketizerStreamSubtable, by SUBTABLE_KEY (table_id, extension) */
+  GHashTable *subtables;
 
   /* Upstream offset of the data contained in the section */
   guint64 offset;
@@ -323,6 +324,8 @@ typedef struct
    * Use MPEGTS_BIT_* macros to check */
   /* Size is 32, because there's a maximum of 256 (32*8) section_number */
   guint8   seen_section[32];
+  /* CRC_32 of the seen sections, last_section_number + 1 entries */
+  guint32 *section_crc;
 } MpegTSPacketizerStreamSubtable;
 
 #define MPEGTS_BIT_SET(field, offs)    ((field)[(offs) >> 3] |=  (1 << ((offs) & 0x7)))
@@ -0,0 +1,502 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * A small subset of the tcpdump / BPF filter syntax, evaluated on the
+ * headers pcapparse extracts from each packet:
+ *
+ *   expr      := term { ("or" | "||") term }
+ *   term      := factor { ("and" | "&&") factor }
+ *   factor    := ("not" | "!") factor | "(" expr ")" | primitive
+ *   primitive := "ip" | "ip6" | "udp" | "tcp" | "vlan" [id]
+ *              | [ "src" | "dst" ] "host" address
+ *              | [ "src" | "dst" ] "net" address "/" prefix-length
+ *              | [ "src" | "dst" ] "port" number
+ *
+ * For example "udp and dst net 239.0.0.0/8 and not port 5004".
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gio/gio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gstpcapfilter.h"
+
+typedef enum
+{
+  NODE_OR,
+  NODE_AND,
+  NODE_NOT,
+  NODE_IP,
+  NODE_IP6,
+  NODE_UDP,
+  NODE_TCP,
+  NODE_VLAN,
+  NODE_NET,
+  NODE_PORT
+} NodeType;
+
+typedef enum
+{
+  DIR_ANY,
+  DIR_SRC,
+  DIR_DST
+} Direction;
+
+typedef struct _Node Node;
+
+struct _Node
+{
+  NodeType type;
+  Node *left;
+  Node *right;
+
+  Direction dir;
+  gint vlan;                    /* -1 for any */
+  GstPcapAddress addr;
+  guint prefix_len;
+  guint16 port;
+};
+
+struct _GstPcapFilter
+{
+  Node *root;
+};
+
+typedef struct
+{
+  gchar **tokens;
+  guint pos;
+  GError **error;
+} Parser;
+
+#define IP_PROTO_TCP 6
+#define IP_PROTO_UDP 17
+
+gboolean
+gst_pcap_address_from_string (GstPcapAddress * addr, const gchar * str)
+{
+  GInetAddress *inet;
+
+  inet = g_inet_address_new_from_string (str);
+  if (!inet)
+    return FALSE;
+
+  memset (addr, 0, sizeof (GstPcapAddress));
+  if (g_inet_address_get_family (inet) == G_SOCKET_FAMILY_IPV4) {
+    addr->family = 4;
+    memcpy (addr->bytes, g_inet_address_to_bytes (inet), 4);
+  } else {
+    addr->family = 6;
+    memcpy (addr->bytes, g_inet_address_to_bytes (inet), 16);
+  }
+  g_object_unref (inet);
+
+  return TRUE;
+}
+
+gchar *
+gst_pcap_address_to_string (const GstPcapAddress * addr)
+{
+  GInetAddress *inet;
+  gchar *str;
+
+  if (addr->family == 0)
+    return g_strdup ("");
+
+  inet = g_inet_address_new_from_bytes (addr->bytes,
+      addr->family == 4 ? G_SOCKET_FAMILY_IPV4 : G_SOCKET_FAMILY_IPV6);
+  str = g_inet_address_to_string (inet);
+  g_object_unref (inet);
+
+  return str;
+}
+
+gboolean
+gst_pcap_address_equal (const GstPcapAddress * a, const GstPcapAddress * b)
+{
+  return a->family == b->family &&
+      memcmp (a->bytes, b->bytes, a->family == 4 ? 4 : 16) == 0;
+}
+
+static gboolean
+address_in_net (const GstPcapAddress * addr, const GstPcapAddress * net,
+    guint prefix_len)
+{
+  guint bytes = prefix_len / 8, bits = prefix_len % 8;
+
+  if (addr->family != net->family)
+    return FALSE;
+  if (memcmp (addr->bytes, net->bytes, bytes) != 0)
+    return FALSE;
+  if (bits) {
+    guint8 mask = 0xff << (8 - bits);
+
+    if ((addr->bytes[bytes] & mask) != (net->bytes[bytes] & mask))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+node_free (Node * node)
+{
+  if (!node)
+    return;
+  node_free (node->left);
+  node_free (node->right);
+  g_slice_free (Node, node);
+}
+
+static Node *
+node_new (NodeType type)
+{
+  Node *node = g_slice_new0 (Node);
+
+  node->type = type;
+  return node;
+}
+
+static const gchar *
+parser_peek (Parser * p)
+{
+  return p->tokens[p->pos];
+}
+
+static const gchar *
+parser_next (Parser * p)
+{
+  const gchar *token = p->tokens[p->pos];
+
+  if (token)
+    p->pos++;
+  return token;
+}
+
+static gboolean
+parser_accept (Parser * p, const gchar * a, const gchar * b)
+{
+  const gchar *token = parser_peek (p);
+
+  if (token && (!g_strcmp0 (token, a) || !g_strcmp0 (token, b))) {
+    p->pos++;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+static gboolean
+parse_uint (const gchar * str, guint max, guint * value)
+{
+  gchar *end;
+  guint64 v;
+
+  if (!str || !g_ascii_isdigit (*str))
+    return FALSE;
+  v = g_ascii_strtoull (str, &end, 10);
+  if (*end || v > max)
+    return FALSE;
+
+  *value = v;
+  return TRUE;
+}
+
+static Node *parse_or (Parser * p);
+
+static Node *
+parse_primitive (Parser * p)
+{
+  const gchar *token;
+  Direction dir = DIR_ANY;
+  Node *node;
+  guint v;
+
+  if (parser_accept (p, "src", NULL))
+    dir = DIR_SRC;
+  else if (parser_accept (p, "dst", NULL))
+    dir = DIR_DST;
+
+  token = parser_next (p);
+  if (!token) {
+    g_set_error (p->error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+        "unexpected end of filter");
+    return NULL;
+  }
+
+  if (dir == DIR_ANY) {
+    if (!strcmp (token, "ip"))
+      return node_new (NODE_IP);
+    if (!strcmp (token, "ip6"))
+      return node_new (NODE_IP6);
+    if (!strcmp (token, "udp"))
+      return node_new (NODE_UDP);
+    if (!strcmp (token, "tcp"))
+      return node_new (NODE_TCP);
+    if (!strcmp (token, "vlan")) {
+      node = node_new (NODE_VLAN);
+      node->vlan = -1;
+      if (parse_uint (parser_peek (p), 4095, &v)) {
+        parser_next (p);
+        node->vlan = v;
+      }
+      return node;
+    }
+  }
+
+  if (!strcmp (token, "host") || !strcmp (token, "net")) {
+    gboolean net = !strcmp (token, "net");
+    const gchar *arg = parser_next (p);
+    gchar **parts;
+    gboolean ok;
+
+    node = node_new (NODE_NET);
+    node->dir = dir;
+
+    parts = g_strsplit (arg ? arg : "", "/", 2);
+    ok = gst_pcap_address_from_string (&node->addr, parts[0]);
+    node->prefix_len = node->addr.family == 4 ? 32 : 128;
+    if (ok && net && parts[1])
+      ok = parse_uint (parts[1], node->prefix_len, &node->prefix_len);
+    else if (ok && (net != (parts[1] != NULL)))
+      ok = FALSE;
+    g_strfreev (parts);
+
+    if (!ok) {
+      g_set_error (p->error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+          "invalid %s '%s'", token, arg ? arg : "");
+      node_free (node);
+      return NULL;
+    }
+    return node;
+  }
+
+  if (!strcmp (token, "port")) {
+    const gchar *arg = parser_next (p);
+
+    if (!parse_uint (arg, G_MAXUINT16, &v)) {
+      g_set_error (p->error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+          "invalid port '%s'", arg ? arg : "");
+      return NULL;
+    }
+    node = node_new (NODE_PORT);
+    node->dir = dir;
+    node->port = v;
+    return node;
+  }
+
+  g_set_error (p->error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+      "unexpected '%s' in filter", token);
+  return NULL;
+}
+
+static Node *
+parse_not (Parser * p)
+{
+  Node *node;
+
+  if (parser_accept (p, "not", "!")) {
+    node = node_new (NODE_NOT);
+    node->left = parse_not (p);
+    if (!node->left) {
+      node_free (node);
+      return NULL;
+    }
+    return node;
+  }
+
+  if (parser_accept (p, "(", NULL)) {
+    node = parse_or (p);
+    if (node && !parser_accept (p, ")", NULL)) {
+      g_set_error (p->error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+          "missing ')' in filter");
+      node_free (node);
+      return NULL;
+    }
+    return node;
+  }
+
+  return parse_primitive (p);
+}
+
+static Node *
+parse_and (Parser * p)
+{
+  Node *node, *op;
+
+  node = parse_not (p);
+  while (node && parser_accept (p, "and", "&&")) {
+    op = node_new (NODE_AND);
+    op->left = node;
+    op->right = parse_not (p);
+    node = op;
+    if (!op->right) {
+      node_free (op);
+      return NULL;
+    }
+  }
+
+  return node;
+}
+
+static Node *
+parse_or (Parser * p)
+{
+  Node *node, *op;
+
+  node = parse_and (p);
+  while (node && parser_accept (p, "or", "||")) {
+    op = node_new (NODE_OR);
+    op->left = node;
+    op->right = parse_and (p);
+    node = op;
+    if (!op->right) {
+      node_free (op);
+      return NULL;
+    }
+  }
+
+  return node;
+}
+
+/* splits @expression on white space, with parentheses and '!' as separate
+ * tokens */
+static gchar **
+tokenize (const gchar * expression)
+{
+  GPtrArray *tokens = g_ptr_array_new ();
+  const gchar *s = expression, *start;
+
+  while (*s) {
+    if (g_ascii_isspace (*s)) {
+      s++;
+    } else if (*s == '(' || *s == ')' || (*s == '!' && s[1] != '=')) {
+      g_ptr_array_add (tokens, g_strndup (s, 1));
+      s++;
+    } else {
+      for (start = s; *s && !g_ascii_isspace (*s) && *s != '(' && *s != ')';)
+        s++;
+      g_ptr_array_add (tokens, g_strndup (start, s - start));
+    }
+  }
+  g_ptr_array_add (tokens, NULL);
+
+  return (gchar **) g_ptr_array_free (tokens, FALSE);
+}
+
+/**
+ * gst_pcap_filter_new:
+ * @expression: a filter expression
+ * @error: return location for a #GError
+ *
+ * Returns: a new #GstPcapFilter, or %NULL if @expression is invalid
+ */
+GstPcapFilter *
+gst_pcap_filter_new (const gchar * expression, GError ** error)
+{
+  GstPcapFilter *filter;
+  Parser p = { NULL, 0, error };
+  Node *root;
+
+  p.tokens = tokenize (expression);
+  if (!p.tokens[0]) {
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+        "empty filter");
+    g_strfreev (p.tokens);
+    return NULL;
+  }
+
+  root = parse_or (&p);
+  if (root && parser_peek (&p)) {
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+        "unexpected '%s' in filter", parser_peek (&p));
+    node_free (root);
+    root = NULL;
+  }
+  g_strfreev (p.tokens);
+
+  if (!root)
+    return NULL;
+
+  filter = g_new0 (GstPcapFilter, 1);
+  filter->root = root;
+
+  return filter;
+}
+
+void
+gst_pcap_filter_free (GstPcapFilter * filter)
+{
+  if (!filter)
+    return;
+  node_free (filter->root);
+  g_free (filter);
+}
+
+static gboolean
+node_match (const Node * node, const GstPcapPacketInfo * info)
+{
+  guint i;
+
+  switch (node->type) {
+    case NODE_OR:
+      return node_match (node->left, info) || node_match (node->right, info);
+    case NODE_AND:
+      return node_match (node->left, info) && node_match (node->right, info);
+    case NODE_NOT:
+      return !node_match (node->left, info);
+    case NODE_IP:
+      return info->src.family == 4;
+    case NODE_IP6:
+      return info->src.family == 6;
+    case NODE_UDP:
+      return info->protocol == IP_PROTO_UDP;
+    case NODE_TCP:
+      return info->protocol == IP_PROTO_TCP;
+    case NODE_VLAN:
+      if (node->vlan < 0)
+        return info->n_vlans > 0;
+      for (i = 0; i < info->n_vlans; i++) {
+        if (info->vlans[i] == node->vlan)
+          return TRUE;
+      }
+      return FALSE;
+    case NODE_NET:
+      return (node->dir != DIR_DST &&
+          address_in_net (&info->src, &node->addr, node->prefix_len)) ||
+          (node->dir != DIR_SRC &&
+          address_in_net (&info->dst, &node->addr, node->prefix_len));
+    case NODE_PORT:
+      return (node->dir != DIR_DST && info->src_port == node->port) ||
+          (node->dir != DIR_SRC && info->dst_port == node->port);
+  }
+
+  return FALSE;
+}
+
+gboolean
+gst_pcap_filter_match (const GstPcapFilter * filter,
+    const GstPcapPacketInfo * info)
+{
+  return node_match (filter->root, info);
+}
@@ -0,0 +1,73 @@
+/* GStreamer
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PCAP_FILTER_H__
+#define __GST_PCAP_FILTER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_PCAP_MAX_VLANS 4
+
+/* An IPv4 or IPv6 address in network byte order, IPv4 addresses only use
+ * the first 4 bytes.  A family of 0 means unset. */
+typedef struct
+{
+  guint8 family;                /* 4 or 6 */
+  guint8 bytes[16];
+} GstPcapAddress;
+
+/* What is known about a captured packet after parsing its headers */
+typedef struct
+{
+  guint n_vlans;
+  guint16 vlans[GST_PCAP_MAX_VLANS];
+
+  GstPcapAddress src;
+  GstPcapAddress dst;
+  guint8 protocol;
+  guint16 src_port;
+  guint16 dst_port;
+
+  const guint8 *payload;
+  gsize payload_size;
+} GstPcapPacketInfo;
+
+typedef struct _GstPcapFilter GstPcapFilter;
+
+GstPcapFilter * gst_pcap_filter_new   (const gchar * expression,
+                                       GError ** error);
+
+void            gst_pcap_filter_free  (GstPcapFilter * filter);
+
+gboolean        gst_pcap_filter_match (const GstPcapFilter * filter,
+                                       const GstPcapPacketInfo * info);
+
+gboolean        gst_pcap_address_from_string (GstPcapAddress * addr,
+                                              const gchar * str);
+
+gchar *         gst_pcap_address_to_string   (const GstPcapAddress * addr);
+
+gboolean        gst_pcap_address_equal       (const GstPcapAddress * a,
+                                              const GstPcapAddress * b);
+
+G_END_DECLS
+
+#endif /* __GST_PCAP_FILTER_H__ */
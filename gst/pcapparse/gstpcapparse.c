@@ -17,14 +17,31 @@
  * Boston, MA 02110-1301, USA.
  */
 
+
 /**
  * SECTION:element-pcapparse
  * @title: pcapparse
  *
- * Extracts payloads from Ethernet-encapsulated IP packets.
+ * Extracts payloads from IP packets in pcap and pcapng captures.
+ * Ethernet (with any number of stacked 802.1Q / 802.1ad VLAN tags), Linux
+ * cooked (SLL), BSD loopback and raw IP captures are understood, carrying
+ * UDP or TCP over IPv4 or IPv6.
+ *
  * Use #GstPcapParse:src-ip, #GstPcapParse:dst-ip,
  * #GstPcapParse:src-port and #GstPcapParse:dst-port to restrict which packets
- * should be included.
+ * should be included, or #GstPcapParse:filter for a tcpdump-like filter
+ * expression such as "udp and dst port 5004 and not vlan 20".
+ *
+ * Several flows can be extracted from one capture in a single pass by
+ * requesting "src_\%u" pads and setting a filter on each of them.  Every
+ * packet goes to the first request pad whose filter matches it, in the order
+ * the pads were requested, and otherwise to the always "src" pad.
+ *
+ * When upstream supports random access, as filesrc does, the capture is read
+ * in pull mode in large chunks and the payloads are output as sub-buffers of
+ * those chunks, without copying.  Seeking in time is then supported, by
+ * reading the capture again from the start and dropping the packets before
+ * the requested position.
  *
  * ## Example pipelines
  * |[
@@ -32,35 +49,45 @@
  * ! ffdec_h264 ! fakesink
  * ]| Read from a pcap dump file using filesrc, extract the raw UDP packets,
  * depayload and decode them.
+ * |[
+ * gst-launch-1.0 filesrc location=call.pcapng ! pcapparse name=p
+ *   p::src_0::filter="udp dst port 5004" p::src_1::filter="udp dst port 5006"
+ *   p.src_0 ! fakesink p.src_1 ! fakesink p.src ! fakesink
+ * ]| Split the audio and video RTP flows of a capture, everything else goes
+ * to the always pad.
  *
  */
 
-/* TODO:
- * - Implement support for timestamping the buffers.
- */
-
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
 
 #include "gstpcapparse.h"
 
+#include <stdio.h>
 #include <string.h>
 
-#ifndef G_OS_WIN32
-#include <arpa/inet.h>
-#include <netinet/in.h>
-#include <string.h>
-#else
-#include <winsock2.h>
-#endif
-
-
 const guint GST_PCAPPARSE_MAGIC_MILLISECOND_NO_SWAP_ENDIAN = 0xa1b2c3d4;
 const guint GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN = 0xa1b23c4d;
 const guint GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN = 0xd4c3b2a1;
 const guint GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN = 0x4d3cb2a1;
 
+/* pcapng block types */
+#define PCAPNG_BLOCK_SHB 0x0A0D0D0A
+#define PCAPNG_BLOCK_IDB 0x00000001
+#define PCAPNG_BLOCK_SPB 0x00000003
+#define PCAPNG_BLOCK_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_OPT_IF_TSRESOL 9
+
+#define PCAP_HEADER_LEN 24
+#define PCAP_RECORD_HEADER_LEN 16
+
+/* refuse records larger than this, they can only come from corrupt files */
+#define MAX_RECORD_SIZE (16 * 1024 * 1024)
+
+/* how much is read at once in pull mode */
+#define PULL_CHUNK_SIZE (1024 * 1024)
 
 enum
 {
@@ -70,7 +97,15 @@ enum
   PROP_SRC_PORT,
   PROP_DST_PORT,
   PROP_CAPS,
-  PROP_TS_OFFSET
+  PROP_TS_OFFSET,
+  PROP_FILTER
+};
+
+enum
+{
+  PROP_PAD_0,
+  PROP_PAD_FILTER,
+  PROP_PAD_CAPS
 };
 
 GST_DEBUG_CATEGORY_STATIC (gst_pcap_parse_debug);
@@ -86,6 +121,21 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS_ANY);
 
+static GstStaticPadTemplate request_src_template =
+GST_STATIC_PAD_TEMPLATE ("src_%u",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS_ANY);
+
+/* a captured packet extracted from a pcap record or a pcapng block */
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+  GstPcapParseLinktype linktype;
+  GstClockTime ts;
+} GstPcapParsePacket;
+
 static void gst_pcap_parse_finalize (GObject * object);
 static void gst_pcap_parse_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
@@ -93,6 +143,9 @@ static void gst_pcap_parse_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static GstStateChangeReturn
 gst_pcap_parse_change_state (GstElement * element, GstStateChange transition);
+static GstPad *gst_pcap_parse_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps);
+static void gst_pcap_parse_release_pad (GstElement * element, GstPad * pad);
 
 static void gst_pcap_parse_reset (GstPcapParse * self);
 
@@ -100,10 +153,163 @@ static GstFlowReturn gst_pcap_parse_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buffer);
 static gboolean gst_pcap_sink_event (GstPad * pad,
     GstObject * parent, GstEvent * event);
+static gboolean gst_pcap_parse_sink_activate (GstPad * pad,
+    GstObject * parent);
+static gboolean gst_pcap_parse_sink_activate_mode (GstPad * pad,
+    GstObject * parent, GstPadMode mode, gboolean active);
+static void gst_pcap_parse_loop (GstPad * pad);
+static gboolean gst_pcap_parse_src_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+static gboolean gst_pcap_parse_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+
+static void gst_pcap_parse_child_proxy_init (gpointer g_iface,
+    gpointer iface_data);
+
+/* GstPcapParsePad */
+
+G_DEFINE_TYPE (GstPcapParsePad, gst_pcap_parse_pad, GST_TYPE_PAD);
+
+static void
+gst_pcap_parse_pad_finalize (GObject * object)
+{
+  GstPcapParsePad *pad = GST_PCAP_PARSE_PAD (object);
+
+  g_free (pad->filter_str);
+  if (pad->filter)
+    gst_pcap_filter_free (pad->filter);
+  if (pad->caps)
+    gst_caps_unref (pad->caps);
+  if (pad->pending)
+    gst_buffer_list_unref (pad->pending);
+
+  G_OBJECT_CLASS (gst_pcap_parse_pad_parent_class)->finalize (object);
+}
+
+static void
+gst_pcap_parse_pad_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstPcapParsePad *pad = GST_PCAP_PARSE_PAD (object);
+
+  switch (prop_id) {
+    case PROP_PAD_FILTER:
+      GST_OBJECT_LOCK (pad);
+      g_value_set_string (value, pad->filter_str);
+      GST_OBJECT_UNLOCK (pad);
+      break;
+    case PROP_PAD_CAPS:
+      GST_OBJECT_LOCK (pad);
+      gst_value_set_caps (value, pad->caps);
+      GST_OBJECT_UNLOCK (pad);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_pcap_parse_pad_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstPcapParsePad *pad = GST_PCAP_PARSE_PAD (object);
+
+  switch (prop_id) {
+    case PROP_PAD_FILTER:
+    {
+      const gchar *str = g_value_get_string (value);
+      GstPcapFilter *filter = NULL, *old_filter;
+      GError *err = NULL;
+
+      if (str && *str == '\0')
+        str = NULL;
+
+      if (str) {
+        filter = gst_pcap_filter_new (str, &err);
+        if (!filter) {
+          GST_WARNING_OBJECT (pad, "Invalid filter \"%s\": %s, no packet "
+              "will match", str, err->message);
+          g_clear_error (&err);
+        }
+      }
+
+      GST_OBJECT_LOCK (pad);
+      g_free (pad->filter_str);
+      pad->filter_str = g_strdup (str);
+      old_filter = pad->filter;
+      pad->filter = filter;
+      GST_OBJECT_UNLOCK (pad);
+
+      if (old_filter)
+        gst_pcap_filter_free (old_filter);
+      break;
+    }
+    case PROP_PAD_CAPS:
+    {
+      const GstCaps *new_caps = gst_value_get_caps (value);
+
+      GST_OBJECT_LOCK (pad);
+      gst_caps_replace (&pad->caps, (GstCaps *) new_caps);
+      GST_OBJECT_UNLOCK (pad);
+      break;
+    }
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_pcap_parse_pad_class_init (GstPcapParsePadClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_pcap_parse_pad_finalize;
+  gobject_class->get_property = gst_pcap_parse_pad_get_property;
+  gobject_class->set_property = gst_pcap_parse_pad_set_property;
+
+  g_object_class_install_property (gobject_class, PROP_PAD_FILTER,
+      g_param_spec_string ("filter", "Filter",
+          "tcpdump-like filter expression selecting the packets of this pad, "
+          "for example \"udp and dst port 5004\" (NULL = all packets)", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PAD_CAPS,
+      g_param_spec_boxed ("caps", "Caps",
+          "The caps of this pad (NULL = the caps of the element)",
+          GST_TYPE_CAPS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gst_pcap_parse_pad_init (GstPcapParsePad * pad)
+{
+  gst_pad_set_event_function (GST_PAD (pad),
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_src_event));
+  gst_pad_set_query_function (GST_PAD (pad),
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_src_query));
+}
 
+static gboolean
+gst_pcap_parse_pad_match (GstPcapParsePad * pad, const GstPcapPacketInfo * info)
+{
+  gboolean match;
+
+  /* an invalid filter matches nothing rather than everything */
+  GST_OBJECT_LOCK (pad);
+  match = pad->filter_str == NULL ||
+      (pad->filter != NULL && gst_pcap_filter_match (pad->filter, info));
+  GST_OBJECT_UNLOCK (pad);
+
+  return match;
+}
+
+/* GstPcapParse */
 
 #define parent_class gst_pcap_parse_parent_class
-G_DEFINE_TYPE (GstPcapParse, gst_pcap_parse, GST_TYPE_ELEMENT);
+G_DEFINE_TYPE_WITH_CODE (GstPcapParse, gst_pcap_parse, GST_TYPE_ELEMENT,
+    G_IMPLEMENT_INTERFACE (GST_TYPE_CHILD_PROXY,
+        gst_pcap_parse_child_proxy_init));
 
 static void
 gst_pcap_parse_class_init (GstPcapParseClass * klass)
@@ -117,12 +323,12 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
 
   g_object_class_install_property (gobject_class,
       PROP_SRC_IP, g_param_spec_string ("src-ip", "Source IP",
-          "Source IP to restrict to", "",
+          "Source IPv4 or IPv6 address to restrict to", "",
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (gobject_class,
       PROP_DST_IP, g_param_spec_string ("dst-ip", "Destination IP",
-          "Destination IP to restrict to", "",
+          "Destination IPv4 or IPv6 address to restrict to", "",
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (gobject_class,
@@ -145,10 +351,31 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
           "Relative timestamp offset (ns) to apply (-1 = use absolute packet time)",
           -1, G_MAXINT64, -1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPcapParse:filter:
+   *
+   * A tcpdump-like filter expression restricting the packets output on the
+   * always source pad, in addition to the address and port properties.
+   * Primitives are "ip", "ip6", "udp", "tcp", "vlan [id]" and
+   * "[src|dst] host", "[src|dst] net" and "[src|dst] port", which can be
+   * combined with "and", "or", "not" and parentheses.
+   */
+  g_object_class_install_property (gobject_class, PROP_FILTER,
+      g_param_spec_string ("filter", "Filter",
+          "tcpdump-like filter expression for the source pad, for example "
+          "\"udp and dst port 5004\" (NULL = all packets)", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (element_class, &sink_template);
-  gst_element_class_add_static_pad_template (element_class, &src_template);
+  gst_element_class_add_static_pad_template_with_gtype (element_class,
+      &src_template, GST_TYPE_PCAP_PARSE_PAD);
+  gst_element_class_add_static_pad_template_with_gtype (element_class,
+      &request_src_template, GST_TYPE_PCAP_PARSE_PAD);
 
   element_class->change_state = gst_pcap_parse_change_state;
+  element_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_request_new_pad);
+  element_class->release_pad = GST_DEBUG_FUNCPTR (gst_pcap_parse_release_pad);
 
   gst_element_class_set_static_metadata (element_class, "PCapParse",
       "Raw/Parser",
@@ -161,25 +388,36 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
 static void
 gst_pcap_parse_init (GstPcapParse * self)
 {
+  GstPadTemplate *templ;
+
   self->sink_pad = gst_pad_new_from_static_template (&sink_template, "sink");
   gst_pad_set_chain_function (self->sink_pad,
       GST_DEBUG_FUNCPTR (gst_pcap_parse_chain));
+  gst_pad_set_activate_function (self->sink_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_sink_activate));
+  gst_pad_set_activatemode_function (self->sink_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_sink_activate_mode));
   gst_pad_use_fixed_caps (self->sink_pad);
   gst_pad_set_event_function (self->sink_pad,
       GST_DEBUG_FUNCPTR (gst_pcap_sink_event));
   gst_element_add_pad (GST_ELEMENT (self), self->sink_pad);
 
-  self->src_pad = gst_pad_new_from_static_template (&src_template, "src");
+  templ = gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (self),
+      "src");
+  self->src_pad = g_object_new (GST_TYPE_PCAP_PARSE_PAD, "name", "src",
+      "direction", GST_PAD_SRC, "template", templ, NULL);
   gst_pad_use_fixed_caps (self->src_pad);
   gst_element_add_pad (GST_ELEMENT (self), self->src_pad);
 
-  self->src_ip = -1;
-  self->dst_ip = -1;
+  self->flow_combiner = gst_flow_combiner_new ();
+  gst_flow_combiner_add_pad (self->flow_combiner, self->src_pad);
+
   self->src_port = -1;
   self->dst_port = -1;
   self->offset = -1;
 
   self->adapter = gst_adapter_new ();
+  gst_segment_init (&self->segment, GST_FORMAT_TIME);
 
   gst_pcap_parse_reset (self);
 }
@@ -192,31 +430,20 @@ gst_pcap_parse_finalize (GObject * object)
   g_object_unref (self->adapter);
   if (self->caps)
     gst_caps_unref (self->caps);
+  g_list_free (self->request_pads);
+  gst_flow_combiner_free (self->flow_combiner);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
-static const gchar *
-get_ip_address_as_string (gint64 ip_addr)
-{
-  if (ip_addr >= 0) {
-    struct in_addr addr;
-    addr.s_addr = ip_addr;
-    return inet_ntoa (addr);
-  } else {
-    return "";
-  }
-}
-
 static void
-set_ip_address_from_string (gint64 * ip_addr, const gchar * ip_str)
+set_ip_address_from_string (GstPcapParse * self, GstPcapAddress * ip_addr,
+    const gchar * ip_str)
 {
-  if (ip_str[0] != '\0') {
-    gulong addr = inet_addr (ip_str);
-    if (addr != INADDR_NONE)
-      *ip_addr = addr;
-  } else {
-    *ip_addr = -1;
+  if (ip_str == NULL || ip_str[0] == '\0') {
+    ip_addr->family = 0;
+  } else if (!gst_pcap_address_from_string (ip_addr, ip_str)) {
+    GST_WARNING_OBJECT (self, "Invalid IP address \"%s\"", ip_str);
   }
 }
 
@@ -228,11 +455,11 @@ gst_pcap_parse_get_property (GObject * object, guint prop_id,
 
   switch (prop_id) {
     case PROP_SRC_IP:
-      g_value_set_string (value, get_ip_address_as_string (self->src_ip));
+      g_value_take_string (value, gst_pcap_address_to_string (&self->src_ip));
       break;
 
     case PROP_DST_IP:
-      g_value_set_string (value, get_ip_address_as_string (self->dst_ip));
+      g_value_take_string (value, gst_pcap_address_to_string (&self->dst_ip));
       break;
 
     case PROP_SRC_PORT:
@@ -251,6 +478,10 @@ gst_pcap_parse_get_property (GObject * object, guint prop_id,
       g_value_set_int64 (value, self->offset);
       break;
 
+    case PROP_FILTER:
+      g_object_get_property (G_OBJECT (self->src_pad), "filter", value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -265,11 +496,13 @@ gst_pcap_parse_set_property (GObject * object, guint prop_id,
 
   switch (prop_id) {
     case PROP_SRC_IP:
-      set_ip_address_from_string (&self->src_ip, g_value_get_string (value));
+      set_ip_address_from_string (self, &self->src_ip,
+          g_value_get_string (value));
       break;
 
     case PROP_DST_IP:
-      set_ip_address_from_string (&self->dst_ip, g_value_get_string (value));
+      set_ip_address_from_string (self, &self->dst_ip,
+          g_value_get_string (value));
       break;
 
     case PROP_SRC_PORT:
@@ -305,6 +538,10 @@ gst_pcap_parse_set_property (GObject * object, guint prop_id,
       self->offset = g_value_get_int64 (value);
       break;
 
+    case PROP_FILTER:
+      g_object_set_property (G_OBJECT (self->src_pad), "filter", value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -314,339 +551,1088 @@ gst_pcap_parse_set_property (GObject * object, guint prop_id,
 static void
 gst_pcap_parse_reset (GstPcapParse * self)
 {
+  GList *l;
+
   self->initialized = FALSE;
+  self->pcapng = FALSE;
   self->swap_endian = FALSE;
-  self->nanosecond_timestamp = FALSE;
-  self->cur_packet_size = -1;
+  self->n_interfaces = 0;
   self->cur_ts = GST_CLOCK_TIME_NONE;
   self->base_ts = GST_CLOCK_TIME_NONE;
-  self->newsegment_sent = FALSE;
+  self->pull_offset = 0;
+  self->pull_size = PULL_CHUNK_SIZE;
+
+  GST_OBJECT_LOCK (self);
+  for (l = GST_ELEMENT (self)->srcpads; l; l = l->next) {
+    GstPcapParsePad *pad = l->data;
+
+    pad->newsegment_sent = FALSE;
+    if (pad->pending) {
+      gst_buffer_list_unref (pad->pending);
+      pad->pending = NULL;
+    }
+  }
+  GST_OBJECT_UNLOCK (self);
 
+  gst_flow_combiner_reset (self->flow_combiner);
   gst_adapter_clear (self->adapter);
 }
 
-static guint32
+static inline guint16
+gst_pcap_parse_read_uint16 (GstPcapParse * self, const guint8 * p)
+{
+  guint16 val;
+
+  memcpy (&val, p, 2);
+
+  return self->swap_endian ? GUINT16_SWAP_LE_BE (val) : val;
+}
+
+static inline guint32
 gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
 {
-  guint32 val = *((guint32 *) p);
+  guint32 val;
 
-  if (self->swap_endian) {
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-    return GUINT32_FROM_BE (val);
-#else
-    return GUINT32_FROM_LE (val);
-#endif
+  memcpy (&val, p, 4);
+
+  return self->swap_endian ? GUINT32_SWAP_LE_BE (val) : val;
+}
+
+/* Returns the size of the record starting at @data, 0 if more than @avail
+ * bytes are needed to know it, in which case @needed is set to how many,
+ * or -1 after posting an error if the stream is corrupt. */
+static gssize
+gst_pcap_parse_record_size (GstPcapParse * self, const guint8 * data,
+    gsize avail, gsize * needed)
+{
+  guint32 len;
+
+  if (avail < 4) {
+    *needed = 4;
+    return 0;
+  }
+
+  /* the section header block type reads the same in both byte orders */
+  if (GST_READ_UINT32_LE (data) == PCAPNG_BLOCK_SHB &&
+      (self->pcapng || !self->initialized)) {
+    guint32 magic;
+
+    if (avail < 12) {
+      *needed = 12;
+      return 0;
+    }
+
+    memcpy (&magic, data + 8, 4);
+    if (magic == PCAPNG_BYTE_ORDER_MAGIC) {
+      self->swap_endian = FALSE;
+    } else if (GUINT32_SWAP_LE_BE (magic) == PCAPNG_BYTE_ORDER_MAGIC) {
+      self->swap_endian = TRUE;
+    } else {
+      GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+          ("Invalid pcapng byte order magic %X", magic));
+      return -1;
+    }
+  } else if (!self->initialized) {
+    *needed = PCAP_HEADER_LEN;
+    return avail < PCAP_HEADER_LEN ? 0 : PCAP_HEADER_LEN;
+  }
+
+  if (self->pcapng || !self->initialized) {
+    if (avail < 8) {
+      *needed = 8;
+      return 0;
+    }
+
+    len = gst_pcap_parse_read_uint32 (self, data + 4);
+    if (len < 12 || len % 4 != 0 || len > MAX_RECORD_SIZE) {
+      GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+          ("Invalid pcapng block length %u", len));
+      return -1;
+    }
+    return len;
+  }
+
+  if (avail < PCAP_RECORD_HEADER_LEN) {
+    *needed = PCAP_RECORD_HEADER_LEN;
+    return 0;
+  }
+
+  len = gst_pcap_parse_read_uint32 (self, data + 8);
+  if (len > MAX_RECORD_SIZE) {
+    GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+        ("Invalid pcap packet length %u", len));
+    return -1;
+  }
+
+  return PCAP_RECORD_HEADER_LEN + len;
+}
+
+static gboolean
+gst_pcap_parse_linktype_supported (guint32 linktype)
+{
+  switch (linktype) {
+    case LINKTYPE_NULL:
+    case LINKTYPE_ETHER:
+    case LINKTYPE_RAW:
+    case LINKTYPE_SLL:
+    case LINKTYPE_IPV4:
+    case LINKTYPE_IPV6:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+static GstFlowReturn
+gst_pcap_parse_file_header (GstPcapParse * self, const guint8 * data)
+{
+  guint32 magic;
+  guint32 linktype;
+  guint16 major_version;
+  gboolean nanosecond_timestamp = FALSE;
+
+  memcpy (&magic, data, 4);
+
+  if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_NO_SWAP_ENDIAN ||
+      magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN) {
+    self->swap_endian = FALSE;
+    if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN)
+      nanosecond_timestamp = TRUE;
+  } else if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN ||
+      magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN) {
+    self->swap_endian = TRUE;
+    if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN)
+      nanosecond_timestamp = TRUE;
   } else {
-    return val;
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("File is not a libpcap file, magic is %X", magic));
+    return GST_FLOW_ERROR;
+  }
+
+  major_version = gst_pcap_parse_read_uint16 (self, data + 4);
+  linktype = gst_pcap_parse_read_uint32 (self, data + 20);
+
+  if (major_version != 2) {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("File is not a libpcap major version 2, but %u", major_version));
+    return GST_FLOW_ERROR;
+  }
+
+  if (!gst_pcap_parse_linktype_supported (linktype)) {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("Only dumps of type Ethernet, raw IP, BSD loopback or Linux Cooked "
+            "(SLL) understood; type %d unknown", linktype));
+    return GST_FLOW_ERROR;
+  }
+
+  GST_DEBUG_OBJECT (self, "linktype %u", linktype);
+
+  self->interfaces[0].linktype = linktype;
+  self->interfaces[0].ts_rate = nanosecond_timestamp ? 1000000000 : 1000000;
+  self->n_interfaces = 1;
+  self->pcapng = FALSE;
+  self->initialized = TRUE;
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_pcap_parse_interface_block (GstPcapParse * self, const guint8 * data,
+    gsize size)
+{
+  GstPcapParseInterface *iface;
+  const guint8 *opt, *end = data + size - 4;
+
+  if (self->n_interfaces == GST_PCAP_PARSE_MAX_INTERFACES) {
+    GST_WARNING_OBJECT (self, "Too many interfaces, ignoring packets of "
+        "interface %u", self->n_interfaces);
+    return;
+  }
+
+  iface = &self->interfaces[self->n_interfaces++];
+  iface->linktype = gst_pcap_parse_read_uint16 (self, data + 8);
+  iface->ts_rate = 1000000;
+
+  for (opt = data + 16; opt + 4 <= end;) {
+    guint16 code = gst_pcap_parse_read_uint16 (self, opt);
+    guint16 len = gst_pcap_parse_read_uint16 (self, opt + 2);
+
+    if (code == 0 || opt + 4 + len > end)
+      break;
+
+    if (code == PCAPNG_OPT_IF_TSRESOL && len >= 1) {
+      guint8 resol = opt[4];
+
+      /* negative power of 2 if the high bit is set, else of 10 */
+      if (resol & 0x80) {
+        iface->ts_rate = G_GUINT64_CONSTANT (1) << MIN (resol & 0x7f, 63);
+      } else {
+        iface->ts_rate = 1;
+        while (resol-- > 0 && iface->ts_rate < G_GUINT64_CONSTANT (1) << 60)
+          iface->ts_rate *= 10;
+      }
+    }
+
+    opt += 4 + GST_ROUND_UP_4 (len);
+  }
+
+  GST_DEBUG_OBJECT (self, "interface %u: linktype %u, %" G_GUINT64_FORMAT
+      " ticks per second", self->n_interfaces - 1, iface->linktype,
+      iface->ts_rate);
+
+  if (!gst_pcap_parse_linktype_supported (iface->linktype))
+    GST_WARNING_OBJECT (self, "Unsupported linktype %u, ignoring packets of "
+        "interface %u", iface->linktype, self->n_interfaces - 1);
+}
+
+/* Parses a complete record of @size bytes, as returned by
+ * gst_pcap_parse_record_size(), and fills @packet if it contains a packet */
+static GstFlowReturn
+gst_pcap_parse_record (GstPcapParse * self, const guint8 * data, gsize size,
+    GstPcapParsePacket * packet)
+{
+  GstPcapParseInterface *iface;
+  guint32 type, caplen;
+  guint64 ticks;
+
+  packet->data = NULL;
+
+  if (!self->initialized && GST_READ_UINT32_LE (data) != PCAPNG_BLOCK_SHB)
+    return gst_pcap_parse_file_header (self, data);
+
+  if (!self->pcapng && self->initialized) {
+    iface = &self->interfaces[0];
+    ticks = gst_pcap_parse_read_uint32 (self, data + 4);
+    packet->ts = gst_pcap_parse_read_uint32 (self, data) * GST_SECOND +
+        gst_util_uint64_scale (ticks, GST_SECOND, iface->ts_rate);
+    packet->data = data + PCAP_RECORD_HEADER_LEN;
+    packet->size = size - PCAP_RECORD_HEADER_LEN;
+    packet->linktype = iface->linktype;
+    return GST_FLOW_OK;
+  }
+
+  type = gst_pcap_parse_read_uint32 (self, data);
+
+  switch (type) {
+    case PCAPNG_BLOCK_SHB:
+      if (size < 28 || gst_pcap_parse_read_uint16 (self, data + 12) != 1) {
+        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+            ("Unsupported pcapng section header"));
+        return GST_FLOW_ERROR;
+      }
+      GST_DEBUG_OBJECT (self, "pcapng section, %s endian",
+          self->swap_endian ? "swapped" : "native");
+      self->pcapng = TRUE;
+      self->initialized = TRUE;
+      self->n_interfaces = 0;
+      break;
+
+    case PCAPNG_BLOCK_IDB:
+      if (size < 20)
+        goto corrupt;
+      gst_pcap_parse_interface_block (self, data, size);
+      break;
+
+    case PCAPNG_BLOCK_EPB:
+    {
+      guint32 if_id;
+
+      if (size < 32)
+        goto corrupt;
+
+      if_id = gst_pcap_parse_read_uint32 (self, data + 8);
+      caplen = gst_pcap_parse_read_uint32 (self, data + 20);
+      if (caplen > size - 32)
+        goto corrupt;
+      if (if_id >= self->n_interfaces) {
+        GST_LOG_OBJECT (self, "packet of unknown interface %u", if_id);
+        break;
+      }
+
+      iface = &self->interfaces[if_id];
+      ticks = ((guint64) gst_pcap_parse_read_uint32 (self, data + 12) << 32) |
+          gst_pcap_parse_read_uint32 (self, data + 16);
+      packet->ts = gst_util_uint64_scale (ticks, GST_SECOND, iface->ts_rate);
+      packet->data = data + 28;
+      packet->size = caplen;
+      packet->linktype = iface->linktype;
+      break;
+    }
+
+    case PCAPNG_BLOCK_SPB:
+      if (size < 16)
+        goto corrupt;
+      if (self->n_interfaces == 0)
+        break;
+
+      /* simple packets have no timestamp nor captured length, they are
+       * truncated to the block size */
+      caplen = gst_pcap_parse_read_uint32 (self, data + 8);
+      packet->data = data + 12;
+      packet->size = MIN (caplen, size - 16);
+      packet->linktype = self->interfaces[0].linktype;
+      packet->ts = GST_CLOCK_TIME_NONE;
+      break;
+
+    default:
+      GST_LOG_OBJECT (self, "skipping pcapng block of type 0x%x", type);
+      break;
   }
+
+  return GST_FLOW_OK;
+
+corrupt:
+  GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+      ("Corrupt pcapng block of type 0x%x", type));
+  return GST_FLOW_ERROR;
 }
 
-#define ETH_MAC_ADDRESSES_LEN    12
 #define ETH_HEADER_LEN    14
 #define ETH_VLAN_HEADER_LEN    4
 #define SLL_HEADER_LEN    16
+#define NULL_HEADER_LEN    4
 #define IP_HEADER_MIN_LEN 20
+#define IP6_HEADER_LEN    40
 #define UDP_HEADER_LEN     8
+#define TCP_HEADER_MIN_LEN 20
+
+#define ETH_TYPE_IP       0x0800
+#define ETH_TYPE_IP6      0x86dd
+#define ETH_TYPE_VLAN     0x8100
+#define ETH_TYPE_QINQ     0x88a8
+#define ETH_TYPE_QINQ_OLD 0x9100
 
 #define IP_PROTO_UDP      17
 #define IP_PROTO_TCP      6
 
+#define IP6_EXT_HOP_BY_HOP 0
+#define IP6_EXT_ROUTING    43
+#define IP6_EXT_FRAGMENT   44
+#define IP6_EXT_DEST_OPTS  60
 
+/* Parses the link, network and transport headers of a packet.  Fragments
+ * other than the first one of a datagram are skipped, as they don't carry
+ * the transport header. */
 static gboolean
 gst_pcap_parse_scan_frame (GstPcapParse * self,
-    const guint8 * buf,
-    gint buf_size, const guint8 ** payload, gint * payload_size)
+    GstPcapParseLinktype linktype, const guint8 * buf, gsize buf_size,
+    GstPcapPacketInfo * info)
 {
-  const guint8 *buf_ip = 0;
+  const guint8 *end = buf + buf_size;
+  const guint8 *buf_ip;
   const guint8 *buf_proto;
   guint16 eth_type;
-  guint8 b;
-  guint8 ip_header_size;
   guint8 ip_protocol;
-  guint32 ip_src_addr;
-  guint32 ip_dst_addr;
-  guint16 src_port;
-  guint16 dst_port;
-  guint16 len;
+  guint len;
+
+  info->n_vlans = 0;
 
-  switch (self->linktype) {
+  switch (linktype) {
     case LINKTYPE_ETHER:
-      if (buf_size < ETH_HEADER_LEN + IP_HEADER_MIN_LEN + UDP_HEADER_LEN)
+      if (buf_size < ETH_HEADER_LEN)
         return FALSE;
-      eth_type = GUINT16_FROM_BE (*((guint16 *) (buf + ETH_MAC_ADDRESSES_LEN)));
-      /* check for vlan 802.1q header (4 bytes, with first two bytes equal to 0x8100)  */
-      if (eth_type == 0x8100) {
-        if (buf_size <
-            ETH_HEADER_LEN + ETH_VLAN_HEADER_LEN + IP_HEADER_MIN_LEN +
-            UDP_HEADER_LEN)
+      eth_type = GST_READ_UINT16_BE (buf + 12);
+      buf_ip = buf + ETH_HEADER_LEN;
+      /* 802.1Q and 802.1ad tags, possibly stacked */
+      while (eth_type == ETH_TYPE_VLAN || eth_type == ETH_TYPE_QINQ ||
+          eth_type == ETH_TYPE_QINQ_OLD) {
+        if (buf_ip + ETH_VLAN_HEADER_LEN > end)
           return FALSE;
-        eth_type =
-            GUINT16_FROM_BE (*((guint16 *) (buf + ETH_MAC_ADDRESSES_LEN +
-                    ETH_VLAN_HEADER_LEN)));
-        buf_ip = buf + ETH_HEADER_LEN + ETH_VLAN_HEADER_LEN;
-      } else {
-        buf_ip = buf + ETH_HEADER_LEN;
+        if (info->n_vlans < GST_PCAP_MAX_VLANS)
+          info->vlans[info->n_vlans++] = GST_READ_UINT16_BE (buf_ip) & 0xfff;
+        eth_type = GST_READ_UINT16_BE (buf_ip + 2);
+        buf_ip += ETH_VLAN_HEADER_LEN;
       }
       break;
     case LINKTYPE_SLL:
-      if (buf_size < SLL_HEADER_LEN + IP_HEADER_MIN_LEN + UDP_HEADER_LEN)
+      if (buf_size < SLL_HEADER_LEN)
         return FALSE;
-
-      eth_type = GUINT16_FROM_BE (*((guint16 *) (buf + 14)));
+      eth_type = GST_READ_UINT16_BE (buf + 14);
       buf_ip = buf + SLL_HEADER_LEN;
       break;
+    case LINKTYPE_NULL:
+    {
+      guint32 family;
+
+      if (buf_size < NULL_HEADER_LEN)
+        return FALSE;
+      /* address family in the byte order of the capturing host */
+      family = gst_pcap_parse_read_uint32 (self, buf);
+      if (family == 2)
+        eth_type = ETH_TYPE_IP;
+      else if (family == 24 || family == 28 || family == 30)
+        eth_type = ETH_TYPE_IP6;
+      else
+        return FALSE;
+      buf_ip = buf + NULL_HEADER_LEN;
+      break;
+    }
     case LINKTYPE_RAW:
-      if (buf_size < IP_HEADER_MIN_LEN + UDP_HEADER_LEN)
+      if (buf_size < 1)
         return FALSE;
-
-      eth_type = 0x800;         /* This is fine since IPv4/IPv6 is parse elsewhere */
+      eth_type = (buf[0] >> 4) == 6 ? ETH_TYPE_IP6 : ETH_TYPE_IP;
+      buf_ip = buf;
+      break;
+    case LINKTYPE_IPV4:
+      eth_type = ETH_TYPE_IP;
+      buf_ip = buf;
+      break;
+    case LINKTYPE_IPV6:
+      eth_type = ETH_TYPE_IP6;
       buf_ip = buf;
       break;
-
     default:
       return FALSE;
   }
 
-  if (eth_type != 0x800) {
-    GST_ERROR_OBJECT (self,
-        "Link type %d: Ethernet type %d is not supported; only type 0x800",
-        (gint) self->linktype, (gint) eth_type);
-    return FALSE;
-  }
+  if (eth_type == ETH_TYPE_IP) {
+    guint ip_header_size;
 
-  b = *buf_ip;
-  if (((b >> 4) & 0x0f) != 4)
-    return FALSE;
+    if (buf_ip + IP_HEADER_MIN_LEN > end || (buf_ip[0] >> 4) != 4)
+      return FALSE;
 
-  ip_header_size = (b & 0x0f) * 4;
-  if (buf_ip + ip_header_size > buf + buf_size)
-    return FALSE;
+    ip_header_size = (buf_ip[0] & 0x0f) * 4;
+    if (ip_header_size < IP_HEADER_MIN_LEN || buf_ip + ip_header_size > end)
+      return FALSE;
 
-  ip_protocol = *(buf_ip + 9);
-  GST_LOG_OBJECT (self, "ip proto %d", (gint) ip_protocol);
+    /* strip link layer padding */
+    len = GST_READ_UINT16_BE (buf_ip + 2);
+    if (len >= ip_header_size && buf_ip + len < end)
+      end = buf_ip + len;
 
-  if (ip_protocol != IP_PROTO_UDP && ip_protocol != IP_PROTO_TCP)
-    return FALSE;
+    if (GST_READ_UINT16_BE (buf_ip + 6) & 0x1fff)
+      return FALSE;
 
-  /* ip info */
-  ip_src_addr = *((guint32 *) (buf_ip + 12));
-  ip_dst_addr = *((guint32 *) (buf_ip + 16));
-  buf_proto = buf_ip + ip_header_size;
+    ip_protocol = buf_ip[9];
+    info->src.family = info->dst.family = 4;
+    memcpy (info->src.bytes, buf_ip + 12, 4);
+    memcpy (info->dst.bytes, buf_ip + 16, 4);
+    buf_proto = buf_ip + ip_header_size;
+  } else if (eth_type == ETH_TYPE_IP6) {
+    gint i;
 
-  /* ok for tcp and udp */
-  src_port = GUINT16_FROM_BE (*((guint16 *) (buf_proto + 0)));
-  dst_port = GUINT16_FROM_BE (*((guint16 *) (buf_proto + 2)));
+    if (buf_ip + IP6_HEADER_LEN > end || (buf_ip[0] >> 4) != 6)
+      return FALSE;
+
+    /* a payload length of 0 is a jumbogram, keep everything then */
+    len = GST_READ_UINT16_BE (buf_ip + 4);
+    if (len > 0 && buf_ip + IP6_HEADER_LEN + len < end)
+      end = buf_ip + IP6_HEADER_LEN + len;
+
+    ip_protocol = buf_ip[6];
+    info->src.family = info->dst.family = 6;
+    memcpy (info->src.bytes, buf_ip + 8, 16);
+    memcpy (info->dst.bytes, buf_ip + 24, 16);
+    buf_proto = buf_ip + IP6_HEADER_LEN;
+
+    /* skip the extension headers, a few at most in practice */
+    for (i = 0; i < 8; i++) {
+      if (ip_protocol == IP6_EXT_HOP_BY_HOP || ip_protocol == IP6_EXT_ROUTING
+          || ip_protocol == IP6_EXT_DEST_OPTS) {
+        if (buf_proto + 8 > end)
+          return FALSE;
+        ip_protocol = buf_proto[0];
+        buf_proto += (buf_proto[1] + 1) * 8;
+      } else if (ip_protocol == IP6_EXT_FRAGMENT) {
+        if (buf_proto + 8 > end ||
+            (GST_READ_UINT16_BE (buf_proto + 2) & 0xfff8))
+          return FALSE;
+        ip_protocol = buf_proto[0];
+        buf_proto += 8;
+      } else {
+        break;
+      }
+    }
+  } else {
+    GST_LOG_OBJECT (self, "Link type %d: Ethernet type 0x%x is not supported",
+        (gint) linktype, (gint) eth_type);
+    return FALSE;
+  }
+
+  GST_LOG_OBJECT (self, "ip proto %d", (gint) ip_protocol);
+  info->protocol = ip_protocol;
 
   /* extract some params and data according to protocol */
   if (ip_protocol == IP_PROTO_UDP) {
-    len = GUINT16_FROM_BE (*((guint16 *) (buf_proto + 4)));
-    if (len < UDP_HEADER_LEN || buf_proto + len > buf + buf_size)
+    if (buf_proto + UDP_HEADER_LEN > end)
       return FALSE;
 
-    *payload = buf_proto + UDP_HEADER_LEN;
-    *payload_size = len - UDP_HEADER_LEN;
-  } else {
-    if (buf_proto + 12 >= buf + buf_size)
+    len = GST_READ_UINT16_BE (buf_proto + 4);
+    if (len < UDP_HEADER_LEN || buf_proto + len > end)
       return FALSE;
+
+    info->payload = buf_proto + UDP_HEADER_LEN;
+    info->payload_size = len - UDP_HEADER_LEN;
+  } else if (ip_protocol == IP_PROTO_TCP) {
+    if (buf_proto + TCP_HEADER_MIN_LEN > end)
+      return FALSE;
+
     len = (buf_proto[12] >> 4) * 4;
-    if (buf_proto + len > buf + buf_size)
+    if (len < TCP_HEADER_MIN_LEN || buf_proto + len > end)
       return FALSE;
 
     /* all remaining data following tcp header is payload */
-    *payload = buf_proto + len;
-    *payload_size = self->cur_packet_size - (buf_proto - buf) - len;
+    info->payload = buf_proto + len;
+    info->payload_size = end - info->payload;
+  } else {
+    return FALSE;
+  }
+
+  /* ok for tcp and udp */
+  info->src_port = GST_READ_UINT16_BE (buf_proto);
+  info->dst_port = GST_READ_UINT16_BE (buf_proto + 2);
+
+  return TRUE;
+}
+
+/* Returns the pad @info should go to, or NULL if it should be dropped */
+static GstPcapParsePad *
+gst_pcap_parse_select_pad (GstPcapParse * self, const GstPcapPacketInfo * info)
+{
+  GstPcapParsePad *src_pad = GST_PCAP_PARSE_PAD (self->src_pad);
+  GList *l;
+
+  if (self->request_pads) {
+    GstPcapParsePad *pad = NULL;
+
+    GST_OBJECT_LOCK (self);
+    for (l = self->request_pads; l; l = l->next) {
+      if (gst_pcap_parse_pad_match (l->data, info)) {
+        pad = l->data;
+        break;
+      }
+    }
+    GST_OBJECT_UNLOCK (self);
+
+    if (pad)
+      return pad;
   }
 
   /* but still filter as configured */
-  if (self->src_ip >= 0 && ip_src_addr != self->src_ip)
-    return FALSE;
+  if (self->src_ip.family &&
+      !gst_pcap_address_equal (&info->src, &self->src_ip))
+    return NULL;
 
-  if (self->dst_ip >= 0 && ip_dst_addr != self->dst_ip)
-    return FALSE;
+  if (self->dst_ip.family &&
+      !gst_pcap_address_equal (&info->dst, &self->dst_ip))
+    return NULL;
 
-  if (self->src_port >= 0 && src_port != self->src_port)
-    return FALSE;
+  if (self->src_port >= 0 && info->src_port != self->src_port)
+    return NULL;
 
-  if (self->dst_port >= 0 && dst_port != self->dst_port)
-    return FALSE;
+  if (self->dst_port >= 0 && info->dst_port != self->dst_port)
+    return NULL;
 
-  return TRUE;
+  return gst_pcap_parse_pad_match (src_pad, info) ? src_pad : NULL;
+}
+
+/* the timestamp the stream time is relative to, that of the first packet
+ * unless the timestamps are offset */
+static GstClockTime
+gst_pcap_parse_get_origin (GstPcapParse * self)
+{
+  return self->offset >= 0 ? self->offset : self->base_ts;
+}
+
+/* queues @out_buf on @pad unless it is before the segment of the last seek,
+ * returns GST_FLOW_EOS once the end of that segment is reached */
+static GstFlowReturn
+gst_pcap_parse_queue_buffer (GstPcapParse * self, GstPcapParsePad * pad,
+    GstBuffer * out_buf, GstClockTime ts)
+{
+  if (GST_CLOCK_TIME_IS_VALID (ts)) {
+    GstClockTime origin;
+
+    if (!GST_CLOCK_TIME_IS_VALID (self->base_ts))
+      self->base_ts = ts;
+    if (self->offset >= 0) {
+      ts -= self->base_ts;
+      ts += self->offset;
+    }
+
+    origin = gst_pcap_parse_get_origin (self);
+    if (GST_CLOCK_TIME_IS_VALID (self->segment.stop) &&
+        ts >= origin + self->segment.stop) {
+      gst_buffer_unref (out_buf);
+      return GST_FLOW_EOS;
+    }
+    if (ts < origin + self->segment.start) {
+      gst_buffer_unref (out_buf);
+      return GST_FLOW_OK;
+    }
+  }
+  self->cur_ts = ts;
+  GST_BUFFER_TIMESTAMP (out_buf) = ts;
+
+  if (pad->pending == NULL)
+    pad->pending = gst_buffer_list_new ();
+  gst_buffer_list_add (pad->pending, out_buf);
+
+  return GST_FLOW_OK;
+}
+
+/* sends the stream-start, caps and segment events before the first buffer */
+static void
+gst_pcap_parse_start_pad (GstPcapParse * self, GstPcapParsePad * pad)
+{
+  if (pad->need_stream_start) {
+    gchar *stream_id;
+
+    stream_id = gst_pad_create_stream_id (GST_PAD (pad), GST_ELEMENT (self),
+        GST_PAD (pad) == self->src_pad ? NULL : GST_PAD_NAME (pad));
+    gst_pad_push_event (GST_PAD (pad), gst_event_new_stream_start (stream_id));
+    g_free (stream_id);
+    pad->need_stream_start = FALSE;
+  }
+
+  if (!pad->newsegment_sent) {
+    GstSegment segment;
+    GstEvent *event;
+    GstCaps *caps;
+
+    GST_OBJECT_LOCK (pad);
+    caps = pad->caps ? gst_caps_ref (pad->caps) : NULL;
+    GST_OBJECT_UNLOCK (pad);
+    if (caps == NULL && self->caps)
+      caps = gst_caps_ref (self->caps);
+
+    if (caps) {
+      gst_pad_set_caps (GST_PAD (pad), caps);
+      gst_caps_unref (caps);
+    }
+
+    gst_segment_init (&segment, GST_FORMAT_TIME);
+    if (self->offset >= 0)
+      segment.start = self->offset;
+    else if (GST_CLOCK_TIME_IS_VALID (self->base_ts))
+      segment.start = self->base_ts;
+
+    /* the segment of the last seek is in stream time */
+    segment.rate = self->segment.rate;
+    segment.time = self->segment.start;
+    segment.start += self->segment.start;
+    segment.position = segment.start;
+    if (GST_CLOCK_TIME_IS_VALID (self->segment.stop))
+      segment.stop = segment.start - segment.time + self->segment.stop;
+
+    event = gst_event_new_segment (&segment);
+    if (self->segment_seqnum)
+      gst_event_set_seqnum (event, self->segment_seqnum);
+    gst_pad_push_event (GST_PAD (pad), event);
+    pad->newsegment_sent = TRUE;
+  }
+}
+
+static GList *
+gst_pcap_parse_get_src_pads (GstPcapParse * self)
+{
+  GList *pads;
+
+  GST_OBJECT_LOCK (self);
+  pads = g_list_copy_deep (GST_ELEMENT (self)->srcpads,
+      (GCopyFunc) gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK (self);
+
+  return pads;
+}
+
+/* pushes the buffers collected for each pad and combines the flows */
+static GstFlowReturn
+gst_pcap_parse_push_pending (GstPcapParse * self)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GList *pads, *l;
+
+  pads = gst_pcap_parse_get_src_pads (self);
+  for (l = pads; l; l = l->next) {
+    GstPcapParsePad *pad = l->data;
+    GstBufferList *list = pad->pending;
+    GstFlowReturn pad_ret;
+
+    if (list == NULL)
+      continue;
+    pad->pending = NULL;
+
+    gst_pcap_parse_start_pad (self, pad);
+    pad_ret = gst_pad_push_list (GST_PAD (pad), list);
+    ret = gst_flow_combiner_update_pad_flow (self->flow_combiner,
+        GST_PAD (pad), pad_ret);
+  }
+  g_list_free_full (pads, gst_object_unref);
+
+  return ret;
+}
+
+static void
+gst_pcap_parse_push_eos (GstPcapParse * self)
+{
+  GList *pads, *l;
+
+  pads = gst_pcap_parse_get_src_pads (self);
+  for (l = pads; l; l = l->next) {
+    gst_pcap_parse_start_pad (self, l->data);
+    gst_pad_push_event (l->data, gst_event_new_eos ());
+  }
+  g_list_free_full (pads, gst_object_unref);
 }
 
 static GstFlowReturn
 gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
   GstPcapParse *self = GST_PCAP_PARSE (parent);
-  GstFlowReturn ret = GST_FLOW_OK;
-  GstBufferList *list = NULL;
+  GstFlowReturn ret = GST_FLOW_OK, push_ret;
 
   gst_adapter_push (self->adapter, buffer);
 
   while (ret == GST_FLOW_OK) {
-    gint avail;
+    GstPcapParsePacket packet;
+    GstPcapPacketInfo info;
+    GstPcapParsePad *out_pad;
     const guint8 *data;
+    gsize avail, needed;
+    gssize size = 0;
 
     avail = gst_adapter_available (self->adapter);
 
-    if (self->initialized) {
-      if (self->cur_packet_size >= 0) {
-        if (avail < self->cur_packet_size)
-          break;
-
-        if (self->cur_packet_size > 0) {
-          const guint8 *payload_data;
-          gint payload_size;
-
-          data = gst_adapter_map (self->adapter, self->cur_packet_size);
-
-          GST_LOG_OBJECT (self, "examining packet size %" G_GINT64_FORMAT,
-              self->cur_packet_size);
-
-          if (gst_pcap_parse_scan_frame (self, data, self->cur_packet_size,
-                  &payload_data, &payload_size)) {
-            GstBuffer *out_buf;
-            guintptr offset = payload_data - data;
-
-            gst_adapter_unmap (self->adapter);
-            gst_adapter_flush (self->adapter, offset);
-            /* we don't use _take_buffer_fast() on purpose here, we need a
-             * buffer with a single memory, since the RTP depayloaders expect
-             * the complete RTP header to be in the first memory if there are
-             * multiple ones and we can't guarantee that with _fast() */
-            if (payload_size > 0) {
-              out_buf = gst_adapter_take_buffer (self->adapter, payload_size);
-            } else {
-              out_buf = gst_buffer_new ();
-            }
-            gst_adapter_flush (self->adapter,
-                self->cur_packet_size - offset - payload_size);
-
-            if (GST_CLOCK_TIME_IS_VALID (self->cur_ts)) {
-              if (!GST_CLOCK_TIME_IS_VALID (self->base_ts))
-                self->base_ts = self->cur_ts;
-              if (self->offset >= 0) {
-                self->cur_ts -= self->base_ts;
-                self->cur_ts += self->offset;
-              }
-            }
-            GST_BUFFER_TIMESTAMP (out_buf) = self->cur_ts;
-
-
-            if (list == NULL)
-              list = gst_buffer_list_new ();
-            gst_buffer_list_add (list, out_buf);
-          } else {
-            gst_adapter_unmap (self->adapter);
-            gst_adapter_flush (self->adapter, self->cur_packet_size);
-          }
-        }
+    needed = !self->initialized ? 4 : self->pcapng ? 8 : PCAP_RECORD_HEADER_LEN;
+    while (size == 0 && avail >= needed) {
+      data = gst_adapter_map (self->adapter, needed);
+      size = gst_pcap_parse_record_size (self, data, needed, &needed);
+      gst_adapter_unmap (self->adapter);
+    }
 
-        self->cur_packet_size = -1;
-      } else {
-        guint32 ts_sec;
-        guint32 ts_usec;
-        guint32 incl_len;
+    if (size < 0) {
+      ret = GST_FLOW_ERROR;
+      break;
+    }
+    if (size == 0 || avail < (gsize) size)
+      break;
 
-        if (avail < 16)
-          break;
+    data = gst_adapter_map (self->adapter, size);
 
-        data = gst_adapter_map (self->adapter, 16);
+    GST_LOG_OBJECT (self, "examining record size %" G_GSSIZE_FORMAT, size);
 
-        ts_sec = gst_pcap_parse_read_uint32 (self, data + 0);
-        ts_usec = gst_pcap_parse_read_uint32 (self, data + 4);
-        incl_len = gst_pcap_parse_read_uint32 (self, data + 8);
-        /* orig_len = gst_pcap_parse_read_uint32 (self, data + 12); */
+    ret = gst_pcap_parse_record (self, data, size, &packet);
 
-        gst_adapter_unmap (self->adapter);
-        gst_adapter_flush (self->adapter, 16);
+    if (ret == GST_FLOW_OK && packet.data &&
+        gst_pcap_parse_scan_frame (self, packet.linktype, packet.data,
+            packet.size, &info) &&
+        (out_pad = gst_pcap_parse_select_pad (self, &info))) {
+      GstBuffer *out_buf;
+      gsize offset = info.payload - data;
 
-        self->cur_ts =
-            ts_sec * GST_SECOND +
-            ts_usec * (self->nanosecond_timestamp ? 1 : GST_USECOND);
-        self->cur_packet_size = incl_len;
+      gst_adapter_unmap (self->adapter);
+      gst_adapter_flush (self->adapter, offset);
+      /* we don't use _take_buffer_fast() on purpose here, we need a
+       * buffer with a single memory, since the RTP depayloaders expect
+       * the complete RTP header to be in the first memory if there are
+       * multiple ones and we can't guarantee that with _fast() */
+      if (info.payload_size > 0) {
+        out_buf = gst_adapter_take_buffer (self->adapter, info.payload_size);
+      } else {
+        out_buf = gst_buffer_new ();
       }
+      gst_adapter_flush (self->adapter, size - offset - info.payload_size);
+
+      ret = gst_pcap_parse_queue_buffer (self, out_pad, out_buf, packet.ts);
     } else {
-      guint32 magic;
-      guint32 linktype;
-      guint16 major_version;
+      gst_adapter_unmap (self->adapter);
+      gst_adapter_flush (self->adapter, size);
+    }
+  }
 
-      if (avail < 24)
-        break;
+  if (ret == GST_FLOW_OK) {
+    ret = gst_pcap_parse_push_pending (self);
+  } else {
+    push_ret = gst_pcap_parse_push_pending (self);
+    if (push_ret < GST_FLOW_EOS)
+      ret = push_ret;
+  }
 
-      data = gst_adapter_map (self->adapter, 24);
+  return ret;
+}
 
-      magic = *((guint32 *) data);
-      major_version = *((guint16 *) (data + 4));
-      linktype = *((guint32 *) (data + 20));
-      gst_adapter_unmap (self->adapter);
+static gboolean
+gst_pcap_parse_sink_activate (GstPad * sinkpad, GstObject * parent)
+{
+  GstQuery *query;
+  gboolean pull_mode;
+
+  query = gst_query_new_scheduling ();
+
+  if (!gst_pad_peer_query (sinkpad, query)) {
+    gst_query_unref (query);
+    goto activate_push;
+  }
+
+  pull_mode = gst_query_has_scheduling_mode_with_flags (query,
+      GST_PAD_MODE_PULL, GST_SCHEDULING_FLAG_SEEKABLE);
+  gst_query_unref (query);
+
+  if (!pull_mode)
+    goto activate_push;
 
-      if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_NO_SWAP_ENDIAN ||
-          magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN) {
-        self->swap_endian = FALSE;
-        if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN)
-          self->nanosecond_timestamp = TRUE;
-      } else if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN ||
-          magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN) {
-        self->swap_endian = TRUE;
-        if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN)
-          self->nanosecond_timestamp = TRUE;
-        major_version = GUINT16_SWAP_LE_BE (major_version);
-        linktype = GUINT32_SWAP_LE_BE (linktype);
+  GST_DEBUG_OBJECT (sinkpad, "activating pull");
+  return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PULL, TRUE);
+
+activate_push:
+  {
+    GST_DEBUG_OBJECT (sinkpad, "activating push");
+    return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, TRUE);
+  }
+}
+
+static gboolean
+gst_pcap_parse_sink_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (parent);
+
+  switch (mode) {
+    case GST_PAD_MODE_PUSH:
+      self->pull_mode = FALSE;
+      return TRUE;
+    case GST_PAD_MODE_PULL:
+      if (active) {
+        self->pull_mode = TRUE;
+        /* nothing upstream sends a stream-start in pull mode */
+        GST_PCAP_PARSE_PAD (self->src_pad)->need_stream_start = TRUE;
+        self->pull_offset = 0;
+        return gst_pad_start_task (pad, (GstTaskFunction) gst_pcap_parse_loop,
+            pad, NULL);
       } else {
-        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
-            ("File is not a libpcap file, magic is %X", magic));
-        ret = GST_FLOW_ERROR;
-        goto out;
+        return gst_pad_stop_task (pad);
       }
+    default:
+      return FALSE;
+  }
+}
 
-      if (major_version != 2) {
-        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
-            ("File is not a libpcap major version 2, but %u", major_version));
-        ret = GST_FLOW_ERROR;
-        goto out;
-      }
+/* Pulls large chunks and outputs the payloads as sub-buffers sharing the
+ * memory of the chunk, so the capture is only read once and never copied */
+static void
+gst_pcap_parse_loop (GstPad * pad)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (GST_PAD_PARENT (pad));
+  GstFlowReturn ret, push_ret;
+  GstBuffer *chunk = NULL;
+  GstMapInfo map;
+  gsize pos = 0, request;
 
-      if (linktype != LINKTYPE_ETHER && linktype != LINKTYPE_SLL &&
-          linktype != LINKTYPE_RAW) {
-        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
-            ("Only dumps of type Ethernet, raw IP or Linux Cooked (SLL) "
-                "understood; type %d unknown", linktype));
-        ret = GST_FLOW_ERROR;
-        goto out;
+  request = self->pull_size;
+  ret = gst_pad_pull_range (pad, self->pull_offset, request, &chunk);
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  gst_buffer_map (chunk, &map, GST_MAP_READ);
+
+  while (ret == GST_FLOW_OK) {
+    GstPcapParsePacket packet;
+    GstPcapPacketInfo info;
+    GstPcapParsePad *out_pad;
+    gsize avail = map.size - pos, needed = 0;
+    gssize size;
+
+    size = gst_pcap_parse_record_size (self, map.data + pos, avail, &needed);
+    if (size < 0) {
+      ret = GST_FLOW_ERROR;
+      break;
+    }
+
+    if (size == 0 || (gsize) size > avail) {
+      if (pos > 0)
+        break;
+      if (map.size < request) {
+        /* the file ends in the middle of a record */
+        GST_WARNING_OBJECT (self, "Ignoring %" G_GSIZE_FORMAT " trailing "
+            "bytes", map.size);
+        ret = GST_FLOW_EOS;
+      } else {
+        /* a record larger than a chunk, pull it in one go next time */
+        self->pull_size = size;
       }
+      break;
+    }
 
-      GST_DEBUG_OBJECT (self, "linktype %u", linktype);
-      self->linktype = linktype;
+    ret = gst_pcap_parse_record (self, map.data + pos, size, &packet);
 
-      gst_adapter_flush (self->adapter, 24);
-      self->initialized = TRUE;
+    if (ret == GST_FLOW_OK && packet.data &&
+        gst_pcap_parse_scan_frame (self, packet.linktype, packet.data,
+            packet.size, &info) &&
+        (out_pad = gst_pcap_parse_select_pad (self, &info))) {
+      GstBuffer *out_buf;
+
+      if (info.payload_size > 0) {
+        out_buf = gst_buffer_copy_region (chunk, GST_BUFFER_COPY_MEMORY,
+            info.payload - map.data, info.payload_size);
+      } else {
+        out_buf = gst_buffer_new ();
+      }
+
+      ret = gst_pcap_parse_queue_buffer (self, out_pad, out_buf, packet.ts);
     }
+
+    pos += size;
   }
 
-  if (list) {
-    if (!self->newsegment_sent && GST_CLOCK_TIME_IS_VALID (self->cur_ts)) {
-      GstSegment segment;
+  gst_buffer_unmap (chunk, &map);
+  gst_buffer_unref (chunk);
 
-      if (self->caps)
-        gst_pad_set_caps (self->src_pad, self->caps);
-      gst_segment_init (&segment, GST_FORMAT_TIME);
-      segment.start = self->base_ts;
-      gst_pad_push_event (self->src_pad, gst_event_new_segment (&segment));
-      self->newsegment_sent = TRUE;
+  self->pull_offset += pos;
+  if (pos > 0)
+    self->pull_size = PULL_CHUNK_SIZE;
+
+  push_ret = gst_pcap_parse_push_pending (self);
+  if (ret == GST_FLOW_OK || push_ret < GST_FLOW_EOS)
+    ret = push_ret;
+
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  return;
+
+pause:
+  {
+    const gchar *reason = gst_flow_get_name (ret);
+
+    GST_DEBUG_OBJECT (self, "pausing task, reason %s", reason);
+    gst_pad_pause_task (pad);
+
+    if (ret == GST_FLOW_EOS) {
+      gst_pcap_parse_push_eos (self);
+    } else if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS) {
+      GST_ELEMENT_FLOW_ERROR (self, ret);
+      gst_pcap_parse_push_eos (self);
     }
+    return;
+  }
+}
+
+static void
+gst_pcap_parse_push_event (GstPcapParse * self, GstEvent * event)
+{
+  GList *pads, *l;
+
+  pads = gst_pcap_parse_get_src_pads (self);
+  for (l = pads; l; l = l->next)
+    gst_pad_push_event (l->data, gst_event_ref (event));
+  g_list_free_full (pads, gst_object_unref);
+  gst_event_unref (event);
+}
+
+/* There is no index in a capture, so seeking restarts reading from the
+ * beginning of the file and the packets before the new segment are dropped
+ * by gst_pcap_parse_queue_buffer() */
+static gboolean
+gst_pcap_parse_perform_seek (GstPcapParse * self, GstEvent * event)
+{
+  GstSeekFlags flags;
+  GstSeekType start_type, stop_type;
+  GstFormat format;
+  GstSegment segment;
+  gdouble rate;
+  gint64 start, stop;
+  gboolean flush, update;
+  guint32 seqnum;
+
+  gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
+      &stop_type, &stop);
+  seqnum = gst_event_get_seqnum (event);
+
+  /* the same seek comes from the sinks of every source pad */
+  if (seqnum == self->segment_seqnum) {
+    GST_LOG_OBJECT (self, "seek %u already handled", seqnum);
+    return TRUE;
+  }
+
+  if (format != GST_FORMAT_TIME || rate <= 0.0) {
+    GST_DEBUG_OBJECT (self, "only forward seeks in time are supported");
+    return FALSE;
+  }
+
+  flush = ! !(flags & GST_SEEK_FLAG_FLUSH);
+
+  if (flush) {
+    GstEvent *flush_event = gst_event_new_flush_start ();
+
+    gst_event_set_seqnum (flush_event, seqnum);
+    gst_pcap_parse_push_event (self, flush_event);
+  } else {
+    gst_pad_pause_task (self->sink_pad);
+  }
 
-    ret = gst_pad_push_list (self->src_pad, list);
-    list = NULL;
+  GST_PAD_STREAM_LOCK (self->sink_pad);
+
+  segment = self->segment;
+  gst_segment_do_seek (&segment, rate, format, flags, start_type, start,
+      stop_type, stop, &update);
+
+  GST_DEBUG_OBJECT (self, "seeking to %" GST_SEGMENT_FORMAT, &segment);
+
+  if (flush) {
+    GstEvent *flush_event = gst_event_new_flush_stop (TRUE);
+
+    gst_event_set_seqnum (flush_event, seqnum);
+    gst_pcap_parse_push_event (self, flush_event);
   }
 
-out:
+  gst_pcap_parse_reset (self);
+  self->segment = segment;
+  self->segment_seqnum = seqnum;
+
+  gst_pad_start_task (self->sink_pad, (GstTaskFunction) gst_pcap_parse_loop,
+      self->sink_pad, NULL);
 
-  if (list)
-    gst_buffer_list_unref (list);
+  GST_PAD_STREAM_UNLOCK (self->sink_pad);
+
+  return TRUE;
+}
+
+static gboolean
+gst_pcap_parse_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (parent);
+  gboolean ret;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_SEEK:
+      /* in push mode, let upstream handle it */
+      if (!self->pull_mode)
+        return gst_pad_event_default (pad, parent, event);
+      ret = gst_pcap_parse_perform_seek (self, event);
+      gst_event_unref (event);
+      break;
+    default:
+      ret = gst_pad_event_default (pad, parent, event);
+      break;
+  }
 
   return ret;
 }
 
+static gboolean
+gst_pcap_parse_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_SEEKING:{
+      GstFormat format;
+
+      if (!self->pull_mode)
+        break;
+
+      gst_query_parse_seeking (query, &format, NULL, NULL, NULL);
+      gst_query_set_seeking (query, format, format == GST_FORMAT_TIME, 0, -1);
+      return TRUE;
+    }
+    default:
+      break;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
 static gboolean
 gst_pcap_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -655,26 +1641,124 @@ gst_pcap_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_SEGMENT:
+    case GST_EVENT_CAPS:
       /* Drop it, we'll replace it with our own */
       gst_event_unref (event);
       break;
+    case GST_EVENT_STREAM_START:
+      /* the request pads start their own streams */
+      ret = gst_pad_push_event (self->src_pad, event);
+      break;
+    case GST_EVENT_EOS:
+      gst_pcap_parse_push_eos (self);
+      gst_event_unref (event);
+      break;
     case GST_EVENT_FLUSH_STOP:
       gst_pcap_parse_reset (self);
       /* Push event down the pipeline so that other elements stop flushing */
       /* fall through */
     default:
-      ret = gst_pad_push_event (self->src_pad, event);
+      ret = gst_pad_event_default (pad, parent, event);
       break;
   }
 
   return ret;
 }
 
+static GstPad *
+gst_pcap_parse_request_new_pad (GstElement * element, GstPadTemplate * templ,
+    const gchar * name, const GstCaps * caps)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (element);
+  GstPcapParsePad *pad;
+  gchar *pad_name;
+  guint id;
+
+  GST_OBJECT_LOCK (self);
+  if (name && sscanf (name, "src_%u", &id) == 1) {
+    if (id >= self->next_pad_id)
+      self->next_pad_id = id + 1;
+  } else {
+    id = self->next_pad_id++;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  pad_name = g_strdup_printf ("src_%u", id);
+  pad = g_object_new (GST_TYPE_PCAP_PARSE_PAD, "name", pad_name,
+      "direction", GST_PAD_SRC, "template", templ, NULL);
+  g_free (pad_name);
+
+  gst_pad_use_fixed_caps (GST_PAD (pad));
+  pad->need_stream_start = TRUE;
+  if (caps && !gst_caps_is_any (caps))
+    pad->caps = gst_caps_copy (caps);
+
+  GST_PAD_STREAM_LOCK (self->sink_pad);
+  GST_OBJECT_LOCK (self);
+  self->request_pads = g_list_append (self->request_pads, pad);
+  GST_OBJECT_UNLOCK (self);
+  gst_flow_combiner_add_pad (self->flow_combiner, GST_PAD (pad));
+  GST_PAD_STREAM_UNLOCK (self->sink_pad);
+
+  if (!gst_element_add_pad (element, GST_PAD (pad)))
+    goto add_failed;
+
+  gst_child_proxy_child_added (GST_CHILD_PROXY (self), G_OBJECT (pad),
+      GST_OBJECT_NAME (pad));
+
+  return GST_PAD (pad);
+
+add_failed:
+  {
+    GST_WARNING_OBJECT (self, "Failed to add pad %" GST_PTR_FORMAT, pad);
+    GST_PAD_STREAM_LOCK (self->sink_pad);
+    GST_OBJECT_LOCK (self);
+    self->request_pads = g_list_remove (self->request_pads, pad);
+    GST_OBJECT_UNLOCK (self);
+    gst_flow_combiner_remove_pad (self->flow_combiner, GST_PAD (pad));
+    GST_PAD_STREAM_UNLOCK (self->sink_pad);
+    return NULL;
+  }
+}
+
+static void
+gst_pcap_parse_release_pad (GstElement * element, GstPad * pad)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (element);
+
+  GST_PAD_STREAM_LOCK (self->sink_pad);
+  GST_OBJECT_LOCK (self);
+  self->request_pads = g_list_remove (self->request_pads, pad);
+  GST_OBJECT_UNLOCK (self);
+  gst_flow_combiner_remove_pad (self->flow_combiner, pad);
+  GST_PAD_STREAM_UNLOCK (self->sink_pad);
+
+  gst_child_proxy_child_removed (GST_CHILD_PROXY (self), G_OBJECT (pad),
+      GST_OBJECT_NAME (pad));
+
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+}
+
 static GstStateChangeReturn
 gst_pcap_parse_change_state (GstElement * element, GstStateChange transition)
 {
   GstPcapParse *self = GST_PCAP_PARSE (element);
   GstStateChangeReturn ret;
+  GList *l;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_segment_init (&self->segment, GST_FORMAT_TIME);
+      self->segment_seqnum = 0;
+      GST_OBJECT_LOCK (self);
+      for (l = self->request_pads; l; l = l->next)
+        GST_PCAP_PARSE_PAD (l->data)->need_stream_start = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      break;
+  }
 
   ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
 
@@ -689,3 +1773,43 @@ gst_pcap_parse_change_state (GstElement * element, GstStateChange transition)
 
   return ret;
 }
+
+/* GstChildProxy implementation, so that the filters of the request pads can
+ * be set from gst-launch */
+static GObject *
+gst_pcap_parse_child_proxy_get_child_by_index (GstChildProxy * child_proxy,
+    guint index)
+{
+  GstElement *element = GST_ELEMENT (child_proxy);
+  GObject *obj;
+
+  GST_OBJECT_LOCK (element);
+  obj = g_list_nth_data (element->srcpads, index);
+  if (obj)
+    gst_object_ref (obj);
+  GST_OBJECT_UNLOCK (element);
+
+  return obj;
+}
+
+static guint
+gst_pcap_parse_child_proxy_get_children_count (GstChildProxy * child_proxy)
+{
+  GstElement *element = GST_ELEMENT (child_proxy);
+  guint count;
+
+  GST_OBJECT_LOCK (element);
+  count = element->numsrcpads;
+  GST_OBJECT_UNLOCK (element);
+
+  return count;
+}
+
+static void
+gst_pcap_parse_child_proxy_init (gpointer g_iface, gpointer iface_data)
+{
+  GstChildProxyInterface *iface = g_iface;
+
+  iface->get_child_by_index = gst_pcap_parse_child_proxy_get_child_by_index;
+  iface->get_children_count = gst_pcap_parse_child_proxy_get_children_count;
+}
@@ -22,6 +22,9 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
+#include <gst/base/gstflowcombiner.h>
+
+#include "gstpcapfilter.h"
 
 G_BEGIN_DECLS
 
@@ -36,22 +39,64 @@ G_BEGIN_DECLS
 #define GST_IS_PCAP_PARSE_CLASS(klass) \
   (G_TYPE_CHECK_CLASS_TYPE ((klass), GST_TYPE_PCAP_PARSE))
 
+#define GST_TYPE_PCAP_PARSE_PAD (gst_pcap_parse_pad_get_type ())
+#define GST_PCAP_PARSE_PAD(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_PCAP_PARSE_PAD, GstPcapParsePad))
+#define GST_IS_PCAP_PARSE_PAD(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_PCAP_PARSE_PAD))
+
 typedef struct _GstPcapParse      GstPcapParse;
 typedef struct _GstPcapParseClass GstPcapParseClass;
+typedef struct _GstPcapParsePad   GstPcapParsePad;
+typedef struct _GstPcapParsePadClass GstPcapParsePadClass;
 
 typedef enum
 {
-  PCAP_PARSE_STATE_CREATED,
-  PCAP_PARSE_STATE_PARSING,
-} GstPcapParseState;
-
-typedef enum
-{
+  LINKTYPE_NULL = 0,
   LINKTYPE_ETHER  = 1,
   LINKTYPE_RAW = 101,
-  LINKTYPE_SLL = 113
+  LINKTYPE_SLL = 113,
+  LINKTYPE_IPV4 = 228,
+  LINKTYPE_IPV6 = 229
 } GstPcapParseLinktype;
 
+#define GST_PCAP_PARSE_MAX_INTERFACES 64
+
+/* a pcapng interface, the classic pcap format has a single one */
+typedef struct
+{
+  GstPcapParseLinktype linktype;
+  /* timestamps are in units of 1 / ts_rate seconds */
+  guint64 ts_rate;
+} GstPcapParseInterface;
+
+/**
+ * GstPcapParsePad:
+ *
+ * A source pad of a #GstPcapParse, the always "src" pad or a requested
+ * "src_%u" pad.
+ */
+struct _GstPcapParsePad
+{
+  GstPad pad;
+
+  /*< private >*/
+  /* properties, protected by the object lock of the pad */
+  gchar *filter_str;
+  GstPcapFilter *filter;
+  GstCaps *caps;
+
+  /* state, only used from the streaming thread */
+  GstBufferList *pending;
+  gboolean need_stream_start;
+  gboolean newsegment_sent;
+};
+
+struct _GstPcapParsePadClass
+{
+  GstPadClass parent_class;
+};
+
 /**
  * GstPcapParse:
  *
@@ -67,24 +112,36 @@ struct _GstPcapParse
   GstPad * src_pad;
 
   /* properties */
-  gint64 src_ip;
-  gint64 dst_ip;
+  GstPcapAddress src_ip;
+  GstPcapAddress dst_ip;
   gint32 src_port;
   gint32 dst_port;
   GstCaps *caps;
   gint64 offset;
 
+  /* request pads, in the order in which their filters are tried */
+  GList *request_pads;
+  guint next_pad_id;
+  GstFlowCombiner *flow_combiner;
+
   /* state */
   GstAdapter * adapter;
   gboolean initialized;
+  gboolean pcapng;
   gboolean swap_endian;
-  gboolean nanosecond_timestamp;
-  gint64 cur_packet_size;
+  GstPcapParseInterface interfaces[GST_PCAP_PARSE_MAX_INTERFACES];
+  guint n_interfaces;
   GstClockTime cur_ts;
   GstClockTime base_ts;
-  GstPcapParseLinktype linktype;
-
-  gboolean newsegment_sent;
+  /* the segment configured by the last seek, in stream time, that is
+   * relative to the first packet */
+  GstSegment segment;
+  guint32 segment_seqnum;
+
+  /* pull mode */
+  gboolean pull_mode;
+  guint64 pull_offset;
+  gsize pull_size;
 };
 
 struct _GstPcapParseClass
@@ -93,6 +150,7 @@ struct _GstPcapParseClass
 };
 
 GType gst_pcap_parse_get_type (void);
+GType gst_pcap_parse_pad_get_type (void);
 
 G_END_DECLS
 
@@ -33,6 +33,29 @@
  *
  * The scenechange element does not work with compressed video.
  *
+ * With #GstSceneChange:method set to "fast", each frame is first reduced
+ * to a small luma thumbnail of #GstSceneChange:analysis-width pixels and
+ * the decision is taken on the thumbnail, using the sum of absolute
+ * differences and the difference of the luma histograms of consecutive
+ * thumbnails.  Instead of fixed thresholds, the difference is compared
+ * with the mean and standard deviation of the last
+ * #GstSceneChange:window-size differences.  This makes the cost per frame
+ * almost independent of the input resolution.
+ *
+ * For every detected scene change, an element message named
+ * "scene-change" is posted on the bus, with the following fields:
+ *
+ * * #GstClockTime `timestamp`: the timestamp of the first frame of the
+ *   new scene
+ * * #guint64 `frame`: the number of the first frame of the new scene
+ * * #gdouble `score`: the mean absolute luma difference to the previous
+ *   frame
+ * * #gdouble `threshold`: the threshold the score was compared with
+ * * #gdouble `histogram-difference`: the fraction of luma samples that
+ *   changed histogram bin, between 0 and 1 (fast method only)
+ * * #gdouble `confidence`: an estimate between 0 and 1 of how clear the
+ *   scene change is
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 -v filesrc location=some_file.ogv ! decodebin !
@@ -81,6 +104,7 @@
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
 #include <string.h>
+#include <math.h>
 #include "gstscenechange.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_scene_change_debug_category);
@@ -89,6 +113,15 @@ GST_DEBUG_CATEGORY_STATIC (gst_scene_change_debug_category);
 /* prototypes */
 
 
+static void gst_scene_change_set_property (GObject * object,
+    guint property_id, const GValue * value, GParamSpec * pspec);
+static void gst_scene_change_get_property (GObject * object,
+    guint property_id, GValue * value, GParamSpec * pspec);
+static void gst_scene_change_finalize (GObject * object);
+static gboolean gst_scene_change_stop (GstBaseTransform * trans);
+static gboolean gst_scene_change_set_info (GstVideoFilter * filter,
+    GstCaps * incaps, GstVideoInfo * in_info, GstCaps * outcaps,
+    GstVideoInfo * out_info);
 static GstFlowReturn gst_scene_change_transform_frame_ip (GstVideoFilter *
     filter, GstVideoFrame * frame);
 
@@ -99,11 +132,48 @@ static gboolean is_shot_change (int frame_number);
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_METHOD,
+  PROP_ANALYSIS_WIDTH,
+  PROP_WINDOW_SIZE,
+  PROP_SENSITIVITY
 };
 
+#define DEFAULT_METHOD GST_SCENE_CHANGE_METHOD_FULL
+#define DEFAULT_ANALYSIS_WIDTH 64
+#define DEFAULT_WINDOW_SIZE 30
+#define DEFAULT_SENSITIVITY 3.0
+
+/* fast method: the score must be at least SC_MIN_SCORE and at least
+ * 15% of the luma samples must have moved to another histogram bin,
+ * unless the score is as large as the full method's upper limit */
+#define SC_MIN_SCORE 5.0
+#define SC_MIN_HIST_DIFF 0.15
+#define SC_MAX_SCORE 50.0
+/* number of source rows averaged per thumbnail row */
+#define SC_MAX_ROWS 4
+
 #define VIDEO_CAPS \
-    GST_VIDEO_CAPS_MAKE("{ I420, Y42B, Y41B, Y444 }")
+    GST_VIDEO_CAPS_MAKE("{ I420, YV12, Y42B, Y41B, Y444, NV12, NV21, GRAY8 }")
+
+#define GST_TYPE_SCENE_CHANGE_METHOD (gst_scene_change_method_get_type ())
+static GType
+gst_scene_change_method_get_type (void)
+{
+  static GType method_type = 0;
+  static const GEnumValue method_types[] = {
+    {GST_SCENE_CHANGE_METHOD_FULL, "Full resolution difference", "full"},
+    {GST_SCENE_CHANGE_METHOD_FAST,
+        "Downscaled luma thumbnail with adaptive threshold", "fast"},
+    {0, NULL, NULL}
+  };
+
+  if (!method_type) {
+    method_type =
+        g_enum_register_static ("GstSceneChangeMethod", method_types);
+  }
+  return method_type;
+}
 
 /* class initialization */
 
@@ -115,6 +185,9 @@ G_DEFINE_TYPE_WITH_CODE (GstSceneChange, gst_scene_change,
 static void
 gst_scene_change_class_init (GstSceneChangeClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstBaseTransformClass *base_transform_class =
+      GST_BASE_TRANSFORM_CLASS (klass);
   GstVideoFilterClass *video_filter_class = GST_VIDEO_FILTER_CLASS (klass);
 
   gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
@@ -129,14 +202,178 @@ gst_scene_change_class_init (GstSceneChangeClass * klass)
       "Video/Filter", "Detects scene changes in video",
       "David Schleef <ds@entropywave.com>");
 
+  gobject_class->set_property = gst_scene_change_set_property;
+  gobject_class->get_property = gst_scene_change_get_property;
+  gobject_class->finalize = gst_scene_change_finalize;
+  base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_scene_change_stop);
+  video_filter_class->set_info = GST_DEBUG_FUNCPTR (gst_scene_change_set_info);
   video_filter_class->transform_frame_ip =
       GST_DEBUG_FUNCPTR (gst_scene_change_transform_frame_ip);
 
+  g_object_class_install_property (gobject_class, PROP_METHOD,
+      g_param_spec_enum ("method", "Method",
+          "Scene change detection method", GST_TYPE_SCENE_CHANGE_METHOD,
+          DEFAULT_METHOD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_ANALYSIS_WIDTH,
+      g_param_spec_uint ("analysis-width", "Analysis width",
+          "Width of the luma thumbnail analysed by the fast method", 8, 1024,
+          DEFAULT_ANALYSIS_WIDTH, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_WINDOW_SIZE,
+      g_param_spec_uint ("window-size", "Window size",
+          "Number of past frames the fast method's threshold is derived from",
+          2, 1000, DEFAULT_WINDOW_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_SENSITIVITY,
+      g_param_spec_double ("sensitivity", "Sensitivity",
+          "Number of standard deviations above the mean difference that "
+          "the fast method considers a scene change (lower is more sensitive)",
+          0.5, 100.0, DEFAULT_SENSITIVITY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
 gst_scene_change_init (GstSceneChange * scenechange)
 {
+  scenechange->method = DEFAULT_METHOD;
+  scenechange->analysis_width = DEFAULT_ANALYSIS_WIDTH;
+  scenechange->window_size = DEFAULT_WINDOW_SIZE;
+  scenechange->sensitivity = DEFAULT_SENSITIVITY;
+}
+
+static void
+gst_scene_change_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (object);
+
+  GST_OBJECT_LOCK (scenechange);
+  switch (property_id) {
+    case PROP_METHOD:
+      scenechange->method = g_value_get_enum (value);
+      break;
+    case PROP_ANALYSIS_WIDTH:
+      /* takes effect with the next caps */
+      scenechange->analysis_width = g_value_get_uint (value);
+      break;
+    case PROP_WINDOW_SIZE:
+      scenechange->window_size = g_value_get_uint (value);
+      break;
+    case PROP_SENSITIVITY:
+      scenechange->sensitivity = g_value_get_double (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (scenechange);
+}
+
+static void
+gst_scene_change_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (object);
+
+  GST_OBJECT_LOCK (scenechange);
+  switch (property_id) {
+    case PROP_METHOD:
+      g_value_set_enum (value, scenechange->method);
+      break;
+    case PROP_ANALYSIS_WIDTH:
+      g_value_set_uint (value, scenechange->analysis_width);
+      break;
+    case PROP_WINDOW_SIZE:
+      g_value_set_uint (value, scenechange->window_size);
+      break;
+    case PROP_SENSITIVITY:
+      g_value_set_double (value, scenechange->sensitivity);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (scenechange);
+}
+
+static void
+gst_scene_change_reset (GstSceneChange * scenechange)
+{
+  if (scenechange->oldbuf) {
+    gst_buffer_unref (scenechange->oldbuf);
+    scenechange->oldbuf = NULL;
+  }
+  scenechange->n_diffs = 0;
+  scenechange->n_frames = 0;
+  scenechange->have_thumb = FALSE;
+  scenechange->window_len = 0;
+  scenechange->window_pos = 0;
+}
+
+static void
+gst_scene_change_free_analysis (GstSceneChange * scenechange)
+{
+  g_free (scenechange->thumbs[0]);
+  g_free (scenechange->thumbs[1]);
+  g_free (scenechange->colsums);
+  scenechange->thumbs[0] = scenechange->thumbs[1] = NULL;
+  scenechange->colsums = NULL;
+}
+
+static void
+gst_scene_change_finalize (GObject * object)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (object);
+
+  gst_scene_change_reset (scenechange);
+  gst_scene_change_free_analysis (scenechange);
+  g_free (scenechange->window);
+
+  G_OBJECT_CLASS (gst_scene_change_parent_class)->finalize (object);
+}
+
+static gboolean
+gst_scene_change_stop (GstBaseTransform * trans)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (trans);
+
+  GST_DEBUG_OBJECT (scenechange, "stop");
+
+  gst_scene_change_reset (scenechange);
+
+  if (GST_BASE_TRANSFORM_CLASS (gst_scene_change_parent_class)->stop)
+    return
+        GST_BASE_TRANSFORM_CLASS (gst_scene_change_parent_class)->stop (trans);
+  return TRUE;
+}
+
+static gboolean
+gst_scene_change_set_info (GstVideoFilter * filter, GstCaps * incaps,
+    GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (filter);
+  int width = GST_VIDEO_INFO_WIDTH (in_info);
+  int height = GST_VIDEO_INFO_HEIGHT (in_info);
+  int tw, th;
+
+  GST_OBJECT_LOCK (scenechange);
+  tw = MIN (scenechange->analysis_width, width);
+  GST_OBJECT_UNLOCK (scenechange);
+  /* keep the aspect ratio of the picture */
+  th = CLAMP ((height * tw + width / 2) / width, 1, height);
+
+  gst_scene_change_reset (scenechange);
+  gst_scene_change_free_analysis (scenechange);
+
+  scenechange->thumb_width = tw;
+  scenechange->thumb_height = th;
+  scenechange->thumbs[0] = g_malloc (tw * th);
+  scenechange->thumbs[1] = g_malloc (tw * th);
+  scenechange->colsums = g_new (guint32, width);
+
+  GST_DEBUG_OBJECT (scenechange, "analysing %dx%d thumbnails of %dx%d frames",
+      tw, th, width, height);
+
+  return TRUE;
 }
 
 
@@ -164,28 +401,246 @@ get_frame_score (GstVideoFrame * f1, GstVideoFrame * f2)
   return ((double) score) / (width * height);
 }
 
+/* The loops below are kept simple and branch-free over contiguous rows so
+ * that the compiler can vectorize them. */
+static inline void
+accumulate_row (guint32 * sums, const guint8 * s, int width)
+{
+  int i;
+
+  for (i = 0; i < width; i++)
+    sums[i] += s[i];
+}
+
+static inline guint32
+sad_row (const guint8 * s1, const guint8 * s2, int width)
+{
+  guint32 sad = 0;
+  int i;
+
+  for (i = 0; i < width; i++)
+    sad += ABS (s1[i] - s2[i]);
+
+  return sad;
+}
+
+/* box filters the luma plane of @frame into a tw x th thumbnail.  For each
+ * thumbnail row, at most SC_MAX_ROWS evenly spaced source rows are summed
+ * per column, and the column sums are then reduced horizontally. */
+static void
+make_thumbnail (GstSceneChange * scenechange, GstVideoFrame * frame,
+    guint8 * thumb, guint32 * hist)
+{
+  int width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0);
+  int height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0);
+  int stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+  const guint8 *data = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
+  int tw = scenechange->thumb_width;
+  int th = scenechange->thumb_height;
+  guint32 *sums = scenechange->colsums;
+  int tx, ty, i;
+
+  memset (hist, 0, sizeof (guint32) * SC_HIST_BINS);
+
+  for (ty = 0; ty < th; ty++) {
+    int y0 = ty * height / th;
+    int y1 = (ty + 1) * height / th;
+    int n_rows = MIN (y1 - y0, SC_MAX_ROWS);
+    guint8 *out = thumb + ty * tw;
+
+    memset (sums, 0, sizeof (guint32) * width);
+    for (i = 0; i < n_rows; i++) {
+      int y = y0 + (2 * i + 1) * (y1 - y0) / (2 * n_rows);
+
+      accumulate_row (sums, data + y * stride, width);
+    }
+
+    for (tx = 0; tx < tw; tx++) {
+      int x0 = tx * width / tw;
+      int x1 = (tx + 1) * width / tw;
+      int n = (x1 - x0) * n_rows;
+      guint32 sum = 0;
+
+      for (i = x0; i < x1; i++)
+        sum += sums[i];
+
+      out[tx] = (sum + n / 2) / n;
+      hist[out[tx] * SC_HIST_BINS / 256]++;
+    }
+  }
+}
+
+/* returns the mean absolute difference of the thumbnails and stores the
+ * fraction of samples that changed histogram bin in @hist_diff */
+static double
+get_thumbnail_score (GstSceneChange * scenechange, const guint8 * t1,
+    const guint32 * h1, const guint8 * t2, const guint32 * h2,
+    double *hist_diff)
+{
+  int n = scenechange->thumb_width * scenechange->thumb_height;
+  guint32 hsum = 0;
+  int i;
+
+  for (i = 0; i < SC_HIST_BINS; i++)
+    hsum += ABS ((gint32) h1[i] - (gint32) h2[i]);
+  *hist_diff = (double) hsum / (2 * n);
+
+  return (double) sad_row (t1, t2, n) / n;
+}
+
+static void
+window_stats (GstSceneChange * scenechange, double *mean, double *sigma)
+{
+  double sum = 0, sum2 = 0;
+  guint i, n = scenechange->window_len;
+
+  for (i = 0; i < n; i++) {
+    sum += scenechange->window[i];
+    sum2 += scenechange->window[i] * scenechange->window[i];
+  }
+
+  *mean = sum / n;
+  *sigma = sqrt (MAX (sum2 / n - *mean * *mean, 0.0));
+}
+
+static void
+window_push (GstSceneChange * scenechange, guint window_size, double score)
+{
+  if (window_size != scenechange->window_alloc) {
+    g_free (scenechange->window);
+    scenechange->window = g_new (double, window_size);
+    scenechange->window_alloc = window_size;
+    scenechange->window_len = 0;
+    scenechange->window_pos = 0;
+  }
+
+  scenechange->window[scenechange->window_pos] = score;
+  scenechange->window_pos = (scenechange->window_pos + 1) % window_size;
+  scenechange->window_len = MIN (scenechange->window_len + 1, window_size);
+}
+
+static gboolean
+gst_scene_change_fast (GstSceneChange * scenechange, GstVideoFrame * frame,
+    double *score, double *threshold, double *hist_diff, double *confidence)
+{
+  int cur = scenechange->cur_thumb;
+  int prev = cur ^ 1;
+  guint window_size;
+  double sensitivity;
+  double mean, sigma, z;
+  gboolean change = FALSE;
+
+  GST_OBJECT_LOCK (scenechange);
+  window_size = scenechange->window_size;
+  sensitivity = scenechange->sensitivity;
+  GST_OBJECT_UNLOCK (scenechange);
+
+  make_thumbnail (scenechange, frame, scenechange->thumbs[cur],
+      scenechange->hists[cur]);
+  scenechange->cur_thumb = prev;
+
+  if (!scenechange->have_thumb) {
+    scenechange->have_thumb = TRUE;
+    return FALSE;
+  }
+
+  *score = get_thumbnail_score (scenechange, scenechange->thumbs[prev],
+      scenechange->hists[prev], scenechange->thumbs[cur],
+      scenechange->hists[cur], hist_diff);
+
+  if (scenechange->window_len >= 2) {
+    window_stats (scenechange, &mean, &sigma);
+    /* a static picture has no variance at all, don't let the threshold
+     * collapse onto the mean */
+    sigma = MAX (sigma, 1.0);
+    *threshold = MAX (mean + sensitivity * sigma, SC_MIN_SCORE);
+    z = (*score - mean) / sigma;
+
+    change = *score > *threshold &&
+        (*hist_diff >= SC_MIN_HIST_DIFF || *score > SC_MAX_SCORE);
+    if (change) {
+      *confidence = 0.5 * (1.0 - sensitivity / z) +
+          0.5 * MIN (1.0, *hist_diff / (2 * SC_MIN_HIST_DIFF));
+    }
+  } else {
+    *threshold = 0;
+  }
+
+  GST_LOG_OBJECT (scenechange, "score %g threshold %g histogram %g",
+      *score, *threshold, *hist_diff);
+
+  /* only track differences within a scene, a cut would inflate the
+   * threshold for the whole window */
+  if (!change)
+    window_push (scenechange, window_size, *score);
+
+  return change;
+}
+
+static void
+gst_scene_change_post_message (GstSceneChange * scenechange,
+    GstBuffer * buffer, double score, double threshold, double hist_diff,
+    double confidence)
+{
+  GstStructure *s;
+
+  s = gst_structure_new ("scene-change",
+      "timestamp", G_TYPE_UINT64, GST_BUFFER_PTS (buffer),
+      "frame", G_TYPE_UINT64, scenechange->n_frames,
+      "score", G_TYPE_DOUBLE, score,
+      "threshold", G_TYPE_DOUBLE, threshold,
+      "confidence", G_TYPE_DOUBLE, CLAMP (confidence, 0.0, 1.0), NULL);
+  if (hist_diff >= 0)
+    gst_structure_set (s, "histogram-difference", G_TYPE_DOUBLE, hist_diff,
+        NULL);
+
+  gst_element_post_message (GST_ELEMENT (scenechange),
+      gst_message_new_element (GST_OBJECT (scenechange), s));
+}
+
 static GstFlowReturn
 gst_scene_change_transform_frame_ip (GstVideoFilter * filter,
     GstVideoFrame * frame)
 {
   GstSceneChange *scenechange = GST_SCENE_CHANGE (filter);
+  GstSceneChangeMethod method;
   GstVideoFrame oldframe;
   double score_min;
   double score_max;
-  double threshold;
-  double score;
+  double threshold = 0;
+  double score = 0;
+  double hist_diff = -1;
+  double confidence = 0;
   gboolean change;
   gboolean ret;
   int i;
 
   GST_DEBUG_OBJECT (scenechange, "transform_frame_ip");
 
+  GST_OBJECT_LOCK (scenechange);
+  method = scenechange->method;
+  GST_OBJECT_UNLOCK (scenechange);
+
+  if (method == GST_SCENE_CHANGE_METHOD_FAST) {
+    /* the fast method only keeps the thumbnail of the previous frame */
+    if (scenechange->oldbuf) {
+      gst_buffer_unref (scenechange->oldbuf);
+      scenechange->oldbuf = NULL;
+    }
+
+    change = gst_scene_change_fast (scenechange, frame, &score, &threshold,
+        &hist_diff, &confidence);
+    goto done;
+  }
+  scenechange->have_thumb = FALSE;
+
   if (!scenechange->oldbuf) {
     scenechange->n_diffs = 0;
     memset (scenechange->diffs, 0, sizeof (double) * SC_N_DIFFS);
     scenechange->oldbuf = gst_buffer_ref (frame->buffer);
     memcpy (&scenechange->oldinfo, &frame->info, sizeof (GstVideoInfo));
-    return GST_FLOW_OK;
+    change = FALSE;
+    goto done;
   }
 
   ret =
@@ -242,10 +697,18 @@ gst_scene_change_transform_frame_ip (GstVideoFilter * filter,
 #endif
 
   if (change) {
-    GstEvent *event;
-
     GST_INFO_OBJECT (scenechange, "%d %g %g %g %d",
         scenechange->n_diffs, score / threshold, score, threshold, change);
+    /* ratios above 2.5 are always taken as a change */
+    confidence = (score / threshold - 1.0) / 1.5;
+  }
+
+done:
+  if (change) {
+    GstEvent *event;
+
+    gst_scene_change_post_message (scenechange, frame->buffer, score,
+        threshold, hist_diff, confidence);
 
     event =
         gst_video_event_new_downstream_force_key_unit (GST_BUFFER_PTS
@@ -255,6 +718,8 @@ gst_scene_change_transform_frame_ip (GstVideoFilter * filter,
     gst_pad_push_event (GST_BASE_TRANSFORM_SRC_PAD (scenechange), event);
   }
 
+  scenechange->n_frames++;
+
   return GST_FLOW_OK;
 }
 
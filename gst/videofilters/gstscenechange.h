@@ -35,6 +35,13 @@ typedef struct _GstSceneChange GstSceneChange;
 typedef struct _GstSceneChangeClass GstSceneChangeClass;
 
 #define SC_N_DIFFS 5
+#define SC_HIST_BINS 64
+
+typedef enum
+{
+  GST_SCENE_CHANGE_METHOD_FULL,
+  GST_SCENE_CHANGE_METHOD_FAST
+} GstSceneChangeMethod;
 
 struct _GstSceneChange
 {
@@ -45,6 +52,28 @@ struct _GstSceneChange
   GstBuffer *oldbuf;
   GstVideoInfo oldinfo;
   int count;
+  guint64 n_frames;
+
+  /* fast method: luma thumbnails of the current and previous frame */
+  int thumb_width;
+  int thumb_height;
+  guint8 *thumbs[2];
+  guint32 hists[2][SC_HIST_BINS];
+  int cur_thumb;
+  gboolean have_thumb;
+  guint32 *colsums;
+
+  /* sliding window of recent scores for the adaptive threshold */
+  double *window;
+  guint window_alloc;
+  guint window_len;
+  guint window_pos;
+
+  /* properties */
+  GstSceneChangeMethod method;
+  guint analysis_width;
+  guint window_size;
+  double sensitivity;
 };
 
 struct _GstSceneChangeClass
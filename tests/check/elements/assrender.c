@@ -174,6 +174,35 @@ src_buffer_probe_cb (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
   return GST_PAD_PROBE_OK;
 }
 
+/* the subtitle is shown on the frames at 40 and 80 ms, and only rendered
+ * again if libass reports a change */
+static void
+check_stats (GstElement * assrender)
+{
+  GstStructure *stats;
+  guint64 rendered, overlaid, render_cost, last_cost, average_cost;
+  guint pixels;
+
+  g_object_get (assrender, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_get (stats,
+          "rendered", G_TYPE_UINT64, &rendered,
+          "render-cost", G_TYPE_UINT64, &render_cost,
+          "overlaid", G_TYPE_UINT64, &overlaid,
+          "last-cost", G_TYPE_UINT64, &last_cost,
+          "average-cost", G_TYPE_UINT64, &average_cost,
+          "pixels", G_TYPE_UINT, &pixels, NULL));
+  gst_structure_free (stats);
+
+  fail_unless (rendered >= 1 && rendered <= 2);
+  fail_unless (render_cost > 0);
+  fail_unless_equals_int (overlaid, 2);
+  fail_unless (average_cost > 0);
+  fail_unless (last_cost > 0);
+  /* the composition is released on the frames without text */
+  fail_unless_equals_int (pixels, 0);
+}
+
 #define CREATE_BASIC_TEST(format) \
 GST_START_TEST (test_assrender_basic_##format) \
 { \
@@ -268,6 +297,7 @@ GST_START_TEST (test_assrender_basic_##format) \
   gst_element_set_state (pipeline, GST_STATE_NULL); \
   \
   fail_unless_equals_int (sink_pos, 5); \
+  check_stats (assrender); \
   \
   g_object_unref (pipeline); \
   g_main_loop_unref (loop); \
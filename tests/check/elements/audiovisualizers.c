@@ -0,0 +1,248 @@
+/* GStreamer
+ *
+ * unit test for the audiovisualizers scopes
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/audio/audio.h>
+
+#define RATE 44100
+#define WIDTH 64
+#define HEIGHT 32
+#define FPS 30
+/* audio frames per video frame */
+#define SPF (RATE / FPS)
+
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+#define RGB_ORDER "xRGB"
+#else
+#define RGB_ORDER "BGRx"
+#endif
+
+static GstHarness *
+setup_scope (const gchar * name, guint render_interval)
+{
+  GstHarness *h;
+  gchar *desc;
+
+  desc = g_strdup_printf ("%s shader=none render-interval=%u", name,
+      render_interval);
+  h = gst_harness_new_parse (desc);
+  g_free (desc);
+
+  gst_harness_set_caps_str (h, "audio/x-raw,format=" GST_AUDIO_NE (S16)
+      ",layout=interleaved,channels=2,channel-mask=(bitmask)0x3,"
+      "rate=" G_STRINGIFY (RATE),
+      "video/x-raw,format=" RGB_ORDER ",width=" G_STRINGIFY (WIDTH)
+      ",height=" G_STRINGIFY (HEIGHT) ",framerate=" G_STRINGIFY (FPS) "/1");
+
+  return h;
+}
+
+/* one video frame worth of a stereo sine at @freq, the right channel is a
+ * quarter period late */
+static GstBuffer *
+make_sine (guint n, gdouble freq, gdouble amplitude)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint16 *data;
+  guint i;
+
+  buf = gst_buffer_new_allocate (NULL, SPF * 2 * sizeof (gint16), NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  data = (gint16 *) map.data;
+  for (i = 0; i < SPF; i++) {
+    gdouble t = 2.0 * G_PI * freq * (n * SPF + i) / RATE;
+
+    data[2 * i] = amplitude * 32767.0 * sin (t);
+    data[2 * i + 1] = amplitude * 32767.0 * cos (t);
+  }
+  gst_buffer_unmap (buf, &map);
+
+  GST_BUFFER_PTS (buf) = gst_util_uint64_scale_int (n * SPF, GST_SECOND, RATE);
+  GST_BUFFER_DURATION (buf) = gst_util_uint64_scale_int (SPF, GST_SECOND,
+      RATE);
+
+  return buf;
+}
+
+/* pushes @n_frames video frames of audio and returns the drawn frames */
+static GList *
+run_scope (GstHarness * h, guint n_frames, const gdouble * freqs,
+    const gdouble * amplitudes)
+{
+  GList *frames = NULL;
+  GstBuffer *buf;
+  guint n;
+
+  for (n = 0; n < n_frames; n++) {
+    fail_unless_equals_int (gst_harness_push (h, make_sine (n, freqs[n],
+                amplitudes[n])), GST_FLOW_OK);
+    while ((buf = gst_harness_try_pull (h)))
+      frames = g_list_append (frames, buf);
+  }
+
+  return frames;
+}
+
+static gboolean
+frames_equal (GstBuffer * a, GstBuffer * b)
+{
+  GstMapInfo amap, bmap;
+  gboolean ret;
+
+  gst_buffer_map (a, &amap, GST_MAP_READ);
+  gst_buffer_map (b, &bmap, GST_MAP_READ);
+  ret = amap.size == bmap.size && memcmp (amap.data, bmap.data,
+      amap.size) == 0;
+  gst_buffer_unmap (a, &amap);
+  gst_buffer_unmap (b, &bmap);
+
+  return ret;
+}
+
+/* the bars of spectrascope follow the spectrum computed by the shared
+ * analysis, column x shows the FFT bin x + 1 of the 2 * WIDTH points */
+GST_START_TEST (test_spectrum_analysis)
+{
+  const guint bin = 20;
+  const gdouble freq = bin * (gdouble) RATE / (2 * WIDTH);
+  gdouble freqs[4], amplitudes[4];
+  guint top[WIDTH];
+  GstHarness *h;
+  GstBuffer *buf;
+  GstMapInfo map;
+  GList *frames;
+  guint i, x, y, peak;
+
+  for (i = 0; i < G_N_ELEMENTS (freqs); i++) {
+    freqs[i] = freq;
+    amplitudes[i] = 0.01;
+  }
+
+  h = setup_scope ("spectrascope", 1);
+  frames = run_scope (h, G_N_ELEMENTS (freqs), freqs, amplitudes);
+  fail_unless (frames != NULL);
+
+  /* the top of the bar in each column */
+  buf = g_list_last (frames)->data;
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, WIDTH * HEIGHT * 4);
+  peak = 0;
+  for (x = 0; x < WIDTH; x++) {
+    const guint32 *p = (const guint32 *) map.data;
+
+    for (y = 0; y < HEIGHT && p[y * WIDTH + x] == 0; y++);
+    top[x] = y;
+    if (top[x] < top[peak])
+      peak = x;
+  }
+  gst_buffer_unmap (buf, &map);
+
+  fail_unless (ABS ((gint) peak - (gint) (bin - 1)) <= 1,
+      "tallest bar in column %u instead of %u", peak, bin - 1);
+  fail_unless (top[peak] < HEIGHT - 1);
+  for (x = 0; x < WIDTH; x++) {
+    if (ABS ((gint) x - (gint) (bin - 1)) > 3)
+      fail_unless (HEIGHT - top[x] <= (HEIGHT - top[peak]) / 2,
+          "column %u: bar of %u, peak %u", x, HEIGHT - top[x],
+          HEIGHT - top[peak]);
+  }
+
+  g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static void
+check_render_interval (const gchar * name)
+{
+  gdouble freqs[12], amplitudes[12];
+  GstHarness *h;
+  GList *frames, *l;
+  guint i, n;
+
+  /* every video frame gets a different sine */
+  for (i = 0; i < G_N_ELEMENTS (freqs); i++) {
+    freqs[i] = (4 + 3 * i) * (gdouble) RATE / (2 * WIDTH);
+    amplitudes[i] = 0.1 + 0.07 * i;
+  }
+
+  h = setup_scope (name, 2);
+  frames = run_scope (h, G_N_ELEMENTS (freqs), freqs, amplitudes);
+  n = g_list_length (frames);
+  fail_unless (n >= 6, "%s: only %u frames", name, n);
+
+  /* frames 2i and 2i + 1 are the same, the next pair is drawn anew */
+  for (i = 0, l = frames; l && l->next; i += 2, l = l->next->next) {
+    fail_unless (frames_equal (l->data, l->next->data),
+        "%s: frame %u not repeated", name, i);
+    if (l->next->next)
+      fail_if (frames_equal (l->data, l->next->next->data),
+          "%s: frame %u not drawn", name, i + 2);
+  }
+
+  g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+  gst_harness_teardown (h);
+
+  /* without the interval every frame is drawn */
+  h = setup_scope (name, 1);
+  frames = run_scope (h, G_N_ELEMENTS (freqs), freqs, amplitudes);
+  for (i = 0, l = frames; l && l->next; i++, l = l->next)
+    fail_if (frames_equal (l->data, l->next->data),
+        "%s: frame %u repeated", name, i + 1);
+
+  g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_render_interval)
+{
+  static const gchar *scopes[] = { "spacescope", "spectrascope",
+    "synaescope", "wavescope"
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (scopes); i++)
+    check_render_interval (scopes[i]);
+}
+
+GST_END_TEST;
+
+static Suite *
+audiovisualizers_suite (void)
+{
+  Suite *s = suite_create ("audiovisualizers");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_spectrum_analysis);
+  tcase_add_test (tc_chain, test_render_interval);
+
+  return s;
+}
+
+GST_CHECK_MAIN (audiovisualizers);
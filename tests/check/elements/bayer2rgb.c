@@ -0,0 +1,315 @@
+/* GStreamer
+ *
+ * unit test for bayer2rgb
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define WIDTH 64
+#define HEIGHT 48
+
+/* the flat colour of the test frames, on 8 bits */
+#define RED 200
+#define GREEN 100
+#define BLUE 50
+
+static const gchar *methods[] = { "bilinear", "malvar" };
+
+/* a frame of @format (bggr, rggb12le, ...) filled with the flat colour,
+ * scaled to the bit depth, or with pseudo random samples if @noise */
+static GstBuffer *
+make_bayer_frame (const gchar * format, gboolean noise)
+{
+  gboolean rggb = g_str_has_prefix (format, "rggb");
+  gint depth = strlen (format) > 4 ? atoi (format + 4) : 8;
+  gint bpp = depth > 8 ? 2 : 1;
+  gint stride = GST_ROUND_UP_4 (WIDTH) * bpp;
+  guint32 seed = 1;
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint x, y;
+
+  buf = gst_buffer_new_allocate (NULL, stride * HEIGHT, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      guint value;
+
+      if (noise) {
+        seed = seed * 1103515245 + 12345;
+        value = (seed >> 16) & ((1 << depth) - 1);
+      } else {
+        /* class of the sample in the bggr pattern: 0 B, 1 and 2 G, 3 R */
+        gint c = ((y & 1) << 1) | (x & 1);
+
+        if (rggb)
+          c = 3 - c;
+        value = c == 0 ? BLUE : c == 3 ? RED : GREEN;
+        value <<= depth - 8;
+      }
+
+      if (bpp == 2)
+        GST_WRITE_UINT16_LE (map.data + y * stride + 2 * x, value);
+      else
+        map.data[y * stride + x] = value;
+    }
+  }
+
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+/* converts a frame and returns the output buffer */
+static GstBuffer *
+run_bayer2rgb (const gchar * method, guint n_threads, const gchar * format,
+    const gchar * out_format, GstBuffer * in)
+{
+  GstHarness *h;
+  GstBuffer *out;
+  gchar *desc, *in_caps, *out_caps;
+
+  desc = g_strdup_printf ("bayer2rgb method=%s n-threads=%u", method,
+      n_threads);
+  h = gst_harness_new_parse (desc);
+  g_free (desc);
+
+  in_caps = g_strdup_printf ("video/x-bayer,format=%s,width=%d,height=%d,"
+      "framerate=30/1", format, WIDTH, HEIGHT);
+  out_caps = g_strdup_printf ("video/x-raw,format=%s,width=%d,height=%d,"
+      "framerate=30/1%s", out_format, WIDTH, HEIGHT,
+      g_str_equal (out_format, "I420") || g_str_equal (out_format, "NV12") ?
+      ",colorimetry=bt601" : "");
+  gst_harness_set_caps_str (h, in_caps, out_caps);
+  g_free (in_caps);
+  g_free (out_caps);
+
+  out = gst_harness_push_and_pull (h, in);
+  fail_unless (out != NULL);
+  gst_harness_teardown (h);
+
+  return out;
+}
+
+static void
+map_frame (GstVideoFrame * frame, const gchar * out_format, GstBuffer * buf)
+{
+  GstVideoInfo info;
+
+  gst_video_info_set_format (&info, gst_video_format_from_string (out_format),
+      WIDTH, HEIGHT);
+  fail_unless (gst_video_frame_map (frame, &info, buf, GST_MAP_READ));
+}
+
+static void
+check_flat_rgb (const gchar * method, const gchar * format)
+{
+  GstVideoFrame frame;
+  GstBuffer *out;
+  gint x, y;
+
+  out = run_bayer2rgb (method, 1, format, "RGBx",
+      make_bayer_frame (format, FALSE));
+  map_frame (&frame, "RGBx", out);
+
+  for (y = 0; y < HEIGHT; y++) {
+    const guint8 *p = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0);
+
+    for (x = 0; x < WIDTH; x++, p += 4) {
+      fail_unless (p[0] == RED && p[1] == GREEN && p[2] == BLUE,
+          "%s %s at %d,%d: %u %u %u", method, format, x, y, p[0], p[1], p[2]);
+    }
+  }
+
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unref (out);
+}
+
+/* a flat colour is interpolated exactly by both methods, from any bit depth
+ * and pattern */
+GST_START_TEST (test_flat_rgb)
+{
+  static const gchar *formats[] = { "bggr", "rggb", "bggr10le", "rggb10le",
+    "bggr12le", "rggb12le", "bggr16le"
+  };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (methods); i++) {
+    for (j = 0; j < G_N_ELEMENTS (formats); j++)
+      check_flat_rgb (methods[i], formats[j]);
+  }
+}
+
+GST_END_TEST;
+
+/* the samples are scaled to 16 bits by replicating their top bits */
+GST_START_TEST (test_flat_argb64)
+{
+  GstVideoFrame frame;
+  GstBuffer *out;
+  guint16 r = RED << 2, g = GREEN << 2, b = BLUE << 2;
+  gint x, y;
+
+  out = run_bayer2rgb ("malvar", 1, "bggr10le", "ARGB64",
+      make_bayer_frame ("bggr10le", FALSE));
+  map_frame (&frame, "ARGB64", out);
+
+  for (y = 0; y < HEIGHT; y++) {
+    const guint16 *p = (guint16 *) ((guint8 *)
+        GST_VIDEO_FRAME_PLANE_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0));
+
+    for (x = 0; x < WIDTH; x++, p += 4) {
+      fail_unless_equals_int (p[0], 0xffff);
+      fail_unless_equals_int (p[1], (r << 6) | (r >> 4));
+      fail_unless_equals_int (p[2], (g << 6) | (g >> 4));
+      fail_unless_equals_int (p[3], (b << 6) | (b >> 4));
+    }
+  }
+
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unref (out);
+}
+
+GST_END_TEST;
+
+static void
+check_flat_yuv (const gchar * method, const gchar * format,
+    const gchar * out_format)
+{
+  GstVideoFrame frame;
+  GstBuffer *out;
+  gdouble luma;
+  gint y_ref, u_ref, v_ref;
+  gint x, y;
+
+  /* BT.601 in limited range */
+  luma = 0.299 * RED + 0.587 * GREEN + 0.114 * BLUE;
+  y_ref = 16 + luma * 219.0 / 255.0 + 0.5;
+  u_ref = 128 + (BLUE - luma) / 1.772 * 224.0 / 255.0 + 0.5;
+  v_ref = 128 + (RED - luma) / 1.402 * 224.0 / 255.0 + 0.5;
+
+  out = run_bayer2rgb (method, 1, format, out_format,
+      make_bayer_frame (format, FALSE));
+  map_frame (&frame, out_format, out);
+
+  for (y = 0; y < HEIGHT; y++) {
+    const guint8 *p = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+
+    for (x = 0; x < WIDTH; x++)
+      fail_unless (ABS (p[x] - y_ref) <= 1, "%s %s Y at %d,%d: %u != %d",
+          method, out_format, x, y, p[x], y_ref);
+  }
+
+  for (y = 0; y < HEIGHT / 2; y++) {
+    const guint8 *u = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&frame, 1) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1);
+    const guint8 *v = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&frame, 2) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 2);
+    gint u_pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, 1);
+    gint v_pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, 2);
+
+    for (x = 0; x < WIDTH / 2; x++) {
+      fail_unless (ABS (u[x * u_pstride] - u_ref) <= 1,
+          "%s %s U at %d,%d: %u != %d", method, out_format, x, y,
+          u[x * u_pstride], u_ref);
+      fail_unless (ABS (v[x * v_pstride] - v_ref) <= 1,
+          "%s %s V at %d,%d: %u != %d", method, out_format, x, y,
+          v[x * v_pstride], v_ref);
+    }
+  }
+
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unref (out);
+}
+
+GST_START_TEST (test_flat_yuv)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (methods); i++) {
+    check_flat_yuv (methods[i], "bggr", "I420");
+    check_flat_yuv (methods[i], "rggb10le", "I420");
+    check_flat_yuv (methods[i], "bggr12le", "NV12");
+  }
+}
+
+GST_END_TEST;
+
+/* the bands processed by each thread must join without seams */
+GST_START_TEST (test_threads)
+{
+  static const gchar *formats[] = { "bggr", "rggb12le" };
+  static const gchar *out_formats[] = { "BGRx", "I420", "ARGB64" };
+  guint i, j, k;
+
+  for (i = 0; i < G_N_ELEMENTS (methods); i++) {
+    for (j = 0; j < G_N_ELEMENTS (formats); j++) {
+      for (k = 0; k < G_N_ELEMENTS (out_formats); k++) {
+        GstBuffer *in, *out1, *out4;
+        GstMapInfo map1, map4;
+
+        in = make_bayer_frame (formats[j], TRUE);
+        out1 = run_bayer2rgb (methods[i], 1, formats[j], out_formats[k],
+            gst_buffer_ref (in));
+        out4 = run_bayer2rgb (methods[i], 4, formats[j], out_formats[k], in);
+
+        gst_buffer_map (out1, &map1, GST_MAP_READ);
+        gst_buffer_map (out4, &map4, GST_MAP_READ);
+        fail_unless_equals_int (map1.size, map4.size);
+        fail_unless (memcmp (map1.data, map4.data, map1.size) == 0,
+            "%s %s to %s differs with 4 threads", methods[i], formats[j],
+            out_formats[k]);
+        gst_buffer_unmap (out1, &map1);
+        gst_buffer_unmap (out4, &map4);
+
+        gst_buffer_unref (out1);
+        gst_buffer_unref (out4);
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+bayer2rgb_suite (void)
+{
+  Suite *s = suite_create ("bayer2rgb");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_flat_rgb);
+  tcase_add_test (tc_chain, test_flat_argb64);
+  tcase_add_test (tc_chain, test_flat_yuv);
+  tcase_add_test (tc_chain, test_threads);
+
+  return s;
+}
+
+GST_CHECK_MAIN (bayer2rgb);
@@ -0,0 +1,235 @@
+/* GStreamer
+ *
+ * unit test for checksumsink
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define N_BUFFERS 200
+
+/* pushes @buffers through a checksumsink writing to a temporary file and
+ * returns the content of the file */
+static gchar *
+run_checksumsink (const gchar * props, const gchar * caps,
+    GstBuffer ** buffers, gint n_buffers)
+{
+  GstHarness *h;
+  gchar *desc, *location, *contents;
+  gint fd, i;
+
+  fd = g_file_open_tmp ("checksumsink-XXXXXX", &location, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+
+  desc = g_strdup_printf ("checksumsink location=%s %s", location, props);
+  h = gst_harness_new_parse (desc);
+  g_free (desc);
+  gst_harness_set_src_caps_str (h, caps);
+
+  for (i = 0; i < n_buffers; i++)
+    fail_unless_equals_int (gst_harness_push (h, buffers[i]), GST_FLOW_OK);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  gst_harness_teardown (h);
+
+  fail_unless (g_file_get_contents (location, &contents, NULL, NULL));
+  g_unlink (location);
+  g_free (location);
+
+  return contents;
+}
+
+static GstBuffer *
+make_data_buffer (const gchar * data, GstClockTime pts)
+{
+  GstBuffer *buf;
+
+  buf = gst_buffer_new_wrapped (g_strdup (data), strlen (data));
+  GST_BUFFER_PTS (buf) = pts;
+
+  return buf;
+}
+
+GST_START_TEST (test_known_digests)
+{
+  GstBuffer *buffers[2];
+  gchar *out;
+
+  buffers[0] = make_data_buffer ("abc", 0);
+  buffers[1] = make_data_buffer ("123456789", GST_SECOND);
+  out = run_checksumsink ("hash=xxh64", "application/x-test", buffers, 2);
+  fail_unless_equals_string (out, "0:00:00.000000000 44bc2cf5ad770999\n"
+      "0:00:01.000000000 8cb841db40e6ae83\n");
+  g_free (out);
+
+  buffers[0] = make_data_buffer ("abc", 0);
+  buffers[1] = make_data_buffer ("123456789", GST_SECOND);
+  out = run_checksumsink ("hash=crc32c", "application/x-test", buffers, 2);
+  fail_unless_equals_string (out, "0:00:00.000000000 364b3fb7\n"
+      "0:00:01.000000000 e3069283\n");
+  g_free (out);
+
+  buffers[0] = make_data_buffer ("abc", 0);
+  out = run_checksumsink ("hash=md5", "application/x-test", buffers, 1);
+  fail_unless_equals_string (out,
+      "0:00:00.000000000 900150983cd24fb0d6963f7d28e17f72\n");
+  g_free (out);
+}
+
+GST_END_TEST;
+
+static void
+make_random_buffers (GstBuffer ** buffers, gint n, guint32 seed)
+{
+  GRand *rand = g_rand_new_with_seed (seed);
+  gint i, j;
+
+  for (i = 0; i < n; i++) {
+    gsize size = g_rand_int_range (rand, 1, 100000);
+    guint8 *data = g_malloc (size);
+
+    for (j = 0; j < size; j++)
+      data[j] = g_rand_int (rand);
+    buffers[i] = gst_buffer_new_wrapped (data, size);
+    GST_BUFFER_PTS (buffers[i]) = i * GST_MSECOND;
+  }
+
+  g_rand_free (rand);
+}
+
+GST_START_TEST (test_threads_ordered)
+{
+  const gchar *hashes[] = { "sha1", "xxh64", "crc32c" };
+  GstBuffer *buffers[N_BUFFERS];
+  gchar *props, *serial, *threaded;
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (hashes); i++) {
+    props = g_strdup_printf ("hash=%s n-threads=1", hashes[i]);
+    make_random_buffers (buffers, N_BUFFERS, 42);
+    serial = run_checksumsink (props, "application/x-test", buffers,
+        N_BUFFERS);
+    g_free (props);
+
+    props = g_strdup_printf ("hash=%s n-threads=4", hashes[i]);
+    make_random_buffers (buffers, N_BUFFERS, 42);
+    threaded = run_checksumsink (props, "application/x-test", buffers,
+        N_BUFFERS);
+    g_free (props);
+
+    fail_unless_equals_int (strlen (serial) > 0, TRUE);
+    fail_unless_equals_string (serial, threaded);
+    g_free (serial);
+    g_free (threaded);
+  }
+}
+
+GST_END_TEST;
+
+/* an I420 frame with the given luma stride, padding filled with garbage */
+static GstBuffer *
+make_i420_frame (gint width, gint height, gint stride)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gsize offset[3];
+  gint strides[3];
+  gint x, y, p;
+
+  strides[0] = stride;
+  strides[1] = strides[2] = stride / 2;
+  offset[0] = 0;
+  offset[1] = stride * height;
+  offset[2] = offset[1] + strides[1] * height / 2;
+
+  buf = gst_buffer_new_allocate (NULL, offset[2] + strides[2] * height / 2,
+      NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, stride & 0xff, map.size);
+  for (p = 0; p < 3; p++) {
+    gint w = p ? width / 2 : width;
+    gint h = p ? height / 2 : height;
+
+    for (y = 0; y < h; y++)
+      for (x = 0; x < w; x++)
+        map.data[offset[p] + y * strides[p] + x] = x + y * 3 + p * 50;
+  }
+  gst_buffer_unmap (buf, &map);
+
+  gst_buffer_add_video_meta_full (buf, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_FORMAT_I420, width, height, 3, offset, strides);
+
+  return buf;
+}
+
+GST_START_TEST (test_plane_checksums)
+{
+  const gchar *caps = "video/x-raw,format=I420,width=64,height=48,"
+      "framerate=30/1";
+  GstBuffer *buffer;
+  gchar *tight, *padded, **fields;
+
+  buffer = make_i420_frame (64, 48, 64);
+  tight = run_checksumsink ("hash=xxh64 plane-checksums=true", caps,
+      &buffer, 1);
+  buffer = make_i420_frame (64, 48, 128);
+  padded = run_checksumsink ("hash=xxh64 plane-checksums=true", caps,
+      &buffer, 1);
+
+  /* timestamp and one checksum per plane */
+  fields = g_strsplit (g_strstrip (tight), " ", -1);
+  fail_unless_equals_int (g_strv_length (fields), 4);
+  g_strfreev (fields);
+
+  fail_unless_equals_string (tight, g_strstrip (padded));
+  g_free (tight);
+  g_free (padded);
+
+  /* without plane checksums, the padding changes the checksum */
+  buffer = make_i420_frame (64, 48, 64);
+  tight = run_checksumsink ("hash=xxh64", caps, &buffer, 1);
+  buffer = make_i420_frame (64, 48, 128);
+  padded = run_checksumsink ("hash=xxh64", caps, &buffer, 1);
+  fail_if (strcmp (tight, padded) == 0);
+  g_free (tight);
+  g_free (padded);
+}
+
+GST_END_TEST;
+
+static Suite *
+checksumsink_suite (void)
+{
+  Suite *s = suite_create ("checksumsink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_known_digests);
+  tcase_add_test (tc_chain, test_threads_ordered);
+  tcase_add_test (tc_chain, test_plane_checksums);
+
+  return s;
+}
+
+GST_CHECK_MAIN (checksumsink);
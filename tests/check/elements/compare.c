@@ -0,0 +1,195 @@
+/* GStreamer
+ *
+ * unit test for compare
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+
+#include <gst/check/gstcheck.h>
+
+#define N_FRAMES 10
+
+/* runs the pipeline to EOS and collects the score of every frame */
+static gint
+run_compare (const gchar * method, const gchar * caps, const gchar * pattern1,
+    const gchar * pattern2, gint n_threads, gdouble * scores,
+    GstClockTime * elapsed)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start;
+  gchar *desc;
+  gint n_scores = 0;
+  gboolean done = FALSE;
+
+  desc = g_strdup_printf ("videotestsrc pattern=%s num-buffers=%d ! %s ! "
+      "compare name=c method=%s n-threads=%d ! fakesink "
+      "videotestsrc pattern=%s num-buffers=%d ! %s ! c.check",
+      pattern1, N_FRAMES, caps, method, n_threads, pattern2, N_FRAMES, caps);
+  pipeline = gst_parse_launch (desc, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (desc);
+
+  bus = gst_element_get_bus (pipeline);
+  start = gst_util_get_timestamp ();
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  while (!done) {
+    msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR | GST_MESSAGE_ELEMENT);
+
+    switch (GST_MESSAGE_TYPE (msg)) {
+      case GST_MESSAGE_ELEMENT:{
+        const GstStructure *s = gst_message_get_structure (msg);
+
+        if (scores && gst_structure_has_name (s, "score")) {
+          fail_unless (n_scores < N_FRAMES);
+          fail_unless (gst_structure_get_double (s, "score",
+                  &scores[n_scores]));
+          fail_unless (gst_structure_has_field (s, "component-scores"));
+          n_scores++;
+        }
+        break;
+      }
+      case GST_MESSAGE_ERROR:
+        fail ("unexpected error message");
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+    gst_message_unref (msg);
+  }
+
+  if (elapsed)
+    *elapsed = gst_util_get_timestamp () - start;
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return n_scores;
+}
+
+GST_START_TEST (test_psnr_identical)
+{
+  gdouble scores[N_FRAMES];
+  gint i, n;
+
+  n = run_compare ("psnr", "video/x-raw,format=I420,width=320,height=240",
+      "smpte", "smpte", 0, scores, NULL);
+  fail_unless_equals_int (n, N_FRAMES);
+  for (i = 0; i < n; i++)
+    fail_unless_equals_float (scores[i], 100.0);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ssim_fast_identical)
+{
+  const gchar *formats[] = { "I420", "NV12", "AYUV", "I420_10LE", "GRAY16_LE" };
+  gdouble scores[N_FRAMES];
+  gchar *caps;
+  gint i, j, n;
+
+  for (j = 0; j < G_N_ELEMENTS (formats); j++) {
+    caps = g_strdup_printf ("video/x-raw,format=%s,width=320,height=240",
+        formats[j]);
+    n = run_compare ("ssim-fast", caps, "ball", "ball", 0, scores, NULL);
+    fail_unless_equals_int (n, N_FRAMES);
+    for (i = 0; i < n; i++)
+      fail_unless (fabs (scores[i] - 1.0) < 1e-9, "%s: ssim %f", formats[j],
+          scores[i]);
+
+    n = run_compare ("ms-ssim", caps, "ball", "ball", 0, scores, NULL);
+    fail_unless_equals_int (n, N_FRAMES);
+    for (i = 0; i < n; i++)
+      fail_unless (fabs (scores[i] - 1.0) < 1e-9, "%s: ms-ssim %f",
+          formats[j], scores[i]);
+    g_free (caps);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ssim_fast_different)
+{
+  gdouble scores[N_FRAMES], scores_mt[N_FRAMES], psnr[N_FRAMES];
+  gint i, n;
+
+  n = run_compare ("ssim-fast", "video/x-raw,format=I420,width=320,height=240",
+      "smpte", "ball", 1, scores, NULL);
+  fail_unless_equals_int (n, N_FRAMES);
+  n = run_compare ("ssim-fast", "video/x-raw,format=I420,width=320,height=240",
+      "smpte", "ball", 4, scores_mt, NULL);
+  fail_unless_equals_int (n, N_FRAMES);
+  n = run_compare ("psnr", "video/x-raw,format=I420,width=320,height=240",
+      "smpte", "ball", 0, psnr, NULL);
+  fail_unless_equals_int (n, N_FRAMES);
+
+  for (i = 0; i < n; i++) {
+    fail_unless (scores[i] < 0.5);
+    fail_unless (psnr[i] < 20.0);
+    /* splitting in slices must not change the result */
+    fail_unless (fabs (scores[i] - scores_mt[i]) < 1e-9);
+  }
+}
+
+GST_END_TEST;
+
+/* compares the time taken by the plain ssim method and ssim-fast on 1080p */
+GST_START_TEST (test_ssim_benchmark)
+{
+  const gchar *caps = "video/x-raw,format=I420,width=1920,height=1080";
+  GstClockTime base, plain, fast, fast_mt;
+
+  run_compare ("mem", caps, "ball", "ball", 0, NULL, &base);
+  run_compare ("ssim", caps, "ball", "ball", 0, NULL, &plain);
+  run_compare ("ssim-fast", caps, "ball", "ball", 1, NULL, &fast);
+  run_compare ("ssim-fast", caps, "ball", "ball", 0, NULL, &fast_mt);
+
+  GST_INFO ("%d frames: pipeline %" GST_TIME_FORMAT ", ssim +%"
+      GST_TIME_FORMAT ", ssim-fast +%" GST_TIME_FORMAT ", threaded +%"
+      GST_TIME_FORMAT, N_FRAMES, GST_TIME_ARGS (base),
+      GST_TIME_ARGS (plain - MIN (plain, base)),
+      GST_TIME_ARGS (fast - MIN (fast, base)),
+      GST_TIME_ARGS (fast_mt - MIN (fast_mt, base)));
+}
+
+GST_END_TEST;
+
+static Suite *
+compare_suite (void)
+{
+  Suite *s = suite_create ("compare");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_psnr_identical);
+  tcase_add_test (tc_chain, test_ssim_fast_identical);
+  tcase_add_test (tc_chain, test_ssim_fast_different);
+  tcase_add_test (tc_chain, test_ssim_benchmark);
+
+  return s;
+}
+
+GST_CHECK_MAIN (compare);
@@ -0,0 +1,281 @@
+/* GStreamer
+ *
+ * unit test for curlhttpsrc
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <gio/gio.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+/* the chunk size of curlhttpsrc */
+#define CHUNK_SIZE (64 * 1024)
+
+/* A minimal HTTP/1.1 server on the loopback interface that answers every
+ * request with a body of @body_size bytes of a known pattern */
+typedef struct
+{
+  GSocket *socket;
+  GCancellable *cancellable;
+  GThread *thread;
+  guint16 port;
+  gsize body_size;
+} TestServer;
+
+static guint8
+body_byte (gsize offset)
+{
+  return offset % 251;
+}
+
+static gboolean
+read_request (TestServer * server, GSocket * conn)
+{
+  GString *request = g_string_new (NULL);
+  gchar buf[1024];
+  gssize len;
+  gboolean ret = FALSE;
+
+  while (!strstr (request->str, "\r\n\r\n")) {
+    len = g_socket_receive (conn, buf, sizeof (buf), server->cancellable,
+        NULL);
+    if (len <= 0)
+      goto done;
+    g_string_append_len (request, buf, len);
+  }
+  ret = TRUE;
+
+done:
+  g_string_free (request, TRUE);
+  return ret;
+}
+
+static gboolean
+send_all (TestServer * server, GSocket * conn, const guint8 * data, gsize len)
+{
+  gssize sent;
+
+  while (len > 0) {
+    sent = g_socket_send (conn, (const gchar *) data, len, server->cancellable,
+        NULL);
+    if (sent <= 0)
+      return FALSE;
+    data += sent;
+    len -= sent;
+  }
+  return TRUE;
+}
+
+static gpointer
+server_thread (gpointer user_data)
+{
+  TestServer *server = user_data;
+  GSocket *conn;
+  guint8 *body;
+  gchar *header;
+  gsize i;
+
+  body = g_malloc (server->body_size);
+  for (i = 0; i < server->body_size; i++)
+    body[i] = body_byte (i);
+  header = g_strdup_printf ("HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/octet-stream\r\n"
+      "Content-Length: %" G_GSIZE_FORMAT "\r\n\r\n", server->body_size);
+
+  while ((conn = g_socket_accept (server->socket, server->cancellable, NULL))) {
+    while (read_request (server, conn)) {
+      if (!send_all (server, conn, (const guint8 *) header, strlen (header)) ||
+          !send_all (server, conn, body, server->body_size))
+        break;
+    }
+    g_socket_close (conn, NULL);
+    g_object_unref (conn);
+  }
+
+  g_free (header);
+  g_free (body);
+  return NULL;
+}
+
+static TestServer *
+test_server_new (gsize body_size)
+{
+  TestServer *server = g_new0 (TestServer, 1);
+  GInetAddress *loopback;
+  GSocketAddress *addr;
+
+  server->body_size = body_size;
+  server->cancellable = g_cancellable_new ();
+  server->socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+      G_SOCKET_PROTOCOL_TCP, NULL);
+  fail_unless (server->socket != NULL);
+
+  loopback = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (loopback, 0);
+  fail_unless (g_socket_bind (server->socket, addr, TRUE, NULL));
+  fail_unless (g_socket_listen (server->socket, NULL));
+  g_object_unref (addr);
+  g_object_unref (loopback);
+
+  addr = g_socket_get_local_address (server->socket, NULL);
+  server->port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr));
+  g_object_unref (addr);
+
+  server->thread = g_thread_new ("http-server", server_thread, server);
+
+  return server;
+}
+
+static void
+test_server_free (TestServer * server)
+{
+  g_cancellable_cancel (server->cancellable);
+  g_thread_join (server->thread);
+  g_socket_close (server->socket, NULL);
+  g_object_unref (server->socket);
+  g_object_unref (server->cancellable);
+  g_free (server);
+}
+
+static GstHarness *
+setup_curlhttpsrc (TestServer * server)
+{
+  GstHarness *h;
+  gchar *uri;
+
+  h = gst_harness_new_with_padnames ("curlhttpsrc", NULL, "src");
+  uri = g_strdup_printf ("http://127.0.0.1:%u/file", server->port);
+  g_object_set (h->element, "location", uri, NULL);
+  g_free (uri);
+
+  return h;
+}
+
+/* Pulls the whole body and checks its content and the buffer sizes */
+static void
+pull_body (GstHarness * h, gsize body_size)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gsize offset = 0, i;
+
+  while (offset < body_size) {
+    buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    fail_unless (map.size > 0 && map.size <= CHUNK_SIZE);
+    fail_unless (offset + map.size <= body_size);
+    for (i = 0; i < map.size; i++) {
+      if (map.data[i] != body_byte (offset + i))
+        fail ("wrong byte at offset %" G_GSIZE_FORMAT, offset + i);
+    }
+    offset += map.size;
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+  }
+}
+
+static void
+get_stats (GstHarness * h, guint64 * hwm, guint64 * pauses)
+{
+  GstStructure *stats;
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "queued-bytes-hwm", hwm));
+  fail_unless (gst_structure_get_uint64 (stats, "pauses", pauses));
+  gst_structure_free (stats);
+}
+
+GST_START_TEST (test_download)
+{
+  TestServer *server;
+  GstHarness *h;
+  guint64 hwm, pauses;
+
+  server = test_server_new (1024 * 1024 + 123);
+  h = setup_curlhttpsrc (server);
+
+  gst_harness_play (h);
+  pull_body (h, server->body_size);
+
+  get_stats (h, &hwm, &pauses);
+  fail_unless (hwm > 0);
+
+  gst_harness_teardown (h);
+  test_server_free (server);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_backpressure)
+{
+  TestServer *server;
+  GstHarness *h;
+  guint64 hwm, pauses;
+  const guint64 max_queued = 256 * 1024;
+
+  server = test_server_new (16 * 1024 * 1024);
+  h = setup_curlhttpsrc (server);
+  g_object_set (h->element, "max-queued-bytes", max_queued, NULL);
+
+  /* downstream only takes a buffer when it is pulled */
+  gst_harness_set_blocking_push_mode (h);
+  gst_harness_play (h);
+
+  /* let the transfer run into the limit */
+  g_usleep (G_USEC_PER_SEC / 2);
+  get_stats (h, &hwm, &pauses);
+  fail_unless (pauses > 0);
+  /* the last curl write before the pause may go past the limit */
+  fail_unless (hwm <= max_queued + CHUNK_SIZE, "%" G_GUINT64_FORMAT, hwm);
+
+  /* the transfer is resumed as the data is taken */
+  pull_body (h, server->body_size);
+  get_stats (h, &hwm, &pauses);
+  fail_unless (hwm <= max_queued + CHUNK_SIZE, "%" G_GUINT64_FORMAT, hwm);
+  GST_INFO ("queue high-water mark %" G_GUINT64_FORMAT " bytes, %"
+      G_GUINT64_FORMAT " pauses", hwm, pauses);
+
+  gst_harness_teardown (h);
+  test_server_free (server);
+}
+
+GST_END_TEST;
+
+static Suite *
+curlhttpsrc_suite (void)
+{
+  Suite *s = suite_create ("curlhttpsrc");
+  TCase *tc_chain = tcase_create ("general");
+
+  /* the server is local */
+  g_unsetenv ("http_proxy");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_download);
+  tcase_add_test (tc_chain, test_backpressure);
+
+  return s;
+}
+
+GST_CHECK_MAIN (curlhttpsrc);
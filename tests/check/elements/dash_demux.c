@@ -18,7 +18,13 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <string.h>
+
+#include <gio/gio.h>
 #include <gst/check/gstcheck.h>
+#include <gst/check/gsttestclock.h>
+#include <glib/gstdio.h>
+#include <gst/base/gstbytewriter.h>
 #include "adaptive_demux_common.h"
 
 #define DEMUX_ELEMENT_NAME "dashdemux"
@@ -545,6 +551,261 @@ GST_START_TEST (testParameters)
 
 GST_END_TEST;
 
+static gchar *index_cache_directory;
+static guint index_cache_requests;
+
+static gboolean
+gst_dashdemux_http_src_start_count (GstTestHTTPSrc * src,
+    const gchar * uri, GstTestHTTPSrcInput * input_data, gpointer user_data)
+{
+  index_cache_requests++;
+  return gst_dashdemux_http_src_start (src, uri, input_data, user_data);
+}
+
+static void
+remove_index_cache_directory (void)
+{
+  const gchar *name;
+  GDir *dir;
+
+  dir = g_dir_open (index_cache_directory, 0, NULL);
+  fail_unless (dir != NULL);
+  while ((name = g_dir_read_name (dir)) != NULL) {
+    gchar *path = g_build_filename (index_cache_directory, name, NULL);
+    g_unlink (path);
+    g_free (path);
+  }
+  g_dir_close (dir);
+  g_rmdir (index_cache_directory);
+  g_free (index_cache_directory);
+  index_cache_directory = NULL;
+}
+
+static void
+setIndexCacheDirectory (GstAdaptiveDemuxTestEngine * engine,
+    gpointer user_data)
+{
+  g_object_set (engine->demux, "index-cache-directory", index_cache_directory,
+      NULL);
+}
+
+/*
+ * Test that the header and index are read from the index cache when the
+ * same manifest is played again
+ *
+ */
+GST_START_TEST (testIndexCache)
+{
+  const gchar *mpd =
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+      "     xmlns=\"urn:mpeg:DASH:schema:MPD:2011\""
+      "     xsi:schemaLocation=\"urn:mpeg:DASH:schema:MPD:2011 DASH-MPD.xsd\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-on-demand:2011\""
+      "     type=\"static\""
+      "     minBufferTime=\"PT1.500S\""
+      "     mediaPresentationDuration=\"PT135.743S\">"
+      "  <Period>"
+      "    <AdaptationSet mimeType=\"audio/webm\""
+      "                   subsegmentAlignment=\"true\">"
+      "      <Representation id=\"171\""
+      "                      codecs=\"vorbis\""
+      "                      audioSamplingRate=\"44100\""
+      "                      startWithSAP=\"1\""
+      "                      bandwidth=\"129553\">"
+      "        <AudioChannelConfiguration"
+      "           schemeIdUri=\"urn:mpeg:dash:23003:3:audio_channel_configuration:2011\""
+      "           value=\"2\" />"
+      "        <BaseURL>audio.webm</BaseURL>"
+      "        <SegmentBase indexRange=\"4452-4686\""
+      "                     indexRangeExact=\"true\">"
+      "          <Initialization range=\"0-4451\" />"
+      "        </SegmentBase>"
+      "      </Representation></AdaptationSet></Period></MPD>";
+
+  GstDashDemuxTestInputData inputTestData[] = {
+    {"http://unit.test/test.mpd", (guint8 *) mpd, 0},
+    {"http://unit.test/audio.webm", NULL, 5000},
+    {NULL, NULL, 0},
+  };
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"audio_00", 5000, NULL},
+  };
+  GstTestHTTPSrcCallbacks http_src_callbacks = { 0 };
+  GstTestHTTPSrcTestData http_src_test_data = { 0 };
+  GstAdaptiveDemuxTestCallbacks test_callbacks = { 0 };
+  GstDashDemuxTestCase *testData;
+  guint first_requests;
+
+  index_cache_directory = g_dir_make_tmp ("dash_demux-XXXXXX", NULL);
+  fail_unless (index_cache_directory != NULL);
+
+  http_src_callbacks.src_start = gst_dashdemux_http_src_start_count;
+  http_src_callbacks.src_create = gst_dashdemux_http_src_create;
+  http_src_test_data.input = inputTestData;
+  gst_test_http_src_install_callbacks (&http_src_callbacks,
+      &http_src_test_data);
+
+  test_callbacks.pre_test = setIndexCacheDirectory;
+  test_callbacks.appsink_received_data =
+      gst_adaptive_demux_test_check_received_data;
+  test_callbacks.appsink_eos =
+      gst_adaptive_demux_test_check_size_of_received_data;
+
+  /* the first run downloads the header and the index and caches them */
+  index_cache_requests = 0;
+  testData = gst_dash_demux_test_case_new ();
+  COPY_OUTPUT_TEST_DATA (outputTestData, testData);
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME, "http://unit.test/test.mpd",
+      &test_callbacks, testData);
+  g_object_unref (testData);
+  first_requests = index_cache_requests;
+
+  /* the second one outputs the same data without requesting them */
+  index_cache_requests = 0;
+  testData = gst_dash_demux_test_case_new ();
+  COPY_OUTPUT_TEST_DATA (outputTestData, testData);
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME, "http://unit.test/test.mpd",
+      &test_callbacks, testData);
+  g_object_unref (testData);
+  fail_unless_equals_int (index_cache_requests, first_requests - 2);
+
+  if (http_src_test_data.data)
+    gst_structure_free (http_src_test_data.data);
+
+  remove_index_cache_directory ();
+}
+
+GST_END_TEST;
+
+static const gchar *revalidation_etag;
+static guint revalidation_not_modified;
+
+/* the header and index are cached with an ETag, and must be revalidated each
+ * time they are used */
+static gboolean
+gst_dashdemux_http_src_start_revalidate (GstTestHTTPSrc * src,
+    const gchar * uri, GstTestHTTPSrcInput * input_data, gpointer user_data)
+{
+  const gchar *if_none_match = NULL;
+
+  if (!gst_dashdemux_http_src_start_count (src, uri, input_data, user_data))
+    return FALSE;
+  if (!g_str_has_suffix (uri, ".webm"))
+    return TRUE;
+
+  input_data->response_headers =
+      gst_structure_new (TEST_HTTP_SRC_RESPONSE_HEADERS_NAME,
+      "ETag", G_TYPE_STRING, revalidation_etag,
+      "Cache-Control", G_TYPE_STRING, "no-cache", NULL);
+  if (input_data->request_headers)
+    if_none_match = gst_structure_get_string (input_data->request_headers,
+        "If-None-Match");
+  if (g_strcmp0 (if_none_match, revalidation_etag) == 0) {
+    input_data->status_code = 304;
+    revalidation_not_modified++;
+  }
+
+  return TRUE;
+}
+
+/*
+ * Test that the expired entries of the index cache are revalidated with a
+ * conditional request, and replaced when they changed
+ *
+ */
+GST_START_TEST (testIndexCacheRevalidation)
+{
+  const gchar *mpd =
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+      "     xmlns=\"urn:mpeg:DASH:schema:MPD:2011\""
+      "     xsi:schemaLocation=\"urn:mpeg:DASH:schema:MPD:2011 DASH-MPD.xsd\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-on-demand:2011\""
+      "     type=\"static\""
+      "     minBufferTime=\"PT1.500S\""
+      "     mediaPresentationDuration=\"PT135.743S\">"
+      "  <Period>"
+      "    <AdaptationSet mimeType=\"audio/webm\""
+      "                   subsegmentAlignment=\"true\">"
+      "      <Representation id=\"171\""
+      "                      codecs=\"vorbis\""
+      "                      audioSamplingRate=\"44100\""
+      "                      startWithSAP=\"1\""
+      "                      bandwidth=\"129553\">"
+      "        <AudioChannelConfiguration"
+      "           schemeIdUri=\"urn:mpeg:dash:23003:3:audio_channel_configuration:2011\""
+      "           value=\"2\" />"
+      "        <BaseURL>audio.webm</BaseURL>"
+      "        <SegmentBase indexRange=\"4452-4686\""
+      "                     indexRangeExact=\"true\">"
+      "          <Initialization range=\"0-4451\" />"
+      "        </SegmentBase>"
+      "      </Representation></AdaptationSet></Period></MPD>";
+
+  GstDashDemuxTestInputData inputTestData[] = {
+    {"http://unit.test/test.mpd", (guint8 *) mpd, 0},
+    {"http://unit.test/audio.webm", NULL, 5000},
+    {NULL, NULL, 0},
+  };
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"audio_00", 5000, NULL},
+  };
+  GstTestHTTPSrcCallbacks http_src_callbacks = { 0 };
+  GstTestHTTPSrcTestData http_src_test_data = { 0 };
+  GstAdaptiveDemuxTestCallbacks test_callbacks = { 0 };
+  GstDashDemuxTestCase *testData;
+  guint first_requests, run;
+
+  index_cache_directory = g_dir_make_tmp ("dash_demux-XXXXXX", NULL);
+  fail_unless (index_cache_directory != NULL);
+
+  http_src_callbacks.src_start = gst_dashdemux_http_src_start_revalidate;
+  http_src_callbacks.src_create = gst_dashdemux_http_src_create;
+  http_src_test_data.input = inputTestData;
+  gst_test_http_src_install_callbacks (&http_src_callbacks,
+      &http_src_test_data);
+
+  test_callbacks.pre_test = setIndexCacheDirectory;
+  test_callbacks.appsink_received_data =
+      gst_adaptive_demux_test_check_received_data;
+  test_callbacks.appsink_eos =
+      gst_adaptive_demux_test_check_size_of_received_data;
+
+  revalidation_etag = "\"v1\"";
+  revalidation_not_modified = 0;
+  first_requests = 0;
+
+  /* the first run caches the header and the index, the second one
+   * revalidates them. The third one gets them again as they changed, and
+   * the fourth one revalidates the new ones */
+  for (run = 0; run < 4; run++) {
+    if (run == 2)
+      revalidation_etag = "\"v2\"";
+
+    index_cache_requests = 0;
+    testData = gst_dash_demux_test_case_new ();
+    COPY_OUTPUT_TEST_DATA (outputTestData, testData);
+    gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME,
+        "http://unit.test/test.mpd", &test_callbacks, testData);
+    g_object_unref (testData);
+
+    /* the requests are still made, but not answered with the data */
+    if (run == 0)
+      first_requests = index_cache_requests;
+    fail_unless_equals_int (index_cache_requests, first_requests);
+    fail_unless_equals_int (revalidation_not_modified, run < 2 ? 2 * run :
+        2 * (run - 1));
+  }
+
+  if (http_src_test_data.data)
+    gst_structure_free (http_src_test_data.data);
+
+  remove_index_cache_directory ();
+}
+
+GST_END_TEST;
+
 /*
  * Test seeking
  *
@@ -1516,6 +1777,1361 @@ GST_START_TEST (testContentProtection)
 
 GST_END_TEST;
 
+/* fragmented MP4 writing for testElementaryStreams */
+
+#define ES_N_SEGMENTS 4
+#define ES_N_MOOFS 2
+#define ES_N_SAMPLES 5
+/* in the 1000 Hz track timescale */
+#define ES_SAMPLE_DURATION 100
+#define ES_SAMPLE_FLAGS_SYNC 0x02000000
+#define ES_SAMPLE_FLAGS_NON_SYNC 0x01010000
+
+static const guint8 es_avcc[2][19] = {
+  {0x01, 0x42, 0xc0, 0x0d, 0xff, 0xe1, 0x00, 0x04, 0x67, 0x42, 0xc0, 0x0d,
+      0x01, 0x00, 0x04, 0x68, 0xce, 0x3c, 0x80},
+  {0x01, 0x42, 0xc0, 0x1e, 0xff, 0xe1, 0x00, 0x04, 0x67, 0x42, 0xc0, 0x1e,
+      0x01, 0x00, 0x04, 0x68, 0xce, 0x3c, 0x80},
+};
+
+static const guint16 es_width[2] = { 320, 640 };
+static const guint16 es_height[2] = { 240, 480 };
+
+/* starts a box and returns its position, to be given to es_box_end() */
+static guint
+es_box_start (GstByteWriter * bw, const gchar * type)
+{
+  guint pos = gst_byte_writer_get_pos (bw);
+
+  gst_byte_writer_put_uint32_be (bw, 0);
+  gst_byte_writer_put_data (bw, (const guint8 *) type, 4);
+
+  return pos;
+}
+
+static guint32
+es_box_end (GstByteWriter * bw, guint start)
+{
+  guint end = gst_byte_writer_get_pos (bw);
+
+  gst_byte_writer_set_pos (bw, start);
+  gst_byte_writer_put_uint32_be (bw, end - start);
+  gst_byte_writer_set_pos (bw, end);
+
+  return end - start;
+}
+
+/* version and flags of a full box */
+static void
+es_full_box_header (GstByteWriter * bw, guint8 version, guint32 flags)
+{
+  gst_byte_writer_put_uint8 (bw, version);
+  gst_byte_writer_put_uint24_be (bw, flags);
+}
+
+/* the init segment of representation @rep, one H.264 track with id 1 */
+static guint8 *
+es_make_init_segment (guint rep, guint64 * size)
+{
+  GstByteWriter bw;
+  guint moov, trak, mdia, minf, stbl, stsd, avc1, mvex, box;
+
+  gst_byte_writer_init (&bw);
+
+  box = es_box_start (&bw, "ftyp");
+  gst_byte_writer_put_data (&bw, (const guint8 *) "iso6", 4);
+  gst_byte_writer_put_uint32_be (&bw, 0);
+  gst_byte_writer_put_data (&bw, (const guint8 *) "iso6dash", 8);
+  es_box_end (&bw, box);
+
+  moov = es_box_start (&bw, "moov");
+
+  box = es_box_start (&bw, "mvhd");
+  es_full_box_header (&bw, 0, 0);
+  gst_byte_writer_fill (&bw, 0, 8);
+  gst_byte_writer_put_uint32_be (&bw, 1000);
+  gst_byte_writer_fill (&bw, 0, 84);
+  es_box_end (&bw, box);
+
+  trak = es_box_start (&bw, "trak");
+  box = es_box_start (&bw, "tkhd");
+  es_full_box_header (&bw, 0, 3);
+  gst_byte_writer_fill (&bw, 0, 8);
+  gst_byte_writer_put_uint32_be (&bw, 1);
+  gst_byte_writer_fill (&bw, 0, 60);
+  gst_byte_writer_put_uint32_be (&bw, es_width[rep] << 16);
+  gst_byte_writer_put_uint32_be (&bw, es_height[rep] << 16);
+  es_box_end (&bw, box);
+
+  mdia = es_box_start (&bw, "mdia");
+  box = es_box_start (&bw, "mdhd");
+  es_full_box_header (&bw, 0, 0);
+  gst_byte_writer_fill (&bw, 0, 8);
+  gst_byte_writer_put_uint32_be (&bw, 1000);
+  gst_byte_writer_put_uint32_be (&bw, 0);
+  gst_byte_writer_put_uint16_be (&bw, 0x55c4);
+  gst_byte_writer_put_uint16_be (&bw, 0);
+  es_box_end (&bw, box);
+
+  box = es_box_start (&bw, "hdlr");
+  es_full_box_header (&bw, 0, 0);
+  gst_byte_writer_put_uint32_be (&bw, 0);
+  gst_byte_writer_put_data (&bw, (const guint8 *) "vide", 4);
+  gst_byte_writer_fill (&bw, 0, 13);
+  es_box_end (&bw, box);
+
+  minf = es_box_start (&bw, "minf");
+  stbl = es_box_start (&bw, "stbl");
+  stsd = es_box_start (&bw, "stsd");
+  es_full_box_header (&bw, 0, 0);
+  gst_byte_writer_put_uint32_be (&bw, 1);
+  avc1 = es_box_start (&bw, "avc1");
+  gst_byte_writer_fill (&bw, 0, 6);
+  gst_byte_writer_put_uint16_be (&bw, 1);
+  gst_byte_writer_fill (&bw, 0, 16);
+  gst_byte_writer_put_uint16_be (&bw, es_width[rep]);
+  gst_byte_writer_put_uint16_be (&bw, es_height[rep]);
+  gst_byte_writer_put_uint32_be (&bw, 0x00480000);
+  gst_byte_writer_put_uint32_be (&bw, 0x00480000);
+  gst_byte_writer_put_uint32_be (&bw, 0);
+  gst_byte_writer_put_uint16_be (&bw, 1);
+  gst_byte_writer_fill (&bw, 0, 32);
+  gst_byte_writer_put_uint16_be (&bw, 0x18);
+  gst_byte_writer_put_uint16_be (&bw, 0xffff);
+  box = es_box_start (&bw, "avcC");
+  gst_byte_writer_put_data (&bw, es_avcc[rep], sizeof (es_avcc[rep]));
+  es_box_end (&bw, box);
+  es_box_end (&bw, avc1);
+  es_box_end (&bw, stsd);
+  es_box_end (&bw, stbl);
+  es_box_end (&bw, minf);
+  es_box_end (&bw, mdia);
+  es_box_end (&bw, trak);
+
+  mvex = es_box_start (&bw, "mvex");
+  box = es_box_start (&bw, "trex");
+  es_full_box_header (&bw, 0, 0);
+  gst_byte_writer_put_uint32_be (&bw, 1);
+  gst_byte_writer_put_uint32_be (&bw, 1);
+  gst_byte_writer_fill (&bw, 0, 12);
+  es_box_end (&bw, box);
+  es_box_end (&bw, mvex);
+
+  es_box_end (&bw, moov);
+
+  *size = gst_byte_writer_get_pos (&bw);
+  return gst_byte_writer_reset_and_get_data (&bw);
+}
+
+/* the size of the sample @sample of a moof */
+#define ES_SAMPLE_SIZE(sample) (8 + (sample))
+
+/* the decode time of a sample, in milliseconds */
+#define ES_SAMPLE_TIME(segment, moof, sample) \
+  ((((segment) - 1) * ES_N_MOOFS + (moof)) * ES_N_SAMPLES * \
+   ES_SAMPLE_DURATION + (sample) * ES_SAMPLE_DURATION)
+
+/* media segment @segment (starting at 1) of representation @rep, with
+ * ES_N_MOOFS moof/mdat pairs. The first bytes of each sample tell where it
+ * comes from */
+static guint8 *
+es_make_media_segment (guint rep, guint segment, guint64 * size)
+{
+  GstByteWriter bw;
+  guint moof, traf, mdat, box, data_offset_pos, end;
+  guint32 moof_size;
+  guint m, i;
+
+  gst_byte_writer_init (&bw);
+
+  box = es_box_start (&bw, "styp");
+  gst_byte_writer_put_data (&bw, (const guint8 *) "msdh", 4);
+  gst_byte_writer_put_uint32_be (&bw, 0);
+  gst_byte_writer_put_data (&bw, (const guint8 *) "msdhmsix", 8);
+  es_box_end (&bw, box);
+
+  for (m = 0; m < ES_N_MOOFS; m++) {
+    moof = es_box_start (&bw, "moof");
+
+    box = es_box_start (&bw, "mfhd");
+    es_full_box_header (&bw, 0, 0);
+    gst_byte_writer_put_uint32_be (&bw, (segment - 1) * ES_N_MOOFS + m + 1);
+    es_box_end (&bw, box);
+
+    traf = es_box_start (&bw, "traf");
+    /* default-base-is-moof */
+    box = es_box_start (&bw, "tfhd");
+    es_full_box_header (&bw, 0, 0x020000);
+    gst_byte_writer_put_uint32_be (&bw, 1);
+    es_box_end (&bw, box);
+
+    box = es_box_start (&bw, "tfdt");
+    es_full_box_header (&bw, 1, 0);
+    gst_byte_writer_put_uint64_be (&bw, ES_SAMPLE_TIME (segment, m, 0));
+    es_box_end (&bw, box);
+
+    /* data offset, sample durations, sizes and flags */
+    box = es_box_start (&bw, "trun");
+    es_full_box_header (&bw, 0, 0x000701);
+    gst_byte_writer_put_uint32_be (&bw, ES_N_SAMPLES);
+    data_offset_pos = gst_byte_writer_get_pos (&bw);
+    gst_byte_writer_put_uint32_be (&bw, 0);
+    for (i = 0; i < ES_N_SAMPLES; i++) {
+      gst_byte_writer_put_uint32_be (&bw, ES_SAMPLE_DURATION);
+      gst_byte_writer_put_uint32_be (&bw, ES_SAMPLE_SIZE (i));
+      gst_byte_writer_put_uint32_be (&bw,
+          i == 0 ? ES_SAMPLE_FLAGS_SYNC : ES_SAMPLE_FLAGS_NON_SYNC);
+    }
+    es_box_end (&bw, box);
+    es_box_end (&bw, traf);
+    moof_size = es_box_end (&bw, moof);
+
+    /* the samples follow the mdat header */
+    end = gst_byte_writer_get_pos (&bw);
+    gst_byte_writer_set_pos (&bw, data_offset_pos);
+    gst_byte_writer_put_uint32_be (&bw, moof_size + 8);
+    gst_byte_writer_set_pos (&bw, end);
+
+    mdat = es_box_start (&bw, "mdat");
+    for (i = 0; i < ES_N_SAMPLES; i++) {
+      gst_byte_writer_put_uint8 (&bw, rep);
+      gst_byte_writer_put_uint8 (&bw, segment);
+      gst_byte_writer_put_uint8 (&bw, m);
+      gst_byte_writer_put_uint8 (&bw, i);
+      gst_byte_writer_fill (&bw, 0xab, ES_SAMPLE_SIZE (i) - 4);
+    }
+    es_box_end (&bw, mdat);
+  }
+
+  *size = gst_byte_writer_get_pos (&bw);
+  return gst_byte_writer_reset_and_get_data (&bw);
+}
+
+static GstCaps *es_caps;
+static guint es_next_sample;
+static guint es_caps_changes;
+static gint es_last_rep;
+
+static void
+setElementaryStreams (GstAdaptiveDemuxTestEngine * engine, gpointer user_data)
+{
+  /* the first segment comes from the lowest representation, the bitrate
+   * selection after it switches to the highest */
+  g_object_set (engine->demux, "elementary-streams", TRUE,
+      "connection-speed", 1000, NULL);
+}
+
+static void
+testElementaryStreamsEvent (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, GstEvent * event,
+    gpointer user_data)
+{
+  GstCaps *caps;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_CAPS)
+    return;
+
+  /* the caps of the container may come first, count the switches between
+   * the caps of the samples */
+  gst_event_parse_caps (event, &caps);
+  if (es_caps && !gst_caps_is_equal (es_caps, caps) &&
+      gst_structure_has_name (gst_caps_get_structure (es_caps, 0),
+          "video/x-h264"))
+    es_caps_changes++;
+  gst_caps_replace (&es_caps, caps);
+}
+
+static gboolean
+testElementaryStreamsCheckData (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, GstBuffer * buffer,
+    gpointer user_data)
+{
+  const GstStructure *s;
+  const GValue *codec_data;
+  guint segment, moof, sample, rep;
+  gint width, height;
+  GstMapInfo map;
+
+  fail_unless (es_caps != NULL);
+  s = gst_caps_get_structure (es_caps, 0);
+  fail_unless (gst_structure_has_name (s, "video/x-h264"),
+      "unexpected caps %" GST_PTR_FORMAT, es_caps);
+  fail_unless_equals_string (gst_structure_get_string (s, "stream-format"),
+      "avc");
+  fail_unless_equals_string (gst_structure_get_string (s, "alignment"), "au");
+  fail_unless (gst_structure_get_int (s, "width", &width));
+  fail_unless (gst_structure_get_int (s, "height", &height));
+  codec_data = gst_structure_get_value (s, "codec_data");
+  fail_unless (codec_data != NULL && GST_VALUE_HOLDS_BUFFER (codec_data));
+
+  /* the samples are output one by one and in order, across the moofs of a
+   * segment and the representation switch */
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  rep = map.data[0];
+  segment = map.data[1];
+  moof = map.data[2];
+  sample = map.data[3];
+  fail_unless (rep < 2);
+  fail_unless_equals_int (map.size, ES_SAMPLE_SIZE (sample));
+  fail_unless_equals_int (((segment - 1) * ES_N_MOOFS + moof) * ES_N_SAMPLES +
+      sample, es_next_sample);
+  gst_buffer_unmap (buffer, &map);
+  es_next_sample++;
+
+  /* the caps are those of the representation the sample comes from */
+  fail_unless_equals_int (width, es_width[rep]);
+  fail_unless_equals_int (height, es_height[rep]);
+  fail_unless (gst_buffer_memcmp (gst_value_get_buffer (codec_data), 0,
+          es_avcc[rep], sizeof (es_avcc[rep])) == 0);
+  fail_unless (rep >= es_last_rep);
+  es_last_rep = rep;
+
+  fail_unless_equals_uint64 (GST_BUFFER_DTS (buffer),
+      ES_SAMPLE_TIME (segment, moof, sample) * GST_MSECOND);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer),
+      ES_SAMPLE_TIME (segment, moof, sample) * GST_MSECOND);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer),
+      ES_SAMPLE_DURATION * GST_MSECOND);
+  fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buffer,
+          GST_BUFFER_FLAG_DELTA_UNIT), sample != 0);
+
+  return gst_adaptive_demux_test_check_received_data (engine, stream, buffer,
+      user_data);
+}
+
+static void
+testElementaryStreamsCheckEos (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, gpointer user_data)
+{
+  fail_unless_equals_int (es_next_sample,
+      ES_N_SEGMENTS * ES_N_MOOFS * ES_N_SAMPLES);
+  /* from the lowest to the highest representation */
+  fail_unless_equals_int (es_last_rep, 1);
+  fail_unless_equals_int (es_caps_changes, 1);
+
+  gst_adaptive_demux_test_check_size_of_received_data (engine, stream,
+      user_data);
+}
+
+/*
+ * Test the output of the samples of fragmented MP4 representations, with
+ * several moofs per segment and a representation switch
+ *
+ */
+GST_START_TEST (testElementaryStreams)
+{
+  const gchar *mpd =
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+      "     xmlns=\"urn:mpeg:DASH:schema:MPD:2011\""
+      "     xsi:schemaLocation=\"urn:mpeg:DASH:schema:MPD:2011 DASH-MPD.xsd\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+      "     type=\"static\""
+      "     minBufferTime=\"PT1.500S\""
+      "     mediaPresentationDuration=\"PT4S\">"
+      "  <Period>"
+      "    <AdaptationSet mimeType=\"video/mp4\""
+      "                   segmentAlignment=\"true\">"
+      "      <SegmentTemplate timescale=\"1000\""
+      "                       duration=\"1000\""
+      "                       startNumber=\"1\""
+      "                       initialization=\"$RepresentationID$/init.mp4\""
+      "                       media=\"$RepresentationID$/$Number$.m4s\" />"
+      "      <Representation id=\"low\""
+      "                      codecs=\"avc1.42c00d\""
+      "                      width=\"320\""
+      "                      height=\"240\""
+      "                      startWithSAP=\"1\""
+      "                      bandwidth=\"100000\" />"
+      "      <Representation id=\"high\""
+      "                      codecs=\"avc1.42c01e\""
+      "                      width=\"640\""
+      "                      height=\"480\""
+      "                      startWithSAP=\"1\""
+      "                      bandwidth=\"500000\" />"
+      "    </AdaptationSet></Period></MPD>";
+  static const gchar *reps[] = { "low", "high" };
+  GstDashDemuxTestInputData inputTestData[2 + 2 * (1 + ES_N_SEGMENTS)];
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"video_00", 0, NULL},
+  };
+  GstTestHTTPSrcCallbacks http_src_callbacks = { 0 };
+  GstTestHTTPSrcTestData http_src_test_data = { 0 };
+  GstAdaptiveDemuxTestCallbacks test_callbacks = { 0 };
+  GstDashDemuxTestCase *testData;
+  guint i, rep, segment;
+
+  memset (inputTestData, 0, sizeof (inputTestData));
+  i = 0;
+  inputTestData[i].uri = "http://unit.test/test.mpd";
+  inputTestData[i++].payload = (const guint8 *) mpd;
+  for (rep = 0; rep < 2; rep++) {
+    inputTestData[i].uri =
+        g_strdup_printf ("http://unit.test/%s/init.mp4", reps[rep]);
+    inputTestData[i].payload =
+        es_make_init_segment (rep, &inputTestData[i].size);
+    i++;
+    for (segment = 1; segment <= ES_N_SEGMENTS; segment++) {
+      inputTestData[i].uri =
+          g_strdup_printf ("http://unit.test/%s/%u.m4s", reps[rep], segment);
+      inputTestData[i].payload =
+          es_make_media_segment (rep, segment, &inputTestData[i].size);
+      i++;
+    }
+  }
+
+  /* only the samples are output, not the boxes */
+  for (i = 0; i < ES_N_SAMPLES; i++)
+    outputTestData[0].expected_size +=
+        ES_N_SEGMENTS * ES_N_MOOFS * ES_SAMPLE_SIZE (i);
+
+  es_caps = NULL;
+  es_next_sample = 0;
+  es_caps_changes = 0;
+  es_last_rep = 0;
+
+  http_src_callbacks.src_start = gst_dashdemux_http_src_start;
+  http_src_callbacks.src_create = gst_dashdemux_http_src_create;
+  http_src_test_data.input = inputTestData;
+  gst_test_http_src_install_callbacks (&http_src_callbacks,
+      &http_src_test_data);
+
+  test_callbacks.pre_test = setElementaryStreams;
+  test_callbacks.appsink_event = testElementaryStreamsEvent;
+  test_callbacks.appsink_received_data = testElementaryStreamsCheckData;
+  test_callbacks.appsink_eos = testElementaryStreamsCheckEos;
+
+  testData = gst_dash_demux_test_case_new ();
+  COPY_OUTPUT_TEST_DATA (outputTestData, testData);
+
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME, "http://unit.test/test.mpd",
+      &test_callbacks, testData);
+
+  g_object_unref (testData);
+  if (http_src_test_data.data)
+    gst_structure_free (http_src_test_data.data);
+  gst_caps_replace (&es_caps, NULL);
+  for (i = 1; inputTestData[i].uri; i++) {
+    g_free ((gchar *) inputTestData[i].uri);
+    g_free ((guint8 *) inputTestData[i].payload);
+  }
+}
+
+GST_END_TEST;
+
+/* live low latency catch-up for testLowLatencyCatchUp */
+
+/* in seconds, the first period ends at CU_PERIOD_2_START */
+#define CU_PERIOD_2_START 70
+/* in microseconds, like the UTC times below */
+#define CU_AVAILABILITY_TIME_OFFSET (500 * G_TIME_SPAN_MILLISECOND)
+/* of the request times, as the demuxer's idea of UTC is not ours */
+#define CU_TOLERANCE (100 * G_TIME_SPAN_MILLISECOND)
+
+static GstClock *cu_clock;
+/* the UTC time when cu_clock was at 0, in microseconds */
+static gint64 cu_clock_epoch;
+/* availabilityStartTime, in microseconds */
+static gint64 cu_availability_start;
+static guint cu_period_2_requests;
+
+static GstSegment cu_segment;
+static GstAdaptiveDemuxTestOutputStream *cu_stream;
+static GstAdaptiveDemuxTestOutputStream *cu_catch_up_stream;
+static GstClockTime cu_last_running_time;
+static gdouble cu_last_rate;
+static gboolean cu_caught_up;
+static gboolean cu_back_to_normal;
+static guint cu_period_2_fragments;
+static gboolean cu_done;
+
+static void
+setLowLatency (GstAdaptiveDemuxTestEngine * engine, gpointer user_data)
+{
+  g_object_set (engine->demux, "low-latency", TRUE,
+      "target-latency", (guint64) GST_SECOND, "max-catch-up-rate", 2.0, NULL);
+  cu_clock_epoch = g_get_real_time () -
+      (gint64) GST_TIME_AS_USECONDS (gst_clock_get_time (cu_clock));
+}
+
+/* the segments are only requested availabilityTimeOffset before the end of
+ * their production, not earlier */
+static gboolean
+testLowLatencyHTTPSrcStart (GstTestHTTPSrc * src, const gchar * uri,
+    GstTestHTTPSrcInput * input_data, gpointer user_data)
+{
+  static const GstDashDemuxTestInputData fragment = { NULL, NULL, 1000 };
+  guint period, number;
+  gint64 now, available;
+
+  if (!g_str_has_prefix (uri, "http://unit.test/p"))
+    return gst_dashdemux_http_src_start (src, uri, input_data, user_data);
+  /* p<period>-<number>.ts */
+  period = uri[strlen ("http://unit.test/p")] - '0';
+  number = g_ascii_strtoull (strchr (uri, '-') + 1, NULL, 10);
+
+  now = cu_clock_epoch +
+      (gint64) GST_TIME_AS_USECONDS (gst_clock_get_time (cu_clock));
+  available = cu_availability_start +
+      ((period == 2 ? CU_PERIOD_2_START : 0) + number) * G_TIME_SPAN_SECOND -
+      CU_AVAILABILITY_TIME_OFFSET;
+  fail_unless (now >= available - CU_TOLERANCE,
+      "%s requested %" G_GINT64_FORMAT "us too early", uri, available - now);
+
+  /* these were not available yet when playback started, they must have
+   * been waited for and fetched as soon as possible */
+  if (period == 2) {
+    fail_unless (now < available + CU_TOLERANCE,
+        "%s requested %" G_GINT64_FORMAT "us late", uri, now - available);
+    cu_period_2_requests++;
+  }
+
+  input_data->context = (gpointer) & fragment;
+  input_data->size = fragment.size;
+  return TRUE;
+}
+
+static void
+testLowLatencyEvent (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, GstEvent * event,
+    gpointer user_data)
+{
+  if (GST_EVENT_TYPE (event) != GST_EVENT_SEGMENT)
+    return;
+
+  gst_event_copy_segment (event, &cu_segment);
+  GST_DEBUG ("segment %" GST_SEGMENT_FORMAT, &cu_segment);
+
+  if (cu_segment.rate > 1.0) {
+    fail_unless_equals_float (cu_segment.rate, 2.0);
+    cu_caught_up = TRUE;
+    cu_catch_up_stream = stream;
+  } else if (cu_caught_up && stream == cu_catch_up_stream) {
+    cu_back_to_normal = TRUE;
+  }
+}
+
+/* The running times of the fragments must stay continuous through the rate
+ * switches and the period switch, which has to take the running time skipped
+ * by the catch-up into account */
+static gboolean
+testLowLatencyCheckData (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, GstBuffer * buffer,
+    gpointer user_data)
+{
+  GstClockTime running_time, expected;
+
+  /* only the first buffer of a fragment is timestamped */
+  if (cu_done || !GST_BUFFER_PTS_IS_VALID (buffer))
+    return TRUE;
+
+  running_time = gst_segment_to_running_time (&cu_segment, GST_FORMAT_TIME,
+      GST_BUFFER_PTS (buffer));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (running_time));
+
+  if (GST_CLOCK_TIME_IS_VALID (cu_last_running_time)) {
+    expected = cu_last_running_time + GST_SECOND / cu_last_rate;
+    fail_unless (ABS (GST_CLOCK_DIFF (expected, running_time)) <= GST_MSECOND,
+        "fragment at running time %" GST_TIME_FORMAT " instead of %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (running_time), GST_TIME_ARGS (expected));
+  }
+
+  if (cu_stream && stream != cu_stream) {
+    /* the new period starts once the catch-up is over */
+    fail_unless (cu_back_to_normal);
+    fail_unless_equals_float (cu_segment.rate, 1.0);
+    cu_period_2_fragments = 1;
+  } else if (cu_period_2_fragments > 0) {
+    cu_period_2_fragments++;
+  }
+
+  cu_stream = stream;
+  cu_last_running_time = running_time;
+  cu_last_rate = cu_segment.rate;
+
+  if (cu_period_2_fragments == 3) {
+    cu_done = TRUE;
+    g_main_loop_quit (engine->loop);
+  }
+
+  return TRUE;
+}
+
+/*
+ * Test the catch-up with the live edge of the low latency mode
+ *
+ * The stream starts 3s behind the live edge, with a target latency of 1s.
+ * The playback rate must be raised to 2.0 and come back to 1.0 once the
+ * latency is reached, and the following period must keep the running time
+ * gained.
+ */
+GST_START_TEST (testLowLatencyCatchUp)
+{
+  GstDashDemuxTestInputData inputTestData[] = {
+    {"http://unit.test/test.mpd", NULL, 0},
+    {NULL, NULL, 0},
+  };
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"video_00", 0, NULL},
+  };
+  GstTestHTTPSrcCallbacks http_src_callbacks = { 0 };
+  GstTestHTTPSrcTestData http_src_test_data = { 0 };
+  GstAdaptiveDemuxTestCallbacks test_callbacks = { 0 };
+  GstDashDemuxTestCase *testData;
+  GDateTime *start;
+  gchar *start_str, *mpd;
+
+  /* played from the test clock, which the test engine moves to the next
+   * segment availability */
+  cu_clock = gst_test_clock_new ();
+  gst_system_clock_set_default (cu_clock);
+
+  /* about a minute of stream is available */
+  start = g_date_time_new_from_unix_utc (g_get_real_time () /
+      G_TIME_SPAN_SECOND - 60);
+  start_str = g_date_time_format (start, "%Y-%m-%dT%H:%M:%SZ");
+  cu_availability_start = g_date_time_to_unix (start) * G_TIME_SPAN_SECOND;
+  g_date_time_unref (start);
+
+  mpd = g_strdup_printf
+      ("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+      "     xmlns=\"urn:mpeg:DASH:schema:MPD:2011\""
+      "     xsi:schemaLocation=\"urn:mpeg:DASH:schema:MPD:2011 DASH-MPD.xsd\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+      "     type=\"dynamic\""
+      "     availabilityStartTime=\"%s\""
+      "     minimumUpdatePeriod=\"PT500S\""
+      "     suggestedPresentationDelay=\"PT3S\""
+      "     maxSegmentDuration=\"PT1S\""
+      "     minBufferTime=\"PT1S\">"
+      "  <Period id=\"1\" start=\"PT0S\" duration=\"PT%uS\">"
+      "    <AdaptationSet mimeType=\"video/mp2t\">"
+      "      <SegmentTemplate timescale=\"1\" duration=\"1\" startNumber=\"1\""
+      "                       availabilityTimeOffset=\"0.5\""
+      "                       media=\"p1-$Number$.ts\" />"
+      "      <Representation id=\"1\" bandwidth=\"100000\" />"
+      "    </AdaptationSet>"
+      "  </Period>"
+      "  <Period id=\"2\" start=\"PT%uS\">"
+      "    <AdaptationSet mimeType=\"video/mp2t\">"
+      "      <SegmentTemplate timescale=\"1\" duration=\"1\" startNumber=\"1\""
+      "                       availabilityTimeOffset=\"0.5\""
+      "                       media=\"p2-$Number$.ts\" />"
+      "      <Representation id=\"1\" bandwidth=\"100000\" />"
+      "    </AdaptationSet>"
+      "  </Period></MPD>", start_str, CU_PERIOD_2_START, CU_PERIOD_2_START);
+  inputTestData[0].payload = (const guint8 *) mpd;
+
+  cu_period_2_requests = 0;
+  gst_segment_init (&cu_segment, GST_FORMAT_UNDEFINED);
+  cu_stream = NULL;
+  cu_catch_up_stream = NULL;
+  cu_last_running_time = GST_CLOCK_TIME_NONE;
+  cu_last_rate = 1.0;
+  cu_caught_up = FALSE;
+  cu_back_to_normal = FALSE;
+  cu_period_2_fragments = 0;
+  cu_done = FALSE;
+
+  http_src_callbacks.src_start = testLowLatencyHTTPSrcStart;
+  http_src_callbacks.src_create = gst_dashdemux_http_src_create;
+  http_src_test_data.input = inputTestData;
+  gst_test_http_src_install_callbacks (&http_src_callbacks,
+      &http_src_test_data);
+
+  test_callbacks.pre_test = setLowLatency;
+  test_callbacks.appsink_event = testLowLatencyEvent;
+  test_callbacks.appsink_received_data = testLowLatencyCheckData;
+
+  testData = gst_dash_demux_test_case_new ();
+  COPY_OUTPUT_TEST_DATA (outputTestData, testData);
+
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME, "http://unit.test/test.mpd",
+      &test_callbacks, testData);
+
+  fail_unless (cu_caught_up);
+  fail_unless (cu_back_to_normal);
+  fail_unless (cu_done);
+  fail_unless (cu_period_2_requests >= 3);
+
+  g_object_unref (testData);
+  if (http_src_test_data.data)
+    gst_structure_free (http_src_test_data.data);
+  gst_system_clock_set_default (NULL);
+  gst_object_unref (cu_clock);
+  cu_clock = NULL;
+  g_free (start_str);
+  g_free (mpd);
+}
+
+GST_END_TEST;
+
+/* loopback HTTP server of testLowLatencyChunkedTransfer. It serves the
+ * segment in two chunks with a chunked transfer encoding, the second one
+ * being held until the first one is received from the demuxer, as a
+ * packager does with the CMAF chunks of a segment being produced */
+
+#define CT_CHUNK_SIZE 4000
+
+static GSocket *ct_socket;
+static GCancellable *ct_cancellable;
+static gchar *ct_mpd;
+static GMutex ct_lock;
+static GCond ct_cond;
+static guint64 ct_received;
+static gboolean ct_first_chunk_received;
+
+static gchar *
+ct_read_request (GSocket * conn)
+{
+  GString *request = g_string_new (NULL);
+  gchar buf[1024];
+  gssize len;
+
+  while (!strstr (request->str, "\r\n\r\n")) {
+    len = g_socket_receive (conn, buf, sizeof (buf), ct_cancellable, NULL);
+    if (len <= 0) {
+      g_string_free (request, TRUE);
+      return NULL;
+    }
+    g_string_append_len (request, buf, len);
+  }
+
+  return g_string_free (request, FALSE);
+}
+
+static gboolean
+ct_send (GSocket * conn, const gchar * data, gsize len)
+{
+  gssize sent;
+
+  while (len > 0) {
+    sent = g_socket_send (conn, data, len, ct_cancellable, NULL);
+    if (sent <= 0)
+      return FALSE;
+    data += sent;
+    len -= sent;
+  }
+  return TRUE;
+}
+
+static gboolean
+ct_send_chunk (GSocket * conn, const guint8 * data, gsize size)
+{
+  gchar *header = g_strdup_printf ("%" G_GSIZE_MODIFIER "x\r\n", size);
+  gboolean ret;
+
+  ret = ct_send (conn, header, strlen (header)) &&
+      ct_send (conn, (const gchar *) data, size) && ct_send (conn, "\r\n", 2);
+  g_free (header);
+
+  return ret;
+}
+
+static void
+ct_send_segment (GSocket * conn)
+{
+  const gchar *header = "HTTP/1.1 200 OK\r\n"
+      "Content-Type: video/mp2t\r\n"
+      "Transfer-Encoding: chunked\r\n" "Connection: close\r\n\r\n";
+  GstDashDemuxTestInputData input = { NULL, NULL, 2 * CT_CHUNK_SIZE };
+  GstBuffer *body;
+  GstMapInfo map;
+  gint64 end_time;
+
+  gst_dashdemux_http_src_create (NULL, 0, 2 * CT_CHUNK_SIZE, &body, &input,
+      NULL);
+  gst_buffer_map (body, &map, GST_MAP_READ);
+
+  if (!ct_send (conn, header, strlen (header))
+      || !ct_send_chunk (conn, map.data, CT_CHUNK_SIZE))
+    goto done;
+
+  /* the rest of the segment is not produced yet */
+  end_time = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+  g_mutex_lock (&ct_lock);
+  while (ct_received < CT_CHUNK_SIZE) {
+    if (!g_cond_wait_until (&ct_cond, &ct_lock, end_time))
+      break;
+  }
+  ct_first_chunk_received = ct_received == CT_CHUNK_SIZE;
+  g_mutex_unlock (&ct_lock);
+
+  if (ct_send_chunk (conn, map.data + CT_CHUNK_SIZE, CT_CHUNK_SIZE))
+    ct_send (conn, "0\r\n\r\n", 5);
+
+done:
+  gst_buffer_unmap (body, &map);
+  gst_buffer_unref (body);
+}
+
+/* answers one request per connection */
+static gpointer
+ct_server_thread (gpointer user_data)
+{
+  const gchar *not_found = "HTTP/1.1 404 Not Found\r\n"
+      "Content-Length: 0\r\n" "Connection: close\r\n\r\n";
+  GSocket *conn;
+  gchar *request, *response;
+
+  while ((conn = g_socket_accept (ct_socket, ct_cancellable, NULL))) {
+    request = ct_read_request (conn);
+    if (request && g_str_has_prefix (request, "GET /test.mpd ")) {
+      response = g_strdup_printf ("HTTP/1.1 200 OK\r\n"
+          "Content-Type: application/dash+xml\r\n"
+          "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+          "Connection: close\r\n\r\n%s", strlen (ct_mpd), ct_mpd);
+      ct_send (conn, response, strlen (response));
+      g_free (response);
+    } else if (request && g_str_has_prefix (request, "GET /segment.ts ")) {
+      ct_send_segment (conn);
+    } else if (request) {
+      ct_send (conn, not_found, strlen (not_found));
+    }
+    g_free (request);
+    g_socket_close (conn, NULL);
+    g_object_unref (conn);
+  }
+
+  return NULL;
+}
+
+static void
+testChunkedTransferSetLowLatency (GstAdaptiveDemuxTestEngine * engine,
+    gpointer user_data)
+{
+  g_object_set (engine->demux, "low-latency", TRUE, NULL);
+}
+
+static gboolean
+testChunkedTransferCheckData (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, GstBuffer * buffer,
+    gpointer user_data)
+{
+  g_mutex_lock (&ct_lock);
+  ct_received += gst_buffer_get_size (buffer);
+  g_cond_signal (&ct_cond);
+  g_mutex_unlock (&ct_lock);
+
+  return gst_adaptive_demux_test_check_received_data (engine, stream, buffer,
+      user_data);
+}
+
+/*
+ * Test that in low latency mode the chunks of a segment are output while
+ * the segment is still being produced, with a real HTTP source downloading
+ * from a loopback server.
+ *
+ */
+GST_START_TEST (testLowLatencyChunkedTransfer)
+{
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"video_00", 2 * CT_CHUNK_SIZE, NULL},
+  };
+  GstAdaptiveDemuxTestCallbacks test_callbacks = { 0 };
+  GstDashDemuxTestCase *testData;
+  GstPluginFeature *test_src;
+  GstElement *http_src;
+  GInetAddress *loopback;
+  GSocketAddress *addr;
+  GThread *server;
+  guint16 port;
+  guint rank;
+  gchar *uri;
+
+  /* the test HTTP source would otherwise answer the http URIs */
+  test_src = gst_registry_lookup_feature (gst_registry_get (), "testhttpsrc");
+  fail_unless (test_src != NULL);
+  rank = gst_plugin_feature_get_rank (test_src);
+  gst_plugin_feature_set_rank (test_src, GST_RANK_NONE);
+
+  http_src = gst_element_make_from_uri (GST_URI_SRC, "http://127.0.0.1/",
+      NULL, NULL);
+  if (http_src == NULL) {
+    GST_INFO ("no HTTP source element, skipping test");
+    goto out;
+  }
+  gst_object_unref (http_src);
+
+  ct_cancellable = g_cancellable_new ();
+  ct_socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+      G_SOCKET_PROTOCOL_TCP, NULL);
+  fail_unless (ct_socket != NULL);
+  loopback = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (loopback, 0);
+  fail_unless (g_socket_bind (ct_socket, addr, TRUE, NULL));
+  fail_unless (g_socket_listen (ct_socket, NULL));
+  g_object_unref (addr);
+  g_object_unref (loopback);
+  addr = g_socket_get_local_address (ct_socket, NULL);
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr));
+  g_object_unref (addr);
+
+  ct_mpd = g_strdup ("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+      "     xmlns=\"urn:mpeg:DASH:schema:MPD:2011\""
+      "     xsi:schemaLocation=\"urn:mpeg:DASH:schema:MPD:2011 DASH-MPD.xsd\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+      "     type=\"static\""
+      "     minBufferTime=\"PT1S\""
+      "     mediaPresentationDuration=\"PT1S\">"
+      "  <Period>"
+      "    <AdaptationSet mimeType=\"video/mp2t\">"
+      "      <Representation id=\"1\" bandwidth=\"100000\">"
+      "        <BaseURL>segment.ts</BaseURL>"
+      "      </Representation>"
+      "    </AdaptationSet>"
+      "  </Period></MPD>");
+  ct_received = 0;
+  ct_first_chunk_received = FALSE;
+  server = g_thread_new ("http-server", ct_server_thread, NULL);
+
+  test_callbacks.pre_test = testChunkedTransferSetLowLatency;
+  test_callbacks.appsink_received_data = testChunkedTransferCheckData;
+  test_callbacks.appsink_eos =
+      gst_adaptive_demux_test_check_size_of_received_data;
+
+  testData = gst_dash_demux_test_case_new ();
+  COPY_OUTPUT_TEST_DATA (outputTestData, testData);
+
+  uri = g_strdup_printf ("http://127.0.0.1:%u/test.mpd", port);
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME, uri, &test_callbacks,
+      testData);
+
+  fail_unless (ct_first_chunk_received,
+      "the first chunk was not output before the end of the segment");
+
+  g_cancellable_cancel (ct_cancellable);
+  g_thread_join (server);
+  g_socket_close (ct_socket, NULL);
+  g_object_unref (ct_socket);
+  g_object_unref (ct_cancellable);
+  g_object_unref (testData);
+  g_free (ct_mpd);
+  g_free (uri);
+
+out:
+  gst_plugin_feature_set_rank (test_src, rank);
+  gst_object_unref (test_src);
+}
+
+GST_END_TEST;
+
+/* index cache of isoff-on-demand representations, for testIndexCacheSeek and
+ * testIndexCacheEviction. The file is made of the init segment and media
+ * segments of testElementaryStreams, the media segments being indexed as
+ * subsegments by a sidx */
+
+#define IC_N_SUBSEGMENTS 4
+/* the subsegment the seek lands in */
+#define IC_SEEK_SUBSEGMENT 2
+
+static guint8 *ic_file;
+static guint64 ic_file_size;
+static guint64 ic_init_size;
+static guint64 ic_media_start;
+static guint64 ic_subsegment_offsets[IC_N_SUBSEGMENTS];
+static guint64 ic_max_size;
+
+/* reads of the header and of the index from the server */
+static guint ic_header_reads;
+static guint ic_index_reads;
+
+static GstEvent *ic_seek_event;
+static GThread *ic_seek_thread;
+static GMutex ic_lock;
+static GCond ic_cond;
+static gboolean ic_flushing;
+static gboolean ic_seeked;
+static gboolean ic_checked_seek_offset;
+static guint64 ic_media_received;
+
+static void
+ic_make_on_demand_file (void)
+{
+  GstByteWriter bw;
+  guint8 *init, *media[IC_N_SUBSEGMENTS];
+  guint64 media_size[IC_N_SUBSEGMENTS];
+  guint64 offset;
+  guint sidx, i;
+
+  init = es_make_init_segment (0, &ic_init_size);
+  for (i = 0; i < IC_N_SUBSEGMENTS; i++)
+    media[i] = es_make_media_segment (0, i + 1, &media_size[i]);
+
+  gst_byte_writer_init (&bw);
+  gst_byte_writer_put_data (&bw, init, ic_init_size);
+
+  sidx = es_box_start (&bw, "sidx");
+  es_full_box_header (&bw, 0, 0);
+  gst_byte_writer_put_uint32_be (&bw, 1);
+  gst_byte_writer_put_uint32_be (&bw, 1000);
+  /* earliest_presentation_time and first_offset */
+  gst_byte_writer_put_uint32_be (&bw, 0);
+  gst_byte_writer_put_uint32_be (&bw, 0);
+  gst_byte_writer_put_uint16_be (&bw, 0);
+  gst_byte_writer_put_uint16_be (&bw, IC_N_SUBSEGMENTS);
+  for (i = 0; i < IC_N_SUBSEGMENTS; i++) {
+    gst_byte_writer_put_uint32_be (&bw, media_size[i]);
+    gst_byte_writer_put_uint32_be (&bw,
+        ES_N_MOOFS * ES_N_SAMPLES * ES_SAMPLE_DURATION);
+    /* starts with a SAP of type 1 */
+    gst_byte_writer_put_uint32_be (&bw, 0x90000000);
+  }
+  es_box_end (&bw, sidx);
+  ic_media_start = gst_byte_writer_get_pos (&bw);
+
+  offset = ic_media_start;
+  for (i = 0; i < IC_N_SUBSEGMENTS; i++) {
+    ic_subsegment_offsets[i] = offset;
+    gst_byte_writer_put_data (&bw, media[i], media_size[i]);
+    offset += media_size[i];
+    g_free (media[i]);
+  }
+  g_free (init);
+
+  ic_file_size = gst_byte_writer_get_pos (&bw);
+  ic_file = gst_byte_writer_reset_and_get_data (&bw);
+}
+
+static gchar *
+ic_make_mpd (void)
+{
+  return g_strdup_printf ("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+      "     xmlns=\"urn:mpeg:DASH:schema:MPD:2011\""
+      "     xsi:schemaLocation=\"urn:mpeg:DASH:schema:MPD:2011 DASH-MPD.xsd\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-on-demand:2011\""
+      "     type=\"static\""
+      "     minBufferTime=\"PT1.500S\""
+      "     mediaPresentationDuration=\"PT%uS\">"
+      "  <Period>"
+      "    <AdaptationSet mimeType=\"video/mp4\""
+      "                   subsegmentAlignment=\"true\">"
+      "      <Representation id=\"1\""
+      "                      codecs=\"avc1.42c00d\""
+      "                      width=\"320\""
+      "                      height=\"240\""
+      "                      startWithSAP=\"1\""
+      "                      bandwidth=\"100000\">"
+      "        <BaseURL>video.mp4</BaseURL>"
+      "        <SegmentBase indexRange=\"%" G_GUINT64_FORMAT "-%"
+      G_GUINT64_FORMAT "\""
+      "                     indexRangeExact=\"true\">"
+      "          <Initialization range=\"0-%" G_GUINT64_FORMAT "\" />"
+      "        </SegmentBase>"
+      "      </Representation></AdaptationSet></Period></MPD>",
+      IC_N_SUBSEGMENTS, ic_init_size, ic_media_start - 1, ic_init_size - 1);
+}
+
+static GstFlowReturn
+ic_http_src_create (GstTestHTTPSrc * src, guint64 offset, guint length,
+    GstBuffer ** retbuf, gpointer context, gpointer user_data)
+{
+  const GstDashDemuxTestInputData *input =
+      (const GstDashDemuxTestInputData *) context;
+
+  if (input->payload == ic_file && offset < ic_init_size)
+    ic_header_reads++;
+  else if (input->payload == ic_file && offset < ic_media_start)
+    ic_index_reads++;
+
+  return gst_dashdemux_http_src_create (src, offset, length, retbuf, context,
+      user_data);
+}
+
+static void
+setIndexCache (GstAdaptiveDemuxTestEngine * engine, gpointer user_data)
+{
+  g_object_set (engine->demux, "index-cache-directory", index_cache_directory,
+      NULL);
+  if (ic_max_size)
+    g_object_set (engine->demux, "index-cache-max-size", ic_max_size, NULL);
+}
+
+static gpointer
+ic_do_seek (gpointer pipeline)
+{
+  fail_unless (gst_element_send_event (GST_ELEMENT (pipeline),
+          gst_event_ref (ic_seek_event)));
+
+  return NULL;
+}
+
+/* Seeks at the first media data, with the header and the index read from the
+ * cache. The data is held until the seek flushes the sink, as in
+ * gst_adaptive_demux_test_seek() */
+static gboolean
+testIndexCacheSendsData (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, GstBuffer * buffer,
+    gpointer user_data)
+{
+  gint64 end_time;
+
+  if (ic_seek_event == NULL || ic_seek_thread != NULL ||
+      GST_BUFFER_OFFSET (buffer) < ic_media_start)
+    return TRUE;
+
+  ic_seek_thread = g_thread_new ("seek", ic_do_seek, engine->pipeline);
+
+  end_time = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+  g_mutex_lock (&ic_lock);
+  while (!ic_flushing)
+    fail_unless (g_cond_wait_until (&ic_cond, &ic_lock, end_time),
+        "the seek did not flush");
+  g_mutex_unlock (&ic_lock);
+
+  return TRUE;
+}
+
+static void
+testIndexCacheEvent (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, GstEvent * event,
+    gpointer user_data)
+{
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_START:
+      g_mutex_lock (&ic_lock);
+      ic_flushing = TRUE;
+      g_cond_signal (&ic_cond);
+      g_mutex_unlock (&ic_lock);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      ic_seeked = TRUE;
+      ic_media_received = 0;
+      break;
+    default:
+      break;
+  }
+}
+
+/* The buffers carry their offset in the file, which must match their data.
+ * After the seek, the media data must restart at the subsegment of the seek
+ * position, found from the index with its offset in the file */
+static gboolean
+testIndexCacheCheckData (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, GstBuffer * buffer,
+    gpointer user_data)
+{
+  guint64 offset = GST_BUFFER_OFFSET (buffer);
+  gsize size = gst_buffer_get_size (buffer);
+
+  fail_unless (GST_BUFFER_OFFSET_IS_VALID (buffer));
+  fail_unless (offset + size <= ic_file_size);
+  fail_unless (gst_buffer_memcmp (buffer, 0, ic_file + offset, size) == 0,
+      "data at offset %" G_GUINT64_FORMAT " differs from the file", offset);
+
+  if (offset < ic_media_start)
+    return TRUE;
+
+  if (ic_seeked && !ic_checked_seek_offset) {
+    fail_unless_equals_uint64 (offset,
+        ic_subsegment_offsets[IC_SEEK_SUBSEGMENT]);
+    ic_checked_seek_offset = TRUE;
+  }
+  ic_media_received += size;
+
+  return TRUE;
+}
+
+static void
+testIndexCacheCheckEos (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, gpointer user_data)
+{
+  if (ic_seek_event) {
+    fail_unless (ic_checked_seek_offset);
+    fail_unless_equals_uint64 (ic_media_received,
+        ic_file_size - ic_subsegment_offsets[IC_SEEK_SUBSEGMENT]);
+  } else {
+    fail_unless_equals_uint64 (ic_media_received,
+        ic_file_size - ic_media_start);
+  }
+
+  g_main_loop_quit (engine->loop);
+}
+
+/* plays the file with the index cache, seeking if @seek_event */
+static void
+ic_run (GstEvent * seek_event)
+{
+  gchar *mpd = ic_make_mpd ();
+  GstDashDemuxTestInputData inputTestData[] = {
+    {"http://unit.test/test.mpd", (guint8 *) mpd, 0},
+    {"http://unit.test/video.mp4", ic_file, ic_file_size},
+    {NULL, NULL, 0},
+  };
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"video_00", ic_file_size, NULL},
+  };
+  GstTestHTTPSrcCallbacks http_src_callbacks = { 0 };
+  GstTestHTTPSrcTestData http_src_test_data = { 0 };
+  GstAdaptiveDemuxTestCallbacks test_callbacks = { 0 };
+  GstDashDemuxTestCase *testData;
+
+  ic_header_reads = 0;
+  ic_index_reads = 0;
+  ic_seek_event = seek_event;
+  ic_seek_thread = NULL;
+  ic_flushing = FALSE;
+  ic_seeked = FALSE;
+  ic_checked_seek_offset = FALSE;
+  ic_media_received = 0;
+
+  http_src_callbacks.src_start = gst_dashdemux_http_src_start;
+  http_src_callbacks.src_create = ic_http_src_create;
+  http_src_test_data.input = inputTestData;
+  gst_test_http_src_install_callbacks (&http_src_callbacks,
+      &http_src_test_data);
+
+  test_callbacks.pre_test = setIndexCache;
+  test_callbacks.appsink_received_data = testIndexCacheCheckData;
+  test_callbacks.appsink_eos = testIndexCacheCheckEos;
+  test_callbacks.appsink_event = testIndexCacheEvent;
+  test_callbacks.demux_sent_data = testIndexCacheSendsData;
+
+  testData = gst_dash_demux_test_case_new ();
+  COPY_OUTPUT_TEST_DATA (outputTestData, testData);
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME, "http://unit.test/test.mpd",
+      &test_callbacks, testData);
+  g_object_unref (testData);
+
+  if (ic_seek_thread)
+    g_thread_join (ic_seek_thread);
+  fail_unless (seek_event == NULL || ic_seeked);
+
+  if (http_src_test_data.data)
+    gst_structure_free (http_src_test_data.data);
+  g_free (mpd);
+}
+
+/*
+ * Test a seek in an isoff-on-demand representation whose header and sidx
+ * were read from the index cache: the media ranges are found from the
+ * offset of the cached sidx in the file
+ *
+ */
+GST_START_TEST (testIndexCacheSeek)
+{
+  GstEvent *seek_event;
+
+  ic_make_on_demand_file ();
+  ic_max_size = 0;
+  index_cache_directory = g_dir_make_tmp ("dash_demux-XXXXXX", NULL);
+  fail_unless (index_cache_directory != NULL);
+
+  /* the first run downloads the header and the index and caches them */
+  ic_run (NULL);
+  fail_unless (ic_header_reads > 0);
+  fail_unless (ic_index_reads > 0);
+
+  /* the second one only downloads media data, before and after the seek */
+  seek_event = gst_event_new_seek (1.0, GST_FORMAT_TIME,
+      GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT, GST_SEEK_TYPE_SET,
+      IC_SEEK_SUBSEGMENT * GST_SECOND + 500 * GST_MSECOND, GST_SEEK_TYPE_NONE,
+      0);
+  ic_run (seek_event);
+  fail_unless_equals_int (ic_header_reads, 0);
+  fail_unless_equals_int (ic_index_reads, 0);
+
+  gst_event_unref (seek_event);
+  remove_index_cache_directory ();
+  g_free (ic_file);
+  ic_file = NULL;
+}
+
+GST_END_TEST;
+
+/* the total size of the entries of the index cache, without their key
+ * files */
+static guint64
+ic_get_directory_size (guint * n_entries)
+{
+  const gchar *name;
+  guint64 size = 0;
+  GDir *dir;
+
+  *n_entries = 0;
+  dir = g_dir_open (index_cache_directory, 0, NULL);
+  fail_unless (dir != NULL);
+  while ((name = g_dir_read_name (dir)) != NULL) {
+    gchar *path;
+    GStatBuf st;
+
+    if (!g_str_has_suffix (name, ".index"))
+      continue;
+
+    path = g_build_filename (index_cache_directory, name, NULL);
+    fail_unless (g_stat (path, &st) == 0);
+    size += st.st_size;
+    (*n_entries)++;
+    g_free (path);
+  }
+  g_dir_close (dir);
+
+  return size;
+}
+
+/*
+ * Test that the index cache keeps under index-cache-max-size, evicting the
+ * least recently used entries and not storing the ones which do not fit
+ *
+ */
+GST_START_TEST (testIndexCacheEviction)
+{
+  guint64 index_size;
+  guint8 stale[100] = { 0, };
+  gchar *stale_path, *stale_meta_path;
+  guint n_entries;
+
+  ic_make_on_demand_file ();
+  index_size = ic_media_start - ic_init_size;
+
+  /* an older entry, that has to go to make room for the new ones */
+  index_cache_directory = g_dir_make_tmp ("dash_demux-XXXXXX", NULL);
+  fail_unless (index_cache_directory != NULL);
+  stale_path = g_build_filename (index_cache_directory, "stale.index", NULL);
+  fail_unless (g_file_set_contents (stale_path, (gchar *) stale,
+          sizeof (stale), NULL));
+  stale_meta_path = g_strconcat (stale_path, ".meta", NULL);
+  fail_unless (g_file_set_contents (stale_meta_path,
+          "[entry]\nlast-used=1\n", -1, NULL));
+
+  ic_max_size = ic_init_size + index_size + sizeof (stale) / 2;
+  ic_run (NULL);
+  fail_if (g_file_test (stale_path, G_FILE_TEST_EXISTS));
+  fail_if (g_file_test (stale_meta_path, G_FILE_TEST_EXISTS));
+  fail_unless_equals_uint64 (ic_get_directory_size (&n_entries),
+      ic_init_size + index_size);
+  fail_unless_equals_int (n_entries, 2);
+
+  ic_run (NULL);
+  fail_unless_equals_int (ic_header_reads, 0);
+  fail_unless_equals_int (ic_index_reads, 0);
+
+  g_free (stale_path);
+  g_free (stale_meta_path);
+  remove_index_cache_directory ();
+
+  /* the header is larger than the cache, only the index is kept */
+  index_cache_directory = g_dir_make_tmp ("dash_demux-XXXXXX", NULL);
+  fail_unless (index_cache_directory != NULL);
+  ic_max_size = ic_init_size - 1;
+  ic_run (NULL);
+  fail_unless_equals_uint64 (ic_get_directory_size (&n_entries), index_size);
+  fail_unless_equals_int (n_entries, 1);
+
+  ic_run (NULL);
+  fail_unless (ic_header_reads > 0);
+  fail_unless_equals_int (ic_index_reads, 0);
+
+  remove_index_cache_directory ();
+  g_free (ic_file);
+  ic_file = NULL;
+}
+
+GST_END_TEST;
+
 static Suite *
 dash_demux_suite (void)
 {
@@ -1525,6 +3141,10 @@ dash_demux_suite (void)
   tcase_add_test (tc_basicTest, simpleTest);
   tcase_add_test (tc_basicTest, testTwoPeriods);
   tcase_add_test (tc_basicTest, testParameters);
+  tcase_add_test (tc_basicTest, testIndexCache);
+  tcase_add_test (tc_basicTest, testIndexCacheRevalidation);
+  tcase_add_test (tc_basicTest, testIndexCacheSeek);
+  tcase_add_test (tc_basicTest, testIndexCacheEviction);
   tcase_add_test (tc_basicTest, testSeek);
   tcase_add_test (tc_basicTest, testSeekKeyUnitPosition);
   tcase_add_test (tc_basicTest, testSeekPosition);
@@ -1541,6 +3161,9 @@ dash_demux_suite (void)
   tcase_add_test (tc_basicTest, testMediaDownloadErrorMiddleFragment);
   tcase_add_test (tc_basicTest, testQuery);
   tcase_add_test (tc_basicTest, testContentProtection);
+  tcase_add_test (tc_basicTest, testElementaryStreams);
+  tcase_add_test (tc_basicTest, testLowLatencyCatchUp);
+  tcase_add_test (tc_basicTest, testLowLatencyChunkedTransfer);
 
   tcase_add_unchecked_fixture (tc_basicTest, gst_adaptive_demux_test_setup,
       gst_adaptive_demux_test_teardown);
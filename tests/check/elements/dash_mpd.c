@@ -893,7 +893,9 @@ GST_START_TEST
       "                     duration=\"1\""
       "                     presentationTimeOffset=\"123456789\""
       "                     indexRange=\"100-200\""
-      "                     indexRangeExact=\"true\">"
+      "                     indexRangeExact=\"true\""
+      "                     availabilityTimeOffset=\"1.5\""
+      "                     availabilityTimeComplete=\"false\">"
       "    </SegmentTemplate></Period></MPD>";
 
   gboolean ret;
@@ -911,6 +913,8 @@ GST_START_TEST
   assert_equals_uint64 (segBaseType->indexRange->first_byte_pos, 100);
   assert_equals_uint64 (segBaseType->indexRange->last_byte_pos, 200);
   assert_equals_int (segBaseType->indexRangeExact, TRUE);
+  assert_equals_float (segBaseType->availabilityTimeOffset, 1.5);
+  assert_equals_int (segBaseType->availabilityTimeComplete, FALSE);
 
   gst_mpd_client_free (mpdclient);
 }
@@ -3255,6 +3259,110 @@ GST_START_TEST (dash_mpdparser_adaptationSet_handling)
 
 GST_END_TEST;
 
+/*
+ * Test handling trick mode Adaptation sets
+ *
+ */
+GST_START_TEST (dash_mpdparser_trickmode_adaptationSet)
+{
+  GList *adaptationSets;
+  GstAdaptationSetNode *main_set, *trick_set, *audio_set;
+  GstDescriptorType *descriptor;
+  GstActiveStream *activeStream;
+
+  const gchar *xml =
+      "<?xml version=\"1.0\"?>"
+      "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-main:2011\">"
+      "  <Period id=\"Period0\" duration=\"P0Y0M1DT1H1M1S\">"
+      "    <AdaptationSet id=\"1\" mimeType=\"video/mp4\">"
+      "      <Representation id=\"1\" bandwidth=\"250000\">"
+      "      </Representation>"
+      "      <Representation id=\"2\" bandwidth=\"1000000\">"
+      "      </Representation>"
+      "    </AdaptationSet>"
+      "    <AdaptationSet id=\"2\" mimeType=\"video/mp4\">"
+      "      <EssentialProperty"
+      "          schemeIdUri=\"http://dashif.org/guidelines/trickmode\""
+      "          value=\"1\"/>"
+      "      <Representation id=\"3\" bandwidth=\"200000\">"
+      "      </Representation>"
+      "      <Representation id=\"4\" bandwidth=\"100000\">"
+      "      </Representation>"
+      "    </AdaptationSet>"
+      "    <AdaptationSet id=\"3\" mimeType=\"audio\">"
+      "      <SupplementalProperty schemeIdUri=\"urn:example\" value=\"x\"/>"
+      "      <Representation id=\"5\" bandwidth=\"64000\">"
+      "      </Representation></AdaptationSet></Period></MPD>";
+
+  gboolean ret;
+  GstMpdClient *mpdclient = gst_mpd_client_new ();
+
+  ret = gst_mpd_parse (mpdclient, xml, (gint) strlen (xml));
+  assert_equals_int (ret, TRUE);
+
+  /* process the xml data */
+  ret =
+      gst_mpd_client_setup_media_presentation (mpdclient, GST_CLOCK_TIME_NONE,
+      -1, NULL);
+  assert_equals_int (ret, TRUE);
+
+  adaptationSets = gst_mpd_client_get_adaptation_sets (mpdclient);
+  main_set = (GstAdaptationSetNode *) g_list_nth_data (adaptationSets, 0);
+  trick_set = (GstAdaptationSetNode *) g_list_nth_data (adaptationSets, 1);
+  audio_set = (GstAdaptationSetNode *) g_list_nth_data (adaptationSets, 2);
+  fail_if (main_set == NULL || trick_set == NULL || audio_set == NULL);
+
+  /* the descriptors are parsed */
+  fail_if (trick_set->RepresentationBase->EssentialProperty == NULL);
+  descriptor = trick_set->RepresentationBase->EssentialProperty->data;
+  assert_equals_string (descriptor->schemeIdUri,
+      "http://dashif.org/guidelines/trickmode");
+  assert_equals_string (descriptor->value, "1");
+  fail_if (audio_set->RepresentationBase->SupplementalProperty == NULL);
+  descriptor = audio_set->RepresentationBase->SupplementalProperty->data;
+  assert_equals_string (descriptor->schemeIdUri, "urn:example");
+
+  fail_unless (gst_mpd_client_adaptation_set_is_trickmode_only (trick_set));
+  fail_if (gst_mpd_client_adaptation_set_is_trickmode_only (main_set));
+  fail_if (gst_mpd_client_adaptation_set_is_trickmode_only (audio_set));
+
+  fail_unless (gst_mpd_client_get_trickmode_adaptation_set (mpdclient,
+          main_set) == trick_set);
+  fail_unless (gst_mpd_client_get_trickmode_adaptation_set (mpdclient,
+          trick_set) == NULL);
+  fail_unless (gst_mpd_client_get_trickmode_adaptation_set (mpdclient,
+          audio_set) == NULL);
+  fail_unless (gst_mpd_client_get_trickmode_main_adaptation_set (mpdclient,
+          trick_set) == main_set);
+  fail_unless (gst_mpd_client_get_trickmode_main_adaptation_set (mpdclient,
+          main_set) == NULL);
+
+  /* switch the stream to the lowest representation of the trick mode set
+   * and back */
+  ret = gst_mpd_client_setup_streaming (mpdclient, main_set);
+  assert_equals_int (ret, TRUE);
+  activeStream = gst_mpdparser_get_active_stream_by_index (mpdclient, 0);
+  fail_if (activeStream == NULL);
+
+  ret = gst_mpd_client_setup_adaptation_set (mpdclient, activeStream,
+      trick_set);
+  assert_equals_int (ret, TRUE);
+  fail_unless (activeStream->cur_adapt_set == trick_set);
+  assert_equals_string (activeStream->cur_representation->id, "4");
+  assert_equals_int (activeStream->representation_idx, 1);
+
+  ret = gst_mpd_client_setup_adaptation_set (mpdclient, activeStream,
+      main_set);
+  assert_equals_int (ret, TRUE);
+  fail_unless (activeStream->cur_adapt_set == main_set);
+  assert_equals_string (activeStream->cur_representation->id, "1");
+
+  gst_mpd_client_free (mpdclient);
+}
+
+GST_END_TEST;
+
 /*
  * Test handling Representation selection
  *
@@ -5976,6 +6084,7 @@ dash_suite (void)
   tcase_add_test (tc_complexMPD, dash_mpdparser_period_selection);
   tcase_add_test (tc_complexMPD, dash_mpdparser_get_period_at_time);
   tcase_add_test (tc_complexMPD, dash_mpdparser_adaptationSet_handling);
+  tcase_add_test (tc_complexMPD, dash_mpdparser_trickmode_adaptationSet);
   tcase_add_test (tc_complexMPD, dash_mpdparser_representation_selection);
   tcase_add_test (tc_complexMPD, dash_mpdparser_multipleSegmentURL);
   tcase_add_test (tc_complexMPD, dash_mpdparser_activeStream_selection);
@@ -0,0 +1,268 @@
+/* GStreamer
+ *
+ * unit test for freeverb
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/audio/audio.h>
+
+#define RATE 48000
+
+static GstHarness *
+setup_freeverb (const gchar * format, gint in_channels, guint64 in_mask,
+    gint out_channels, guint64 out_mask)
+{
+  GstHarness *h;
+  GstCaps *caps;
+
+  h = gst_harness_new ("freeverb");
+
+  caps = gst_caps_new_simple ("audio/x-raw", "format", G_TYPE_STRING, format,
+      "rate", G_TYPE_INT, RATE, "channels", G_TYPE_INT, in_channels,
+      "layout", G_TYPE_STRING, "interleaved", NULL);
+  if (in_mask)
+    gst_caps_set_simple (caps, "channel-mask", GST_TYPE_BITMASK, in_mask, NULL);
+  gst_harness_set_src_caps (h, caps);
+
+  caps = gst_caps_new_simple ("audio/x-raw", "format", G_TYPE_STRING, format,
+      "rate", G_TYPE_INT, RATE, "channels", G_TYPE_INT, out_channels,
+      "layout", G_TYPE_STRING, "interleaved", NULL);
+  if (out_mask)
+    gst_caps_set_simple (caps, "channel-mask", GST_TYPE_BITMASK, out_mask,
+        NULL);
+  gst_harness_set_sink_caps (h, caps);
+
+  return h;
+}
+
+/* @n_frames of float noise in all channels, or silence */
+static GstBuffer *
+make_float_buffer (gint channels, guint n_frames, gboolean silent)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gfloat *data;
+  guint i;
+
+  buf = gst_buffer_new_allocate (NULL, n_frames * channels * sizeof (gfloat),
+      NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  data = (gfloat *) map.data;
+  for (i = 0; i < n_frames * channels; i++)
+    data[i] = silent ? 0.0 : g_random_double_range (-0.5, 0.5);
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static gdouble
+channel_energy (GstBuffer * buf, gint channels, gint channel)
+{
+  GstMapInfo map;
+  const gfloat *data;
+  gdouble sum = 0.0;
+  guint i, n_frames;
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  data = (const gfloat *) map.data;
+  n_frames = map.size / (channels * sizeof (gfloat));
+  for (i = 0; i < n_frames; i++)
+    sum += data[i * channels + channel] * data[i * channels + channel];
+  gst_buffer_unmap (buf, &map);
+
+  return sum;
+}
+
+GST_START_TEST (test_mono_to_stereo)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint16 *data;
+  guint64 tail[2] = { 0, 0 };
+  gint i;
+
+  h = setup_freeverb (GST_AUDIO_NE (S16), 1, 0, 2, 0);
+
+  /* an impulse */
+  buf = gst_buffer_new_allocate (NULL, 4096 * sizeof (gint16), NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+  ((gint16 *) map.data)[0] = G_MAXINT16;
+  gst_buffer_unmap (buf, &map);
+
+  buf = gst_harness_push_and_pull (h, buf);
+  fail_unless_equals_int (gst_buffer_get_size (buf),
+      4096 * 2 * sizeof (gint16));
+
+  /* the dry signal and the reverb tail are in both channels */
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  data = (gint16 *) map.data;
+  fail_unless (data[0] != 0 && data[1] != 0);
+  for (i = 2000; i < 4096; i++) {
+    tail[0] += ABS (data[2 * i]);
+    tail[1] += ABS (data[2 * i + 1]);
+  }
+  fail_unless (tail[0] > 0 && tail[1] > 0);
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_surround_5_1)
+{
+  GstAudioChannelPosition pos[6] = {
+    GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_CENTER,
+    GST_AUDIO_CHANNEL_POSITION_LFE1,
+    GST_AUDIO_CHANNEL_POSITION_REAR_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_REAR_RIGHT
+  };
+  GstHarness *h;
+  GstBuffer *in, *out;
+  GstMapInfo inmap, outmap;
+  guint64 mask;
+  gint c, i;
+
+  fail_unless (gst_audio_channel_positions_to_mask (pos, 6, FALSE, &mask));
+  h = setup_freeverb (GST_AUDIO_NE (F32), 6, mask, 6, mask);
+
+  in = make_float_buffer (6, 4800, FALSE);
+  out = gst_harness_push_and_pull (h, gst_buffer_ref (in));
+  fail_unless_equals_int (gst_buffer_get_size (out), gst_buffer_get_size (in));
+
+  /* the LFE channel is passed through, the others are changed */
+  gst_buffer_map (in, &inmap, GST_MAP_READ);
+  gst_buffer_map (out, &outmap, GST_MAP_READ);
+  for (i = 0; i < 4800; i++)
+    fail_unless_equals_float (((gfloat *) outmap.data)[i * 6 + 3],
+        ((gfloat *) inmap.data)[i * 6 + 3]);
+  for (c = 0; c < 6; c++) {
+    if (c == 3)
+      continue;
+    fail_unless (((gfloat *) outmap.data)[4000 * 6 + c] !=
+        ((gfloat *) inmap.data)[4000 * 6 + c]);
+  }
+  gst_buffer_unmap (in, &inmap);
+  gst_buffer_unmap (out, &outmap);
+  gst_buffer_unref (in);
+  gst_buffer_unref (out);
+
+  /* the reverb keeps ringing in all channels but the LFE */
+  out = gst_harness_push_and_pull (h, make_float_buffer (6, 4800, TRUE));
+  for (c = 0; c < 6; c++) {
+    if (c == 3)
+      fail_unless (channel_energy (out, 6, c) == 0.0);
+    else
+      fail_unless (channel_energy (out, 6, c) > 0.0);
+  }
+  gst_buffer_unref (out);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_drain_to_gap)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint i;
+
+  h = setup_freeverb (GST_AUDIO_NE (S16), 2, 0, 2, 0);
+
+  buf = gst_buffer_new_allocate (NULL, 4800 * 2 * sizeof (gint16), NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  for (i = 0; i < 4800 * 2; i++)
+    ((gint16 *) map.data)[i] = g_random_int_range (-16384, 16384);
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (gst_harness_push_and_pull (h, buf));
+
+  /* the tail decays to silence and the output is then marked as gap */
+  for (i = 0; i < 200; i++) {
+    buf = gst_buffer_new_allocate (NULL, 4800 * 2 * sizeof (gint16), NULL);
+    gst_buffer_memset (buf, 0, 0, 4800 * 2 * sizeof (gint16));
+    buf = gst_harness_push_and_pull (h, buf);
+    if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_GAP)) {
+      gst_buffer_unref (buf);
+      break;
+    }
+    gst_buffer_unref (buf);
+  }
+  fail_unless (i < 200);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_channel_speed)
+{
+  static const gint layouts[] = { 2, 6, 8 };
+  GstHarness *h;
+  GstBuffer *buf;
+  gint64 start, elapsed;
+  guint i, l, channels;
+
+  for (l = 0; l < G_N_ELEMENTS (layouts); l++) {
+    channels = layouts[l];
+    h = setup_freeverb (GST_AUDIO_NE (F32), channels,
+        gst_audio_channel_get_fallback_mask (channels), channels,
+        gst_audio_channel_get_fallback_mask (channels));
+    buf = make_float_buffer (channels, 1024, FALSE);
+
+    /* 10 seconds of audio */
+    start = g_get_monotonic_time ();
+    for (i = 0; i < 10 * RATE / 1024; i++)
+      gst_buffer_unref (gst_harness_push_and_pull (h, gst_buffer_copy (buf)));
+    elapsed = g_get_monotonic_time () - start;
+    GST_INFO ("%u channels: 10 s at %d Hz in %" G_GINT64_FORMAT " us, "
+        "%.3f %% CPU per channel", channels, RATE, elapsed,
+        elapsed / (10.0 * 1e6 * channels) * 100.0);
+
+    gst_buffer_unref (buf);
+    gst_harness_teardown (h);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+freeverb_suite (void)
+{
+  Suite *s = suite_create ("freeverb");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_mono_to_stereo);
+  tcase_add_test (tc_chain, test_surround_5_1);
+  tcase_add_test (tc_chain, test_drain_to_gap);
+  tcase_add_test (tc_chain, test_channel_speed);
+
+  return s;
+}
+
+GST_CHECK_MAIN (freeverb);
@@ -278,6 +278,93 @@ GST_START_TEST (test_audio_in_one_buffer)
 
 GST_END_TEST;
 
+/* buffer payloads are pushed in the memories they arrived in, and their
+ * CRC is checked without merging them */
+GST_START_TEST (test_payload_not_copied)
+{
+  GstCaps *caps;
+  GstElement *gdpdepay;
+  GstBuffer *buffer, *inbuffer, *outbuffer;
+  GstMemory *payload, *mem;
+  GstEvent *event;
+  GstSegment segment;
+  GstDPHeaderFlag flags;
+  GstMapInfo map;
+
+  gdpdepay = setup_gdpdepay ();
+
+  fail_unless (gst_element_set_state (gdpdepay,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_empty_simple ("application/x-gdp");
+  gst_check_setup_events (mysrcpad, gdpdepay, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  flags = GST_DP_HEADER_FLAG_CRC_HEADER | GST_DP_HEADER_FLAG_CRC_PAYLOAD;
+
+  event = gst_event_new_stream_start ("s-s-id-1234");
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          gst_dp_payload_event (event, flags)), GST_FLOW_OK);
+  gst_event_unref (event);
+
+  caps = gst_caps_from_string (AUDIO_CAPS_STRING);
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          gst_dp_payload_caps (caps, flags)), GST_FLOW_OK);
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  event = gst_event_new_segment (&segment);
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          gst_dp_payload_event (event, flags)), GST_FLOW_OK);
+  gst_event_unref (event);
+
+  /* the payload spans two memories */
+  buffer = gst_buffer_new_and_alloc (4);
+  gst_buffer_fill (buffer, 0, "f00d", 4);
+  gst_buffer_append_memory (buffer, gst_allocator_alloc (NULL, 4, NULL));
+  gst_buffer_memset (buffer, 4, 0xaa, 4);
+  GST_BUFFER_TIMESTAMP (buffer) = GST_SECOND;
+  payload = gst_memory_ref (gst_buffer_peek_memory (buffer, 0));
+  inbuffer = gst_dp_payload_buffer (buffer, flags);
+  gst_buffer_unref (buffer);
+
+  fail_unless_equals_int (gst_pad_push (mysrcpad, inbuffer), GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  outbuffer = GST_BUFFER_CAST (buffers->data);
+  fail_unless_equals_int (gst_buffer_get_size (outbuffer), 8);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (outbuffer), GST_SECOND);
+  fail_unless_equals_int (gst_buffer_n_memory (outbuffer), 2);
+  mem = gst_buffer_peek_memory (outbuffer, 0);
+  fail_unless (mem == payload || mem->parent == payload);
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless (memcmp (map.data, "f00d\xaa\xaa\xaa\xaa", 8) == 0);
+  gst_buffer_unmap (outbuffer, &map);
+  gst_memory_unref (payload);
+
+  /* a corrupted payload is still caught */
+  buffer = gst_buffer_new_and_alloc (4);
+  gst_buffer_fill (buffer, 0, "f00d", 4);
+  inbuffer = gst_dp_payload_buffer (buffer, flags);
+  gst_buffer_unref (buffer);
+  inbuffer = gst_buffer_make_writable (inbuffer);
+  gst_buffer_memset (inbuffer, GST_DP_HEADER_LENGTH, 0, 1);
+  fail_unless_equals_int (gst_pad_push (mysrcpad, inbuffer), GST_FLOW_ERROR);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  fail_unless (gst_element_set_state (gdpdepay,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+  ASSERT_OBJECT_REFCOUNT (gdpdepay, "gdpdepay", 1);
+  cleanup_gdpdepay (gdpdepay);
+}
+
+GST_END_TEST;
+
 static GstStaticPadTemplate shsinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -410,6 +497,7 @@ gdpdepay_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_audio_per_byte);
   tcase_add_test (tc_chain, test_audio_in_one_buffer);
+  tcase_add_test (tc_chain, test_payload_not_copied);
   tcase_add_test (tc_chain, test_streamheader);
 
   return s;
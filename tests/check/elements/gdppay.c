@@ -557,6 +557,69 @@ GST_START_TEST (test_crc)
 GST_END_TEST;
 
 
+GST_START_TEST (test_buffer_list)
+{
+  GstCaps *caps;
+  GstElement *gdppay;
+  GstBufferList *list;
+  GstBuffer *inbuffer, *outbuffer;
+  GstMemory *payloads[3];
+  gint i;
+
+  gdppay = setup_gdppay ();
+
+  fail_unless (gst_element_set_state (gdppay,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (AUDIO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, gdppay, caps, GST_FORMAT_TIME);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++) {
+    inbuffer = gst_buffer_new_and_alloc (4);
+    gst_buffer_memset (inbuffer, 0, i, 4);
+    GST_BUFFER_TIMESTAMP (inbuffer) = i * GST_SECOND;
+    payloads[i] = gst_buffer_peek_memory (inbuffer, 0);
+    gst_buffer_list_add (list, inbuffer);
+  }
+
+  /* pushing gives away my reference */
+  fail_unless (gst_pad_push_list (mysrcpad, list) == GST_FLOW_OK);
+
+  /* stream-start, caps and new_segment, then the three buffers */
+  fail_unless_equals_int (g_list_length (buffers), 6);
+  check_stream_start_buffer (1);
+  check_caps_buffer (1, caps);
+  check_segment_buffer (1);
+
+  for (i = 0; i < 3; i++) {
+    fail_if ((outbuffer = (GstBuffer *) buffers->data) == NULL);
+    buffers = g_list_remove (buffers, outbuffer);
+    fail_unless_equals_int (gst_buffer_get_size (outbuffer),
+        GST_DP_HEADER_LENGTH + 4);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (outbuffer),
+        i * GST_SECOND);
+
+    /* the header is a memory of its own, the payload is not copied */
+    fail_unless_equals_int (gst_buffer_n_memory (outbuffer), 2);
+    fail_unless_equals_int (gst_buffer_peek_memory (outbuffer, 0)->size,
+        GST_DP_HEADER_LENGTH);
+    fail_unless (gst_buffer_peek_memory (outbuffer, 1) == payloads[i]);
+    gst_buffer_unref (outbuffer);
+  }
+
+  fail_unless (gst_element_set_state (gdppay,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  gst_caps_unref (caps);
+  ASSERT_OBJECT_REFCOUNT (gdppay, "gdppay", 1);
+  cleanup_gdppay (gdppay);
+}
+
+GST_END_TEST;
+
+
 static Suite *
 gdppay_suite (void)
 {
@@ -569,6 +632,7 @@ gdppay_suite (void)
   tcase_add_test (tc_chain, test_first_no_new_segment);
   tcase_add_test (tc_chain, test_streamheader);
   tcase_add_test (tc_chain, test_crc);
+  tcase_add_test (tc_chain, test_buffer_list);
 
   return s;
 }
@@ -0,0 +1,232 @@
+/* GStreamer unit test for the Smooth Streaming manifest
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "../../ext/smoothstreaming/gstmssmanifest.c"
+#include "../../ext/smoothstreaming/gstmssfragmentparser.c"
+#undef GST_CAT_DEFAULT
+
+#include <gst/check/gstcheck.h>
+
+GST_DEBUG_CATEGORY (mssdemux_debug);
+
+static GstMssManifest *
+parse_manifest (const gchar * xml)
+{
+  GstBuffer *buffer;
+  GstMssManifest *manifest;
+
+  buffer = gst_buffer_new_wrapped (g_strdup (xml), strlen (xml));
+  manifest = gst_mss_manifest_new (buffer);
+  gst_buffer_unref (buffer);
+  fail_unless (manifest != NULL);
+
+  return manifest;
+}
+
+/*
+ * Test that the fragments of the manifest are stored as runs and that
+ * seeking and iterating over them gives the fragments of the manifest
+ *
+ */
+GST_START_TEST (mss_manifest_fragment_runs)
+{
+  const gchar *xml =
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<SmoothStreamingMedia MajorVersion=\"2\" MinorVersion=\"0\" Duration=\"0\">"
+      "<StreamIndex Type=\"video\" QualityLevels=\"1\" Chunks=\"6\" Url=\"QualityLevels({bitrate})/Fragments(video={start time})\">"
+      "<QualityLevel Index=\"0\" Bitrate=\"480111\" FourCC=\"H264\" MaxWidth=\"1024\" MaxHeight=\"436\" CodecPrivateData=\"000\" />"
+      "<c n=\"0\" d=\"10000000\" />"
+      "<c n=\"1\" d=\"10000000\" />"
+      "<c n=\"2\" d=\"10000000\" r=\"2\" />"
+      "<c n=\"4\" d=\"5000000\" />"
+      "<c n=\"5\" />"
+      "<c n=\"6\" t=\"55000000\" d=\"10000000\" />"
+      "</StreamIndex>" "</SmoothStreamingMedia>";
+  const guint64 times[] = { 0, 10000000, 20000000, 30000000, 40000000,
+    45000000, 55000000
+  };
+  GstMssManifest *manifest;
+  GstMssStream *stream;
+  guint64 final_time;
+  gchar *url;
+  guint i;
+
+  manifest = parse_manifest (xml);
+  stream = gst_mss_manifest_get_streams (manifest)->data;
+  gst_mss_stream_set_active (stream, TRUE);
+
+  /* 4 fragments of 1s, one of 0.5s, then 2 of 1s, the duration of the first
+   * one being deduced from the start of the second one */
+  fail_unless_equals_int (stream->fragments->len, 3);
+  fail_unless_equals_int (GST_MSS_STREAM_FRAGMENT (stream, 0)->repetitions, 4);
+  fail_unless_equals_int (GST_MSS_STREAM_FRAGMENT (stream, 1)->repetitions, 1);
+  fail_unless_equals_uint64 (GST_MSS_STREAM_FRAGMENT (stream, 1)->duration,
+      5000000);
+  fail_unless_equals_int (GST_MSS_STREAM_FRAGMENT (stream, 2)->repetitions, 2);
+  fail_unless_equals_uint64 (gst_mss_manifest_get_duration (manifest),
+      65000000);
+
+  for (i = 0; i < G_N_ELEMENTS (times); i++) {
+    gchar *expected = g_strdup_printf ("QualityLevels(480111)/"
+        "Fragments(video=%" G_GUINT64_FORMAT ")", times[i]);
+
+    fail_unless (gst_mss_stream_has_next_fragment (stream));
+    fail_unless (gst_mss_stream_get_fragment_url (stream, &url) == GST_FLOW_OK);
+    fail_unless_equals_string (url, expected);
+    fail_unless_equals_uint64 (gst_mss_stream_get_fragment_gst_timestamp
+        (stream), times[i] * 100);
+    g_free (expected);
+    g_free (url);
+
+    gst_mss_stream_advance_fragment (stream);
+  }
+  fail_if (gst_mss_stream_has_next_fragment (stream));
+
+  /* inside a fragment of each run */
+  gst_mss_stream_seek (stream, TRUE, 0, 2500 * GST_MSECOND, &final_time);
+  fail_unless_equals_uint64 (final_time, 2 * GST_SECOND);
+  gst_mss_stream_seek (stream, TRUE, GST_SEEK_FLAG_SNAP_AFTER,
+      4200 * GST_MSECOND, &final_time);
+  fail_unless_equals_uint64 (final_time, 4500 * GST_MSECOND);
+  gst_mss_stream_seek (stream, TRUE, 0, 6 * GST_SECOND, &final_time);
+  fail_unless_equals_uint64 (final_time, 5500 * GST_MSECOND);
+
+  /* at a run limit in reverse playback */
+  gst_mss_stream_seek (stream, FALSE, 0, 4 * GST_SECOND, &final_time);
+  fail_unless_equals_uint64 (final_time, 3 * GST_SECOND);
+  fail_unless (gst_mss_stream_regress_fragment (stream) == GST_FLOW_OK);
+  fail_unless_equals_uint64 (gst_mss_stream_get_fragment_gst_timestamp
+      (stream), 2 * GST_SECOND);
+
+  gst_mss_manifest_free (manifest);
+}
+
+GST_END_TEST;
+
+#define SOAK_DVR_WINDOW (2 * 3600 * GST_SECOND)
+#define SOAK_DURATION (7 * 24 * 3600 * GST_SECOND)
+
+/*
+ * Simulate a week of a live stream with a 2 hours DVR window, the fragments
+ * being announced one by one by the tfrf boxes. The video fragments all have
+ * the same duration and the audio ones alternate between two durations so
+ * that they can't be stored as runs.
+ *
+ */
+GST_START_TEST (mss_manifest_live_soak)
+{
+  const gchar *xml =
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<SmoothStreamingMedia MajorVersion=\"2\" MinorVersion=\"0\" Duration=\"0\""
+      " IsLive=\"TRUE\" LookAheadFragmentCount=\"2\" DVRWindowLength=\"72000000000\">"
+      "<StreamIndex Type=\"video\" QualityLevels=\"1\" Chunks=\"0\" Url=\"QualityLevels({bitrate})/Fragments(video={start time})\">"
+      "<QualityLevel Index=\"0\" Bitrate=\"480111\" FourCC=\"H264\" MaxWidth=\"1024\" MaxHeight=\"436\" CodecPrivateData=\"000\" />"
+      "<c t=\"0\" d=\"20000000\" />"
+      "</StreamIndex>"
+      "<StreamIndex Type=\"audio\" Language=\"eng\" QualityLevels=\"1\" Chunks=\"0\" Url=\"QualityLevels({bitrate})/Fragments(audio_eng={start time})\">"
+      "<QualityLevel Index=\"0\" Bitrate=\"200029\" FourCC=\"AACL\" SamplingRate=\"48000\" Channels=\"2\" BitsPerSample=\"16\" PacketSize=\"4\" AudioTag=\"255\" CodecPrivateData=\"1190\" />"
+      "<c t=\"0\" d=\"20000001\" />" "</StreamIndex>" "</SmoothStreamingMedia>";
+  GstMssManifest *manifest;
+  GstMssStream *video, *audio;
+  guint64 video_time = 20000000, audio_time = 20000001;
+  guint64 final_time, max_len = 0;
+  gint64 start, stop;
+  GstClockTime elapsed;
+  guint i, count;
+
+  manifest = parse_manifest (xml);
+  video = gst_mss_manifest_get_streams (manifest)->data;
+  audio = gst_mss_manifest_get_streams (manifest)->next->data;
+  gst_mss_stream_set_active (video, TRUE);
+  gst_mss_stream_set_active (audio, TRUE);
+  fail_unless (video->has_live_fragments && audio->has_live_fragments);
+
+  elapsed = gst_util_get_timestamp ();
+  count = SOAK_DURATION / (2 * GST_SECOND);
+  for (i = 1; i < count; i++) {
+    guint64 audio_duration = (i % 2) ? 19999999 : 20000001;
+
+    /* the next fragment is announced while downloading the current one */
+    gst_mss_stream_add_live_fragment (video, video_time, 20000000);
+    gst_mss_stream_add_live_fragment (audio, audio_time, audio_duration);
+
+    fail_unless (gst_mss_stream_advance_fragment (video) == GST_FLOW_OK);
+    fail_unless (gst_mss_stream_advance_fragment (audio) == GST_FLOW_OK);
+    fail_unless_equals_uint64 (gst_mss_stream_get_fragment_gst_timestamp
+        (video), video_time * 100);
+    fail_unless_equals_uint64 (gst_mss_stream_get_fragment_gst_timestamp
+        (audio), audio_time * 100);
+
+    video_time += 20000000;
+    audio_time += audio_duration;
+
+    /* the video fragments are a single run of at most the DVR window */
+    fail_unless_equals_int (video->fragments->len, 1);
+    fail_unless (GST_MSS_STREAM_FRAGMENT (video, 0)->repetitions <=
+        SOAK_DVR_WINDOW / (2 * GST_SECOND) + 1);
+    max_len = MAX (max_len, audio->fragments->len);
+  }
+  elapsed = gst_util_get_timestamp () - elapsed;
+  GST_INFO ("%u fragments added in %" GST_TIME_FORMAT ", at most %"
+      G_GUINT64_FORMAT " audio runs", count, GST_TIME_ARGS (elapsed),
+      max_len);
+
+  /* the audio fragments are kept for at most twice the DVR window */
+  fail_unless (max_len <= 2 * (SOAK_DVR_WINDOW / (2 * GST_SECOND)) + 2);
+  fail_unless (max_len >= SOAK_DVR_WINDOW / (2 * GST_SECOND));
+
+  fail_unless (gst_mss_manifest_get_live_seek_range (manifest, &start, &stop));
+  fail_unless_equals_uint64 (stop, SOAK_DURATION);
+  fail_unless_equals_uint64 (stop - start, SOAK_DVR_WINDOW);
+
+  /* seeking back in the DVR window */
+  gst_mss_stream_seek (video, TRUE, 0, stop - 3600 * GST_SECOND - GST_MSECOND,
+      &final_time);
+  fail_unless_equals_uint64 (final_time, stop - 3602 * GST_SECOND);
+  gst_mss_stream_seek (audio, TRUE, 0, stop - 3600 * GST_SECOND, &final_time);
+  fail_unless (final_time <= stop - 3600 * GST_SECOND);
+  fail_unless (final_time > stop - 3602 * GST_SECOND);
+
+  /* and to the live edge */
+  gst_mss_stream_seek (video, TRUE, 0, stop - GST_MSECOND, &final_time);
+  fail_unless_equals_uint64 (final_time, stop - 2 * GST_SECOND);
+  fail_unless (gst_mss_stream_has_next_fragment (video));
+
+  gst_mss_manifest_free (manifest);
+}
+
+GST_END_TEST;
+
+static Suite *
+mss_manifest_suite (void)
+{
+  Suite *s = suite_create ("mssmanifest");
+  TCase *tc_chain = tcase_create ("general");
+
+  GST_DEBUG_CATEGORY_INIT (mssdemux_debug, "mssdemux", 0, "mssdemux test");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, mss_manifest_fragment_runs);
+  tcase_add_test (tc_chain, mss_manifest_live_soak);
+
+  return s;
+}
+
+GST_CHECK_MAIN (mss_manifest);
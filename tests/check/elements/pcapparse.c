@@ -1,6 +1,8 @@
 #include "parser.h"
+#include <glib/gstdio.h>
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstharness.h>
+#include <string.h>
 
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -115,6 +117,520 @@ GST_START_TEST (test_parse_zerosize_frames)
 
 GST_END_TEST;
 
+/* an Ethernet frame carrying a UDP datagram over IPv4 or IPv6, the outer
+ * tag is an 802.1ad one if there are several */
+static GByteArray *
+make_udp_frame (const guint16 * vlans, guint n_vlans, gboolean ipv6,
+    guint16 src_port, guint16 dst_port, const gchar * payload)
+{
+  GByteArray *frame = g_byte_array_new ();
+  gsize len = strlen (payload);
+  guint8 hdr[40];
+  guint i;
+
+  memset (hdr, 0, sizeof (hdr));
+  g_byte_array_append (frame, hdr, 12);
+  for (i = 0; i < n_vlans; i++) {
+    GST_WRITE_UINT16_BE (hdr, i == 0 && n_vlans > 1 ? 0x88a8 : 0x8100);
+    GST_WRITE_UINT16_BE (hdr + 2, vlans[i]);
+    g_byte_array_append (frame, hdr, 4);
+  }
+  GST_WRITE_UINT16_BE (hdr, ipv6 ? 0x86dd : 0x0800);
+  g_byte_array_append (frame, hdr, 2);
+
+  memset (hdr, 0, sizeof (hdr));
+  if (ipv6) {
+    /* 2001:db8::1 > 2001:db8::2 */
+    hdr[0] = 0x60;
+    GST_WRITE_UINT16_BE (hdr + 4, 8 + len);
+    hdr[6] = 17;
+    hdr[7] = 64;
+    GST_WRITE_UINT32_BE (hdr + 8, 0x20010db8);
+    hdr[23] = 1;
+    GST_WRITE_UINT32_BE (hdr + 24, 0x20010db8);
+    hdr[39] = 2;
+    g_byte_array_append (frame, hdr, 40);
+  } else {
+    /* 10.0.0.1 > 10.0.0.2 */
+    hdr[0] = 0x45;
+    GST_WRITE_UINT16_BE (hdr + 2, 20 + 8 + len);
+    hdr[8] = 64;
+    hdr[9] = 17;
+    GST_WRITE_UINT32_BE (hdr + 12, 0x0a000001);
+    GST_WRITE_UINT32_BE (hdr + 16, 0x0a000002);
+    g_byte_array_append (frame, hdr, 20);
+  }
+
+  GST_WRITE_UINT16_BE (hdr, src_port);
+  GST_WRITE_UINT16_BE (hdr + 2, dst_port);
+  GST_WRITE_UINT16_BE (hdr + 4, 8 + len);
+  GST_WRITE_UINT16_BE (hdr + 6, 0);
+  g_byte_array_append (frame, hdr, 8);
+  g_byte_array_append (frame, (const guint8 *) payload, len);
+
+  return frame;
+}
+
+static GByteArray *
+new_pcap (void)
+{
+  GByteArray *capture = g_byte_array_new ();
+  guint8 hdr[24] = { 0, };
+
+  GST_WRITE_UINT32_LE (hdr, 0xa1b2c3d4);
+  GST_WRITE_UINT16_LE (hdr + 4, 2);
+  GST_WRITE_UINT16_LE (hdr + 6, 4);
+  GST_WRITE_UINT32_LE (hdr + 16, 65535);
+  GST_WRITE_UINT32_LE (hdr + 20, 1);
+  g_byte_array_append (capture, hdr, sizeof (hdr));
+
+  return capture;
+}
+
+static void
+append_pcap_packet (GByteArray * capture, GstClockTime ts, GByteArray * frame)
+{
+  guint8 hdr[16];
+
+  GST_WRITE_UINT32_LE (hdr, ts / GST_SECOND);
+  GST_WRITE_UINT32_LE (hdr + 4, (ts % GST_SECOND) / GST_USECOND);
+  GST_WRITE_UINT32_LE (hdr + 8, frame->len);
+  GST_WRITE_UINT32_LE (hdr + 12, frame->len);
+  g_byte_array_append (capture, hdr, sizeof (hdr));
+  g_byte_array_append (capture, frame->data, frame->len);
+  g_byte_array_unref (frame);
+}
+
+/* a section header and an Ethernet interface with nanosecond timestamps */
+static GByteArray *
+new_pcapng (void)
+{
+  GByteArray *capture = g_byte_array_new ();
+  guint8 shb[28], idb[32];
+
+  GST_WRITE_UINT32_LE (shb, 0x0a0d0d0a);
+  GST_WRITE_UINT32_LE (shb + 4, sizeof (shb));
+  GST_WRITE_UINT32_LE (shb + 8, 0x1a2b3c4d);
+  GST_WRITE_UINT16_LE (shb + 12, 1);
+  GST_WRITE_UINT16_LE (shb + 14, 0);
+  memset (shb + 16, 0xff, 8);
+  GST_WRITE_UINT32_LE (shb + 24, sizeof (shb));
+  g_byte_array_append (capture, shb, sizeof (shb));
+
+  memset (idb, 0, sizeof (idb));
+  GST_WRITE_UINT32_LE (idb, 1);
+  GST_WRITE_UINT32_LE (idb + 4, sizeof (idb));
+  GST_WRITE_UINT16_LE (idb + 8, 1);
+  GST_WRITE_UINT32_LE (idb + 12, 65535);
+  /* if_tsresol = 9, then opt_endofopt */
+  GST_WRITE_UINT16_LE (idb + 16, 9);
+  GST_WRITE_UINT16_LE (idb + 18, 1);
+  idb[20] = 9;
+  GST_WRITE_UINT32_LE (idb + 28, sizeof (idb));
+  g_byte_array_append (capture, idb, sizeof (idb));
+
+  return capture;
+}
+
+static void
+append_pcapng_packet (GByteArray * capture, GstClockTime ts,
+    GByteArray * frame)
+{
+  guint8 hdr[28], pad[4] = { 0, }, trailer[4];
+  guint32 len = 32 + GST_ROUND_UP_4 (frame->len);
+
+  GST_WRITE_UINT32_LE (hdr, 6);
+  GST_WRITE_UINT32_LE (hdr + 4, len);
+  GST_WRITE_UINT32_LE (hdr + 8, 0);
+  GST_WRITE_UINT32_LE (hdr + 12, ts >> 32);
+  GST_WRITE_UINT32_LE (hdr + 16, ts & 0xffffffff);
+  GST_WRITE_UINT32_LE (hdr + 20, frame->len);
+  GST_WRITE_UINT32_LE (hdr + 24, frame->len);
+  GST_WRITE_UINT32_LE (trailer, len);
+  g_byte_array_append (capture, hdr, sizeof (hdr));
+  g_byte_array_append (capture, frame->data, frame->len);
+  g_byte_array_append (capture, pad, GST_ROUND_UP_4 (frame->len) - frame->len);
+  g_byte_array_append (capture, trailer, sizeof (trailer));
+  g_byte_array_unref (frame);
+}
+
+/* In pull mode the capture is read from a file by filesrc, in push mode it
+ * is pushed in small pieces through an appsrc.  @desc is the rest of the
+ * pipeline, starting with pcapparse. */
+static GstElement *
+setup_pipeline (GByteArray * capture, gboolean push_mode, const gchar * desc,
+    gchar ** location)
+{
+  GstElement *pipeline;
+  gchar *full_desc;
+  gint fd;
+
+  if (push_mode) {
+    *location = NULL;
+    full_desc = g_strdup_printf ("appsrc name=src caps=raw/x-pcap ! %s", desc);
+  } else {
+    fd = g_file_open_tmp ("pcapparse-XXXXXX", location, NULL);
+    fail_unless (fd >= 0);
+    g_close (fd, NULL);
+    fail_unless (g_file_set_contents (*location, (const gchar *) capture->data,
+            capture->len, NULL));
+    full_desc = g_strdup_printf ("filesrc location=%s ! %s", *location, desc);
+  }
+
+  pipeline = gst_parse_launch (full_desc, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (full_desc);
+
+  return pipeline;
+}
+
+static void
+run_pipeline (GstElement * pipeline, GByteArray * capture, gboolean push_mode,
+    gsize chunk_size)
+{
+  GstBus *bus;
+  GstMessage *msg;
+
+  fail_if (gst_element_set_state (pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+
+  if (push_mode) {
+    GstElement *src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+    GstFlowReturn flow;
+    gsize offset;
+
+    for (offset = 0; offset < capture->len; offset += chunk_size) {
+      gsize size = MIN (chunk_size, capture->len - offset);
+      GstBuffer *buf;
+
+      buf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+          capture->data + offset, size, 0, size, NULL, NULL);
+      g_signal_emit_by_name (src, "push-buffer", buf, &flow);
+      gst_buffer_unref (buf);
+      fail_unless_equals_int (flow, GST_FLOW_OK);
+    }
+    g_signal_emit_by_name (src, "end-of-stream", &flow);
+    gst_object_unref (src);
+  }
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+}
+
+static void
+teardown_pipeline (GstElement * pipeline, gchar * location)
+{
+  gst_object_unref (pipeline);
+  if (location) {
+    g_unlink (location);
+    g_free (location);
+  }
+}
+
+static void
+on_handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  g_ptr_array_add (user_data, gst_buffer_ref (buffer));
+}
+
+static GPtrArray *
+collect_buffers (GstElement * pipeline, const gchar * sink_name)
+{
+  GstElement *sink = gst_bin_get_by_name (GST_BIN (pipeline), sink_name);
+  GPtrArray *buffers;
+
+  buffers = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (on_handoff), buffers);
+  gst_object_unref (sink);
+
+  return buffers;
+}
+
+/* runs @capture through "pcapparse @props" and returns the output buffers */
+static GPtrArray *
+parse_capture (GByteArray * capture, gboolean push_mode, const gchar * props)
+{
+  GstElement *pipeline;
+  GPtrArray *buffers;
+  gchar *desc, *location;
+
+  desc = g_strdup_printf ("pcapparse %s ! fakesink name=sink", props);
+  pipeline = setup_pipeline (capture, push_mode, desc, &location);
+  g_free (desc);
+
+  buffers = collect_buffers (pipeline, "sink");
+  run_pipeline (pipeline, capture, push_mode, 7);
+  teardown_pipeline (pipeline, location);
+
+  return buffers;
+}
+
+static void
+check_payload (GstBuffer * buffer, const gchar * payload)
+{
+  fail_unless_equals_int (gst_buffer_get_size (buffer), strlen (payload));
+  fail_unless (gst_buffer_memcmp (buffer, 0, payload, strlen (payload)) == 0);
+}
+
+GST_START_TEST (test_parse_pcapng_ipv6)
+{
+  GByteArray *capture = new_pcapng ();
+  GPtrArray *buffers;
+  gint push_mode;
+
+  append_pcapng_packet (capture, 1500 * GST_MSECOND + 7,
+      make_udp_frame (NULL, 0, TRUE, 4000, 5000, "hello"));
+  append_pcapng_packet (capture, 2 * GST_SECOND,
+      make_udp_frame (NULL, 0, FALSE, 4000, 5000, "world"));
+
+  for (push_mode = 0; push_mode < 2; push_mode++) {
+    buffers = parse_capture (capture, push_mode, "");
+    fail_unless_equals_int (buffers->len, 2);
+    check_payload (g_ptr_array_index (buffers, 0), "hello");
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (g_ptr_array_index (buffers, 0)),
+        1500 * GST_MSECOND + 7);
+    check_payload (g_ptr_array_index (buffers, 1), "world");
+    g_ptr_array_unref (buffers);
+
+    buffers = parse_capture (capture, push_mode, "filter=ip6");
+    fail_unless_equals_int (buffers->len, 1);
+    check_payload (g_ptr_array_index (buffers, 0), "hello");
+    g_ptr_array_unref (buffers);
+  }
+
+  g_byte_array_unref (capture);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parse_filter)
+{
+  const guint16 qinq[] = { 100, 200 }, vlan[] = { 300 };
+  const struct
+  {
+    const gchar *props;
+    const gchar *payloads;
+  } cases[] = {
+    {"", "a bb ccc"},
+    {"filter=\"vlan 200\"", "a"},
+    {"filter=\"udp and (port 5002 or dst port 5004)\"", "bb ccc"},
+    {"filter=\"not vlan and ip6\"", "ccc"},
+    {"filter=\"src net 10.0.0.0/8 and not port 5000\"", "bb"},
+    {"src-ip=\"2001:db8::1\"", "ccc"},
+    {"dst-port=5002", "bb"},
+    {"filter=\"port\"", ""},
+  };
+  GByteArray *capture = new_pcap ();
+  gint i, j, push_mode;
+
+  append_pcap_packet (capture, 0,
+      make_udp_frame (qinq, 2, FALSE, 4000, 5000, "a"));
+  append_pcap_packet (capture, GST_MSECOND,
+      make_udp_frame (vlan, 1, FALSE, 4000, 5002, "bb"));
+  append_pcap_packet (capture, 2 * GST_MSECOND,
+      make_udp_frame (NULL, 0, TRUE, 4000, 5004, "ccc"));
+
+  for (push_mode = 0; push_mode < 2; push_mode++) {
+    for (i = 0; i < G_N_ELEMENTS (cases); i++) {
+      gchar **payloads = g_strsplit (cases[i].payloads, " ", -1);
+      GPtrArray *buffers;
+
+      GST_INFO ("filter %s, push mode %d", cases[i].props, push_mode);
+
+      buffers = parse_capture (capture, push_mode, cases[i].props);
+      fail_unless_equals_int (buffers->len,
+          cases[i].payloads[0] ? g_strv_length (payloads) : 0);
+      for (j = 0; j < buffers->len; j++)
+        check_payload (g_ptr_array_index (buffers, j), payloads[j]);
+
+      g_ptr_array_unref (buffers);
+      g_strfreev (payloads);
+    }
+  }
+
+  g_byte_array_unref (capture);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parse_request_pads)
+{
+  GByteArray *capture = new_pcap ();
+  GPtrArray *buffers[3];
+  GstElement *pipeline, *pcapparse;
+  gchar *location, payload[16];
+  gint i, j, push_mode;
+
+  for (i = 0; i < 30; i++) {
+    g_snprintf (payload, sizeof (payload), "pkt-%d", i);
+    append_pcap_packet (capture, i * GST_MSECOND,
+        make_udp_frame (NULL, 0, i % 2, 4000, 5000 + 2 * (i % 3), payload));
+  }
+
+  for (push_mode = 0; push_mode < 2; push_mode++) {
+    pipeline = setup_pipeline (capture, push_mode,
+        "pcapparse name=p p.src_0 ! fakesink name=s0 "
+        "p.src_1 ! fakesink name=s1 p.src ! fakesink name=s2", &location);
+
+    pcapparse = gst_bin_get_by_name (GST_BIN (pipeline), "p");
+    gst_child_proxy_set (GST_CHILD_PROXY (pcapparse),
+        "src_0::filter", "udp dst port 5000",
+        "src_1::filter", "dst port 5002 or dst port 5000", NULL);
+    gst_object_unref (pcapparse);
+
+    buffers[0] = collect_buffers (pipeline, "s0");
+    buffers[1] = collect_buffers (pipeline, "s1");
+    buffers[2] = collect_buffers (pipeline, "s2");
+
+    run_pipeline (pipeline, capture, push_mode, 100);
+    teardown_pipeline (pipeline, location);
+
+    /* each packet goes to the first pad that matches it */
+    for (i = 0; i < 3; i++) {
+      fail_unless_equals_int (buffers[i]->len, 10);
+      for (j = 0; j < 10; j++) {
+        g_snprintf (payload, sizeof (payload), "pkt-%d", j * 3 + i);
+        check_payload (g_ptr_array_index (buffers[i], j), payload);
+      }
+      g_ptr_array_unref (buffers[i]);
+    }
+  }
+
+  g_byte_array_unref (capture);
+}
+
+GST_END_TEST;
+
+/* in pull mode, seeking in time restarts from the requested packet */
+GST_START_TEST (test_parse_pull_seek)
+{
+  GByteArray *capture = new_pcap ();
+  GstElement *pipeline;
+  GPtrArray *buffers;
+  GstMessage *msg;
+  GstQuery *query;
+  GstBus *bus;
+  gchar *location, payload[16];
+  gboolean seekable;
+  gint i;
+
+  for (i = 0; i < 10; i++) {
+    g_snprintf (payload, sizeof (payload), "pkt-%d", i);
+    append_pcap_packet (capture, 1000 * GST_SECOND + i * 100 * GST_MSECOND,
+        make_udp_frame (NULL, 0, FALSE, 4000, 5000, payload));
+  }
+
+  pipeline = setup_pipeline (capture, FALSE,
+      "pcapparse ! fakesink name=sink sync=false", &location);
+  buffers = collect_buffers (pipeline, "sink");
+  bus = gst_element_get_bus (pipeline);
+
+  fail_if (gst_element_set_state (pipeline, GST_STATE_PAUSED) ==
+      GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_ASYNC_DONE);
+  gst_message_unref (msg);
+
+  query = gst_query_new_seeking (GST_FORMAT_TIME);
+  fail_unless (gst_element_query (pipeline, query));
+  gst_query_parse_seeking (query, NULL, &seekable, NULL, NULL);
+  fail_unless (seekable);
+  gst_query_unref (query);
+
+  fail_unless (gst_element_seek (pipeline, 1.0, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, GST_SEEK_TYPE_SET, 300 * GST_MSECOND,
+          GST_SEEK_TYPE_SET, 600 * GST_MSECOND));
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_ASYNC_DONE);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  /* nothing was rendered before the seek, the preroll buffer was flushed */
+  run_pipeline (pipeline, capture, FALSE, 0);
+  teardown_pipeline (pipeline, location);
+
+  /* the segment stop is exclusive */
+  fail_unless_equals_int (buffers->len, 3);
+  for (i = 0; i < buffers->len; i++) {
+    GstBuffer *buffer = g_ptr_array_index (buffers, i);
+
+    g_snprintf (payload, sizeof (payload), "pkt-%d", i + 3);
+    check_payload (buffer, payload);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer),
+        1000 * GST_SECOND + (i + 3) * 100 * GST_MSECOND);
+  }
+
+  g_ptr_array_unref (buffers);
+  g_byte_array_unref (capture);
+}
+
+GST_END_TEST;
+
+static void
+on_handoff_count (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  guint *count = user_data;
+
+  *count += 1;
+}
+
+#define BENCHMARK_PACKETS 20000
+
+GST_START_TEST (test_parse_throughput)
+{
+  GByteArray *capture = new_pcap ();
+  GstElement *pipeline, *sink;
+  gchar *location, *payload;
+  gint i, push_mode;
+  gint64 start, elapsed;
+  guint count;
+
+  /* seven MPEG-TS packets per datagram, as in a typical IPTV capture */
+  payload = g_strnfill (7 * 188, 'G');
+  for (i = 0; i < BENCHMARK_PACKETS; i++) {
+    append_pcap_packet (capture, i * GST_MSECOND,
+        make_udp_frame (NULL, 0, FALSE, 4000, 5000, payload));
+  }
+  g_free (payload);
+
+  for (push_mode = 0; push_mode < 2; push_mode++) {
+    pipeline = setup_pipeline (capture, push_mode,
+        "pcapparse ! fakesink name=sink", &location);
+
+    count = 0;
+    sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+    g_object_set (sink, "signal-handoffs", TRUE, NULL);
+    g_signal_connect (sink, "handoff", G_CALLBACK (on_handoff_count), &count);
+    gst_object_unref (sink);
+
+    start = g_get_monotonic_time ();
+    run_pipeline (pipeline, capture, push_mode, 64 * 1024);
+    elapsed = g_get_monotonic_time () - start;
+    teardown_pipeline (pipeline, location);
+
+    fail_unless_equals_int (count, BENCHMARK_PACKETS);
+    GST_INFO ("%s mode: %u bytes in %" G_GINT64_FORMAT " us, %.1f MB/s",
+        push_mode ? "push" : "pull", capture->len, elapsed,
+        (gdouble) capture->len / MAX (elapsed, 1));
+  }
+
+  g_byte_array_unref (capture);
+}
+
+GST_END_TEST;
+
 static Suite *
 pcapparse_suite (void)
 {
@@ -133,6 +649,11 @@ pcapparse_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_parse_frames_with_eth_padding);
   tcase_add_test (tc_chain, test_parse_zerosize_frames);
+  tcase_add_test (tc_chain, test_parse_pcapng_ipv6);
+  tcase_add_test (tc_chain, test_parse_filter);
+  tcase_add_test (tc_chain, test_parse_request_pads);
+  tcase_add_test (tc_chain, test_parse_pull_seek);
+  tcase_add_test (tc_chain, test_parse_throughput);
 
   return s;
 }
@@ -0,0 +1,208 @@
+/* GStreamer
+ *
+ * unit test for scenechange
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+#define WIDTH 320
+#define HEIGHT 240
+#define SCENE_LENGTH 20
+
+#define BENCH_WIDTH 1920
+#define BENCH_HEIGHT 1080
+#define BENCH_FRAMES 30
+
+/* scene 0 is a horizontal gradient moving by one level per frame,
+ * scene 1 a flat grey picture */
+static GstBuffer *
+make_frame (gint width, gint height, gint scene, gint n)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint x, y;
+
+  buf = gst_buffer_new_allocate (NULL, width * height, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++) {
+      if (scene == 0)
+        map.data[y * width + x] = x * 180 / width + n;
+      else
+        map.data[y * width + x] = 200;
+    }
+  }
+  gst_buffer_unmap (buf, &map);
+
+  GST_BUFFER_PTS (buf) = n * GST_SECOND / 30;
+  GST_BUFFER_DURATION (buf) = GST_SECOND / 30;
+
+  return buf;
+}
+
+static GstHarness *
+setup_scenechange (const gchar * method, gint width, gint height)
+{
+  GstHarness *h;
+  gchar *caps;
+
+  h = gst_harness_new ("scenechange");
+  gst_util_set_object_arg (G_OBJECT (h->element), "method", method);
+  caps = g_strdup_printf ("video/x-raw,format=GRAY8,width=%d,height=%d,"
+      "framerate=30/1", width, height);
+  gst_harness_set_src_caps_str (h, caps);
+  g_free (caps);
+
+  return h;
+}
+
+static void
+check_scene_changes (const gchar * method)
+{
+  GstHarness *h;
+  GstBus *bus;
+  GstMessage *msg;
+  GstEvent *event;
+  gint i, n_events = 0, n_messages = 0;
+
+  h = setup_scenechange (method, WIDTH, HEIGHT);
+  bus = gst_bus_new ();
+  gst_element_set_bus (h->element, bus);
+
+  /* A, B, A */
+  for (i = 0; i < 3 * SCENE_LENGTH; i++) {
+    fail_unless_equals_int (gst_harness_push (h,
+            make_frame (WIDTH, HEIGHT, (i / SCENE_LENGTH) & 1, i)),
+        GST_FLOW_OK);
+    gst_buffer_unref (gst_harness_pull (h));
+  }
+
+  while ((event = gst_harness_try_pull_event (h))) {
+    const GstStructure *s = gst_event_get_structure (event);
+
+    if (s && gst_structure_has_name (s, "GstForceKeyUnit"))
+      n_events++;
+    gst_event_unref (event);
+  }
+  fail_unless_equals_int (n_events, 2);
+
+  while ((msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT))) {
+    const GstStructure *s = gst_message_get_structure (msg);
+    guint64 frame;
+    gdouble confidence;
+
+    if (gst_structure_has_name (s, "scene-change")) {
+      fail_unless (gst_structure_get_uint64 (s, "frame", &frame));
+      fail_unless_equals_uint64 (frame, (n_messages + 1) * SCENE_LENGTH);
+      fail_unless (gst_structure_get_double (s, "confidence", &confidence));
+      fail_unless (confidence > 0.0 && confidence <= 1.0);
+      fail_unless (gst_structure_has_field (s, "timestamp"));
+      fail_unless (gst_structure_has_field (s, "score"));
+      fail_unless (gst_structure_has_field (s, "threshold"));
+      n_messages++;
+    }
+    gst_message_unref (msg);
+  }
+  fail_unless_equals_int (n_messages, 2);
+
+  gst_element_set_bus (h->element, NULL);
+  gst_object_unref (bus);
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_scene_change_full)
+{
+  check_scene_changes ("full");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_scene_change_fast)
+{
+  check_scene_changes ("fast");
+}
+
+GST_END_TEST;
+
+static GstClockTime
+run_benchmark (const gchar * method, GstBuffer ** frames)
+{
+  GstHarness *h;
+  GstClockTime start, elapsed;
+  gint i;
+
+  h = setup_scenechange (method, BENCH_WIDTH, BENCH_HEIGHT);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < BENCH_FRAMES; i++) {
+    gst_harness_push (h, frames[i]);
+    gst_buffer_unref (gst_harness_pull (h));
+  }
+  elapsed = gst_util_get_timestamp () - start;
+
+  gst_harness_teardown (h);
+
+  return elapsed;
+}
+
+/* logs the cost per 1080p frame of both methods */
+GST_START_TEST (test_scene_change_benchmark)
+{
+  const gchar *methods[] = { "full", "fast" };
+  GstBuffer *frames[BENCH_FRAMES];
+  GstBuffer *ref[2];
+  GstClockTime elapsed;
+  gint i, j;
+
+  ref[0] = make_frame (BENCH_WIDTH, BENCH_HEIGHT, 0, 0);
+  ref[1] = make_frame (BENCH_WIDTH, BENCH_HEIGHT, 0, 1);
+
+  for (j = 0; j < G_N_ELEMENTS (methods); j++) {
+    /* writable buffers, so that no copy is made in the element */
+    for (i = 0; i < BENCH_FRAMES; i++)
+      frames[i] = gst_buffer_copy_deep (ref[i & 1]);
+
+    elapsed = run_benchmark (methods[j], frames);
+    GST_INFO ("%s: %" GST_TIME_FORMAT " per %dx%d frame", methods[j],
+        GST_TIME_ARGS (elapsed / BENCH_FRAMES), BENCH_WIDTH, BENCH_HEIGHT);
+  }
+
+  gst_buffer_unref (ref[0]);
+  gst_buffer_unref (ref[1]);
+}
+
+GST_END_TEST;
+
+static Suite *
+scenechange_suite (void)
+{
+  Suite *s = suite_create ("scenechange");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_scene_change_full);
+  tcase_add_test (tc_chain, test_scene_change_fast);
+  tcase_add_test (tc_chain, test_scene_change_benchmark);
+
+  return s;
+}
+
+GST_CHECK_MAIN (scenechange);
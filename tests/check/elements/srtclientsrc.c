@@ -0,0 +1,167 @@
+/* GStreamer
+ *
+ * unit test for srtclientsrc
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <gio/gio.h>
+#include <gio/gnetworking.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <srt/srt.h>
+
+#define N_MESSAGES 256
+#define PAYLOAD_SIZE 1316
+
+/* a listening SRT socket on a free loopback port */
+static SRTSOCKET
+listen_sender (guint16 * port)
+{
+  struct sockaddr_in sa;
+  int sa_len = sizeof (sa);
+  SRTSOCKET sock;
+
+  sock = srt_socket (AF_INET, SOCK_DGRAM, 0);
+  fail_unless (sock != SRT_INVALID_SOCK);
+  srt_setsockopt (sock, 0, SRTO_TSBPDMODE, &(int) {
+      1}, sizeof (int));
+  srt_setsockopt (sock, 0, SRTO_SENDER, &(int) {
+      1}, sizeof (int));
+
+  memset (&sa, 0, sizeof (sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = 0;
+  sa.sin_addr.s_addr = g_htonl (INADDR_LOOPBACK);
+  fail_unless (srt_bind (sock, (struct sockaddr *) &sa,
+          sizeof (sa)) != SRT_ERROR, "%s", srt_getlasterror_str ());
+  fail_unless (srt_listen (sock, 1) != SRT_ERROR);
+
+  fail_unless (srt_getsockname (sock, (struct sockaddr *) &sa,
+          &sa_len) != SRT_ERROR);
+  *port = g_ntohs (sa.sin_port);
+
+  return sock;
+}
+
+static GstHarness *
+setup_srtclientsrc (guint16 port)
+{
+  GstHarness *h;
+  gchar *uri;
+
+  h = gst_harness_new_with_padnames ("srtclientsrc", NULL, "src");
+  uri = g_strdup_printf ("srt://127.0.0.1:%u", port);
+  g_object_set (h->element, "uri", uri, "latency", 200, NULL);
+  g_free (uri);
+
+  gst_harness_use_systemclock (h);
+
+  return h;
+}
+
+GST_START_TEST (test_batching)
+{
+  SRTSOCKET listener, sender;
+  struct sockaddr_in sa;
+  int sa_len = sizeof (sa);
+  GstClockTime last_pts = 0;
+  GstStructure *stats;
+  GstHarness *h;
+  GstBuffer *buf;
+  GstMapInfo map;
+  gchar data[PAYLOAD_SIZE];
+  guint32 i, seqnum = 0;
+  guint n_buffers = 0;
+  gsize offset;
+  guint16 port;
+  gint64 received;
+
+  listener = listen_sender (&port);
+  h = setup_srtclientsrc (port);
+  gst_harness_play (h);
+
+  sender = srt_accept (listener, (struct sockaddr *) &sa, &sa_len);
+  fail_unless (sender != SRT_INVALID_SOCK, "%s", srt_getlasterror_str ());
+
+  /* a burst, the messages are available to the receiver together */
+  for (i = 0; i < N_MESSAGES; i++) {
+    memset (data, i & 0xff, sizeof (data));
+    GST_WRITE_UINT32_BE (data, i);
+    fail_unless (srt_sendmsg2 (sender, data, sizeof (data), NULL) ==
+        PAYLOAD_SIZE);
+  }
+
+  while (seqnum < N_MESSAGES) {
+    buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+    n_buffers++;
+
+    /* the timestamps come from the sender times */
+    fail_unless (GST_BUFFER_PTS_IS_VALID (buf));
+    fail_unless (GST_BUFFER_PTS (buf) >= last_pts);
+    last_pts = GST_BUFFER_PTS (buf);
+
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    fail_unless (map.size > 0 && map.size % PAYLOAD_SIZE == 0);
+    for (offset = 0; offset < map.size; offset += PAYLOAD_SIZE) {
+      fail_unless_equals_int (GST_READ_UINT32_BE (map.data + offset), seqnum);
+      seqnum++;
+    }
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+  }
+
+  /* the messages were received in batches of at most 8 */
+  GST_INFO ("%u messages in %u buffers", N_MESSAGES, n_buffers);
+  fail_unless (n_buffers >= N_MESSAGES / 8);
+  fail_unless (n_buffers < N_MESSAGES);
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_has_field (stats, "rtt-ms"));
+  fail_unless (gst_structure_has_field (stats, "packets-received-lost"));
+  fail_unless (gst_structure_has_field (stats,
+          "packets-received-retransmitted"));
+  fail_unless (gst_structure_get_int64 (stats, "packets-received", &received));
+  fail_unless (received >= N_MESSAGES);
+  gst_structure_free (stats);
+
+  /* the source stops on the broken connection */
+  srt_close (sender);
+  srt_close (listener);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+srtclientsrc_suite (void)
+{
+  Suite *s = suite_create ("srtclientsrc");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_batching);
+
+  return s;
+}
+
+GST_CHECK_MAIN (srtclientsrc);
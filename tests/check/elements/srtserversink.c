@@ -0,0 +1,515 @@
+/* GStreamer
+ *
+ * unit test for srtserversink
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <gio/gio.h>
+#include <gio/gnetworking.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <srt/srt.h>
+
+#define N_RECEIVERS 16
+#define N_BUFFERS 200
+/* the SRT live mode payload size */
+#define PAYLOAD_SIZE 1316
+/* the sequence number of the streamheader buffer */
+#define HEADER_SEQNUM 0xffffff00
+/* the first buffer pushed while the sender thread is held back */
+#define SLOW_SEQNUM 1000
+
+static gint clients_added;
+static gint clients_removed;
+
+/* holds back the sender thread in the client-removed signal */
+static GMutex sender_lock;
+static GCond sender_cond;
+static gboolean sender_blocked;
+
+static void
+client_added_cb (GstElement * sink, gint sock, GSocketAddress * addr,
+    gpointer user_data)
+{
+  g_atomic_int_inc (&clients_added);
+}
+
+static void
+client_removed_cb (GstElement * sink, gint sock, GSocketAddress * addr,
+    gpointer user_data)
+{
+  g_atomic_int_inc (&clients_removed);
+}
+
+static void
+block_sender_cb (GstElement * sink, gint sock, GSocketAddress * addr,
+    gpointer user_data)
+{
+  g_mutex_lock (&sender_lock);
+  while (sender_blocked)
+    g_cond_wait (&sender_cond, &sender_lock);
+  g_mutex_unlock (&sender_lock);
+}
+
+static void
+release_sender (void)
+{
+  g_mutex_lock (&sender_lock);
+  sender_blocked = FALSE;
+  g_cond_broadcast (&sender_cond);
+  g_mutex_unlock (&sender_lock);
+}
+
+/* a port that is free on the loopback interface right now */
+static guint16
+get_free_port (void)
+{
+  GSocket *socket;
+  GInetAddress *loopback;
+  GSocketAddress *addr;
+  guint16 port;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+
+  loopback = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (loopback, 0);
+  fail_unless (g_socket_bind (socket, addr, TRUE, NULL));
+  g_object_unref (addr);
+  g_object_unref (loopback);
+
+  addr = g_socket_get_local_address (socket, NULL);
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr));
+  g_object_unref (addr);
+
+  g_socket_close (socket, NULL);
+  g_object_unref (socket);
+
+  return port;
+}
+
+static gboolean
+wait_for_count (gint * count, gint value)
+{
+  gint i;
+
+  for (i = 0; i < 500 && g_atomic_int_get (count) < value; i++)
+    g_usleep (G_USEC_PER_SEC / 100);
+
+  return g_atomic_int_get (count) >= value;
+}
+
+static GstHarness *
+setup_srtserversink (guint16 port)
+{
+  GstHarness *h;
+  gchar *uri;
+
+  g_atomic_int_set (&clients_added, 0);
+  g_atomic_int_set (&clients_removed, 0);
+
+  h = gst_harness_new_with_padnames ("srtserversink", "sink", NULL);
+  uri = g_strdup_printf ("srt://127.0.0.1:%u", port);
+  g_object_set (h->element, "uri", uri, "latency", 1000, "sync", FALSE, NULL);
+  g_free (uri);
+
+  g_signal_connect (h->element, "client-added", G_CALLBACK (client_added_cb),
+      NULL);
+  g_signal_connect (h->element, "client-removed",
+      G_CALLBACK (client_removed_cb), NULL);
+
+  gst_harness_play (h);
+  gst_harness_set_src_caps_str (h, "video/mpegts");
+
+  return h;
+}
+
+static SRTSOCKET
+connect_receiver (guint16 port)
+{
+  struct sockaddr_in sa;
+  SRTSOCKET sock;
+
+  sock = srt_socket (AF_INET, SOCK_DGRAM, 0);
+  fail_unless (sock != SRT_INVALID_SOCK);
+  srt_setsockopt (sock, 0, SRTO_TSBPDMODE, &(int) {
+      1}, sizeof (int));
+  srt_setsockopt (sock, 0, SRTO_RCVTIMEO, &(int) {
+      5000}, sizeof (int));
+
+  memset (&sa, 0, sizeof (sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = g_htons (port);
+  sa.sin_addr.s_addr = g_htonl (INADDR_LOOPBACK);
+  fail_unless (srt_connect (sock, (struct sockaddr *) &sa,
+          sizeof (sa)) != SRT_ERROR, "%s", srt_getlasterror_str ());
+
+  return sock;
+}
+
+/* connects the receivers one after the other, the server has a backlog of 1 */
+static void
+connect_receivers (guint16 port, SRTSOCKET * receivers, gint n_receivers)
+{
+  gint i;
+
+  for (i = 0; i < n_receivers; i++) {
+    receivers[i] = connect_receiver (port);
+    fail_unless (wait_for_count (&clients_added, i + 1));
+  }
+}
+
+static GstBuffer *
+make_buffer (guint32 seqnum)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+
+  buf = gst_buffer_new_allocate (NULL, PAYLOAD_SIZE, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, seqnum & 0xff, map.size);
+  GST_WRITE_UINT32_BE (map.data, seqnum);
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+/* a keyframe every @keyframe_interval buffers after @first */
+static void
+push_burst (GstHarness * h, guint32 first, guint32 n_buffers,
+    guint32 keyframe_interval)
+{
+  GstBuffer *buf;
+  guint32 i;
+
+  for (i = 0; i < n_buffers; i++) {
+    buf = make_buffer (first + i);
+    if (i % keyframe_interval)
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+}
+
+/* pushes the buffers at about 10 Mbit/s */
+static void
+push_buffers (GstHarness * h, guint32 first, guint32 n_buffers)
+{
+  guint32 i;
+
+  for (i = first; i < first + n_buffers; i++) {
+    fail_unless_equals_int (gst_harness_push (h, make_buffer (i)),
+        GST_FLOW_OK);
+    g_usleep (1000);
+  }
+}
+
+static void
+receive_buffers (SRTSOCKET sock, guint32 first, guint32 n_buffers)
+{
+  gchar data[PAYLOAD_SIZE + 1];
+  guint32 i;
+  int len;
+
+  for (i = first; i < first + n_buffers; i++) {
+    len = srt_recvmsg (sock, data, sizeof (data));
+    fail_unless_equals_int (len, PAYLOAD_SIZE);
+    fail_unless_equals_int (GST_READ_UINT32_BE (data), i);
+  }
+}
+
+GST_START_TEST (test_fan_out)
+{
+  SRTSOCKET receivers[N_RECEIVERS];
+  GValue stats = G_VALUE_INIT;
+  const GstStructure *s;
+  guint64 dropped;
+  guint16 port;
+  GstHarness *h;
+  gint i;
+
+  port = get_free_port ();
+  h = setup_srtserversink (port);
+  connect_receivers (port, receivers, N_RECEIVERS);
+
+  push_buffers (h, 0, N_BUFFERS);
+
+  /* every receiver gets every buffer in order */
+  for (i = 0; i < N_RECEIVERS; i++)
+    receive_buffers (receivers[i], 0, N_BUFFERS);
+
+  g_value_init (&stats, GST_TYPE_ARRAY);
+  g_object_get_property (G_OBJECT (h->element), "stats", &stats);
+  fail_unless_equals_int (gst_value_array_get_size (&stats), N_RECEIVERS);
+  for (i = 0; i < N_RECEIVERS; i++) {
+    s = gst_value_get_structure (gst_value_array_get_value (&stats, i));
+    fail_unless (gst_structure_has_field (s, "queue-depth"));
+    fail_unless (gst_structure_has_field (s, "packets-retransmitted-total"));
+    fail_unless (gst_structure_get_uint64 (s, "buffers-dropped", &dropped));
+    fail_unless_equals_uint64 (dropped, 0);
+  }
+  g_value_unset (&stats);
+
+  gst_harness_teardown (h);
+  for (i = 0; i < N_RECEIVERS; i++)
+    srt_close (receivers[i]);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_client_leaves)
+{
+  SRTSOCKET receivers[4];
+  guint16 port;
+  GstHarness *h;
+  gint i;
+
+  port = get_free_port ();
+  h = setup_srtserversink (port);
+  connect_receivers (port, receivers, 4);
+
+  push_buffers (h, 0, 10);
+  for (i = 0; i < 4; i++)
+    receive_buffers (receivers[i], 0, 10);
+
+  /* the client is removed by the sender thread once a send fails, without
+   * disturbing the others */
+  srt_close (receivers[0]);
+  for (i = 0; i < 50 && !g_atomic_int_get (&clients_removed); i++)
+    push_buffers (h, 10 + i * 10, 10);
+  fail_unless (wait_for_count (&clients_removed, 1));
+
+  for (i = 1; i < 4; i++) {
+    gchar data[PAYLOAD_SIZE + 1];
+    guint32 n = 10;
+    int len;
+
+    while ((len = srt_recvmsg (receivers[i], data, sizeof (data))) > 0 &&
+        GST_READ_UINT32_BE (data) == n)
+      n++;
+    /* the receive times out once all the buffers are read */
+    fail_unless_equals_int (len, SRT_ERROR);
+    fail_unless (n > 10);
+  }
+
+  gst_harness_teardown (h);
+  for (i = 1; i < 4; i++)
+    srt_close (receivers[i]);
+}
+
+GST_END_TEST;
+
+/* Connects a receiver for the test and one that leaves, the sender thread
+ * stays in the client-removed signal of the latter until release_sender(),
+ * so the queue of the first client fills up like that of a receiver that
+ * does not keep up */
+static GstHarness *
+setup_slow_receiver (const gchar * policy, SRTSOCKET * receiver)
+{
+  SRTSOCKET receivers[2];
+  GstBuffer *header;
+  GstCaps *caps;
+  guint16 port;
+  GstHarness *h;
+  guint32 n;
+
+  port = get_free_port ();
+  h = setup_srtserversink (port);
+  g_object_set (h->element, "client-queue-size", 10 * PAYLOAD_SIZE, NULL);
+  gst_util_set_object_arg (G_OBJECT (h->element), "overflow-policy", policy);
+
+  header = make_buffer (HEADER_SEQNUM);
+  GST_BUFFER_FLAG_SET (header, GST_BUFFER_FLAG_HEADER);
+  caps = gst_caps_new_simple ("video/mpegts", "streamheader", GST_TYPE_BUFFER,
+      header, NULL);
+  gst_harness_set_src_caps (h, caps);
+  gst_buffer_unref (header);
+
+  sender_blocked = TRUE;
+  g_signal_connect (h->element, "client-removed",
+      G_CALLBACK (block_sender_cb), NULL);
+
+  connect_receivers (port, receivers, 2);
+  srt_close (receivers[1]);
+  for (n = 0; n < SLOW_SEQNUM && !g_atomic_int_get (&clients_removed); n++) {
+    fail_unless_equals_int (gst_harness_push (h, make_buffer (n)),
+        GST_FLOW_OK);
+    g_usleep (10000);
+  }
+  fail_unless (g_atomic_int_get (&clients_removed) == 1);
+
+  *receiver = receivers[0];
+  return h;
+}
+
+/* receives until @last or an error, returns the received sequence numbers */
+static GArray *
+receive_until (SRTSOCKET sock, guint32 last)
+{
+  GArray *seqnums = g_array_new (FALSE, FALSE, sizeof (guint32));
+  gchar data[PAYLOAD_SIZE + 1];
+  guint32 seqnum;
+  int len;
+
+  while ((len = srt_recvmsg (sock, data, sizeof (data))) > 0) {
+    fail_unless_equals_int (len, PAYLOAD_SIZE);
+    seqnum = GST_READ_UINT32_BE (data);
+    g_array_append_val (seqnums, seqnum);
+    if (seqnum == last)
+      break;
+  }
+
+  return seqnums;
+}
+
+static guint64
+get_buffers_dropped (GstHarness * h)
+{
+  GValue stats = G_VALUE_INIT;
+  const GstStructure *s;
+  guint64 dropped = 0;
+
+  g_value_init (&stats, GST_TYPE_ARRAY);
+  g_object_get_property (G_OBJECT (h->element), "stats", &stats);
+  fail_unless_equals_int (gst_value_array_get_size (&stats), 1);
+  s = gst_value_get_structure (gst_value_array_get_value (&stats, 0));
+  fail_unless (gst_structure_get_uint64 (s, "buffers-dropped", &dropped));
+  g_value_unset (&stats);
+
+  return dropped;
+}
+
+/* the oldest buffers make room for the new ones */
+GST_START_TEST (test_slow_receiver_drop_oldest)
+{
+  SRTSOCKET receiver;
+  GArray *seqnums;
+  GstHarness *h;
+  guint32 seqnum;
+  guint i, n;
+
+  h = setup_slow_receiver ("drop-oldest", &receiver);
+
+  push_burst (h, SLOW_SEQNUM, 50, 1);
+  fail_unless (get_buffers_dropped (h) >= 40);
+  release_sender ();
+
+  seqnums = receive_until (receiver, SLOW_SEQNUM + 49);
+  n = seqnums->len;
+  fail_unless (n >= 10);
+  for (i = 0; i < n - 10; i++) {
+    seqnum = g_array_index (seqnums, guint32, i);
+    fail_unless (seqnum < SLOW_SEQNUM || seqnum == HEADER_SEQNUM,
+        "buffer %u was not dropped", seqnum);
+  }
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (g_array_index (seqnums, guint32, n - 10 + i),
+        SLOW_SEQNUM + 40 + i);
+
+  g_array_free (seqnums, TRUE);
+  gst_harness_teardown (h);
+  srt_close (receiver);
+}
+
+GST_END_TEST;
+
+/* the queue is flushed and the client resumes at the next keyframe, after
+ * the streamheaders */
+GST_START_TEST (test_slow_receiver_drop_to_keyframe)
+{
+  SRTSOCKET receiver;
+  GArray *seqnums;
+  GstHarness *h;
+  guint32 seqnum;
+  guint i, n;
+
+  h = setup_slow_receiver ("drop-to-keyframe", &receiver);
+
+  /* overflows at the 11th buffer at the latest, the keyframe is the 16th */
+  push_burst (h, SLOW_SEQNUM, 20, 15);
+  fail_unless (get_buffers_dropped (h) >= 15);
+  release_sender ();
+
+  seqnums = receive_until (receiver, SLOW_SEQNUM + 19);
+  n = seqnums->len;
+  fail_unless (n >= 6);
+  fail_unless_equals_int (g_array_index (seqnums, guint32, n - 6),
+      HEADER_SEQNUM);
+  for (i = 0; i < 5; i++)
+    fail_unless_equals_int (g_array_index (seqnums, guint32, n - 5 + i),
+        SLOW_SEQNUM + 15 + i);
+  for (i = 0; i < n - 6; i++) {
+    seqnum = g_array_index (seqnums, guint32, i);
+    fail_unless (seqnum < SLOW_SEQNUM || seqnum == HEADER_SEQNUM,
+        "buffer %u was not dropped", seqnum);
+  }
+
+  g_array_free (seqnums, TRUE);
+  gst_harness_teardown (h);
+  srt_close (receiver);
+}
+
+GST_END_TEST;
+
+/* the client is removed, without getting any of the buffers of the burst */
+GST_START_TEST (test_slow_receiver_disconnect)
+{
+  SRTSOCKET receiver;
+  GArray *seqnums;
+  GstHarness *h;
+  guint i;
+
+  h = setup_slow_receiver ("disconnect", &receiver);
+
+  push_burst (h, SLOW_SEQNUM, 20, 1);
+  release_sender ();
+  fail_unless (wait_for_count (&clients_removed, 2));
+
+  seqnums = receive_until (receiver, SLOW_SEQNUM);
+  for (i = 0; i < seqnums->len; i++)
+    fail_unless (g_array_index (seqnums, guint32, i) < SLOW_SEQNUM ||
+        g_array_index (seqnums, guint32, i) == HEADER_SEQNUM);
+
+  g_array_free (seqnums, TRUE);
+  gst_harness_teardown (h);
+  srt_close (receiver);
+}
+
+GST_END_TEST;
+
+static Suite *
+srtserversink_suite (void)
+{
+  Suite *s = suite_create ("srtserversink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_set_timeout (tc_chain, 60);
+  tcase_add_test (tc_chain, test_fan_out);
+  tcase_add_test (tc_chain, test_client_leaves);
+  tcase_add_test (tc_chain, test_slow_receiver_drop_oldest);
+  tcase_add_test (tc_chain, test_slow_receiver_drop_to_keyframe);
+  tcase_add_test (tc_chain, test_slow_receiver_disconnect);
+
+  return s;
+}
+
+GST_CHECK_MAIN (srtserversink);
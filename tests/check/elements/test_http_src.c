@@ -95,6 +95,9 @@ typedef struct _GstTestHTTPSrc
   guint64 position;
   /* index immediately after the last byte from the segment to be retrieved */
   guint64 segment_end;
+  /* offset and size of the range asked for with a Range header */
+  guint64 range_offset;
+  guint64 range_size;
 
   GstEvent *http_headers_event;
   gboolean duration_changed;
@@ -243,14 +246,8 @@ gst_test_http_src_reset_input (GstTestHTTPSrc * src)
     gst_event_unref (src->http_headers_event);
     src->http_headers_event = NULL;
   }
-  if (src->extra_headers) {
-    gst_structure_free (src->extra_headers);
-    src->extra_headers = NULL;
-  }
-  g_free (src->http_method_name);
-  src->http_method_name = NULL;
-  g_free (src->user_agent);
-  src->user_agent = NULL;
+  src->range_offset = 0;
+  src->range_size = 0;
   src->duration_changed = FALSE;
 }
 
@@ -263,6 +260,10 @@ gst_test_http_src_finalize (GObject * object)
 
   g_free (src->uri);
   gst_test_http_src_reset_input (src);
+  if (src->extra_headers)
+    gst_structure_free (src->extra_headers);
+  g_free (src->http_method_name);
+  g_free (src->user_agent);
   g_mutex_clear (&src->mutex);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -296,17 +297,44 @@ gst_test_http_src_start (GstBaseSrc * basesrc)
     g_mutex_unlock (&src->mutex);
     return FALSE;
   }
+  /* the extra headers are sent with the request */
+  if (src->extra_headers) {
+    src->input.request_headers = gst_structure_copy (src->extra_headers);
+    gst_structure_set_name (src->input.request_headers,
+        TEST_HTTP_SRC_REQUEST_HEADERS_NAME);
+  }
   if (!gst_test_http_src_callbacks->src_start (src, src->uri, &src->input,
           gst_test_http_src_callback_user_data)) {
     if (src->input.status_code == 0) {
       src->input.status_code = 404;
     }
   } else {
+    const gchar *range = NULL;
+    gchar *end = NULL;
+    guint64 range_start = 0, range_end;
+
+    if (src->input.request_headers)
+      range = gst_structure_get_string (src->input.request_headers, "Range");
+    if (range && g_str_has_prefix (range, "bytes="))
+      range_start = g_ascii_strtoull (range + 6, &end, 10);
+    src->position = 0;
+    src->range_size = src->input.size;
+    if (end && *end == '-' && range_start < src->input.size) {
+      if (end[1] != '\0')
+        range_end = g_ascii_strtoull (end + 1, NULL, 10);
+      else
+        range_end = src->input.size - 1;
+      if (range_start <= range_end && range_end < src->input.size) {
+        src->range_offset = range_start;
+        src->range_size = range_end + 1 - range_start;
+        if (src->input.status_code == 0)
+          src->input.status_code = 206;
+      }
+    }
+    src->segment_end = src->range_size;
     if (src->input.status_code == 0) {
       src->input.status_code = 200;
     }
-    src->position = 0;
-    src->segment_end = src->input.size;
     gst_base_src_set_dynamic_size (basesrc, FALSE);
     basesrc->segment.duration = src->input.size;
     src->duration_changed = TRUE;
@@ -441,7 +469,7 @@ gst_test_http_src_do_seek (GstBaseSrc * basesrc, GstSegment * segment)
   if (segment->stop != -1) {
     src->segment_end = segment->stop;
   } else {
-    src->segment_end = src->input.size;
+    src->segment_end = src->range_size;
   }
   g_mutex_unlock (&src->mutex);
   return TRUE;
@@ -491,10 +519,11 @@ gst_test_http_src_create (GstBaseSrc * basesrc, guint64 offset,
     return GST_FLOW_ERROR;
   }
   if (src->input.status_code < 200 || src->input.status_code >= 300) {
-    GST_ELEMENT_ERROR (src, RESOURCE, NOT_FOUND, ("%s",
+    GST_ELEMENT_ERROR_WITH_DETAILS (src, RESOURCE, NOT_FOUND, ("%s",
             "Generated requested error"), ("%s (%d), URL: %s, Redirect to: %s",
             "Generated requested error", src->input.status_code, src->uri,
-            GST_STR_NULL (NULL)));
+            GST_STR_NULL (NULL)), ("http-status-code", G_TYPE_UINT,
+            src->input.status_code, NULL));
     g_mutex_unlock (&src->mutex);
     return GST_FLOW_ERROR;
   }
@@ -515,7 +544,7 @@ gst_test_http_src_create (GstBaseSrc * basesrc, guint64 offset,
     goto http_events;
   }
   ret = gst_test_http_src_callbacks->src_create (src,
-      offset, bytes_read, retbuf,
+      src->range_offset + offset, bytes_read, retbuf,
       src->input.context, gst_test_http_src_callback_user_data);
   if (ret != GST_FLOW_OK) {
     goto http_events;
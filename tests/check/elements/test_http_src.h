@@ -49,7 +49,7 @@ typedef struct _GstTestHTTPSrcInput
 {
   gpointer context; /* opaque pointer that can be used in callbacks */
   guint64 size; /* size of resource, in bytes */
-  GstStructure *request_headers;
+  GstStructure *request_headers; /* holds the extra headers on input */
   GstStructure *response_headers;
   guint status_code; /* HTTP status code */
 } GstTestHTTPSrcInput;
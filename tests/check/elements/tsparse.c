@@ -0,0 +1,218 @@
+/* GStreamer
+ *
+ * unit test for tsparse
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/mpegts/mpegts.h>
+
+#define TS_CAPS "video/mpegts,systemstream=(boolean)true,packetsize=(int)188"
+
+#define EIT_PID 0x12
+/* header, transport_stream_id..last_table_id, one event, CRC */
+#define EIT_SECTION_SIZE (8 + 6 + 12 + 4)
+
+static guint8 eit_cc;
+
+/* One EIT schedule section with a single event in its own TS packet */
+static void
+write_eit_packet (guint8 * p, guint16 service_id, guint8 version,
+    guint8 section_number, guint8 last_section_number, guint16 event_id)
+{
+  guint8 *section = p + 5;
+
+  memset (p, 0xff, 188);
+  p[0] = 0x47;
+  p[1] = 0x40 | (EIT_PID >> 8);
+  p[2] = EIT_PID & 0xff;
+  p[3] = 0x10 | (eit_cc++ & 0xf);
+  p[4] = 0;
+
+  memset (section, 0, EIT_SECTION_SIZE);
+  section[0] = GST_MTS_TABLE_ID_EVENT_INFORMATION_ACTUAL_TS_SCHEDULE_1;
+  GST_WRITE_UINT16_BE (section + 1, 0xf000 | (EIT_SECTION_SIZE - 3));
+  GST_WRITE_UINT16_BE (section + 3, service_id);
+  section[5] = 0xc1 | (version << 1);
+  section[6] = section_number;
+  section[7] = last_section_number;
+  GST_WRITE_UINT16_BE (section + 8, 1);
+  GST_WRITE_UINT16_BE (section + 10, 1);
+  section[12] = last_section_number;
+  section[13] = GST_MTS_TABLE_ID_EVENT_INFORMATION_ACTUAL_TS_SCHEDULE_1;
+  GST_WRITE_UINT16_BE (section + 14, event_id);
+  GST_WRITE_UINT32_BE (section + EIT_SECTION_SIZE - 4,
+      gst_mpegts_calc_crc32 (section, EIT_SECTION_SIZE - 4));
+}
+
+/* All the sections of all the services, like an EPG carousel does */
+static GstBuffer *
+make_eit_cycle (guint n_services, guint n_sections, guint8 version)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint i, j;
+
+  buf = gst_buffer_new_allocate (NULL, 188 * n_services * n_sections, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  for (i = 0; i < n_sections; i++) {
+    for (j = 0; j < n_services; j++)
+      write_eit_packet (map.data + 188 * (i * n_services + j), j + 1, version,
+          i, n_sections - 1, i);
+  }
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static void
+push_and_drain (GstHarness * h, GstBuffer * buf)
+{
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  while ((buf = gst_harness_try_pull (h)))
+    gst_buffer_unref (buf);
+}
+
+static guint
+count_eit_sections (GstBus * bus)
+{
+  GstMessage *msg;
+  GstMpegtsSection *section;
+  guint n = 0;
+
+  while ((msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT))) {
+    if ((section = gst_message_parse_mpegts_section (msg))) {
+      if (GST_MPEGTS_SECTION_TYPE (section) == GST_MPEGTS_SECTION_EIT)
+        n++;
+      gst_mpegts_section_unref (section);
+    }
+    gst_message_unref (msg);
+  }
+
+  return n;
+}
+
+static GstHarness *
+setup_tsparse (GstBus ** bus)
+{
+  GstHarness *h;
+
+  h = gst_harness_new ("tsparse");
+  *bus = gst_bus_new ();
+  gst_element_set_bus (h->element, *bus);
+  gst_harness_set_src_caps_str (h, TS_CAPS);
+  eit_cc = 0;
+
+  return h;
+}
+
+GST_START_TEST (test_section_repeats)
+{
+  GstHarness *h;
+  GstBus *bus;
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint i;
+
+  h = setup_tsparse (&bus);
+
+  /* repeated sections are only posted once */
+  for (i = 0; i < 5; i++)
+    push_and_drain (h, make_eit_cycle (50, 4, 0));
+  fail_unless_equals_int (count_eit_sections (bus), 50 * 4);
+
+  /* a section whose content changed without a version update is posted
+   * again, and only once */
+  for (i = 0; i < 3; i++) {
+    buf = gst_buffer_new_allocate (NULL, 188, NULL);
+    gst_buffer_map (buf, &map, GST_MAP_WRITE);
+    write_eit_packet (map.data, 7, 0, 2, 3, 1000);
+    gst_buffer_unmap (buf, &map);
+    push_and_drain (h, buf);
+  }
+  fail_unless_equals_int (count_eit_sections (bus), 1);
+
+  /* a new version of the tables is posted */
+  push_and_drain (h, make_eit_cycle (50, 4, 1));
+  push_and_drain (h, make_eit_cycle (50, 4, 1));
+  fail_unless_equals_int (count_eit_sections (bus), 50 * 4);
+
+  /* fewer sections with the same version reset the subtables too */
+  push_and_drain (h, make_eit_cycle (50, 2, 1));
+  push_and_drain (h, make_eit_cycle (50, 2, 1));
+  fail_unless_equals_int (count_eit_sections (bus), 50 * 2);
+
+  gst_element_set_bus (h->element, NULL);
+  gst_object_unref (bus);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_eit_carousel_speed)
+{
+  GstHarness *h;
+  GstBus *bus;
+  GstBuffer *cycle;
+  gint64 start, elapsed;
+  gsize size;
+  gint i;
+
+  h = setup_tsparse (&bus);
+
+  /* EIT schedule of 1000 services, 8 sections each */
+  cycle = make_eit_cycle (1000, 8, 0);
+  size = gst_buffer_get_size (cycle);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < 20; i++)
+    push_and_drain (h, gst_buffer_copy (cycle));
+  elapsed = g_get_monotonic_time () - start;
+  GST_INFO ("20 EIT cycles of %" G_GSIZE_FORMAT " bytes in %" G_GINT64_FORMAT
+      " us, %.1f MB/s", size, elapsed, 20.0 * size / MAX (elapsed, 1));
+
+  fail_unless_equals_int (count_eit_sections (bus), 1000 * 8);
+
+  gst_buffer_unref (cycle);
+  gst_element_set_bus (h->element, NULL);
+  gst_object_unref (bus);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+tsparse_suite (void)
+{
+  Suite *s = suite_create ("tsparse");
+  TCase *tc_chain = tcase_create ("general");
+
+  gst_mpegts_initialize ();
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_section_repeats);
+  tcase_add_test (tc_chain, test_eit_carousel_speed);
+
+  return s;
+}
+
+GST_CHECK_MAIN (tsparse);
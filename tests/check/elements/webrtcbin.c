@@ -28,8 +28,11 @@
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstharness.h>
+#include <gst/rtp/rtp.h>
 #include <gst/webrtc/webrtc.h>
 
+#include <string.h>
+
 #define OPUS_RTP_CAPS(pt) "application/x-rtp,payload=" G_STRINGIFY(pt) ",encoding-name=OPUS,media=audio,clock-rate=48000"
 #define VP8_RTP_CAPS(pt) "application/x-rtp,payload=" G_STRINGIFY(pt) ",encoding-name=VP8,media=video,clock-rate=90000"
 
@@ -1342,17 +1345,353 @@ GST_START_TEST (test_recvonly_sendonly)
 
 GST_END_TEST;
 
+struct bundle_check
+{
+  const gchar *group;           /* expected a=group attribute */
+  const guint *ports;           /* expected port of each media */
+  const gboolean *bundle_only;  /* whether each media is bundle-only */
+  gboolean same_ice;            /* whether the media share ICE credentials */
+};
+
+static void
+on_sdp_bundle (struct test_webrtc *t, GstElement * element,
+    GstWebRTCSessionDescription * desc, gpointer user_data)
+{
+  struct bundle_check *check = user_data;
+  const gchar *group, *first_ufrag = NULL;
+  int i;
+
+  group = gst_sdp_message_get_attribute_val (desc->sdp, "group");
+  fail_unless (g_strcmp0 (group, check->group) == 0,
+      "unexpected group \'%s\', expected \'%s\'", group, check->group);
+
+  for (i = 0; i < gst_sdp_message_medias_len (desc->sdp); i++) {
+    const GstSDPMedia *media = gst_sdp_message_get_media (desc->sdp, i);
+    const gchar *ufrag = gst_sdp_media_get_attribute_val (media, "ice-ufrag");
+    gboolean bundle_only =
+        gst_sdp_media_get_attribute_val (media, "bundle-only") != NULL;
+
+    fail_unless_equals_int (gst_sdp_media_get_port (media), check->ports[i]);
+    fail_unless_equals_int (bundle_only, check->bundle_only[i]);
+
+    if (check->ports[i] == 0 && !bundle_only)
+      continue;
+
+    /* the bundled media are sent with their MID */
+    if (check->group)
+      fail_unless_equals_string (gst_sdp_media_get_attribute_val (media,
+              "extmap"), "1 urn:ietf:params:rtp-hdrext:sdes:mid");
+    else
+      fail_unless (gst_sdp_media_get_attribute_val (media, "extmap") == NULL);
+
+    fail_unless (ufrag != NULL);
+    if (!first_ufrag)
+      first_ufrag = ufrag;
+    else if (check->same_ice)
+      fail_unless_equals_string (ufrag, first_ufrag);
+    else
+      fail_if (g_strcmp0 (ufrag, first_ufrag) == 0);
+  }
+}
+
+static void
+test_bundle_audio_video (const gchar * offer_policy,
+    const gchar * answer_policy, struct bundle_check *offer_check,
+    struct bundle_check *answer_check)
+{
+  struct test_webrtc *t = create_audio_video_test ();
+  struct validate_sdp offer = { on_sdp_bundle, offer_check };
+  struct validate_sdp answer = { on_sdp_bundle, answer_check };
+
+  gst_util_set_object_arg (G_OBJECT (t->webrtc1), "bundle-policy",
+      offer_policy);
+  gst_util_set_object_arg (G_OBJECT (t->webrtc2), "bundle-policy",
+      answer_policy);
+
+  t->offer_data = &offer;
+  t->on_offer_created = validate_sdp;
+  t->answer_data = &answer;
+  t->on_answer_created = validate_sdp;
+  t->on_ice_candidate = NULL;
+
+  test_webrtc_create_offer (t, t->webrtc1);
+
+  test_webrtc_wait_for_answer_error_eos (t);
+  fail_unless_equals_int (STATE_ANSWER_CREATED, t->state);
+  test_webrtc_free (t);
+}
+
+GST_START_TEST (test_bundle_max_bundle)
+{
+  const guint offer_ports[] = { 9, 0 };
+  const gboolean offer_bundle_only[] = { FALSE, TRUE };
+  const guint answer_ports[] = { 9, 9 };
+  const gboolean answer_bundle_only[] = { FALSE, FALSE };
+  struct bundle_check offer = { "BUNDLE audio0 video1", offer_ports,
+    offer_bundle_only, TRUE
+  };
+  struct bundle_check answer = { "BUNDLE audio0 video1", answer_ports,
+    answer_bundle_only, TRUE
+  };
+
+  /* only the first media carries a transport in the offer and both media
+   * are bundled on it in the answer */
+  test_bundle_audio_video ("max-bundle", "max-bundle", &offer, &answer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bundle_max_compat)
+{
+  const guint ports[] = { 9, 9 };
+  const gboolean bundle_only[] = { FALSE, FALSE };
+  struct bundle_check offer = { "BUNDLE audio0 video1", ports, bundle_only,
+    FALSE
+  };
+  struct bundle_check answer = { "BUNDLE audio0 video1", ports, bundle_only,
+    TRUE
+  };
+
+  /* each media has its own transport in the offer until the answer bundles
+   * them */
+  test_bundle_audio_video ("max-compat", "balanced", &offer, &answer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bundle_balanced)
+{
+  const guint ports[] = { 9, 9 };
+  const gboolean bundle_only[] = { FALSE, FALSE };
+  struct bundle_check offer = { "BUNDLE audio0 video1", ports, bundle_only,
+    FALSE
+  };
+  struct bundle_check answer = { "BUNDLE audio0 video1", ports, bundle_only,
+    TRUE
+  };
+
+  /* audio and video are of a different type so both have a transport */
+  test_bundle_audio_video ("balanced", "max-bundle", &offer, &answer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bundle_refused)
+{
+  const guint offer_ports[] = { 9, 0 };
+  const gboolean offer_bundle_only[] = { FALSE, TRUE };
+  const guint answer_ports[] = { 9, 0 };
+  const gboolean answer_bundle_only[] = { FALSE, FALSE };
+  struct bundle_check offer = { "BUNDLE audio0 video1", offer_ports,
+    offer_bundle_only, TRUE
+  };
+  struct bundle_check answer = { NULL, answer_ports, answer_bundle_only,
+    FALSE
+  };
+
+  /* an answerer not bundling rejects the bundle-only media */
+  test_bundle_audio_video ("max-bundle", "none", &offer, &answer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bundle_none)
+{
+  const guint ports[] = { 9, 9 };
+  const gboolean bundle_only[] = { FALSE, FALSE };
+  struct bundle_check offer = { NULL, ports, bundle_only, FALSE };
+  struct bundle_check answer = { NULL, ports, bundle_only, FALSE };
+
+  /* no bundle is offered by default */
+  test_bundle_audio_video ("none", "max-bundle", &offer, &answer);
+}
+
+GST_END_TEST;
+
+/* waits until the operations queued on @webrtc so far have completed, they
+ * are run in order */
+static void
+_wait_for_pending_operations (GstElement * webrtc)
+{
+  GstPromise *promise = gst_promise_new ();
+
+  g_signal_emit_by_name (webrtc, "get-stats", NULL, promise);
+  fail_unless_equals_int (gst_promise_wait (promise), GST_PROMISE_RESULT_REPLIED);
+  gst_promise_unref (promise);
+}
+
+static GstBuffer *
+_make_rtp_buffer (guint8 pt, guint32 ssrc)
+{
+  guint8 data[16] = { 0x80, };
+
+  data[1] = pt;
+  GST_WRITE_UINT16_BE (data + 2, 1);
+  GST_WRITE_UINT32_BE (data + 4, 0);
+  GST_WRITE_UINT32_BE (data + 8, ssrc);
+
+  return gst_buffer_new_wrapped (g_memdup (data, sizeof (data)),
+      sizeof (data));
+}
+
+/* counts the RTP packets reaching a transport, and drops them as there is
+ * no ICE connection to send them on */
+static GstPadProbeReturn
+_count_transport_packets (GstPad * pad, GstPadProbeInfo * info,
+    gint * n_packets)
+{
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    g_atomic_int_add (n_packets,
+        gst_buffer_list_length (GST_PAD_PROBE_INFO_BUFFER_LIST (info)));
+  else
+    g_atomic_int_inc (n_packets);
+
+  return GST_PAD_PROBE_DROP;
+}
+
+struct mid_count
+{
+  gint audio;
+  gint video;
+};
+
+/* counts the RTP packets reaching a transport with the MID of each media */
+static GstPadProbeReturn
+_count_mid_packets (GstPad * pad, GstPadProbeInfo * info,
+    struct mid_count *count)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  gpointer data;
+  guint size;
+
+  fail_unless (gst_rtp_buffer_map (GST_PAD_PROBE_INFO_BUFFER (info),
+          GST_MAP_READ, &rtp));
+  if (gst_rtp_buffer_get_extension_onebyte_header (&rtp, 1, 0, &data, &size)) {
+    if (size == 6 && memcmp (data, "audio0", 6) == 0)
+      g_atomic_int_inc (&count->audio);
+    else if (size == 6 && memcmp (data, "video1", 6) == 0)
+      g_atomic_int_inc (&count->video);
+  }
+  gst_rtp_buffer_unmap (&rtp);
+
+  return GST_PAD_PROBE_OK;
+}
+
+#define MAX_TRANSPORTS 4
+
+static void
+test_bundle_send (const gchar * offer_policy, const gchar * answer_policy)
+{
+  struct test_webrtc *t = test_webrtc_new ();
+  gint n_packets[MAX_TRANSPORTS] = { 0, };
+  struct mid_count mids = { 0, };
+  GstHarness *h_audio, *h_video;
+  GValue item = G_VALUE_INIT;
+  GstIterator *it;
+  guint i, n_transports = 0, n_used = 0;
+
+  t->on_negotiation_needed = NULL;
+  t->on_pad_added = _pad_added_fakesink;
+  t->on_ice_candidate = NULL;
+  t->on_offer_created = NULL;
+  t->on_answer_created = NULL;
+
+  gst_util_set_object_arg (G_OBJECT (t->webrtc1), "bundle-policy",
+      offer_policy);
+  gst_util_set_object_arg (G_OBJECT (t->webrtc2), "bundle-policy",
+      answer_policy);
+
+  /* the sink pads are linked to a transport before the negotiation */
+  h_audio = gst_harness_new_with_element (t->webrtc1, "sink_0", NULL);
+  gst_harness_set_src_caps_str (h_audio, OPUS_RTP_CAPS (96));
+  t->harnesses = g_list_prepend (t->harnesses, h_audio);
+  h_video = gst_harness_new_with_element (t->webrtc1, "sink_1", NULL);
+  gst_harness_set_src_caps_str (h_video, VP8_RTP_CAPS (97));
+  t->harnesses = g_list_prepend (t->harnesses, h_video);
+
+  test_webrtc_create_offer (t, t->webrtc1);
+  test_webrtc_wait_for_answer_error_eos (t);
+  fail_unless_equals_int (STATE_ANSWER_CREATED, t->state);
+  _wait_for_pending_operations (t->webrtc1);
+
+  it = gst_bin_iterate_elements (GST_BIN (t->webrtc1));
+  while (gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+    GstElement *element = g_value_get_object (&item);
+
+    if (g_strcmp0 (G_OBJECT_TYPE_NAME (element), "TransportSendBin") == 0) {
+      GstPad *pad = gst_element_get_static_pad (element, "rtp_sink");
+
+      fail_unless (n_transports < MAX_TRANSPORTS);
+      gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+          (GstPadProbeCallback) _count_mid_packets, &mids, NULL);
+      gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+          GST_PAD_PROBE_TYPE_BUFFER_LIST,
+          (GstPadProbeCallback) _count_transport_packets,
+          &n_packets[n_transports++], NULL);
+      gst_object_unref (pad);
+    }
+    g_value_reset (&item);
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  /* the transport the video left once bundled has been torn down */
+  fail_unless_equals_int (n_transports, 1);
+
+  for (i = 0; i < 5; i++) {
+    fail_unless_equals_int (gst_harness_push (h_audio,
+            _make_rtp_buffer (96, 0x11111111)), GST_FLOW_OK);
+    fail_unless_equals_int (gst_harness_push (h_video,
+            _make_rtp_buffer (97, 0x22222222)), GST_FLOW_OK);
+  }
+
+  /* the media of both pads go out on the single bundle transport */
+  for (i = 0; i < n_transports; i++) {
+    gint n = g_atomic_int_get (&n_packets[i]);
+
+    GST_INFO ("transport %u sent %d packets", i, n);
+    if (n > 0) {
+      fail_unless_equals_int (n, 10);
+      n_used++;
+    }
+  }
+  fail_unless_equals_int (n_used, 1);
+
+  /* and each media is sent with its MID */
+  fail_unless_equals_int (g_atomic_int_get (&mids.audio), 5);
+  fail_unless_equals_int (g_atomic_int_get (&mids.video), 5);
+
+  test_webrtc_free (t);
+}
+
+GST_START_TEST (test_bundle_send_max_compat)
+{
+  /* the video pad moves to the audio transport once the answer is set */
+  test_bundle_send ("max-compat", "balanced");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bundle_send_max_bundle)
+{
+  /* the video pad moves to the audio transport when creating the offer */
+  test_bundle_send ("max-bundle", "max-bundle");
+}
+
+GST_END_TEST;
+
 static Suite *
 webrtcbin_suite (void)
 {
   Suite *s = suite_create ("webrtcbin");
   TCase *tc = tcase_create ("general");
-  GstPluginFeature *nicesrc, *nicesink;
+  GstPluginFeature *nicesrc, *nicesink, *rtpfunnel;
   GstRegistry *registry;
 
   registry = gst_registry_get ();
   nicesrc = gst_registry_lookup_feature (registry, "nicesrc");
   nicesink = gst_registry_lookup_feature (registry, "nicesink");
+  rtpfunnel = gst_registry_lookup_feature (registry, "rtpfunnel");
 
   tcase_add_test (tc, test_sdp_no_media);
   tcase_add_test (tc, test_no_nice_elements_request_pad);
@@ -1367,12 +1706,23 @@ webrtcbin_suite (void)
     tcase_add_test (tc, test_get_transceivers);
     tcase_add_test (tc, test_add_recvonly_transceiver);
     tcase_add_test (tc, test_recvonly_sendonly);
+    tcase_add_test (tc, test_bundle_none);
+    if (rtpfunnel) {
+      tcase_add_test (tc, test_bundle_max_bundle);
+      tcase_add_test (tc, test_bundle_max_compat);
+      tcase_add_test (tc, test_bundle_balanced);
+      tcase_add_test (tc, test_bundle_refused);
+      tcase_add_test (tc, test_bundle_send_max_compat);
+      tcase_add_test (tc, test_bundle_send_max_bundle);
+    }
   }
 
   if (nicesrc)
     gst_object_unref (nicesrc);
   if (nicesink)
     gst_object_unref (nicesink);
+  if (rtpfunnel)
+    gst_object_unref (rtpfunnel);
 
   suite_add_tcase (s, tc);
 
@@ -338,6 +338,105 @@ GST_START_TEST (isoff_moov_parse)
 
 GST_END_TEST;
 
+GST_START_TEST (isoff_moov_parse_sample_entry)
+{
+  GstByteReader reader = GST_BYTE_READER_INIT (init_mp4, sizeof (init_mp4));
+  guint32 type;
+  guint header_size;
+  guint64 size;
+  GstMoovBox *moov;
+  GstTrakBox *trak;
+  GstStsdEntry *entry;
+  GstTrexBox *trex;
+  GstMapInfo map;
+
+  fail_unless (gst_isoff_parse_box_header (&reader, &type, NULL,
+          &header_size, &size));
+  moov = gst_isoff_moov_box_parse (&reader);
+  fail_unless (moov != NULL);
+
+  trak = &g_array_index (moov->trak, GstTrakBox, 0);
+  fail_unless (trak->mdia.minf.stbl.stsd.entries != NULL);
+  fail_unless_equals_int (trak->mdia.minf.stbl.stsd.entries->len, 1);
+
+  entry = &g_array_index (trak->mdia.minf.stbl.stsd.entries, GstStsdEntry, 0);
+  fail_unless (entry->fourcc == GST_ISOFF_FOURCC_MP4A);
+  fail_unless_equals_int (entry->channel_count, 2);
+  fail_unless_equals_int (entry->sample_rate, 44100);
+  fail_unless (entry->codec_data_fourcc == GST_ISOFF_FOURCC_ESDS);
+  fail_unless_equals_int (entry->object_type_indication, 0x40);
+
+  /* AAC LC, 44.1 kHz, stereo */
+  fail_unless (entry->codec_data != NULL);
+  gst_buffer_map (entry->codec_data, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, 2);
+  fail_unless_equals_int (map.data[0], 0x12);
+  fail_unless_equals_int (map.data[1], 0x10);
+  gst_buffer_unmap (entry->codec_data, &map);
+
+  fail_unless_equals_int (moov->trex->len, 1);
+  trex = &g_array_index (moov->trex, GstTrexBox, 0);
+  fail_unless_equals_int (trex->track_id, 2);
+  fail_unless_equals_int (trex->default_sample_description_index, 1);
+  fail_unless_equals_int (trex->default_sample_duration, 0);
+  fail_unless_equals_int (trex->default_sample_size, 0);
+  fail_unless_equals_int (trex->default_sample_flags, 0);
+
+  gst_isoff_moov_box_free (moov);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (isoff_moof_get_samples)
+{
+  GstByteReader reader = GST_BYTE_READER_INIT (seg_2_m4f, sizeof (seg_2_m4f));
+  guint32 type;
+  guint header_size;
+  guint64 size, offset;
+  GstMoofBox *moof;
+  GstTrexBox trex = { 2, 1, 0, 0, 0x01010000 };
+  GArray *samples;
+  guint i;
+
+  fail_unless (gst_isoff_parse_box_header (&reader, &type, NULL,
+          &header_size, &size));
+  moof = gst_isoff_moof_box_parse (&reader);
+  fail_unless (moof != NULL);
+
+  /* no traf for this track */
+  samples = gst_isoff_moof_box_get_samples (moof, 1000, 1, NULL);
+  fail_unless (samples != NULL);
+  fail_unless_equals_int (samples->len, 0);
+  g_array_free (samples, TRUE);
+
+  /* the moof is at offset 1000, the data follows the mdat header */
+  samples = gst_isoff_moof_box_get_samples (moof, 1000, 2, &trex);
+  fail_unless (samples != NULL);
+  fail_unless_equals_int (samples->len, 129);
+
+  offset = 1000 + size + 8;
+  for (i = 0; i < 129; i++) {
+    GstIsoffSample *sample = &g_array_index (samples, GstIsoffSample, i);
+
+    fail_unless_equals_uint64 (sample->offset, offset);
+    fail_unless_equals_int (sample->size, seg_2_sample_sizes[i]);
+    fail_unless_equals_int (sample->duration, seg_sample_duration);
+    fail_unless_equals_uint64 (sample->decode_time,
+        132096 + i * seg_sample_duration);
+    fail_unless_equals_int (sample->composition_time_offset, 0);
+    /* the flags come from the trex */
+    fail_unless_equals_int (sample->flags, 0x01010000);
+    fail_if (GST_ISOFF_SAMPLE_IS_SYNC (sample));
+
+    offset += sample->size;
+  }
+  g_array_free (samples, TRUE);
+
+  gst_isoff_moof_box_free (moof);
+}
+
+GST_END_TEST;
+
 static Suite *
 dash_isoff_suite (void)
 {
@@ -356,9 +455,11 @@ dash_isoff_suite (void)
   tcase_add_test (tc_moof, isoff_moof_parse);
   tcase_add_test (tc_moof, isoff_moof_parse_with_tfdt);
   tcase_add_test (tc_moof, isoff_moof_parse_with_tfxd_tfrf);
+  tcase_add_test (tc_moof, isoff_moof_get_samples);
   suite_add_tcase (s, tc_moof);
 
   tcase_add_test (tc_moov, isoff_moov_parse);
+  tcase_add_test (tc_moov, isoff_moov_parse_sample_entry);
   suite_add_tcase (s, tc_moov);
 
   return s;
@@ -560,6 +560,59 @@ GST_START_TEST (test_mpegts_dvb_descriptors)
 
 GST_END_TEST;
 
+GST_START_TEST (test_mpegts_crc32)
+{
+  const guint8 *sections[] = { pat_data_check, pmt_data_check,
+    nit_data_check, sdt_data_check, stt_data_check
+  };
+  const gsize sizes[] = { sizeof (pat_data_check), sizeof (pmt_data_check),
+    sizeof (nit_data_check), sizeof (sdt_data_check), sizeof (stt_data_check)
+  };
+  guint8 *data;
+  gsize offset, len, i;
+  guint32 crc, ref;
+  gint64 start, elapsed;
+  gint j;
+
+  fail_unless_equals_int (gst_mpegts_calc_crc32 ((const guint8 *) "123456789",
+          9), 0x0376e6e7);
+  fail_unless_equals_int (gst_mpegts_calc_crc32 (NULL, 0), 0xffffffff);
+
+  /* complete sections have a CRC of 0 */
+  for (i = 0; i < G_N_ELEMENTS (sections); i++)
+    fail_unless_equals_int (gst_mpegts_calc_crc32 (sections[i], sizes[i]), 0);
+
+  /* compare with a bitwise implementation around all the block sizes */
+  data = g_malloc (4096 + 16);
+  for (i = 0; i < 4096 + 16; i++)
+    data[i] = g_random_int_range (0, 256);
+
+  for (offset = 0; offset < 16; offset++) {
+    for (len = 0; len <= 300; len++) {
+      ref = 0xffffffff;
+      for (i = 0; i < len; i++) {
+        ref ^= (guint32) data[offset + i] << 24;
+        for (j = 0; j < 8; j++)
+          ref = (ref << 1) ^ (ref & 0x80000000 ? 0x04c11db7 : 0);
+      }
+      fail_unless_equals_int (gst_mpegts_calc_crc32 (data + offset, len), ref);
+    }
+  }
+
+  /* how fast maximum size sections are checked */
+  crc = 0;
+  start = g_get_monotonic_time ();
+  for (i = 0; i < 10000; i++)
+    crc ^= gst_mpegts_calc_crc32 (data, 4096);
+  elapsed = g_get_monotonic_time () - start;
+  GST_INFO ("CRC of 10000 x 4096 bytes in %" G_GINT64_FORMAT " us, %.1f MB/s "
+      "(%08x)", elapsed, 10000.0 * 4096 / MAX (elapsed, 1), crc);
+
+  g_free (data);
+}
+
+GST_END_TEST;
+
 static Suite *
 mpegts_suite (void)
 {
@@ -577,6 +630,7 @@ mpegts_suite (void)
   tcase_add_test (tc_chain, test_mpegts_atsc_stt);
   tcase_add_test (tc_chain, test_mpegts_descriptors);
   tcase_add_test (tc_chain, test_mpegts_dvb_descriptors);
+  tcase_add_test (tc_chain, test_mpegts_crc32);
 
   return s;
 }
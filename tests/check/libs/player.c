@@ -1628,6 +1628,216 @@ START_TEST (test_restart)
 
 END_TEST;
 
+static void
+test_play_standby_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  fail_if (change == STATE_CHANGE_ERROR);
+
+  if (change == STATE_CHANGE_END_OF_STREAM) {
+    new_state->test_data = GINT_TO_POINTER (1);
+    g_main_loop_quit (new_state->loop);
+  }
+}
+
+typedef struct
+{
+  GMainLoop *loop;
+  const gchar **uris;
+  guint n_pending;
+} StandbyReadyData;
+
+static void
+standby_ready_cb (GstPlayer * player, const gchar * uri,
+    StandbyReadyData * data)
+{
+  guint i;
+
+  for (i = 0; data->uris[i]; i++) {
+    if (g_strcmp0 (data->uris[i], uri) == 0) {
+      data->uris[i] = "";
+      data->n_pending--;
+    }
+  }
+
+  if (data->n_pending == 0)
+    g_main_loop_quit (data->loop);
+}
+
+/* waits until the standby pipelines of the NULL terminated @uris are ready */
+static void
+wait_standby_ready (GstPlayer * player, GMainLoop * loop, const gchar ** uris)
+{
+  StandbyReadyData data;
+  gulong id;
+
+  data.loop = loop;
+  data.uris = uris;
+  data.n_pending = g_strv_length ((gchar **) uris);
+
+  id = g_signal_connect (player, "standby-ready",
+      G_CALLBACK (standby_ready_cb), &data);
+  g_main_loop_run (loop);
+  g_signal_handler_disconnect (player, id);
+}
+
+START_TEST (test_play_standby)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  GstStructure *config;
+  GstElement *pipeline, *standby_pipeline, *sink, *fakesink;
+  GstClockTime time_to_first_frame;
+  const gchar *uris[2] = { NULL, };
+  gboolean sync;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_play_standby_cb;
+  state.test_data = GINT_TO_POINTER (0);
+
+  player = test_player_new (&state);
+
+  fail_unless (player != NULL);
+
+  config = gst_player_get_config (player);
+  fail_unless_equals_int (gst_player_config_get_max_standby (config), 2);
+  gst_player_config_set_standby_buffer_size (config, 512 * 1024);
+  fail_unless_equals_int (gst_player_config_get_standby_buffer_size (config),
+      512 * 1024);
+  fail_unless (gst_player_set_config (player, config));
+
+  fail_unless_equals_uint64 (gst_player_get_time_to_first_frame (player),
+      GST_CLOCK_TIME_NONE);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-short.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_add_standby_uri (player, uri);
+
+  uris[0] = uri;
+  wait_standby_ready (player, state.loop, uris);
+
+  pipeline = gst_player_get_pipeline (player);
+
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+
+  fail_unless_equals_int (GPOINTER_TO_INT (state.test_data), 1);
+
+  /* the standby pipeline was played */
+  standby_pipeline = gst_player_get_pipeline (player);
+  fail_if (standby_pipeline == pipeline);
+
+  /* with a copy of the sink of the previous pipeline instead of its
+   * fakesink, which doesn't sync by default */
+  g_object_get (standby_pipeline, "audio-sink", &sink, NULL);
+  fail_unless (GST_IS_BIN (sink));
+  fail_unless_equals_int (GST_BIN_NUMCHILDREN (sink), 1);
+  fakesink = GST_BIN_CHILDREN (sink)->data;
+  fail_unless (g_str_has_prefix (GST_OBJECT_NAME (fakesink), "fakesink"));
+  g_object_get (fakesink, "sync", &sync, NULL);
+  fail_unless (sync);
+  gst_object_unref (sink);
+
+  gst_object_unref (standby_pipeline);
+  gst_object_unref (pipeline);
+
+  time_to_first_frame = gst_player_get_time_to_first_frame (player);
+  fail_unless (GST_CLOCK_TIME_IS_VALID (time_to_first_frame));
+  GST_INFO ("time to first frame %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (time_to_first_frame));
+
+  stop_player (player, &state);
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
+static void
+test_play_standby_evicted_cb (GstPlayer * player,
+    TestPlayerStateChange change, TestPlayerState * old_state,
+    TestPlayerState * new_state)
+{
+  fail_if (change == STATE_CHANGE_ERROR);
+
+  if (change == STATE_CHANGE_STATE_CHANGED
+      && new_state->state == GST_PLAYER_STATE_PLAYING)
+    g_main_loop_quit (new_state->loop);
+}
+
+/* plays @uri and returns whether it switched away from @pipeline */
+static gboolean
+play_standby_uri (GstPlayer * player, TestPlayerState * state,
+    GstElement * pipeline, const gchar * uri)
+{
+  GstElement *current;
+  gboolean switched;
+
+  gst_player_set_uri (player, uri);
+  gst_player_play (player);
+  g_main_loop_run (state->loop);
+
+  current = gst_player_get_pipeline (player);
+  switched = current != pipeline;
+  gst_object_unref (current);
+
+  stop_player (player, state);
+  state->test_callback = test_play_standby_evicted_cb;
+
+  return switched;
+}
+
+START_TEST (test_play_standby_evicted)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  GstElement *pipeline;
+  const gchar *uris[3] = { NULL, };
+  gchar *first, *second, *third;
+
+  memset (&state, 0, sizeof (state));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_play_standby_evicted_cb;
+
+  player = test_player_new (&state);
+
+  fail_unless (player != NULL);
+
+  first = gst_filename_to_uri (TEST_PATH "/audio-short.ogg", NULL);
+  second = gst_filename_to_uri (TEST_PATH "/audio-video.ogg", NULL);
+  third = gst_filename_to_uri (TEST_PATH "/sintel.mkv", NULL);
+
+  /* only the last two of the default 2 are kept */
+  gst_player_add_standby_uri (player, first);
+  gst_player_add_standby_uri (player, second);
+  gst_player_add_standby_uri (player, third);
+
+  uris[0] = second;
+  uris[1] = third;
+  wait_standby_ready (player, state.loop, uris);
+
+  pipeline = gst_player_get_pipeline (player);
+
+  fail_if (play_standby_uri (player, &state, pipeline, first));
+  fail_unless (play_standby_uri (player, &state, pipeline, second));
+
+  gst_object_unref (pipeline);
+
+  g_free (first);
+  g_free (second);
+  g_free (third);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
 #define TEST_USER_AGENT "test user agent"
 
 static void
@@ -1722,6 +1932,8 @@ player_suite (void)
   tcase_add_test (tc_general, test_play_backward_rate);
   tcase_add_test (tc_general, test_play_audio_video_seek_done);
   tcase_add_test (tc_general, test_restart);
+  tcase_add_test (tc_general, test_play_standby);
+  tcase_add_test (tc_general, test_play_standby_evicted);
   tcase_add_test (tc_general, test_user_agent);
 
   suite_add_tcase (s, tc_general);
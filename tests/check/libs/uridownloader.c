@@ -0,0 +1,362 @@
+/* GStreamer
+ *
+ * unit test for the uridownloader library
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/uridownloader/gsturidownloader.h>
+
+#include "../elements/test_http_src.h"
+
+#define GST_TEST_HTTP_SRC_NAME "testhttpsrc"
+
+#define MANIFEST_URI "http://unit.test/manifest.mpd"
+#define DATA_URI "http://unit.test/data.mp4"
+#define MANIFEST_V1 "<?xml version=\"1.0\"?><MPD type=\"dynamic\"></MPD>"
+#define MANIFEST_V2 "<?xml version=\"1.0\"?><MPD type=\"static\"></MPD>"
+#define DATA_SIZE (256 * 1024)
+
+/* What the test source answers, and what it was asked for */
+typedef struct
+{
+  const gchar *manifest;
+  const gchar *etag;
+
+  guint requests;
+  guint not_modified;
+  gchar *last_range;
+} TestServer;
+
+static TestServer server;
+
+static guint8
+data_byte (guint64 offset)
+{
+  return offset % 251;
+}
+
+static gboolean
+test_src_start (GstTestHTTPSrc * src, const gchar * uri,
+    GstTestHTTPSrcInput * input_data, gpointer user_data)
+{
+  const gchar *if_none_match = NULL;
+  const gchar *range = NULL;
+
+  server.requests++;
+  if (input_data->request_headers) {
+    if_none_match = gst_structure_get_string (input_data->request_headers,
+        "If-None-Match");
+    range = gst_structure_get_string (input_data->request_headers, "Range");
+  }
+  g_free (server.last_range);
+  server.last_range = g_strdup (range);
+
+  if (strcmp (uri, MANIFEST_URI) == 0) {
+    input_data->context = (gpointer) server.manifest;
+    input_data->response_headers =
+        gst_structure_new (TEST_HTTP_SRC_RESPONSE_HEADERS_NAME,
+        "ETag", G_TYPE_STRING, server.etag, NULL);
+    if (g_strcmp0 (if_none_match, server.etag) == 0) {
+      server.not_modified++;
+      input_data->status_code = 304;
+    } else {
+      input_data->size = strlen (server.manifest);
+    }
+    return TRUE;
+  }
+
+  if (strcmp (uri, DATA_URI) == 0) {
+    input_data->context = NULL;
+    input_data->size = DATA_SIZE;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+static GstFlowReturn
+test_src_create (GstTestHTTPSrc * src, guint64 offset, guint length,
+    GstBuffer ** retbuf, gpointer context, gpointer user_data)
+{
+  const gchar *manifest = context;
+  GstMapInfo map;
+  guint i;
+
+  *retbuf = gst_buffer_new_allocate (NULL, length, NULL);
+  fail_unless (*retbuf != NULL);
+
+  gst_buffer_map (*retbuf, &map, GST_MAP_WRITE);
+  for (i = 0; i < length; i++)
+    map.data[i] = manifest ? manifest[offset + i] : data_byte (offset + i);
+  gst_buffer_unmap (*retbuf, &map);
+
+  return GST_FLOW_OK;
+}
+
+static const GstTestHTTPSrcCallbacks test_src_callbacks = {
+  test_src_start,
+  test_src_create
+};
+
+static void
+setup (void)
+{
+  fail_unless (gst_test_http_src_register_plugin (gst_registry_get (),
+          GST_TEST_HTTP_SRC_NAME));
+  gst_test_http_src_install_callbacks (&test_src_callbacks, NULL);
+
+  server.manifest = MANIFEST_V1;
+  server.etag = "\"v1\"";
+  server.requests = 0;
+  server.not_modified = 0;
+  server.last_range = NULL;
+}
+
+static void
+teardown (void)
+{
+  gst_test_http_src_install_callbacks (NULL, NULL);
+  g_free (server.last_range);
+  server.last_range = NULL;
+}
+
+static GstFragment *
+fetch (GstUriDownloader * downloader, const gchar * uri, gboolean refresh,
+    gint64 range_start, gint64 range_end)
+{
+  GstFragment *download;
+  GError *err = NULL;
+
+  download = gst_uri_downloader_fetch_uri_with_range (downloader, uri, NULL,
+      FALSE, refresh, TRUE, range_start, range_end, &err);
+  fail_unless (download != NULL, "%s", err ? err->message : "no error");
+  fail_unless (download->completed);
+  fail_unless_equals_string (download->uri, uri);
+
+  return download;
+}
+
+static void
+check_manifest (GstFragment * download, const gchar * manifest)
+{
+  GstBuffer *buf = gst_fragment_get_buffer (download);
+  GstMapInfo map;
+
+  fail_unless (buf != NULL);
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, strlen (manifest));
+  fail_unless (memcmp (map.data, manifest, map.size) == 0);
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+}
+
+static void
+check_data (GstFragment * download, gsize offset, gsize size)
+{
+  GstBuffer *buf = gst_fragment_get_buffer (download);
+  GstMapInfo map;
+  gsize i;
+
+  fail_unless (buf != NULL);
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, size);
+  for (i = 0; i < map.size; i++) {
+    if (map.data[i] != data_byte (offset + i))
+      fail ("wrong byte at offset %" G_GSIZE_FORMAT, offset + i);
+  }
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+}
+
+static guint64
+get_stat (GstUriDownloader * downloader, const gchar * name)
+{
+  GstStructure *stats = gst_uri_downloader_get_stats (downloader);
+  guint64 value;
+
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_get_uint64 (stats, name, &value));
+  gst_structure_free (stats);
+
+  return value;
+}
+
+GST_START_TEST (test_conditional_refresh)
+{
+  GstUriDownloader *downloader;
+  GstFragment *download;
+  const GstStructure *response_headers;
+  gint i;
+
+  downloader = gst_uri_downloader_new ();
+
+  /* a live manifest refreshed a few times, with the same source element */
+  for (i = 0; i < 4; i++) {
+    download = fetch (downloader, MANIFEST_URI, TRUE, 0, -1);
+    check_manifest (download, MANIFEST_V1);
+    fail_unless (download->headers != NULL);
+    response_headers =
+        gst_value_get_structure (gst_structure_get_value (download->headers,
+            "response-headers"));
+    fail_unless_equals_string (gst_structure_get_string (response_headers,
+            "ETag"), "\"v1\"");
+    g_object_unref (download);
+  }
+
+  fail_unless_equals_int (server.requests, 4);
+  fail_unless_equals_int (server.not_modified, 3);
+
+  fail_unless_equals_uint64 (get_stat (downloader, "requests"), 4);
+  fail_unless_equals_uint64 (get_stat (downloader, "sources-reused"), 3);
+  fail_unless_equals_uint64 (get_stat (downloader, "not-modified"), 3);
+  fail_unless_equals_uint64 (get_stat (downloader, "bytes-received"),
+      strlen (MANIFEST_V1));
+  fail_unless_equals_uint64 (get_stat (downloader, "bytes-saved"),
+      3 * strlen (MANIFEST_V1));
+
+  gst_object_unref (downloader);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_changed_manifest)
+{
+  GstUriDownloader *downloader;
+  GstFragment *download;
+
+  downloader = gst_uri_downloader_new ();
+
+  download = fetch (downloader, MANIFEST_URI, TRUE, 0, -1);
+  check_manifest (download, MANIFEST_V1);
+  g_object_unref (download);
+
+  /* the validator does not match anymore, the new manifest is answered */
+  server.manifest = MANIFEST_V2;
+  server.etag = "\"v2\"";
+  download = fetch (downloader, MANIFEST_URI, TRUE, 0, -1);
+  check_manifest (download, MANIFEST_V2);
+  g_object_unref (download);
+
+  /* and is then the one revalidated */
+  download = fetch (downloader, MANIFEST_URI, TRUE, 0, -1);
+  check_manifest (download, MANIFEST_V2);
+  g_object_unref (download);
+
+  fail_unless_equals_int (server.requests, 3);
+  fail_unless_equals_int (server.not_modified, 1);
+  fail_unless_equals_uint64 (get_stat (downloader, "bytes-received"),
+      strlen (MANIFEST_V1) + strlen (MANIFEST_V2));
+
+  gst_object_unref (downloader);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_range_coalescing)
+{
+  GstUriDownloader *downloader;
+  GstFragment *download;
+
+  downloader = gst_uri_downloader_new ();
+
+  /* the range is sent as a header of the request */
+  download = fetch (downloader, DATA_URI, FALSE, 0, 65535);
+  check_data (download, 0, 65536);
+  g_object_unref (download);
+  fail_unless_equals_string (server.last_range, "bytes=0-65535");
+
+  /* contained in the previous range, answered without a request */
+  download = fetch (downloader, DATA_URI, FALSE, 1000, 1999);
+  check_data (download, 1000, 1000);
+  g_object_unref (download);
+  fail_unless_equals_int (server.requests, 1);
+  fail_unless_equals_uint64 (get_stat (downloader, "range-hits"), 1);
+  fail_unless_equals_uint64 (get_stat (downloader, "bytes-saved"), 1000);
+
+  /* outside of it, or refreshed */
+  download = fetch (downloader, DATA_URI, FALSE, 65000, 69999);
+  check_data (download, 65000, 5000);
+  g_object_unref (download);
+  fail_unless_equals_string (server.last_range, "bytes=65000-69999");
+  download = fetch (downloader, DATA_URI, TRUE, 66000, 66999);
+  check_data (download, 66000, 1000);
+  g_object_unref (download);
+  fail_unless_equals_int (server.requests, 3);
+  fail_unless_equals_uint64 (get_stat (downloader, "range-hits"), 1);
+
+  download = fetch (downloader, DATA_URI, FALSE, 0, -1);
+  check_data (download, 0, DATA_SIZE);
+  g_object_unref (download);
+  fail_unless (server.last_range == NULL);
+
+  fail_unless_equals_uint64 (get_stat (downloader, "requests"), 4);
+  fail_unless_equals_uint64 (get_stat (downloader, "bytes-received"),
+      65536 + 5000 + 1000 + DATA_SIZE);
+
+  gst_object_unref (downloader);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_not_found)
+{
+  GstUriDownloader *downloader;
+  GstFragment *download;
+  GError *err = NULL;
+
+  downloader = gst_uri_downloader_new ();
+
+  download = gst_uri_downloader_fetch_uri (downloader,
+      "http://unit.test/missing.mpd", NULL, FALSE, TRUE, TRUE, &err);
+  fail_unless (download == NULL);
+  fail_unless (g_error_matches (err, GST_RESOURCE_ERROR,
+          GST_RESOURCE_ERROR_NOT_FOUND));
+  g_clear_error (&err);
+
+  /* nothing kept, the manifest is fetched in full */
+  download = fetch (downloader, MANIFEST_URI, TRUE, 0, -1);
+  check_manifest (download, MANIFEST_V1);
+  g_object_unref (download);
+  fail_unless_equals_int (server.not_modified, 0);
+
+  gst_object_unref (downloader);
+}
+
+GST_END_TEST;
+
+static Suite *
+uridownloader_suite (void)
+{
+  Suite *s = suite_create ("uridownloader");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_checked_fixture (tc_chain, setup, teardown);
+  tcase_add_test (tc_chain, test_conditional_refresh);
+  tcase_add_test (tc_chain, test_changed_manifest);
+  tcase_add_test (tc_chain, test_range_coalescing);
+  tcase_add_test (tc_chain, test_not_found);
+
+  return s;
+}
+
+GST_CHECK_MAIN (uridownloader);
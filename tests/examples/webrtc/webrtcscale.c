@@ -0,0 +1,274 @@
+/* Connects many pairs of local webrtcbin's and reports the time it took,
+ * the memory and the number of threads used.  The number of shared threads
+ * can be changed with the GST_WEBRTC_THREADS and GST_WEBRTC_ICE_THREADS
+ * environment variables. */
+
+#include <gst/gst.h>
+#include <gst/sdp/sdp.h>
+#include <gst/webrtc/webrtc.h>
+
+#include <string.h>
+
+typedef struct
+{
+  GstElement *pipe;
+  GstElement *offerer;
+  GstElement *answerer;
+  gboolean offerer_connected;
+  gboolean answerer_connected;
+} PeerPair;
+
+static GMainLoop *loop;
+static GMutex lock;
+static guint n_connected;
+static gint n_pairs = 200;
+static gint timeout = 60;
+static gint64 start_time;
+
+static void
+_print_usage (const gchar * when)
+{
+  gchar *contents = NULL;
+  gchar **lines;
+  const gchar *threads = "?", *rss = "?";
+  gint i;
+
+  /* Linux only */
+  if (g_file_get_contents ("/proc/self/status", &contents, NULL, NULL)) {
+    lines = g_strsplit (contents, "\n", -1);
+    for (i = 0; lines[i]; i++) {
+      if (g_str_has_prefix (lines[i], "Threads:"))
+        threads = g_strstrip (lines[i] + strlen ("Threads:"));
+      else if (g_str_has_prefix (lines[i], "VmRSS:"))
+        rss = g_strstrip (lines[i] + strlen ("VmRSS:"));
+    }
+    g_print ("%-24s threads: %s, resident memory: %s\n", when, threads, rss);
+    g_strfreev (lines);
+    g_free (contents);
+  }
+}
+
+static gboolean
+_report_connected (gpointer user_data)
+{
+  g_print ("%d pairs connected in %.3f s\n", n_pairs,
+      (g_get_monotonic_time () - start_time) / (gdouble) G_USEC_PER_SEC);
+  _print_usage ("connected");
+  g_main_loop_quit (loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+_report_timeout (gpointer user_data)
+{
+  g_printerr ("only %u of %d pairs connected after %d s\n", n_connected,
+      n_pairs, timeout);
+  _print_usage ("timeout");
+  g_main_loop_quit (loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+_on_ice_connection_state (GstElement * webrtc, GParamSpec * pspec,
+    PeerPair * pair)
+{
+  GstWebRTCICEConnectionState state;
+  gboolean connected;
+
+  g_object_get (webrtc, "ice-connection-state", &state, NULL);
+  connected = state == GST_WEBRTC_ICE_CONNECTION_STATE_CONNECTED
+      || state == GST_WEBRTC_ICE_CONNECTION_STATE_COMPLETED;
+  if (!connected)
+    return;
+
+  g_mutex_lock (&lock);
+  if (webrtc == pair->offerer && !pair->offerer_connected)
+    pair->offerer_connected = TRUE;
+  else if (webrtc == pair->answerer && !pair->answerer_connected)
+    pair->answerer_connected = TRUE;
+  else
+    connected = FALSE;
+
+  if (connected && pair->offerer_connected && pair->answerer_connected) {
+    if (++n_connected == (guint) n_pairs)
+      g_idle_add (_report_connected, NULL);
+  }
+  g_mutex_unlock (&lock);
+}
+
+static void
+_on_pad_added (GstElement * webrtc, GstPad * new_pad, PeerPair * pair)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  if (GST_PAD_DIRECTION (new_pad) != GST_PAD_SRC)
+    return;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "async", FALSE, NULL);
+  gst_bin_add (GST_BIN (pair->pipe), sink);
+  gst_element_sync_state_with_parent (sink);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_link (new_pad, sinkpad);
+  gst_object_unref (sinkpad);
+}
+
+static void
+_on_answer_received (GstPromise * promise, PeerPair * pair)
+{
+  GstWebRTCSessionDescription *answer = NULL;
+
+  gst_structure_get (gst_promise_get_reply (promise), "answer",
+      GST_TYPE_WEBRTC_SESSION_DESCRIPTION, &answer, NULL);
+  gst_promise_unref (promise);
+
+  g_signal_emit_by_name (pair->answerer, "set-local-description", answer,
+      NULL);
+  g_signal_emit_by_name (pair->offerer, "set-remote-description", answer,
+      NULL);
+  gst_webrtc_session_description_free (answer);
+}
+
+static void
+_on_offer_received (GstPromise * promise, PeerPair * pair)
+{
+  GstWebRTCSessionDescription *offer = NULL;
+
+  gst_structure_get (gst_promise_get_reply (promise), "offer",
+      GST_TYPE_WEBRTC_SESSION_DESCRIPTION, &offer, NULL);
+  gst_promise_unref (promise);
+
+  g_signal_emit_by_name (pair->offerer, "set-local-description", offer, NULL);
+  g_signal_emit_by_name (pair->answerer, "set-remote-description", offer,
+      NULL);
+  gst_webrtc_session_description_free (offer);
+
+  promise = gst_promise_new_with_change_func ((GstPromiseChangeFunc)
+      _on_answer_received, pair, NULL);
+  g_signal_emit_by_name (pair->answerer, "create-answer", NULL, promise);
+}
+
+static void
+_on_negotiation_needed (GstElement * webrtc, PeerPair * pair)
+{
+  GstPromise *promise;
+
+  promise = gst_promise_new_with_change_func ((GstPromiseChangeFunc)
+      _on_offer_received, pair, NULL);
+  g_signal_emit_by_name (pair->offerer, "create-offer", NULL, promise);
+}
+
+static void
+_on_ice_candidate (GstElement * webrtc, guint mlineindex, gchar * candidate,
+    GstElement * other)
+{
+  g_signal_emit_by_name (other, "add-ice-candidate", mlineindex, candidate);
+}
+
+static PeerPair *
+_create_pair (void)
+{
+  PeerPair *pair = g_new0 (PeerPair, 1);
+  GError *error = NULL;
+
+  pair->pipe =
+      gst_parse_launch ("audiotestsrc is-live=true wave=silence ! opusenc ! "
+      "rtpopuspay ! queue ! application/x-rtp,media=audio,payload=96,"
+      "encoding-name=OPUS ! webrtcbin name=offerer webrtcbin name=answerer",
+      &error);
+  if (!pair->pipe) {
+    g_printerr ("failed to create the pipeline: %s\n", error->message);
+    g_error_free (error);
+    g_free (pair);
+    return NULL;
+  }
+
+  pair->offerer = gst_bin_get_by_name (GST_BIN (pair->pipe), "offerer");
+  pair->answerer = gst_bin_get_by_name (GST_BIN (pair->pipe), "answerer");
+
+  g_signal_connect (pair->offerer, "on-negotiation-needed",
+      G_CALLBACK (_on_negotiation_needed), pair);
+  g_signal_connect (pair->offerer, "on-ice-candidate",
+      G_CALLBACK (_on_ice_candidate), pair->answerer);
+  g_signal_connect (pair->answerer, "on-ice-candidate",
+      G_CALLBACK (_on_ice_candidate), pair->offerer);
+  g_signal_connect (pair->answerer, "pad-added", G_CALLBACK (_on_pad_added),
+      pair);
+  g_signal_connect (pair->offerer, "notify::ice-connection-state",
+      G_CALLBACK (_on_ice_connection_state), pair);
+  g_signal_connect (pair->answerer, "notify::ice-connection-state",
+      G_CALLBACK (_on_ice_connection_state), pair);
+
+  return pair;
+}
+
+static void
+_free_pair (PeerPair * pair)
+{
+  gst_element_set_state (pair->pipe, GST_STATE_NULL);
+  gst_object_unref (pair->offerer);
+  gst_object_unref (pair->answerer);
+  gst_object_unref (pair->pipe);
+  g_free (pair);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionEntry entries[] = {
+    {"pairs", 'n', 0, G_OPTION_ARG_INT, &n_pairs,
+        "Number of pairs of webrtcbin to connect (default: 200)", "N"},
+    {"timeout", 't', 0, G_OPTION_ARG_INT, &timeout,
+        "Seconds to wait for the connections (default: 60)", "SECONDS"},
+    {NULL}
+  };
+  GOptionContext *ctx;
+  GError *error = NULL;
+  PeerPair **pairs;
+  gint i;
+
+  ctx = g_option_context_new ("- connect many local webrtcbin pairs");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &error)) {
+    g_printerr ("Error initializing: %s\n", error->message);
+    g_error_free (error);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (n_pairs <= 0 || timeout <= 0)
+    return 0;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  _print_usage ("start");
+
+  pairs = g_new0 (PeerPair *, n_pairs);
+  for (i = 0; i < n_pairs; i++) {
+    if (!(pairs[i] = _create_pair ()))
+      return 1;
+  }
+  _print_usage ("created");
+
+  start_time = g_get_monotonic_time ();
+  for (i = 0; i < n_pairs; i++)
+    gst_element_set_state (pairs[i]->pipe, GST_STATE_PLAYING);
+  g_timeout_add_seconds (timeout, _report_timeout, NULL);
+
+  g_main_loop_run (loop);
+
+  for (i = 0; i < n_pairs; i++)
+    _free_pair (pairs[i]);
+  g_free (pairs);
+  _print_usage ("freed");
+
+  g_main_loop_unref (loop);
+  gst_deinit ();
+
+  return n_connected == (guint) n_pairs ? 0 : 1;
+}